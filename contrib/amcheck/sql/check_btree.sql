@@ -54,8 +54,26 @@ WHERE relation = ANY(ARRAY['bttest_a', 'bttest_a_idx', 'bttest_b', 'bttest_b_idx
     AND pid = pg_backend_pid();
 COMMIT;
 
+-- multi-column index with suffix-truncated pivot tuples, built by both
+-- CREATE INDEX and leaf page splits
+CREATE TABLE bttest_multi(id int4, data text);
+INSERT INTO bttest_multi
+    SELECT i % 1000, repeat('x', 20) || i FROM generate_series(1, 50000) i;
+CREATE INDEX bttest_multi_idx ON bttest_multi USING btree (id, data);
+SELECT bt_index_parent_check('bttest_multi_idx');
+INSERT INTO bttest_multi
+    SELECT i % 1000, repeat('y', 20) || i FROM generate_series(1, 50000) i;
+SELECT bt_index_parent_check('bttest_multi_idx');
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM bttest_multi WHERE id = 42;
+SELECT count(*) FROM bttest_multi WHERE id = 42 AND data > 'y';
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
 -- cleanup
 DROP TABLE bttest_a;
 DROP TABLE bttest_b;
+DROP TABLE bttest_multi;
 DROP OWNED BY bttest_role; -- permissions
 DROP ROLE bttest_role;
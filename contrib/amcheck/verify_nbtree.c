@@ -98,20 +98,21 @@ static void bt_check_every_level(Relation rel, bool readonly);
 static BtreeLevel bt_check_level_from_leftmost(BtreeCheckState *state,
 							 BtreeLevel level);
 static void bt_target_page_check(BtreeCheckState *state);
-static ScanKey bt_right_page_check_scankey(BtreeCheckState *state);
+static ScanKey bt_right_page_check_scankey(BtreeCheckState *state,
+							int *keysz);
 static void bt_downlink_check(BtreeCheckState *state, BlockNumber childblock,
-				  ScanKey targetkey);
+				  ScanKey targetkey, int targetkeysz);
 static inline bool offset_is_negative_infinity(BTPageOpaque opaque,
 							OffsetNumber offset);
 static inline bool invariant_leq_offset(BtreeCheckState *state,
-					 ScanKey key,
+					 ScanKey key, int keysz,
 					 OffsetNumber upperbound);
 static inline bool invariant_geq_offset(BtreeCheckState *state,
-					 ScanKey key,
+					 ScanKey key, int keysz,
 					 OffsetNumber lowerbound);
 static inline bool invariant_leq_nontarget_offset(BtreeCheckState *state,
 							   Page other,
-							   ScanKey key,
+							   ScanKey key, int keysz,
 							   OffsetNumber upperbound);
 static Page palloc_btree_page(BtreeCheckState *state, BlockNumber blocknum);
 
@@ -574,6 +575,7 @@ bt_target_page_check(BtreeCheckState *state)
 		ItemId		itemid;
 		IndexTuple	itup;
 		ScanKey		skey;
+		int			skeysz;
 
 		CHECK_FOR_INTERRUPTS();
 
@@ -588,6 +590,7 @@ bt_target_page_check(BtreeCheckState *state)
 		itemid = PageGetItemId(state->target, offset);
 		itup = (IndexTuple) PageGetItem(state->target, itemid);
 		skey = _bt_mkscankey(state->rel, itup);
+		skeysz = BTreeTupleGetNAtts(itup, state->rel);
 
 		/*
 		 * * High key check *
@@ -610,7 +613,7 @@ bt_target_page_check(BtreeCheckState *state)
 		 * and probably not markedly more effective in practice.
 		 */
 		if (!P_RIGHTMOST(topaque) &&
-			!invariant_leq_offset(state, skey, P_HIKEY))
+			!invariant_leq_offset(state, skey, skeysz, P_HIKEY))
 		{
 			char	   *itid,
 					   *htid;
@@ -639,7 +642,7 @@ bt_target_page_check(BtreeCheckState *state)
 		 * current item is less than or equal to next item (if any).
 		 */
 		if (OffsetNumberNext(offset) <= max &&
-			!invariant_leq_offset(state, skey,
+			!invariant_leq_offset(state, skey, skeysz,
 								  OffsetNumberNext(offset)))
 		{
 			char	   *itid,
@@ -696,12 +699,13 @@ bt_target_page_check(BtreeCheckState *state)
 		else if (offset == max)
 		{
 			ScanKey		rightkey;
+			int			rightkeysz;
 
 			/* Get item in next/right page */
-			rightkey = bt_right_page_check_scankey(state);
+			rightkey = bt_right_page_check_scankey(state, &rightkeysz);
 
 			if (rightkey &&
-				!invariant_geq_offset(state, rightkey, max))
+				!invariant_geq_offset(state, rightkey, rightkeysz, max))
 			{
 				/*
 				 * As explained at length in bt_right_page_check_scankey(),
@@ -747,7 +751,7 @@ bt_target_page_check(BtreeCheckState *state)
 		{
 			BlockNumber childblock = ItemPointerGetBlockNumber(&(itup->t_tid));
 
-			bt_downlink_check(state, childblock, skey);
+			bt_downlink_check(state, childblock, skey, skeysz);
 		}
 	}
 }
@@ -766,13 +770,15 @@ bt_target_page_check(BtreeCheckState *state)
  * NULL instead.
  *
  * Note that !readonly callers must reverify that target page has not
- * been concurrently deleted.
+ * been concurrently deleted.  The number of attributes in the returned
+ * scankey is stored in *keysz.
  */
 static ScanKey
-bt_right_page_check_scankey(BtreeCheckState *state)
+bt_right_page_check_scankey(BtreeCheckState *state, int *keysz)
 {
 	BTPageOpaque opaque;
 	ItemId		rightitem;
+	IndexTuple	firstitup;
 	BlockNumber targetnext;
 	Page		rightpage;
 	OffsetNumber nline;
@@ -960,8 +966,9 @@ bt_right_page_check_scankey(BtreeCheckState *state)
 	 * Return first real item scankey.  Note that this relies on right page
 	 * memory remaining allocated.
 	 */
-	return _bt_mkscankey(state->rel,
-						 (IndexTuple) PageGetItem(rightpage, rightitem));
+	firstitup = (IndexTuple) PageGetItem(rightpage, rightitem);
+	*keysz = BTreeTupleGetNAtts(firstitup, state->rel);
+	return _bt_mkscankey(state->rel, firstitup);
 }
 
 /*
@@ -975,7 +982,7 @@ bt_right_page_check_scankey(BtreeCheckState *state)
  */
 static void
 bt_downlink_check(BtreeCheckState *state, BlockNumber childblock,
-				  ScanKey targetkey)
+				  ScanKey targetkey, int targetkeysz)
 {
 	OffsetNumber offset;
 	OffsetNumber maxoffset;
@@ -1047,7 +1054,7 @@ bt_downlink_check(BtreeCheckState *state, BlockNumber childblock,
 			continue;
 
 		if (!invariant_leq_nontarget_offset(state, child,
-											targetkey, offset))
+											targetkey, targetkeysz, offset))
 			ereport(ERROR,
 					(errcode(ERRCODE_INDEX_CORRUPTED),
 					 errmsg("down-link lower bound invariant violated for index \"%s\"",
@@ -1101,13 +1108,12 @@ offset_is_negative_infinity(BTPageOpaque opaque, OffsetNumber offset)
  * to corruption.
  */
 static inline bool
-invariant_leq_offset(BtreeCheckState *state, ScanKey key,
+invariant_leq_offset(BtreeCheckState *state, ScanKey key, int keysz,
 					 OffsetNumber upperbound)
 {
-	int16		natts = state->rel->rd_rel->relnatts;
 	int32		cmp;
 
-	cmp = _bt_compare(state->rel, natts, key, state->target, upperbound);
+	cmp = _bt_compare(state->rel, keysz, key, state->target, upperbound);
 
 	return cmp <= 0;
 }
@@ -1120,13 +1126,12 @@ invariant_leq_offset(BtreeCheckState *state, ScanKey key,
  * to corruption.
  */
 static inline bool
-invariant_geq_offset(BtreeCheckState *state, ScanKey key,
+invariant_geq_offset(BtreeCheckState *state, ScanKey key, int keysz,
 					 OffsetNumber lowerbound)
 {
-	int16		natts = state->rel->rd_rel->relnatts;
 	int32		cmp;
 
-	cmp = _bt_compare(state->rel, natts, key, state->target, lowerbound);
+	cmp = _bt_compare(state->rel, keysz, key, state->target, lowerbound);
 
 	return cmp >= 0;
 }
@@ -1143,13 +1148,12 @@ invariant_geq_offset(BtreeCheckState *state, ScanKey key,
  */
 static inline bool
 invariant_leq_nontarget_offset(BtreeCheckState *state,
-							   Page nontarget, ScanKey key,
+							   Page nontarget, ScanKey key, int keysz,
 							   OffsetNumber upperbound)
 {
-	int16		natts = state->rel->rd_rel->relnatts;
 	int32		cmp;
 
-	cmp = _bt_compare(state->rel, natts, key, nontarget, upperbound);
+	cmp = _bt_compare(state->rel, keysz, key, nontarget, upperbound);
 
 	return cmp <= 0;
 }
@@ -0,0 +1,363 @@
+/*-------------------------------------------------------------------------
+ *
+ * idp_join.c
+ *	  Deterministic join order search using iterative dynamic programming
+ *
+ * The standard join search builds every feasible join relation, level by
+ * level, which takes exponential time and memory as the number of relations
+ * grows.  GEQO, used above geqo_threshold, is cheaper but randomized, so the
+ * chosen plan may differ considerably for small changes of the query.
+ *
+ * This module implements the "IDP1" algorithm of Kossmann and Stocker:
+ * instead of running the dynamic programming over all the relations at once,
+ * it only builds joins of up to idp_join.block_size relations, picks the
+ * cheapest of the largest joins built, and replaces the relations it
+ * consists of by that join.  This is repeated until few enough relations
+ * remain to be joined by a single round of dynamic programming.
+ *
+ * Each round of the search is done in a temporary memory context, which is
+ * released once the join to keep has been chosen, so the planning time and
+ * memory are bounded by what is needed to plan joins of block_size
+ * relations, times the number of rounds.
+ *
+ * Copyright (c) 2017, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/idp_join/idp_join.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <limits.h>
+
+#include "optimizer/geqo.h"
+#include "optimizer/pathnode.h"
+#include "optimizer/paths.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+
+PG_MODULE_MAGIC;
+
+/* GUC variables */
+static int	idp_join_threshold = 12;
+static int	idp_join_block_size = 4;
+
+/* Saved hook value in case of unload */
+static join_search_hook_type prev_join_search_hook = NULL;
+
+void		_PG_init(void);
+void		_PG_fini(void);
+
+static RelOptInfo *idp_join_search(PlannerInfo *root, int levels_needed,
+				List *initial_rels);
+static List **idp_search_levels(PlannerInfo *root, List *units, int levels);
+static RelOptInfo *idp_choose_join(PlannerInfo *root, List *units,
+				int levels);
+static RelOptInfo *idp_search(PlannerInfo *root, List *initial_rels);
+
+
+/*
+ * Module load callback
+ */
+void
+_PG_init(void)
+{
+	/* Define custom GUC variables. */
+	DefineCustomIntVariable("idp_join.threshold",
+							"Sets the threshold of FROM items beyond which "
+							"iterative dynamic programming is used.",
+							NULL,
+							&idp_join_threshold,
+							12,
+							2, INT_MAX,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("idp_join.block_size",
+							"Sets the largest number of FROM items joined in "
+							"each round of dynamic programming.",
+							NULL,
+							&idp_join_block_size,
+							4,
+							2, 32,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	EmitWarningsOnPlaceholders("idp_join");
+
+	/* Install hook. */
+	prev_join_search_hook = join_search_hook;
+	join_search_hook = idp_join_search;
+}
+
+/*
+ * Module unload callback
+ */
+void
+_PG_fini(void)
+{
+	/* Uninstall hook. */
+	join_search_hook = prev_join_search_hook;
+}
+
+/*
+ * idp_search_levels
+ *	  Run the dynamic programming over 'units', up to joins of 'levels' units
+ *
+ * This is standard_join_search(), except that it stops at the given level
+ * and returns the join_rel_level[] array rather than the final rel, and the
+ * units may be join relations themselves.
+ */
+static List **
+idp_search_levels(PlannerInfo *root, List *units, int levels)
+{
+	List	  **join_rel_level;
+	int			lev;
+
+	Assert(root->join_rel_level == NULL);
+
+	join_rel_level = (List **) palloc0((levels + 1) * sizeof(List *));
+	join_rel_level[1] = units;
+	root->join_rel_level = join_rel_level;
+
+	for (lev = 2; lev <= levels; lev++)
+	{
+		ListCell   *lc;
+
+		join_search_one_level(root, lev);
+
+		foreach(lc, join_rel_level[lev])
+		{
+			RelOptInfo *rel = (RelOptInfo *) lfirst(lc);
+
+			/* Create paths for partition-wise joins. */
+			generate_partition_wise_join_paths(root, rel);
+
+			/* Create GatherPaths for any useful partial paths for rel */
+			generate_gather_paths(root, rel);
+
+			/* Find and save the cheapest paths for this rel */
+			set_cheapest(rel);
+		}
+	}
+
+	root->join_rel_level = NULL;
+
+	return join_rel_level;
+}
+
+/*
+ * idp_choose_join
+ *	  Do one round of the search, and build the join it chooses
+ *
+ * We plan all the joins of up to 'levels' of the units, and choose the
+ * cheapest join among those of the highest level we managed to build (with
+ * special joins there may be no legal joins of some sizes).  Everything
+ * built in the process is thrown away, except the relids of the chosen
+ * join, and then we build the chosen join again (together with the joins
+ * of its subsets) in the caller's memory context.
+ *
+ * Returns NULL if no joins at all could be built.
+ */
+static RelOptInfo *
+idp_choose_join(PlannerInfo *root, List *units, int levels)
+{
+	MemoryContext roundcxt;
+	MemoryContext oldcxt;
+	int			savelength;
+	struct HTAB *savehash;
+	List	  **join_rel_level;
+	Relids		chosen = NULL;
+	List	   *members = NIL;
+	ListCell   *lc;
+	int			lev;
+
+	roundcxt = AllocSetContextCreate(CurrentMemoryContext,
+									 "IDP join search round",
+									 ALLOCSET_DEFAULT_SIZES);
+
+	/*
+	 * As in geqo_eval(), the new join rels are appended to join_rel_list and
+	 * will be released with the memory context, so truncate the list to its
+	 * original length afterwards, and don't let them into the outer hash.
+	 */
+	savelength = list_length(root->join_rel_list);
+	savehash = root->join_rel_hash;
+	root->join_rel_hash = NULL;
+
+	oldcxt = MemoryContextSwitchTo(roundcxt);
+
+	join_rel_level = idp_search_levels(root, units, levels);
+
+	for (lev = levels; lev >= 2 && chosen == NULL; lev--)
+	{
+		RelOptInfo *best = NULL;
+
+		foreach(lc, join_rel_level[lev])
+		{
+			RelOptInfo *rel = (RelOptInfo *) lfirst(lc);
+
+			if (best == NULL ||
+				rel->cheapest_total_path->total_cost <
+				best->cheapest_total_path->total_cost)
+				best = rel;
+		}
+
+		if (best != NULL)
+		{
+			MemoryContextSwitchTo(oldcxt);
+			chosen = bms_copy(best->relids);
+			MemoryContextSwitchTo(roundcxt);
+		}
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	root->join_rel_list = list_truncate(root->join_rel_list, savelength);
+	root->join_rel_hash = savehash;
+
+	MemoryContextDelete(roundcxt);
+
+	if (chosen == NULL)
+		return NULL;
+
+	/* now build the chosen join for real */
+	foreach(lc, units)
+	{
+		RelOptInfo *rel = (RelOptInfo *) lfirst(lc);
+
+		if (bms_is_subset(rel->relids, chosen))
+			members = lappend(members, rel);
+	}
+
+	join_rel_level = idp_search_levels(root, members, list_length(members));
+	if (join_rel_level[list_length(members)] == NIL)
+		elog(ERROR, "failed to build any %d-way joins", list_length(members));
+	Assert(list_length(join_rel_level[list_length(members)]) == 1);
+
+	return (RelOptInfo *) linitial(join_rel_level[list_length(members)]);
+}
+
+/*
+ * idp_search
+ *	  Find a join order using iterative dynamic programming
+ *
+ * Returns NULL if joining the units chosen in the earlier rounds leaves no
+ * legal way to continue, as can happen with special join constraints.
+ */
+static RelOptInfo *
+idp_search(PlannerInfo *root, List *initial_rels)
+{
+	MemoryContext searchcxt;
+	MemoryContext oldcxt;
+	int			savelength;
+	struct HTAB *savehash;
+	List	   *units = initial_rels;
+	RelOptInfo *result = NULL;
+
+	/*
+	 * Everything we keep from the rounds of the search lives in a context of
+	 * its own, so that it can be released if we have to fall back to one of
+	 * the other join search methods.
+	 */
+	searchcxt = AllocSetContextCreate(CurrentMemoryContext,
+									  "IDP join search",
+									  ALLOCSET_DEFAULT_SIZES);
+	savelength = list_length(root->join_rel_list);
+	savehash = root->join_rel_hash;
+	root->join_rel_hash = NULL;
+
+	oldcxt = MemoryContextSwitchTo(searchcxt);
+
+	while (list_length(units) > idp_join_block_size)
+	{
+		RelOptInfo *joinrel;
+		List	   *newunits = NIL;
+		bool		placed = false;
+		ListCell   *lc;
+
+		/* has_legal_joinclause() looks at the units being joined */
+		root->initial_rels = units;
+
+		joinrel = idp_choose_join(root, units, idp_join_block_size);
+		if (joinrel == NULL)
+			break;
+
+		/*
+		 * Replace the units the join consists of by the join, placing it
+		 * where the first of them was, so that the result only depends on
+		 * the order of the FROM items.
+		 */
+		foreach(lc, units)
+		{
+			RelOptInfo *rel = (RelOptInfo *) lfirst(lc);
+
+			if (!bms_is_subset(rel->relids, joinrel->relids))
+				newunits = lappend(newunits, rel);
+			else if (!placed)
+			{
+				newunits = lappend(newunits, joinrel);
+				placed = true;
+			}
+		}
+		units = newunits;
+	}
+
+	/* join the remaining units using a single round */
+	if (list_length(units) <= idp_join_block_size)
+	{
+		List	  **join_rel_level;
+		int			levels = list_length(units);
+
+		root->initial_rels = units;
+		join_rel_level = idp_search_levels(root, units, levels);
+		if (join_rel_level[levels] != NIL)
+			result = (RelOptInfo *) linitial(join_rel_level[levels]);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+	root->initial_rels = initial_rels;
+
+	if (result == NULL)
+	{
+		/* discard everything we built */
+		root->join_rel_list = list_truncate(root->join_rel_list, savelength);
+		root->join_rel_hash = savehash;
+		MemoryContextDelete(searchcxt);
+	}
+
+	return result;
+}
+
+/*
+ * idp_join_search
+ *	  join_search_hook implementing iterative dynamic programming
+ *
+ * Queries with fewer than idp_join.threshold FROM items are passed on to the
+ * next hook, or the core planner, and so are those idp_search() fails on.
+ */
+static RelOptInfo *
+idp_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
+{
+	if (levels_needed >= idp_join_threshold)
+	{
+		RelOptInfo *result = idp_search(root, initial_rels);
+
+		if (result != NULL)
+			return result;
+	}
+
+	if (prev_join_search_hook)
+		return (*prev_join_search_hook) (root, levels_needed, initial_rels);
+	else if (enable_geqo && levels_needed >= geqo_threshold)
+		return geqo(root, levels_needed, initial_rels);
+	else
+		return standard_join_search(root, levels_needed, initial_rels);
+}
@@ -0,0 +1,123 @@
+LOAD 'idp_join';
+
+-- use the iterative search even for small joins, in rounds of three
+SET idp_join.threshold = 2;
+SET idp_join.block_size = 3;
+
+CREATE TABLE idp1 AS SELECT i AS id FROM generate_series(1, 100) i;
+CREATE TABLE idp2 AS SELECT * FROM idp1;
+CREATE TABLE idp3 AS SELECT * FROM idp1;
+CREATE TABLE idp4 AS SELECT * FROM idp1;
+CREATE TABLE idp5 AS SELECT * FROM idp1;
+CREATE TABLE idp6 AS SELECT * FROM idp1;
+CREATE TABLE idp7 AS SELECT * FROM idp1;
+CREATE TABLE idp8 AS SELECT * FROM idp1;
+CREATE TABLE idp_half AS SELECT id FROM idp1 WHERE id <= 50;
+ANALYZE idp1;
+ANALYZE idp2;
+ANALYZE idp3;
+ANALYZE idp4;
+ANALYZE idp5;
+ANALYZE idp6;
+ANALYZE idp7;
+ANALYZE idp8;
+ANALYZE idp_half;
+
+-- chain of inner joins
+SELECT count(*)
+  FROM idp1, idp2, idp3, idp4, idp5, idp6, idp7, idp8
+ WHERE idp1.id = idp2.id AND idp2.id = idp3.id AND idp3.id = idp4.id
+   AND idp4.id = idp5.id AND idp5.id = idp6.id AND idp6.id = idp7.id
+   AND idp7.id = idp8.id;
+
+-- star of inner joins
+SELECT count(*)
+  FROM idp1, idp2, idp3, idp4, idp5, idp6, idp7, idp8
+ WHERE idp1.id = idp2.id AND idp1.id = idp3.id AND idp1.id = idp4.id
+   AND idp1.id = idp5.id AND idp1.id = idp6.id AND idp1.id = idp7.id
+   AND idp1.id = idp8.id AND idp8.id < 11;
+
+-- outer and semi joins constrain the join order
+SELECT count(*), count(idp_half.id)
+  FROM idp1
+  JOIN idp2 ON idp1.id = idp2.id
+  JOIN idp3 ON idp2.id = idp3.id
+  LEFT JOIN idp_half ON idp3.id = idp_half.id
+  JOIN idp4 ON idp1.id = idp4.id
+  JOIN idp5 ON idp4.id = idp5.id
+ WHERE idp5.id IN (SELECT id FROM idp6 WHERE id % 2 = 0);
+
+SELECT count(*)
+  FROM idp1
+  JOIN idp2 ON idp1.id = idp2.id
+  FULL JOIN idp_half ON idp2.id = idp_half.id
+  JOIN idp3 ON idp1.id = idp3.id
+  JOIN idp4 ON idp3.id = idp4.id
+ WHERE NOT EXISTS (SELECT 1 FROM idp5 WHERE idp5.id = idp4.id + 90);
+
+-- the block size bounds the part of the join order searched at once: in
+-- rounds of two, the search commits to the cheapest pair of tables first and
+-- ends up with a left-deep plan, while a single round of four finds the same
+-- bushy plan as the standard search
+CREATE TABLE idp_big1 AS SELECT i AS a, i % 10 AS b FROM generate_series(1, 10000) i;
+CREATE TABLE idp_big2 AS SELECT * FROM idp_big1;
+CREATE TABLE idp_mid AS SELECT i AS a, i % 100 AS b FROM generate_series(1, 1000) i;
+CREATE TABLE idp_small AS SELECT i AS a FROM generate_series(1, 10) i;
+ANALYZE idp_big1;
+ANALYZE idp_big2;
+ANALYZE idp_mid;
+ANALYZE idp_small;
+
+SET idp_join.block_size = 2;
+EXPLAIN (COSTS OFF)
+SELECT count(*)
+  FROM idp_big1, idp_big2, idp_mid, idp_small
+ WHERE idp_big1.b = idp_big2.b AND idp_big2.a = idp_mid.a
+   AND idp_mid.b = idp_small.a AND idp_big1.a = idp_small.a;
+
+SET idp_join.block_size = 4;
+EXPLAIN (COSTS OFF)
+SELECT count(*)
+  FROM idp_big1, idp_big2, idp_mid, idp_small
+ WHERE idp_big1.b = idp_big2.b AND idp_big2.a = idp_mid.a
+   AND idp_mid.b = idp_small.a AND idp_big1.a = idp_small.a;
+
+-- below the threshold, the standard search is used whatever the block size
+SET idp_join.block_size = 2;
+SET idp_join.threshold = 5;
+EXPLAIN (COSTS OFF)
+SELECT count(*)
+  FROM idp_big1, idp_big2, idp_mid, idp_small
+ WHERE idp_big1.b = idp_big2.b AND idp_big2.a = idp_mid.a
+   AND idp_mid.b = idp_small.a AND idp_big1.a = idp_small.a;
+
+SET idp_join.threshold = 2;
+SET idp_join.block_size = 3;
+DROP TABLE idp_big1, idp_big2, idp_mid, idp_small;
+
+-- the chosen plan does not change from one planning to the next
+CREATE FUNCTION plan_of(query text) RETURNS text
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+    result text := '';
+BEGIN
+    FOR ln IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query
+    LOOP
+        result := result || ln || E'\n';
+    END LOOP;
+    RETURN result;
+END;
+$$;
+
+SELECT count(DISTINCT plan_of($$
+SELECT *
+  FROM idp1, idp2, idp3, idp4, idp5, idp6, idp7, idp8
+ WHERE idp1.id = idp2.id AND idp2.id = idp3.id AND idp3.id = idp4.id
+   AND idp4.id = idp5.id AND idp5.id = idp6.id AND idp6.id = idp7.id
+   AND idp7.id = idp8.id
+$$)) FROM generate_series(1, 5);
+
+DROP FUNCTION plan_of(text);
+DROP TABLE idp1, idp2, idp3, idp4, idp5, idp6, idp7, idp8, idp_half;
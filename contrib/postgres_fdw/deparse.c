@@ -119,6 +119,7 @@ typedef struct deparse_expr_cxt
 static bool foreign_expr_walker(Node *node,
 					foreign_glob_cxt *glob_cxt,
 					foreign_loc_cxt *outer_cxt);
+static bool partial_agg_ok(Aggref *agg);
 static char *deparse_type_name(Oid type_oid, int32 typemod);
 
 /*
@@ -680,8 +681,13 @@ foreign_expr_walker(Node *node,
 				if (!IS_UPPER_REL(glob_cxt->foreignrel))
 					return false;
 
-				/* Only non-split aggregates are pushable. */
-				if (agg->aggsplit != AGGSPLIT_SIMPLE)
+				/*
+				 * Only non-split aggregates are pushable, plus the partial
+				 * aggregates the remote server can compute for us.
+				 */
+				if (agg->aggsplit != AGGSPLIT_SIMPLE &&
+					!(agg->aggsplit == AGGSPLIT_INITIAL_SERIAL &&
+					  partial_agg_ok(agg)))
 					return false;
 
 				/* As usual, it must be shippable. */
@@ -836,6 +842,33 @@ foreign_expr_walker(Node *node,
 	return true;
 }
 
+/*
+ * Check whether the remote server can compute a partial aggregate.
+ *
+ * We only know how to ask the remote server for an aggregate's final value,
+ * which is its transition state if it has no final function.  The state must
+ * not be of type internal, which would have to be serialized.
+ */
+static bool
+partial_agg_ok(Aggref *agg)
+{
+	HeapTuple	aggtup;
+	Form_pg_aggregate aggform;
+	bool		result;
+
+	aggtup = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(agg->aggfnoid));
+	if (!HeapTupleIsValid(aggtup))
+		elog(ERROR, "cache lookup failed for aggregate %u", agg->aggfnoid);
+	aggform = (Form_pg_aggregate) GETSTRUCT(aggtup);
+
+	result = (!OidIsValid(aggform->aggfinalfn) &&
+			  aggform->aggtranstype != INTERNALOID);
+
+	ReleaseSysCache(aggtup);
+
+	return result;
+}
+
 /*
  * Convert type OID + typmod info into a type name we can ship to the remote
  * server.  Someplace else had better have verified that this type name is
@@ -1539,13 +1572,15 @@ deparseRangeTblRef(StringInfo buf, PlannerInfo *root, RelOptInfo *foreignrel,
  *
  * The statement text is appended to buf, and we also create an integer List
  * of the columns being retrieved by RETURNING (if any), which is returned
- * to *retrieved_attrs.
+ * to *retrieved_attrs.  The length of the statement up to the end of its
+ * VALUES clause is returned to *values_end_len, for rebuildInsertSql.
  */
 void
 deparseInsertSql(StringInfo buf, PlannerInfo *root,
 				 Index rtindex, Relation rel,
 				 List *targetAttrs, bool doNothing,
-				 List *returningList, List **retrieved_attrs)
+				 List *returningList, List **retrieved_attrs,
+				 int *values_end_len)
 {
 	AttrNumber	pindex;
 	bool		first;
@@ -1588,6 +1623,7 @@ deparseInsertSql(StringInfo buf, PlannerInfo *root,
 	}
 	else
 		appendStringInfoString(buf, " DEFAULT VALUES");
+	*values_end_len = buf->len;
 
 	if (doNothing)
 		appendStringInfoString(buf, " ON CONFLICT DO NOTHING");
@@ -1597,6 +1633,54 @@ deparseInsertSql(StringInfo buf, PlannerInfo *root,
 						 returningList, retrieved_attrs);
 }
 
+/*
+ * rebuild remote INSERT statement
+ *
+ * Given the text of an INSERT statement built by deparseInsertSql for a
+ * single row, build one that inserts num_rows rows, with the parameters of
+ * each row numbered after those of the previous row.  values_end_len is the
+ * length of the statement up to the end of the first row of its VALUES
+ * clause.
+ */
+void
+rebuildInsertSql(StringInfo buf, char *orig_query,
+				 int values_end_len, int num_cols, int num_rows)
+{
+	int			i;
+	int			j;
+	int			pindex;
+	bool		first;
+
+	/* Make sure the values_end_len is sensible */
+	Assert(values_end_len > 0 && values_end_len <= strlen(orig_query));
+
+	/* Copy up to the end of the first row from the original query */
+	appendBinaryStringInfo(buf, orig_query, values_end_len);
+
+	/* Add the remaining rows to the VALUES clause */
+	pindex = num_cols + 1;
+	for (i = 1; i < num_rows; i++)
+	{
+		appendStringInfoString(buf, ", (");
+
+		first = true;
+		for (j = 0; j < num_cols; j++)
+		{
+			if (!first)
+				appendStringInfoString(buf, ", ");
+			first = false;
+
+			appendStringInfo(buf, "$%d", pindex);
+			pindex++;
+		}
+
+		appendStringInfoChar(buf, ')');
+	}
+
+	/* Copy whatever follows the VALUES clause in the original query */
+	appendStringInfoString(buf, orig_query + values_end_len);
+}
+
 /*
  * deparse remote UPDATE statement
  *
@@ -2745,8 +2829,12 @@ deparseAggref(Aggref *node, deparse_expr_cxt *context)
 	StringInfo	buf = context->buf;
 	bool		use_variadic;
 
-	/* Only basic, non-split aggregation accepted. */
-	Assert(node->aggsplit == AGGSPLIT_SIMPLE);
+	/*
+	 * Only basic, non-split aggregation accepted, or partial aggregation of
+	 * aggregates whose final value is their transition state.
+	 */
+	Assert(node->aggsplit == AGGSPLIT_SIMPLE ||
+		   node->aggsplit == AGGSPLIT_INITIAL_SERIAL);
 
 	/* Check if need to print VARIADIC (cf. ruleutils.c) */
 	use_variadic = node->aggvariadic;
@@ -0,0 +1,394 @@
+/*
+ * brin_bloom.c
+ *		Implementation of Bloom opclass for BRIN
+ *
+ * Each page range is summarized by a bloom filter built over the hashes of
+ * all the values in the range.  Unlike minmax, this only supports equality
+ * searches, but it keeps working when the values are not correlated with
+ * the physical position of the rows, where a [min, max] interval would
+ * quickly degenerate to cover the whole domain.
+ *
+ * The filter is stored as a single bytea value.  Its size is derived from
+ * the pages_per_range of the index: we assume that up to 10% of the tuples
+ * that fit in a range are distinct and aim for a 1% false positive rate,
+ * but never let the filter grow beyond BLOOM_MAX_BYTES so that the index
+ * tuple still fits comfortably on a page.  When the filter is capped the
+ * false positive rate simply goes up; the scan remains correct.
+ *
+ * The hash of a value is obtained with the type's hash function (support
+ * procedure BLOOM_PROCNUM_HASH), and the individual bit positions are then
+ * derived using double hashing.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/brin/brin_bloom.c
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/brin.h"
+#include "access/brin_internal.h"
+#include "access/brin_tuple.h"
+#include "access/genam.h"
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "access/stratnum.h"
+#include "catalog/pg_type.h"
+#include "utils/builtins.h"
+#include "utils/rel.h"
+
+
+/* support procedure returning the hash of a value */
+#define BLOOM_PROCNUM_HASH			11
+
+/* the only supported strategy */
+#define BloomEqualStrategyNumber	1
+
+/* parameters used to size the filter */
+#define BLOOM_NDISTINCT_FRACTION	0.1
+#define BLOOM_MIN_NDISTINCT			16
+#define BLOOM_FALSE_POSITIVE_RATE	0.01
+#define BLOOM_MIN_BYTES				64
+#define BLOOM_MAX_BYTES				(BLCKSZ / 4)
+#define BLOOM_MAX_HASHES			16
+
+/* seeds used to derive the two independent hashes */
+#define BLOOM_SEED_1	0x71d924af
+#define BLOOM_SEED_2	0xba48b314
+
+/*
+ * On-disk representation of the bloom filter.  It's a plain varlena, so
+ * that it can be stored as a bytea.
+ */
+typedef struct BloomFilter
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	uint16		nhashes;		/* number of hash functions */
+	uint16		flags;			/* currently unused */
+	uint32		nbits;			/* number of bits in the bitmap */
+	uint32		nbits_set;		/* number of bits set to 1 */
+	char		bitmap[FLEXIBLE_ARRAY_MEMBER];
+} BloomFilter;
+
+#define BloomFilterSize(nbits) \
+	(offsetof(BloomFilter, bitmap) + ((nbits) + 7) / 8)
+
+static BloomFilter *bloom_init(BrinDesc *bdesc);
+static bool bloom_add_hash(BloomFilter *filter, uint32 hash);
+static bool bloom_contains_hash(BloomFilter *filter, uint32 hash);
+static uint32 bloom_value_hash(BrinDesc *bdesc, AttrNumber attno,
+				 Oid colloid, Datum value);
+
+
+Datum
+brin_bloom_opcinfo(PG_FUNCTION_ARGS)
+{
+	BrinOpcInfo *result;
+
+	/*
+	 * The summary is a single bytea, regardless of the indexed type; the
+	 * hash support procedure is looked up on demand, since it depends on the
+	 * opfamily and not on anything we know here.
+	 */
+	result = palloc0(MAXALIGN(SizeofBrinOpcInfo(1)));
+	result->oi_nstored = 1;
+	result->oi_opaque = NULL;
+	result->oi_typcache[0] = lookup_type_cache(BYTEAOID, 0);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Examine the given index tuple (which contains partial status of a certain
+ * page range) and add the hash of the new value to its bloom filter.  Return
+ * true if the filter was modified.
+ */
+Datum
+brin_bloom_add_value(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	Datum		newval = PG_GETARG_DATUM(2);
+	bool		isnull = PG_GETARG_DATUM(3);
+	Oid			colloid = PG_GET_COLLATION();
+	BloomFilter *filter;
+	bool		updated = false;
+	uint32		hash;
+
+	/*
+	 * If the new value is null, we record that we saw it if it's the first
+	 * one; otherwise, there's nothing to do.
+	 */
+	if (isnull)
+	{
+		if (column->bv_hasnulls)
+			PG_RETURN_BOOL(false);
+
+		column->bv_hasnulls = true;
+		PG_RETURN_BOOL(true);
+	}
+
+	/* If the range was all nulls so far, start with an empty filter. */
+	if (column->bv_allnulls)
+	{
+		filter = bloom_init(bdesc);
+		column->bv_values[0] = PointerGetDatum(filter);
+		column->bv_allnulls = false;
+		updated = true;
+	}
+	else
+	{
+		/*
+		 * The filter is modified in place, so make sure we have a plain
+		 * (non-short-header) copy of it.
+		 */
+		filter = (BloomFilter *) PG_DETOAST_DATUM(column->bv_values[0]);
+		column->bv_values[0] = PointerGetDatum(filter);
+	}
+
+	hash = bloom_value_hash(bdesc, column->bv_attno, colloid, newval);
+	updated |= bloom_add_hash(filter, hash);
+
+	PG_RETURN_BOOL(updated);
+}
+
+/*
+ * Given an index tuple corresponding to a certain page range and a scan key,
+ * return whether the scan key may match some value in the range, according to
+ * the bloom filter.  Return true if so, false otherwise.
+ */
+Datum
+brin_bloom_consistent(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey		key = (ScanKey) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION();
+	BloomFilter *filter;
+	uint32		hash;
+
+	Assert(key->sk_attno == column->bv_attno);
+
+	/* handle IS NULL/IS NOT NULL tests */
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (key->sk_flags & SK_SEARCHNULL)
+		{
+			if (column->bv_allnulls || column->bv_hasnulls)
+				PG_RETURN_BOOL(true);
+			PG_RETURN_BOOL(false);
+		}
+
+		/*
+		 * For IS NOT NULL, we can only skip ranges that are known to have
+		 * only nulls.
+		 */
+		if (key->sk_flags & SK_SEARCHNOTNULL)
+			PG_RETURN_BOOL(!column->bv_allnulls);
+
+		/*
+		 * Neither IS NULL nor IS NOT NULL was used; assume all indexable
+		 * operators are strict and return false.
+		 */
+		PG_RETURN_BOOL(false);
+	}
+
+	/* if the range is all empty, it cannot possibly be consistent */
+	if (column->bv_allnulls)
+		PG_RETURN_BOOL(false);
+
+	filter = (BloomFilter *) PG_DETOAST_DATUM(column->bv_values[0]);
+
+	switch (key->sk_strategy)
+	{
+		case BloomEqualStrategyNumber:
+			hash = bloom_value_hash(bdesc, key->sk_attno, colloid,
+									key->sk_argument);
+			PG_RETURN_BOOL(bloom_contains_hash(filter, hash));
+		default:
+			/* shouldn't happen */
+			elog(ERROR, "invalid strategy number %d", key->sk_strategy);
+			break;
+	}
+
+	PG_RETURN_BOOL(false);
+}
+
+/*
+ * Given two BrinValues, update the first of them as a union of the summary
+ * values contained in both.  The second one is untouched.
+ */
+Datum
+brin_bloom_union(PG_FUNCTION_ARGS)
+{
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	BloomFilter *filter_a;
+	BloomFilter *filter_b;
+	uint32		nbytes;
+	uint32		i;
+
+	Assert(col_a->bv_attno == col_b->bv_attno);
+
+	/* Adjust "hasnulls" */
+	if (!col_a->bv_hasnulls && col_b->bv_hasnulls)
+		col_a->bv_hasnulls = true;
+
+	/* If there are no values in B, there's nothing left to do */
+	if (col_b->bv_allnulls)
+		PG_RETURN_VOID();
+
+	filter_b = (BloomFilter *) PG_DETOAST_DATUM(col_b->bv_values[0]);
+
+	/*
+	 * Adjust "allnulls".  If A doesn't have values, just copy the filter from
+	 * B into A, and we're done.
+	 */
+	if (col_a->bv_allnulls)
+	{
+		filter_a = palloc(VARSIZE(filter_b));
+		memcpy(filter_a, filter_b, VARSIZE(filter_b));
+		col_a->bv_values[0] = PointerGetDatum(filter_a);
+		col_a->bv_allnulls = false;
+		PG_RETURN_VOID();
+	}
+
+	filter_a = (BloomFilter *) PG_DETOAST_DATUM(col_a->bv_values[0]);
+	col_a->bv_values[0] = PointerGetDatum(filter_a);
+
+	/* both filters were sized from the same index, so they must match */
+	if (filter_a->nbits != filter_b->nbits ||
+		filter_a->nhashes != filter_b->nhashes)
+		elog(ERROR, "incompatible bloom filters: %u/%u bits, %u/%u hashes",
+			 filter_a->nbits, filter_b->nbits,
+			 filter_a->nhashes, filter_b->nhashes);
+
+	nbytes = (filter_a->nbits + 7) / 8;
+	filter_a->nbits_set = 0;
+	for (i = 0; i < nbytes; i++)
+	{
+		uint8		byte;
+
+		filter_a->bitmap[i] |= filter_b->bitmap[i];
+
+		/* count the bits set, clearing the lowest one at a time */
+		for (byte = (uint8) filter_a->bitmap[i]; byte != 0; byte &= byte - 1)
+			filter_a->nbits_set++;
+	}
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Create an empty bloom filter, sized according to the pages_per_range of
+ * the index.
+ */
+static BloomFilter *
+bloom_init(BrinDesc *bdesc)
+{
+	BloomFilter *filter;
+	double		ndistinct;
+	double		nbits;
+	int			nhashes;
+	Size		len;
+
+	ndistinct = (double) MaxHeapTuplesPerPage *
+		BrinGetPagesPerRange(bdesc->bd_index) * BLOOM_NDISTINCT_FRACTION;
+	ndistinct = Max(ndistinct, BLOOM_MIN_NDISTINCT);
+
+	/* m = -n * ln(p) / (ln 2)^2, rounded up to whole bytes and clamped */
+	nbits = ceil(-(ndistinct * log(BLOOM_FALSE_POSITIVE_RATE)) /
+				 (M_LN2 * M_LN2));
+	nbits = Max(nbits, BLOOM_MIN_BYTES * 8);
+	nbits = Min(nbits, BLOOM_MAX_BYTES * 8);
+	nbits = ((int) nbits + 7) / 8 * 8;
+
+	/* k = (m / n) * ln 2, computed for the filter we actually got */
+	nhashes = (int) rint(nbits / ndistinct * M_LN2);
+	nhashes = Max(nhashes, 1);
+	nhashes = Min(nhashes, BLOOM_MAX_HASHES);
+
+	len = BloomFilterSize((uint32) nbits);
+	filter = (BloomFilter *) palloc0(len);
+	SET_VARSIZE(filter, len);
+	filter->nhashes = (uint16) nhashes;
+	filter->nbits = (uint32) nbits;
+
+	return filter;
+}
+
+/*
+ * Set the bits corresponding to the given hash; return true if any bit
+ * changed.
+ */
+static bool
+bloom_add_hash(BloomFilter *filter, uint32 hash)
+{
+	uint32		h1,
+				h2;
+	int			i;
+	bool		updated = false;
+
+	h1 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_1)) % filter->nbits;
+	h2 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_2)) % filter->nbits;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		uint32		bit = (h1 + (uint64) i * h2) % filter->nbits;
+		uint32		byte = bit / 8;
+		uint8		mask = 1 << (bit % 8);
+
+		if (!(filter->bitmap[byte] & mask))
+		{
+			filter->bitmap[byte] |= mask;
+			filter->nbits_set++;
+			updated = true;
+		}
+	}
+
+	return updated;
+}
+
+/*
+ * Return true if all the bits corresponding to the given hash are set.
+ */
+static bool
+bloom_contains_hash(BloomFilter *filter, uint32 hash)
+{
+	uint32		h1,
+				h2;
+	int			i;
+
+	/* an empty filter can't contain anything */
+	if (filter->nbits_set == 0)
+		return false;
+
+	h1 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_1)) % filter->nbits;
+	h2 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_2)) % filter->nbits;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		uint32		bit = (h1 + (uint64) i * h2) % filter->nbits;
+
+		if (!(filter->bitmap[bit / 8] & (1 << (bit % 8))))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Compute the hash of a value using the opfamily's hash support procedure.
+ */
+static uint32
+bloom_value_hash(BrinDesc *bdesc, AttrNumber attno, Oid colloid, Datum value)
+{
+	FmgrInfo   *hashFn;
+
+	hashFn = index_getprocinfo(bdesc->bd_index, attno, BLOOM_PROCNUM_HASH);
+
+	return DatumGetUInt32(FunctionCall1Coll(hashFn, colloid, value));
+}
@@ -0,0 +1,836 @@
+/*
+ * brin_minmax_multi.c
+ *		Implementation of Multi Min/Max opclass for BRIN
+ *
+ * Plain minmax summarizes each page range with a single [min, max] interval,
+ * which works well for data that is well correlated with the physical order
+ * of the table, but degrades quickly when a few outliers are present: a
+ * single out-of-order row is enough to make the interval cover most of the
+ * domain.  This opclass instead keeps a small sorted list of disjoint
+ * intervals per range, where an interval whose both ends are equal is stored
+ * as a single point.  When the list grows beyond MINMAX_MULTI_MAX_VALUES
+ * stored values, the intervals closest to each other (as measured by the
+ * opfamily's distance support procedure) are merged.
+ *
+ * The summary is stored as a single bytea value.  Only fixed-length types
+ * are supported, which is all the built-in opfamilies need.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/brin/brin_minmax_multi.c
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/genam.h"
+#include "access/brin_internal.h"
+#include "access/brin_tuple.h"
+#include "access/stratnum.h"
+#include "access/tupmacs.h"
+#include "catalog/pg_type.h"
+#include "catalog/pg_amop.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/syscache.h"
+#include "utils/timestamp.h"
+
+
+/* support procedure returning the distance between two values */
+#define MINMAX_MULTI_PROCNUM_DISTANCE	11
+
+/*
+ * Maximum number of values stored in a summary (an interval takes two, a
+ * single point one), and the number we compact down to once exceeded, so
+ * that we don't have to merge again on every insertion.
+ */
+#define MINMAX_MULTI_MAX_VALUES		32
+#define MINMAX_MULTI_TARGET_VALUES	(MINMAX_MULTI_MAX_VALUES / 2)
+
+typedef struct MinmaxMultiOpaque
+{
+	Oid			cached_subtype;
+	FmgrInfo	strategy_procinfos[BTMaxStrategyNumber];
+} MinmaxMultiOpaque;
+
+/*
+ * On-disk representation of the summary.  The intervals are stored in
+ * ascending order; for each of them a flag byte tells whether it's a single
+ * point, followed (at a MAXALIGN'ed offset) by the values themselves, each
+ * in a MAXALIGN'ed slot, so that they can be fetched in place.
+ */
+typedef struct SerializedRanges
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	int32		nranges;		/* number of intervals */
+	int32		nvalues;		/* number of stored values */
+	int16		typlen;			/* length of the stored values */
+	bool		typbyval;		/* are the values passed by value? */
+	char		data[FLEXIBLE_ARRAY_MEMBER];	/* flags, then values */
+} SerializedRanges;
+
+#define SerializedRangesValuesOffset(nranges) \
+	MAXALIGN(offsetof(SerializedRanges, data) + (nranges))
+
+/* In-memory representation of a single interval. */
+typedef struct MinmaxMultiRange
+{
+	Datum		minval;
+	Datum		maxval;
+	bool		single;			/* minval == maxval? */
+} MinmaxMultiRange;
+
+/* Gap between two adjacent intervals, used during compaction. */
+typedef struct MinmaxMultiGap
+{
+	int			index;			/* gap is between index and index + 1 */
+	double		distance;
+} MinmaxMultiGap;
+
+/* Context for sorting intervals by their minimum. */
+typedef struct MinmaxMultiSortContext
+{
+	FmgrInfo   *cmpFn;
+	Oid			colloid;
+} MinmaxMultiSortContext;
+
+static FmgrInfo *minmax_multi_get_strategy_procinfo(BrinDesc *bdesc,
+								   uint16 attno, Oid subtype,
+								   uint16 strategynum);
+static MinmaxMultiRange *ranges_deserialize(SerializedRanges *serialized,
+				  int *nranges);
+static SerializedRanges *ranges_serialize(Form_pg_attribute attr,
+				MinmaxMultiRange *ranges, int nranges);
+static int	ranges_compact(BrinDesc *bdesc, AttrNumber attno, Oid colloid,
+			  MinmaxMultiRange *ranges, int nranges);
+static int	ranges_nvalues(MinmaxMultiRange *ranges, int nranges);
+static int	compare_ranges(const void *a, const void *b, void *arg);
+static int	compare_gaps(const void *a, const void *b);
+
+
+Datum
+brin_minmax_multi_opcinfo(PG_FUNCTION_ARGS)
+{
+	BrinOpcInfo *result;
+
+	/*
+	 * opaque->strategy_procinfos is initialized lazily; here it is set to
+	 * all-uninitialized by palloc0 which sets fn_oid to InvalidOid.
+	 */
+
+	result = palloc0(MAXALIGN(SizeofBrinOpcInfo(1)) +
+					 sizeof(MinmaxMultiOpaque));
+	result->oi_nstored = 1;
+	result->oi_opaque = (MinmaxMultiOpaque *)
+		MAXALIGN((char *) result + SizeofBrinOpcInfo(1));
+	result->oi_typcache[0] = lookup_type_cache(BYTEAOID, 0);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Examine the given index tuple (which contains partial status of a certain
+ * page range) by comparing it to the given value that comes from another heap
+ * tuple.  If the new value is not covered by any of the intervals stored in
+ * the summary, add it as a new point (compacting the summary if needed) and
+ * return true.  Otherwise, return false and do not modify in this case.
+ */
+Datum
+brin_minmax_multi_add_value(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	Datum		newval = PG_GETARG_DATUM(2);
+	bool		isnull = PG_GETARG_DATUM(3);
+	Oid			colloid = PG_GET_COLLATION();
+	SerializedRanges *serialized;
+	MinmaxMultiRange *ranges;
+	int			nranges;
+	FmgrInfo   *cmpFn;
+	Form_pg_attribute attr;
+	AttrNumber	attno;
+	int			lo,
+				hi;
+
+	/*
+	 * If the new value is null, we record that we saw it if it's the first
+	 * one; otherwise, there's nothing to do.
+	 */
+	if (isnull)
+	{
+		if (column->bv_hasnulls)
+			PG_RETURN_BOOL(false);
+
+		column->bv_hasnulls = true;
+		PG_RETURN_BOOL(true);
+	}
+
+	attno = column->bv_attno;
+	attr = bdesc->bd_tupdesc->attrs[attno - 1];
+
+	/*
+	 * If the recorded value is null, store the new value as the only point
+	 * in the summary, and we're done.
+	 */
+	if (column->bv_allnulls)
+	{
+		MinmaxMultiRange range;
+
+		range.minval = range.maxval = newval;
+		range.single = true;
+		column->bv_values[0] = PointerGetDatum(ranges_serialize(attr,
+															   &range, 1));
+		column->bv_allnulls = false;
+		PG_RETURN_BOOL(true);
+	}
+
+	serialized = (SerializedRanges *) PG_DETOAST_DATUM(column->bv_values[0]);
+	ranges = ranges_deserialize(serialized, &nranges);
+
+	/*
+	 * Binary search for the first interval whose minimum is greater than the
+	 * new value; the value can only be covered by the one just before it.
+	 */
+	cmpFn = minmax_multi_get_strategy_procinfo(bdesc, attno, attr->atttypid,
+											   BTLessStrategyNumber);
+	lo = 0;
+	hi = nranges;
+	while (lo < hi)
+	{
+		int			mid = (lo + hi) / 2;
+
+		if (DatumGetBool(FunctionCall2Coll(cmpFn, colloid, newval,
+										   ranges[mid].minval)))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	if (lo > 0 &&
+		!DatumGetBool(FunctionCall2Coll(cmpFn, colloid,
+										ranges[lo - 1].maxval, newval)))
+	{
+		/* already covered, nothing to do */
+		pfree(ranges);
+		PG_RETURN_BOOL(false);
+	}
+
+	/* Insert the value as a new point at position "lo". */
+	ranges = repalloc(ranges, sizeof(MinmaxMultiRange) * (nranges + 1));
+	memmove(&ranges[lo + 1], &ranges[lo],
+			sizeof(MinmaxMultiRange) * (nranges - lo));
+	ranges[lo].minval = ranges[lo].maxval = newval;
+	ranges[lo].single = true;
+	nranges++;
+
+	if (ranges_nvalues(ranges, nranges) > MINMAX_MULTI_MAX_VALUES)
+		nranges = ranges_compact(bdesc, attno, colloid, ranges, nranges);
+
+	/*
+	 * The new summary may reference values within the old one, so only free
+	 * the old one once the new one is built.
+	 */
+	column->bv_values[0] = PointerGetDatum(ranges_serialize(attr, ranges,
+														   nranges));
+	pfree(ranges);
+	pfree(serialized);
+
+	PG_RETURN_BOOL(true);
+}
+
+/*
+ * Given an index tuple corresponding to a certain page range and a scan key,
+ * return whether the scan key is consistent with the intervals stored in the
+ * index tuple.  Return true if so, false otherwise.
+ */
+Datum
+brin_minmax_multi_consistent(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey		key = (ScanKey) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION(),
+				subtype;
+	AttrNumber	attno;
+	Datum		value;
+	Datum		matches;
+	FmgrInfo   *finfo;
+	SerializedRanges *serialized;
+	MinmaxMultiRange *ranges;
+	int			nranges;
+	int			i;
+
+	Assert(key->sk_attno == column->bv_attno);
+
+	/* handle IS NULL/IS NOT NULL tests */
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (key->sk_flags & SK_SEARCHNULL)
+		{
+			if (column->bv_allnulls || column->bv_hasnulls)
+				PG_RETURN_BOOL(true);
+			PG_RETURN_BOOL(false);
+		}
+
+		/*
+		 * For IS NOT NULL, we can only skip ranges that are known to have
+		 * only nulls.
+		 */
+		if (key->sk_flags & SK_SEARCHNOTNULL)
+			PG_RETURN_BOOL(!column->bv_allnulls);
+
+		/*
+		 * Neither IS NULL nor IS NOT NULL was used; assume all indexable
+		 * operators are strict and return false.
+		 */
+		PG_RETURN_BOOL(false);
+	}
+
+	/* if the range is all empty, it cannot possibly be consistent */
+	if (column->bv_allnulls)
+		PG_RETURN_BOOL(false);
+
+	serialized = (SerializedRanges *) PG_DETOAST_DATUM(column->bv_values[0]);
+	ranges = ranges_deserialize(serialized, &nranges);
+
+	attno = key->sk_attno;
+	subtype = key->sk_subtype;
+	value = key->sk_argument;
+	switch (key->sk_strategy)
+	{
+		case BTLessStrategyNumber:
+		case BTLessEqualStrategyNumber:
+			/* only the overall minimum matters */
+			finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+													   key->sk_strategy);
+			matches = FunctionCall2Coll(finfo, colloid, ranges[0].minval,
+										value);
+			break;
+		case BTEqualStrategyNumber:
+
+			/*
+			 * In the equality case (WHERE col = someval), we want to return
+			 * the current page range if any of the intervals contains the
+			 * scan key, that is min <= scan key and max >= scan key.  The
+			 * intervals are sorted, so we can stop as soon as we see one
+			 * whose minimum is above the scan key.
+			 */
+			matches = BoolGetDatum(false);
+			for (i = 0; i < nranges; i++)
+			{
+				finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+												  BTLessEqualStrategyNumber);
+				if (!DatumGetBool(FunctionCall2Coll(finfo, colloid,
+													ranges[i].minval, value)))
+					break;
+
+				finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+											   BTGreaterEqualStrategyNumber);
+				if (DatumGetBool(FunctionCall2Coll(finfo, colloid,
+												   ranges[i].maxval, value)))
+				{
+					matches = BoolGetDatum(true);
+					break;
+				}
+			}
+			break;
+		case BTGreaterEqualStrategyNumber:
+		case BTGreaterStrategyNumber:
+			/* only the overall maximum matters */
+			finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+													   key->sk_strategy);
+			matches = FunctionCall2Coll(finfo, colloid,
+										ranges[nranges - 1].maxval, value);
+			break;
+		default:
+			/* shouldn't happen */
+			elog(ERROR, "invalid strategy number %d", key->sk_strategy);
+			matches = 0;
+			break;
+	}
+
+	pfree(ranges);
+
+	PG_RETURN_DATUM(matches);
+}
+
+/*
+ * Given two BrinValues, update the first of them as a union of the summary
+ * values contained in both.  The second one is untouched.
+ */
+Datum
+brin_minmax_multi_union(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION();
+	AttrNumber	attno;
+	Form_pg_attribute attr;
+	SerializedRanges *serialized_a;
+	SerializedRanges *serialized_b;
+	MinmaxMultiRange *ranges_a;
+	MinmaxMultiRange *ranges_b;
+	MinmaxMultiRange *ranges;
+	int			nranges_a;
+	int			nranges_b;
+	int			nranges;
+	int			i;
+	MinmaxMultiSortContext cxt;
+
+	Assert(col_a->bv_attno == col_b->bv_attno);
+
+	/* Adjust "hasnulls" */
+	if (!col_a->bv_hasnulls && col_b->bv_hasnulls)
+		col_a->bv_hasnulls = true;
+
+	/* If there are no values in B, there's nothing left to do */
+	if (col_b->bv_allnulls)
+		PG_RETURN_VOID();
+
+	attno = col_a->bv_attno;
+	attr = bdesc->bd_tupdesc->attrs[attno - 1];
+
+	serialized_b = (SerializedRanges *) PG_DETOAST_DATUM(col_b->bv_values[0]);
+
+	/*
+	 * Adjust "allnulls".  If A doesn't have values, just copy the summary
+	 * from B into A, and we're done.
+	 */
+	if (col_a->bv_allnulls)
+	{
+		serialized_a = palloc(VARSIZE(serialized_b));
+		memcpy(serialized_a, serialized_b, VARSIZE(serialized_b));
+		col_a->bv_values[0] = PointerGetDatum(serialized_a);
+		col_a->bv_allnulls = false;
+		PG_RETURN_VOID();
+	}
+
+	serialized_a = (SerializedRanges *) PG_DETOAST_DATUM(col_a->bv_values[0]);
+	ranges_a = ranges_deserialize(serialized_a, &nranges_a);
+	ranges_b = ranges_deserialize(serialized_b, &nranges_b);
+
+	/* Put all the intervals together and sort them by their minimum. */
+	ranges = palloc(sizeof(MinmaxMultiRange) * (nranges_a + nranges_b));
+	memcpy(ranges, ranges_a, sizeof(MinmaxMultiRange) * nranges_a);
+	memcpy(&ranges[nranges_a], ranges_b,
+		   sizeof(MinmaxMultiRange) * nranges_b);
+
+	cxt.cmpFn = minmax_multi_get_strategy_procinfo(bdesc, attno,
+												   attr->atttypid,
+												   BTLessStrategyNumber);
+	cxt.colloid = colloid;
+	qsort_arg(ranges, nranges_a + nranges_b, sizeof(MinmaxMultiRange),
+			  compare_ranges, &cxt);
+
+	/*
+	 * Merge overlapping intervals.  Each input is disjoint by itself, so any
+	 * overlap is between an interval of A and one of B.
+	 */
+	nranges = 1;
+	for (i = 1; i < nranges_a + nranges_b; i++)
+	{
+		MinmaxMultiRange *last = &ranges[nranges - 1];
+
+		if (DatumGetBool(FunctionCall2Coll(cxt.cmpFn, colloid,
+										   last->maxval, ranges[i].minval)))
+		{
+			/* disjoint, keep it as a separate interval */
+			ranges[nranges++] = ranges[i];
+			continue;
+		}
+
+		/* overlapping, extend the last interval if needed */
+		if (DatumGetBool(FunctionCall2Coll(cxt.cmpFn, colloid,
+										   last->maxval, ranges[i].maxval)))
+		{
+			last->maxval = ranges[i].maxval;
+			last->single = false;
+		}
+	}
+
+	if (ranges_nvalues(ranges, nranges) > MINMAX_MULTI_MAX_VALUES)
+		nranges = ranges_compact(bdesc, attno, colloid, ranges, nranges);
+
+	col_a->bv_values[0] = PointerGetDatum(ranges_serialize(attr, ranges,
+														  nranges));
+
+	pfree(ranges);
+	pfree(ranges_a);
+	pfree(ranges_b);
+	pfree(serialized_a);
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Build the in-memory array of intervals from the on-disk summary.  For
+ * pass-by-reference types the values point into the serialized data, so it
+ * must not be freed while the array is in use.
+ */
+static MinmaxMultiRange *
+ranges_deserialize(SerializedRanges *serialized, int *nranges)
+{
+	MinmaxMultiRange *ranges;
+	char	   *ptr;
+	Size		slotsize;
+	int			i;
+
+	Assert(serialized->typlen > 0);
+
+	ranges = palloc(sizeof(MinmaxMultiRange) * serialized->nranges);
+	slotsize = MAXALIGN(serialized->typlen);
+	ptr = (char *) serialized +
+		SerializedRangesValuesOffset(serialized->nranges);
+
+	for (i = 0; i < serialized->nranges; i++)
+	{
+		ranges[i].single = (serialized->data[i] != 0);
+		ranges[i].minval = fetch_att(ptr, serialized->typbyval,
+									 serialized->typlen);
+		ptr += slotsize;
+
+		if (ranges[i].single)
+			ranges[i].maxval = ranges[i].minval;
+		else
+		{
+			ranges[i].maxval = fetch_att(ptr, serialized->typbyval,
+										 serialized->typlen);
+			ptr += slotsize;
+		}
+	}
+
+	*nranges = serialized->nranges;
+	return ranges;
+}
+
+/*
+ * Build the on-disk summary from an array of intervals.
+ */
+static SerializedRanges *
+ranges_serialize(Form_pg_attribute attr, MinmaxMultiRange *ranges, int nranges)
+{
+	SerializedRanges *serialized;
+	Size		slotsize;
+	Size		len;
+	int			nvalues;
+	char	   *ptr;
+	int			i;
+
+	if (attr->attlen <= 0)
+		elog(ERROR, "minmax-multi summaries only support fixed-length types");
+
+	slotsize = MAXALIGN(attr->attlen);
+	nvalues = ranges_nvalues(ranges, nranges);
+	len = SerializedRangesValuesOffset(nranges) + slotsize * nvalues;
+
+	serialized = (SerializedRanges *) palloc0(len);
+	SET_VARSIZE(serialized, len);
+	serialized->nranges = nranges;
+	serialized->nvalues = nvalues;
+	serialized->typlen = attr->attlen;
+	serialized->typbyval = attr->attbyval;
+
+	ptr = (char *) serialized + SerializedRangesValuesOffset(nranges);
+	for (i = 0; i < nranges; i++)
+	{
+		serialized->data[i] = ranges[i].single ? 1 : 0;
+
+		if (attr->attbyval)
+			store_att_byval(ptr, ranges[i].minval, attr->attlen);
+		else
+			memcpy(ptr, DatumGetPointer(ranges[i].minval), attr->attlen);
+		ptr += slotsize;
+
+		if (ranges[i].single)
+			continue;
+
+		if (attr->attbyval)
+			store_att_byval(ptr, ranges[i].maxval, attr->attlen);
+		else
+			memcpy(ptr, DatumGetPointer(ranges[i].maxval), attr->attlen);
+		ptr += slotsize;
+	}
+
+	return serialized;
+}
+
+/*
+ * Number of values needed to store the given intervals.
+ */
+static int
+ranges_nvalues(MinmaxMultiRange *ranges, int nranges)
+{
+	int			nvalues = 0;
+	int			i;
+
+	for (i = 0; i < nranges; i++)
+		nvalues += ranges[i].single ? 1 : 2;
+
+	return nvalues;
+}
+
+/*
+ * Reduce the number of stored values to MINMAX_MULTI_TARGET_VALUES, by
+ * merging adjacent intervals, closest ones first.  The intervals are merged
+ * in place; returns the new number of intervals.
+ */
+static int
+ranges_compact(BrinDesc *bdesc, AttrNumber attno, Oid colloid,
+			  MinmaxMultiRange *ranges, int nranges)
+{
+	FmgrInfo   *distanceFn;
+	MinmaxMultiGap *gaps;
+	bool	   *merge;
+	int			ngaps = nranges - 1;
+	int			nmerged;
+	int			i;
+
+	distanceFn = index_getprocinfo(bdesc->bd_index, attno,
+								   MINMAX_MULTI_PROCNUM_DISTANCE);
+
+	gaps = palloc(sizeof(MinmaxMultiGap) * ngaps);
+	for (i = 0; i < ngaps; i++)
+	{
+		gaps[i].index = i;
+		gaps[i].distance =
+			DatumGetFloat8(FunctionCall2Coll(distanceFn, colloid,
+											 ranges[i].maxval,
+											 ranges[i + 1].minval));
+	}
+	qsort(gaps, ngaps, sizeof(MinmaxMultiGap), compare_gaps);
+
+	/*
+	 * Close gaps, smallest first, until the merged intervals fit.  Merging
+	 * two single points doesn't save anything by itself, so we need to
+	 * recount after each step.
+	 */
+	merge = palloc0(sizeof(bool) * nranges);
+	for (i = 0; i < ngaps; i++)
+	{
+		int			nvalues = 0;
+		int			j;
+
+		merge[gaps[i].index] = true;
+
+		for (j = 0; j < nranges; j++)
+		{
+			int			start = j;
+
+			while (merge[j])
+				j++;
+			nvalues += (start == j && ranges[j].single) ? 1 : 2;
+		}
+
+		if (nvalues <= MINMAX_MULTI_TARGET_VALUES)
+			break;
+	}
+
+	/* Now actually merge the marked intervals. */
+	nmerged = 0;
+	for (i = 0; i < nranges; i++)
+	{
+		int			start = i;
+
+		while (merge[i])
+			i++;
+
+		ranges[nmerged].minval = ranges[start].minval;
+		ranges[nmerged].maxval = ranges[i].maxval;
+		ranges[nmerged].single = (start == i && ranges[i].single);
+		nmerged++;
+	}
+
+	pfree(gaps);
+	pfree(merge);
+
+	return nmerged;
+}
+
+/*
+ * qsort_arg comparator sorting intervals by their minimum.
+ */
+static int
+compare_ranges(const void *a, const void *b, void *arg)
+{
+	MinmaxMultiRange *ra = (MinmaxMultiRange *) a;
+	MinmaxMultiRange *rb = (MinmaxMultiRange *) b;
+	MinmaxMultiSortContext *cxt = (MinmaxMultiSortContext *) arg;
+
+	if (DatumGetBool(FunctionCall2Coll(cxt->cmpFn, cxt->colloid,
+									   ra->minval, rb->minval)))
+		return -1;
+	if (DatumGetBool(FunctionCall2Coll(cxt->cmpFn, cxt->colloid,
+									   rb->minval, ra->minval)))
+		return 1;
+	return 0;
+}
+
+/*
+ * qsort comparator sorting gaps by distance.
+ */
+static int
+compare_gaps(const void *a, const void *b)
+{
+	const MinmaxMultiGap *ga = (const MinmaxMultiGap *) a;
+	const MinmaxMultiGap *gb = (const MinmaxMultiGap *) b;
+
+	if (ga->distance < gb->distance)
+		return -1;
+	if (ga->distance > gb->distance)
+		return 1;
+	return 0;
+}
+
+/*
+ * Cache and return the procedure for the given strategy.
+ *
+ * Note: this function mirrors minmax_get_strategy_procinfo; see notes
+ * there.  If changes are made here, see that function too.
+ */
+static FmgrInfo *
+minmax_multi_get_strategy_procinfo(BrinDesc *bdesc, uint16 attno, Oid subtype,
+								   uint16 strategynum)
+{
+	MinmaxMultiOpaque *opaque;
+
+	Assert(strategynum >= 1 &&
+		   strategynum <= BTMaxStrategyNumber);
+
+	opaque = (MinmaxMultiOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+
+	/*
+	 * We cache the procedures for the previous subtype in the opaque struct,
+	 * to avoid repetitive syscache lookups.  If the subtype changed,
+	 * invalidate all the cached entries.
+	 */
+	if (opaque->cached_subtype != subtype)
+	{
+		uint16		i;
+
+		for (i = 1; i <= BTMaxStrategyNumber; i++)
+			opaque->strategy_procinfos[i - 1].fn_oid = InvalidOid;
+		opaque->cached_subtype = subtype;
+	}
+
+	if (opaque->strategy_procinfos[strategynum - 1].fn_oid == InvalidOid)
+	{
+		Form_pg_attribute attr;
+		HeapTuple	tuple;
+		Oid			opfamily,
+					oprid;
+		bool		isNull;
+
+		opfamily = bdesc->bd_index->rd_opfamily[attno - 1];
+		attr = bdesc->bd_tupdesc->attrs[attno - 1];
+		tuple = SearchSysCache4(AMOPSTRATEGY, ObjectIdGetDatum(opfamily),
+								ObjectIdGetDatum(attr->atttypid),
+								ObjectIdGetDatum(subtype),
+								Int16GetDatum(strategynum));
+
+		if (!HeapTupleIsValid(tuple))
+			elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+				 strategynum, attr->atttypid, subtype, opfamily);
+
+		oprid = DatumGetObjectId(SysCacheGetAttr(AMOPSTRATEGY, tuple,
+											 Anum_pg_amop_amopopr, &isNull));
+		ReleaseSysCache(tuple);
+		Assert(!isNull && RegProcedureIsValid(oprid));
+
+		fmgr_info_cxt(get_opcode(oprid),
+					  &opaque->strategy_procinfos[strategynum - 1],
+					  bdesc->bd_context);
+	}
+
+	return &opaque->strategy_procinfos[strategynum - 1];
+}
+
+/*
+ * Distance support procedures.  They're always called with a <= b, and
+ * return the distance as a float8; infinite values are infinitely far.
+ */
+
+Datum
+brin_minmax_multi_distance_int2(PG_FUNCTION_ARGS)
+{
+	int16		a = PG_GETARG_INT16(0);
+	int16		b = PG_GETARG_INT16(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_int4(PG_FUNCTION_ARGS)
+{
+	int32		a = PG_GETARG_INT32(0);
+	int32		b = PG_GETARG_INT32(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_int8(PG_FUNCTION_ARGS)
+{
+	int64		a = PG_GETARG_INT64(0);
+	int64		b = PG_GETARG_INT64(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_float4(PG_FUNCTION_ARGS)
+{
+	float4		a = PG_GETARG_FLOAT4(0);
+	float4		b = PG_GETARG_FLOAT4(1);
+	float8		result = (double) b - (double) a;
+
+	/* NaN sorts above everything else, so treat it as infinitely far */
+	if (isnan(result))
+		PG_RETURN_FLOAT8(get_float8_infinity());
+
+	PG_RETURN_FLOAT8(result);
+}
+
+Datum
+brin_minmax_multi_distance_float8(PG_FUNCTION_ARGS)
+{
+	float8		a = PG_GETARG_FLOAT8(0);
+	float8		b = PG_GETARG_FLOAT8(1);
+	float8		result = b - a;
+
+	/* NaN sorts above everything else, so treat it as infinitely far */
+	if (isnan(result))
+		PG_RETURN_FLOAT8(get_float8_infinity());
+
+	PG_RETURN_FLOAT8(result);
+}
+
+Datum
+brin_minmax_multi_distance_date(PG_FUNCTION_ARGS)
+{
+	DateADT		a = PG_GETARG_DATEADT(0);
+	DateADT		b = PG_GETARG_DATEADT(1);
+
+	if (DATE_NOT_FINITE(a) || DATE_NOT_FINITE(b))
+		PG_RETURN_FLOAT8(get_float8_infinity());
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+/* used for both timestamp and timestamptz */
+Datum
+brin_minmax_multi_distance_timestamp(PG_FUNCTION_ARGS)
+{
+	Timestamp	a = PG_GETARG_TIMESTAMP(0);
+	Timestamp	b = PG_GETARG_TIMESTAMP(1);
+
+	if (TIMESTAMP_NOT_FINITE(a) || TIMESTAMP_NOT_FINITE(b))
+		PG_RETURN_FLOAT8(get_float8_infinity());
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
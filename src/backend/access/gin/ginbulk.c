@@ -23,6 +23,7 @@
 
 #define DEF_NENTRY	2048		/* GinEntryAccumulator allocation quantum */
 #define DEF_NPTR	5			/* ItemPointer initial allocation quantum */
+#define DEF_NSORTED 1024		/* GinSortedEntry initial allocation quantum */
 
 
 /* Combiner function for rbtree.c */
@@ -118,6 +119,39 @@ ginInitBA(BuildAccumulator *accum)
 							ginAllocEntryAccumulator,
 							NULL,		/* no freefunc needed */
 							(void *) accum);
+	accum->sorted = false;
+	accum->sortentries = NULL;
+	accum->nsortentries = accum->maxsortentries = 0;
+	accum->sortpos = 0;
+	accum->sortlist = NULL;
+	accum->maxsortlist = 0;
+}
+
+/*
+ * Initialize a BuildAccumulator in sorted mode.
+ *
+ * Rather than looking up each key in a balanced tree as it arrives, the
+ * (key, heap pointer) pairs are simply appended to an array, which is sorted
+ * once when the contents are read out.  When a lot of data is accumulated,
+ * as in a big pending-list merge, that is considerably cheaper than the tree:
+ * insertion involves no key comparisons at all, and the sort works on
+ * contiguous memory.  The price is that a key that occurs in many items is
+ * stored many times, so each pair costs more memory than in the tree.
+ */
+void
+ginInitSortedBA(BuildAccumulator *accum)
+{
+	/* accum->ginstate is intentionally not set here */
+	accum->allocatedMemory = 0;
+	accum->entryallocator = NULL;
+	accum->eas_used = 0;
+	accum->tree = NULL;
+	accum->sorted = true;
+	accum->sortentries = NULL;
+	accum->nsortentries = accum->maxsortentries = 0;
+	accum->sortpos = 0;
+	accum->sortlist = NULL;
+	accum->maxsortlist = 0;
 }
 
 /*
@@ -189,6 +223,51 @@ ginInsertBAEntry(BuildAccumulator *accum,
 	}
 }
 
+/*
+ * Append one entry to a sorted-mode accumulator.
+ */
+static void
+ginInsertSortedEntry(BuildAccumulator *accum,
+					 ItemPointer heapptr, OffsetNumber attnum,
+					 Datum key, GinNullCategory category)
+{
+	GinSortedEntry *se;
+
+	if (accum->nsortentries >= accum->maxsortentries)
+	{
+		if (accum->sortentries == NULL)
+		{
+			accum->maxsortentries = DEF_NSORTED;
+			accum->sortentries = (GinSortedEntry *)
+				palloc(sizeof(GinSortedEntry) * accum->maxsortentries);
+		}
+		else
+		{
+			if (accum->maxsortentries >= MaxAllocHugeSize / sizeof(GinSortedEntry) / 2)
+				ereport(ERROR,
+						(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+						 errmsg("too many entries to accumulate"),
+						 errhint("Reduce maintenance_work_mem.")));
+
+			accum->allocatedMemory -= GetMemoryChunkSpace(accum->sortentries);
+			accum->maxsortentries *= 2;
+			accum->sortentries = (GinSortedEntry *)
+				repalloc_huge(accum->sortentries,
+							  sizeof(GinSortedEntry) * accum->maxsortentries);
+		}
+		accum->allocatedMemory += GetMemoryChunkSpace(accum->sortentries);
+	}
+
+	se = &accum->sortentries[accum->nsortentries++];
+	se->attnum = attnum;
+	se->category = category;
+	se->heapptr = *heapptr;
+	if (category == GIN_CAT_NORM_KEY)
+		se->key = getDatumCopy(accum, attnum, key);
+	else
+		se->key = key;
+}
+
 /*
  * Insert the entries for one heap pointer.
  *
@@ -218,6 +297,17 @@ ginInsertBAEntries(BuildAccumulator *accum,
 
 	Assert(ItemPointerIsValid(heapptr) && attnum >= FirstOffsetNumber);
 
+	if (accum->sorted)
+	{
+		int			i;
+
+		/* order doesn't matter, we'll sort everything at the end */
+		for (i = 0; i < nentries; i++)
+			ginInsertSortedEntry(accum, heapptr, attnum,
+								 entries[i], categories[i]);
+		return;
+	}
+
 	/*
 	 * step will contain largest power of 2 and <= nentries
 	 */
@@ -251,15 +341,104 @@ qsortCompareItemPointers(const void *a, const void *b)
 	return res;
 }
 
-/* Prepare to read out the rbtree contents using ginGetBAEntry */
+/* qsort_arg comparator for sorted-mode entries */
+static int
+qsortCompareSortedEntries(const void *a, const void *b, void *arg)
+{
+	const GinSortedEntry *sa = (const GinSortedEntry *) a;
+	const GinSortedEntry *sb = (const GinSortedEntry *) b;
+	BuildAccumulator *accum = (BuildAccumulator *) arg;
+	int			res;
+
+	res = ginCompareAttEntries(accum->ginstate,
+							   sa->attnum, sa->key, sa->category,
+							   sb->attnum, sb->key, sb->category);
+	if (res != 0)
+		return res;
+
+	return ginCompareItemPointers((ItemPointer) &sa->heapptr,
+								  (ItemPointer) &sb->heapptr);
+}
+
+/* Prepare to read out the accumulated contents using ginGetBAEntry */
 void
 ginBeginBAScan(BuildAccumulator *accum)
 {
+	if (accum->sorted)
+	{
+		if (accum->nsortentries > 1)
+			qsort_arg(accum->sortentries, accum->nsortentries,
+					  sizeof(GinSortedEntry), qsortCompareSortedEntries,
+					  (void *) accum);
+		accum->sortpos = 0;
+		return;
+	}
+
 	rb_begin_iterate(accum->tree, LeftRightWalk, &accum->tree_walk);
 }
 
 /*
- * Get the next entry in sequence from the BuildAccumulator's rbtree.
+ * ginGetBAEntry for a sorted-mode accumulator: collect the heap pointers of
+ * the next run of equal keys.
+ */
+static ItemPointerData *
+ginGetSortedBAEntry(BuildAccumulator *accum,
+					OffsetNumber *attnum, Datum *key, GinNullCategory *category,
+					uint32 *n)
+{
+	GinSortedEntry *first;
+	uint32		end;
+	uint32		count;
+	uint32		i;
+
+	if (accum->sortpos >= accum->nsortentries)
+		return NULL;			/* no more entries */
+
+	first = &accum->sortentries[accum->sortpos];
+
+	/* Find the end of the run of entries with this key */
+	for (end = accum->sortpos + 1; end < accum->nsortentries; end++)
+	{
+		GinSortedEntry *se = &accum->sortentries[end];
+
+		if (ginCompareAttEntries(accum->ginstate,
+								 first->attnum, first->key, first->category,
+								 se->attnum, se->key, se->category) != 0)
+			break;
+	}
+	count = end - accum->sortpos;
+
+	/* Make sure the result buffer is large enough */
+	if (count > accum->maxsortlist)
+	{
+		if (accum->sortlist)
+			pfree(accum->sortlist);
+		accum->maxsortlist = Max(count, DEF_NPTR);
+		accum->sortlist = (ItemPointerData *)
+			palloc_extended(sizeof(ItemPointerData) * accum->maxsortlist,
+							MCXT_ALLOC_HUGE);
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		accum->sortlist[i] = accum->sortentries[accum->sortpos + i].heapptr;
+		Assert(i == 0 ||
+			   ginCompareItemPointers(&accum->sortlist[i - 1],
+									  &accum->sortlist[i]) < 0);
+	}
+
+	*attnum = first->attnum;
+	*key = first->key;
+	*category = first->category;
+	*n = count;
+
+	accum->sortpos = end;
+
+	return accum->sortlist;
+}
+
+/*
+ * Get the next entry in sequence from the BuildAccumulator.
  * This consists of a single key datum and a list (array) of one or more
  * heap TIDs in which that key is found.  The list is guaranteed sorted.
  */
@@ -271,6 +450,9 @@ ginGetBAEntry(BuildAccumulator *accum,
 	GinEntryAccumulator *entry;
 	ItemPointerData *list;
 
+	if (accum->sorted)
+		return ginGetSortedBAEntry(accum, attnum, key, category, n);
+
 	entry = (GinEntryAccumulator *) rb_iterate(&accum->tree_walk);
 
 	if (entry == NULL)
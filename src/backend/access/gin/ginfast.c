@@ -230,6 +230,7 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	ginxlogUpdateMeta data;
 	bool		separateList = false;
 	bool		needCleanup = false;
+	bool		mustCleanup = false;
 	int			cleanupSize;
 	bool		needWal;
 
@@ -430,18 +431,38 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	 * while pending list is still small enough to fit into
 	 * gin_pending_list_limit.
 	 *
+	 * If the list has grown to twice the limit, the background cleanup
+	 * requested below is evidently not keeping up, so clean up in the
+	 * foreground regardless.
+	 *
 	 * ginInsertCleanup() should not be called inside our CRIT_SECTION.
 	 */
 	cleanupSize = GinGetPendingListCleanupSize(index);
 	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * 1024L)
 		needCleanup = true;
+	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * 2048L)
+		mustCleanup = true;
 
 	UnlockReleaseBuffer(metabuffer);
 
 	END_CRIT_SECTION();
 
 	if (needCleanup)
-		ginInsertCleanup(ginstate, false, true, NULL);
+	{
+		/*
+		 * Rather than making this inserter wait for the whole pending list to
+		 * be merged, hand the work to autovacuum if we can.  Autovacuum can't
+		 * process temporary relations, and the request can be lost if the
+		 * work item list is full, in which case we do it ourselves.
+		 */
+		if (mustCleanup ||
+			!AutoVacuumingActive() ||
+			index->rd_rel->relpersistence == RELPERSISTENCE_TEMP ||
+			!AutoVacuumRequestWork(AVW_GINCleanPendingList,
+								   RelationGetRelid(index),
+								   InvalidBlockNumber))
+			ginInsertCleanup(ginstate, false, true, false, NULL);
+	}
 }
 
 /*
@@ -723,11 +744,19 @@ processPendingPage(BuildAccumulator *accum, KeyArray *ka,
  * to FSM otherwise caller is responsible to put deleted pages into
  * FSM.
  *
+ * forceCleanup is true when called from [auto]vacuum/analyze,
+ * gin_clean_pending_list() or an autovacuum work item: we then wait for any
+ * concurrent cleanup to finish, use maintenance_work_mem, and accumulate the
+ * entries in sorted mode, which is cheaper for the large merges these callers
+ * typically do.  Regular inserters pass false, and give up immediately if
+ * someone else is already cleaning up.
+ *
  * If stats isn't null, we count deleted pending pages into the counts.
  */
 void
 ginInsertCleanup(GinState *ginstate, bool full_clean,
-				 bool fill_fsm, IndexBulkDeleteResult *stats)
+				 bool fill_fsm, bool forceCleanup,
+				 IndexBulkDeleteResult *stats)
 {
 	Relation	index = ginstate->index;
 	Buffer		metabuffer,
@@ -744,7 +773,6 @@ ginInsertCleanup(GinState *ginstate, bool full_clean,
 	bool		cleanupFinish = false;
 	bool		fsm_vac = false;
 	Size		workMemory;
-	bool		inVacuum = (stats == NULL);
 
 	/*
 	 * We would like to prevent concurrent cleanup process. For that we will
@@ -753,7 +781,7 @@ ginInsertCleanup(GinState *ginstate, bool full_clean,
 	 * insertion into pending list
 	 */
 
-	if (inVacuum)
+	if (forceCleanup)
 	{
 		/*
 		 * We are called from [auto]vacuum/analyze or gin_clean_pending_list()
@@ -815,7 +843,10 @@ ginInsertCleanup(GinState *ginstate, bool full_clean,
 	oldCtx = MemoryContextSwitchTo(opCtx);
 
 	initKeyArray(&datums, 128);
-	ginInitBA(&accum);
+	if (forceCleanup)
+		ginInitSortedBA(&accum);
+	else
+		ginInitBA(&accum);
 	accum.ginstate = ginstate;
 
 	/*
@@ -899,7 +930,10 @@ ginInsertCleanup(GinState *ginstate, bool full_clean,
 			 */
 			if (PageGetMaxOffsetNumber(page) != maxoff)
 			{
-				ginInitBA(&accum);
+				if (forceCleanup)
+					ginInitSortedBA(&accum);
+				else
+					ginInitBA(&accum);
 				processPendingPage(&accum, &datums, page, maxoff + 1);
 
 				ginBeginBAScan(&accum);
@@ -940,7 +974,10 @@ ginInsertCleanup(GinState *ginstate, bool full_clean,
 			 */
 			MemoryContextReset(opCtx);
 			initKeyArray(&datums, datums.maxvalues);
-			ginInitBA(&accum);
+			if (forceCleanup)
+				ginInitSortedBA(&accum);
+			else
+				ginInitBA(&accum);
 		}
 		else
 		{
@@ -1016,7 +1053,7 @@ gin_clean_pending_list(PG_FUNCTION_ARGS)
 
 	memset(&stats, 0, sizeof(stats));
 	initGinState(&ginstate, indexRel);
-	ginInsertCleanup(&ginstate, true, true, &stats);
+	ginInsertCleanup(&ginstate, true, true, true, &stats);
 
 	index_close(indexRel, AccessShareLock);
 
@@ -27,6 +27,7 @@
 #include "storage/smgr.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
+#include "utils/tuplesort.h"
 
 /* Step of index tuples for check whether to switch to buffering build mode */
 #define BUFFERING_MODE_SWITCH_CHECK_STEP 256
@@ -49,7 +50,8 @@ typedef enum
 	GIST_BUFFERING_STATS,		/* gathering statistics of index tuple size
 								 * before switching to the buffering build
 								 * mode */
-	GIST_BUFFERING_ACTIVE		/* in buffering build mode */
+	GIST_BUFFERING_ACTIVE,		/* in buffering build mode */
+	GIST_SORTED_BUILD			/* bottom-up build of pre-sorted tuples */
 } GistBufferingMode;
 
 /* Working state for gistbuild and its callback */
@@ -72,8 +74,29 @@ typedef struct
 	HTAB	   *parentMap;
 
 	GistBufferingMode bufferingMode;
+
+	/*
+	 * Extra data structures used during a sorted build.  'sortstate' holds
+	 * the index tuples while they are sorted; 'pages_allocated' is the next
+	 * block number to hand out, and 'pages_written' the number of blocks
+	 * physically written so far.
+	 */
+	Tuplesortstate *sortstate;
+	BlockNumber pages_allocated;
+	BlockNumber pages_written;
 } GISTBuildState;
 
+/*
+ * In sorted build, we keep one of these for each level of the tree that is
+ * currently being filled.  'page' is the in-memory page being filled, and
+ * 'parent' the state for the level above (NULL until it is needed).
+ */
+typedef struct GistSortedBuildPageState
+{
+	Page		page;
+	struct GistSortedBuildPageState *parent;
+} GistSortedBuildPageState;
+
 /* prototypes for private functions */
 static void gistInitBuffering(GISTBuildState *buildstate);
 static int	calculatePagesPerBuffer(GISTBuildState *buildstate, int levelStep);
@@ -99,6 +122,21 @@ static void gistProcessEmptyingQueue(GISTBuildState *buildstate);
 static void gistEmptyAllBuffers(GISTBuildState *buildstate);
 static int	gistGetMaxLevel(Relation index);
 
+static void gistSortedBuildCallback(Relation index,
+						HeapTuple htup,
+						Datum *values,
+						bool *isnull,
+						bool tupleIsAlive,
+						void *state);
+static void gist_indexsortbuild(GISTBuildState *state);
+static void gist_indexsortbuild_pagestate_add(GISTBuildState *state,
+								  GistSortedBuildPageState *pagestate,
+								  IndexTuple itup);
+static void gist_indexsortbuild_pagestate_flush(GISTBuildState *state,
+									GistSortedBuildPageState *pagestate);
+static void gist_indexsortbuild_flush_page(GISTBuildState *state,
+							   BlockNumber blkno, Page page);
+
 static void gistInitParentMap(GISTBuildState *buildstate);
 static void gistMemorizeParent(GISTBuildState *buildstate, BlockNumber child,
 				   BlockNumber parent);
@@ -106,9 +144,18 @@ static void gistMemorizeAllDownlinks(GISTBuildState *buildstate, Buffer parent);
 static BlockNumber gistGetParent(GISTBuildState *buildstate, BlockNumber child);
 
 /*
- * Main entry point to GiST index build. Initially calls insert over and over,
- * but switches to more efficient buffering build algorithm after a certain
- * number of tuples (unless buffering mode is disabled).
+ * Main entry point to GiST index build.
+ *
+ * If all the opclasses of the index provide a sortsupport function, and
+ * buffering was not explicitly requested, the index is built bottom-up: the
+ * tuples are sorted into an order that clusters nearby keys (for example a
+ * Z-order curve for points), and then packed into pages one level at a time.
+ * That is much faster than inserting the tuples one by one, although the
+ * resulting tree may be somewhat less well clustered.
+ *
+ * Otherwise, this initially calls insert over and over, but switches to more
+ * efficient buffering build algorithm after a certain number of tuples
+ * (unless buffering mode is disabled).
  */
 IndexBuildResult *
 gistbuild(Relation heap, Relation index, IndexInfo *indexInfo)
@@ -120,6 +167,7 @@ gistbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 	Page		page;
 	MemoryContext oldcxt = CurrentMemoryContext;
 	int			fillfactor;
+	int			i;
 
 	buildstate.indexrel = index;
 	if (index->rd_options)
@@ -149,6 +197,27 @@ gistbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 	/* Calculate target amount of free space to leave on pages */
 	buildstate.freespace = BLCKSZ * (100 - fillfactor) / 100;
 
+	/*
+	 * Use the sorted build if every column has a sortsupport function, unless
+	 * the user explicitly asked for a buffering build.
+	 */
+	if (buildstate.bufferingMode != GIST_BUFFERING_STATS)
+	{
+		bool		hasallsortsupports = true;
+
+		for (i = 0; i < RelationGetNumberOfAttributes(index); i++)
+		{
+			if (!OidIsValid(index_getprocid(index, i + 1,
+											GIST_SORTSUPPORT_PROC)))
+			{
+				hasallsortsupports = false;
+				break;
+			}
+		}
+		if (hasallsortsupports)
+			buildstate.bufferingMode = GIST_SORTED_BUILD;
+	}
+
 	/*
 	 * We expect to be called exactly once for any index relation. If that's
 	 * not the case, big trouble's what we have.
@@ -167,53 +236,76 @@ gistbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 	 */
 	buildstate.giststate->tempCxt = createTempGistContext();
 
-	/* initialize the root page */
-	buffer = gistNewBuffer(index);
-	Assert(BufferGetBlockNumber(buffer) == GIST_ROOT_BLKNO);
-	page = BufferGetPage(buffer);
-
-	START_CRIT_SECTION();
+	/* build the index */
+	buildstate.indtuples = 0;
+	buildstate.indtuplesSize = 0;
 
-	GISTInitBuffer(buffer, F_LEAF);
+	if (buildstate.bufferingMode == GIST_SORTED_BUILD)
+	{
+		/*
+		 * Sort all the index tuples, then pack them into the index bottom-up.
+		 */
+		buildstate.sortstate = tuplesort_begin_index_gist(heap,
+														  index,
+														  maintenance_work_mem,
+														  false);
 
-	MarkBufferDirty(buffer);
+		reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
+									   gistSortedBuildCallback,
+									   (void *) &buildstate);
 
-	if (RelationNeedsWAL(index))
-	{
-		XLogRecPtr	recptr;
+		tuplesort_performsort(buildstate.sortstate);
 
-		XLogBeginInsert();
-		XLogRegisterBuffer(0, buffer, REGBUF_WILL_INIT);
+		gist_indexsortbuild(&buildstate);
 
-		recptr = XLogInsert(RM_GIST_ID, XLOG_GIST_CREATE_INDEX);
-		PageSetLSN(page, recptr);
+		tuplesort_end(buildstate.sortstate);
 	}
 	else
-		PageSetLSN(page, gistGetFakeLSN(heap));
+	{
+		/* initialize the root page */
+		buffer = gistNewBuffer(index);
+		Assert(BufferGetBlockNumber(buffer) == GIST_ROOT_BLKNO);
+		page = BufferGetPage(buffer);
 
-	UnlockReleaseBuffer(buffer);
+		START_CRIT_SECTION();
 
-	END_CRIT_SECTION();
+		GISTInitBuffer(buffer, F_LEAF);
 
-	/* build the index */
-	buildstate.indtuples = 0;
-	buildstate.indtuplesSize = 0;
+		MarkBufferDirty(buffer);
 
-	/*
-	 * Do the heap scan.
-	 */
-	reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
-								   gistBuildCallback, (void *) &buildstate);
+		if (RelationNeedsWAL(index))
+		{
+			XLogRecPtr	recptr;
 
-	/*
-	 * If buffering was used, flush out all the tuples that are still in the
-	 * buffers.
-	 */
-	if (buildstate.bufferingMode == GIST_BUFFERING_ACTIVE)
-	{
-		elog(DEBUG1, "all tuples processed, emptying buffers");
-		gistEmptyAllBuffers(&buildstate);
-		gistFreeBuildBuffers(buildstate.gfbb);
+			XLogBeginInsert();
+			XLogRegisterBuffer(0, buffer, REGBUF_WILL_INIT);
+
+			recptr = XLogInsert(RM_GIST_ID, XLOG_GIST_CREATE_INDEX);
+			PageSetLSN(page, recptr);
+		}
+		else
+			PageSetLSN(page, gistGetFakeLSN(heap));
+
+		UnlockReleaseBuffer(buffer);
+
+		END_CRIT_SECTION();
+
+		/*
+		 * Do the heap scan.
+		 */
+		reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
+									   gistBuildCallback, (void *) &buildstate);
+
+		/*
+		 * If buffering was used, flush out all the tuples that are still in
+		 * the buffers.
+		 */
+		if (buildstate.bufferingMode == GIST_BUFFERING_ACTIVE)
+		{
+			elog(DEBUG1, "all tuples processed, emptying buffers");
+			gistEmptyAllBuffers(&buildstate);
+			gistFreeBuildBuffers(buildstate.gfbb);
+		}
 	}
 
 	/* okay, all heap tuples are indexed */
@@ -233,6 +325,221 @@ gistbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 	return result;
 }
 
+/*
+ * Per-tuple callback from IndexBuildHeapScan, in sorted build mode.
+ */
+static void
+gistSortedBuildCallback(Relation index,
+						HeapTuple htup,
+						Datum *values,
+						bool *isnull,
+						bool tupleIsAlive,
+						void *state)
+{
+	GISTBuildState *buildstate = (GISTBuildState *) state;
+	MemoryContext oldCtx;
+	Datum		compressed_values[INDEX_MAX_KEYS];
+
+	oldCtx = MemoryContextSwitchTo(buildstate->giststate->tempCxt);
+
+	/* Form an index tuple and point it at the heap tuple */
+	gistCompressValues(buildstate->giststate, index,
+					   values, isnull,
+					   true, compressed_values);
+
+	tuplesort_putindextuplevalues(buildstate->sortstate,
+								  buildstate->indexrel,
+								  &htup->t_self,
+								  compressed_values, isnull);
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextReset(buildstate->giststate->tempCxt);
+
+	/* Update tuple count. */
+	buildstate->indtuples += 1;
+}
+
+/*
+ * Build the GiST index bottom-up from the sorted tuples.
+ *
+ * Leaf pages are filled in order, and whenever a page is full, it is written
+ * out and a downlink for it is added to the page on the next level up.
+ * Internal pages are filled in the same fashion, so we only ever keep one
+ * page per level in memory.  The root page is written last, to block 0,
+ * which is reserved for it at the start.
+ */
+static void
+gist_indexsortbuild(GISTBuildState *state)
+{
+	IndexTuple	itup;
+	GistSortedBuildPageState *leafstate;
+	GistSortedBuildPageState *pagestate;
+	Page		page;
+
+	state->pages_allocated = 0;
+	state->pages_written = 0;
+
+	/* Reserve block 0 for the root page */
+	page = palloc0(BLCKSZ);
+	RelationOpenSmgr(state->indexrel);
+	smgrextend(state->indexrel->rd_smgr, MAIN_FORKNUM, GIST_ROOT_BLKNO,
+			   page, true);
+	state->pages_allocated++;
+	state->pages_written++;
+
+	/* Allocate a temporary buffer for the first leaf page */
+	leafstate = palloc(sizeof(GistSortedBuildPageState));
+	leafstate->page = page;
+	leafstate->parent = NULL;
+	gistinitpage(page, F_LEAF);
+
+	/*
+	 * Fill index pages with tuples in the sorted order.
+	 */
+	while ((itup = tuplesort_getindextuple(state->sortstate, true)) != NULL)
+	{
+		gist_indexsortbuild_pagestate_add(state, leafstate, itup);
+		MemoryContextReset(state->giststate->tempCxt);
+	}
+
+	/*
+	 * Write out the partially full non-root pages.
+	 *
+	 * Keep in mind that flush can build a new root.
+	 */
+	pagestate = leafstate;
+	while (pagestate->parent != NULL)
+	{
+		GistSortedBuildPageState *parent;
+
+		gist_indexsortbuild_pagestate_flush(state, pagestate);
+		parent = pagestate->parent;
+		pfree(pagestate->page);
+		pfree(pagestate);
+		pagestate = parent;
+	}
+
+	/* Write out the root */
+	gist_indexsortbuild_flush_page(state, GIST_ROOT_BLKNO, pagestate->page);
+	pfree(pagestate->page);
+	pfree(pagestate);
+
+	/*
+	 * When we WAL-logged index pages, we must nonetheless fsync index files.
+	 * Since we're building outside shared buffers, a CHECKPOINT occurring
+	 * during the build has no way to flush the previously written data to
+	 * disk (indeed it won't know the index even exists).  A crash later on
+	 * would replay WAL from the checkpoint, therefore it wouldn't replay our
+	 * earlier WAL entries. If we do not fsync those pages here, they might
+	 * still not be on disk when the crash occurs.
+	 */
+	if (RelationNeedsWAL(state->indexrel))
+	{
+		RelationOpenSmgr(state->indexrel);
+		smgrimmedsync(state->indexrel->rd_smgr, MAIN_FORKNUM);
+	}
+}
+
+/*
+ * Add tuple to a page. If the page is full, write it out and re-initialize
+ * a new page first.
+ */
+static void
+gist_indexsortbuild_pagestate_add(GISTBuildState *state,
+								  GistSortedBuildPageState *pagestate,
+								  IndexTuple itup)
+{
+	Size		sizeNeeded;
+
+	/* Does the tuple fit? If not, flush */
+	sizeNeeded = IndexTupleSize(itup) + sizeof(ItemIdData) + state->freespace;
+	if (PageGetFreeSpace(pagestate->page) < sizeNeeded &&
+		!PageIsEmpty(pagestate->page))
+		gist_indexsortbuild_pagestate_flush(state, pagestate);
+
+	gistfillbuffer(pagestate->page, &itup, 1, InvalidOffsetNumber);
+}
+
+/*
+ * Write out a page, and add a downlink for it to the parent level, creating
+ * the parent level if this was the topmost level so far.
+ */
+static void
+gist_indexsortbuild_pagestate_flush(GISTBuildState *state,
+									GistSortedBuildPageState *pagestate)
+{
+	GistSortedBuildPageState *parent;
+	IndexTuple *itvec;
+	IndexTuple	union_tuple;
+	int			vect_len;
+	bool		isleaf;
+	BlockNumber blkno;
+	MemoryContext oldCtx;
+
+	/* check once per page */
+	CHECK_FOR_INTERRUPTS();
+
+	isleaf = GistPageIsLeaf(pagestate->page);
+
+	/* Compute the downlink for the page, while we still have it in memory */
+	oldCtx = MemoryContextSwitchTo(state->giststate->tempCxt);
+	itvec = gistextractpage(pagestate->page, &vect_len);
+	union_tuple = gistunion(state->indexrel, itvec, vect_len,
+							state->giststate);
+	MemoryContextSwitchTo(oldCtx);
+
+	/* Write out the page, and point the downlink at it */
+	blkno = state->pages_allocated++;
+	ItemPointerSetBlockNumber(&(union_tuple->t_tid), blkno);
+	gist_indexsortbuild_flush_page(state, blkno, pagestate->page);
+
+	/* Re-initialize the page buffer for the next page on this level */
+	gistinitpage(pagestate->page, isleaf ? F_LEAF : 0);
+
+	/* Insert the downlink to the parent page, creating the parent if needed */
+	parent = pagestate->parent;
+	if (parent == NULL)
+	{
+		parent = palloc(sizeof(GistSortedBuildPageState));
+		parent->page = (Page) palloc(BLCKSZ);
+		parent->parent = NULL;
+		gistinitpage(parent->page, 0);
+
+		pagestate->parent = parent;
+	}
+	gist_indexsortbuild_pagestate_add(state, parent, union_tuple);
+}
+
+/*
+ * Write a page of the index being built.  The root page is written in place
+ * (block 0 was reserved for it at the start); all other pages are appended
+ * to the end of the relation.
+ */
+static void
+gist_indexsortbuild_flush_page(GISTBuildState *state, BlockNumber blkno,
+							   Page page)
+{
+	Relation	index = state->indexrel;
+
+	/* XLOG stuff; log_newpage also sets the page LSN */
+	if (RelationNeedsWAL(index))
+		log_newpage(&index->rd_node, MAIN_FORKNUM, blkno, page, true);
+	else
+		PageSetLSN(page, gistGetFakeLSN(index));
+
+	PageSetChecksumInplace(page, blkno);
+
+	RelationOpenSmgr(index);
+	if (blkno == GIST_ROOT_BLKNO)
+		smgrwrite(index->rd_smgr, MAIN_FORKNUM, blkno, (char *) page, true);
+	else
+	{
+		Assert(blkno == state->pages_written);
+		smgrextend(index->rd_smgr, MAIN_FORKNUM, blkno, (char *) page, true);
+		state->pages_written++;
+	}
+}
+
 /*
  * Validator for "buffering" reloption on GiST indexes. Allows "on", "off"
  * and "auto" values.
@@ -568,12 +568,30 @@ gistFormTuple(GISTSTATE *giststate, Relation r,
 			  Datum attdata[], bool isnull[], bool isleaf)
 {
 	Datum		compatt[INDEX_MAX_KEYS];
-	int			i;
 	IndexTuple	res;
 
+	gistCompressValues(giststate, r, attdata, isnull, isleaf, compatt);
+
+	res = index_form_tuple(giststate->tupdesc, compatt, isnull);
+
 	/*
-	 * Call the compress method on each attribute.
+	 * The offset number on tuples on internal pages is unused. For historical
+	 * reasons, it is set to 0xffff.
 	 */
+	ItemPointerSetOffsetNumber(&(res->t_tid), 0xffff);
+	return res;
+}
+
+/*
+ * Call the compress method on each attribute, storing the results in
+ * compatt[].  Null attributes are stored as zeroes.
+ */
+void
+gistCompressValues(GISTSTATE *giststate, Relation r,
+				   Datum *attdata, bool *isnull, bool isleaf, Datum *compatt)
+{
+	int			i;
+
 	for (i = 0; i < r->rd_att->natts; i++)
 	{
 		if (isnull[i])
@@ -592,15 +610,6 @@ gistFormTuple(GISTSTATE *giststate, Relation r,
 			compatt[i] = cep->key;
 		}
 	}
-
-	res = index_form_tuple(giststate->tupdesc, compatt, isnull);
-
-	/*
-	 * The offset number on tuples on internal pages is unused. For historical
-	 * reasons, it is set to 0xffff.
-	 */
-	ItemPointerSetOffsetNumber(&(res->t_tid), 0xffff);
-	return res;
 }
 
 /*
@@ -699,14 +708,20 @@ gistpenalty(GISTSTATE *giststate, int attno,
  */
 void
 GISTInitBuffer(Buffer b, uint32 f)
+{
+	gistinitpage(BufferGetPage(b), f);
+}
+
+/*
+ * Initialize a new index page, which need not be in a buffer (used by the
+ * sorted index build)
+ */
+void
+gistinitpage(Page page, uint32 f)
 {
 	GISTPageOpaque opaque;
-	Page		page;
-	Size		pageSize;
 
-	pageSize = BufferGetPageSize(b);
-	page = BufferGetPage(b);
-	PageInit(page, pageSize, sizeof(GISTPageOpaqueData));
+	PageInit(page, BLCKSZ, sizeof(GISTPageOpaqueData));
 
 	opaque = GistPageGetOpaque(page);
 	/* page was already zeroed by PageInit, so this is not needed: */
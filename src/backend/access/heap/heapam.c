@@ -2581,12 +2581,14 @@ heap_prepare_insert(Relation relation, HeapTuple tup, TransactionId xid,
 					CommandId cid, int options)
 {
 	/*
-	 * For now, parallel operations are required to be strictly read-only.
-	 * Unlike heap_update() and heap_delete(), an insert should never create a
-	 * combo CID, so it might be possible to relax this restriction, but not
-	 * without more thought and testing.
-	 */
-	if (IsInParallelMode())
+	 * Parallel workers are required to be strictly read-only, except for
+	 * those the leader has explicitly set up to insert.  Unlike heap_update()
+	 * and heap_delete(), an insert never creates a combo CID, so all such a
+	 * worker needs is the leader's XID and command ID.  For the same reason
+	 * the leader itself may insert while in parallel mode, as it does for
+	 * INSERT and CREATE TABLE AS with a parallel source query.
+	 */
+	if (IsParallelWorker() && !ParallelWorkerInsertsAllowed)
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_TRANSACTION_STATE),
 				 errmsg("cannot insert tuples during a parallel operation")));
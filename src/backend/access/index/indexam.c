@@ -20,6 +20,7 @@
  *		index_insert	- insert an index tuple into a relation
  *		index_markpos	- mark a scan position
  *		index_restrpos	- restore a scan position
+ *		index_skip		- skip to the next leading column value
  *		index_parallelscan_estimate - estimate shared memory for parallel scan
  *		index_parallelscan_initialize - initialize parallel scan
  *		index_parallelrescan  - (re)start a parallel scan of an index
@@ -406,6 +407,32 @@ index_restrpos(IndexScanDesc scan)
 	scan->indexRelation->rd_amroutine->amrestrpos(scan);
 }
 
+/* ----------------
+ *		index_skip	- skip to the next leading column value
+ *
+ * In a skip scan (see xs_skipscan), abandon the remaining index entries
+ * having the same first-column value as the entry last returned, so that
+ * the next index_getnext_tid call returns the first matching entry with a
+ * later value.  Returns false if there is no later value.
+ *
+ * The AM is free to ignore the request and return true, in which case the
+ * scan simply continues with the next matching entry.  Callers must be
+ * prepared for that.
+ * ----------------
+ */
+bool
+index_skip(IndexScanDesc scan, ScanDirection direction)
+{
+	SCAN_CHECKS;
+	CHECK_SCAN_PROCEDURE(amskip);
+
+	scan->xs_continue_hot = false;
+
+	scan->kill_prior_tuple = false;		/* for safety */
+
+	return scan->indexRelation->rd_amroutine->amskip(scan, direction);
+}
+
 /*
  * index_parallelscan_estimate - estimate shared memory for parallel scan
  *
@@ -160,6 +160,7 @@ bthandler(PG_FUNCTION_ARGS)
 	amroutine->amendscan = btendscan;
 	amroutine->ammarkpos = btmarkpos;
 	amroutine->amrestrpos = btrestrpos;
+	amroutine->amskip = btskip;
 	amroutine->amestimateparallelscan = btestimateparallelscan;
 	amroutine->aminitparallelscan = btinitparallelscan;
 	amroutine->amparallelrescan = btparallelrescan;
@@ -361,7 +362,21 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 		_bt_start_array_keys(scan, dir);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/*
+	 * Likewise, a skip scan finds the first value of the leading index column
+	 * during the first call.
+	 */
+	if (so->skipScan && !so->skipHaveValue)
+	{
+		Assert(!BTScanPosIsValid(so->currPos));
+		if (!_bt_advance_skip_key(scan, dir))
+			return false;
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, or to the next
+	 * leading column value in a skip scan, if any
+	 */
 	do
 	{
 		/*
@@ -404,7 +419,8 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 		if (res)
 			break;
 		/* ... otherwise see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
+	} while ((so->numArrayKeys && _bt_advance_array_keys(scan, dir)) ||
+			 (so->skipScan && _bt_advance_skip_key(scan, dir)));
 
 	return res;
 }
@@ -486,16 +502,20 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so = (BTScanOpaque) palloc(sizeof(BTScanOpaqueData));
 	BTScanPosInvalidate(so->currPos);
 	BTScanPosInvalidate(so->markPos);
-	if (scan->numberOfKeys > 0)
-		so->keyData = (ScanKey) palloc(scan->numberOfKeys * sizeof(ScanKeyData));
-	else
-		so->keyData = NULL;
+	/* leave room for the extra key added by a skip scan */
+	so->keyData = (ScanKey) palloc((scan->numberOfKeys + 1) *
+								   sizeof(ScanKeyData));
 
 	so->arrayKeyData = NULL;	/* assume no array keys for now */
 	so->numArrayKeys = 0;
 	so->arrayKeys = NULL;
 	so->arrayContext = NULL;
 
+	so->skipScan = false;		/* caller may ask for it before btrescan */
+	so->skipHaveValue = false;
+	so->skipKeyData = NULL;
+	so->skipContext = NULL;
+
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 
@@ -571,6 +591,9 @@ btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 
 	/* If any keys are SK_SEARCHARRAY type, set up array-key info */
 	_bt_preprocess_array_keys(scan);
+
+	/* If caller asked for a skip scan, set up the skip key */
+	_bt_preprocess_skip_key(scan);
 }
 
 /*
@@ -601,6 +624,9 @@ btendscan(IndexScanDesc scan)
 	/* so->arrayKeyData and so->arrayKeys are in arrayContext */
 	if (so->arrayContext != NULL)
 		MemoryContextDelete(so->arrayContext);
+	/* likewise so->skipKeyData is in skipContext */
+	if (so->skipContext != NULL)
+		MemoryContextDelete(so->skipContext);
 	if (so->killedItems != NULL)
 		pfree(so->killedItems);
 	if (so->currTuples != NULL)
@@ -617,6 +643,14 @@ btmarkpos(IndexScanDesc scan)
 {
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 
+	/*
+	 * We don't remember the skip key's value, so restoring a mark set in an
+	 * earlier primitive scan of a skip scan would go wrong.  The planner
+	 * never asks for mark/restore of a skip scan.
+	 */
+	if (so->skipScan)
+		elog(ERROR, "btree skip scans do not support mark/restore");
+
 	/* There may be an old mark with a pin (but no lock). */
 	BTScanPosUnpinIfPinned(so->markPos);
 
@@ -639,6 +673,35 @@ btmarkpos(IndexScanDesc scan)
 		_bt_mark_array_keys(scan);
 }
 
+/*
+ *	btskip() -- skip the remaining entries with the current leading value
+ *
+ * In a skip scan, end the current primitive index scan and advance the skip
+ * key to the next value of the first index column.  The next btgettuple call
+ * then starts a new primitive scan for that value.  Returns false if there
+ * are no more values.  If this isn't a skip scan, we just continue as usual.
+ */
+bool
+btskip(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+
+	if (!so->skipScan || !so->skipHaveValue)
+		return true;
+
+	/* Drop the current page, as btrescan does */
+	if (BTScanPosIsValid(so->currPos))
+	{
+		/* Before leaving current page, deal with any killed items */
+		if (so->numKilled > 0)
+			_bt_killitems(scan);
+		BTScanPosUnpinIfPinned(so->currPos);
+		BTScanPosInvalidate(so->currPos);
+	}
+
+	return _bt_advance_skip_key(scan, dir);
+}
+
 /*
  *	btrestrpos() -- restore scan to last saved position
  */
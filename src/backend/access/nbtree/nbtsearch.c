@@ -422,6 +422,11 @@ _bt_binsrch(Relation rel,
  * does not matter.  This convention allows us to implement the Lehman and
  * Yao convention that the first down-link pointer is before the first key.
  * See backend/access/nbtree/README for details.
+ *
+ * Likewise, key attributes that were suffix-truncated away from a pivot
+ * tuple are "minus infinity": if the scankey has more attributes than the
+ * tuple and is equal on all of the tuple's attributes, the scankey is
+ * considered greater.
  *----------
  */
 int32
@@ -434,6 +439,8 @@ _bt_compare(Relation rel,
 	TupleDesc	itupdesc = RelationGetDescr(rel);
 	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
 	IndexTuple	itup;
+	int			ntupatts;
+	int			ncmpkey;
 	int			i;
 
 	/*
@@ -444,6 +451,8 @@ _bt_compare(Relation rel,
 		return 1;
 
 	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	ntupatts = BTreeTupleGetNAtts(itup, rel);
+	ncmpkey = Min(ntupatts, keysz);
 
 	/*
 	 * The scan key is set up with the attribute number associated with each
@@ -457,7 +466,7 @@ _bt_compare(Relation rel,
 	 * _bt_first).
 	 */
 
-	for (i = 1; i <= keysz; i++)
+	for (i = 1; i <= ncmpkey; i++)
 	{
 		Datum		datum;
 		bool		isNull;
@@ -508,6 +517,14 @@ _bt_compare(Relation rel,
 		scankey++;
 	}
 
+	/*
+	 * All the attributes we compared are equal.  If the tuple's remaining
+	 * attributes were truncated away, they are minus infinity, so the
+	 * scankey is greater.
+	 */
+	if (keysz > ntupatts)
+		return 1;
+
 	/* if we get here, the keys are equal */
 	return 0;
 }
@@ -1161,6 +1178,130 @@ _bt_next(IndexScanDesc scan, ScanDirection dir)
 	return true;
 }
 
+/*
+ *	_bt_advance_skip_key() -- Advance a skip scan to the next leading value
+ *
+ *		In a skip scan (see _bt_preprocess_skip_key), find the first index
+ *		entry whose first column is beyond the skip key's current value, or
+ *		the first entry in the index if the skip key has no value yet, and
+ *		set the skip key to that entry's first column.  The caller then
+ *		starts a new primitive scan with _bt_first.
+ *
+ *		Returns false, and resets the skip key, if there are no more values.
+ *		This only finds values, it doesn't check them against the other scan
+ *		keys; the primitive scan does that.
+ *
+ *		so->currPos must be invalid on entry.  No pins or locks are held on
+ *		exit.
+ */
+bool
+_bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	OffsetNumber offnum;
+	IndexTuple	itup;
+	Datum		value;
+	bool		isnull;
+
+	Assert(so->skipScan);
+	Assert(!BTScanPosIsValid(so->currPos));
+
+	if (!ScanDirectionIsForward(dir))
+		elog(ERROR, "btree skip scans do not support backward scan");
+
+	if (so->skipHaveValue)
+	{
+		ScanKey		skip = &so->skipKeyData[0];
+		ScanKeyData scankey;
+		BTStack		stack;
+
+		/*
+		 * Build an insertion scankey for the current value, and find the
+		 * first item > scankey.
+		 */
+		ScanKeyEntryInitializeWithInfo(&scankey,
+									   (skip->sk_flags & SK_ISNULL) |
+									   (rel->rd_indoption[0] <<
+										SK_BT_INDOPTION_SHIFT),
+									   1,
+									   InvalidStrategy,
+									   rel->rd_opcintype[0],
+									   rel->rd_indcollation[0],
+									   index_getprocinfo(rel, 1,
+														 BTORDER_PROC),
+									   skip->sk_argument);
+
+		stack = _bt_search(rel, 1, &scankey, true, &buf, BT_READ,
+						   scan->xs_snapshot);
+		_bt_freestack(stack);
+		if (BufferIsValid(buf))
+			offnum = _bt_binsrch(rel, buf, 1, &scankey, true);
+	}
+	else
+	{
+		buf = _bt_get_endpoint(rel, 0, false, scan->xs_snapshot);
+		if (BufferIsValid(buf))
+		{
+			opaque = (BTPageOpaque) PageGetSpecialPointer(BufferGetPage(buf));
+			offnum = P_FIRSTDATAKEY(opaque);
+		}
+	}
+
+	if (!BufferIsValid(buf))
+	{
+		/* Empty index; lock the whole relation, as _bt_first does */
+		PredicateLockRelation(rel, scan->xs_snapshot);
+		so->skipHaveValue = false;
+		return false;
+	}
+
+	/*
+	 * If we are past the end of the page, the value we want is the first
+	 * item on a later page.
+	 */
+	for (;;)
+	{
+		BlockNumber blkno;
+
+		page = BufferGetPage(buf);
+		TestForOldSnapshot(scan->xs_snapshot, rel, page);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+		if (!P_IGNORE(opaque))
+		{
+			PredicateLockPage(rel, BufferGetBlockNumber(buf),
+							  scan->xs_snapshot);
+			if (offnum <= PageGetMaxOffsetNumber(page))
+				break;
+		}
+
+		blkno = opaque->btpo_next;
+		_bt_relbuf(rel, buf);
+		if (blkno == P_NONE)
+		{
+			so->skipHaveValue = false;
+			return false;
+		}
+
+		/* check for interrupts while we're not holding any buffer lock */
+		CHECK_FOR_INTERRUPTS();
+		buf = _bt_getbuf(rel, blkno, BT_READ);
+		offnum = P_FIRSTDATAKEY((BTPageOpaque)
+								PageGetSpecialPointer(BufferGetPage(buf)));
+	}
+
+	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	value = index_getattr(itup, 1, RelationGetDescr(rel), &isnull);
+	_bt_set_skip_key(scan, value, isnull);
+
+	_bt_relbuf(rel, buf);
+
+	return true;
+}
+
 /*
  *	_bt_readpage() -- Load data from current index page into so->currPos
  *
@@ -510,6 +510,7 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		ItemId		ii;
 		ItemId		hii;
 		IndexTuple	oitup;
+		IndexTuple	truncated = NULL;
 
 		/* Create new page of same level */
 		npage = _bt_blnewpage(state->btps_level);
@@ -529,6 +530,25 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		oitup = (IndexTuple) PageGetItem(opage, ii);
 		_bt_sortaddtup(npage, ItemIdGetLength(ii), oitup, P_FIRSTKEY);
 
+		/*
+		 * On the leaf level, the high key can be suffix-truncated just like
+		 * in _bt_split(), keeping only the attributes that separate it from
+		 * the item before it, which stays on opage.  Build it now, while
+		 * both items are still in place.
+		 */
+		if (state->btps_level == 0)
+		{
+			ItemId		lii = PageGetItemId(opage, OffsetNumberPrev(last_off));
+			IndexTuple	lastleft = (IndexTuple) PageGetItem(opage, lii);
+
+			truncated = _bt_truncate(wstate->index, lastleft, oitup);
+			if (!BTreeTupleIsTruncated(truncated))
+			{
+				pfree(truncated);
+				truncated = NULL;
+			}
+		}
+
 		/*
 		 * Move 'last' into the high key position on opage
 		 */
@@ -537,6 +557,22 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		ItemIdSetUnused(ii);	/* redundant */
 		((PageHeader) opage)->pd_lower -= sizeof(ItemIdData);
 
+		/*
+		 * Replace the high key with its truncated version, if any.  oitup
+		 * must keep pointing at the page's high key, since that's what the
+		 * next downlink is copied from.
+		 */
+		if (truncated)
+		{
+			PageIndexTupleDelete(opage, P_HIKEY);
+			_bt_sortaddtup(opage, IndexTupleSize(truncated), truncated,
+						   P_HIKEY);
+			pfree(truncated);
+
+			hii = PageGetItemId(opage, P_HIKEY);
+			oitup = (IndexTuple) PageGetItem(opage, hii);
+		}
+
 		/*
 		 * Link the old page into its parent, using its minimum key. If we
 		 * don't have a parent, we have to create one; this adds a new btree
@@ -546,7 +582,7 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 			state->btps_next = _bt_pagestate(wstate, state->btps_level + 1);
 
 		Assert(state->btps_minkey != NULL);
-		ItemPointerSet(&(state->btps_minkey->t_tid), oblkno, P_HIKEY);
+		BTreeInnerTupleSetDownLink(state->btps_minkey, oblkno);
 		_bt_buildadd(wstate, state->btps_next, state->btps_minkey);
 		pfree(state->btps_minkey);
 
@@ -643,7 +679,7 @@ _bt_uppershutdown(BTWriteState *wstate, BTPageState *state)
 		else
 		{
 			Assert(s->btps_minkey != NULL);
-			ItemPointerSet(&(s->btps_minkey->t_tid), blkno, P_HIKEY);
+			BTreeInnerTupleSetDownLink(s->btps_minkey, blkno);
 			_bt_buildadd(wstate, s->btps_next, s->btps_minkey);
 			pfree(s->btps_minkey);
 			s->btps_minkey = NULL;
@@ -22,6 +22,7 @@
 #include "access/relscan.h"
 #include "miscadmin.h"
 #include "utils/array.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -56,7 +57,10 @@ static bool _bt_check_rowcompare(ScanKey skey,
  *		Build an insertion scan key that contains comparison data from itup
  *		as well as comparator routines appropriate to the key datatypes.
  *
- *		The result is intended for use with _bt_compare().
+ *		The result is intended for use with _bt_compare().  If itup is a
+ *		pivot tuple whose trailing attributes were truncated away, the
+ *		scan key has only BTreeTupleGetNAtts() entries, and callers must
+ *		pass that as keysz.
  */
 ScanKey
 _bt_mkscankey(Relation rel, IndexTuple itup)
@@ -68,7 +72,7 @@ _bt_mkscankey(Relation rel, IndexTuple itup)
 	int			i;
 
 	itupdesc = RelationGetDescr(rel);
-	natts = RelationGetNumberOfAttributes(rel);
+	natts = BTreeTupleGetNAtts(itup, rel);
 	indoption = rel->rd_indoption;
 
 	skey = (ScanKey) palloc(natts * sizeof(ScanKeyData));
@@ -148,6 +152,92 @@ _bt_mkscankey_nodata(Relation rel)
 	return skey;
 }
 
+/*
+ * _bt_keep_natts
+ *		Determine the number of leading attributes that a pivot tuple must
+ *		keep to separate lastleft from firstright.
+ *
+ *		Returns natts + 1 if the tuples are equal on all attributes.  Note
+ *		that equality is determined by the opclass's comparator, not by
+ *		binary equality, since that is the only thing _bt_compare() cares
+ *		about.
+ */
+static int
+_bt_keep_natts(Relation rel, IndexTuple lastleft, IndexTuple firstright)
+{
+	TupleDesc	itupdesc = RelationGetDescr(rel);
+	int			natts = RelationGetNumberOfAttributes(rel);
+	ScanKey		skey;
+	int			keepnatts;
+	int			i;
+
+	skey = _bt_mkscankey_nodata(rel);
+
+	keepnatts = 1;
+	for (i = 1; i <= natts; i++)
+	{
+		Datum		datum1,
+					datum2;
+		bool		isNull1,
+					isNull2;
+
+		datum1 = index_getattr(lastleft, i, itupdesc, &isNull1);
+		datum2 = index_getattr(firstright, i, itupdesc, &isNull2);
+
+		if (isNull1 != isNull2)
+			break;
+
+		if (!isNull1 &&
+			DatumGetInt32(FunctionCall2Coll(&skey[i - 1].sk_func,
+											skey[i - 1].sk_collation,
+											datum1,
+											datum2)) != 0)
+			break;
+
+		keepnatts++;
+	}
+
+	_bt_freeskey(skey);
+
+	return keepnatts;
+}
+
+/*
+ * _bt_truncate
+ *		Build the pivot tuple that separates lastleft from firstright in a
+ *		leaf page split.
+ *
+ *		The result is palloc'd, and is used both as the new high key of the
+ *		left half and as the downlink to the right half.  It has only as many
+ *		leading key attributes of firstright as are needed to tell the two
+ *		tuples apart; see "Suffix truncation" in nbtree/README.  When no
+ *		attribute can be removed, this is a plain copy of firstright.
+ */
+IndexTuple
+_bt_truncate(Relation rel, IndexTuple lastleft, IndexTuple firstright)
+{
+	int			natts = RelationGetNumberOfAttributes(rel);
+	int			keepnatts;
+	IndexTuple	pivot;
+
+	Assert(!BTreeTupleIsTruncated(lastleft));
+	Assert(!BTreeTupleIsTruncated(firstright));
+
+	/* Nothing to truncate in a single-column index */
+	if (natts == 1)
+		return CopyIndexTuple(firstright);
+
+	keepnatts = _bt_keep_natts(rel, lastleft, firstright);
+	if (keepnatts >= natts)
+		return CopyIndexTuple(firstright);
+
+	pivot = index_truncate_tuple(RelationGetDescr(rel), firstright,
+								 keepnatts);
+	BTreeTupleSetNAtts(pivot, keepnatts);
+
+	return pivot;
+}
+
 /*
  * free a scan key made by either _bt_mkscankey or _bt_mkscankey_nodata.
  */
@@ -656,14 +746,140 @@ _bt_restore_array_keys(IndexScanDesc scan)
 	}
 }
 
+/*
+ *	_bt_preprocess_skip_key() -- Set up the skip key for a skip scan
+ *
+ * A skip scan is a series of primitive index scans, one for each distinct
+ * value of the first index column.  Each primitive scan uses the scan keys
+ * plus an extra "=" key on the first column, the skip key, that supplies the
+ * value.  That lets keys on the later columns position the scan and end it
+ * early, just as if the query had specified the first column's value; so a
+ * query with quals only on later columns need not read the whole index when
+ * the first column has few distinct values.  We prepare so->skipKeyData here,
+ * with the skip key in front of a copy of scan->keyData, and
+ * _bt_advance_skip_key fills in the successive values.
+ *
+ * We only do a skip scan if the caller asked for one, and only in a
+ * non-parallel scan without array keys; otherwise we quietly fall back to an
+ * ordinary scan, which returns the same tuples.  Skip scans are forward-only.
+ */
+void
+_bt_preprocess_skip_key(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	MemoryContext oldContext;
+
+	so->skipHaveValue = false;
+	so->skipScan = (scan->xs_skipscan &&
+					so->numArrayKeys == 0 &&
+					scan->parallel_scan == NULL);
+	if (!so->skipScan)
+		return;
+
+	/*
+	 * The workspace lasts for the whole scan, since the scan keys are always
+	 * the same number; only their contents change on a rescan.
+	 */
+	if (so->skipContext == NULL)
+	{
+		Oid			eqop;
+
+		so->skipContext = AllocSetContextCreate(CurrentMemoryContext,
+												"BTree skip context",
+												ALLOCSET_SMALL_SIZES);
+		oldContext = MemoryContextSwitchTo(so->skipContext);
+
+		so->skipKeyData = (ScanKey)
+			palloc((scan->numberOfKeys + 1) * sizeof(ScanKeyData));
+
+		eqop = get_opfamily_member(rel->rd_opfamily[0],
+								   rel->rd_opcintype[0],
+								   rel->rd_opcintype[0],
+								   BTEqualStrategyNumber);
+		if (!OidIsValid(eqop))
+			elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+				 BTEqualStrategyNumber, rel->rd_opcintype[0],
+				 rel->rd_opcintype[0], rel->rd_opfamily[0]);
+		ScanKeyEntryInitialize(&so->skipKeyData[0],
+							   0,
+							   1,
+							   BTEqualStrategyNumber,
+							   rel->rd_opcintype[0],
+							   rel->rd_indcollation[0],
+							   get_opcode(eqop),
+							   (Datum) 0);
+
+		MemoryContextSwitchTo(oldContext);
+	}
+	else if (!(so->skipKeyData[0].sk_flags & SK_ISNULL) &&
+			 !RelationGetDescr(rel)->attrs[0]->attbyval)
+	{
+		/* Release the value left over from the previous scan, if any */
+		if (DatumGetPointer(so->skipKeyData[0].sk_argument) != NULL)
+			pfree(DatumGetPointer(so->skipKeyData[0].sk_argument));
+	}
+	so->skipKeyData[0].sk_flags = 0;
+	so->skipKeyData[0].sk_argument = (Datum) 0;
+
+	if (scan->numberOfKeys > 0)
+		memcpy(so->skipKeyData + 1,
+			   scan->keyData,
+			   scan->numberOfKeys * sizeof(ScanKeyData));
+}
+
+/*
+ * _bt_set_skip_key() -- Make the skip key compare against the given value
+ *
+ * The value is copied into the skip scan's workspace.
+ */
+void
+_bt_set_skip_key(IndexScanDesc scan, Datum value, bool isnull)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	Form_pg_attribute att = RelationGetDescr(rel)->attrs[0];
+	ScanKey		skey = &so->skipKeyData[0];
+
+	Assert(so->skipScan);
+
+	/* Release the previous value, if we copied one */
+	if (!(skey->sk_flags & SK_ISNULL) && !att->attbyval &&
+		DatumGetPointer(skey->sk_argument) != NULL)
+		pfree(DatumGetPointer(skey->sk_argument));
+
+	if (isnull)
+	{
+		/* _bt_fix_scankey_strategy will adjust the other fields */
+		skey->sk_flags = SK_ISNULL | SK_SEARCHNULL;
+		skey->sk_argument = (Datum) 0;
+	}
+	else
+	{
+		MemoryContext oldContext;
+
+		/* Undo any changes made for a NULL value */
+		skey->sk_flags = 0;
+		skey->sk_strategy = BTEqualStrategyNumber;
+		skey->sk_subtype = rel->rd_opcintype[0];
+		skey->sk_collation = rel->rd_indcollation[0];
+
+		oldContext = MemoryContextSwitchTo(so->skipContext);
+		skey->sk_argument = datumCopy(value, att->attbyval, att->attlen);
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	so->skipHaveValue = true;
+}
 
 /*
  *	_bt_preprocess_keys() -- Preprocess scan keys
  *
- * The given search-type keys (in scan->keyData[] or so->arrayKeyData[])
- * are copied to so->keyData[] with possible transformation.
- * scan->numberOfKeys is the number of input keys, so->numberOfKeys gets
- * the number of output keys (possibly less, never greater).
+ * The given search-type keys (in scan->keyData[], so->arrayKeyData[] or
+ * so->skipKeyData[]) are copied to so->keyData[] with possible
+ * transformation.  scan->numberOfKeys is the number of input keys (plus one
+ * for the skip key in a skip scan), so->numberOfKeys gets the number of
+ * output keys (possibly less, never greater).
  *
  * The output keys are marked with additional sk_flag bits beyond the
  * system-standard bits supplied by the caller.  The DESC and NULLS_FIRST
@@ -762,17 +978,23 @@ _bt_preprocess_keys(IndexScanDesc scan)
 	so->qual_ok = true;
 	so->numberOfKeys = 0;
 
-	if (numberOfKeys < 1)
-		return;					/* done if qual-less scan */
-
 	/*
-	 * Read so->arrayKeyData if array keys are present, else scan->keyData
+	 * Read so->skipKeyData in a skip scan, else so->arrayKeyData if array
+	 * keys are present, else scan->keyData
 	 */
-	if (so->arrayKeyData != NULL)
+	if (so->skipScan)
+	{
+		inkeys = so->skipKeyData;
+		numberOfKeys++;
+	}
+	else if (so->arrayKeyData != NULL)
 		inkeys = so->arrayKeyData;
 	else
 		inkeys = scan->keyData;
 
+	if (numberOfKeys < 1)
+		return;					/* done if qual-less scan */
+
 	outkeys = so->keyData;
 	cur = &inkeys[0];
 	/* we check that input keys are correctly ordered */
@@ -101,6 +101,13 @@ volatile bool ParallelMessagePending = false;
 /* Are we initializing a parallel worker? */
 bool		InitializingParallelWorker = false;
 
+/*
+ * May this parallel worker insert tuples?  Set by workers that insert on
+ * behalf of their leader, using the XID and command ID it set up for them
+ * (see parallel COPY FROM); insertions are forbidden otherwise.
+ */
+bool		ParallelWorkerInsertsAllowed = false;
+
 /* Pointer to our fixed parallel state. */
 static FixedParallelState *MyFixedParallelState;
 
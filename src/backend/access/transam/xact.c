@@ -691,11 +691,15 @@ GetCurrentCommandId(bool used)
 	{
 		/*
 		 * Forbid setting currentCommandIdUsed in parallel mode, because we
-		 * have no provision for communicating this back to the master.  We
-		 * could relax this restriction when currentCommandIdUsed was already
-		 * true at the start of the parallel operation.
+		 * have no provision for communicating this back to the master.  It's
+		 * OK if it was already true at the start of the parallel operation,
+		 * as it is in the leader of a parallel write, and in workers the
+		 * leader set up to insert with its command ID (parallel COPY FROM).
+		 * Those may still get here, e.g. when btree registers a relcache
+		 * invalidation on creating an index's root page.
 		 */
-		Assert(CurrentTransactionState->parallelModeLevel == 0);
+		Assert(CurrentTransactionState->parallelModeLevel == 0 ||
+			   currentCommandIdUsed || ParallelWorkerInsertsAllowed);
 		currentCommandIdUsed = true;
 	}
 	return currentCommandId;
@@ -6739,6 +6739,14 @@ StartupXLOG(void)
 		InRecovery = true;
 	}
 
+	/*
+	 * If no WAL needs to be replayed, we were shut down cleanly and the
+	 * statistics saved at that time are still valid; load them into shared
+	 * memory.  Otherwise they are discarded below.
+	 */
+	if (!InRecovery)
+		pgstat_restore_stats();
+
 	/* REDO */
 	if (InRecovery)
 	{
@@ -589,10 +589,11 @@ RelationBuildPartitionDesc(Relation rel)
  * Used in the keep logic of relcache.c (ie, in RelationClearRelation()).
  * This is also useful when b1 and b2 are bound collections of two separate
  * relations, respectively, because PartitionBoundInfo is a canonical
- * representation of partition bounds.
+ * representation of partition bounds.  The planner relies on that to decide
+ * whether two partitioned relations can be joined partition-wise.
  */
 bool
-partition_bounds_equal(PartitionKey key,
+partition_bounds_equal(int partnatts, int16 *parttyplen, bool *parttypbyval,
 					   PartitionBoundInfo b1, PartitionBoundInfo b2)
 {
 	int			i;
@@ -613,7 +614,7 @@ partition_bounds_equal(PartitionKey key,
 	{
 		int			j;
 
-		for (j = 0; j < key->partnatts; j++)
+		for (j = 0; j < partnatts; j++)
 		{
 			/* For range partitions, the bounds might not be finite. */
 			if (b1->content != NULL)
@@ -642,8 +643,7 @@ partition_bounds_equal(PartitionKey key,
 			 * context.  datumIsEqual() should be simple enough to be safe.
 			 */
 			if (!datumIsEqual(b1->datums[i][j], b2->datums[i][j],
-							  key->parttypbyval[j],
-							  key->parttyplen[j]))
+							  parttypbyval[j], parttyplen[j]))
 				return false;
 		}
 
@@ -652,7 +652,7 @@ partition_bounds_equal(PartitionKey key,
 	}
 
 	/* There are ndatums+1 indexes in case of range partitions */
-	if (key->strategy == PARTITION_STRATEGY_RANGE &&
+	if (b1->strategy == PARTITION_STRATEGY_RANGE &&
 		b1->indexes[i] != b2->indexes[i])
 		return false;
 
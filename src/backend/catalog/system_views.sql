@@ -193,7 +193,8 @@ CREATE VIEW pg_stats_ext AS
         S.staname AS staname,
         S.stakeys AS attnums,
         length(s.standistinct::bytea) AS ndistbytes,
-        length(S.stadependencies::bytea) AS depsbytes
+        length(S.stadependencies::bytea) AS depsbytes,
+        length(S.stamcv::bytea) AS mcvbytes
     FROM (pg_statistic_ext S JOIN pg_class C ON (C.oid = S.starelid))
         LEFT JOIN pg_namespace N ON (N.oid = C.relnamespace);
 
@@ -279,6 +280,9 @@ CREATE VIEW pg_locks AS
 CREATE VIEW pg_cursors AS
     SELECT * FROM pg_cursor() AS C;
 
+CREATE VIEW pg_catalog_cache_stats AS
+    SELECT * FROM pg_get_catalog_cache_stats() AS S;
+
 CREATE VIEW pg_available_extensions AS
     SELECT E.name, E.default_version, X.extversion AS installed_version,
            E.comment
@@ -723,6 +723,17 @@ pg_listening_channels(PG_FUNCTION_ARGS)
 	SRF_RETURN_DONE(funcctx);
 }
 
+/*
+ * HaveListenChannels
+ *
+ * Is this session listening on any channel?
+ */
+bool
+HaveListenChannels(void)
+{
+	return listenChannels != NIL;
+}
+
 /*
  * Async_UnlistenOnExit
  *
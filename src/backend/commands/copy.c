@@ -20,11 +20,15 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+#include "access/genam.h"
 #include "access/heapam.h"
 #include "access/htup_details.h"
+#include "access/parallel.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
 #include "access/xlog.h"
+#include "catalog/partition.h"
+#include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "commands/copy.h"
 #include "commands/defrem.h"
@@ -37,10 +41,17 @@
 #include "optimizer/clauses.h"
 #include "optimizer/planner.h"
 #include "nodes/makefuncs.h"
+#include "pgstat.h"
+#include "port/atomics.h"
 #include "rewrite/rewriteHandler.h"
+#include "storage/condition_variable.h"
 #include "storage/fd.h"
+#include "storage/proc.h"
+#include "storage/spin.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
+#include "utils/dsa.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/portal.h"
@@ -132,6 +143,9 @@ typedef struct CopyStateData
 	bool		convert_selectively;	/* do selective binary conversion? */
 	List	   *convert_select; /* list of column names (can be NIL) */
 	bool	   *convert_select_flags;	/* per-column CSV/TEXT CS flags */
+	int			nworkers;		/* number of parallel workers for COPY FROM */
+	List	   *attnamelist;	/* column name list, for parallel workers */
+	List	   *options;		/* List of DefElem, for parallel workers */
 
 	/* these are just for error messages, see CopyFromErrorCallback */
 	const char *cur_relname;	/* table name for error messages */
@@ -171,6 +185,17 @@ typedef struct CopyStateData
 	TupleConversionMap **partition_tupconv_maps;
 	TupleTableSlot *partition_tuple_slot;
 
+	/*
+	 * In a parallel COPY FROM worker, input lines come from chunks of shared
+	 * memory filled by the leader, see ParallelCopyReadLine.
+	 */
+	struct ParallelCopyShared *pcshared;	/* NULL if not a worker */
+	struct ParallelCopyChunk *pcchunks;
+	dsa_area   *pcarea;			/* holds lines too long for a chunk */
+	int			pcchunk;		/* index of claimed chunk, or -1 */
+	int			pcline;			/* next line to return from it */
+	int			pcoffset;		/* offset of that line in the chunk */
+
 	/*
 	 * These variables are used to reduce overhead in textual COPY FROM.
 	 *
@@ -201,8 +226,9 @@ typedef struct CopyStateData
 	 * Finally, raw_buf holds raw data read from the data source (file or
 	 * client connection).  CopyReadLine parses this data sufficiently to
 	 * locate line boundaries, then transfers the data to line_buf and
-	 * converts it.  Note: we guarantee that there is a \0 at
-	 * raw_buf[raw_buf_len].
+	 * converts it.  In binary mode, all input is read through raw_buf too,
+	 * so that fields are normally decoded straight out of it.  Note: we
+	 * guarantee that there is a \0 at raw_buf[raw_buf_len].
 	 */
 #define RAW_BUF_SIZE 65536		/* we palloc RAW_BUF_SIZE+1 bytes */
 	char	   *raw_buf;
@@ -210,6 +236,63 @@ typedef struct CopyStateData
 	int			raw_buf_len;	/* total # of bytes stored */
 } CopyStateData;
 
+/* Number of unprocessed bytes in raw_buf */
+#define RAW_BUF_BYTES(cstate) ((cstate)->raw_buf_len - (cstate)->raw_buf_index)
+
+/*
+ * Parallel COPY FROM.
+ *
+ * The leader reads the input and splits it into lines, just as a serial COPY
+ * FROM would, and copies the lines into chunks in dynamic shared memory.
+ * Workers claim filled chunks in turn and do everything else: they split the
+ * lines into fields, run the input functions, evaluate defaults and check
+ * constraints, and insert the tuples and their index entries, all under the
+ * leader's transaction and command ID.  Only tables whose rows can be
+ * inserted without consulting backend-local state are loaded this way; see
+ * CopyFromParallelSafe.
+ *
+ * Chunks are used as a ring: the leader fills them in order, waiting for a
+ * chunk to be released by the worker that last had it, and workers claim
+ * them in the same order.  Each line is stored as an int32 length followed
+ * by the line's bytes; a line too long for a chunk gets a chunk of its own,
+ * with the line itself in a DSA allocation.
+ */
+#define PARALLEL_COPY_KEY_SHARED		UINT64CONST(0xC000000000000001)
+#define PARALLEL_COPY_KEY_CHUNKS		UINT64CONST(0xC000000000000002)
+#define PARALLEL_COPY_KEY_STATE			UINT64CONST(0xC000000000000003)
+#define PARALLEL_COPY_KEY_DSA			UINT64CONST(0xC000000000000004)
+
+#define PARALLEL_COPY_CHUNK_SIZE		65536
+#define PARALLEL_COPY_CHUNKS_PER_WORKER	4
+
+typedef struct ParallelCopyChunk
+{
+	bool		busy;			/* being filled, or not yet released */
+	int			first_lineno;	/* line number of first line, for errors */
+	int			nlines;			/* number of lines stored */
+	int			used;			/* bytes of data[] used */
+	dsa_pointer big_line;		/* the only line, if too long for data[] */
+	int32		big_len;		/* length of same */
+	char		data[PARALLEL_COPY_CHUNK_SIZE];
+} ParallelCopyChunk;
+
+typedef struct ParallelCopyShared
+{
+	Oid			relid;			/* target table */
+	CommandId	mycid;			/* leader's command ID */
+	int			hi_options;		/* heap_insert options chosen by CopyFrom */
+	int			nchunks;		/* size of the chunk ring */
+	PGPROC	   *leader;			/* to wake the leader when a chunk is free */
+	pg_atomic_uint64 processed; /* tuples inserted by all workers */
+	ConditionVariable chunk_ready_cv;	/* signaled when a chunk is submitted */
+
+	/* protected by mutex, along with the chunks' busy flags */
+	slock_t		mutex;
+	uint64		nsubmitted;		/* chunks submitted by the leader */
+	uint64		nclaimed;		/* chunks claimed by workers */
+	bool		input_done;		/* leader has submitted all input */
+} ParallelCopyShared;
+
 /* DestReceiver for COPY (query) TO */
 typedef struct
 {
@@ -301,6 +384,19 @@ static uint64 DoCopyTo(CopyState cstate);
 static uint64 CopyTo(CopyState cstate);
 static void CopyOneRowTo(CopyState cstate, Oid tupleOid,
 			 Datum *values, bool *nulls);
+static uint64 CopyFromInsertRows(CopyState cstate, CommandId mycid,
+				   int hi_options);
+static bool CopyFromParallelSafe(CopyState cstate);
+static uint64 CopyFromParallel(CopyState cstate, CommandId mycid,
+				 int hi_options);
+static ParallelCopyChunk *ParallelCopyNextFreeChunk(ParallelContext *pcxt,
+						  ParallelCopyShared *shared,
+						  ParallelCopyChunk *chunks);
+static void ParallelCopySubmitChunk(ParallelCopyShared *shared,
+						ParallelCopyChunk *chunk);
+static void ParallelCopyMain(dsm_segment *seg, shm_toc *toc);
+static int	ParallelCopyGetData(void *outbuf, int minread, int maxread);
+static bool ParallelCopyReadLine(CopyState cstate);
 static void CopyFromInsertBatch(CopyState cstate, EState *estate,
 					CommandId mycid, int hi_options,
 					ResultRelInfo *resultRelInfo, TupleTableSlot *myslot,
@@ -309,6 +405,8 @@ static void CopyFromInsertBatch(CopyState cstate, EState *estate,
 					int firstBufferedLineNo);
 static bool CopyReadLine(CopyState cstate);
 static bool CopyReadLineText(CopyState cstate);
+static char *CopyScanForSpecial(char *ptr, char *end,
+				   const char *specials, int nspecials);
 static int	CopyReadAttributesText(CopyState cstate);
 static int	CopyReadAttributesCSV(CopyState cstate);
 static Datum CopyReadBinaryAttribute(CopyState cstate,
@@ -332,6 +430,7 @@ static void CopySendChar(CopyState cstate, char c);
 static void CopySendEndOfRow(CopyState cstate);
 static int CopyGetData(CopyState cstate, void *databuf,
 			int minread, int maxread);
+static int	CopyReadBinaryData(CopyState cstate, char *dest, int nbytes);
 static void CopySendInt32(CopyState cstate, int32 val);
 static bool CopyGetInt32(CopyState cstate, int32 *val);
 static void CopySendInt16(CopyState cstate, int16 val);
@@ -674,6 +773,7 @@ CopySendInt32(CopyState cstate, int32 val)
 
 /*
  * CopyGetInt32 reads an int32 that appears in network byte order
+ * (binary mode only, like all the CopyGet* functions)
  *
  * Returns true if OK, false if EOF
  */
@@ -682,7 +782,7 @@ CopyGetInt32(CopyState cstate, int32 *val)
 {
 	uint32		buf;
 
-	if (CopyGetData(cstate, &buf, sizeof(buf), sizeof(buf)) != sizeof(buf))
+	if (CopyReadBinaryData(cstate, (char *) &buf, sizeof(buf)) != sizeof(buf))
 	{
 		*val = 0;				/* suppress compiler warning */
 		return false;
@@ -711,7 +811,7 @@ CopyGetInt16(CopyState cstate, int16 *val)
 {
 	uint16		buf;
 
-	if (CopyGetData(cstate, &buf, sizeof(buf), sizeof(buf)) != sizeof(buf))
+	if (CopyReadBinaryData(cstate, (char *) &buf, sizeof(buf)) != sizeof(buf))
 	{
 		*val = 0;				/* suppress compiler warning */
 		return false;
@@ -756,6 +856,57 @@ CopyLoadRawBuf(CopyState cstate)
 	return (inbytes > 0);
 }
 
+/*
+ * CopyReadBinaryData
+ *
+ * Reads up to 'nbytes' bytes of binary COPY data from cstate->raw_buf into
+ * 'dest', refilling the buffer as needed.  Returns the number of bytes
+ * read, which is less than 'nbytes' only at EOF.
+ *
+ * Binary COPY is never used with the old protocol, so we're free to read
+ * ahead of what the current row needs.
+ */
+static int
+CopyReadBinaryData(CopyState cstate, char *dest, int nbytes)
+{
+	int			copied_bytes = 0;
+
+	if (RAW_BUF_BYTES(cstate) >= nbytes)
+	{
+		/* Enough bytes are present in the buffer. */
+		memcpy(dest, cstate->raw_buf + cstate->raw_buf_index, nbytes);
+		cstate->raw_buf_index += nbytes;
+		copied_bytes = nbytes;
+	}
+	else
+	{
+		/*
+		 * Not enough bytes in the buffer, so must read from the file.  Need
+		 * to loop since 'nbytes' could be larger than the buffer size.
+		 */
+		do
+		{
+			int			copy_bytes;
+
+			/* Load more data if buffer is empty. */
+			if (RAW_BUF_BYTES(cstate) == 0)
+			{
+				if (!CopyLoadRawBuf(cstate))
+					break;		/* EOF */
+			}
+
+			/* Transfer some bytes. */
+			copy_bytes = Min(nbytes - copied_bytes, RAW_BUF_BYTES(cstate));
+			memcpy(dest, cstate->raw_buf + cstate->raw_buf_index, copy_bytes);
+			cstate->raw_buf_index += copy_bytes;
+			dest += copy_bytes;
+			copied_bytes += copy_bytes;
+		} while (copied_bytes < nbytes);
+	}
+
+	return copied_bytes;
+}
+
 
 /*
  *	 DoCopy executes the SQL COPY statement
@@ -1023,6 +1174,7 @@ ProcessCopyOptions(ParseState *pstate,
 				   List *options)
 {
 	bool		format_specified = false;
+	bool		parallel_specified = false;
 	ListCell   *option;
 
 	/* Support external use for option sanity checking */
@@ -1207,6 +1359,22 @@ ProcessCopyOptions(ParseState *pstate,
 								defel->defname),
 						 parser_errposition(pstate, defel->location)));
 		}
+		else if (strcmp(defel->defname, "parallel") == 0)
+		{
+			if (parallel_specified)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options"),
+						 parser_errposition(pstate, defel->location)));
+			parallel_specified = true;
+			cstate->nworkers = defGetInt32(defel);
+			if (cstate->nworkers < 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("argument to option \"%s\" must be a non-negative integer",
+								defel->defname),
+						 parser_errposition(pstate, defel->location)));
+		}
 		else
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
@@ -1345,6 +1513,12 @@ ProcessCopyOptions(ParseState *pstate,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("COPY force null only available using COPY FROM")));
 
+	/* Check parallel */
+	if (cstate->nworkers > 0 && !is_from)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY parallel only available using COPY FROM")));
+
 	/* Don't allow the delimiter to appear in the null string. */
 	if (strchr(cstate->null_print, cstate->delim[0]) != NULL)
 		ereport(ERROR,
@@ -2297,30 +2471,9 @@ limit_printout_length(const char *str)
 uint64
 CopyFrom(CopyState cstate)
 {
-	HeapTuple	tuple;
-	TupleDesc	tupDesc;
-	Datum	   *values;
-	bool	   *nulls;
-	ResultRelInfo *resultRelInfo;
-	ResultRelInfo *saved_resultRelInfo = NULL;
-	EState	   *estate = CreateExecutorState(); /* for ExecConstraints() */
-	ExprContext *econtext;
-	TupleTableSlot *myslot;
-	MemoryContext oldcontext = CurrentMemoryContext;
-
-	ErrorContextCallback errcallback;
 	CommandId	mycid = GetCurrentCommandId(true);
 	int			hi_options = 0; /* start with default heap_insert options */
-	BulkInsertState bistate;
-	uint64		processed = 0;
-	bool		useHeapMultiInsert;
-	int			nBufferedTuples = 0;
-	int			prev_leaf_part_index = -1;
-
-#define MAX_BUFFERED_TUPLES 1000
-	HeapTuple  *bufferedTuples = NULL;	/* initialize to silence warning */
-	Size		bufferedTuplesSize = 0;
-	int			firstBufferedLineNo = 0;
+	uint64		processed;
 
 	Assert(cstate->rel);
 
@@ -2362,8 +2515,6 @@ CopyFrom(CopyState cstate)
 							RelationGetRelationName(cstate->rel))));
 	}
 
-	tupDesc = RelationGetDescr(cstate->rel);
-
 	/*----------
 	 * Check to see if we can avoid writing WAL
 	 *
@@ -2432,6 +2583,54 @@ CopyFrom(CopyState cstate)
 		hi_options |= HEAP_INSERT_FROZEN;
 	}
 
+	if (cstate->nworkers > 0 && CopyFromParallelSafe(cstate))
+		processed = CopyFromParallel(cstate, mycid, hi_options);
+	else
+		processed = CopyFromInsertRows(cstate, mycid, hi_options);
+
+	/*
+	 * If we skipped writing WAL, then we need to sync the heap (but not
+	 * indexes since those use WAL anyway)
+	 */
+	if (hi_options & HEAP_INSERT_SKIP_WAL)
+		heap_sync(cstate->rel);
+
+	return processed;
+}
+
+/*
+ * A subroutine of CopyFrom, to read all the input rows and insert them into
+ * the relation.  This is also the main loop of each parallel COPY FROM
+ * worker.
+ */
+static uint64
+CopyFromInsertRows(CopyState cstate, CommandId mycid, int hi_options)
+{
+	HeapTuple	tuple;
+	TupleDesc	tupDesc;
+	Datum	   *values;
+	bool	   *nulls;
+	ResultRelInfo *resultRelInfo;
+	ResultRelInfo *saved_resultRelInfo = NULL;
+	EState	   *estate = CreateExecutorState(); /* for ExecConstraints() */
+	ExprContext *econtext;
+	TupleTableSlot *myslot;
+	MemoryContext oldcontext = CurrentMemoryContext;
+
+	ErrorContextCallback errcallback;
+	BulkInsertState bistate;
+	uint64		processed = 0;
+	bool		useHeapMultiInsert;
+	int			nBufferedTuples = 0;
+	int			prev_leaf_part_index = -1;
+
+#define MAX_BUFFERED_TUPLES 1000
+	HeapTuple  *bufferedTuples = NULL;	/* initialize to silence warning */
+	Size		bufferedTuplesSize = 0;
+	int			firstBufferedLineNo = 0;
+
+	tupDesc = RelationGetDescr(cstate->rel);
+
 	/*
 	 * We need a ResultRelInfo so we can use the regular executor's
 	 * index-entry-making machinery.  (There used to be a huge amount of code
@@ -2655,6 +2854,23 @@ CopyFrom(CopyState cstate)
 
 				if (useHeapMultiInsert)
 				{
+					/*
+					 * CopyFromInsertBatch assumes the buffered tuples came
+					 * from consecutive lines, which may not be the case in a
+					 * parallel worker; flush first if this one doesn't follow
+					 * on.
+					 */
+					if (nBufferedTuples > 0 &&
+						cstate->cur_lineno != firstBufferedLineNo + nBufferedTuples)
+					{
+						CopyFromInsertBatch(cstate, estate, mycid, hi_options,
+											resultRelInfo, myslot, bistate,
+											nBufferedTuples, bufferedTuples,
+											firstBufferedLineNo);
+						nBufferedTuples = 0;
+						bufferedTuplesSize = 0;
+					}
+
 					/* Add this tuple to the tuple buffer */
 					if (nBufferedTuples == 0)
 						firstBufferedLineNo = cstate->cur_lineno;
@@ -2783,13 +2999,6 @@ CopyFrom(CopyState cstate)
 
 	FreeExecutorState(estate);
 
-	/*
-	 * If we skipped writing WAL, then we need to sync the heap (but not
-	 * indexes since those use WAL anyway)
-	 */
-	if (hi_options & HEAP_INSERT_SKIP_WAL)
-		heap_sync(cstate->rel);
-
 	return processed;
 }
 
@@ -2871,6 +3080,502 @@ CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
 	cstate->cur_lineno = save_cur_lineno;
 }
 
+/*
+ * Can the rows of this COPY FROM be inserted by parallel workers?
+ *
+ * Workers insert under the leader's transaction but have no access to its
+ * trigger queue, temporary buffers or predicate locks, so anything that
+ * would need those is loaded serially.  So is binary input, which can't be
+ * split into rows without decoding it.  Every expression a worker evaluates
+ * on the way -- input functions, defaults, check constraints, partition
+ * constraints and index expressions and predicates -- must be parallel safe.
+ */
+static bool
+CopyFromParallelSafe(CopyState cstate)
+{
+	Relation	rel = cstate->rel;
+	TupleDesc	tupDesc = RelationGetDescr(rel);
+	List	   *indexoidlist;
+	ListCell   *cur;
+	bool		safe = true;
+	int			i;
+
+	if (cstate->binary || cstate->file_has_oids ||
+		cstate->copy_dest == COPY_CALLBACK)
+		return false;
+
+	/* Foreign key checks are triggers too */
+	if (rel->rd_rel->relkind != RELKIND_RELATION ||
+		rel->rd_rel->relpersistence == RELPERSISTENCE_TEMP ||
+		rel->trigdesc != NULL)
+		return false;
+
+	if (IsInParallelMode() || IsolationIsSerializable())
+		return false;
+
+	foreach(cur, cstate->attnumlist)
+	{
+		int			attnum = lfirst_int(cur);
+
+		/* Domain constraints may run arbitrary functions */
+		if (get_typtype(tupDesc->attrs[attnum - 1]->atttypid) == TYPTYPE_DOMAIN ||
+			func_parallel(cstate->in_functions[attnum - 1].fn_oid) != PROPARALLEL_SAFE)
+			return false;
+	}
+
+	for (i = 0; i < cstate->num_defaults; i++)
+	{
+		if (!is_parallel_safe_expr((Node *) cstate->defexprs[i]->expr))
+			return false;
+	}
+
+	if (tupDesc->constr != NULL)
+	{
+		for (i = 0; i < tupDesc->constr->num_check; i++)
+		{
+			Node	   *check = stringToNode(tupDesc->constr->check[i].ccbin);
+
+			if (!is_parallel_safe_expr(check))
+				return false;
+		}
+	}
+
+	if (rel->rd_rel->relispartition &&
+		!is_parallel_safe_expr((Node *) RelationGetPartitionQual(rel)))
+		return false;
+
+	indexoidlist = RelationGetIndexList(rel);
+	foreach(cur, indexoidlist)
+	{
+		Relation	indexDesc = index_open(lfirst_oid(cur), RowExclusiveLock);
+
+		if (indexDesc->rd_index->indisexclusion ||
+			!is_parallel_safe_expr((Node *) RelationGetIndexExpressions(indexDesc)) ||
+			!is_parallel_safe_expr((Node *) RelationGetIndexPredicate(indexDesc)))
+			safe = false;
+
+		index_close(indexDesc, NoLock);
+		if (!safe)
+			break;
+	}
+	list_free(indexoidlist);
+
+	return safe;
+}
+
+/*
+ * Load the rows with parallel workers, as described above ParallelCopyChunk.
+ * Falls back to CopyFromInsertRows if no workers can be launched.
+ */
+static uint64
+CopyFromParallel(CopyState cstate, CommandId mycid, int hi_options)
+{
+	ParallelContext *pcxt;
+	ParallelCopyShared *shared;
+	ParallelCopyChunk *chunks;
+	ParallelCopyChunk *chunk = NULL;
+	dsa_area   *area = NULL;
+	ErrorContextCallback errcallback;
+	char	   *state;
+	char	   *statespace;
+	int			nworkers = Min(cstate->nworkers, max_parallel_workers);
+	int			nchunks = nworkers * PARALLEL_COPY_CHUNKS_PER_WORKER;
+	int			lineno = 0;
+	int			i;
+	uint64		processed;
+
+	if (nworkers == 0)
+		return CopyFromInsertRows(cstate, mycid, hi_options);
+
+	/* Workers can't assign an XID, so make sure we have one to share */
+	(void) GetCurrentTransactionId();
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext(ParallelCopyMain, nworkers);
+
+	/* Workers repeat BeginCopyFrom from the original column list and options */
+	state = nodeToString(list_make3(cstate->attnamelist, cstate->options,
+									cstate->range_table));
+
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(ParallelCopyShared));
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(nchunks, sizeof(ParallelCopyChunk)));
+	shm_toc_estimate_chunk(&pcxt->estimator, strlen(state) + 1);
+	shm_toc_estimate_chunk(&pcxt->estimator, dsa_minimum_size());
+	shm_toc_estimate_keys(&pcxt->estimator, 4);
+
+	InitializeParallelDSM(pcxt);
+
+	shared = shm_toc_allocate(pcxt->toc, sizeof(ParallelCopyShared));
+	shared->relid = RelationGetRelid(cstate->rel);
+	shared->mycid = mycid;
+	shared->hi_options = hi_options;
+	shared->nchunks = nchunks;
+	shared->leader = MyProc;
+	pg_atomic_init_u64(&shared->processed, 0);
+	ConditionVariableInit(&shared->chunk_ready_cv);
+	SpinLockInit(&shared->mutex);
+	shared->nsubmitted = 0;
+	shared->nclaimed = 0;
+	shared->input_done = false;
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_SHARED, shared);
+
+	chunks = shm_toc_allocate(pcxt->toc,
+							  mul_size(nchunks, sizeof(ParallelCopyChunk)));
+	for (i = 0; i < nchunks; i++)
+		chunks[i].busy = false;
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_CHUNKS, chunks);
+
+	statespace = shm_toc_allocate(pcxt->toc, strlen(state) + 1);
+	strcpy(statespace, state);
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_STATE, statespace);
+
+	if (pcxt->seg != NULL)
+	{
+		char	   *area_space;
+
+		area_space = shm_toc_allocate(pcxt->toc, dsa_minimum_size());
+		shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_DSA, area_space);
+		area = dsa_create_in_place(area_space, dsa_minimum_size(),
+								   LWTRANCHE_PARALLEL_QUERY_DSA,
+								   pcxt->seg);
+	}
+
+	LaunchParallelWorkers(pcxt);
+
+	if (pcxt->nworkers_launched == 0)
+	{
+		if (area != NULL)
+			dsa_detach(area);
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return CopyFromInsertRows(cstate, mycid, hi_options);
+	}
+
+	/* Set up callback to identify error line number */
+	errcallback.callback = CopyFromErrorCallback;
+	errcallback.arg = (void *) cstate;
+	errcallback.previous = error_context_stack;
+
+	/*
+	 * Read the input a line at a time, as NextCopyFromRawFields would, and
+	 * hand the lines to the workers.  Any errors they run into come back
+	 * while we're waiting for them, so our error context callback is
+	 * installed only while we read, lest it blame the wrong line.
+	 */
+	for (;;)
+	{
+		bool		done;
+		int32		len;
+
+		CHECK_FOR_INTERRUPTS();
+
+		error_context_stack = &errcallback;
+
+		/* on input just throw the header line away */
+		if (lineno == 0 && cstate->header_line)
+		{
+			cstate->cur_lineno = ++lineno;
+			if (CopyReadLine(cstate))
+			{
+				error_context_stack = errcallback.previous;
+				break;
+			}
+		}
+
+		cstate->cur_lineno = ++lineno;
+		done = CopyReadLine(cstate);
+		error_context_stack = errcallback.previous;
+
+		/* EOF at start of line means we're done */
+		len = cstate->line_buf.len;
+		if (done && len == 0)
+			break;
+
+		/* Submit the chunk we're filling if this line doesn't fit */
+		if (chunk != NULL &&
+			chunk->used + sizeof(int32) + len > PARALLEL_COPY_CHUNK_SIZE)
+		{
+			ParallelCopySubmitChunk(shared, chunk);
+			chunk = NULL;
+		}
+
+		if (chunk == NULL)
+		{
+			chunk = ParallelCopyNextFreeChunk(pcxt, shared, chunks);
+			chunk->first_lineno = lineno;
+		}
+
+		if (sizeof(int32) + len > PARALLEL_COPY_CHUNK_SIZE)
+		{
+			/* Too long for any chunk, so put it in the DSA area */
+			if (area == NULL)
+				elog(ERROR, "no shared memory area for parallel COPY");
+			chunk->big_line = dsa_allocate(area, len);
+			chunk->big_len = len;
+			memcpy(dsa_get_address(area, chunk->big_line),
+				   cstate->line_buf.data, len);
+			chunk->nlines = 1;
+			ParallelCopySubmitChunk(shared, chunk);
+			chunk = NULL;
+		}
+		else
+		{
+			memcpy(chunk->data + chunk->used, &len, sizeof(int32));
+			memcpy(chunk->data + chunk->used + sizeof(int32),
+				   cstate->line_buf.data, len);
+			chunk->used += sizeof(int32) + len;
+			chunk->nlines++;
+		}
+
+		/*
+		 * If we see EOF after some characters, we act as though it was
+		 * newline followed by EOF.
+		 */
+		if (done)
+			break;
+	}
+
+	if (chunk != NULL)
+		ParallelCopySubmitChunk(shared, chunk);
+
+	/* Tell the workers there's nothing more coming, and wait for them */
+	SpinLockAcquire(&shared->mutex);
+	shared->input_done = true;
+	SpinLockRelease(&shared->mutex);
+	ConditionVariableBroadcast(&shared->chunk_ready_cv);
+
+	WaitForParallelWorkersToFinish(pcxt);
+
+	processed = pg_atomic_read_u64(&shared->processed);
+
+	if (area != NULL)
+		dsa_detach(area);
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+
+	/*
+	 * In the old protocol, tell pqcomm that we can process normal protocol
+	 * messages again.
+	 */
+	if (cstate->copy_dest == COPY_OLD_FE)
+		pq_endmsgread();
+
+	return processed;
+}
+
+/*
+ * Wait until the next chunk in the ring has been released by the worker
+ * that last had it, and return it, emptied, for the leader to fill.
+ */
+static ParallelCopyChunk *
+ParallelCopyNextFreeChunk(ParallelContext *pcxt, ParallelCopyShared *shared,
+						  ParallelCopyChunk *chunks)
+{
+	ParallelCopyChunk *chunk;
+
+	/* Only the leader advances nsubmitted, so we can read it unlocked */
+	chunk = &chunks[shared->nsubmitted % shared->nchunks];
+
+	for (;;)
+	{
+		bool		busy;
+		bool		anyalive = false;
+		int			i;
+
+		SpinLockAcquire(&shared->mutex);
+		busy = chunk->busy;
+		SpinLockRelease(&shared->mutex);
+		if (!busy)
+			break;
+
+		/*
+		 * A worker that fails reports its error to us, and that is thrown by
+		 * CHECK_FOR_INTERRUPTS; but if all of them are gone without one,
+		 * perhaps because they never managed to start, nobody will ever
+		 * release this chunk.
+		 */
+		for (i = 0; i < pcxt->nworkers_launched; i++)
+		{
+			pid_t		pid;
+
+			if (pcxt->worker[i].bgwhandle != NULL &&
+				GetBackgroundWorkerPid(pcxt->worker[i].bgwhandle,
+									   &pid) != BGWH_STOPPED)
+				anyalive = true;
+		}
+		if (!anyalive)
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("parallel COPY FROM workers exited unexpectedly")));
+
+		WaitLatch(MyLatch, WL_LATCH_SET, -1,
+				  WAIT_EVENT_PARALLEL_COPY_CHUNK_FREE);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	chunk->busy = true;
+	chunk->first_lineno = 0;
+	chunk->nlines = 0;
+	chunk->used = 0;
+	chunk->big_line = InvalidDsaPointer;
+	chunk->big_len = 0;
+
+	return chunk;
+}
+
+/*
+ * Make a filled chunk available to the workers.
+ */
+static void
+ParallelCopySubmitChunk(ParallelCopyShared *shared, ParallelCopyChunk *chunk)
+{
+	SpinLockAcquire(&shared->mutex);
+	shared->nsubmitted++;
+	SpinLockRelease(&shared->mutex);
+
+	ConditionVariableSignal(&shared->chunk_ready_cv);
+}
+
+/*
+ * Main entrypoint for parallel COPY FROM workers.
+ */
+static void
+ParallelCopyMain(dsm_segment *seg, shm_toc *toc)
+{
+	ParallelCopyShared *shared;
+	List	   *state;
+	Relation	rel;
+	CopyState	cstate;
+	void	   *area_space;
+	dsa_area   *area = NULL;
+	uint64		processed;
+
+	shared = shm_toc_lookup(toc, PARALLEL_COPY_KEY_SHARED);
+	state = (List *) stringToNode(shm_toc_lookup(toc, PARALLEL_COPY_KEY_STATE));
+	area_space = shm_toc_lookup(toc, PARALLEL_COPY_KEY_DSA);
+	if (area_space != NULL)
+		area = dsa_attach_in_place(area_space, seg);
+
+	/* The leader holds the same lock, so this can't block */
+	rel = heap_open(shared->relid, RowExclusiveLock);
+
+	cstate = BeginCopyFrom(NULL, rel, NULL, false, ParallelCopyGetData,
+						   (List *) linitial(state), (List *) lsecond(state));
+	cstate->range_table = (List *) lthird(state);
+	cstate->pcshared = shared;
+	cstate->pcchunks = shm_toc_lookup(toc, PARALLEL_COPY_KEY_CHUNKS);
+	cstate->pcarea = area;
+	cstate->pcchunk = -1;
+
+	/* The leader dealt with the header line, if any */
+	cstate->header_line = false;
+
+	ParallelWorkerInsertsAllowed = true;
+	processed = CopyFromInsertRows(cstate, shared->mycid, shared->hi_options);
+	pg_atomic_add_fetch_u64(&shared->processed, processed);
+
+	EndCopyFrom(cstate);
+	heap_close(rel, NoLock);
+	if (area != NULL)
+		dsa_detach(area);
+}
+
+/*
+ * Parallel COPY FROM workers get their input through ParallelCopyReadLine
+ * rather than from a data source.
+ */
+static int
+ParallelCopyGetData(void *outbuf, int minread, int maxread)
+{
+	elog(ERROR, "unexpected read of parallel COPY FROM input");
+	return 0;					/* keep compiler quiet */
+}
+
+/*
+ * CopyReadLine for a parallel COPY FROM worker: put the next line from the
+ * chunk we've claimed in line_buf, claiming the next submitted chunk once
+ * we're through with it.  The leader already stripped the EOL marker and
+ * converted the line to server encoding.  Returns true once the input is
+ * exhausted.
+ */
+static bool
+ParallelCopyReadLine(CopyState cstate)
+{
+	ParallelCopyShared *shared = cstate->pcshared;
+	ParallelCopyChunk *chunk;
+	int32		len;
+
+	resetStringInfo(&cstate->line_buf);
+	cstate->line_buf_valid = true;
+	cstate->line_buf_converted = true;
+
+	if (cstate->pcchunk >= 0 &&
+		cstate->pcline >= cstate->pcchunks[cstate->pcchunk].nlines)
+	{
+		/* Release the chunk we're done with, and wake up the leader */
+		chunk = &cstate->pcchunks[cstate->pcchunk];
+		if (DsaPointerIsValid(chunk->big_line))
+			dsa_free(cstate->pcarea, chunk->big_line);
+
+		SpinLockAcquire(&shared->mutex);
+		chunk->busy = false;
+		SpinLockRelease(&shared->mutex);
+		SetLatch(&shared->leader->procLatch);
+
+		cstate->pcchunk = -1;
+	}
+
+	while (cstate->pcchunk < 0)
+	{
+		bool		input_done;
+
+		SpinLockAcquire(&shared->mutex);
+		if (shared->nclaimed < shared->nsubmitted)
+			cstate->pcchunk = shared->nclaimed++ % shared->nchunks;
+		input_done = shared->input_done;
+		SpinLockRelease(&shared->mutex);
+
+		cstate->pcline = 0;
+		cstate->pcoffset = 0;
+
+		if (cstate->pcchunk < 0)
+		{
+			if (input_done)
+			{
+				ConditionVariableCancelSleep();
+				cstate->line_buf_valid = false;
+				return true;
+			}
+			ConditionVariableSleep(&shared->chunk_ready_cv,
+								   WAIT_EVENT_PARALLEL_COPY_CHUNK_READY);
+		}
+	}
+	ConditionVariableCancelSleep();
+
+	chunk = &cstate->pcchunks[cstate->pcchunk];
+	cstate->cur_lineno = chunk->first_lineno + cstate->pcline;
+
+	if (DsaPointerIsValid(chunk->big_line))
+	{
+		appendBinaryStringInfo(&cstate->line_buf,
+							   dsa_get_address(cstate->pcarea, chunk->big_line),
+							   chunk->big_len);
+	}
+	else
+	{
+		memcpy(&len, chunk->data + cstate->pcoffset, sizeof(int32));
+		appendBinaryStringInfo(&cstate->line_buf,
+							   chunk->data + cstate->pcoffset + sizeof(int32),
+							   len);
+		cstate->pcoffset += sizeof(int32) + len;
+	}
+	cstate->pcline++;
+
+	return false;
+}
+
 /*
  * Setup to read tuples from a file for COPY FROM.
  *
@@ -2908,6 +3613,10 @@ BeginCopyFrom(ParseState *pstate,
 	cstate = BeginCopy(pstate, true, rel, NULL, InvalidOid, attnamelist, options);
 	oldcontext = MemoryContextSwitchTo(cstate->copycontext);
 
+	/* Parallel workers need to repeat this setup for themselves */
+	cstate->attnamelist = attnamelist;
+	cstate->options = options;
+
 	/* Initialize state variables */
 	cstate->fe_eof = false;
 	cstate->eol_type = EOL_UNKNOWN;
@@ -3071,7 +3780,7 @@ BeginCopyFrom(ParseState *pstate,
 		int32		tmp;
 
 		/* Signature */
-		if (CopyGetData(cstate, readSig, 11, 11) != 11 ||
+		if (CopyReadBinaryData(cstate, readSig, 11) != 11 ||
 			memcmp(readSig, BinarySignature, 11) != 0)
 			ereport(ERROR,
 					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
@@ -3096,7 +3805,7 @@ BeginCopyFrom(ParseState *pstate,
 		/* Skip extension header, if present */
 		while (tmp-- > 0)
 		{
-			if (CopyGetData(cstate, readSig, 1, 1) != 1)
+			if (CopyReadBinaryData(cstate, readSig, 1) != 1)
 				ereport(ERROR,
 						(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 						 errmsg("invalid COPY file header (wrong length)")));
@@ -3353,7 +4062,7 @@ NextCopyFrom(CopyState cstate, ExprContext *econtext,
 			char		dummy;
 
 			if (cstate->copy_dest != COPY_OLD_FE &&
-				CopyGetData(cstate, &dummy, 1, 1) > 0)
+				CopyReadBinaryData(cstate, &dummy, 1) > 0)
 				ereport(ERROR,
 						(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 						 errmsg("received copy data after EOF marker")));
@@ -3450,6 +4159,9 @@ CopyReadLine(CopyState cstate)
 {
 	bool		result;
 
+	if (cstate->pcshared != NULL)
+		return ParallelCopyReadLine(cstate);
+
 	resetStringInfo(&cstate->line_buf);
 	cstate->line_buf_valid = true;
 
@@ -3531,6 +4243,52 @@ CopyReadLine(CopyState cstate)
 	return result;
 }
 
+/*
+ * CopyScanForSpecial - skip over bytes of no interest to a COPY parser
+ *
+ * Returns a pointer to the first byte in [ptr, end) that equals one of the
+ * nspecials bytes in specials[], or end if there is none.  The parsers spend
+ * most of their time wading through ordinary data bytes, so this examines
+ * eight bytes at a time, using the usual bit trick to test a word for a zero
+ * byte after XOR'ing it with each special byte replicated across the word.
+ */
+#define COPY_SCAN_ONES		UINT64CONST(0x0101010101010101)
+#define COPY_SCAN_HIGHBITS	UINT64CONST(0x8080808080808080)
+
+static char *
+CopyScanForSpecial(char *ptr, char *end, const char *specials, int nspecials)
+{
+	int			i;
+
+	while (end - ptr >= sizeof(uint64))
+	{
+		uint64		word;
+		uint64		hit = 0;
+
+		memcpy(&word, ptr, sizeof(word));
+		for (i = 0; i < nspecials; i++)
+		{
+			uint64		x = word ^ (COPY_SCAN_ONES * (unsigned char) specials[i]);
+
+			hit |= (x - COPY_SCAN_ONES) & ~x & COPY_SCAN_HIGHBITS;
+		}
+		if (hit != 0)
+			break;				/* the byte loop below will locate it */
+		ptr += sizeof(uint64);
+	}
+
+	for (; ptr < end; ptr++)
+	{
+		for (i = 0; i < nspecials; i++)
+		{
+			if (*ptr == specials[i])
+				return ptr;
+		}
+	}
+
+	return end;
+}
+
 /*
  * CopyReadLineText - inner loop of CopyReadLine for text mode
  */
@@ -3544,6 +4302,8 @@ CopyReadLineText(CopyState cstate)
 	bool		hit_eof = false;
 	bool		result = false;
 	char		mblen_str[2];
+	char		specials[5];
+	int			nspecials;
 
 	/* CSV variables */
 	bool		first_char_in_line = true;
@@ -3563,6 +4323,24 @@ CopyReadLineText(CopyState cstate)
 
 	mblen_str[1] = '\0';
 
+	/*
+	 * Bytes that the loop below must look at one by one; all others are
+	 * skipped over in bulk.  That's not possible with an encoding that can
+	 * embed these characters in multibyte characters, though.
+	 */
+	nspecials = 0;
+	if (!cstate->encoding_embeds_ascii)
+	{
+		specials[nspecials++] = '\n';
+		specials[nspecials++] = '\r';
+		specials[nspecials++] = '\\';
+		if (cstate->csv_mode)
+		{
+			specials[nspecials++] = quotec;
+			specials[nspecials++] = escapec;
+		}
+	}
+
 	/*
 	 * The objective of this loop is to transfer the entire next input line
 	 * into line_buf.  Hence, we only care for detecting newlines (\r and/or
@@ -3628,6 +4406,25 @@ CopyReadLineText(CopyState cstate)
 			need_data = false;
 		}
 
+		/* Skip ahead to the next character that needs a closer look */
+		if (nspecials > 0)
+		{
+			int			next_ptr;
+
+			next_ptr = CopyScanForSpecial(copy_raw_buf + raw_buf_ptr,
+										  copy_raw_buf + copy_buf_len,
+										  specials, nspecials) - copy_raw_buf;
+			if (next_ptr > raw_buf_ptr)
+			{
+				/* the skipped bytes would have cleared these, too */
+				first_char_in_line = false;
+				last_was_esc = false;
+				raw_buf_ptr = next_ptr;
+				if (raw_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = raw_buf_ptr;
 		c = copy_raw_buf[raw_buf_ptr++];
@@ -3925,6 +4722,7 @@ static int
 CopyReadAttributesText(CopyState cstate)
 {
 	char		delimc = cstate->delim[0];
+	char		specials[2];
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -3960,6 +4758,10 @@ CopyReadAttributesText(CopyState cstate)
 	cur_ptr = cstate->line_buf.data;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	/* the only bytes the scan loop must examine individually */
+	specials[0] = delimc;
+	specials[1] = '\\';
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -3996,6 +4798,16 @@ CopyReadAttributesText(CopyState cstate)
 		for (;;)
 		{
 			char		c;
+			char	   *next_ptr;
+
+			/* Copy ordinary bytes up to the next special one in bulk */
+			next_ptr = CopyScanForSpecial(cur_ptr, line_end_ptr, specials, 2);
+			if (next_ptr > cur_ptr)
+			{
+				memcpy(output_ptr, cur_ptr, next_ptr - cur_ptr);
+				output_ptr += next_ptr - cur_ptr;
+				cur_ptr = next_ptr;
+			}
 
 			end_ptr = cur_ptr;
 			if (cur_ptr >= line_end_ptr)
@@ -4155,6 +4967,8 @@ CopyReadAttributesCSV(CopyState cstate)
 	char		delimc = cstate->delim[0];
 	char		quotec = cstate->quote[0];
 	char		escapec = cstate->escape[0];
+	char		unquoted_specials[2];
+	char		quoted_specials[2];
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -4190,6 +5004,12 @@ CopyReadAttributesCSV(CopyState cstate)
 	cur_ptr = cstate->line_buf.data;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	/* the only bytes the scan loops must examine individually */
+	unquoted_specials[0] = delimc;
+	unquoted_specials[1] = quotec;
+	quoted_specials[0] = quotec;
+	quoted_specials[1] = escapec;
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -4222,10 +5042,20 @@ CopyReadAttributesCSV(CopyState cstate)
 		for (;;)
 		{
 			char		c;
+			char	   *next_ptr;
 
 			/* Not in quote */
 			for (;;)
 			{
+				next_ptr = CopyScanForSpecial(cur_ptr, line_end_ptr,
+											  unquoted_specials, 2);
+				if (next_ptr > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, next_ptr - cur_ptr);
+					output_ptr += next_ptr - cur_ptr;
+					cur_ptr = next_ptr;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					goto endfield;
@@ -4249,6 +5079,15 @@ CopyReadAttributesCSV(CopyState cstate)
 			/* In quote */
 			for (;;)
 			{
+				next_ptr = CopyScanForSpecial(cur_ptr, line_end_ptr,
+											  quoted_specials, 2);
+				if (next_ptr > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, next_ptr - cur_ptr);
+					output_ptr += next_ptr - cur_ptr;
+					cur_ptr = next_ptr;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					ereport(ERROR,
@@ -4317,6 +5156,11 @@ endfield:
 
 /*
  * Read a binary attribute
+ *
+ * A field that is wholly present in raw_buf is decoded in place, without
+ * first copying it into attribute_buf; the common fixed-width integer types
+ * are even decoded without calling their receive function.  Only a field
+ * that straddles a buffer refill takes the long way around.
  */
 static Datum
 CopyReadBinaryAttribute(CopyState cstate,
@@ -4326,6 +5170,9 @@ CopyReadBinaryAttribute(CopyState cstate,
 {
 	int32		fld_size;
 	Datum		result;
+	StringInfo	buf;
+	StringInfoData inplace_buf;
+	char		save_byte = '\0';
 
 	if (!CopyGetInt32(cstate, &fld_size))
 		ereport(ERROR,
@@ -4341,30 +5188,102 @@ CopyReadBinaryAttribute(CopyState cstate,
 				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 				 errmsg("invalid field size")));
 
-	/* reset attribute_buf to empty, and load raw data in it */
-	resetStringInfo(&cstate->attribute_buf);
+	*isnull = false;
 
-	enlargeStringInfo(&cstate->attribute_buf, fld_size);
-	if (CopyGetData(cstate, cstate->attribute_buf.data,
-					fld_size, fld_size) != fld_size)
-		ereport(ERROR,
-				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-				 errmsg("unexpected EOF in COPY data")));
+	if (RAW_BUF_BYTES(cstate) >= fld_size)
+	{
+		char	   *data = cstate->raw_buf + cstate->raw_buf_index;
 
-	cstate->attribute_buf.len = fld_size;
-	cstate->attribute_buf.data[fld_size] = '\0';
+		cstate->raw_buf_index += fld_size;
+
+		/*
+		 * These match what int2recv, int4recv, int8recv and oidrecv would
+		 * do; a field of the wrong size is left to them to complain about.
+		 */
+		switch (flinfo->fn_oid)
+		{
+			case F_INT2RECV:
+				if (fld_size == sizeof(int16))
+				{
+					uint16		n16;
+
+					memcpy(&n16, data, sizeof(n16));
+					return Int16GetDatum((int16) ntohs(n16));
+				}
+				break;
+			case F_INT4RECV:
+			case F_OIDRECV:
+				if (fld_size == sizeof(int32))
+				{
+					uint32		n32;
+
+					memcpy(&n32, data, sizeof(n32));
+					n32 = ntohl(n32);
+					if (flinfo->fn_oid == F_OIDRECV)
+						return ObjectIdGetDatum((Oid) n32);
+					return Int32GetDatum((int32) n32);
+				}
+				break;
+			case F_INT8RECV:
+				if (fld_size == sizeof(int64))
+				{
+					uint32		h32;
+					uint32		l32;
+					int64		val;
+
+					memcpy(&h32, data, sizeof(h32));
+					memcpy(&l32, data + sizeof(h32), sizeof(l32));
+					val = ntohl(h32);
+					val <<= 32;
+					val |= ntohl(l32);
+					return Int64GetDatum(val);
+				}
+				break;
+		}
+
+		/*
+		 * Point a StringInfo at the field in raw_buf.  Receive functions
+		 * expect the usual trailing null, so supply one temporarily; there
+		 * is always room for it, since raw_buf has a spare byte at the end.
+		 */
+		inplace_buf.data = data;
+		inplace_buf.len = fld_size;
+		inplace_buf.maxlen = fld_size + 1;
+		inplace_buf.cursor = 0;
+		save_byte = data[fld_size];
+		data[fld_size] = '\0';
+		buf = &inplace_buf;
+	}
+	else
+	{
+		/* reset attribute_buf to empty, and load raw data in it */
+		resetStringInfo(&cstate->attribute_buf);
+
+		enlargeStringInfo(&cstate->attribute_buf, fld_size);
+		if (CopyReadBinaryData(cstate, cstate->attribute_buf.data,
+							   fld_size) != fld_size)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("unexpected EOF in COPY data")));
+
+		cstate->attribute_buf.len = fld_size;
+		cstate->attribute_buf.data[fld_size] = '\0';
+		buf = &cstate->attribute_buf;
+	}
 
 	/* Call the column type's binary input converter */
-	result = ReceiveFunctionCall(flinfo, &cstate->attribute_buf,
-								 typioparam, typmod);
+	result = ReceiveFunctionCall(flinfo, buf, typioparam, typmod);
+
+	/* Put back the byte that followed an in-place field */
+	if (buf == &inplace_buf)
+		buf->data[buf->len] = save_byte;
 
 	/* Trouble if it didn't eat the whole buffer */
-	if (cstate->attribute_buf.cursor != cstate->attribute_buf.len)
+	if (buf->cursor != buf->len)
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
 				 errmsg("incorrect binary data format")));
 
-	*isnull = false;
 	return result;
 }
 
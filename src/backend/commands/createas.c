@@ -326,8 +326,11 @@ ExecCreateTableAs(CreateTableAsStmt *stmt, const char *queryString,
 		query = castNode(Query, linitial(rewritten));
 		Assert(query->commandType == CMD_SELECT);
 
-		/* plan the query --- note we disallow parallelism */
-		plan = pg_plan_query(query, 0, params);
+		/*
+		 * Plan the query.  Parallel workers may compute its rows, but we
+		 * insert them ourselves; see ExecutePlan.
+		 */
+		plan = pg_plan_query(query, CURSOR_OPT_PARALLEL_OK, params);
 
 		/*
 		 * Use a snapshot with an updated command ID to ensure this query sees
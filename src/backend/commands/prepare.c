@@ -202,6 +202,7 @@ ExecuteQuery(ExecuteStmt *stmt, IntoClause *intoClause,
 			 DestReceiver *dest, char *completionTag)
 {
 	PreparedStatement *entry;
+	CachedPlanSource *plansource;
 	CachedPlan *cplan;
 	List	   *plan_list;
 	ParamListInfo paramLI = NULL;
@@ -210,10 +211,14 @@ ExecuteQuery(ExecuteStmt *stmt, IntoClause *intoClause,
 	char	   *query_string;
 	int			eflags;
 	long		count;
+	instr_time	starttime;
+	instr_time	duration;
 
 	/* Look it up in the hash table */
 	entry = FetchPreparedStatement(stmt->name, true);
 
+	plansource = entry->plansource;
+
 	/* Shouldn't find a non-fixed-result cached plan */
 	if (!entry->plansource->fixed_result)
 		elog(ERROR, "EXECUTE does not support variable-result cached plans");
@@ -299,10 +304,24 @@ ExecuteQuery(ExecuteStmt *stmt, IntoClause *intoClause,
 	/*
 	 * Run the portal as appropriate.
 	 */
+	INSTR_TIME_SET_CURRENT(starttime);
+
 	PortalStart(portal, paramLI, eflags, GetActiveSnapshot());
 
 	(void) PortalRun(portal, count, false, true, dest, dest, completionTag);
 
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, starttime);
+
+	/*
+	 * Tell the plan cache how long the plan took to run, unless it didn't
+	 * really run or the statement was deallocated while it was running.
+	 */
+	entry = FetchPreparedStatement(stmt->name, false);
+	if (count != 0 && entry && entry->plansource == plansource)
+		CachedPlanRecordExecution(plansource, cplan,
+								  INSTR_TIME_GET_MILLISEC(duration));
+
 	PortalDrop(portal, false);
 
 	if (estate)
@@ -618,6 +637,16 @@ DropAllPreparedStatements(void)
 	}
 }
 
+/*
+ * Does this session have any prepared statements?
+ */
+bool
+HavePreparedStatements(void)
+{
+	return prepared_queries != NULL &&
+		hash_get_num_entries(prepared_queries) > 0;
+}
+
 /*
  * Implements the 'EXPLAIN EXECUTE' utility statement.
  *
@@ -733,7 +762,7 @@ pg_prepared_statement(PG_FUNCTION_ARGS)
 	 * build tupdesc for result tuples. This must match the definition of the
 	 * pg_prepared_statements view in system_views.sql
 	 */
-	tupdesc = CreateTemplateTupleDesc(5, false);
+	tupdesc = CreateTemplateTupleDesc(9, false);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "name",
 					   TEXTOID, -1, 0);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "statement",
@@ -744,6 +773,14 @@ pg_prepared_statement(PG_FUNCTION_ARGS)
 					   REGTYPEARRAYOID, -1, 0);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "from_sql",
 					   BOOLOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "generic_plans",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "custom_plans",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "mean_generic_time",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "mean_custom_time",
+					   FLOAT8OID, -1, 0);
 
 	/*
 	 * We put all the tuples into a tuplestore in one scan of the hashtable.
@@ -765,8 +802,9 @@ pg_prepared_statement(PG_FUNCTION_ARGS)
 		hash_seq_init(&hash_seq, prepared_queries);
 		while ((prep_stmt = hash_seq_search(&hash_seq)) != NULL)
 		{
-			Datum		values[5];
-			bool		nulls[5];
+			CachedPlanSource *plansource = prep_stmt->plansource;
+			Datum		values[9];
+			bool		nulls[9];
 
 			MemSet(nulls, 0, sizeof(nulls));
 
@@ -776,6 +814,18 @@ pg_prepared_statement(PG_FUNCTION_ARGS)
 			values[3] = build_regtype_array(prep_stmt->plansource->param_types,
 										  prep_stmt->plansource->num_params);
 			values[4] = BoolGetDatum(prep_stmt->from_sql);
+			values[5] = Int64GetDatum(plansource->generic_plan_count);
+			values[6] = Int64GetDatum(plansource->custom_plan_count);
+			if (plansource->num_generic_runs > 0)
+				values[7] = Float8GetDatum(plansource->total_generic_time /
+										   plansource->num_generic_runs);
+			else
+				nulls[7] = true;
+			if (plansource->num_custom_runs > 0)
+				values[8] = Float8GetDatum(plansource->total_custom_time /
+										   plansource->num_custom_runs);
+			else
+				nulls[8] = true;
 
 			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
 		}
@@ -62,11 +62,12 @@ CreateStatistics(CreateStatsStmt *stmt)
 	Oid			relid;
 	ObjectAddress parentobject,
 				childobject;
-	Datum		types[2];		/* one for each possible type of statistics */
+	Datum		types[3];		/* one for each possible type of statistics */
 	int			ntypes;
 	ArrayType  *staenabled;
 	bool		build_ndistinct;
 	bool		build_dependencies;
+	bool		build_mcv;
 	bool		requested_type = false;
 
 	Assert(IsA(stmt, CreateStatsStmt));
@@ -190,6 +191,7 @@ CreateStatistics(CreateStatsStmt *stmt)
 	 */
 	build_ndistinct = false;
 	build_dependencies = false;
+	build_mcv = false;
 	foreach(l, stmt->options)
 	{
 		DefElem    *opt = (DefElem *) lfirst(l);
@@ -204,13 +206,22 @@ CreateStatistics(CreateStatsStmt *stmt)
 			build_dependencies = defGetBoolean(opt);
 			requested_type = true;
 		}
+		else if (strcmp(opt->defname, "mcv") == 0)
+		{
+			build_mcv = defGetBoolean(opt);
+			requested_type = true;
+		}
 		else
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
 					 errmsg("unrecognized STATISTICS option \"%s\"",
 							opt->defname)));
 	}
-	/* If no statistic type was specified, build them all. */
+	/*
+	 * If no statistic type was specified, build all the cheap ones.  MCV lists
+	 * are much larger and more expensive to build, so they have to be
+	 * requested explicitly.
+	 */
 	if (!requested_type)
 	{
 		build_ndistinct = true;
@@ -223,6 +234,8 @@ CreateStatistics(CreateStatsStmt *stmt)
 		types[ntypes++] = CharGetDatum(STATS_EXT_NDISTINCT);
 	if (build_dependencies)
 		types[ntypes++] = CharGetDatum(STATS_EXT_DEPENDENCIES);
+	if (build_mcv)
+		types[ntypes++] = CharGetDatum(STATS_EXT_MCV);
 	Assert(ntypes > 0);
 	staenabled = construct_array(types, ntypes, CHAROID, 1, true, 'c');
 
@@ -241,6 +254,7 @@ CreateStatistics(CreateStatsStmt *stmt)
 	/* no statistics build yet */
 	nulls[Anum_pg_statistic_ext_standistinct - 1] = true;
 	nulls[Anum_pg_statistic_ext_stadependencies - 1] = true;
+	nulls[Anum_pg_statistic_ext_stamcv - 1] = true;
 
 	/* insert it into pg_statistic_ext */
 	statrel = heap_open(StatisticExtRelationId, RowExclusiveLock);
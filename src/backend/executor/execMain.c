@@ -1627,13 +1627,21 @@ ExecutePlan(EState *estate,
 
 	/*
 	 * If the plan might potentially be executed multiple times, we must force
-	 * it to run without parallelism, because we might exit early.  Also
-	 * disable parallelism when writing into a relation, because no database
-	 * changes are allowed in parallel mode.
+	 * it to run without parallelism, because we might exit early.
 	 */
-	if (!execute_once || dest->mydest == DestIntoRel)
+	if (!execute_once)
 		use_parallel_mode = false;
 
+	/*
+	 * The planner allows parallel mode for INSERT and CREATE TABLE AS, whose
+	 * rows are written by the leader alone.  No XID can be assigned once in
+	 * parallel mode, so get ours now; the workers need it to see the rows as
+	 * our own, too.
+	 */
+	if (use_parallel_mode &&
+		(operation != CMD_SELECT || dest->mydest == DestIntoRel))
+		(void) GetCurrentTransactionId();
+
 	if (use_parallel_mode)
 		EnterParallelMode();
 
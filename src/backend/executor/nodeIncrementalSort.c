@@ -0,0 +1,348 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.c
+ *	  Routines to handle incremental sorting of relations.
+ *
+ * An incremental sort is used when the input is already sorted by some
+ * leading subset of the requested sort keys (the "presorted" keys).  Tuples
+ * with different values of the presorted keys are already in the right
+ * order relative to each other, so it is enough to sort each group of
+ * tuples with equal presorted keys on its own.  Compared with a full sort,
+ * this returns the first tuples as soon as the first group is sorted, and
+ * needs only enough memory for one group at a time.
+ *
+ * Sorting tiny groups one at a time would be dominated by the tuplesort
+ * setup cost, so we always put at least INCREMENTAL_SORT_MIN_GROUP_SIZE
+ * tuples into a batch, and then keep adding tuples until the presorted keys
+ * change.  Each batch is sorted on all the sort keys, which orders the
+ * groups within it correctly as well.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeIncrementalSort.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "executor/execdebug.h"
+#include "executor/executor.h"
+#include "executor/nodeIncrementalSort.h"
+#include "miscadmin.h"
+#include "utils/lsyscache.h"
+#include "utils/tuplesort.h"
+
+
+/*
+ * Read the next batch of tuples from the outer plan into a new tuplesort,
+ * and sort it.
+ */
+static void
+fill_batch(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	PlanState  *outerNode = outerPlanState(node);
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	Tuplesortstate *tuplesortstate;
+	int64		nTuples = 0;
+
+	SO1_printf("ExecIncrementalSort: %s\n",
+			   "reading next batch");
+
+	tuplesortstate = tuplesort_begin_heap(ExecGetResultType(outerNode),
+										  plannode->sort.numCols,
+										  plannode->sort.sortColIdx,
+										  plannode->sort.sortOperators,
+										  plannode->sort.collations,
+										  plannode->sort.nullsFirst,
+										  work_mem,
+										  false);
+	if (node->bounded && node->bound > node->bound_Done)
+		tuplesort_set_bound(tuplesortstate, node->bound - node->bound_Done);
+	node->tuplesortstate = (void *) tuplesortstate;
+
+	/* The tuple that ended the previous batch begins this one. */
+	if (!TupIsNull(node->group_pivot))
+	{
+		tuplesort_puttupleslot(tuplesortstate, node->group_pivot);
+		nTuples++;
+	}
+
+	for (;;)
+	{
+		TupleTableSlot *slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			node->finished = true;
+			ExecClearTuple(node->group_pivot);
+			break;
+		}
+
+		/*
+		 * Once the batch has its minimum size, it ends as soon as the
+		 * presorted keys differ from those of the tuple that completed the
+		 * minimum.  That tuple is saved in group_pivot below; after the end
+		 * of the batch, group_pivot holds the first tuple of the next one.
+		 *
+		 * We need not call ResetExprContext here because execTuplesMatch
+		 * will reset the per-tuple memory context once per input tuple.
+		 */
+		if (nTuples >= INCREMENTAL_SORT_MIN_GROUP_SIZE &&
+			!execTuplesMatch(node->group_pivot, slot,
+							 plannode->presortedCols,
+							 plannode->sort.sortColIdx,
+							 node->eqfunctions,
+							 econtext->ecxt_per_tuple_memory))
+		{
+			ExecCopySlot(node->group_pivot, slot);
+			break;
+		}
+
+		tuplesort_puttupleslot(tuplesortstate, slot);
+		if (++nTuples == INCREMENTAL_SORT_MIN_GROUP_SIZE)
+			ExecCopySlot(node->group_pivot, slot);
+	}
+
+	tuplesort_performsort(tuplesortstate);
+	node->groupsCount++;
+
+	SO1_printf("ExecIncrementalSort: %s\n",
+			   "batch sorted");
+}
+
+/*
+ * Release the tuplesort of a batch that has been returned completely,
+ * remembering its statistics for EXPLAIN ANALYZE.
+ */
+static void
+end_batch(IncrementalSortState *node)
+{
+	Tuplesortstate *tuplesortstate = (Tuplesortstate *) node->tuplesortstate;
+	const char *sortMethod;
+	const char *spaceType;
+	long		spaceUsed;
+
+	tuplesort_get_stats(tuplesortstate, &sortMethod, &spaceType, &spaceUsed);
+	if (node->sortMethod == NULL || spaceUsed > node->maxSpaceUsed)
+	{
+		node->sortMethod = sortMethod;
+		node->spaceType = spaceType;
+		node->maxSpaceUsed = spaceUsed;
+	}
+
+	tuplesort_end(tuplesortstate);
+	node->tuplesortstate = NULL;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecIncrementalSort
+ *
+ *		Sorts the tuples from the outer subtree of the node one batch at a
+ *		time, returning each sorted batch before reading the next.
+ *
+ *		Conditions:
+ *		  -- the outer subtree returns tuples sorted by the first
+ *			 presortedCols sort keys.
+ *
+ *		Initial States:
+ *		  -- the outer child is prepared to return the first tuple.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecIncrementalSort(IncrementalSortState *node)
+{
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+
+	/* Backward scan is not supported, see ExecInitIncrementalSort */
+	Assert(ScanDirectionIsForward(node->ss.ps.state->es_direction));
+
+	for (;;)
+	{
+		if (node->tuplesortstate != NULL)
+		{
+			if (tuplesort_gettupleslot((Tuplesortstate *) node->tuplesortstate,
+									   true, slot, NULL))
+			{
+				node->bound_Done++;
+				return slot;
+			}
+
+			/* Current batch is used up */
+			end_batch(node);
+		}
+
+		if (node->finished)
+			return ExecClearTuple(slot);
+
+		fill_batch(node);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitIncrementalSort
+ *
+ *		Creates the run-time state information for the incremental sort
+ *		node produced by the planner and initializes its outer subtree.
+ * ----------------------------------------------------------------
+ */
+IncrementalSortState *
+ExecInitIncrementalSort(IncrementalSort *node, EState *estate, int eflags)
+{
+	IncrementalSortState *incrsortstate;
+	Oid		   *eqOperators;
+	int			i;
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "initializing incremental sort node");
+
+	/*
+	 * Only the current batch is kept, so we can't support backward scan or
+	 * mark/restore.  The planner knows this, see ExecSupportsBackwardScan
+	 * and ExecSupportsMarkRestore.
+	 */
+	Assert((eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)) == 0);
+
+	/*
+	 * create state structure
+	 */
+	incrsortstate = makeNode(IncrementalSortState);
+	incrsortstate->ss.ps.plan = (Plan *) node;
+	incrsortstate->ss.ps.state = estate;
+
+	incrsortstate->bounded = false;
+	incrsortstate->bound_Done = 0;
+	incrsortstate->finished = false;
+	incrsortstate->tuplesortstate = NULL;
+	incrsortstate->groupsCount = 0;
+	incrsortstate->maxSpaceUsed = 0;
+	incrsortstate->sortMethod = NULL;
+	incrsortstate->spaceType = NULL;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * We need an ExprContext only for its per-tuple memory, which is used
+	 * when comparing the presorted keys.
+	 */
+	ExecAssignExprContext(estate, &incrsortstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &incrsortstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &incrsortstate->ss);
+	incrsortstate->group_pivot = ExecInitExtraTupleSlot(estate);
+
+	/*
+	 * initialize child nodes
+	 *
+	 * We shield the child node from the need to support REWIND, BACKWARD, or
+	 * MARK/RESTORE.
+	 */
+	eflags &= ~(EXEC_FLAG_REWIND | EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK);
+
+	outerPlanState(incrsortstate) = ExecInitNode(outerPlan(node), estate,
+												 eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&incrsortstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&incrsortstate->ss);
+	incrsortstate->ss.ps.ps_ProjInfo = NULL;
+
+	ExecSetSlotDescriptor(incrsortstate->group_pivot,
+						  ExecGetResultType(outerPlanState(incrsortstate)));
+
+	/*
+	 * Precompute fmgr lookup data for comparing the presorted keys
+	 */
+	eqOperators = (Oid *) palloc(node->presortedCols * sizeof(Oid));
+	for (i = 0; i < node->presortedCols; i++)
+	{
+		Oid			sortop = node->sort.sortOperators[i];
+
+		eqOperators[i] = get_equality_op_for_ordering_op(sortop, NULL);
+		if (!OidIsValid(eqOperators[i]))
+			elog(ERROR, "could not find equality operator for ordering operator %u",
+				 sortop);
+	}
+	incrsortstate->eqfunctions = execTuplesMatchPrepare(node->presortedCols,
+														eqOperators);
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "incremental sort node initialized");
+
+	return incrsortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndIncrementalSort(node)
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndIncrementalSort(IncrementalSortState *node)
+{
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "shutting down incremental sort node");
+
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	/*
+	 * Release tuplesort resources
+	 */
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "incremental sort node shutdown");
+}
+
+void
+ExecReScanIncrementalSort(IncrementalSortState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	/*
+	 * We keep only the current batch, so we must always re-read the subplan.
+	 * The bound may have changed as well; it's applied to each new batch.
+	 */
+	ExecClearTuple(node->group_pivot);
+	if (node->tuplesortstate != NULL)
+	{
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+		node->tuplesortstate = NULL;
+	}
+	node->finished = false;
+	node->bound_Done = 0;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
@@ -96,6 +96,8 @@ IndexOnlyNext(IndexOnlyScanState *node)
 
 		/* Set it up for index-only scan */
 		node->ioss_ScanDesc->xs_want_itup = true;
+		node->ioss_ScanDesc->xs_skipscan =
+			((IndexOnlyScan *) node->ss.ps.plan)->indexskip;
 		node->ioss_VMBuffer = InvalidBuffer;
 
 		/*
@@ -110,6 +112,17 @@ IndexOnlyNext(IndexOnlyScanState *node)
 						 node->ioss_NumOrderByKeys);
 	}
 
+	/*
+	 * In a distinct skip scan, we're done with the current value of the first
+	 * index column as soon as one tuple has been returned for it.
+	 */
+	if (node->ioss_SkipPending)
+	{
+		node->ioss_SkipPending = false;
+		if (!index_skip(scandesc, direction))
+			return ExecClearTuple(slot);
+	}
+
 	/*
 	 * OK, now that we have what we need, fetch the next tuple.
 	 */
@@ -244,6 +257,8 @@ IndexOnlyNext(IndexOnlyScanState *node)
 							  ItemPointerGetBlockNumber(tid),
 							  estate->es_snapshot);
 
+		node->ioss_SkipPending =
+			((IndexOnlyScan *) node->ss.ps.plan)->indexdistinct;
 		return slot;
 	}
 
@@ -370,6 +385,7 @@ ExecReScanIndexOnlyScan(IndexOnlyScanState *node)
 		if (reset_parallel_scan && node->ioss_ScanDesc->parallel_scan)
 			index_parallelrescan(node->ioss_ScanDesc);
 	}
+	node->ioss_SkipPending = false;
 	ExecScanReScan(&node->ss);
 }
 
@@ -550,6 +566,7 @@ ExecInitIndexOnlyScan(IndexOnlyScan *node, EState *estate, int eflags)
 	indexstate->ioss_RuntimeKeysReady = false;
 	indexstate->ioss_RuntimeKeys = NULL;
 	indexstate->ioss_NumRuntimeKeys = 0;
+	indexstate->ioss_SkipPending = false;
 
 	/*
 	 * build the index scan keys from the index qualification
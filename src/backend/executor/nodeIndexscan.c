@@ -115,6 +115,7 @@ IndexNext(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		scandesc->xs_skipscan = ((IndexScan *) node->ss.ps.plan)->indexskip;
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -126,6 +127,20 @@ IndexNext(IndexScanState *node)
 						 node->iss_OrderByKeys, node->iss_NumOrderByKeys);
 	}
 
+	/*
+	 * In a distinct skip scan, we're done with the current value of the first
+	 * index column as soon as one tuple has been returned for it.
+	 */
+	if (node->iss_SkipPending)
+	{
+		node->iss_SkipPending = false;
+		if (!index_skip(scandesc, direction))
+		{
+			node->iss_ReachedEnd = true;
+			return ExecClearTuple(slot);
+		}
+	}
+
 	/*
 	 * ok, now that we have what we need, fetch the next tuple.
 	 */
@@ -157,6 +172,7 @@ IndexNext(IndexScanState *node)
 			}
 		}
 
+		node->iss_SkipPending = ((IndexScan *) node->ss.ps.plan)->indexdistinct;
 		return slot;
 	}
 
@@ -621,6 +637,7 @@ ExecReScanIndexScan(IndexScanState *node)
 			index_parallelrescan(node->iss_ScanDesc);
 	}
 	node->iss_ReachedEnd = false;
+	node->iss_SkipPending = false;
 
 	ExecScanReScan(&node->ss);
 }
@@ -978,6 +995,7 @@ ExecInitIndexScan(IndexScan *node, EState *estate, int eflags)
 	indexstate->iss_RuntimeKeysReady = false;
 	indexstate->iss_RuntimeKeys = NULL;
 	indexstate->iss_NumRuntimeKeys = 0;
+	indexstate->iss_SkipPending = false;
 
 	/*
 	 * build the index scan keys from the index qualification
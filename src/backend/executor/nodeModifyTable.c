@@ -62,6 +62,8 @@ static bool ExecOnConflictUpdate(ModifyTableState *mtstate,
 					 EState *estate,
 					 bool canSetTag,
 					 TupleTableSlot **returning);
+static void ExecBatchInsert(ResultRelInfo *resultRelInfo, EState *estate,
+				bool canSetTag);
 
 /*
  * Verify that the tuples to be produced by INSERT or UPDATE match the
@@ -391,6 +393,53 @@ ExecInsert(ModifyTableState *mtstate,
 	}
 	else if (resultRelInfo->ri_FdwRoutine)
 	{
+		/*
+		 * If the FDW supports batching, queue a copy of the tuple and send
+		 * the batch to the FDW once it is full.  The inserted tuples are
+		 * counted, and their AFTER ROW triggers fired, when the batch is
+		 * sent; there's no RETURNING list when batching.
+		 */
+		if (resultRelInfo->ri_BatchSize > 1)
+		{
+			if (resultRelInfo->ri_Slots == NULL)
+			{
+				resultRelInfo->ri_Slots = (TupleTableSlot **)
+					palloc(sizeof(TupleTableSlot *) *
+						   resultRelInfo->ri_BatchSize);
+				resultRelInfo->ri_PlanSlots = (TupleTableSlot **)
+					palloc(sizeof(TupleTableSlot *) *
+						   resultRelInfo->ri_BatchSize);
+			}
+
+			if (resultRelInfo->ri_NumSlots ==
+				resultRelInfo->ri_NumSlotsInitialized)
+			{
+				TupleDesc	tdesc;
+
+				tdesc = CreateTupleDescCopy(slot->tts_tupleDescriptor);
+				resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots] =
+					MakeSingleTupleTableSlot(tdesc);
+				tdesc = CreateTupleDescCopy(planSlot->tts_tupleDescriptor);
+				resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots] =
+					MakeSingleTupleTableSlot(tdesc);
+				resultRelInfo->ri_NumSlotsInitialized++;
+			}
+
+			ExecCopySlot(resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots],
+						 slot);
+			ExecCopySlot(resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots],
+						 planSlot);
+			resultRelInfo->ri_NumSlots++;
+
+			if (resultRelInfo->ri_NumSlots >= resultRelInfo->ri_BatchSize)
+				ExecBatchInsert(resultRelInfo, estate, canSetTag);
+
+			if (saved_resultRelInfo)
+				estate->es_result_relation_info = saved_resultRelInfo;
+
+			return NULL;
+		}
+
 		/*
 		 * insert into foreign table: let the FDW do it
 		 */
@@ -601,6 +650,61 @@ ExecInsert(ModifyTableState *mtstate,
 	return result;
 }
 
+/* ----------------------------------------------------------------
+ *		ExecBatchInsert
+ *
+ *		Send the tuples queued by ExecInsert for a foreign table to the
+ *		FDW, and do the per-tuple work ExecInsert left for later.
+ * ----------------------------------------------------------------
+ */
+static void
+ExecBatchInsert(ResultRelInfo *resultRelInfo, EState *estate, bool canSetTag)
+{
+	TupleTableSlot **slots = resultRelInfo->ri_Slots;
+	TupleTableSlot **planSlots = resultRelInfo->ri_PlanSlots;
+	int			numSlots = resultRelInfo->ri_NumSlots;
+	TupleTableSlot **rslots;
+	int			i;
+
+	if (numSlots == 0)
+		return;
+
+	rslots = resultRelInfo->ri_FdwRoutine->ExecForeignBatchInsert(estate,
+																  resultRelInfo,
+																  slots,
+																  planSlots,
+																  &numSlots);
+
+	for (i = 0; i < numSlots; i++)
+	{
+		HeapTuple	tuple = ExecMaterializeSlot(rslots[i]);
+
+		/* as in ExecInsert, triggers might reference tableoid */
+		tuple->t_tableOid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
+
+		/* AFTER ROW INSERT Triggers */
+		ExecARInsertTriggers(estate, resultRelInfo, tuple, NIL);
+
+		/* Check any WITH CHECK OPTION constraints from parent views */
+		if (resultRelInfo->ri_WithCheckOptions != NIL)
+			ExecWithCheckOptions(WCO_VIEW_CHECK, resultRelInfo, rslots[i],
+								 estate);
+	}
+
+	if (canSetTag && numSlots > 0)
+	{
+		estate->es_processed += numSlots;
+		estate->es_lastoid = InvalidOid;
+	}
+
+	for (i = 0; i < resultRelInfo->ri_NumSlots; i++)
+	{
+		ExecClearTuple(slots[i]);
+		ExecClearTuple(planSlots[i]);
+	}
+	resultRelInfo->ri_NumSlots = 0;
+}
+
 /* ----------------------------------------------------------------
  *		ExecDelete
  *
@@ -1609,6 +1713,20 @@ ExecModifyTable(ModifyTableState *node)
 	/* Restore es_result_relation_info before exiting */
 	estate->es_result_relation_info = saved_resultRelInfo;
 
+	/* Insert any tuples still queued for batched inserts */
+	if (operation == CMD_INSERT)
+	{
+		int			i;
+
+		for (i = 0; i < node->mt_nplans; i++)
+		{
+			resultRelInfo = node->resultRelInfo + i;
+
+			if (resultRelInfo->ri_NumSlots > 0)
+				ExecBatchInsert(resultRelInfo, estate, node->canSetTag);
+		}
+	}
+
 	/*
 	 * We're done, but fire AFTER STATEMENT triggers before exiting.
 	 */
@@ -2093,6 +2211,31 @@ ExecInitModifyTable(ModifyTable *node, EState *estate, int eflags)
 		}
 	}
 
+	/*
+	 * Determine how many tuples to queue for each batched insert into a
+	 * foreign table.  Batching is only possible when the FDW supports it,
+	 * and there is no RETURNING list to compute for each tuple.
+	 */
+	resultRelInfo = mtstate->resultRelInfo;
+	for (i = 0; i < nplans; i++)
+	{
+		FdwRoutine *fdwroutine = resultRelInfo->ri_FdwRoutine;
+
+		if (operation == CMD_INSERT &&
+			!resultRelInfo->ri_usesFdwDirectModify &&
+			fdwroutine != NULL &&
+			fdwroutine->GetForeignModifyBatchSize != NULL &&
+			fdwroutine->ExecForeignBatchInsert != NULL &&
+			resultRelInfo->ri_projectReturning == NULL)
+			resultRelInfo->ri_BatchSize =
+				fdwroutine->GetForeignModifyBatchSize(resultRelInfo);
+		else
+			resultRelInfo->ri_BatchSize = 1;
+
+		Assert(resultRelInfo->ri_BatchSize >= 1);
+		resultRelInfo++;
+	}
+
 	/*
 	 * Set up a tuple table slot for use for trigger output tuples. In a plan
 	 * containing multiple ModifyTable nodes, all can share one such slot, so
@@ -2131,11 +2274,18 @@ ExecEndModifyTable(ModifyTableState *node)
 	int			i;
 
 	/*
-	 * Allow any FDWs to shut down
+	 * Allow any FDWs to shut down, and release the slots of batched inserts
 	 */
 	for (i = 0; i < node->mt_nplans; i++)
 	{
 		ResultRelInfo *resultRelInfo = node->resultRelInfo + i;
+		int			j;
+
+		for (j = 0; j < resultRelInfo->ri_NumSlotsInitialized; j++)
+		{
+			ExecDropSingleTupleTableSlot(resultRelInfo->ri_Slots[j]);
+			ExecDropSingleTupleTableSlot(resultRelInfo->ri_PlanSlots[j]);
+		}
 
 		if (!resultRelInfo->ri_usesFdwDirectModify &&
 			resultRelInfo->ri_FdwRoutine != NULL &&
@@ -1966,6 +1966,8 @@ _SPI_execute_plan(SPIPlanPtr plan, ParamListInfo paramLI,
 		CachedPlanSource *plansource = (CachedPlanSource *) lfirst(lc1);
 		List	   *stmt_list;
 		ListCell   *lc2;
+		instr_time	starttime;
+		instr_time	duration;
 
 		spierrcontext.arg = (void *) plansource->query_string;
 
@@ -2021,6 +2023,8 @@ _SPI_execute_plan(SPIPlanPtr plan, ParamListInfo paramLI,
 		cplan = GetCachedPlan(plansource, paramLI, plan->saved, _SPI_current->queryEnv);
 		stmt_list = cplan->stmt_list;
 
+		INSTR_TIME_SET_CURRENT(starttime);
+
 		/*
 		 * In the default non-read-only case, get a new snapshot, replacing
 		 * any that we pushed in a previous cycle.
@@ -2186,6 +2190,12 @@ _SPI_execute_plan(SPIPlanPtr plan, ParamListInfo paramLI,
 			}
 		}
 
+		/* Tell the plan cache how long the plan took to run */
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, starttime);
+		CachedPlanRecordExecution(plansource, cplan,
+								  INSTR_TIME_GET_MILLISEC(duration));
+
 		/* Done with this plan, so release refcount */
 		ReleaseCachedPlan(cplan, plan->saved);
 		cplan = NULL;
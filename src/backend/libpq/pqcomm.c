@@ -53,6 +53,7 @@
  *		pq_getmessage	- get a message with length word from connection
  *		pq_getbyte		- get next byte from connection
  *		pq_peekbyte		- peek at next byte from connection
+ *		pq_buffer_has_message - is a complete message waiting in the buffer?
  *		pq_putbytes		- send bytes to connection (not flushed until pq_flush)
  *		pq_flush		- flush pending output
  *		pq_flush_if_writable - flush pending output if writable without blocking
@@ -1009,6 +1010,37 @@ pq_peekbyte(void)
 	return (unsigned char) PqRecvBuffer[PqRecvPointer];
 }
 
+/* --------------------------------
+ *		pq_buffer_has_message	- is a complete message waiting in the buffer?
+ *
+ *	 True if the input buffer holds the whole of the next message: its type
+ *	 byte, length word and body.  This is the case when a client pipelining
+ *	 its messages has already sent the next one, and we can go on to process
+ *	 it without reading from the connection.
+ *
+ *	 We can only tell between messages, and only with protocol 3, whose
+ *	 messages carry a length word.  Otherwise we return false.
+ * --------------------------------
+ */
+bool
+pq_buffer_has_message(void)
+{
+	int			avail = PqRecvLength - PqRecvPointer;
+	uint32		len;
+
+	if (PqCommReadingMsg || PG_PROTOCOL_MAJOR(FrontendProtocol) < 3)
+		return false;
+
+	if (avail < 1 + 4)
+		return false;
+
+	memcpy(&len, PqRecvBuffer + PqRecvPointer + 1, 4);
+	len = ntohl(len);
+
+	/* The length word counts itself, but not the type byte */
+	return (len >= 4 && len <= avail - 1);
+}
+
 /* --------------------------------
  *		pq_getbyte_if_available - get a single byte from connection,
  *			if available
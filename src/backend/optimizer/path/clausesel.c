@@ -66,9 +66,9 @@ static void addRangeClause(RangeQueryClause **rqlist, Node *clause,
  * selectivity estimates using any extended statistcs on 'rel'.
  *
  * If we identify such extended statistics exist, we try to apply them.
- * Currently we only have (soft) functional dependencies, so apply these in as
- * many cases as possible, and fall back on normal estimates for remaining
- * clauses.
+ * We first apply multi-column MCV lists, which handle equality, inequality
+ * and IS NULL clauses, then (soft) functional dependencies for the remaining
+ * equality clauses, and fall back on normal estimates for remaining clauses.
  *
  * We also recognize "range queries", such as "x > 34 AND x < 42".  Clauses
  * are recognized as possible range query components if they are restriction
@@ -127,16 +127,18 @@ clauselist_selectivity(PlannerInfo *root,
 	{
 		/*
 		 * Perform selectivity estimations on any clauses found applicable by
-		 * dependencies_clauselist_selectivity. The 0-based list position of
-		 * estimated clauses will be populated in 'estimatedclauses'.
+		 * mcv_clauselist_selectivity. The 0-based list position of estimated
+		 * clauses will be populated in 'estimatedclauses'.
 		 */
-		s1 *= dependencies_clauselist_selectivity(root, clauses, varRelid,
+		s1 *= mcv_clauselist_selectivity(root, clauses, varRelid,
 								   jointype, sjinfo, rel, &estimatedclauses);
 
 		/*
-		 * This would be the place to apply any other types of extended
-		 * statistics selectivity estimations for remaining clauses.
+		 * Then apply functional dependencies to the clauses not estimated
+		 * using the MCV list.
 		 */
+		s1 *= dependencies_clauselist_selectivity(root, clauses, varRelid,
+								   jointype, sjinfo, rel, &estimatedclauses);
 	}
 
 	/*
@@ -25,6 +25,7 @@
 #include "catalog/pg_opfamily.h"
 #include "catalog/pg_type.h"
 #include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
@@ -32,6 +33,7 @@
 #include "optimizer/predtest.h"
 #include "optimizer/prep.h"
 #include "optimizer/restrictinfo.h"
+#include "optimizer/tlist.h"
 #include "optimizer/var.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
@@ -114,6 +116,8 @@ static List *build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 				  ScanTypeControl scantype,
 				  bool *skip_nonnative_saop,
 				  bool *skip_lower_saop);
+static bool distinct_skip_useful(PlannerInfo *root, RelOptInfo *rel,
+					 IndexPath *ipath);
 static List *build_paths_for_OR(PlannerInfo *root, RelOptInfo *rel,
 				   List *clauses, List *other_clauses);
 static List *generate_bitmap_or_paths(PlannerInfo *root, RelOptInfo *rel,
@@ -782,7 +786,8 @@ get_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	 * Also, pick out the ones that are usable as bitmap scans.  For that, we
 	 * must discard indexes that don't support bitmap scans, and we also are
 	 * only interested in paths that have some selectivity; we should discard
-	 * anything that was generated solely for ordering purposes.
+	 * anything that was generated solely for ordering purposes.  Skip scan
+	 * paths are plain-scan-only variants of another path in the list.
 	 */
 	foreach(lc, indexpaths)
 	{
@@ -791,7 +796,7 @@ get_index_paths(PlannerInfo *root, RelOptInfo *rel,
 		if (index->amhasgettuple)
 			add_path(rel, (Path *) ipath);
 
-		if (index->amhasgetbitmap &&
+		if (index->amhasgetbitmap && !ipath->indexskip &&
 			(ipath->path.pathkeys == NIL ||
 			 ipath->indexselectivity < 1.0))
 			*bitindexpaths = lappend(*bitindexpaths, ipath);
@@ -1050,6 +1055,28 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 								  false);
 		result = lappend(result, ipath);
 
+		/*
+		 * If the index AM can skip between the distinct values of the first
+		 * index column, and nothing restricts that column, consider skip
+		 * scans.  With clauses on later columns, a skip scan replaces a full
+		 * index scan by one short descent per distinct leading value.  For
+		 * SELECT DISTINCT on the leading column, a skip scan that stops after
+		 * the first tuple for each value yields the distinct values directly.
+		 */
+		if (index->amcanskip && enable_indexskipscan &&
+			scantype != ST_BITMAPSCAN && index_is_ordered &&
+			clauses->indexclauses[0] == NIL)
+		{
+			if (index_clauses != NIL && !found_lower_saop_clause)
+				result = lappend(result,
+								 create_index_skip_path(root, ipath, false,
+														loop_count));
+			if (distinct_skip_useful(root, rel, ipath))
+				result = lappend(result,
+								 create_index_skip_path(root, ipath, true,
+														loop_count));
+		}
+
 		/*
 		 * If appropriate, consider parallel index scan.  We don't allow
 		 * parallel index scan for bitmap index scans.
@@ -1139,6 +1166,60 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	return result;
 }
 
+/*
+ * distinct_skip_useful
+ *	  Determine whether a skip scan that returns only one tuple per value of
+ *	  the index's first column could produce the query's DISTINCT output.
+ *
+ * We handle only the simple case of SELECT DISTINCT on the first index
+ * column over a single relation, with every restriction clause used as an
+ * index qual.  The Unique step is still planned above the scan, so all we
+ * need to guarantee is that each distinct value comes out at least once.
+ */
+static bool
+distinct_skip_useful(PlannerInfo *root, RelOptInfo *rel, IndexPath *ipath)
+{
+	Query	   *parse = root->parse;
+	IndexOptInfo *index = ipath->indexinfo;
+	SortGroupClause *sgc;
+	Node	   *expr;
+	ListCell   *lc;
+
+	if (parse->commandType != CMD_SELECT ||
+		list_length(parse->distinctClause) != 1 || parse->hasDistinctOn ||
+		parse->groupClause || parse->groupingSets || parse->hasAggs ||
+		parse->hasWindowFuncs || parse->hasTargetSRFs ||
+		parse->havingQual || parse->rowMarks)
+		return false;
+
+	if (rel->reloptkind != RELOPT_BASEREL ||
+		!bms_equal(root->all_baserels, rel->relids))
+		return false;
+
+	/* The DISTINCT expression must be the first index column */
+	sgc = (SortGroupClause *) linitial(parse->distinctClause);
+	expr = get_sortgroupclause_expr(sgc, parse->targetList);
+	if (!match_index_to_operand(expr, 0, index) ||
+		!op_in_opfamily(sgc->eqop, index->opfamily[0]) ||
+		!IndexCollMatchesExprColl(index->indexcollations[0],
+								  exprCollation(expr)))
+		return false;
+
+	/*
+	 * No filter may reject the one tuple returned per value.  It's not enough
+	 * for a clause to be matched to the index: a lossy one, such as LIKE with
+	 * a fixed prefix, is only used to derive the indexquals, and must still
+	 * be checked against each tuple.
+	 */
+	foreach(lc, rel->baserestrictinfo)
+	{
+		if (!list_member_ptr(ipath->indexquals, lfirst(lc)))
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * build_paths_for_OR
  *	  Given a list of restriction clauses from one arm of an OR clause,
@@ -18,9 +18,13 @@
 
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "utils/lsyscache.h"
+#include "utils/typcache.h"
 
 /* Hook for plugins to get control in add_paths_to_joinrel() */
 set_join_pathlist_hook_type set_join_pathlist_hook = NULL;
@@ -38,6 +42,10 @@ static void try_partial_mergejoin_path(PlannerInfo *root,
 						   List *innersortkeys,
 						   JoinType jointype,
 						   JoinPathExtraData *extra);
+static Path *get_memoize_path(PlannerInfo *root, RelOptInfo *innerrel,
+				 RelOptInfo *outerrel, Path *inner_path,
+				 Path *outer_path, JoinType jointype,
+				 JoinPathExtraData *extra);
 static void sort_inner_and_outer(PlannerInfo *root, RelOptInfo *joinrel,
 					 RelOptInfo *outerrel, RelOptInfo *innerrel,
 					 JoinType jointype, JoinPathExtraData *extra);
@@ -734,6 +742,195 @@ clause_sides_match_join(RestrictInfo *rinfo, RelOptInfo *outerrel,
 	return false;				/* no good for these input relations */
 }
 
+/*
+ * add_memoize_key
+ *	  Append 'expr' to a Memoize cache key, along with the equality
+ *	  operator to compare it with.  Returns false if 'expr' can't be used.
+ */
+static bool
+add_memoize_key(Node *expr, List **param_exprs, List **operators)
+{
+	Oid			exprtype = exprType(expr);
+	TypeCacheEntry *typentry;
+
+	/* A volatile key could give a different value for each evaluation */
+	if (contain_volatile_functions(expr))
+		return false;
+
+	/* There's no point in comparing the same value twice */
+	if (list_member(*param_exprs, expr))
+		return true;
+
+	/*
+	 * The cache compares values of the key's type with each other, so we
+	 * need a hashable equality operator for the type itself; the join
+	 * clause's operator may be a cross-type one.
+	 */
+	typentry = lookup_type_cache(exprtype, TYPECACHE_EQ_OPR);
+	if (!OidIsValid(typentry->eq_opr) ||
+		!op_hashjoinable(typentry->eq_opr, exprtype))
+		return false;
+
+	*param_exprs = lappend(*param_exprs, expr);
+	*operators = lappend_oid(*operators, typentry->eq_opr);
+	return true;
+}
+
+/*
+ * paraminfo_get_equal_hashops
+ *	  Determine the cache key for a Memoize node above a parameterized
+ *	  inner path.
+ *
+ * The key consists of the outer side of each of the path's parameterized
+ * clauses, and any lateral references of the inner rel.  On success, we
+ * return true and set *param_exprs and *operators to parallel lists of the
+ * key expressions and their hash equality operators.  We fail if any
+ * clause is not a hashable equality between the two sides of the join, or
+ * any key expression can't be hashed.
+ *
+ * The inner rows for a parameterized clause depend only on which inner
+ * values the clause accepts, so outer values that are equal by the hash
+ * equality operator can share a cache entry.  A lateral reference can be
+ * used in any way, though; numeric 1.0 and 1.00 are equal, but the inner
+ * scan may well output them differently.  If there are lateral references,
+ * we set *binary_mode to tell the cache to compare keys by binary image.
+ */
+static bool
+paraminfo_get_equal_hashops(ParamPathInfo *param_info,
+							RelOptInfo *outerrel, RelOptInfo *innerrel,
+							List **param_exprs, List **operators,
+							bool *binary_mode)
+{
+	ListCell   *lc;
+
+	*param_exprs = NIL;
+	*operators = NIL;
+	*binary_mode = (innerrel->lateral_vars != NIL);
+
+	if (param_info != NULL)
+	{
+		foreach(lc, param_info->ppi_clauses)
+		{
+			RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+			OpExpr	   *opexpr;
+			Node	   *expr;
+
+			/*
+			 * A valid hashjoinoperator also tells us the clause is a binary
+			 * OpExpr.
+			 */
+			if (!OidIsValid(rinfo->hashjoinoperator) ||
+				!clause_sides_match_join(rinfo, outerrel, innerrel))
+				return false;
+
+			opexpr = (OpExpr *) rinfo->clause;
+			if (rinfo->outer_is_left)
+				expr = (Node *) linitial(opexpr->args);
+			else
+				expr = (Node *) lsecond(opexpr->args);
+
+			if (!add_memoize_key(expr, param_exprs, operators))
+				return false;
+		}
+	}
+
+	/* Lateral references are parameters of the inner scan as well */
+	foreach(lc, innerrel->lateral_vars)
+	{
+		if (!add_memoize_key((Node *) lfirst(lc), param_exprs, operators))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * get_memoize_path
+ *	  If possible, make and return a Memoize path atop of 'inner_path'.
+ *	  Otherwise return NULL.
+ *
+ * A Memoize node caches the inner rows for each set of parameter values, so
+ * that a rescan with values seen before needn't run 'inner_path' again.
+ * Whether that pays off is left to the rescan costing, which looks at the
+ * number of distinct parameter values expected from the outer side.
+ */
+static Path *
+get_memoize_path(PlannerInfo *root, RelOptInfo *innerrel,
+				 RelOptInfo *outerrel, Path *inner_path,
+				 Path *outer_path, JoinType jointype,
+				 JoinPathExtraData *extra)
+{
+	List	   *param_exprs;
+	List	   *hash_operators;
+	ListCell   *lc;
+	bool		singlerow = false;
+	bool		binary_mode;
+
+	/* Obviously not if it's disabled */
+	if (!enable_memoize)
+		return NULL;
+
+	/*
+	 * We can safely not bother with all this unless we expect to perform
+	 * more than one inner scan.  The first scan is always going to be a
+	 * cache miss.
+	 */
+	if (outer_path->rows < 2)
+		return NULL;
+
+	/*
+	 * We can only have a memoize node when there's some kind of cache key,
+	 * either parameterized path clauses or lateral Vars.  Without a cache
+	 * key, a Material node would be the better choice.
+	 */
+	if ((inner_path->param_info == NULL ||
+		 inner_path->param_info->ppi_clauses == NIL) &&
+		innerrel->lateral_vars == NIL)
+		return NULL;
+
+	/*
+	 * Semi and anti joins stop reading the inner side after its first match,
+	 * which would leave every cache entry incomplete.  If all the join's
+	 * clauses are enforced by the inner scan, though, its first row always
+	 * matches, and caching just that row is enough.  Otherwise, give up.
+	 */
+	if (jointype == JOIN_SEMI || jointype == JOIN_ANTI)
+	{
+		if (inner_path->param_info == NULL ||
+			list_length(inner_path->param_info->ppi_clauses) <
+			list_length(extra->restrictlist))
+			return NULL;
+		singlerow = true;
+	}
+
+	/*
+	 * We can't use a memoize node if there are volatile functions in the
+	 * inner rel's target list or restrict list.  A cache hit could reduce the
+	 * number of calls to these functions.
+	 */
+	if (contain_volatile_functions((Node *) innerrel->reltarget->exprs))
+		return NULL;
+
+	foreach(lc, innerrel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+	}
+
+	/* Check if we have hash ops for each parameter to the path */
+	if (!paraminfo_get_equal_hashops(inner_path->param_info, outerrel,
+									 innerrel, &param_exprs, &hash_operators,
+									 &binary_mode))
+		return NULL;
+
+	return (Path *) create_memoize_path(root, innerrel, inner_path,
+										param_exprs, hash_operators,
+										singlerow, binary_mode,
+										outer_path->rows);
+}
+
 /*
  * sort_inner_and_outer
  *	  Create mergejoin join paths by explicitly sorting both the outer and
@@ -1341,6 +1538,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *mpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -1349,6 +1547,22 @@ match_unsorted_outer(PlannerInfo *root,
 								  merge_pathkeys,
 								  jointype,
 								  extra);
+
+				/*
+				 * Try generating a memoize path and see if that makes the
+				 * nested loop any cheaper.
+				 */
+				mpath = get_memoize_path(root, innerrel, outerrel,
+										 innerpath, outerpath, jointype,
+										 extra);
+				if (mpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  outerpath,
+									  mpath,
+									  merge_pathkeys,
+									  jointype,
+									  extra);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
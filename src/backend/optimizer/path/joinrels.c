@@ -14,9 +14,15 @@
  */
 #include "postgres.h"
 
+#include "catalog/partition.h"
+#include "miscadmin.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
 #include "optimizer/joininfo.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/prep.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 
 
@@ -29,12 +35,24 @@ static void make_rels_by_clauseless_joins(PlannerInfo *root,
 static bool has_join_restriction(PlannerInfo *root, RelOptInfo *rel);
 static bool has_legal_joinclause(PlannerInfo *root, RelOptInfo *rel);
 static bool is_dummy_rel(RelOptInfo *rel);
-static void mark_dummy_rel(RelOptInfo *rel);
 static bool restriction_is_constant_false(List *restrictlist,
 							  bool only_pushed_down);
 static void populate_joinrel_with_paths(PlannerInfo *root, RelOptInfo *rel1,
 							RelOptInfo *rel2, RelOptInfo *joinrel,
 							SpecialJoinInfo *sjinfo, List *restrictlist);
+static void try_partition_wise_join(PlannerInfo *root, RelOptInfo *rel1,
+						RelOptInfo *rel2, RelOptInfo *joinrel,
+						SpecialJoinInfo *parent_sjinfo,
+						List *parent_restrictlist);
+static bool have_partkey_equi_join(RelOptInfo *rel1, RelOptInfo *rel2,
+					   JoinType jointype, List *restrictlist);
+static int	match_expr_to_partition_keys(Expr *expr, RelOptInfo *rel);
+static void build_joinrel_partition_info(RelOptInfo *joinrel,
+							 RelOptInfo *outer_rel, RelOptInfo *inner_rel,
+							 JoinType jointype);
+static SpecialJoinInfo *build_child_join_sjinfo(PlannerInfo *root,
+						SpecialJoinInfo *parent_sjinfo,
+						Relids left_relids, Relids right_relids);
 
 
 /*
@@ -731,6 +749,9 @@ make_join_rel(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2)
 	populate_joinrel_with_paths(root, rel1, rel2, joinrel, sjinfo,
 								restrictlist);
 
+	/* Also consider joining the matching partitions of the two rels. */
+	try_partition_wise_join(root, rel1, rel2, joinrel, sjinfo, restrictlist);
+
 	bms_free(joinrelids);
 
 	return joinrel;
@@ -1197,7 +1218,7 @@ is_dummy_rel(RelOptInfo *rel)
  * is that the best solution is to explicitly make the dummy path in the same
  * context the given RelOptInfo is in.
  */
-static void
+void
 mark_dummy_rel(RelOptInfo *rel)
 {
 	MemoryContext oldcontext;
@@ -1217,7 +1238,8 @@ mark_dummy_rel(RelOptInfo *rel)
 	rel->partial_pathlist = NIL;
 
 	/* Set up the dummy path */
-	add_path(rel, (Path *) create_append_path(rel, NIL, NULL, 0, NIL));
+	add_path(rel, (Path *) create_append_path(rel, NIL, NIL, NULL,
+											  0, false, NIL));
 
 	/* Set or update cheapest_total_path and related fields */
 	set_cheapest(rel);
@@ -1268,3 +1290,369 @@ restriction_is_constant_false(List *restrictlist, bool only_pushed_down)
 	}
 	return false;
 }
+
+/*
+ * try_partition_wise_join
+ *	  Assess whether the join between two partitioned relations can be broken
+ *	  down into joins between their matching partitions, and if so, add
+ *	  paths for those "child joins".
+ *
+ * This is possible when both relations share a partitioning scheme and
+ * partition bounds, and the join has an equi-join clause between each pair
+ * of matching partition key columns: then a row of one partition can only
+ * join to rows of the matching partition of the other relation.  The child
+ * joins are RelOptInfos of kind RELOPT_OTHER_JOINREL kept in the joinrel's
+ * part_rels[] array; generate_partition_wise_join_paths() later puts an
+ * Append path over them into the joinrel.
+ *
+ * We don't handle full outer joins, since rows of either side might then
+ * appear in the join result with NULL partition keys.  Nor do we handle
+ * joins that need to compute PlaceHolderVars or involve LATERAL references,
+ * whose translation into child joins we don't support.
+ */
+static void
+try_partition_wise_join(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2,
+						RelOptInfo *joinrel, SpecialJoinInfo *parent_sjinfo,
+						List *parent_restrictlist)
+{
+	PartitionScheme part_scheme;
+	int			nparts;
+	int			cnt_parts;
+
+	if (!enable_partition_wise_join)
+		return;
+
+	/* Guard against stack overflow due to overly deep join trees. */
+	check_stack_depth();
+
+	/* Nothing to do if the join is already known to be empty. */
+	if (IS_DUMMY_REL(joinrel))
+		return;
+
+	/* Both sides must be partitioned, in exactly the same way. */
+	if (!IS_PARTITIONED_REL(rel1) || !IS_PARTITIONED_REL(rel2))
+		return;
+
+	part_scheme = rel1->part_scheme;
+	if (rel2->part_scheme != part_scheme || rel1->nparts != rel2->nparts)
+		return;
+
+	if (!partition_bounds_equal(part_scheme->partnatts,
+								part_scheme->parttyplen,
+								part_scheme->parttypbyval,
+								rel1->boundinfo, rel2->boundinfo))
+		return;
+
+	if (parent_sjinfo->jointype == JOIN_FULL)
+		return;
+
+	if (root->placeholder_list != NIL ||
+		!bms_is_empty(joinrel->lateral_relids))
+		return;
+
+	if (!have_partkey_equi_join(rel1, rel2, parent_sjinfo->jointype,
+								parent_restrictlist))
+		return;
+
+	/*
+	 * The joinrel may already have been found partitioned while joining some
+	 * other pair of its input rels.  Any two such pairs produce the same
+	 * partitioning, since all the base rels involved must then share
+	 * part_scheme and bounds.
+	 */
+	if (joinrel->part_scheme == NULL)
+		build_joinrel_partition_info(joinrel, rel1, rel2,
+									 parent_sjinfo->jointype);
+	else if (joinrel->part_scheme != part_scheme ||
+			 joinrel->nparts != rel1->nparts)
+		return;
+
+	nparts = joinrel->nparts;
+
+	/*
+	 * Create child-join relations for this partitioned join, if those don't
+	 * exist yet, and add paths to join the matching pairs of partitions.
+	 */
+	for (cnt_parts = 0; cnt_parts < nparts; cnt_parts++)
+	{
+		RelOptInfo *child_rel1 = rel1->part_rels[cnt_parts];
+		RelOptInfo *child_rel2 = rel2->part_rels[cnt_parts];
+		SpecialJoinInfo *child_sjinfo;
+		List	   *child_restrictlist;
+		RelOptInfo *child_joinrel;
+		Relids		child_joinrelids;
+		List	   *appinfos;
+
+		/* We should never try to join two overlapping sets of rels. */
+		Assert(!bms_overlap(child_rel1->relids, child_rel2->relids));
+		child_joinrelids = bms_union(child_rel1->relids, child_rel2->relids);
+		appinfos = find_appinfos_by_relids(root, child_joinrelids);
+
+		/*
+		 * Construct SpecialJoinInfo from parent join relations's
+		 * SpecialJoinInfo.
+		 */
+		child_sjinfo = build_child_join_sjinfo(root, parent_sjinfo,
+											   child_rel1->relids,
+											   child_rel2->relids);
+
+		/*
+		 * Construct restrictions applicable to the child join from those
+		 * applicable to the parent join.
+		 */
+		child_restrictlist = (List *)
+			adjust_appendrel_attrs_list(root, (Node *) parent_restrictlist,
+										appinfos);
+
+		child_joinrel = joinrel->part_rels[cnt_parts];
+		if (!child_joinrel)
+		{
+			child_joinrel = build_child_join_rel(root, child_rel1, child_rel2,
+												 joinrel, child_restrictlist,
+												 child_sjinfo,
+												 child_sjinfo->jointype,
+												 appinfos);
+			joinrel->part_rels[cnt_parts] = child_joinrel;
+		}
+
+		Assert(bms_equal(child_joinrel->relids, child_joinrelids));
+
+		populate_joinrel_with_paths(root, child_rel1, child_rel2,
+									child_joinrel, child_sjinfo,
+									child_restrictlist);
+
+		bms_free(child_joinrelids);
+		list_free(appinfos);
+	}
+}
+
+/*
+ * Returns true if there exists an equi-join condition for each pair of
+ * partition keys from given relations being joined.
+ */
+static bool
+have_partkey_equi_join(RelOptInfo *rel1, RelOptInfo *rel2,
+					   JoinType jointype, List *restrictlist)
+{
+	PartitionScheme part_scheme = rel1->part_scheme;
+	bool		pk_has_clause[PARTITION_MAX_KEYS];
+	int			num_equal_pks;
+	ListCell   *lc;
+
+	/*
+	 * This function should be called when the joining relations have same
+	 * partitioning scheme.
+	 */
+	Assert(rel1->part_scheme == rel2->part_scheme);
+	Assert(part_scheme->partnatts <= PARTITION_MAX_KEYS);
+
+	memset(pk_has_clause, 0, sizeof(pk_has_clause));
+	num_equal_pks = 0;
+
+	foreach(lc, restrictlist)
+	{
+		RestrictInfo *rinfo = castNode(RestrictInfo, lfirst(lc));
+		OpExpr	   *opexpr;
+		Expr	   *expr1;
+		Expr	   *expr2;
+		int			ipk1;
+		int			ipk2;
+
+		/* If processing an outer join, only use its own join clauses. */
+		if (IS_OUTER_JOIN(jointype) && rinfo->is_pushed_down)
+			continue;
+
+		/* Skip clauses which can not be used for a join. */
+		if (!rinfo->can_join)
+			continue;
+
+		/* Skip clauses which are not equality conditions. */
+		if (!rinfo->mergeopfamilies)
+			continue;
+
+		opexpr = (OpExpr *) rinfo->clause;
+		Assert(is_opclause(opexpr));
+
+		/*
+		 * The equi-join between partition keys is strict if equi-join between
+		 * at least one partition key is using a strict operator.  See
+		 * explanation about outer join reordering identity 3 in
+		 * optimizer/README
+		 */
+		if (!op_strict(opexpr->opno))
+			continue;
+
+		/* Match the operands to the relation. */
+		if (bms_is_subset(rinfo->left_relids, rel1->relids) &&
+			bms_is_subset(rinfo->right_relids, rel2->relids))
+		{
+			expr1 = linitial(opexpr->args);
+			expr2 = lsecond(opexpr->args);
+		}
+		else if (bms_is_subset(rinfo->left_relids, rel2->relids) &&
+				 bms_is_subset(rinfo->right_relids, rel1->relids))
+		{
+			expr1 = lsecond(opexpr->args);
+			expr2 = linitial(opexpr->args);
+		}
+		else
+			continue;
+
+		/*
+		 * Only clauses referencing the partition keys are useful for
+		 * partition-wise join.
+		 */
+		ipk1 = match_expr_to_partition_keys(expr1, rel1);
+		if (ipk1 < 0)
+			continue;
+		ipk2 = match_expr_to_partition_keys(expr2, rel2);
+		if (ipk2 < 0)
+			continue;
+
+		/*
+		 * If the clause refers to keys at different ordinal positions, it
+		 * can not be used for partition-wise join.
+		 */
+		if (ipk1 != ipk2)
+			continue;
+
+		/*
+		 * The clause allows partition-wise join if only it uses the same
+		 * operator family as that specified by the partition key.
+		 */
+		if (!list_member_oid(rinfo->mergeopfamilies,
+							 part_scheme->partopfamily[ipk1]))
+			continue;
+
+		/* Mark the partition key as having an equi-join clause. */
+		if (!pk_has_clause[ipk1])
+		{
+			pk_has_clause[ipk1] = true;
+			num_equal_pks++;
+		}
+	}
+
+	/* Check whether every partition key has an equi-join condition. */
+	return (num_equal_pks == part_scheme->partnatts);
+}
+
+/*
+ * Find the partition key from the given relation matching the given
+ * expression. If found, return the index of the partition key, else return
+ * -1.
+ */
+static int
+match_expr_to_partition_keys(Expr *expr, RelOptInfo *rel)
+{
+	int			cnt;
+
+	/* This function should be called only for partitioned relations. */
+	Assert(rel->part_scheme);
+
+	/* Remove any relabel decorations. */
+	while (IsA(expr, RelabelType))
+		expr = (Expr *) (castNode(RelabelType, expr))->arg;
+
+	for (cnt = 0; cnt < rel->part_scheme->partnatts; cnt++)
+	{
+		ListCell   *lc;
+
+		Assert(rel->partexprs);
+		foreach(lc, rel->partexprs[cnt])
+		{
+			if (equal(lfirst(lc), expr))
+				return cnt;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * build_joinrel_partition_info
+ *	  Mark a join relation as partitioned the same way as its inputs.
+ *
+ * After an inner join, a row's partition key can be computed from either
+ * side, so both sides' key expressions describe the join's partition key.
+ * After a left, semi or anti join, only the outer side's expressions do,
+ * since the inner side's columns may have gone to NULL.
+ */
+static void
+build_joinrel_partition_info(RelOptInfo *joinrel, RelOptInfo *outer_rel,
+							 RelOptInfo *inner_rel, JoinType jointype)
+{
+	int			partnatts;
+	int			cnt;
+
+	Assert(outer_rel->part_scheme == inner_rel->part_scheme);
+
+	joinrel->part_scheme = outer_rel->part_scheme;
+	joinrel->boundinfo = outer_rel->boundinfo;
+	joinrel->nparts = outer_rel->nparts;
+	joinrel->part_rels = (RelOptInfo **)
+		palloc0(sizeof(RelOptInfo *) * joinrel->nparts);
+
+	partnatts = joinrel->part_scheme->partnatts;
+	joinrel->partexprs = (List **) palloc0(sizeof(List *) * partnatts);
+
+	for (cnt = 0; cnt < partnatts; cnt++)
+	{
+		List	   *outer_expr = outer_rel->partexprs[cnt];
+		List	   *inner_expr = inner_rel->partexprs[cnt];
+		List	   *partexpr = NIL;
+
+		switch (jointype)
+		{
+			case JOIN_INNER:
+				partexpr = list_concat(list_copy(outer_expr),
+									   list_copy(inner_expr));
+				break;
+
+			case JOIN_SEMI:
+			case JOIN_ANTI:
+			case JOIN_LEFT:
+				partexpr = list_copy(outer_expr);
+				break;
+
+			default:
+				elog(ERROR, "unrecognized join type: %d", (int) jointype);
+		}
+
+		joinrel->partexprs[cnt] = partexpr;
+	}
+}
+
+/*
+ * Construct the SpecialJoinInfo for a child-join by translating
+ * SpecialJoinInfo for the join between parents. left_relids and right_relids
+ * are the relids of left and right side of the join respectively.
+ */
+static SpecialJoinInfo *
+build_child_join_sjinfo(PlannerInfo *root, SpecialJoinInfo *parent_sjinfo,
+						Relids left_relids, Relids right_relids)
+{
+	SpecialJoinInfo *sjinfo = makeNode(SpecialJoinInfo);
+	List	   *left_appinfos;
+	List	   *right_appinfos;
+
+	memcpy(sjinfo, parent_sjinfo, sizeof(SpecialJoinInfo));
+	left_appinfos = find_appinfos_by_relids(root, left_relids);
+	right_appinfos = find_appinfos_by_relids(root, right_relids);
+
+	sjinfo->min_lefthand = adjust_child_relids(sjinfo->min_lefthand,
+											   left_appinfos);
+	sjinfo->min_righthand = adjust_child_relids(sjinfo->min_righthand,
+												right_appinfos);
+	sjinfo->syn_lefthand = adjust_child_relids(sjinfo->syn_lefthand,
+											   left_appinfos);
+	sjinfo->syn_righthand = adjust_child_relids(sjinfo->syn_righthand,
+												right_appinfos);
+	sjinfo->semi_rhs_exprs = (List *)
+		adjust_appendrel_attrs_list(root, (Node *) sjinfo->semi_rhs_exprs,
+									right_appinfos);
+
+	list_free(left_appinfos);
+	list_free(right_appinfos);
+
+	return sjinfo;
+}
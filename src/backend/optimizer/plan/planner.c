@@ -18,10 +18,13 @@
 #include <limits.h>
 #include <math.h>
 
+#include "access/genam.h"
+#include "access/heapam.h"
 #include "access/htup_details.h"
 #include "access/parallel.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
+#include "catalog/partition.h"
 #include "catalog/pg_constraint_fn.h"
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
@@ -111,6 +114,7 @@ typedef struct
 /* Local functions */
 static Node *preprocess_expression(PlannerInfo *root, Node *expr, int kind);
 static void preprocess_qual_conditions(PlannerInfo *root, Node *jtnode);
+static bool insert_parallel_mode_ok(Query *parse);
 static void inheritance_planner(PlannerInfo *root);
 static void grouping_planner(PlannerInfo *root, bool inheritance_update,
 				 double tuple_fraction);
@@ -136,8 +140,38 @@ static Size estimate_hashagg_tablesize(Path *path,
 static RelOptInfo *create_grouping_paths(PlannerInfo *root,
 					  RelOptInfo *input_rel,
 					  PathTarget *target,
+					  PathTarget *input_target,
 					  const AggClauseCosts *agg_costs,
 					  grouping_sets_data *gd);
+static void create_partition_wise_grouping_paths(PlannerInfo *root,
+									 RelOptInfo *input_rel,
+									 RelOptInfo *grouped_rel,
+									 PathTarget *target,
+									 PathTarget *input_target,
+									 const AggClauseCosts *agg_costs,
+									 bool can_sort,
+									 bool can_hash,
+									 double dNumGroups);
+static void add_child_grouping_paths(PlannerInfo *root,
+						 RelOptInfo *child_grouped_rel,
+						 Path *path,
+						 PathTarget *target,
+						 AggSplit aggsplit,
+						 List *havingQual,
+						 const AggClauseCosts *agg_costs,
+						 bool can_sort,
+						 bool can_hash,
+						 bool partial);
+static void add_finalize_grouping_paths(PlannerInfo *root,
+							RelOptInfo *grouped_rel,
+							Path *path,
+							PathTarget *target,
+							const AggClauseCosts *agg_final_costs,
+							bool can_sort,
+							bool can_hash,
+							double dNumGroups);
+static bool group_by_has_partkey(RelOptInfo *input_rel, List *groupClause,
+					 List *targetList);
 static void consider_groupingsets_paths(PlannerInfo *root,
 							RelOptInfo *grouped_rel,
 							Path *path,
@@ -256,6 +290,12 @@ standard_planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	 * to values that don't permit parallelism, or if parallel-unsafe
 	 * functions are present in the query tree.
 	 *
+	 * As an exception to the no-modification rule, a plain INSERT may use
+	 * parallel mode for its source query if the rows inserted can't run any
+	 * parallel-unsafe code; the rows are still inserted by the leader.  (CREATE
+	 * TABLE AS and SELECT INTO reach us as plain SELECTs, and the executor lets
+	 * the leader write their rows the same way.)
+	 *
 	 * For now, we don't try to use parallel mode if we're running inside a
 	 * parallel worker.  We might eventually be able to relax this
 	 * restriction, but for now it seems best not to have parallel workers
@@ -272,11 +312,11 @@ standard_planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	if ((cursorOptions & CURSOR_OPT_PARALLEL_OK) != 0 &&
 		IsUnderPostmaster &&
 		dynamic_shared_memory_type != DSM_IMPL_NONE &&
-		parse->commandType == CMD_SELECT &&
 		!parse->hasModifyingCTE &&
 		max_parallel_workers_per_gather > 0 &&
 		!IsParallelWorker() &&
-		!IsolationIsSerializable())
+		!IsolationIsSerializable() &&
+		(parse->commandType == CMD_SELECT || insert_parallel_mode_ok(parse)))
 	{
 		/* all the cheap tests pass, so scan the query tree */
 		glob->maxParallelHazard = max_parallel_hazard(parse);
@@ -450,6 +490,82 @@ standard_planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 }
 
 
+/*
+ * insert_parallel_mode_ok
+ *		Can the target relation of this INSERT be written in parallel mode?
+ *
+ * The leader inserts the rows the (possibly parallel) source query returns,
+ * but it does so in parallel mode, where it can't fire triggers, which might
+ * write anything, nor run parallel-unsafe functions to check the rows'
+ * constraints or to build their index entries.  ON CONFLICT may have to lock
+ * or update existing rows, which parallel mode doesn't allow either.  Column
+ * defaults are part of the query's targetlist, so max_parallel_hazard()
+ * takes care of those.
+ */
+static bool
+insert_parallel_mode_ok(Query *parse)
+{
+	RangeTblEntry *rte;
+	Relation	rel;
+	TupleDesc	tupDesc;
+	List	   *indexoidlist;
+	ListCell   *lc;
+	bool		safe = true;
+	int			i;
+
+	if (parse->commandType != CMD_INSERT || parse->onConflict != NULL)
+		return false;
+
+	/* The rewriter already locked the target relation */
+	rte = rt_fetch(parse->resultRelation, parse->rtable);
+	rel = heap_open(rte->relid, NoLock);
+	tupDesc = RelationGetDescr(rel);
+
+	/* Foreign key checks are triggers too */
+	if (rel->rd_rel->relkind != RELKIND_RELATION || rel->trigdesc != NULL)
+		safe = false;
+
+	if (safe && tupDesc->constr != NULL)
+	{
+		for (i = 0; i < tupDesc->constr->num_check; i++)
+		{
+			Node	   *check = stringToNode(tupDesc->constr->check[i].ccbin);
+
+			if (!is_parallel_safe_expr(check))
+			{
+				safe = false;
+				break;
+			}
+		}
+	}
+
+	if (safe && rel->rd_rel->relispartition &&
+		!is_parallel_safe_expr((Node *) RelationGetPartitionQual(rel)))
+		safe = false;
+
+	if (safe)
+	{
+		indexoidlist = RelationGetIndexList(rel);
+		foreach(lc, indexoidlist)
+		{
+			Relation	indexDesc = index_open(lfirst_oid(lc), AccessShareLock);
+
+			if (!is_parallel_safe_expr((Node *) RelationGetIndexExpressions(indexDesc)) ||
+				!is_parallel_safe_expr((Node *) RelationGetIndexPredicate(indexDesc)))
+				safe = false;
+
+			index_close(indexDesc, NoLock);
+			if (!safe)
+				break;
+		}
+		list_free(indexoidlist);
+	}
+
+	heap_close(rel, NoLock);
+
+	return safe;
+}
+
 /*--------------------
  * subquery_planner
  *	  Invokes the planner on a subquery.  We recurse to here for each
@@ -1871,6 +1987,7 @@ grouping_planner(PlannerInfo *root, bool inheritance_update,
 			current_rel = create_grouping_paths(root,
 												current_rel,
 												grouping_target,
+												scanjoin_target,
 												&agg_costs,
 												gset_data);
 			/* Fix things up if grouping_target contains SRFs */
@@ -2051,7 +2168,8 @@ grouping_planner(PlannerInfo *root, bool inheritance_update,
 	if (final_rel->fdwroutine &&
 		final_rel->fdwroutine->GetForeignUpperPaths)
 		final_rel->fdwroutine->GetForeignUpperPaths(root, UPPERREL_FINAL,
-													current_rel, final_rel);
+													current_rel, final_rel,
+													NULL);
 
 	/* Let extensions possibly add some more paths */
 	if (create_upper_paths_hook)
@@ -3487,6 +3605,7 @@ estimate_hashagg_tablesize(Path *path, const AggClauseCosts *agg_costs,
  *
  * input_rel: contains the source-data Paths
  * target: the pathtarget for the result Paths to compute
+ * input_target: the pathtarget computed by input_rel's Paths
  * agg_costs: cost info about all aggregates in query (in AGGSPLIT_SIMPLE mode)
  * rollup_lists: list of grouping sets, or NIL if not doing grouping sets
  * rollup_groupclauses: list of grouping clauses for grouping sets,
@@ -3504,6 +3623,7 @@ static RelOptInfo *
 create_grouping_paths(PlannerInfo *root,
 					  RelOptInfo *input_rel,
 					  PathTarget *target,
+					  PathTarget *input_target,
 					  const AggClauseCosts *agg_costs,
 					  grouping_sets_data *gd)
 {
@@ -3587,8 +3707,10 @@ create_grouping_paths(PlannerInfo *root,
 			path = (Path *)
 				create_append_path(grouped_rel,
 								   paths,
+								   NIL,
 								   NULL,
 								   0,
+								   false,
 								   NIL);
 			path->pathtarget = target;
 		}
@@ -4093,6 +4215,21 @@ create_grouping_paths(PlannerInfo *root,
 		}
 	}
 
+	/*
+	 * If the input is partitioned, consider grouping each partition on its
+	 * own and appending the results.  We don't try this for grouping sets,
+	 * nor when the grouping target contains SRFs, which must be evaluated
+	 * above the Agg.
+	 */
+	if (enable_partition_wise_agg &&
+		IS_PARTITIONED_REL(input_rel) &&
+		!parse->groupingSets &&
+		!parse->hasTargetSRFs &&
+		(can_sort || can_hash))
+		create_partition_wise_grouping_paths(root, input_rel, grouped_rel,
+											 target, input_target, agg_costs,
+											 can_sort, can_hash, dNumGroups);
+
 	/* Give a helpful error if we failed to find any implementation */
 	if (grouped_rel->pathlist == NIL)
 		ereport(ERROR,
@@ -4106,8 +4243,16 @@ create_grouping_paths(PlannerInfo *root,
 	 */
 	if (grouped_rel->fdwroutine &&
 		grouped_rel->fdwroutine->GetForeignUpperPaths)
+	{
+		GroupPathExtraData extra;
+
+		extra.target = target;
+		extra.havingQual = (List *) parse->havingQual;
+		extra.partial = false;
 		grouped_rel->fdwroutine->GetForeignUpperPaths(root, UPPERREL_GROUP_AGG,
-													  input_rel, grouped_rel);
+													  input_rel, grouped_rel,
+													  &extra);
+	}
 
 	/* Let extensions possibly add some more paths */
 	if (create_upper_paths_hook)
@@ -4130,6 +4275,454 @@ create_grouping_paths(PlannerInfo *root,
 	return grouped_rel;
 }
 
+/*
+ * create_partition_wise_grouping_paths
+ *
+ * Consider performing grouping and/or aggregation separately for each
+ * partition of input_rel, and appending the per-partition results.
+ *
+ * If the GROUP BY clause includes all the partition keys, all the rows of
+ * any one group come from the same partition, so each partition can be
+ * grouped completely on its own and the Append yields the final result
+ * ("full" partition-wise aggregation).  Otherwise, we can still compute
+ * partial aggregates for each partition, provided all the aggregates
+ * support that, and combine them with a Finalize Aggregate above the Append
+ * ("partial" partition-wise aggregation).  Either way the per-partition
+ * sorts and hash tables are much smaller than one over the whole input, and
+ * the Append can be made parallel-aware so that workers share out the
+ * partitions.
+ *
+ * The paths generated here are added to grouped_rel; it's up to add_path to
+ * decide whether they beat grouping above the Append.
+ */
+static void
+create_partition_wise_grouping_paths(PlannerInfo *root,
+									 RelOptInfo *input_rel,
+									 RelOptInfo *grouped_rel,
+									 PathTarget *target,
+									 PathTarget *input_target,
+									 const AggClauseCosts *agg_costs,
+									 bool can_sort,
+									 bool can_hash,
+									 double dNumGroups)
+{
+	Query	   *parse = root->parse;
+	bool		full_agg;
+	PathTarget *child_agg_target;
+	AggSplit	aggsplit;
+	AggClauseCosts agg_partial_costs;
+	AggClauseCosts agg_final_costs;
+	const AggClauseCosts *child_agg_costs;
+	List	   *subpaths = NIL;
+	List	   *partial_subpaths = NIL;
+	bool		partial_subpaths_valid;
+	int			parallel_workers = 0;
+	List	   *partitioned_rels;
+	Path	   *path;
+	int			cnt_parts;
+
+	Assert(IS_PARTITIONED_REL(input_rel));
+
+	full_agg = group_by_has_partkey(input_rel, parse->groupClause,
+									parse->targetList);
+
+	if (full_agg)
+	{
+		/* Each partition computes its share of the final result. */
+		child_agg_target = target;
+		aggsplit = AGGSPLIT_SIMPLE;
+		child_agg_costs = agg_costs;
+	}
+	else
+	{
+		/* Partial aggregation requires support from every aggregate. */
+		if (agg_costs->hasNonPartial || agg_costs->hasNonSerial)
+			return;
+
+		/*
+		 * As for parallel aggregation, the partial paths must emit any Vars
+		 * and Aggrefs needed in HAVING, with the Aggrefs in partial mode.
+		 */
+		child_agg_target = make_partial_grouping_target(root, target);
+		aggsplit = AGGSPLIT_INITIAL_SERIAL;
+
+		MemSet(&agg_partial_costs, 0, sizeof(AggClauseCosts));
+		MemSet(&agg_final_costs, 0, sizeof(AggClauseCosts));
+		if (parse->hasAggs)
+		{
+			get_agg_clause_costs(root, (Node *) child_agg_target->exprs,
+								 AGGSPLIT_INITIAL_SERIAL,
+								 &agg_partial_costs);
+			get_agg_clause_costs(root, (Node *) target->exprs,
+								 AGGSPLIT_FINAL_DESERIAL,
+								 &agg_final_costs);
+			get_agg_clause_costs(root, parse->havingQual,
+								 AGGSPLIT_FINAL_DESERIAL,
+								 &agg_final_costs);
+		}
+		child_agg_costs = &agg_partial_costs;
+	}
+
+	/*
+	 * For full aggregation, a parallel-aware Append can hand out entire
+	 * per-partition aggregates to the workers.  For partial aggregation, each
+	 * partition can instead be partially aggregated in parallel, and the
+	 * Append made up of those partial paths.
+	 */
+	partial_subpaths_valid = grouped_rel->consider_parallel &&
+		is_parallel_safe(root, (Node *) input_target->exprs) &&
+		(!full_agg || enable_parallel_append);
+
+	for (cnt_parts = 0; cnt_parts < input_rel->nparts; cnt_parts++)
+	{
+		RelOptInfo *child_input_rel = input_rel->part_rels[cnt_parts];
+		RelOptInfo *child_grouped_rel;
+		List	   *appinfos;
+		PathTarget *child_input_target;
+		PathTarget *child_target;
+		List	   *child_having = NIL;
+		Path	   *cheapest_path;
+
+		if (child_input_rel == NULL)
+			return;
+
+		/* A dummy partition contributes no rows, hence no groups. */
+		if (IS_DUMMY_REL(child_input_rel))
+			continue;
+
+		cheapest_path = child_input_rel->cheapest_total_path;
+		if (cheapest_path == NULL || cheapest_path->param_info != NULL)
+			return;
+
+		/* Translate the targets and HAVING qual to refer to this partition. */
+		appinfos = find_appinfos_by_relids(root, child_input_rel->relids);
+
+		child_input_target = copy_pathtarget(input_target);
+		child_input_target->exprs = (List *)
+			adjust_appendrel_attrs_list(root,
+										(Node *) input_target->exprs,
+										appinfos);
+
+		child_target = copy_pathtarget(child_agg_target);
+		child_target->exprs = (List *)
+			adjust_appendrel_attrs_list(root,
+										(Node *) child_agg_target->exprs,
+										appinfos);
+
+		if (full_agg)
+			child_having = (List *)
+				adjust_appendrel_attrs_list(root, parse->havingQual, appinfos);
+
+		child_grouped_rel = fetch_upper_rel(root, UPPERREL_GROUP_AGG,
+											child_input_rel->relids);
+		child_grouped_rel->consider_parallel = grouped_rel->consider_parallel;
+
+		/* If the partition belongs to a single FDW, so does its grouping. */
+		child_grouped_rel->serverid = child_input_rel->serverid;
+		child_grouped_rel->userid = child_input_rel->userid;
+		child_grouped_rel->useridiscurrent = child_input_rel->useridiscurrent;
+		child_grouped_rel->fdwroutine = child_input_rel->fdwroutine;
+
+		path = (Path *) create_projection_path(root, child_input_rel,
+											   cheapest_path,
+											   child_input_target);
+		add_child_grouping_paths(root, child_grouped_rel, path, child_target,
+								 aggsplit, child_having, child_agg_costs,
+								 can_sort, can_hash, false);
+
+		/*
+		 * Let the FDW, if any, consider doing the partition's share of the
+		 * grouping remotely.
+		 */
+		if (child_grouped_rel->fdwroutine &&
+			child_grouped_rel->fdwroutine->GetForeignUpperPaths)
+		{
+			FdwRoutine *fdwroutine = child_grouped_rel->fdwroutine;
+			GroupPathExtraData extra;
+
+			extra.target = child_target;
+			extra.havingQual = child_having;
+			extra.partial = !full_agg;
+			fdwroutine->GetForeignUpperPaths(root, UPPERREL_GROUP_AGG,
+											 child_input_rel,
+											 child_grouped_rel, &extra);
+		}
+
+		set_cheapest(child_grouped_rel);
+		subpaths = lappend(subpaths, child_grouped_rel->cheapest_total_path);
+
+		if (!partial_subpaths_valid)
+			continue;
+
+		if (full_agg)
+		{
+			if (!child_grouped_rel->cheapest_total_path->parallel_safe)
+				partial_subpaths_valid = false;
+		}
+		else if (child_input_rel->partial_pathlist == NIL)
+			partial_subpaths_valid = false;
+		else
+		{
+			Path	   *partial_path = linitial(child_input_rel->partial_pathlist);
+
+			partial_path = (Path *)
+				create_projection_path(root, child_input_rel, partial_path,
+									   child_input_target);
+			add_child_grouping_paths(root, child_grouped_rel, partial_path,
+									 child_target, aggsplit, NIL,
+									 child_agg_costs, can_sort, can_hash,
+									 true);
+			if (child_grouped_rel->partial_pathlist == NIL)
+				partial_subpaths_valid = false;
+			else
+			{
+				partial_path = linitial(child_grouped_rel->partial_pathlist);
+				partial_subpaths = lappend(partial_subpaths, partial_path);
+				parallel_workers = Max(parallel_workers,
+									   partial_path->parallel_workers);
+			}
+		}
+	}
+
+	/* Nothing to gain if every partition was excluded. */
+	if (subpaths == NIL)
+		return;
+
+	if (IS_SIMPLE_REL(input_rel))
+		partitioned_rels = get_partitioned_child_rels(root, input_rel->relid);
+	else
+		partitioned_rels = get_partitioned_child_rels_for_join(root,
+													   input_rel->relids);
+
+	path = (Path *) create_append_path(grouped_rel, subpaths, NIL, NULL,
+									   0, false, partitioned_rels);
+	path->pathtarget = child_agg_target;
+
+	if (full_agg)
+		add_path(grouped_rel, path);
+	else
+		add_finalize_grouping_paths(root, grouped_rel, path, target,
+									&agg_final_costs, can_sort, can_hash,
+									dNumGroups);
+
+	if (partial_subpaths_valid)
+	{
+		double		total_rows;
+
+		/* Same formula as for a parallel Append of a partitioned scan. */
+		parallel_workers = Max(parallel_workers, fls(list_length(subpaths)));
+		parallel_workers = Min(parallel_workers,
+							   max_parallel_workers_per_gather);
+		if (parallel_workers <= 0)
+			return;
+
+		if (full_agg)
+			path = (Path *) create_append_path(grouped_rel, subpaths, NIL,
+											   NULL, parallel_workers, true,
+											   partitioned_rels);
+		else
+			path = (Path *) create_append_path(grouped_rel, NIL,
+											   partial_subpaths, NULL,
+											   parallel_workers,
+											   enable_parallel_append,
+											   partitioned_rels);
+		path->pathtarget = child_agg_target;
+		if (!path->parallel_safe)
+			return;
+
+		total_rows = path->rows * path->parallel_workers;
+		path = (Path *) create_gather_path(root, grouped_rel, path,
+										   child_agg_target, NULL,
+										   &total_rows);
+
+		if (full_agg)
+			add_path(grouped_rel, path);
+		else
+			add_finalize_grouping_paths(root, grouped_rel, path, target,
+										&agg_final_costs, can_sort, can_hash,
+										dNumGroups);
+	}
+}
+
+/*
+ * add_child_grouping_paths
+ *
+ * Add sorted and hashed grouping paths over 'path', the input of a single
+ * partition, to child_grouped_rel.  If 'partial' is true, 'path' is a partial
+ * path and the results are added as partial paths.
+ */
+static void
+add_child_grouping_paths(PlannerInfo *root,
+						 RelOptInfo *child_grouped_rel,
+						 Path *path,
+						 PathTarget *target,
+						 AggSplit aggsplit,
+						 List *havingQual,
+						 const AggClauseCosts *agg_costs,
+						 bool can_sort,
+						 bool can_hash,
+						 bool partial)
+{
+	Query	   *parse = root->parse;
+	double		dNumGroups;
+	Path	   *aggpath;
+	bool		added = false;
+
+	dNumGroups = get_number_of_groups(root, path->rows, NULL);
+
+	if (can_sort)
+	{
+		Path	   *sorted_path = path;
+
+		if (!pathkeys_contained_in(root->group_pathkeys, path->pathkeys))
+			sorted_path = (Path *) create_sort_path(root, child_grouped_rel,
+													path,
+													root->group_pathkeys,
+													-1.0);
+
+		if (parse->hasAggs)
+			aggpath = (Path *)
+				create_agg_path(root, child_grouped_rel, sorted_path, target,
+								parse->groupClause ? AGG_SORTED : AGG_PLAIN,
+								aggsplit,
+								parse->groupClause,
+								havingQual,
+								agg_costs,
+								dNumGroups);
+		else
+			aggpath = (Path *)
+				create_group_path(root, child_grouped_rel, sorted_path,
+								  target,
+								  parse->groupClause,
+								  havingQual,
+								  dNumGroups);
+
+		if (partial)
+			add_partial_path(child_grouped_rel, aggpath);
+		else
+			add_path(child_grouped_rel, aggpath);
+		added = true;
+	}
+
+	/*
+	 * As above the Append, only hash if the table fits in work_mem, unless
+	 * sorting isn't possible at all.
+	 */
+	if (can_hash &&
+		(!added ||
+		 estimate_hashagg_tablesize(path, agg_costs,
+									dNumGroups) < work_mem * 1024L))
+	{
+		aggpath = (Path *)
+			create_agg_path(root, child_grouped_rel, path, target,
+							AGG_HASHED,
+							aggsplit,
+							parse->groupClause,
+							havingQual,
+							agg_costs,
+							dNumGroups);
+
+		if (partial)
+			add_partial_path(child_grouped_rel, aggpath);
+		else
+			add_path(child_grouped_rel, aggpath);
+	}
+}
+
+/*
+ * add_finalize_grouping_paths
+ *
+ * Add paths to grouped_rel that combine the partially grouped rows emitted by
+ * 'path' into the final result.
+ */
+static void
+add_finalize_grouping_paths(PlannerInfo *root,
+							RelOptInfo *grouped_rel,
+							Path *path,
+							PathTarget *target,
+							const AggClauseCosts *agg_final_costs,
+							bool can_sort,
+							bool can_hash,
+							double dNumGroups)
+{
+	Query	   *parse = root->parse;
+
+	if (can_sort)
+	{
+		Path	   *sorted_path = path;
+
+		if (!pathkeys_contained_in(root->group_pathkeys, path->pathkeys))
+			sorted_path = (Path *) create_sort_path(root, grouped_rel, path,
+													root->group_pathkeys,
+													-1.0);
+
+		if (parse->hasAggs)
+			add_path(grouped_rel, (Path *)
+					 create_agg_path(root, grouped_rel, sorted_path, target,
+								parse->groupClause ? AGG_SORTED : AGG_PLAIN,
+									 AGGSPLIT_FINAL_DESERIAL,
+									 parse->groupClause,
+									 (List *) parse->havingQual,
+									 agg_final_costs,
+									 dNumGroups));
+		else
+			add_path(grouped_rel, (Path *)
+					 create_group_path(root, grouped_rel, sorted_path, target,
+									   parse->groupClause,
+									   (List *) parse->havingQual,
+									   dNumGroups));
+	}
+
+	if (can_hash &&
+		estimate_hashagg_tablesize(path, agg_final_costs,
+								   dNumGroups) < work_mem * 1024L)
+		add_path(grouped_rel, (Path *)
+				 create_agg_path(root, grouped_rel, path, target,
+								 AGG_HASHED,
+								 AGGSPLIT_FINAL_DESERIAL,
+								 parse->groupClause,
+								 (List *) parse->havingQual,
+								 agg_final_costs,
+								 dNumGroups));
+}
+
+/*
+ * group_by_has_partkey
+ *
+ * Returns true if every partition key of input_rel appears among the GROUP
+ * BY expressions, so that no group can span more than one partition.
+ */
+static bool
+group_by_has_partkey(RelOptInfo *input_rel, List *groupClause,
+					 List *targetList)
+{
+	List	   *groupexprs = get_sortgrouplist_exprs(groupClause, targetList);
+	int			cnt;
+
+	for (cnt = 0; cnt < input_rel->part_scheme->partnatts; cnt++)
+	{
+		List	   *partexprs = input_rel->partexprs[cnt];
+		bool		found = false;
+		ListCell   *lc;
+
+		foreach(lc, partexprs)
+		{
+			Expr	   *partexpr = lfirst(lc);
+
+			if (list_member(groupexprs, partexpr))
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+			return false;
+	}
+
+	return true;
+}
+
 
 /*
  * For a given input path, consider the possible ways of doing grouping sets on
@@ -4543,7 +5136,8 @@ create_window_paths(PlannerInfo *root,
 	if (window_rel->fdwroutine &&
 		window_rel->fdwroutine->GetForeignUpperPaths)
 		window_rel->fdwroutine->GetForeignUpperPaths(root, UPPERREL_WINDOW,
-													 input_rel, window_rel);
+													 input_rel, window_rel,
+													 NULL);
 
 	/* Let extensions possibly add some more paths */
 	if (create_upper_paths_hook)
@@ -4847,7 +5441,8 @@ create_distinct_paths(PlannerInfo *root,
 	if (distinct_rel->fdwroutine &&
 		distinct_rel->fdwroutine->GetForeignUpperPaths)
 		distinct_rel->fdwroutine->GetForeignUpperPaths(root, UPPERREL_DISTINCT,
-													input_rel, distinct_rel);
+													input_rel, distinct_rel,
+													NULL);
 
 	/* Let extensions possibly add some more paths */
 	if (create_upper_paths_hook)
@@ -4908,21 +5503,48 @@ create_ordered_paths(PlannerInfo *root,
 	{
 		Path	   *path = (Path *) lfirst(lc);
 		bool		is_sorted;
+		int			presorted_keys;
 
-		is_sorted = pathkeys_contained_in(root->sort_pathkeys,
-										  path->pathkeys);
+		is_sorted = pathkeys_count_contained_in(root->sort_pathkeys,
+												path->pathkeys,
+												&presorted_keys);
 		if (path == cheapest_input_path || is_sorted)
 		{
+			Path	   *sorted_path = path;
+
 			if (!is_sorted)
 			{
 				/* An explicit sort here can take advantage of LIMIT */
-				path = (Path *) create_sort_path(root,
-												 ordered_rel,
-												 path,
-												 root->sort_pathkeys,
-												 limit_tuples);
+				sorted_path = (Path *) create_sort_path(root,
+														ordered_rel,
+														path,
+														root->sort_pathkeys,
+														limit_tuples);
 			}
 
+			/* Add projection step if needed */
+			if (sorted_path->pathtarget != target)
+				sorted_path = apply_projection_to_path(root, ordered_rel,
+													   sorted_path, target);
+
+			add_path(ordered_rel, sorted_path);
+		}
+
+		/*
+		 * If the path is already sorted by a leading subset of the requested
+		 * keys, an incremental sort of it may be cheaper than a full sort of
+		 * the cheapest path, especially when only a few rows are fetched.
+		 * This is worth trying for any such path, not just the cheapest.
+		 */
+		if (enable_incrementalsort && !is_sorted && presorted_keys > 0)
+		{
+			path = (Path *) create_incremental_sort_path(root,
+														 ordered_rel,
+														 path,
+														 root->sort_pathkeys,
+														 presorted_keys,
+														 limit_tuples);
+
 			/* Add projection step if needed */
 			if (path->pathtarget != target)
 				path = apply_projection_to_path(root, ordered_rel,
@@ -4989,7 +5611,8 @@ create_ordered_paths(PlannerInfo *root,
 	if (ordered_rel->fdwroutine &&
 		ordered_rel->fdwroutine->GetForeignUpperPaths)
 		ordered_rel->fdwroutine->GetForeignUpperPaths(root, UPPERREL_ORDERED,
-													  input_rel, ordered_rel);
+													  input_rel, ordered_rel,
+													  NULL);
 
 	/* Let extensions possibly add some more paths */
 	if (create_upper_paths_hook)
@@ -6084,3 +6707,31 @@ get_partitioned_child_rels(PlannerInfo *root, Index rti)
 
 	return result;
 }
+
+/*
+ * get_partitioned_child_rels_for_join
+ *		Build and return a list containing the RTI of every partitioned
+ *		relation which is a child of some rel included in the join.
+ *
+ * A partition-wise join or aggregate scans the partitions of each partitioned
+ * table in the join, so all of them need to be locked at execution.
+ */
+List *
+get_partitioned_child_rels_for_join(PlannerInfo *root, Relids join_relids)
+{
+	List	   *result = NIL;
+	int			relid = -1;
+
+	while ((relid = bms_next_member(join_relids, relid)) >= 0)
+	{
+		RangeTblEntry *rte = planner_rt_fetch(relid, root);
+
+		if (rte->rtekind == RTE_RELATION && rte->inh &&
+			rte->relkind == RELKIND_PARTITIONED_TABLE)
+			result = list_concat(result,
+								 list_copy(get_partitioned_child_rels(root,
+																	  relid)));
+	}
+
+	return result;
+}
@@ -302,6 +302,13 @@ recurse_set_operations(Node *setOp, PlannerInfo *root,
 		 * set_subquery_pathlist).
 		 */
 		final_rel = fetch_upper_rel(subroot, UPPERREL_FINAL, NULL);
+
+		/*
+		 * The subquery scan can run in a parallel worker if the subquery
+		 * itself could; this lets a UNION ALL above use Parallel Append.
+		 */
+		rel->consider_parallel = final_rel->consider_parallel;
+
 		subpath = get_cheapest_fractional_path(final_rel,
 											   root->tuple_fraction);
 
@@ -522,6 +529,7 @@ generate_union_path(SetOperationStmt *op, PlannerInfo *root,
 	List	   *tlist_list;
 	List	   *tlist;
 	Path	   *path;
+	ListCell   *lc;
 
 	/*
 	 * If plain UNION, tell children to fetch all tuples.
@@ -563,14 +571,58 @@ generate_union_path(SetOperationStmt *op, PlannerInfo *root,
 
 	*pTargetList = tlist;
 
+	/*
+	 * The Append can run in parallel workers if all of its children can.
+	 */
+	result_rel->consider_parallel = true;
+	foreach(lc, pathlist)
+	{
+		Path	   *subpath = (Path *) lfirst(lc);
+
+		if (!subpath->parallel_safe)
+		{
+			result_rel->consider_parallel = false;
+			break;
+		}
+	}
+
 	/*
 	 * Append the child results together.
 	 */
-	path = (Path *) create_append_path(result_rel, pathlist, NULL, 0, NIL);
+	path = (Path *) create_append_path(result_rel, pathlist, NIL,
+									   NULL, 0, false, NIL);
 
 	/* We have to manually jam the right tlist into the path; ick */
 	path->pathtarget = create_pathtarget(root, tlist);
 
+	/*
+	 * If the branches are all parallel-safe, also consider running them
+	 * under a Parallel Append, so that separate workers execute separate
+	 * branches at the same time, and keep whichever is cheaper.  The
+	 * branches' paths are not partial, so each of them is run whole by a
+	 * single participant.
+	 */
+	if (result_rel->consider_parallel && enable_parallel_append &&
+		max_parallel_workers_per_gather > 0 && list_length(pathlist) > 1)
+	{
+		Path	   *ppath;
+		int			parallel_workers;
+
+		parallel_workers = Min(fls(list_length(pathlist)),
+							   max_parallel_workers_per_gather);
+
+		ppath = (Path *) create_append_path(result_rel, pathlist, NIL,
+											NULL, parallel_workers, true,
+											NIL);
+		ppath->pathtarget = create_pathtarget(root, tlist);
+		ppath = (Path *) create_gather_path(root, result_rel, ppath,
+											ppath->pathtarget, NULL,
+											&path->rows);
+
+		if (compare_path_costs(ppath, path, TOTAL_COST) < 0)
+			path = ppath;
+	}
+
 	/*
 	 * For UNION ALL, we just need the Append path.  For UNION, need to add
 	 * node(s) to remove duplicates.
@@ -678,7 +730,8 @@ generate_nonunion_path(SetOperationStmt *op, PlannerInfo *root,
 	/*
 	 * Append the child results together.
 	 */
-	path = (Path *) create_append_path(result_rel, pathlist, NULL, 0, NIL);
+	path = (Path *) create_append_path(result_rel, pathlist, NIL,
+									   NULL, 0, false, NIL);
 
 	/* We have to manually jam the right tlist into the path; ick */
 	path->pathtarget = create_pathtarget(root, tlist);
@@ -2128,19 +2181,119 @@ adjust_inherited_tlist(List *tlist, AppendRelInfo *context)
 	return new_tlist;
 }
 
+/*
+ * adjust_appendrel_attrs_list
+ *	  Apply the translations of several AppendRelInfos to the given
+ *	  expression, as needed for the targetlists and clauses of a child join.
+ *
+ * The AppendRelInfos must all have distinct parents, so that the order in
+ * which they are applied doesn't matter.
+ */
+Node *
+adjust_appendrel_attrs_list(PlannerInfo *root, Node *node, List *appinfos)
+{
+	ListCell   *lc;
+
+	foreach(lc, appinfos)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
+
+		node = adjust_appendrel_attrs(root, node, appinfo);
+	}
+
+	return node;
+}
+
+/*
+ * adjust_child_relids
+ *	  Replace any parent relids in the given set by the corresponding child
+ *	  relids from the given AppendRelInfos.
+ *
+ * The result is a fresh copy if anything had to change.
+ */
+Relids
+adjust_child_relids(Relids relids, List *appinfos)
+{
+	ListCell   *lc;
+
+	foreach(lc, appinfos)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
+
+		relids = adjust_relid_set(relids, appinfo->parent_relid,
+								  appinfo->child_relid);
+	}
+
+	return relids;
+}
+
+/*
+ * find_appinfos_by_relids
+ *	  Find the AppendRelInfos for all the members of the given relid set that
+ *	  are appendrel children.
+ */
+List *
+find_appinfos_by_relids(PlannerInfo *root, Relids relids)
+{
+	List	   *appinfos = NIL;
+	int			relid = -1;
+
+	while ((relid = bms_next_member(relids, relid)) >= 0)
+	{
+		ListCell   *lc;
+
+		foreach(lc, root->append_rel_list)
+		{
+			AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
+
+			if (appinfo->child_relid == relid)
+			{
+				appinfos = lappend(appinfos, appinfo);
+				break;
+			}
+		}
+	}
+
+	return appinfos;
+}
+
 /*
  * adjust_appendrel_attrs_multilevel
  *	  Apply Var translations from a toplevel appendrel parent down to a child.
  *
  * In some cases we need to translate expressions referencing a baserel
  * to reference an appendrel child that's multiple levels removed from it.
+ * child_rel may also be a child join, see try_partition_wise_join.
  */
 Node *
 adjust_appendrel_attrs_multilevel(PlannerInfo *root, Node *node,
 								  RelOptInfo *child_rel)
 {
-	AppendRelInfo *appinfo = find_childrel_appendrelinfo(root, child_rel);
-	RelOptInfo *parent_rel = find_base_rel(root, appinfo->parent_relid);
+	AppendRelInfo *appinfo;
+	RelOptInfo *parent_rel;
+
+	/*
+	 * A child join is translated by translating for each of its member
+	 * relations that is an appendrel child.  Their Vars are disjoint, so the
+	 * order doesn't matter.
+	 */
+	if (child_rel->reloptkind == RELOPT_OTHER_JOINREL)
+	{
+		int			relid = -1;
+
+		while ((relid = bms_next_member(child_rel->relids, relid)) >= 0)
+		{
+			RelOptInfo *member_rel = find_base_rel(root, relid);
+
+			if (member_rel->reloptkind == RELOPT_OTHER_MEMBER_REL)
+				node = adjust_appendrel_attrs_multilevel(root, node,
+														 member_rel);
+		}
+		return node;
+	}
+
+	appinfo = find_childrel_appendrelinfo(root, child_rel);
+	parent_rel = find_base_rel(root, appinfo->parent_relid);
 
 	/* If parent is also a child, first recurse to apply its translations */
 	if (IS_OTHER_REL(parent_rel))
@@ -1087,6 +1087,24 @@ is_parallel_safe(PlannerInfo *root, Node *node)
 	return !max_parallel_hazard_walker(node, &context);
 }
 
+/*
+ * is_parallel_safe_expr
+ *		Detect whether a standalone expression, such as a column default or
+ *		a check constraint, contains only parallel-safe constructs
+ *
+ * This is for use outside the planner, by callers that want to evaluate the
+ * expression in parallel workers.
+ */
+bool
+is_parallel_safe_expr(Node *node)
+{
+	max_parallel_hazard_context context;
+
+	context.max_hazard = PROPARALLEL_SAFE;
+	context.max_interesting = PROPARALLEL_RESTRICTED;
+	return !max_parallel_hazard_walker(node, &context);
+}
+
 /* core logic for all parallel-hazard checks */
 static bool
 max_parallel_hazard_test(char proparallel, max_parallel_hazard_context *context)
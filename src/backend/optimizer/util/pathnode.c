@@ -1045,12 +1045,49 @@ create_index_path(PlannerInfo *root,
 	pathnode->indexorderbys = indexorderbys;
 	pathnode->indexorderbycols = indexorderbycols;
 	pathnode->indexscandir = indexscandir;
+	pathnode->indexskip = false;
+	pathnode->indexdistinct = false;
 
 	cost_index(pathnode, root, loop_count, partial_path);
 
 	return pathnode;
 }
 
+/*
+ * create_index_skip_path
+ *	  Creates a skip scan variant of an existing index path.
+ *
+ * 'ipath' is a non-parallel forward scan path on an index whose AM supports
+ * amskip.  If 'distinct' is true, the scan returns only the first matching
+ * tuple for each distinct value of the leading index column, so the result
+ * is ordered by that column alone.
+ *
+ * As in reparameterize_path, we flat-copy the path node rather than
+ * recomputing its indexquals, and just redo the cost estimate.
+ */
+IndexPath *
+create_index_skip_path(PlannerInfo *root,
+					   IndexPath *ipath,
+					   bool distinct,
+					   double loop_count)
+{
+	IndexPath  *pathnode = makeNode(IndexPath);
+
+	Assert(ipath->indexinfo->amcanskip);
+	Assert(ScanDirectionIsForward(ipath->indexscandir));
+	Assert(!ipath->path.parallel_aware);
+
+	memcpy(pathnode, ipath, sizeof(IndexPath));
+	pathnode->indexskip = true;
+	pathnode->indexdistinct = distinct;
+	if (distinct && list_length(pathnode->path.pathkeys) > 1)
+		pathnode->path.pathkeys = list_make1(linitial(ipath->path.pathkeys));
+
+	cost_index(pathnode, root, loop_count, false);
+
+	return pathnode;
+}
+
 /*
  * create_bitmap_heap_path
  *	  Creates a path node for a bitmap scan.
@@ -1192,53 +1229,117 @@ create_tidscan_path(PlannerInfo *root, RelOptInfo *rel, List *tidquals,
 	return pathnode;
 }
 
+/* Array element used by sort_append_subpaths */
+typedef struct AppendSubpathSortItem
+{
+	Path	   *path;
+	int			position;		/* position in the input list */
+} AppendSubpathSortItem;
+
+/*
+ * append_subpath_cmp
+ *	  qsort comparator for sort_append_subpaths: descending total cost,
+ *	  keeping the original order among equally expensive subpaths.
+ */
+static int
+append_subpath_cmp(const void *a, const void *b)
+{
+	const AppendSubpathSortItem *ia = (const AppendSubpathSortItem *) a;
+	const AppendSubpathSortItem *ib = (const AppendSubpathSortItem *) b;
+	int			cmp;
+
+	cmp = compare_path_costs(ib->path, ia->path, TOTAL_COST);
+	if (cmp != 0)
+		return cmp;
+	return (ia->position > ib->position) - (ia->position < ib->position);
+}
+
+/*
+ * sort_append_subpaths
+ *	  Return a copy of the list of subpaths sorted by descending total cost.
+ */
+static List *
+sort_append_subpaths(List *subpaths)
+{
+	AppendSubpathSortItem *items;
+	List	   *result = NIL;
+	int			nitems = list_length(subpaths);
+	ListCell   *l;
+	int			i;
+
+	if (nitems < 2)
+		return list_copy(subpaths);
+
+	items = (AppendSubpathSortItem *)
+		palloc(nitems * sizeof(AppendSubpathSortItem));
+	i = 0;
+	foreach(l, subpaths)
+	{
+		items[i].path = (Path *) lfirst(l);
+		items[i].position = i;
+		i++;
+	}
+
+	qsort(items, nitems, sizeof(AppendSubpathSortItem), append_subpath_cmp);
+
+	for (i = 0; i < nitems; i++)
+		result = lappend(result, items[i].path);
+
+	pfree(items);
+
+	return result;
+}
+
 /*
  * create_append_path
  *	  Creates a path corresponding to an Append plan, returning the
  *	  pathnode.
  *
+ * 'subpaths' are run to completion by a single participant each, while
+ * 'partial_subpaths' are partial paths whose participants share the work.
+ * The latter may only be given for a partial Append.  A parallel-aware
+ * Append hands out its subpaths to the participants dynamically; for it we
+ * put the subpaths in descending cost order so that the expensive ones are
+ * started first.
+ *
  * Note that we must handle subpaths = NIL, representing a dummy access path.
  */
 AppendPath *
-create_append_path(RelOptInfo *rel, List *subpaths, Relids required_outer,
-				   int parallel_workers, List *partitioned_rels)
+create_append_path(RelOptInfo *rel,
+				   List *subpaths, List *partial_subpaths,
+				   Relids required_outer,
+				   int parallel_workers, bool parallel_aware,
+				   List *partitioned_rels)
 {
 	AppendPath *pathnode = makeNode(AppendPath);
 	ListCell   *l;
 
+	Assert(!parallel_aware || parallel_workers > 0);
+
 	pathnode->path.pathtype = T_Append;
 	pathnode->path.parent = rel;
 	pathnode->path.pathtarget = rel->reltarget;
 	pathnode->path.param_info = get_appendrel_parampathinfo(rel,
 															required_outer);
-	pathnode->path.parallel_aware = false;
+	pathnode->path.parallel_aware = parallel_aware;
 	pathnode->path.parallel_safe = rel->consider_parallel;
 	pathnode->path.parallel_workers = parallel_workers;
 	pathnode->path.pathkeys = NIL;		/* result is always considered
 										 * unsorted */
 	pathnode->partitioned_rels = partitioned_rels;
-	pathnode->subpaths = subpaths;
 
-	/*
-	 * We don't bother with inventing a cost_append(), but just do it here.
-	 *
-	 * Compute rows and costs as sums of subplan rows and costs.  We charge
-	 * nothing extra for the Append itself, which perhaps is too optimistic,
-	 * but since it doesn't do any selection or projection, it is a pretty
-	 * cheap node.
-	 */
-	pathnode->path.rows = 0;
-	pathnode->path.startup_cost = 0;
-	pathnode->path.total_cost = 0;
-	foreach(l, subpaths)
+	if (parallel_aware)
 	{
-		Path	   *subpath = (Path *) lfirst(l);
+		subpaths = sort_append_subpaths(subpaths);
+		partial_subpaths = sort_append_subpaths(partial_subpaths);
+	}
+	pathnode->first_partial_path = list_length(subpaths);
+	pathnode->subpaths = list_concat(subpaths, partial_subpaths);
 
-		pathnode->path.rows += subpath->rows;
+	foreach(l, pathnode->subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(l);
 
-		if (l == list_head(subpaths))	/* first node? */
-			pathnode->path.startup_cost = subpath->startup_cost;
-		pathnode->path.total_cost += subpath->total_cost;
 		pathnode->path.parallel_safe = pathnode->path.parallel_safe &&
 			subpath->parallel_safe;
 
@@ -1246,6 +1347,10 @@ create_append_path(RelOptInfo *rel, List *subpaths, Relids required_outer,
 		Assert(bms_equal(PATH_REQ_OUTER(subpath), required_outer));
 	}
 
+	Assert(!parallel_aware || pathnode->path.parallel_safe);
+
+	cost_append(pathnode);
+
 	return pathnode;
 }
 
@@ -1413,6 +1518,58 @@ create_material_path(RelOptInfo *rel, Path *subpath)
 	return pathnode;
 }
 
+/*
+ * create_memoize_path
+ *	  Creates a path corresponding to a Memoize plan, returning the pathnode.
+ *
+ * 'param_exprs' are the cache keys, with 'hash_operators' to compare them,
+ * or compared by binary image if 'binary_mode' is true.
+ * 'calls' is the number of times we expect the node to be scanned.
+ */
+MemoizePath *
+create_memoize_path(PlannerInfo *root, RelOptInfo *rel, Path *subpath,
+					List *param_exprs, List *hash_operators,
+					bool singlerow, bool binary_mode, double calls)
+{
+	MemoizePath *pathnode = makeNode(MemoizePath);
+
+	Assert(subpath->parent == rel);
+
+	pathnode->path.pathtype = T_Memoize;
+	pathnode->path.parent = rel;
+	pathnode->path.pathtarget = rel->reltarget;
+	pathnode->path.param_info = subpath->param_info;
+	pathnode->path.parallel_aware = false;
+	pathnode->path.parallel_safe = rel->consider_parallel &&
+		subpath->parallel_safe;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	pathnode->path.pathkeys = subpath->pathkeys;
+
+	pathnode->subpath = subpath;
+	pathnode->hash_operators = hash_operators;
+	pathnode->param_exprs = param_exprs;
+	pathnode->singlerow = singlerow;
+	pathnode->binary_mode = binary_mode;
+	pathnode->calls = calls;
+
+	/*
+	 * cost_memoize_rescan() works out how many cache entries there are
+	 * likely to be, and sets est_entries accordingly.  If it's left at 0,
+	 * the executor makes its own guess.
+	 */
+	pathnode->est_entries = 0;
+
+	/*
+	 * Add a small additional charge for caching the first entry.  All the
+	 * harder calculations for rescans are performed in cost_memoize_rescan().
+	 */
+	pathnode->path.startup_cost = subpath->startup_cost + cpu_tuple_cost;
+	pathnode->path.total_cost = subpath->total_cost + cpu_tuple_cost;
+	pathnode->path.rows = subpath->rows;
+
+	return pathnode;
+}
+
 /*
  * create_unique_path
  *	  Creates a path representing elimination of distinct rows from the
@@ -2542,6 +2699,57 @@ create_sort_path(PlannerInfo *root,
 	return pathnode;
 }
 
+/*
+ * create_incremental_sort_path
+ *	  Creates a pathnode that represents performing an incremental sort,
+ *	  that is, sorting input that is already sorted by a prefix of the
+ *	  desired sort order.
+ *
+ * 'rel' is the parent relation associated with the result
+ * 'subpath' is the path representing the source of data
+ * 'pathkeys' represents the desired sort order
+ * 'presorted_keys' is the number of leading pathkeys that subpath is
+ *		already sorted by
+ * 'limit_tuples' is the estimated bound on the number of output tuples,
+ *		or -1 if no LIMIT or couldn't estimate
+ */
+IncrementalSortPath *
+create_incremental_sort_path(PlannerInfo *root,
+							 RelOptInfo *rel,
+							 Path *subpath,
+							 List *pathkeys,
+							 int presorted_keys,
+							 double limit_tuples)
+{
+	IncrementalSortPath *sort = makeNode(IncrementalSortPath);
+	SortPath   *pathnode = &sort->spath;
+
+	pathnode->path.pathtype = T_IncrementalSort;
+	pathnode->path.parent = rel;
+	/* Sort doesn't project, so use source path's pathtarget */
+	pathnode->path.pathtarget = subpath->pathtarget;
+	/* For now, assume we are above any joins, so no parameterization */
+	pathnode->path.param_info = NULL;
+	pathnode->path.parallel_aware = false;
+	pathnode->path.parallel_safe = rel->consider_parallel &&
+		subpath->parallel_safe;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	pathnode->path.pathkeys = pathkeys;
+
+	pathnode->subpath = subpath;
+	sort->nPresortedCols = presorted_keys;
+
+	cost_incremental_sort(&pathnode->path, root, pathkeys, presorted_keys,
+						  subpath->startup_cost,
+						  subpath->total_cost,
+						  subpath->rows,
+						  subpath->pathtarget->width,
+						  0.0,
+						  work_mem, limit_tuples);
+
+	return sort;
+}
+
 /*
  * create_group_path
  *	  Creates a pathnode that represents performing grouping of presorted input
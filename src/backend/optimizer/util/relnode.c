@@ -16,6 +16,8 @@
 
 #include <limits.h>
 
+#include "access/heapam.h"
+#include "catalog/partition.h"
 #include "miscadmin.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
@@ -23,9 +25,11 @@
 #include "optimizer/paths.h"
 #include "optimizer/placeholder.h"
 #include "optimizer/plancat.h"
+#include "optimizer/prep.h"
 #include "optimizer/restrictinfo.h"
 #include "optimizer/tlist.h"
 #include "utils/hsearch.h"
+#include "utils/rel.h"
 
 
 typedef struct JoinHashEntry
@@ -52,6 +56,8 @@ static List *subbuild_joinrel_joinlist(RelOptInfo *joinrel,
 static void set_foreign_rel_properties(RelOptInfo *joinrel,
 						   RelOptInfo *outer_rel, RelOptInfo *inner_rel);
 static void add_join_rel(PlannerInfo *root, RelOptInfo *joinrel);
+static void set_base_rel_partitions(PlannerInfo *root, RelOptInfo *rel,
+						RangeTblEntry *rte);
 
 
 /*
@@ -143,6 +149,11 @@ build_simple_rel(PlannerInfo *root, int relid, RelOptInfo *parent)
 	rel->baserestrict_min_security = UINT_MAX;
 	rel->joininfo = NIL;
 	rel->has_eclass_joins = false;
+	rel->part_scheme = NULL;
+	rel->nparts = 0;
+	rel->boundinfo = NULL;
+	rel->part_rels = NULL;
+	rel->partexprs = NULL;
 
 	/*
 	 * Pass top parent's relids down the inheritance hierarchy. If the parent
@@ -227,11 +238,75 @@ build_simple_rel(PlannerInfo *root, int relid, RelOptInfo *parent)
 			(void) build_simple_rel(root, appinfo->child_relid,
 									rel);
 		}
+
+		/* Now that the partitions exist, record them in bound order */
+		if (rel->part_scheme)
+			set_base_rel_partitions(root, rel, rte);
 	}
 
 	return rel;
 }
 
+/*
+ * set_base_rel_partitions
+ *	  Fill in part_rels[] of a partitioned base relation, whose "other rel"
+ *	  RelOptInfos have just been built.
+ *
+ * part_rels[] is indexed the same way as the partition descriptor, that is
+ * in order of the partition bounds.  If some partition has no RelOptInfo of
+ * its own (a partitioned partition, whose leaves have been flattened into
+ * the parent by expand_inherited_rtentry), we can't describe the relation
+ * partition-wise, so we forget that it is partitioned.
+ */
+static void
+set_base_rel_partitions(PlannerInfo *root, RelOptInfo *rel,
+						RangeTblEntry *rte)
+{
+	Relation	relation;
+	PartitionDesc partdesc;
+	ListCell   *l;
+	int			i;
+
+	/* Assume we already have adequate lock */
+	relation = heap_open(rte->relid, NoLock);
+	partdesc = RelationGetPartitionDesc(relation);
+	Assert(partdesc->nparts == rel->nparts);
+
+	foreach(l, root->append_rel_list)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(l);
+		RangeTblEntry *childrte;
+
+		if (appinfo->parent_relid != rel->relid)
+			continue;
+
+		childrte = root->simple_rte_array[appinfo->child_relid];
+		for (i = 0; i < partdesc->nparts; i++)
+		{
+			if (partdesc->oids[i] == childrte->relid)
+			{
+				rel->part_rels[i] = root->simple_rel_array[appinfo->child_relid];
+				break;
+			}
+		}
+	}
+
+	heap_close(relation, NoLock);
+
+	for (i = 0; i < rel->nparts; i++)
+	{
+		if (rel->part_rels[i] == NULL)
+		{
+			rel->part_scheme = NULL;
+			rel->nparts = 0;
+			rel->boundinfo = NULL;
+			rel->part_rels = NULL;
+			rel->partexprs = NULL;
+			break;
+		}
+	}
+}
+
 /*
  * find_base_rel
  *	  Find a base or other relation entry, which must already exist.
@@ -521,6 +596,11 @@ build_join_rel(PlannerInfo *root,
 	joinrel->joininfo = NIL;
 	joinrel->has_eclass_joins = false;
 	joinrel->top_parent_relids = NULL;
+	joinrel->part_scheme = NULL;
+	joinrel->nparts = 0;
+	joinrel->boundinfo = NULL;
+	joinrel->part_rels = NULL;
+	joinrel->partexprs = NULL;
 
 	/* Compute information relevant to the foreign relations. */
 	set_foreign_rel_properties(joinrel, outer_rel, inner_rel);
@@ -611,6 +691,122 @@ build_join_rel(PlannerInfo *root,
 	return joinrel;
 }
 
+/*
+ * build_child_join_rel
+ *	  Builds RelOptInfo representing join between given two child relations.
+ *
+ * 'outer_rel' and 'inner_rel' are the RelOptInfos of child relations being
+ *		joined
+ * 'parent_joinrel' is the RelOptInfo representing the join between parent
+ *		relations. Some of the members of new RelOptInfo are produced by
+ *		translating corresponding members of this RelOptInfo
+ * 'restrictlist': list of RestrictInfo nodes that apply to this particular
+ *		pair of joinable relations, already translated for the children
+ * 'sjinfo': child-join context info, already translated for the children
+ * 'jointype' is the join type (inner, left, full, etc)
+ * 'appinfos' are the AppendRelInfos for all the children in the join
+ *
+ * Unlike build_join_rel, this doesn't look for an existing RelOptInfo; the
+ * caller keeps child joins in the parent's part_rels[] instead.  Nor is the
+ * child join added to root->join_rel_level, since the join search never
+ * considers it on its own.
+ */
+RelOptInfo *
+build_child_join_rel(PlannerInfo *root, RelOptInfo *outer_rel,
+					 RelOptInfo *inner_rel, RelOptInfo *parent_joinrel,
+					 List *restrictlist, SpecialJoinInfo *sjinfo,
+					 JoinType jointype, List *appinfos)
+{
+	RelOptInfo *joinrel = makeNode(RelOptInfo);
+
+	joinrel->reloptkind = RELOPT_OTHER_JOINREL;
+	joinrel->relids = bms_union(outer_rel->relids, inner_rel->relids);
+	joinrel->rows = 0;
+	/* cheap startup cost is interesting iff not all tuples to be retrieved */
+	joinrel->consider_startup = (root->tuple_fraction > 0);
+	joinrel->consider_param_startup = false;
+	joinrel->consider_parallel = false;
+	joinrel->reltarget = create_empty_pathtarget();
+	joinrel->pathlist = NIL;
+	joinrel->ppilist = NIL;
+	joinrel->partial_pathlist = NIL;
+	joinrel->cheapest_startup_path = NULL;
+	joinrel->cheapest_total_path = NULL;
+	joinrel->cheapest_unique_path = NULL;
+	joinrel->cheapest_parameterized_paths = NIL;
+	joinrel->direct_lateral_relids = NULL;
+	joinrel->lateral_relids = NULL;
+	joinrel->relid = 0;			/* indicates not a baserel */
+	joinrel->rtekind = RTE_JOIN;
+	joinrel->min_attr = 0;
+	joinrel->max_attr = 0;
+	joinrel->attr_needed = NULL;
+	joinrel->attr_widths = NULL;
+	joinrel->lateral_vars = NIL;
+	joinrel->lateral_referencers = NULL;
+	joinrel->indexlist = NIL;
+	joinrel->pages = 0;
+	joinrel->tuples = 0;
+	joinrel->allvisfrac = 0;
+	joinrel->subroot = NULL;
+	joinrel->subplan_params = NIL;
+	joinrel->rel_parallel_workers = -1;
+	joinrel->serverid = InvalidOid;
+	joinrel->userid = InvalidOid;
+	joinrel->useridiscurrent = false;
+	joinrel->fdwroutine = NULL;
+	joinrel->fdw_private = NULL;
+	joinrel->baserestrictinfo = NIL;
+	joinrel->baserestrictcost.startup = 0;
+	joinrel->baserestrictcost.per_tuple = 0;
+	joinrel->baserestrict_min_security = UINT_MAX;
+	joinrel->joininfo = NIL;
+	joinrel->has_eclass_joins = false;
+	joinrel->part_scheme = NULL;
+	joinrel->nparts = 0;
+	joinrel->boundinfo = NULL;
+	joinrel->part_rels = NULL;
+	joinrel->partexprs = NULL;
+
+	/* A child join descends from the union of its inputs' top parents */
+	joinrel->top_parent_relids = bms_union(outer_rel->top_parent_relids,
+										   inner_rel->top_parent_relids);
+
+	/*
+	 * Translate the parent's targetlist.  The cost and width stay the same,
+	 * since the child's columns are the same as the parent's.
+	 */
+	joinrel->reltarget->exprs = (List *)
+		adjust_appendrel_attrs_list(root,
+									(Node *) parent_joinrel->reltarget->exprs,
+									appinfos);
+	joinrel->reltarget->cost.startup = parent_joinrel->reltarget->cost.startup;
+	joinrel->reltarget->cost.per_tuple = parent_joinrel->reltarget->cost.per_tuple;
+	joinrel->reltarget->width = parent_joinrel->reltarget->width;
+
+	/* Child joins get the same pending-EC treatment as their parent */
+	joinrel->has_eclass_joins = parent_joinrel->has_eclass_joins;
+
+	/* Set estimates of the child-joinrel's size. */
+	set_joinrel_size_estimates(root, joinrel, outer_rel, inner_rel,
+							   sjinfo, restrictlist);
+
+	/*
+	 * We can't deduce the consider_parallel flag from the children alone,
+	 * since the translated quals and targetlist are the parent's in disguise;
+	 * just copy the parent's decision.
+	 */
+	joinrel->consider_parallel = parent_joinrel->consider_parallel;
+
+	/*
+	 * Add the joinrel to the PlannerInfo, so that find_join_rel can find it
+	 * by its relids.
+	 */
+	add_join_rel(root, joinrel);
+
+	return joinrel;
+}
+
 /*
  * min_join_parameterization
  *
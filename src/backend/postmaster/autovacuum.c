@@ -92,7 +92,6 @@
 #include "storage/procsignal.h"
 #include "storage/sinvaladt.h"
 #include "tcop/tcopprot.h"
-#include "utils/dsa.h"
 #include "utils/fmgroids.h"
 #include "utils/fmgrprotos.h"
 #include "utils/lsyscache.h"
@@ -244,6 +243,25 @@ typedef enum
 	AutoVacNumSignals			/* must be last */
 }	AutoVacuumSignal;
 
+/*
+ * Autovacuum workitem array, stored in AutoVacuumShmem->av_workItems.  This
+ * list is mostly protected by AutovacuumLock, except that if an item is
+ * marked 'active' other processes must not modify the work-identifying
+ * members.  The array lives in the main autovacuum shmem struct, so that
+ * backends can queue requests even before the launcher has started.
+ */
+typedef struct AutoVacuumWorkItem
+{
+	AutoVacuumWorkItemType avw_type;
+	bool		avw_used;		/* below data is valid */
+	bool		avw_active;		/* being processed */
+	Oid			avw_database;
+	Oid			avw_relation;
+	BlockNumber avw_blockNumber;
+} AutoVacuumWorkItem;
+
+#define NUM_WORKITEMS	256
+
 /*-------------
  * The main autovacuum shmem struct.  On shared memory we store this main
  * struct and the array of WorkerInfo structs.  This struct keeps:
@@ -254,10 +272,10 @@ typedef enum
  * av_runningWorkers the WorkerInfo non-free queue
  * av_startingWorker pointer to WorkerInfo currently being started (cleared by
  *					the worker itself as soon as it's up and running)
- * av_dsa_handle	handle for allocatable shared memory
+ * av_workItems		work item array
  *
  * This struct is protected by AutovacuumLock, except for av_signal and parts
- * of the worker list (see above).  av_dsa_handle is readable unlocked.
+ * of the worker list (see above).
  *-------------
  */
 typedef struct
@@ -267,8 +285,7 @@ typedef struct
 	dlist_head	av_freeWorkers;
 	dlist_head	av_runningWorkers;
 	WorkerInfo	av_startingWorker;
-	dsa_handle	av_dsa_handle;
-	dsa_pointer av_workitems;
+	AutoVacuumWorkItem av_workItems[NUM_WORKITEMS];
 } AutoVacuumShmemStruct;
 
 static AutoVacuumShmemStruct *AutoVacuumShmem;
@@ -283,32 +300,6 @@ static MemoryContext DatabaseListCxt = NULL;
 /* Pointer to my own WorkerInfo, valid on each worker */
 static WorkerInfo MyWorkerInfo = NULL;
 
-/*
- * Autovacuum workitem array, stored in AutoVacuumShmem->av_workitems.  This
- * list is mostly protected by AutovacuumLock, except that if it's marked
- * 'active' other processes must not modify the work-identifying members,
- * though changing the list pointers is okay.
- */
-typedef struct AutoVacuumWorkItem
-{
-	AutoVacuumWorkItemType avw_type;
-	Oid			avw_database;
-	Oid			avw_relation;
-	BlockNumber avw_blockNumber;
-	bool		avw_active;
-	dsa_pointer avw_next;		/* doubly linked list pointers */
-	dsa_pointer avw_prev;
-} AutoVacuumWorkItem;
-
-#define NUM_WORKITEMS	256
-typedef struct
-{
-	dsa_pointer avs_usedItems;
-	dsa_pointer avs_freeItems;
-} AutovacWorkItems;
-
-static dsa_area *AutoVacuumDSA = NULL;
-
 /* PID of launcher, valid only in worker while shutting down */
 int			AutovacuumLauncherPid = 0;
 
@@ -344,9 +335,6 @@ static void autovacuum_do_vac_analyze(autovac_table *tab,
 						  BufferAccessStrategy bstrategy);
 static AutoVacOpts *extract_autovac_opts(HeapTuple tup,
 					 TupleDesc pg_class_desc);
-static PgStat_StatTabEntry *get_pgstat_tabentry_relid(Oid relid, bool isshared,
-						  PgStat_StatDBEntry *shared,
-						  PgStat_StatDBEntry *dbentry);
 static void perform_work_item(AutoVacuumWorkItem *workitem);
 static void autovac_report_activity(autovac_table *tab);
 static void autovac_report_workitem(AutoVacuumWorkItem *workitem,
@@ -355,8 +343,6 @@ static void av_sighup_handler(SIGNAL_ARGS);
 static void avl_sigusr2_handler(SIGNAL_ARGS);
 static void avl_sigterm_handler(SIGNAL_ARGS);
 static void autovac_refresh_stats(void);
-static void remove_wi_from_list(dsa_pointer *list, dsa_pointer wi_ptr);
-static void add_wi_to_list(dsa_pointer *list, dsa_pointer wi_ptr);
 
 
 
@@ -610,28 +596,6 @@ AutoVacLauncherMain(int argc, char *argv[])
 	 */
 	rebuild_database_list(InvalidOid);
 
-	/*
-	 * Set up our DSA so that backends can install work-item requests.  It may
-	 * already exist as created by a previous launcher.
-	 */
-	if (!AutoVacuumShmem->av_dsa_handle)
-	{
-		LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
-		AutoVacuumDSA = dsa_create(AutovacuumLock->tranche);
-		/* make sure it doesn't go away even if we do */
-		dsa_pin(AutoVacuumDSA);
-		dsa_pin_mapping(AutoVacuumDSA);
-		AutoVacuumShmem->av_dsa_handle = dsa_get_handle(AutoVacuumDSA);
-		/* delay array allocation until first request */
-		AutoVacuumShmem->av_workitems = InvalidDsaPointer;
-		LWLockRelease(AutovacuumLock);
-	}
-	else
-	{
-		AutoVacuumDSA = dsa_attach(AutoVacuumShmem->av_dsa_handle);
-		dsa_pin_mapping(AutoVacuumDSA);
-	}
-
 	/* loop until shutdown request */
 	while (!got_SIGTERM)
 	{
@@ -1675,14 +1639,6 @@ AutoVacWorkerMain(int argc, char *argv[])
 	{
 		char		dbname[NAMEDATALEN];
 
-		if (AutoVacuumShmem->av_dsa_handle)
-		{
-			/* First use of DSA in this worker, so attach to it */
-			Assert(!AutoVacuumDSA);
-			AutoVacuumDSA = dsa_attach(AutoVacuumShmem->av_dsa_handle);
-			dsa_pin_mapping(AutoVacuumDSA);
-		}
-
 		/*
 		 * Report autovac startup to the stats collector.  We deliberately do
 		 * this before InitPostgres, so that the last_autovac_time will get
@@ -1957,14 +1913,13 @@ do_autovacuum(void)
 	HASHCTL		ctl;
 	HTAB	   *table_toast_map;
 	ListCell   *volatile cell;
-	PgStat_StatDBEntry *shared;
-	PgStat_StatDBEntry *dbentry;
 	BufferAccessStrategy bstrategy;
 	ScanKeyData key;
 	TupleDesc	pg_class_desc;
 	int			effective_multixact_freeze_max_age;
 	bool		did_vacuum = false;
 	bool		found_concurrent_worker = false;
+	int			i;
 
 	/*
 	 * StartTransactionCommand and CommitTransactionCommand will automatically
@@ -1976,12 +1931,6 @@ do_autovacuum(void)
 										  ALLOCSET_DEFAULT_SIZES);
 	MemoryContextSwitchTo(AutovacMemCxt);
 
-	/*
-	 * may be NULL if we couldn't find an entry (only happens if we are
-	 * forcing a vacuum for anti-wrap purposes).
-	 */
-	dbentry = pgstat_fetch_stat_dbentry(MyDatabaseId);
-
 	/* Start a transaction so our commands have one to play into. */
 	StartTransactionCommand();
 
@@ -2029,9 +1978,6 @@ do_autovacuum(void)
 	/* StartTransactionCommand changed elsewhere */
 	MemoryContextSwitchTo(AutovacMemCxt);
 
-	/* The database hash where pgstat keeps shared relations */
-	shared = pgstat_fetch_stat_dbentry(InvalidOid);
-
 	classRel = heap_open(RelationRelationId, AccessShareLock);
 
 	/* create a copy so we can use it after closing pg_class */
@@ -2112,8 +2058,8 @@ do_autovacuum(void)
 
 		/* Fetch reloptions and the pgstat entry for this table */
 		relopts = extract_autovac_opts(tuple, pg_class_desc);
-		tabentry = get_pgstat_tabentry_relid(relid, classForm->relisshared,
-											 shared, dbentry);
+		tabentry = pgstat_fetch_stat_tabentry_ext(classForm->relisshared,
+												  relid);
 
 		/* Check if it needs vacuum or analyze */
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
@@ -2196,8 +2142,8 @@ do_autovacuum(void)
 		}
 
 		/* Fetch the pgstat entry for this table */
-		tabentry = get_pgstat_tabentry_relid(relid, classForm->relisshared,
-											 shared, dbentry);
+		tabentry = pgstat_fetch_stat_tabentry_ext(classForm->relisshared,
+												  relid);
 
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
@@ -2535,65 +2481,41 @@ deleted:
 	/*
 	 * Perform additional work items, as requested by backends.
 	 */
-	if (AutoVacuumShmem->av_workitems)
+	LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
+	for (i = 0; i < NUM_WORKITEMS; i++)
 	{
-		dsa_pointer wi_ptr;
-		AutovacWorkItems *workitems;
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[i];
 
-		LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
+		if (!workitem->avw_used)
+			continue;
+		if (workitem->avw_active)
+			continue;
+		if (workitem->avw_database != MyDatabaseId)
+			continue;
+
+		/* claim this one, and release lock while performing it */
+		workitem->avw_active = true;
+		LWLockRelease(AutovacuumLock);
+
+		perform_work_item(workitem);
 
 		/*
-		 * Scan the list of pending items, and process the inactive ones in
-		 * our database.
+		 * Check for config changes before acquiring lock for further jobs.
 		 */
-		workitems = (AutovacWorkItems *)
-			dsa_get_address(AutoVacuumDSA, AutoVacuumShmem->av_workitems);
-		wi_ptr = workitems->avs_usedItems;
-
-		while (wi_ptr != InvalidDsaPointer)
+		CHECK_FOR_INTERRUPTS();
+		if (got_SIGHUP)
 		{
-			AutoVacuumWorkItem *workitem;
-
-			workitem = (AutoVacuumWorkItem *)
-				dsa_get_address(AutoVacuumDSA, wi_ptr);
-
-			if (workitem->avw_database == MyDatabaseId && !workitem->avw_active)
-			{
-				dsa_pointer next_ptr;
-
-				/* claim this one */
-				workitem->avw_active = true;
-
-				LWLockRelease(AutovacuumLock);
-
-				perform_work_item(workitem);
-
-				/*
-				 * Check for config changes before acquiring lock for further
-				 * jobs.
-				 */
-				CHECK_FOR_INTERRUPTS();
-				if (got_SIGHUP)
-				{
-					got_SIGHUP = false;
-					ProcessConfigFile(PGC_SIGHUP);
-				}
-
-				LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
-
-				/* Put the array item back for the next user */
-				next_ptr = workitem->avw_next;
-				remove_wi_from_list(&workitems->avs_usedItems, wi_ptr);
-				add_wi_to_list(&workitems->avs_freeItems, wi_ptr);
-				wi_ptr = next_ptr;
-			}
-			else
-				wi_ptr = workitem->avw_next;
+			got_SIGHUP = false;
+			ProcessConfigFile(PGC_SIGHUP);
 		}
 
-		/* all done */
-		LWLockRelease(AutovacuumLock);
+		LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
+
+		/* and mark it done */
+		workitem->avw_active = false;
+		workitem->avw_used = false;
 	}
+	LWLockRelease(AutovacuumLock);
 
 	/*
 	 * We leak table_toast_map here (among other things), but since we're
@@ -2676,6 +2598,10 @@ perform_work_item(AutoVacuumWorkItem *workitem)
 									ObjectIdGetDatum(workitem->avw_relation),
 						   Int64GetDatum((int64) workitem->avw_blockNumber));
 				break;
+			case AVW_GINCleanPendingList:
+				DirectFunctionCall1(gin_clean_pending_list,
+									ObjectIdGetDatum(workitem->avw_relation));
+				break;
 			default:
 				elog(WARNING, "unrecognized work item found: type %d",
 					 workitem->avw_type);
@@ -2751,30 +2677,6 @@ extract_autovac_opts(HeapTuple tup, TupleDesc pg_class_desc)
 	return av;
 }
 
-/*
- * get_pgstat_tabentry_relid
- *
- * Fetch the pgstat entry of a table, either local to a database or shared.
- */
-static PgStat_StatTabEntry *
-get_pgstat_tabentry_relid(Oid relid, bool isshared, PgStat_StatDBEntry *shared,
-						  PgStat_StatDBEntry *dbentry)
-{
-	PgStat_StatTabEntry *tabentry = NULL;
-
-	if (isshared)
-	{
-		if (PointerIsValid(shared))
-			tabentry = hash_search(shared->tables, &relid,
-								   HASH_FIND, NULL);
-	}
-	else if (PointerIsValid(dbentry))
-		tabentry = hash_search(dbentry->tables, &relid,
-							   HASH_FIND, NULL);
-
-	return tabentry;
-}
-
 /*
  * table_recheck_autovac
  *
@@ -2794,17 +2696,15 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 	bool		doanalyze;
 	autovac_table *tab = NULL;
 	PgStat_StatTabEntry *tabentry;
-	PgStat_StatDBEntry *shared;
-	PgStat_StatDBEntry *dbentry;
 	bool		wraparound;
 	AutoVacOpts *avopts;
 
-	/* use fresh stats */
+	/*
+	 * Use fresh stats.  Only this table's entry is copied from shared memory
+	 * below, so this costs little even with many tables.
+	 */
 	autovac_refresh_stats();
 
-	shared = pgstat_fetch_stat_dbentry(InvalidOid);
-	dbentry = pgstat_fetch_stat_dbentry(MyDatabaseId);
-
 	/* fetch the relation's relcache entry */
 	classTup = SearchSysCacheCopy1(RELOID, ObjectIdGetDatum(relid));
 	if (!HeapTupleIsValid(classTup))
@@ -2828,8 +2728,7 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 	}
 
 	/* fetch the pgstat table entry */
-	tabentry = get_pgstat_tabentry_relid(relid, classForm->relisshared,
-										 shared, dbentry);
+	tabentry = pgstat_fetch_stat_tabentry_ext(classForm->relisshared, relid);
 
 	relation_needs_vacanalyze(relid, avopts, classForm, tabentry,
 							  effective_multixact_freeze_max_age,
@@ -3189,6 +3088,10 @@ autovac_report_workitem(AutoVacuumWorkItem *workitem,
 			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
 					 "autovacuum: BRIN summarize");
 			break;
+		case AVW_GINCleanPendingList:
+			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
+					 "autovacuum: GIN pending list cleanup");
+			break;
 	}
 
 	/*
@@ -3225,109 +3128,61 @@ AutoVacuumingActive(void)
 
 /*
  * Request one work item to the next autovacuum run processing our database.
+ * Return false if the request can't be recorded.
  */
-void
+bool
 AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 					  BlockNumber blkno)
 {
-	AutovacWorkItems *workitems;
-	dsa_pointer wi_ptr;
-	AutoVacuumWorkItem *workitem;
+	int			i;
+	int			freeslot = -1;
+	bool		result = false;
 
 	LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
 
 	/*
-	 * It may be useful to de-duplicate the list upon insertion.  For the only
-	 * currently existing caller, this is not necessary.
+	 * Locate an unused work item and fill it with the given data.  If an
+	 * identical request is already pending (but not yet being processed),
+	 * there's no point in queueing another one.
 	 */
-
-	/* First use in this process?  Set up DSA */
-	if (!AutoVacuumDSA)
+	for (i = 0; i < NUM_WORKITEMS; i++)
 	{
-		if (!AutoVacuumShmem->av_dsa_handle)
-		{
-			/* autovacuum launcher not started; nothing can be done */
-			LWLockRelease(AutovacuumLock);
-			return;
-		}
-		AutoVacuumDSA = dsa_attach(AutoVacuumShmem->av_dsa_handle);
-		dsa_pin_mapping(AutoVacuumDSA);
-	}
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[i];
 
-	/* First use overall?  Allocate work items array */
-	if (AutoVacuumShmem->av_workitems == InvalidDsaPointer)
-	{
-		int			i;
-		AutovacWorkItems *workitems;
-
-		AutoVacuumShmem->av_workitems =
-			dsa_allocate_extended(AutoVacuumDSA,
-								  sizeof(AutovacWorkItems) +
-								  NUM_WORKITEMS * sizeof(AutoVacuumWorkItem),
-								  DSA_ALLOC_NO_OOM);
-		/* if out of memory, silently disregard the request */
-		if (AutoVacuumShmem->av_workitems == InvalidDsaPointer)
+		if (!workitem->avw_used)
 		{
-			LWLockRelease(AutovacuumLock);
-			dsa_detach(AutoVacuumDSA);
-			AutoVacuumDSA = NULL;
-			return;
+			if (freeslot < 0)
+				freeslot = i;
+			continue;
 		}
 
-		/* Initialize each array entry as a member of the free list */
-		workitems = dsa_get_address(AutoVacuumDSA, AutoVacuumShmem->av_workitems);
-
-		workitems->avs_usedItems = InvalidDsaPointer;
-		workitems->avs_freeItems = InvalidDsaPointer;
-		for (i = 0; i < NUM_WORKITEMS; i++)
+		if (!workitem->avw_active &&
+			workitem->avw_type == type &&
+			workitem->avw_database == MyDatabaseId &&
+			workitem->avw_relation == relationId &&
+			workitem->avw_blockNumber == blkno)
 		{
-			/* XXX surely there is a simpler way to do this */
-			wi_ptr = AutoVacuumShmem->av_workitems + sizeof(AutovacWorkItems) +
-				sizeof(AutoVacuumWorkItem) * i;
-			workitem = (AutoVacuumWorkItem *) dsa_get_address(AutoVacuumDSA, wi_ptr);
-
-			workitem->avw_type = 0;
-			workitem->avw_database = InvalidOid;
-			workitem->avw_relation = InvalidOid;
-			workitem->avw_active = false;
-
-			/* put this item in the free list */
-			workitem->avw_next = workitems->avs_freeItems;
-			workitems->avs_freeItems = wi_ptr;
+			result = true;
+			break;
 		}
 	}
 
-	workitems = (AutovacWorkItems *)
-		dsa_get_address(AutoVacuumDSA, AutoVacuumShmem->av_workitems);
-
-	/* If array is full, disregard the request */
-	if (workitems->avs_freeItems == InvalidDsaPointer)
+	if (!result && freeslot >= 0)
 	{
-		LWLockRelease(AutovacuumLock);
-		dsa_detach(AutoVacuumDSA);
-		AutoVacuumDSA = NULL;
-		return;
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[freeslot];
+
+		workitem->avw_type = type;
+		workitem->avw_used = true;
+		workitem->avw_active = false;
+		workitem->avw_database = MyDatabaseId;
+		workitem->avw_relation = relationId;
+		workitem->avw_blockNumber = blkno;
+		result = true;
 	}
 
-	/* remove workitem struct from free list ... */
-	wi_ptr = workitems->avs_freeItems;
-	remove_wi_from_list(&workitems->avs_freeItems, wi_ptr);
-
-	/* ... initialize it ... */
-	workitem = dsa_get_address(AutoVacuumDSA, wi_ptr);
-	workitem->avw_type = type;
-	workitem->avw_database = MyDatabaseId;
-	workitem->avw_relation = relationId;
-	workitem->avw_blockNumber = blkno;
-	workitem->avw_active = false;
-
-	/* ... and put it on autovacuum's to-do list */
-	add_wi_to_list(&workitems->avs_usedItems, wi_ptr);
-
 	LWLockRelease(AutovacuumLock);
 
-	dsa_detach(AutoVacuumDSA);
-	AutoVacuumDSA = NULL;
+	return result;
 }
 
 /*
@@ -3407,6 +3262,8 @@ AutoVacuumShmemInit(void)
 		dlist_init(&AutoVacuumShmem->av_freeWorkers);
 		dlist_init(&AutoVacuumShmem->av_runningWorkers);
 		AutoVacuumShmem->av_startingWorker = NULL;
+		memset(AutoVacuumShmem->av_workItems, 0,
+			   sizeof(AutoVacuumWorkItem) * NUM_WORKITEMS);
 
 		worker = (WorkerInfo) ((char *) AutoVacuumShmem +
 							   MAXALIGN(sizeof(AutoVacuumShmemStruct)));
@@ -3451,59 +3308,3 @@ autovac_refresh_stats(void)
 
 	pgstat_clear_snapshot();
 }
-
-/*
- * Simplistic open-coded list implementation for objects stored in DSA.
- * Each item is doubly linked, but we have no tail pointer, and the "prev"
- * element of the first item is null, not the list.
- */
-
-/*
- * Remove a work item from the given list.
- */
-static void
-remove_wi_from_list(dsa_pointer *list, dsa_pointer wi_ptr)
-{
-	AutoVacuumWorkItem *workitem = dsa_get_address(AutoVacuumDSA, wi_ptr);
-	dsa_pointer next = workitem->avw_next;
-	dsa_pointer prev = workitem->avw_prev;
-
-	workitem->avw_next = workitem->avw_prev = InvalidDsaPointer;
-
-	if (next != InvalidDsaPointer)
-	{
-		workitem = dsa_get_address(AutoVacuumDSA, next);
-		workitem->avw_prev = prev;
-	}
-
-	if (prev != InvalidDsaPointer)
-	{
-		workitem = dsa_get_address(AutoVacuumDSA, prev);
-		workitem->avw_next = next;
-	}
-	else
-		*list = next;
-}
-
-/*
- * Add a workitem to the given list
- */
-static void
-add_wi_to_list(dsa_pointer *list, dsa_pointer wi_ptr)
-{
-	if (*list == InvalidDsaPointer)
-	{
-		/* list is empty; item is now singleton */
-		*list = wi_ptr;
-	}
-	else
-	{
-		AutoVacuumWorkItem *workitem = dsa_get_address(AutoVacuumDSA, wi_ptr);
-		AutoVacuumWorkItem *old = dsa_get_address(AutoVacuumDSA, *list);
-
-		/* Put item at head of list */
-		workitem->avw_next = *list;
-		old->avw_prev = wi_ptr;
-		*list = wi_ptr;
-	}
-}
@@ -398,6 +398,9 @@ CheckpointerMain(void)
 			ExitOnAnyError = true;
 			/* Close down the database */
 			ShutdownXLOG(0, 0);
+			/* Write out the cumulative statistics, now that nothing changes them */
+			pgstat_send_bgwriter();
+			pgstat_save_stats();
 			/* Normal exit from the checkpointer is here */
 			proc_exit(0);		/* done */
 		}
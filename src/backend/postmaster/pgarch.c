@@ -44,7 +44,6 @@
 #include "storage/fd.h"
 #include "storage/ipc.h"
 #include "storage/latch.h"
-#include "storage/pg_shmem.h"
 #include "storage/pmsignal.h"
 #include "utils/guc.h"
 #include "utils/ps_status.h"
@@ -157,9 +156,12 @@ pgarch_start(void)
 			/* Close the postmaster's sockets */
 			ClosePostmasterPorts(false);
 
-			/* Drop our connection to postmaster's shared memory, as well */
+			/*
+			 * Drop our connection to dynamic shared memory.  We stay attached
+			 * to the main shared memory segment, since archiver statistics
+			 * are kept there.
+			 */
 			dsm_detach_all();
-			PGSharedMemoryDetach();
 
 			PgArchiverMain(0, NULL);
 			break;
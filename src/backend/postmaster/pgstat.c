@@ -1,12 +1,17 @@
 /* ----------
  * pgstat.c
  *
- *	All the statistics collector stuff hacked up in one big, ugly file.
+ *	Cumulative statistics and backend activity reporting.
  *
- *	TODO:	- Separate collector, postmaster and backend stuff
- *			  into different files.
+ *	Backends accumulate per-table and per-function counts locally, and
+ *	apply them directly to hash tables kept in a dynamic shared memory
+ *	area at transaction end (at most once per PGSTAT_STAT_INTERVAL).
+ *	Readers copy the entries they ask for into a backend-local snapshot,
+ *	which lasts until the end of the transaction.  The shared tables are
+ *	written to disk by the checkpointer at shutdown, and read back by the
+ *	startup process.
  *
- *			- Add some automatic call for pgstat vacuuming.
+ *	TODO:	- Add some automatic call for pgstat vacuuming.
  *
  *			- Add a pgstat config column to pg_database, so this
  *			  entire thing can be enabled/disabled on a per db basis.
@@ -22,15 +27,7 @@
 #include <fcntl.h>
 #include <sys/param.h>
 #include <sys/time.h>
-#include <sys/socket.h>
-#include <netdb.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <signal.h>
 #include <time.h>
-#ifdef HAVE_SYS_SELECT_H
-#include <sys/select.h>
-#endif
 
 #include "pgstat.h"
 
@@ -41,29 +38,24 @@
 #include "access/xact.h"
 #include "catalog/pg_database.h"
 #include "catalog/pg_proc.h"
-#include "common/ip.h"
+#include "lib/dshash.h"
 #include "libpq/libpq.h"
-#include "libpq/pqsignal.h"
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
 #include "pg_trace.h"
 #include "postmaster/autovacuum.h"
-#include "postmaster/fork_process.h"
-#include "postmaster/postmaster.h"
 #include "replication/walsender.h"
 #include "storage/backendid.h"
-#include "storage/dsm.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
-#include "storage/latch.h"
 #include "storage/lmgr.h"
-#include "storage/pg_shmem.h"
 #include "storage/procsignal.h"
+#include "storage/shmem.h"
 #include "storage/sinvaladt.h"
+#include "storage/spin.h"
 #include "utils/ascii.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
-#include "utils/ps_status.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
 #include "utils/timestamp.h"
@@ -74,28 +66,21 @@
  * Timer definitions.
  * ----------
  */
-#define PGSTAT_STAT_INTERVAL	500		/* Minimum time between stats file
-										 * updates; in milliseconds. */
-
-#define PGSTAT_RETRY_DELAY		10		/* How long to wait between checks for
-										 * a new file; in milliseconds. */
-
-#define PGSTAT_MAX_WAIT_TIME	10000	/* Maximum time to wait for a stats
-										 * file update; in milliseconds. */
-
-#define PGSTAT_INQ_INTERVAL		640		/* How often to ping the collector for
-										 * a new file; in milliseconds. */
+#define PGSTAT_STAT_INTERVAL	500		/* Minimum time between applying a
+										 * backend's counts to the shared
+										 * stats; in milliseconds. */
 
-#define PGSTAT_RESTART_INTERVAL 60		/* How often to attempt to restart a
-										 * failed statistics collector; in
-										 * seconds. */
 
-#define PGSTAT_POLL_LOOP_COUNT	(PGSTAT_MAX_WAIT_TIME / PGSTAT_RETRY_DELAY)
-#define PGSTAT_INQ_LOOP_COUNT	(PGSTAT_INQ_INTERVAL / PGSTAT_RETRY_DELAY)
+/* ----------
+ * Size of the part of the DSA area that lives in the main shared memory
+ * segment.  It must hold the initial hash tables.
+ * ----------
+ */
+#define PGSTAT_DSA_INITIAL_SIZE		(256 * 1024)
 
 
 /* ----------
- * The initial size hints for the hash tables used in the collector.
+ * The initial size hints for the snapshot hash tables.
  * ----------
  */
 #define PGSTAT_DB_HASH_SIZE		16
@@ -129,8 +114,6 @@ int			pgstat_track_activity_query_size = 1024;
  * ----------
  */
 char	   *pgstat_stat_directory = NULL;
-char	   *pgstat_stat_filename = NULL;
-char	   *pgstat_stat_tmpname = NULL;
 
 /*
  * BgWriter global statistics counters (unused in other processes).
@@ -140,20 +123,88 @@ char	   *pgstat_stat_tmpname = NULL;
 PgStat_MsgBgWriter BgWriterStats;
 
 /* ----------
- * Local data
+ * Shared statistics
+ *
+ * Database, table and function statistics are kept in dshash tables in a
+ * DSA area, whose first segment is carved out of the main shared memory
+ * segment right after the control struct.  The cluster-wide bgwriter and
+ * archiver statistics are kept directly in the control struct, protected
+ * by a spinlock, so that the archiver (which has no PGPROC and so cannot
+ * take LWLocks) can update them.
  * ----------
  */
-NON_EXEC_STATIC pgsocket pgStatSock = PGINVALID_SOCKET;
+struct PgStat_ShmemControl
+{
+	dshash_table_handle db_hash_handle;
+	dshash_table_handle tab_hash_handle;
+	dshash_table_handle func_hash_handle;
+
+	slock_t		mutex;			/* protects the structs below */
+	PgStat_GlobalStats globalStats;
+	PgStat_ArchiverStats archiverStats;
+};
 
-static struct sockaddr_storage pgStatAddr;
+#define PgStatDSAPlace() \
+	((void *) ((char *) pgStatShmem + MAXALIGN(sizeof(PgStat_ShmemControl))))
+
+/*
+ * Table and function entries of all databases live in one hash table each,
+ * keyed by database OID and object OID.  Shared catalogs use InvalidOid as
+ * the database OID, as before.
+ */
+typedef struct PgStat_ObjKey
+{
+	Oid			databaseid;
+	Oid			objectid;
+} PgStat_ObjKey;
 
-static time_t last_pgstat_start_time;
+typedef struct PgStat_SharedTabEntry
+{
+	PgStat_ObjKey key;			/* hash key (must be first) */
+	PgStat_StatTabEntry stats;
+} PgStat_SharedTabEntry;
 
-static bool pgStatRunningInCollector = false;
+typedef struct PgStat_SharedFuncEntry
+{
+	PgStat_ObjKey key;			/* hash key (must be first) */
+	PgStat_StatFuncEntry stats;
+} PgStat_SharedFuncEntry;
+
+static const dshash_parameters dsh_dbparams = {
+	sizeof(Oid),
+	sizeof(PgStat_StatDBEntry),
+	dshash_memcmp,
+	dshash_memhash,
+	LWTRANCHE_STATS_HASH
+};
+
+static const dshash_parameters dsh_tabparams = {
+	sizeof(PgStat_ObjKey),
+	sizeof(PgStat_SharedTabEntry),
+	dshash_memcmp,
+	dshash_memhash,
+	LWTRANCHE_STATS_HASH
+};
+
+static const dshash_parameters dsh_funcparams = {
+	sizeof(PgStat_ObjKey),
+	sizeof(PgStat_SharedFuncEntry),
+	dshash_memcmp,
+	dshash_memhash,
+	LWTRANCHE_STATS_HASH
+};
+
+NON_EXEC_STATIC PgStat_ShmemControl *pgStatShmem = NULL;
+
+/* This process' mapping of the shared hash tables, attached on first use */
+static dsa_area *pgStatDSA = NULL;
+static dshash_table *pgStatDBTable = NULL;
+static dshash_table *pgStatTabTable = NULL;
+static dshash_table *pgStatFuncTable = NULL;
 
 /*
  * Structures in which backends store per-table info that's waiting to be
- * sent to the collector.
+ * applied to the shared statistics.
  *
  * NOTE: once allocated, TabStatusArray structures are never moved or deleted
  * for the life of the backend.  Also, we zero out the t_id fields of the
@@ -188,14 +239,14 @@ typedef struct TabStatHashEntry
 static HTAB *pgStatTabHash = NULL;
 
 /*
- * Backends store per-function info that's waiting to be sent to the collector
- * in this hash table (indexed by function OID).
+ * Backends store per-function info that's waiting to be applied to the shared
+ * statistics in this hash table (indexed by function OID).
  */
 static HTAB *pgStatFunctions = NULL;
 
 /*
  * Indicates if backend has some function stats that it hasn't yet
- * sent to the collector.
+ * applied to the shared statistics.
  */
 static bool have_function_stats = false;
 
@@ -235,11 +286,14 @@ typedef struct TwoPhasePgStatRecord
 } TwoPhasePgStatRecord;
 
 /*
- * Info about current "snapshot" of stats file
+ * Info about current "snapshot" of the shared statistics
  */
 static MemoryContext pgStatLocalContext = NULL;
 static HTAB *pgStatDBHash = NULL;
 
+/* Have all the table and function entries been copied into the snapshot? */
+static bool pgStatSnapshotComplete = false;
+
 /* Status for backends including auxiliary */
 static LocalPgBackendStatus *localBackendStatusTable = NULL;
 
@@ -247,24 +301,13 @@ static LocalPgBackendStatus *localBackendStatusTable = NULL;
 static int	localNumBackends = 0;
 
 /*
- * Cluster wide statistics, kept in the stats collector.
+ * Snapshot copies of the cluster wide statistics.
  * Contains statistics that are not collected per database
  * or per table.
  */
 static PgStat_ArchiverStats archiverStats;
 static PgStat_GlobalStats globalStats;
 
-/*
- * List of OIDs of databases we need to write out.  If an entry is InvalidOid,
- * it means to write only the shared-catalog stats ("DB 0"); otherwise, we
- * will write both that DB's data and the shared stats.
- */
-static List *pending_write_requests = NIL;
-
-/* Signal handler flags */
-static volatile bool need_exit = false;
-static volatile bool got_SIGHUP = false;
-
 /*
  * Total time charged to functions so far in the current backend.
  * We use this to help separate "self" and "other" time charges.
@@ -277,28 +320,20 @@ static instr_time total_func_time;
  * Local function forward declarations
  * ----------
  */
-#ifdef EXEC_BACKEND
-static pid_t pgstat_forkexec(void);
-#endif
-
-NON_EXEC_STATIC void PgstatCollectorMain(int argc, char *argv[]) pg_attribute_noreturn();
-static void pgstat_exit(SIGNAL_ARGS);
+static void pgstat_shutdown_hook(int code, Datum arg);
 static void pgstat_beshutdown_hook(int code, Datum arg);
-static void pgstat_sighup_handler(SIGNAL_ARGS);
 
+static void pgstat_attach_shmem(void);
+static void pgstat_detach_shmem(void);
 static PgStat_StatDBEntry *pgstat_get_db_entry(Oid databaseid, bool create);
-static PgStat_StatTabEntry *pgstat_get_tab_entry(PgStat_StatDBEntry *dbentry,
+static PgStat_SharedTabEntry *pgstat_get_tab_entry(Oid databaseid,
 					 Oid tableoid, bool create);
-static void pgstat_write_statsfiles(bool permanent, bool allDbs);
-static void pgstat_write_db_statsfile(PgStat_StatDBEntry *dbentry, bool permanent);
-static HTAB *pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep);
-static void pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash, bool permanent);
-static void backend_read_statsfile(void);
+static void pgstat_remove_db_objects(Oid databaseid);
+static void pgstat_build_snapshot(void);
+static void pgstat_snapshot_all_objects(void);
+static PgStat_StatDBEntry *pgstat_snapshot_db_entry(Oid databaseid);
 static void pgstat_read_current_status(void);
 
-static bool pgstat_write_statsfile_needed(void);
-static bool pgstat_db_requested(Oid databaseid);
-
 static void pgstat_send_tabstat(PgStat_MsgTabstat *tsmsg);
 static void pgstat_send_funcstats(void);
 static HTAB *pgstat_collect_oids(Oid catalogid);
@@ -316,23 +351,23 @@ static const char *pgstat_get_wait_io(WaitEventIO w);
 static void pgstat_setheader(PgStat_MsgHdr *hdr, StatMsgType mtype);
 static void pgstat_send(void *msg, int len);
 
-static void pgstat_recv_inquiry(PgStat_MsgInquiry *msg, int len);
-static void pgstat_recv_tabstat(PgStat_MsgTabstat *msg, int len);
-static void pgstat_recv_tabpurge(PgStat_MsgTabpurge *msg, int len);
-static void pgstat_recv_dropdb(PgStat_MsgDropdb *msg, int len);
-static void pgstat_recv_resetcounter(PgStat_MsgResetcounter *msg, int len);
-static void pgstat_recv_resetsharedcounter(PgStat_MsgResetsharedcounter *msg, int len);
-static void pgstat_recv_resetsinglecounter(PgStat_MsgResetsinglecounter *msg, int len);
-static void pgstat_recv_autovac(PgStat_MsgAutovacStart *msg, int len);
-static void pgstat_recv_vacuum(PgStat_MsgVacuum *msg, int len);
-static void pgstat_recv_analyze(PgStat_MsgAnalyze *msg, int len);
-static void pgstat_recv_archiver(PgStat_MsgArchiver *msg, int len);
-static void pgstat_recv_bgwriter(PgStat_MsgBgWriter *msg, int len);
-static void pgstat_recv_funcstat(PgStat_MsgFuncstat *msg, int len);
-static void pgstat_recv_funcpurge(PgStat_MsgFuncpurge *msg, int len);
-static void pgstat_recv_recoveryconflict(PgStat_MsgRecoveryConflict *msg, int len);
-static void pgstat_recv_deadlock(PgStat_MsgDeadlock *msg, int len);
-static void pgstat_recv_tempfile(PgStat_MsgTempFile *msg, int len);
+static void pgstat_apply_tabstat(PgStat_MsgTabstat *msg, int len);
+static void pgstat_apply_tabpurge(PgStat_MsgTabpurge *msg, int len);
+static void pgstat_apply_dropdb(PgStat_MsgDropdb *msg, int len);
+static void pgstat_apply_resetcounter(PgStat_MsgResetcounter *msg, int len);
+static void pgstat_apply_resetsharedcounter(PgStat_MsgResetsharedcounter *msg, int len);
+static void pgstat_apply_resetsinglecounter(PgStat_MsgResetsinglecounter *msg, int len);
+static void pgstat_apply_autovac(PgStat_MsgAutovacStart *msg, int len);
+static void pgstat_apply_vacuum(PgStat_MsgVacuum *msg, int len);
+static void pgstat_apply_analyze(PgStat_MsgAnalyze *msg, int len);
+static void pgstat_apply_archiver(PgStat_MsgArchiver *msg, int len);
+static void pgstat_apply_bgwriter(PgStat_MsgBgWriter *msg, int len);
+static void pgstat_apply_funcstat(PgStat_MsgFuncstat *msg, int len);
+static void pgstat_apply_funcpurge(PgStat_MsgFuncpurge *msg, int len);
+static void pgstat_apply_recoveryconflict(PgStat_MsgRecoveryConflict *msg, int len);
+static void pgstat_apply_deadlock(PgStat_MsgDeadlock *msg, int len);
+static void pgstat_apply_tempfile(PgStat_MsgTempFile *msg, int len);
+
 
 /* ------------------------------------------------------------
  * Public functions called from postmaster follow
@@ -340,262 +375,76 @@ static void pgstat_recv_tempfile(PgStat_MsgTempFile *msg, int len);
  */
 
 /* ----------
- * pgstat_init() -
+ * PgStatShmemSize() -
  *
- *	Called from postmaster at startup. Create the resources required
- *	by the statistics collector process.  If unable to do so, do not
- *	fail --- better to let the postmaster start with stats collection
- *	disabled.
+ *	Compute the space needed for the shared statistics control struct,
+ *	including the in-place DSA area that the hash tables start out in.
  * ----------
  */
-void
-pgstat_init(void)
+Size
+PgStatShmemSize(void)
 {
-	ACCEPT_TYPE_ARG3 alen;
-	struct addrinfo *addrs = NULL,
-			   *addr,
-				hints;
-	int			ret;
-	fd_set		rset;
-	struct timeval tv;
-	char		test_byte;
-	int			sel_res;
-	int			tries = 0;
-
-#define TESTBYTEVAL ((char) 199)
+	return add_size(MAXALIGN(sizeof(PgStat_ShmemControl)),
+					PGSTAT_DSA_INITIAL_SIZE);
+}
 
-	/*
-	 * This static assertion verifies that we didn't mess up the calculations
-	 * involved in selecting maximum payload sizes for our UDP messages.
-	 * Because the only consequence of overrunning PGSTAT_MAX_MSG_SIZE would
-	 * be silent performance loss from fragmentation, it seems worth having a
-	 * compile-time cross-check that we didn't.
-	 */
-	StaticAssertStmt(sizeof(PgStat_Msg) <= PGSTAT_MAX_MSG_SIZE,
-				   "maximum stats message size exceeds PGSTAT_MAX_MSG_SIZE");
+/* ----------
+ * PgStatShmemInit() -
+ *
+ *	Called from postmaster (or a standalone backend) at startup to create
+ *	the shared statistics area.  The hash tables are created here, in the
+ *	part of the DSA area that lives in the main shared memory segment; they
+ *	grow into DSM segments later, as backends insert entries.
+ * ----------
+ */
+void
+PgStatShmemInit(void)
+{
+	bool		found;
 
-	/*
-	 * Create the UDP socket for sending and receiving statistic messages
-	 */
-	hints.ai_flags = AI_PASSIVE;
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_DGRAM;
-	hints.ai_protocol = 0;
-	hints.ai_addrlen = 0;
-	hints.ai_addr = NULL;
-	hints.ai_canonname = NULL;
-	hints.ai_next = NULL;
-	ret = pg_getaddrinfo_all("localhost", NULL, &hints, &addrs);
-	if (ret || !addrs)
-	{
-		ereport(LOG,
-				(errmsg("could not resolve \"localhost\": %s",
-						gai_strerror(ret))));
-		goto startup_failed;
-	}
+	pgStatShmem = (PgStat_ShmemControl *)
+		ShmemInitStruct("Statistics Data", PgStatShmemSize(), &found);
 
-	/*
-	 * On some platforms, pg_getaddrinfo_all() may return multiple addresses
-	 * only one of which will actually work (eg, both IPv6 and IPv4 addresses
-	 * when kernel will reject IPv6).  Worse, the failure may occur at the
-	 * bind() or perhaps even connect() stage.  So we must loop through the
-	 * results till we find a working combination. We will generate LOG
-	 * messages, but no error, for bogus combinations.
-	 */
-	for (addr = addrs; addr; addr = addr->ai_next)
+	if (!found)
 	{
-#ifdef HAVE_UNIX_SOCKETS
-		/* Ignore AF_UNIX sockets, if any are returned. */
-		if (addr->ai_family == AF_UNIX)
-			continue;
-#endif
-
-		if (++tries > 1)
-			ereport(LOG,
-			(errmsg("trying another address for the statistics collector")));
-
-		/*
-		 * Create the socket.
-		 */
-		if ((pgStatSock = socket(addr->ai_family, SOCK_DGRAM, 0)) == PGINVALID_SOCKET)
-		{
-			ereport(LOG,
-					(errcode_for_socket_access(),
-			errmsg("could not create socket for statistics collector: %m")));
-			continue;
-		}
-
-		/*
-		 * Bind it to a kernel assigned port on localhost and get the assigned
-		 * port via getsockname().
-		 */
-		if (bind(pgStatSock, addr->ai_addr, addr->ai_addrlen) < 0)
-		{
-			ereport(LOG,
-					(errcode_for_socket_access(),
-			  errmsg("could not bind socket for statistics collector: %m")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
-
-		alen = sizeof(pgStatAddr);
-		if (getsockname(pgStatSock, (struct sockaddr *) & pgStatAddr, &alen) < 0)
-		{
-			ereport(LOG,
-					(errcode_for_socket_access(),
-					 errmsg("could not get address of socket for statistics collector: %m")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
-
-		/*
-		 * Connect the socket to its own address.  This saves a few cycles by
-		 * not having to respecify the target address on every send. This also
-		 * provides a kernel-level check that only packets from this same
-		 * address will be received.
-		 */
-		if (connect(pgStatSock, (struct sockaddr *) & pgStatAddr, alen) < 0)
-		{
-			ereport(LOG,
-					(errcode_for_socket_access(),
-			errmsg("could not connect socket for statistics collector: %m")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
-
-		/*
-		 * Try to send and receive a one-byte test message on the socket. This
-		 * is to catch situations where the socket can be created but will not
-		 * actually pass data (for instance, because kernel packet filtering
-		 * rules prevent it).
-		 */
-		test_byte = TESTBYTEVAL;
+		dsa_area   *area;
+		dshash_table *dbhash;
+		dshash_table *tabhash;
+		dshash_table *funchash;
+		TimestampTz now = GetCurrentTimestamp();
 
-retry1:
-		if (send(pgStatSock, &test_byte, 1, 0) != 1)
-		{
-			if (errno == EINTR)
-				goto retry1;	/* if interrupted, just retry */
-			ereport(LOG,
-					(errcode_for_socket_access(),
-					 errmsg("could not send test message on socket for statistics collector: %m")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
+		area = dsa_create_in_place(PgStatDSAPlace(),
+								   PGSTAT_DSA_INITIAL_SIZE,
+								   LWTRANCHE_STATS_DSA, NULL);
+		dsa_pin(area);
 
 		/*
-		 * There could possibly be a little delay before the message can be
-		 * received.  We arbitrarily allow up to half a second before deciding
-		 * it's broken.
+		 * Make sure the hash tables' initial allocations fit in the in-place
+		 * area, since we can't create DSM segments from the postmaster.
 		 */
-		for (;;)				/* need a loop to handle EINTR */
-		{
-			FD_ZERO(&rset);
-			FD_SET(pgStatSock, &rset);
-
-			tv.tv_sec = 0;
-			tv.tv_usec = 500000;
-			sel_res = select(pgStatSock + 1, &rset, NULL, NULL, &tv);
-			if (sel_res >= 0 || errno != EINTR)
-				break;
-		}
-		if (sel_res < 0)
-		{
-			ereport(LOG,
-					(errcode_for_socket_access(),
-					 errmsg("select() failed in statistics collector: %m")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
-		if (sel_res == 0 || !FD_ISSET(pgStatSock, &rset))
-		{
-			/*
-			 * This is the case we actually think is likely, so take pains to
-			 * give a specific message for it.
-			 *
-			 * errno will not be set meaningfully here, so don't use it.
-			 */
-			ereport(LOG,
-					(errcode(ERRCODE_CONNECTION_FAILURE),
-					 errmsg("test message did not get through on socket for statistics collector")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
+		dsa_set_size_limit(area, PGSTAT_DSA_INITIAL_SIZE);
 
-		test_byte++;			/* just make sure variable is changed */
+		dbhash = dshash_create(area, &dsh_dbparams, NULL);
+		tabhash = dshash_create(area, &dsh_tabparams, NULL);
+		funchash = dshash_create(area, &dsh_funcparams, NULL);
 
-retry2:
-		if (recv(pgStatSock, &test_byte, 1, 0) != 1)
-		{
-			if (errno == EINTR)
-				goto retry2;	/* if interrupted, just retry */
-			ereport(LOG,
-					(errcode_for_socket_access(),
-					 errmsg("could not receive test message on socket for statistics collector: %m")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
-
-		if (test_byte != TESTBYTEVAL)	/* strictly paranoia ... */
-		{
-			ereport(LOG,
-					(errcode(ERRCODE_INTERNAL_ERROR),
-					 errmsg("incorrect test message transmission on socket for statistics collector")));
-			closesocket(pgStatSock);
-			pgStatSock = PGINVALID_SOCKET;
-			continue;
-		}
+		pgStatShmem->db_hash_handle = dshash_get_hash_table_handle(dbhash);
+		pgStatShmem->tab_hash_handle = dshash_get_hash_table_handle(tabhash);
+		pgStatShmem->func_hash_handle = dshash_get_hash_table_handle(funchash);
 
-		/* If we get here, we have a working socket */
-		break;
-	}
+		dsa_set_size_limit(area, -1);
 
-	/* Did we find a working address? */
-	if (!addr || pgStatSock == PGINVALID_SOCKET)
-		goto startup_failed;
+		dshash_detach(dbhash);
+		dshash_detach(tabhash);
+		dshash_detach(funchash);
+		dsa_detach(area);
 
-	/*
-	 * Set the socket to non-blocking IO.  This ensures that if the collector
-	 * falls behind, statistics messages will be discarded; backends won't
-	 * block waiting to send messages to the collector.
-	 */
-	if (!pg_set_noblock(pgStatSock))
-	{
-		ereport(LOG,
-				(errcode_for_socket_access(),
-				 errmsg("could not set statistics collector socket to nonblocking mode: %m")));
-		goto startup_failed;
+		SpinLockInit(&pgStatShmem->mutex);
+		memset(&pgStatShmem->globalStats, 0, sizeof(PgStat_GlobalStats));
+		memset(&pgStatShmem->archiverStats, 0, sizeof(PgStat_ArchiverStats));
+		pgStatShmem->globalStats.stat_reset_timestamp = now;
+		pgStatShmem->archiverStats.stat_reset_timestamp = now;
 	}
-
-	pg_freeaddrinfo_all(hints.ai_family, addrs);
-
-	return;
-
-startup_failed:
-	ereport(LOG,
-	  (errmsg("disabling statistics collector for lack of working socket")));
-
-	if (addrs)
-		pg_freeaddrinfo_all(hints.ai_family, addrs);
-
-	if (pgStatSock != PGINVALID_SOCKET)
-		closesocket(pgStatSock);
-	pgStatSock = PGINVALID_SOCKET;
-
-	/*
-	 * Adjust GUC variables to suppress useless activity, and for debugging
-	 * purposes (seeing track_counts off is a clue that we failed here). We
-	 * use PGC_S_OVERRIDE because there is no point in trying to turn it back
-	 * on from postgresql.conf without a restart.
-	 */
-	SetConfigOption("track_counts", "off", PGC_INTERNAL, PGC_S_OVERRIDE);
 }
 
 /*
@@ -615,8 +464,9 @@ pgstat_reset_remove_files(const char *directory)
 		Oid			tmp_oid;
 
 		/*
-		 * Skip directory entries that don't match the file names we write.
-		 * See get_dbstat_filename for the database-specific pattern.
+		 * Skip directory entries that don't match the file names we write,
+		 * or the per-database files ("db_<oid>.stat") that servers running
+		 * a separate statistics collector used to write.
 		 */
 		if (strncmp(entry->d_name, "global.", 7) == 0)
 			nchars = 7;
@@ -656,110 +506,6 @@ pgstat_reset_all(void)
 	pgstat_reset_remove_files(PGSTAT_STAT_PERMANENT_DIRECTORY);
 }
 
-#ifdef EXEC_BACKEND
-
-/*
- * pgstat_forkexec() -
- *
- * Format up the arglist for, then fork and exec, statistics collector process
- */
-static pid_t
-pgstat_forkexec(void)
-{
-	char	   *av[10];
-	int			ac = 0;
-
-	av[ac++] = "postgres";
-	av[ac++] = "--forkcol";
-	av[ac++] = NULL;			/* filled in by postmaster_forkexec */
-
-	av[ac] = NULL;
-	Assert(ac < lengthof(av));
-
-	return postmaster_forkexec(ac, av);
-}
-#endif   /* EXEC_BACKEND */
-
-
-/*
- * pgstat_start() -
- *
- *	Called from postmaster at startup or after an existing collector
- *	died.  Attempt to fire up a fresh statistics collector.
- *
- *	Returns PID of child process, or 0 if fail.
- *
- *	Note: if fail, we will be called again from the postmaster main loop.
- */
-int
-pgstat_start(void)
-{
-	time_t		curtime;
-	pid_t		pgStatPid;
-
-	/*
-	 * Check that the socket is there, else pgstat_init failed and we can do
-	 * nothing useful.
-	 */
-	if (pgStatSock == PGINVALID_SOCKET)
-		return 0;
-
-	/*
-	 * Do nothing if too soon since last collector start.  This is a safety
-	 * valve to protect against continuous respawn attempts if the collector
-	 * is dying immediately at launch.  Note that since we will be re-called
-	 * from the postmaster main loop, we will get another chance later.
-	 */
-	curtime = time(NULL);
-	if ((unsigned int) (curtime - last_pgstat_start_time) <
-		(unsigned int) PGSTAT_RESTART_INTERVAL)
-		return 0;
-	last_pgstat_start_time = curtime;
-
-	/*
-	 * Okay, fork off the collector.
-	 */
-#ifdef EXEC_BACKEND
-	switch ((pgStatPid = pgstat_forkexec()))
-#else
-	switch ((pgStatPid = fork_process()))
-#endif
-	{
-		case -1:
-			ereport(LOG,
-					(errmsg("could not fork statistics collector: %m")));
-			return 0;
-
-#ifndef EXEC_BACKEND
-		case 0:
-			/* in postmaster child ... */
-			InitPostmasterChild();
-
-			/* Close the postmaster's sockets */
-			ClosePostmasterPorts(false);
-
-			/* Drop our connection to postmaster's shared memory, as well */
-			dsm_detach_all();
-			PGSharedMemoryDetach();
-
-			PgstatCollectorMain(0, NULL);
-			break;
-#endif
-
-		default:
-			return (int) pgStatPid;
-	}
-
-	/* shouldn't get here */
-	return 0;
-}
-
-void
-allow_immediate_pgstat_restart(void)
-{
-	last_pgstat_start_time = 0;
-}
-
 /* ------------------------------------------------------------
  * Public functions used by backends follow
  *------------------------------------------------------------
@@ -769,8 +515,8 @@ allow_immediate_pgstat_restart(void)
 /* ----------
  * pgstat_report_stat() -
  *
- *	Called from tcop/postgres.c to send the so far collected per-table
- *	and function usage statistics to the collector.  Note that this is
+ *	Called from tcop/postgres.c to apply the so far collected per-table
+ *	and function usage statistics to the shared stats.  Note that this is
  *	called only when not within a transaction, so it is fair to use
  *	transaction stop time as an approximation of current time.
  * ----------
@@ -795,8 +541,9 @@ pgstat_report_stat(bool force)
 		return;
 
 	/*
-	 * Don't send a message unless it's been at least PGSTAT_STAT_INTERVAL
-	 * msec since we last sent one, or the caller wants to force stats out.
+	 * Don't apply anything unless it's been at least PGSTAT_STAT_INTERVAL
+	 * msec since we last did, or the caller wants to force stats out.  This
+	 * bounds the traffic on the shared hash table locks.
 	 */
 	now = GetCurrentTransactionStopTimestamp();
 	if (!force &&
@@ -885,10 +632,6 @@ pgstat_send_tabstat(PgStat_MsgTabstat *tsmsg)
 	int			n;
 	int			len;
 
-	/* It's unlikely we'd get here with no socket, but maybe not impossible */
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	/*
 	 * Report and reset accumulated xact commit/rollback and I/O timings
 	 * whenever we send a normal tabstat message
@@ -979,7 +722,7 @@ pgstat_send_funcstats(void)
 /* ----------
  * pgstat_vacuum_stat() -
  *
- *	Will tell the collector about objects he can get rid of.
+ *	Remove the statistics of objects that no longer exist.
  * ----------
  */
 void
@@ -994,14 +737,11 @@ pgstat_vacuum_stat(void)
 	PgStat_StatFuncEntry *funcentry;
 	int			len;
 
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	/*
-	 * If not done for this transaction, read the statistics collector stats
-	 * file into some hash tables.
+	 * If not done for this transaction, take a snapshot of the shared
+	 * statistics, including all the tables and functions of this database.
 	 */
-	backend_read_statsfile();
+	pgstat_snapshot_all_objects();
 
 	/*
 	 * Read pg_database and make a list of OIDs of all existing databases
@@ -1009,8 +749,7 @@ pgstat_vacuum_stat(void)
 	htab = pgstat_collect_oids(DatabaseRelationId);
 
 	/*
-	 * Search the database hash table for dead databases and tell the
-	 * collector to drop them.
+	 * Search the database hash table for dead databases and drop them.
 	 */
 	hash_seq_init(&hstat, pgStatDBHash);
 	while ((dbentry = (PgStat_StatDBEntry *) hash_seq_search(&hstat)) != NULL)
@@ -1205,9 +944,7 @@ pgstat_collect_oids(Oid catalogid)
 /* ----------
  * pgstat_drop_database() -
  *
- *	Tell the collector that we just dropped a database.
- *	(If the message gets lost, we will still clean the dead DB eventually
- *	via future invocations of pgstat_vacuum_stat().)
+ *	Tell the stats system that we just dropped a database.
  * ----------
  */
 void
@@ -1215,9 +952,6 @@ pgstat_drop_database(Oid databaseid)
 {
 	PgStat_MsgDropdb msg;
 
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_DROPDB);
 	msg.m_databaseid = databaseid;
 	pgstat_send(&msg, sizeof(msg));
@@ -1227,9 +961,7 @@ pgstat_drop_database(Oid databaseid)
 /* ----------
  * pgstat_drop_relation() -
  *
- *	Tell the collector that we just dropped a relation.
- *	(If the message gets lost, we will still clean the dead entry eventually
- *	via future invocations of pgstat_vacuum_stat().)
+ *	Tell the stats system that we just dropped a relation.
  *
  *	Currently not used for lack of any good place to call it; we rely
  *	entirely on pgstat_vacuum_stat() to clean out stats for dead rels.
@@ -1242,9 +974,6 @@ pgstat_drop_relation(Oid relid)
 	PgStat_MsgTabpurge msg;
 	int			len;
 
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	msg.m_tableid[0] = relid;
 	msg.m_nentries = 1;
 
@@ -1260,7 +989,7 @@ pgstat_drop_relation(Oid relid)
 /* ----------
  * pgstat_reset_counters() -
  *
- *	Tell the statistics collector to reset counters for our database.
+ *	Tell the stats system to reset counters for our database.
  *
  *	Permission checking for this function is managed through the normal
  *	GRANT system.
@@ -1271,9 +1000,6 @@ pgstat_reset_counters(void)
 {
 	PgStat_MsgResetcounter msg;
 
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_RESETCOUNTER);
 	msg.m_databaseid = MyDatabaseId;
 	pgstat_send(&msg, sizeof(msg));
@@ -1282,7 +1008,7 @@ pgstat_reset_counters(void)
 /* ----------
  * pgstat_reset_shared_counters() -
  *
- *	Tell the statistics collector to reset cluster-wide shared counters.
+ *	Tell the stats system to reset cluster-wide shared counters.
  *
  *	Permission checking for this function is managed through the normal
  *	GRANT system.
@@ -1293,9 +1019,6 @@ pgstat_reset_shared_counters(const char *target)
 {
 	PgStat_MsgResetsharedcounter msg;
 
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	if (strcmp(target, "archiver") == 0)
 		msg.m_resettarget = RESET_ARCHIVER;
 	else if (strcmp(target, "bgwriter") == 0)
@@ -1313,7 +1036,7 @@ pgstat_reset_shared_counters(const char *target)
 /* ----------
  * pgstat_reset_single_counter() -
  *
- *	Tell the statistics collector to reset a single counter.
+ *	Tell the stats system to reset a single counter.
  *
  *	Permission checking for this function is managed through the normal
  *	GRANT system.
@@ -1324,9 +1047,6 @@ pgstat_reset_single_counter(Oid objoid, PgStat_Single_Reset_Type type)
 {
 	PgStat_MsgResetsinglecounter msg;
 
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_RESETSINGLECOUNTER);
 	msg.m_databaseid = MyDatabaseId;
 	msg.m_resettype = type;
@@ -1348,9 +1068,6 @@ pgstat_report_autovac(Oid dboid)
 {
 	PgStat_MsgAutovacStart msg;
 
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_AUTOVAC_START);
 	msg.m_databaseid = dboid;
 	msg.m_start_time = GetCurrentTimestamp();
@@ -1362,7 +1079,7 @@ pgstat_report_autovac(Oid dboid)
 /* ---------
  * pgstat_report_vacuum() -
  *
- *	Tell the collector about the table we just vacuumed.
+ *	Tell the stats system about the table we just vacuumed.
  * ---------
  */
 void
@@ -1371,7 +1088,7 @@ pgstat_report_vacuum(Oid tableoid, bool shared,
 {
 	PgStat_MsgVacuum msg;
 
-	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
+	if (!pgstat_track_counts)
 		return;
 
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_VACUUM);
@@ -1387,7 +1104,7 @@ pgstat_report_vacuum(Oid tableoid, bool shared,
 /* --------
  * pgstat_report_analyze() -
  *
- *	Tell the collector about the table we just analyzed.
+ *	Tell the stats system about the table we just analyzed.
  *
  * Caller must provide new live- and dead-tuples estimates, as well as a
  * flag indicating whether to reset the changes_since_analyze counter.
@@ -1400,7 +1117,7 @@ pgstat_report_analyze(Relation rel,
 {
 	PgStat_MsgAnalyze msg;
 
-	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
+	if (!pgstat_track_counts)
 		return;
 
 	/*
@@ -1408,9 +1125,9 @@ pgstat_report_analyze(Relation rel,
 	 * already inserted and/or deleted rows in the target table. ANALYZE will
 	 * have counted such rows as live or dead respectively. Because we will
 	 * report our counts of such rows at transaction end, we should subtract
-	 * off these counts from what we send to the collector now, else they'll
-	 * be double-counted after commit.  (This approach also ensures that the
-	 * collector ends up with the right numbers if we abort instead of
+	 * off these counts from what we report now, else they'll be
+	 * double-counted after commit.  (This approach also ensures that the
+	 * shared stats end up with the right numbers if we abort instead of
 	 * committing.)
 	 */
 	if (rel->pgstat_info != NULL)
@@ -1443,7 +1160,7 @@ pgstat_report_analyze(Relation rel,
 /* --------
  * pgstat_report_recovery_conflict() -
  *
- *	Tell the collector about a Hot Standby recovery conflict.
+ *	Tell the stats system about a Hot Standby recovery conflict.
  * --------
  */
 void
@@ -1451,7 +1168,7 @@ pgstat_report_recovery_conflict(int reason)
 {
 	PgStat_MsgRecoveryConflict msg;
 
-	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
+	if (!pgstat_track_counts)
 		return;
 
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_RECOVERYCONFLICT);
@@ -1463,7 +1180,7 @@ pgstat_report_recovery_conflict(int reason)
 /* --------
  * pgstat_report_deadlock() -
  *
- *	Tell the collector about a deadlock detected.
+ *	Tell the stats system about a deadlock detected.
  * --------
  */
 void
@@ -1471,7 +1188,7 @@ pgstat_report_deadlock(void)
 {
 	PgStat_MsgDeadlock msg;
 
-	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
+	if (!pgstat_track_counts)
 		return;
 
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_DEADLOCK);
@@ -1482,7 +1199,7 @@ pgstat_report_deadlock(void)
 /* --------
  * pgstat_report_tempfile() -
  *
- *	Tell the collector about a temporary file.
+ *	Tell the stats system about a temporary file.
  * --------
  */
 void
@@ -1490,7 +1207,7 @@ pgstat_report_tempfile(size_t filesize)
 {
 	PgStat_MsgTempFile msg;
 
-	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
+	if (!pgstat_track_counts)
 		return;
 
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_TEMPFILE);
@@ -1500,43 +1217,6 @@ pgstat_report_tempfile(size_t filesize)
 }
 
 
-/* ----------
- * pgstat_ping() -
- *
- *	Send some junk data to the collector to increase traffic.
- * ----------
- */
-void
-pgstat_ping(void)
-{
-	PgStat_MsgDummy msg;
-
-	if (pgStatSock == PGINVALID_SOCKET)
-		return;
-
-	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_DUMMY);
-	pgstat_send(&msg, sizeof(msg));
-}
-
-/* ----------
- * pgstat_send_inquiry() -
- *
- *	Notify collector that we need fresh data.
- * ----------
- */
-static void
-pgstat_send_inquiry(TimestampTz clock_time, TimestampTz cutoff_time, Oid databaseid)
-{
-	PgStat_MsgInquiry msg;
-
-	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_INQUIRY);
-	msg.clock_time = clock_time;
-	msg.cutoff_time = cutoff_time;
-	msg.databaseid = databaseid;
-	pgstat_send(&msg, sizeof(msg));
-}
-
-
 /*
  * Initialize function call usage data.
  * Called by the executor before invoking a function.
@@ -1687,7 +1367,7 @@ pgstat_initstats(Relation rel)
 		return;
 	}
 
-	if (pgStatSock == PGINVALID_SOCKET || !pgstat_track_counts)
+	if (!pgstat_track_counts)
 	{
 		/* We're not counting at all */
 		rel->pgstat_info = NULL;
@@ -2238,7 +1918,7 @@ AtPrepare_PgStat(void)
  *
  * All we need do here is unlink the transaction stats state from the
  * nontransactional state.  The nontransactional action counts will be
- * reported to the stats collector immediately, while the effects on live
+ * applied to the shared stats normally, while the effects on live
  * and dead tuple counts are preserved in the 2PC state file.
  *
  * Note: AtEOXact_PgStat is not called during PREPARE.
@@ -2342,18 +2022,18 @@ pgstat_twophase_postabort(TransactionId xid, uint16 info,
  *
  *	Support function for the SQL-callable pgstat* functions. Returns
  *	the collected statistics for one database or NULL. NULL doesn't mean
- *	that the database doesn't exist, it is just not yet known by the
- *	collector, so the caller is better off to report ZERO instead.
+ *	that the database doesn't exist, it is just not yet known to the
+ *	stats system, so the caller is better off to report ZERO instead.
  * ----------
  */
 PgStat_StatDBEntry *
 pgstat_fetch_stat_dbentry(Oid dbid)
 {
 	/*
-	 * If not done for this transaction, read the statistics collector stats
-	 * file into some hash tables.
+	 * If not done for this transaction, take a snapshot of the shared
+	 * statistics.
 	 */
-	backend_read_statsfile();
+	pgstat_build_snapshot();
 
 	/*
 	 * Lookup the requested database; return NULL if not found
@@ -2369,43 +2049,54 @@ pgstat_fetch_stat_dbentry(Oid dbid)
  *
  *	Support function for the SQL-callable pgstat* functions. Returns
  *	the collected statistics for one table or NULL. NULL doesn't mean
- *	that the table doesn't exist, it is just not yet known by the
- *	collector, so the caller is better off to report ZERO instead.
+ *	that the table doesn't exist, it is just not yet known to the
+ *	stats system, so the caller is better off to report ZERO instead.
  * ----------
  */
 PgStat_StatTabEntry *
 pgstat_fetch_stat_tabentry(Oid relid)
 {
-	Oid			dbid;
-	PgStat_StatDBEntry *dbentry;
 	PgStat_StatTabEntry *tabentry;
 
 	/*
-	 * If not done for this transaction, read the statistics collector stats
-	 * file into some hash tables.
+	 * Look in our database first.  If we don't find it there, maybe it's a
+	 * shared table.
 	 */
-	backend_read_statsfile();
+	tabentry = pgstat_fetch_stat_tabentry_ext(false, relid);
+	if (tabentry == NULL)
+		tabentry = pgstat_fetch_stat_tabentry_ext(true, relid);
 
-	/*
-	 * Lookup our database, then look in its table hash table.
-	 */
-	dbid = MyDatabaseId;
-	dbentry = (PgStat_StatDBEntry *) hash_search(pgStatDBHash,
-												 (void *) &dbid,
-												 HASH_FIND, NULL);
-	if (dbentry != NULL && dbentry->tables != NULL)
-	{
-		tabentry = (PgStat_StatTabEntry *) hash_search(dbentry->tables,
-													   (void *) &relid,
-													   HASH_FIND, NULL);
-		if (tabentry)
-			return tabentry;
-	}
+	return tabentry;
+}
+
+
+/* ----------
+ * pgstat_fetch_stat_tabentry_ext() -
+ *
+ *	Like pgstat_fetch_stat_tabentry(), but the caller says whether the
+ *	table is a shared one.
+ *
+ *	Only the requested entry is copied from shared memory, so a caller
+ *	that looks at a few tables doesn't pay for a copy of all of them.
+ * ----------
+ */
+PgStat_StatTabEntry *
+pgstat_fetch_stat_tabentry_ext(bool shared, Oid relid)
+{
+	Oid			dbid = shared ? InvalidOid : MyDatabaseId;
+	PgStat_StatDBEntry *dbentry;
+	PgStat_StatTabEntry *tabentry;
+	PgStat_SharedTabEntry *shtabentry;
+	PgStat_StatTabEntry stats;
+	PgStat_ObjKey key;
 
 	/*
-	 * If we didn't find it, maybe it's a shared table.
+	 * If not done for this transaction, take a snapshot of the shared
+	 * statistics.
 	 */
-	dbid = InvalidOid;
+	pgstat_build_snapshot();
+
+	/* Return the entry if it's been copied already in this transaction */
 	dbentry = (PgStat_StatDBEntry *) hash_search(pgStatDBHash,
 												 (void *) &dbid,
 												 HASH_FIND, NULL);
@@ -2418,7 +2109,26 @@ pgstat_fetch_stat_tabentry(Oid relid)
 			return tabentry;
 	}
 
-	return NULL;
+	if (pgStatSnapshotComplete)
+		return NULL;
+
+	/* Else copy it from the shared table, if it's there */
+	key.databaseid = dbid;
+	key.objectid = relid;
+	shtabentry = (PgStat_SharedTabEntry *) dshash_find(pgStatTabTable,
+													   &key, false);
+	if (shtabentry == NULL)
+		return NULL;
+	memcpy(&stats, &shtabentry->stats, sizeof(PgStat_StatTabEntry));
+	dshash_release_lock(pgStatTabTable, shtabentry);
+
+	dbentry = pgstat_snapshot_db_entry(dbid);
+	tabentry = (PgStat_StatTabEntry *) hash_search(dbentry->tables,
+												   (void *) &relid,
+												   HASH_ENTER, NULL);
+	memcpy(tabentry, &stats, sizeof(PgStat_StatTabEntry));
+
+	return tabentry;
 }
 
 
@@ -2433,10 +2143,13 @@ PgStat_StatFuncEntry *
 pgstat_fetch_stat_funcentry(Oid func_id)
 {
 	PgStat_StatDBEntry *dbentry;
-	PgStat_StatFuncEntry *funcentry = NULL;
+	PgStat_StatFuncEntry *funcentry;
+	PgStat_SharedFuncEntry *shfuncentry;
+	PgStat_StatFuncEntry stats;
+	PgStat_ObjKey key;
 
-	/* load the stats file if needed */
-	backend_read_statsfile();
+	/* take a snapshot of the shared stats if needed */
+	pgstat_build_snapshot();
 
 	/* Lookup our database, then find the requested function.  */
 	dbentry = pgstat_fetch_stat_dbentry(MyDatabaseId);
@@ -2445,8 +2158,29 @@ pgstat_fetch_stat_funcentry(Oid func_id)
 		funcentry = (PgStat_StatFuncEntry *) hash_search(dbentry->functions,
 														 (void *) &func_id,
 														 HASH_FIND, NULL);
+		if (funcentry)
+			return funcentry;
 	}
 
+	if (pgStatSnapshotComplete)
+		return NULL;
+
+	/* Not copied yet; get it from the shared table */
+	key.databaseid = MyDatabaseId;
+	key.objectid = func_id;
+	shfuncentry = (PgStat_SharedFuncEntry *) dshash_find(pgStatFuncTable,
+														 &key, false);
+	if (shfuncentry == NULL)
+		return NULL;
+	memcpy(&stats, &shfuncentry->stats, sizeof(PgStat_StatFuncEntry));
+	dshash_release_lock(pgStatFuncTable, shfuncentry);
+
+	dbentry = pgstat_snapshot_db_entry(MyDatabaseId);
+	funcentry = (PgStat_StatFuncEntry *) hash_search(dbentry->functions,
+													 (void *) &func_id,
+													 HASH_ENTER, NULL);
+	memcpy(funcentry, &stats, sizeof(PgStat_StatFuncEntry));
+
 	return funcentry;
 }
 
@@ -2521,7 +2255,7 @@ pgstat_fetch_stat_numbackends(void)
 PgStat_ArchiverStats *
 pgstat_fetch_stat_archiver(void)
 {
-	backend_read_statsfile();
+	pgstat_build_snapshot();
 
 	return &archiverStats;
 }
@@ -2538,7 +2272,7 @@ pgstat_fetch_stat_archiver(void)
 PgStat_GlobalStats *
 pgstat_fetch_global(void)
 {
-	backend_read_statsfile();
+	pgstat_build_snapshot();
 
 	return &globalStats;
 }
@@ -2729,6 +2463,12 @@ pgstat_initialize(void)
 		MyBEEntry = &BackendStatusArray[MaxBackends + MyAuxProcType];
 	}
 
+	/*
+	 * Set up a process-exit hook to flush our counts to shared memory.  This
+	 * has to run before dynamic shared memory is detached.
+	 */
+	before_shmem_exit(pgstat_shutdown_hook, 0);
+
 	/* Set up a process-exit hook to clean up */
 	on_shmem_exit(pgstat_beshutdown_hook, 0);
 }
@@ -2907,32 +2647,39 @@ pgstat_bestart(void)
 }
 
 /*
- * Shut down a single backend's statistics reporting at process exit.
- *
- * Flush any remaining statistics counts out to the collector.
- * Without this, operations triggered during backend exit (such as
- * temp table deletions) won't be counted.
- *
- * Lastly, clear out our entry in the PgBackendStatus array.
+ * Flush any remaining statistics counts out to the shared stats at process
+ * exit, and release our mapping of them.  Without this, operations triggered
+ * during backend exit (such as temp table deletions) won't be counted.
  */
 static void
-pgstat_beshutdown_hook(int code, Datum arg)
+pgstat_shutdown_hook(int code, Datum arg)
 {
-	volatile PgBackendStatus *beentry = MyBEEntry;
-
 	/*
 	 * If we got as far as discovering our own database ID, we can report what
-	 * we did to the collector.  Otherwise, we'd be sending an invalid
-	 * database ID, so forget it.  (This means that accesses to pg_database
-	 * during failed backend starts might never get counted.)
+	 * we did.  Otherwise, we'd be reporting an invalid database ID, so forget
+	 * it.  (This means that accesses to pg_database during failed backend
+	 * starts might never get counted.)
 	 */
 	if (OidIsValid(MyDatabaseId))
 		pgstat_report_stat(true);
 
-	/*
-	 * Clear my status entry, following the protocol of bumping st_changecount
-	 * before and after.  We use a volatile pointer here to ensure the
-	 * compiler doesn't try to get cute.
+	pgstat_detach_shmem();
+}
+
+/*
+ * Shut down a single backend's statistics reporting at process exit.
+ *
+ * Clear out our entry in the PgBackendStatus array.
+ */
+static void
+pgstat_beshutdown_hook(int code, Datum arg)
+{
+	volatile PgBackendStatus *beentry = MyBEEntry;
+
+	/*
+	 * Clear my status entry, following the protocol of bumping st_changecount
+	 * before and after.  We use a volatile pointer here to ensure the
+	 * compiler doesn't try to get cute.
 	 */
 	pgstat_increment_changecount_before(beentry);
 
@@ -3189,7 +2936,6 @@ pgstat_read_current_status(void)
 #endif
 	int			i;
 
-	Assert(!pgStatRunningInCollector);
 	if (localBackendStatusTable)
 		return;					/* already done */
 
@@ -3444,8 +3190,8 @@ pgstat_get_wait_activity(WaitEventActivity w)
 		case WAIT_EVENT_CHECKPOINTER_MAIN:
 			event_name = "CheckpointerMain";
 			break;
-		case WAIT_EVENT_PGSTAT_MAIN:
-			event_name = "PgStatMain";
+		case WAIT_EVENT_PROXY_MAIN:
+			event_name = "ProxyMain";
 			break;
 		case WAIT_EVENT_RECOVERY_WAL_ALL:
 			event_name = "RecoveryWalAll";
@@ -3530,6 +3276,9 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 
 	switch (w)
 	{
+		case WAIT_EVENT_APPEND_READY:
+			event_name = "AppendReady";
+			break;
 		case WAIT_EVENT_BGWORKER_SHUTDOWN:
 			event_name = "BgWorkerShutdown";
 			break;
@@ -3560,6 +3309,12 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 		case WAIT_EVENT_PARALLEL_BITMAP_SCAN:
 			event_name = "ParallelBitmapScan";
 			break;
+		case WAIT_EVENT_PARALLEL_COPY_CHUNK_FREE:
+			event_name = "ParallelCopyChunkFree";
+			break;
+		case WAIT_EVENT_PARALLEL_COPY_CHUNK_READY:
+			event_name = "ParallelCopyChunkReady";
+			break;
 		case WAIT_EVENT_SAFE_SNAPSHOT:
 			event_name = "SafeSnapshot";
 			break;
@@ -4021,6 +3776,7 @@ pgstat_get_backend_desc(BackendType backendType)
 
 	return backendDesc;
 }
+
 /* ------------------------------------------------------------
  * Local support functions follow
  * ------------------------------------------------------------
@@ -4043,36 +3799,98 @@ pgstat_setheader(PgStat_MsgHdr *hdr, StatMsgType mtype)
 /* ----------
  * pgstat_send() -
  *
- *		Send out one statistics message to the collector
+ *		Apply one statistics message to the shared statistics
  * ----------
  */
 static void
 pgstat_send(void *msg, int len)
 {
-	int			rc;
+	PgStat_MsgHdr *hdr = (PgStat_MsgHdr *) msg;
 
-	if (pgStatSock == PGINVALID_SOCKET)
+	if (pgStatShmem == NULL)
 		return;
 
-	((PgStat_MsgHdr *) msg)->m_size = len;
+	hdr->m_size = len;
 
-	/* We'll retry after EINTR, but ignore all other failures */
-	do
+	switch (hdr->m_type)
 	{
-		rc = send(pgStatSock, msg, len, 0);
-	} while (rc < 0 && errno == EINTR);
+		case PGSTAT_MTYPE_TABSTAT:
+			pgstat_apply_tabstat((PgStat_MsgTabstat *) msg, len);
+			break;
 
-#ifdef USE_ASSERT_CHECKING
-	/* In debug builds, log send failures ... */
-	if (rc < 0)
-		elog(LOG, "could not send to statistics collector: %m");
-#endif
+		case PGSTAT_MTYPE_TABPURGE:
+			pgstat_apply_tabpurge((PgStat_MsgTabpurge *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_DROPDB:
+			pgstat_apply_dropdb((PgStat_MsgDropdb *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_RESETCOUNTER:
+			pgstat_apply_resetcounter((PgStat_MsgResetcounter *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_RESETSHAREDCOUNTER:
+			pgstat_apply_resetsharedcounter((PgStat_MsgResetsharedcounter *) msg,
+											len);
+			break;
+
+		case PGSTAT_MTYPE_RESETSINGLECOUNTER:
+			pgstat_apply_resetsinglecounter((PgStat_MsgResetsinglecounter *) msg,
+											len);
+			break;
+
+		case PGSTAT_MTYPE_AUTOVAC_START:
+			pgstat_apply_autovac((PgStat_MsgAutovacStart *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_VACUUM:
+			pgstat_apply_vacuum((PgStat_MsgVacuum *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_ANALYZE:
+			pgstat_apply_analyze((PgStat_MsgAnalyze *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_ARCHIVER:
+			pgstat_apply_archiver((PgStat_MsgArchiver *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_BGWRITER:
+			pgstat_apply_bgwriter((PgStat_MsgBgWriter *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_FUNCSTAT:
+			pgstat_apply_funcstat((PgStat_MsgFuncstat *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_FUNCPURGE:
+			pgstat_apply_funcpurge((PgStat_MsgFuncpurge *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_RECOVERYCONFLICT:
+			pgstat_apply_recoveryconflict((PgStat_MsgRecoveryConflict *) msg,
+										  len);
+			break;
+
+		case PGSTAT_MTYPE_DEADLOCK:
+			pgstat_apply_deadlock((PgStat_MsgDeadlock *) msg, len);
+			break;
+
+		case PGSTAT_MTYPE_TEMPFILE:
+			pgstat_apply_tempfile((PgStat_MsgTempFile *) msg, len);
+			break;
+
+		default:
+			elog(ERROR, "unrecognized statistics message type: %d",
+				 (int) hdr->m_type);
+	}
 }
 
 /* ----------
  * pgstat_send_archiver() -
  *
- *	Tell the collector about the WAL file that we successfully
+ *	Tell the stats system about the WAL file that we successfully
  *	archived or failed to archive.
  * ----------
  */
@@ -4094,7 +3912,7 @@ pgstat_send_archiver(const char *xlog, bool failed)
 /* ----------
  * pgstat_send_bgwriter() -
  *
- *		Send bgwriter statistics to the collector
+ *		Send bgwriter statistics to the shared statistics
  * ----------
  */
 void
@@ -4105,8 +3923,7 @@ pgstat_send_bgwriter(void)
 
 	/*
 	 * This function can be called even if nothing at all has happened. In
-	 * this case, avoid sending a completely empty message to the stats
-	 * collector.
+	 * this case, avoid taking the lock for a completely empty message.
 	 */
 	if (memcmp(&BgWriterStats, &all_zeroes, sizeof(PgStat_MsgBgWriter)) == 0)
 		return;
@@ -4125,301 +3942,72 @@ pgstat_send_bgwriter(void)
 
 
 /* ----------
- * PgstatCollectorMain() -
- *
- *	Start up the statistics collector process.  This is the body of the
- *	postmaster child process.
+ * pgstat_attach_shmem() -
  *
- *	The argc/argv parameters are valid only in EXEC_BACKEND case.
+ *	Attach to the shared hash tables, if not done already.  The mapping is
+ *	kept for the life of the process and released by pgstat_detach_shmem().
  * ----------
  */
-NON_EXEC_STATIC void
-PgstatCollectorMain(int argc, char *argv[])
+static void
+pgstat_attach_shmem(void)
 {
-	int			len;
-	PgStat_Msg	msg;
-	int			wr;
-
-	/*
-	 * Ignore all signals usually bound to some action in the postmaster,
-	 * except SIGHUP and SIGQUIT.  Note we don't need a SIGUSR1 handler to
-	 * support latch operations, because we only use a local latch.
-	 */
-	pqsignal(SIGHUP, pgstat_sighup_handler);
-	pqsignal(SIGINT, SIG_IGN);
-	pqsignal(SIGTERM, SIG_IGN);
-	pqsignal(SIGQUIT, pgstat_exit);
-	pqsignal(SIGALRM, SIG_IGN);
-	pqsignal(SIGPIPE, SIG_IGN);
-	pqsignal(SIGUSR1, SIG_IGN);
-	pqsignal(SIGUSR2, SIG_IGN);
-	pqsignal(SIGCHLD, SIG_DFL);
-	pqsignal(SIGTTIN, SIG_DFL);
-	pqsignal(SIGTTOU, SIG_DFL);
-	pqsignal(SIGCONT, SIG_DFL);
-	pqsignal(SIGWINCH, SIG_DFL);
-	PG_SETMASK(&UnBlockSig);
-
-	/*
-	 * Identify myself via ps
-	 */
-	init_ps_display("stats collector process", "", "", "");
+	MemoryContext oldcontext;
 
-	/*
-	 * Read in existing stats files or initialize the stats to zero.
-	 */
-	pgStatRunningInCollector = true;
-	pgStatDBHash = pgstat_read_statsfiles(InvalidOid, true, true);
-
-	/*
-	 * Loop to process messages until we get SIGQUIT or detect ungraceful
-	 * death of our parent postmaster.
-	 *
-	 * For performance reasons, we don't want to do ResetLatch/WaitLatch after
-	 * every message; instead, do that only after a recv() fails to obtain a
-	 * message.  (This effectively means that if backends are sending us stuff
-	 * like mad, we won't notice postmaster death until things slack off a
-	 * bit; which seems fine.)	To do that, we have an inner loop that
-	 * iterates as long as recv() succeeds.  We do recognize got_SIGHUP inside
-	 * the inner loop, which means that such interrupts will get serviced but
-	 * the latch won't get cleared until next time there is a break in the
-	 * action.
-	 */
-	for (;;)
-	{
-		/* Clear any already-pending wakeups */
-		ResetLatch(MyLatch);
-
-		/*
-		 * Quit if we get SIGQUIT from the postmaster.
-		 */
-		if (need_exit)
-			break;
-
-		/*
-		 * Inner loop iterates as long as we keep getting messages, or until
-		 * need_exit becomes set.
-		 */
-		while (!need_exit)
-		{
-			/*
-			 * Reload configuration if we got SIGHUP from the postmaster.
-			 */
-			if (got_SIGHUP)
-			{
-				got_SIGHUP = false;
-				ProcessConfigFile(PGC_SIGHUP);
-			}
-
-			/*
-			 * Write the stats file(s) if a new request has arrived that is
-			 * not satisfied by existing file(s).
-			 */
-			if (pgstat_write_statsfile_needed())
-				pgstat_write_statsfiles(false, false);
-
-			/*
-			 * Try to receive and process a message.  This will not block,
-			 * since the socket is set to non-blocking mode.
-			 *
-			 * XXX On Windows, we have to force pgwin32_recv to cooperate,
-			 * despite the previous use of pg_set_noblock() on the socket.
-			 * This is extremely broken and should be fixed someday.
-			 */
-#ifdef WIN32
-			pgwin32_noblock = 1;
-#endif
-
-			len = recv(pgStatSock, (char *) &msg,
-					   sizeof(PgStat_Msg), 0);
-
-#ifdef WIN32
-			pgwin32_noblock = 0;
-#endif
-
-			if (len < 0)
-			{
-				if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
-					break;		/* out of inner loop */
-				ereport(ERROR,
-						(errcode_for_socket_access(),
-						 errmsg("could not read statistics message: %m")));
-			}
-
-			/*
-			 * We ignore messages that are smaller than our common header
-			 */
-			if (len < sizeof(PgStat_MsgHdr))
-				continue;
-
-			/*
-			 * The received length must match the length in the header
-			 */
-			if (msg.msg_hdr.m_size != len)
-				continue;
+	if (pgStatDSA != NULL)
+		return;
 
-			/*
-			 * O.K. - we accept this message.  Process it.
-			 */
-			switch (msg.msg_hdr.m_type)
-			{
-				case PGSTAT_MTYPE_DUMMY:
-					break;
-
-				case PGSTAT_MTYPE_INQUIRY:
-					pgstat_recv_inquiry((PgStat_MsgInquiry *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_TABSTAT:
-					pgstat_recv_tabstat((PgStat_MsgTabstat *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_TABPURGE:
-					pgstat_recv_tabpurge((PgStat_MsgTabpurge *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_DROPDB:
-					pgstat_recv_dropdb((PgStat_MsgDropdb *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_RESETCOUNTER:
-					pgstat_recv_resetcounter((PgStat_MsgResetcounter *) &msg,
-											 len);
-					break;
-
-				case PGSTAT_MTYPE_RESETSHAREDCOUNTER:
-					pgstat_recv_resetsharedcounter(
-									   (PgStat_MsgResetsharedcounter *) &msg,
-												   len);
-					break;
-
-				case PGSTAT_MTYPE_RESETSINGLECOUNTER:
-					pgstat_recv_resetsinglecounter(
-									   (PgStat_MsgResetsinglecounter *) &msg,
-												   len);
-					break;
-
-				case PGSTAT_MTYPE_AUTOVAC_START:
-					pgstat_recv_autovac((PgStat_MsgAutovacStart *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_VACUUM:
-					pgstat_recv_vacuum((PgStat_MsgVacuum *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_ANALYZE:
-					pgstat_recv_analyze((PgStat_MsgAnalyze *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_ARCHIVER:
-					pgstat_recv_archiver((PgStat_MsgArchiver *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_BGWRITER:
-					pgstat_recv_bgwriter((PgStat_MsgBgWriter *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_FUNCSTAT:
-					pgstat_recv_funcstat((PgStat_MsgFuncstat *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_FUNCPURGE:
-					pgstat_recv_funcpurge((PgStat_MsgFuncpurge *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_RECOVERYCONFLICT:
-					pgstat_recv_recoveryconflict((PgStat_MsgRecoveryConflict *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_DEADLOCK:
-					pgstat_recv_deadlock((PgStat_MsgDeadlock *) &msg, len);
-					break;
-
-				case PGSTAT_MTYPE_TEMPFILE:
-					pgstat_recv_tempfile((PgStat_MsgTempFile *) &msg, len);
-					break;
-
-				default:
-					break;
-			}
-		}						/* end of inner message-processing loop */
-
-		/* Sleep until there's something to do */
-#ifndef WIN32
-		wr = WaitLatchOrSocket(MyLatch,
-					 WL_LATCH_SET | WL_POSTMASTER_DEATH | WL_SOCKET_READABLE,
-							   pgStatSock, -1L,
-							   WAIT_EVENT_PGSTAT_MAIN);
-#else
+	Assert(pgStatShmem != NULL);
 
-		/*
-		 * Windows, at least in its Windows Server 2003 R2 incarnation,
-		 * sometimes loses FD_READ events.  Waking up and retrying the recv()
-		 * fixes that, so don't sleep indefinitely.  This is a crock of the
-		 * first water, but until somebody wants to debug exactly what's
-		 * happening there, this is the best we can do.  The two-second
-		 * timeout matches our pre-9.2 behavior, and needs to be short enough
-		 * to not provoke "using stale statistics" complaints from
-		 * backend_read_statsfile.
-		 */
-		wr = WaitLatchOrSocket(MyLatch,
-		WL_LATCH_SET | WL_POSTMASTER_DEATH | WL_SOCKET_READABLE | WL_TIMEOUT,
-							   pgStatSock,
-							   2 * 1000L /* msec */,
-							   WAIT_EVENT_PGSTAT_MAIN);
-#endif
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
 
-		/*
-		 * Emergency bailout if postmaster has died.  This is to avoid the
-		 * necessity for manual cleanup of all postmaster children.
-		 */
-		if (wr & WL_POSTMASTER_DEATH)
-			break;
-	}							/* end of outer loop */
+	pgStatDSA = dsa_attach_in_place(PgStatDSAPlace(), NULL);
+	dsa_pin_mapping(pgStatDSA);
 
-	/*
-	 * Save the final stats to reuse at next startup.
-	 */
-	pgstat_write_statsfiles(true, true);
+	pgStatDBTable = dshash_attach(pgStatDSA, &dsh_dbparams,
+								  pgStatShmem->db_hash_handle, NULL);
+	pgStatTabTable = dshash_attach(pgStatDSA, &dsh_tabparams,
+								   pgStatShmem->tab_hash_handle, NULL);
+	pgStatFuncTable = dshash_attach(pgStatDSA, &dsh_funcparams,
+									pgStatShmem->func_hash_handle, NULL);
 
-	exit(0);
+	MemoryContextSwitchTo(oldcontext);
 }
 
-
-/* SIGQUIT signal handler for collector process */
+/* ----------
+ * pgstat_detach_shmem() -
+ *
+ *	Release our mapping of the shared hash tables.  Since no DSM segment was
+ *	given to dsa_attach_in_place(), we must drop our reference by hand.
+ * ----------
+ */
 static void
-pgstat_exit(SIGNAL_ARGS)
+pgstat_detach_shmem(void)
 {
-	int			save_errno = errno;
+	if (pgStatDSA == NULL)
+		return;
 
-	need_exit = true;
-	SetLatch(MyLatch);
+	dshash_detach(pgStatDBTable);
+	dshash_detach(pgStatTabTable);
+	dshash_detach(pgStatFuncTable);
+	dsa_detach(pgStatDSA);
+	dsa_release_in_place(PgStatDSAPlace());
 
-	errno = save_errno;
+	pgStatDBTable = NULL;
+	pgStatTabTable = NULL;
+	pgStatFuncTable = NULL;
+	pgStatDSA = NULL;
 }
 
-/* SIGHUP handler for collector process */
-static void
-pgstat_sighup_handler(SIGNAL_ARGS)
-{
-	int			save_errno = errno;
-
-	got_SIGHUP = true;
-	SetLatch(MyLatch);
-
-	errno = save_errno;
-}
 
 /*
  * Subroutine to clear stats in a database entry
  *
- * Tables and functions hashes are initialized to empty.
+ * The tables and functions pointers are only used by backend-local
+ * snapshots; in shared memory they are always NULL.
  */
 static void
 reset_dbentry_counters(PgStat_StatDBEntry *dbentry)
 {
-	HASHCTL		hash_ctl;
-
 	dbentry->n_xact_commit = 0;
 	dbentry->n_xact_rollback = 0;
 	dbentry->n_blocks_fetched = 0;
@@ -4444,127 +4032,127 @@ reset_dbentry_counters(PgStat_StatDBEntry *dbentry)
 	dbentry->stat_reset_timestamp = GetCurrentTimestamp();
 	dbentry->stats_timestamp = 0;
 
-	memset(&hash_ctl, 0, sizeof(hash_ctl));
-	hash_ctl.keysize = sizeof(Oid);
-	hash_ctl.entrysize = sizeof(PgStat_StatTabEntry);
-	dbentry->tables = hash_create("Per-database table",
-								  PGSTAT_TAB_HASH_SIZE,
-								  &hash_ctl,
-								  HASH_ELEM | HASH_BLOBS);
-
-	hash_ctl.keysize = sizeof(Oid);
-	hash_ctl.entrysize = sizeof(PgStat_StatFuncEntry);
-	dbentry->functions = hash_create("Per-database function",
-									 PGSTAT_FUNCTION_HASH_SIZE,
-									 &hash_ctl,
-									 HASH_ELEM | HASH_BLOBS);
+	dbentry->tables = NULL;
+	dbentry->functions = NULL;
 }
 
 /*
- * Lookup the hash table entry for the specified database. If no hash
- * table entry exists, initialize it, if the create parameter is true.
- * Else, return NULL.
+ * Lookup the shared entry for the specified database. If no entry exists,
+ * initialize it, if the create parameter is true.  Else, return NULL.
+ *
+ * The entry is returned locked; the caller must release it with
+ * dshash_release_lock() before touching any other shared entry.
  */
 static PgStat_StatDBEntry *
 pgstat_get_db_entry(Oid databaseid, bool create)
 {
 	PgStat_StatDBEntry *result;
 	bool		found;
-	HASHACTION	action = (create ? HASH_ENTER : HASH_FIND);
 
-	/* Lookup or create the hash table entry for this database */
-	result = (PgStat_StatDBEntry *) hash_search(pgStatDBHash,
-												&databaseid,
-												action, &found);
+	pgstat_attach_shmem();
 
-	if (!create && !found)
-		return NULL;
+	if (!create)
+		return (PgStat_StatDBEntry *) dshash_find(pgStatDBTable,
+												  &databaseid, true);
 
-	/*
-	 * If not found, initialize the new one.  This creates empty hash tables
-	 * for tables and functions, too.
-	 */
+	result = (PgStat_StatDBEntry *) dshash_find_or_insert(pgStatDBTable,
+														  &databaseid,
+														  &found);
 	if (!found)
 		reset_dbentry_counters(result);
 
 	return result;
 }
 
-
 /*
- * Lookup the hash table entry for the specified table. If no hash
- * table entry exists, initialize it, if the create parameter is true.
- * Else, return NULL.
+ * Lookup the shared entry for the specified table. If no entry exists,
+ * initialize it, if the create parameter is true.  Else, return NULL.
+ *
+ * As with pgstat_get_db_entry, the entry is returned locked.
  */
-static PgStat_StatTabEntry *
-pgstat_get_tab_entry(PgStat_StatDBEntry *dbentry, Oid tableoid, bool create)
+static PgStat_SharedTabEntry *
+pgstat_get_tab_entry(Oid databaseid, Oid tableoid, bool create)
 {
-	PgStat_StatTabEntry *result;
+	PgStat_SharedTabEntry *result;
+	PgStat_ObjKey key;
 	bool		found;
-	HASHACTION	action = (create ? HASH_ENTER : HASH_FIND);
 
-	/* Lookup or create the hash table entry for this table */
-	result = (PgStat_StatTabEntry *) hash_search(dbentry->tables,
-												 &tableoid,
-												 action, &found);
+	pgstat_attach_shmem();
 
-	if (!create && !found)
-		return NULL;
+	key.databaseid = databaseid;
+	key.objectid = tableoid;
+
+	if (!create)
+		return (PgStat_SharedTabEntry *) dshash_find(pgStatTabTable,
+													 &key, true);
+
+	result = (PgStat_SharedTabEntry *) dshash_find_or_insert(pgStatTabTable,
+															 &key, &found);
 
 	/* If not found, initialize the new one. */
 	if (!found)
 	{
-		result->numscans = 0;
-		result->tuples_returned = 0;
-		result->tuples_fetched = 0;
-		result->tuples_inserted = 0;
-		result->tuples_updated = 0;
-		result->tuples_deleted = 0;
-		result->tuples_hot_updated = 0;
-		result->n_live_tuples = 0;
-		result->n_dead_tuples = 0;
-		result->changes_since_analyze = 0;
-		result->blocks_fetched = 0;
-		result->blocks_hit = 0;
-		result->vacuum_timestamp = 0;
-		result->vacuum_count = 0;
-		result->autovac_vacuum_timestamp = 0;
-		result->autovac_vacuum_count = 0;
-		result->analyze_timestamp = 0;
-		result->analyze_count = 0;
-		result->autovac_analyze_timestamp = 0;
-		result->autovac_analyze_count = 0;
+		MemSet(&result->stats, 0, sizeof(PgStat_StatTabEntry));
+		result->stats.tableid = tableoid;
 	}
 
 	return result;
 }
 
+/*
+ * Remove all table and function entries belonging to a database.
+ */
+static void
+pgstat_remove_db_objects(Oid databaseid)
+{
+	dshash_seq_status status;
+	PgStat_SharedTabEntry *tabentry;
+	PgStat_SharedFuncEntry *funcentry;
+
+	dshash_seq_init(&status, pgStatTabTable, true);
+	while ((tabentry = dshash_seq_next(&status)) != NULL)
+	{
+		if (tabentry->key.databaseid == databaseid)
+			dshash_delete_current(&status);
+	}
+	dshash_seq_term(&status);
+
+	dshash_seq_init(&status, pgStatFuncTable, true);
+	while ((funcentry = dshash_seq_next(&status)) != NULL)
+	{
+		if (funcentry->key.databaseid == databaseid)
+			dshash_delete_current(&status);
+	}
+	dshash_seq_term(&status);
+}
+
 
 /* ----------
- * pgstat_write_statsfiles() -
- *		Write the global statistics file, as well as requested DB files.
- *
- *	'permanent' specifies writing to the permanent files not temporary ones.
- *	When true (happens only when the collector is shutting down), also remove
- *	the temporary files so that backends starting up under a new postmaster
- *	can't read old data before the new collector is ready.
+ * pgstat_save_stats() -
  *
- *	When 'allDbs' is false, only the requested databases (listed in
- *	pending_write_requests) will be written; otherwise, all databases
- *	will be written.
+ *	Write the shared statistics to the permanent stats file.  Called by the
+ *	checkpointer after the shutdown checkpoint, or by a standalone backend
+ *	at exit; no other process should be updating the statistics by then.
  * ----------
  */
-static void
-pgstat_write_statsfiles(bool permanent, bool allDbs)
+void
+pgstat_save_stats(void)
 {
-	HASH_SEQ_STATUS hstat;
+	dshash_seq_status status;
 	PgStat_StatDBEntry *dbentry;
+	PgStat_SharedTabEntry *tabentry;
+	PgStat_SharedFuncEntry *funcentry;
+	PgStat_GlobalStats myGlobalStats;
+	PgStat_ArchiverStats myArchiverStats;
 	FILE	   *fpout;
 	int32		format_id;
-	const char *tmpfile = permanent ? PGSTAT_STAT_PERMANENT_TMPFILE : pgstat_stat_tmpname;
-	const char *statfile = permanent ? PGSTAT_STAT_PERMANENT_FILENAME : pgstat_stat_filename;
+	const char *tmpfile = PGSTAT_STAT_PERMANENT_TMPFILE;
+	const char *statfile = PGSTAT_STAT_PERMANENT_FILENAME;
 	int			rc;
 
+	if (pgStatShmem == NULL)
+		return;
+
 	elog(DEBUG2, "writing stats file \"%s\"", statfile);
 
 	/*
@@ -4580,10 +4168,16 @@ pgstat_write_statsfiles(bool permanent, bool allDbs)
 		return;
 	}
 
+	SpinLockAcquire(&pgStatShmem->mutex);
+	memcpy(&myGlobalStats, &pgStatShmem->globalStats, sizeof(myGlobalStats));
+	memcpy(&myArchiverStats, &pgStatShmem->archiverStats,
+		   sizeof(myArchiverStats));
+	SpinLockRelease(&pgStatShmem->mutex);
+
 	/*
 	 * Set the timestamp of the stats file.
 	 */
-	globalStats.stats_timestamp = GetCurrentTimestamp();
+	myGlobalStats.stats_timestamp = GetCurrentTimestamp();
 
 	/*
 	 * Write the file header --- currently just a format ID.
@@ -4595,45 +4189,61 @@ pgstat_write_statsfiles(bool permanent, bool allDbs)
 	/*
 	 * Write global stats struct
 	 */
-	rc = fwrite(&globalStats, sizeof(globalStats), 1, fpout);
+	rc = fwrite(&myGlobalStats, sizeof(myGlobalStats), 1, fpout);
 	(void) rc;					/* we'll check for error with ferror */
 
 	/*
 	 * Write archiver stats struct
 	 */
-	rc = fwrite(&archiverStats, sizeof(archiverStats), 1, fpout);
+	rc = fwrite(&myArchiverStats, sizeof(myArchiverStats), 1, fpout);
 	(void) rc;					/* we'll check for error with ferror */
 
+	pgstat_attach_shmem();
+
 	/*
-	 * Walk through the database table.
+	 * Walk through the database table.  We don't write the tables or
+	 * functions pointers, since they're of no use to any other process.
 	 */
-	hash_seq_init(&hstat, pgStatDBHash);
-	while ((dbentry = (PgStat_StatDBEntry *) hash_seq_search(&hstat)) != NULL)
+	dshash_seq_init(&status, pgStatDBTable, false);
+	while ((dbentry = dshash_seq_next(&status)) != NULL)
 	{
-		/*
-		 * Write out the table and function stats for this DB into the
-		 * appropriate per-DB stat file, if required.
-		 */
-		if (allDbs || pgstat_db_requested(dbentry->databaseid))
-		{
-			/* Make DB's timestamp consistent with the global stats */
-			dbentry->stats_timestamp = globalStats.stats_timestamp;
-
-			pgstat_write_db_statsfile(dbentry, permanent);
-		}
-
-		/*
-		 * Write out the DB entry. We don't write the tables or functions
-		 * pointers, since they're of no use to any other process.
-		 */
 		fputc('D', fpout);
 		rc = fwrite(dbentry, offsetof(PgStat_StatDBEntry, tables), 1, fpout);
 		(void) rc;				/* we'll check for error with ferror */
 	}
+	dshash_seq_term(&status);
+
+	/*
+	 * Walk through the per-table stats, each preceded by its database OID.
+	 */
+	dshash_seq_init(&status, pgStatTabTable, false);
+	while ((tabentry = dshash_seq_next(&status)) != NULL)
+	{
+		fputc('T', fpout);
+		rc = fwrite(&tabentry->key.databaseid, sizeof(Oid), 1, fpout);
+		(void) rc;				/* we'll check for error with ferror */
+		rc = fwrite(&tabentry->stats, sizeof(PgStat_StatTabEntry), 1, fpout);
+		(void) rc;				/* we'll check for error with ferror */
+	}
+	dshash_seq_term(&status);
+
+	/*
+	 * Likewise for the per-function stats.
+	 */
+	dshash_seq_init(&status, pgStatFuncTable, false);
+	while ((funcentry = dshash_seq_next(&status)) != NULL)
+	{
+		fputc('F', fpout);
+		rc = fwrite(&funcentry->key.databaseid, sizeof(Oid), 1, fpout);
+		(void) rc;				/* we'll check for error with ferror */
+		rc = fwrite(&funcentry->stats, sizeof(PgStat_StatFuncEntry), 1, fpout);
+		(void) rc;				/* we'll check for error with ferror */
+	}
+	dshash_seq_term(&status);
 
 	/*
 	 * No more output to be done. Close the temp file and replace the old
-	 * pgstat.stat with it.  The ferror() check replaces testing for error
+	 * global.stat with it.  The ferror() check replaces testing for error
 	 * after each individual fputc or fwrite above.
 	 */
 	fputc('E', fpout);
@@ -4663,267 +4273,85 @@ pgstat_write_statsfiles(bool permanent, bool allDbs)
 						tmpfile, statfile)));
 		unlink(tmpfile);
 	}
-
-	if (permanent)
-		unlink(pgstat_stat_filename);
-
-	/*
-	 * Now throw away the list of requests.  Note that requests sent after we
-	 * started the write are still waiting on the network socket.
-	 */
-	list_free(pending_write_requests);
-	pending_write_requests = NIL;
-}
-
-/*
- * return the filename for a DB stat file; filename is the output buffer,
- * of length len.
- */
-static void
-get_dbstat_filename(bool permanent, bool tempname, Oid databaseid,
-					char *filename, int len)
-{
-	int			printed;
-
-	/* NB -- pgstat_reset_remove_files knows about the pattern this uses */
-	printed = snprintf(filename, len, "%s/db_%u.%s",
-					   permanent ? PGSTAT_STAT_PERMANENT_DIRECTORY :
-					   pgstat_stat_directory,
-					   databaseid,
-					   tempname ? "tmp" : "stat");
-	if (printed > len)
-		elog(ERROR, "overlength pgstat path");
 }
 
 /* ----------
- * pgstat_write_db_statsfile() -
- *		Write the stat file for a single database.
+ * pgstat_restore_stats() -
  *
- *	If writing to the permanent file (happens when the collector is
- *	shutting down only), remove the temporary file so that backends
- *	starting up under a new postmaster can't read the old data before
- *	the new collector is ready.
+ *	Load the statistics saved by pgstat_save_stats() into shared memory.
+ *	Called by the startup process when no WAL replay is needed, before any
+ *	backend can report statistics.  The file is removed afterwards, since
+ *	the shared memory contents are now authoritative.
  * ----------
  */
-static void
-pgstat_write_db_statsfile(PgStat_StatDBEntry *dbentry, bool permanent)
+void
+pgstat_restore_stats(void)
 {
-	HASH_SEQ_STATUS tstat;
-	HASH_SEQ_STATUS fstat;
-	PgStat_StatTabEntry *tabentry;
-	PgStat_StatFuncEntry *funcentry;
-	FILE	   *fpout;
+	PgStat_StatDBEntry dbbuf;
+	PgStat_StatTabEntry tabbuf;
+	PgStat_StatFuncEntry funcbuf;
+	PgStat_GlobalStats myGlobalStats;
+	PgStat_ArchiverStats myArchiverStats;
+	PgStat_ObjKey key;
+	FILE	   *fpin;
 	int32		format_id;
-	Oid			dbid = dbentry->databaseid;
-	int			rc;
-	char		tmpfile[MAXPGPATH];
-	char		statfile[MAXPGPATH];
-
-	get_dbstat_filename(permanent, true, dbid, tmpfile, MAXPGPATH);
-	get_dbstat_filename(permanent, false, dbid, statfile, MAXPGPATH);
+	bool		found;
+	const char *statfile = PGSTAT_STAT_PERMANENT_FILENAME;
 
-	elog(DEBUG2, "writing stats file \"%s\"", statfile);
+	Assert(pgStatShmem != NULL);
 
 	/*
-	 * Open the statistics temp file to write out the current values.
+	 * Try to open the stats file.  If it doesn't exist, we simply start from
+	 * scratch with empty counters.  Any other failure condition is
+	 * suspicious.
 	 */
-	fpout = AllocateFile(tmpfile, PG_BINARY_W);
-	if (fpout == NULL)
+	if ((fpin = AllocateFile(statfile, PG_BINARY_R)) == NULL)
 	{
-		ereport(LOG,
-				(errcode_for_file_access(),
-				 errmsg("could not open temporary statistics file \"%s\": %m",
-						tmpfile)));
+		if (errno != ENOENT)
+			ereport(LOG,
+					(errcode_for_file_access(),
+					 errmsg("could not open statistics file \"%s\": %m",
+							statfile)));
 		return;
 	}
 
 	/*
-	 * Write the file header --- currently just a format ID.
+	 * Verify it's of the expected format.
 	 */
-	format_id = PGSTAT_FILE_FORMAT_ID;
-	rc = fwrite(&format_id, sizeof(format_id), 1, fpout);
-	(void) rc;					/* we'll check for error with ferror */
+	if (fread(&format_id, 1, sizeof(format_id), fpin) != sizeof(format_id) ||
+		format_id != PGSTAT_FILE_FORMAT_ID)
+	{
+		ereport(LOG,
+				(errmsg("corrupted statistics file \"%s\"", statfile)));
+		goto done;
+	}
 
 	/*
-	 * Walk through the database's access stats per table.
+	 * Read global and archiver stats structs
 	 */
-	hash_seq_init(&tstat, dbentry->tables);
-	while ((tabentry = (PgStat_StatTabEntry *) hash_seq_search(&tstat)) != NULL)
+	if (fread(&myGlobalStats, 1, sizeof(myGlobalStats),
+			  fpin) != sizeof(myGlobalStats) ||
+		fread(&myArchiverStats, 1, sizeof(myArchiverStats),
+			  fpin) != sizeof(myArchiverStats))
 	{
-		fputc('T', fpout);
-		rc = fwrite(tabentry, sizeof(PgStat_StatTabEntry), 1, fpout);
-		(void) rc;				/* we'll check for error with ferror */
+		ereport(LOG,
+				(errmsg("corrupted statistics file \"%s\"", statfile)));
+		goto done;
 	}
 
+	SpinLockAcquire(&pgStatShmem->mutex);
+	memcpy(&pgStatShmem->globalStats, &myGlobalStats, sizeof(myGlobalStats));
+	memcpy(&pgStatShmem->archiverStats, &myArchiverStats,
+		   sizeof(myArchiverStats));
+	SpinLockRelease(&pgStatShmem->mutex);
+
+	pgstat_attach_shmem();
+
 	/*
-	 * Walk through the database's function stats table.
+	 * We found an existing stats file. Read it and put all the hashtable
+	 * entries into place.
 	 */
-	hash_seq_init(&fstat, dbentry->functions);
-	while ((funcentry = (PgStat_StatFuncEntry *) hash_seq_search(&fstat)) != NULL)
-	{
-		fputc('F', fpout);
-		rc = fwrite(funcentry, sizeof(PgStat_StatFuncEntry), 1, fpout);
-		(void) rc;				/* we'll check for error with ferror */
-	}
-
-	/*
-	 * No more output to be done. Close the temp file and replace the old
-	 * pgstat.stat with it.  The ferror() check replaces testing for error
-	 * after each individual fputc or fwrite above.
-	 */
-	fputc('E', fpout);
-
-	if (ferror(fpout))
-	{
-		ereport(LOG,
-				(errcode_for_file_access(),
-			   errmsg("could not write temporary statistics file \"%s\": %m",
-					  tmpfile)));
-		FreeFile(fpout);
-		unlink(tmpfile);
-	}
-	else if (FreeFile(fpout) < 0)
-	{
-		ereport(LOG,
-				(errcode_for_file_access(),
-			   errmsg("could not close temporary statistics file \"%s\": %m",
-					  tmpfile)));
-		unlink(tmpfile);
-	}
-	else if (rename(tmpfile, statfile) < 0)
-	{
-		ereport(LOG,
-				(errcode_for_file_access(),
-				 errmsg("could not rename temporary statistics file \"%s\" to \"%s\": %m",
-						tmpfile, statfile)));
-		unlink(tmpfile);
-	}
-
-	if (permanent)
-	{
-		get_dbstat_filename(false, false, dbid, statfile, MAXPGPATH);
-
-		elog(DEBUG2, "removing temporary stats file \"%s\"", statfile);
-		unlink(statfile);
-	}
-}
-
-/* ----------
- * pgstat_read_statsfiles() -
- *
- *	Reads in some existing statistics collector files and returns the
- *	databases hash table that is the top level of the data.
- *
- *	If 'onlydb' is not InvalidOid, it means we only want data for that DB
- *	plus the shared catalogs ("DB 0").  We'll still populate the DB hash
- *	table for all databases, but we don't bother even creating table/function
- *	hash tables for other databases.
- *
- *	'permanent' specifies reading from the permanent files not temporary ones.
- *	When true (happens only when the collector is starting up), remove the
- *	files after reading; the in-memory status is now authoritative, and the
- *	files would be out of date in case somebody else reads them.
- *
- *	If a 'deep' read is requested, table/function stats are read, otherwise
- *	the table/function hash tables remain empty.
- * ----------
- */
-static HTAB *
-pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
-{
-	PgStat_StatDBEntry *dbentry;
-	PgStat_StatDBEntry dbbuf;
-	HASHCTL		hash_ctl;
-	HTAB	   *dbhash;
-	FILE	   *fpin;
-	int32		format_id;
-	bool		found;
-	const char *statfile = permanent ? PGSTAT_STAT_PERMANENT_FILENAME : pgstat_stat_filename;
-
-	/*
-	 * The tables will live in pgStatLocalContext.
-	 */
-	pgstat_setup_memcxt();
-
-	/*
-	 * Create the DB hashtable
-	 */
-	memset(&hash_ctl, 0, sizeof(hash_ctl));
-	hash_ctl.keysize = sizeof(Oid);
-	hash_ctl.entrysize = sizeof(PgStat_StatDBEntry);
-	hash_ctl.hcxt = pgStatLocalContext;
-	dbhash = hash_create("Databases hash", PGSTAT_DB_HASH_SIZE, &hash_ctl,
-						 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
-
-	/*
-	 * Clear out global and archiver statistics so they start from zero in
-	 * case we can't load an existing statsfile.
-	 */
-	memset(&globalStats, 0, sizeof(globalStats));
-	memset(&archiverStats, 0, sizeof(archiverStats));
-
-	/*
-	 * Set the current timestamp (will be kept only in case we can't load an
-	 * existing statsfile).
-	 */
-	globalStats.stat_reset_timestamp = GetCurrentTimestamp();
-	archiverStats.stat_reset_timestamp = globalStats.stat_reset_timestamp;
-
-	/*
-	 * Try to open the stats file. If it doesn't exist, the backends simply
-	 * return zero for anything and the collector simply starts from scratch
-	 * with empty counters.
-	 *
-	 * ENOENT is a possibility if the stats collector is not running or has
-	 * not yet written the stats file the first time.  Any other failure
-	 * condition is suspicious.
-	 */
-	if ((fpin = AllocateFile(statfile, PG_BINARY_R)) == NULL)
-	{
-		if (errno != ENOENT)
-			ereport(pgStatRunningInCollector ? LOG : WARNING,
-					(errcode_for_file_access(),
-					 errmsg("could not open statistics file \"%s\": %m",
-							statfile)));
-		return dbhash;
-	}
-
-	/*
-	 * Verify it's of the expected format.
-	 */
-	if (fread(&format_id, 1, sizeof(format_id), fpin) != sizeof(format_id) ||
-		format_id != PGSTAT_FILE_FORMAT_ID)
-	{
-		ereport(pgStatRunningInCollector ? LOG : WARNING,
-				(errmsg("corrupted statistics file \"%s\"", statfile)));
-		goto done;
-	}
-
-	/*
-	 * Read global stats struct
-	 */
-	if (fread(&globalStats, 1, sizeof(globalStats), fpin) != sizeof(globalStats))
-	{
-		ereport(pgStatRunningInCollector ? LOG : WARNING,
-				(errmsg("corrupted statistics file \"%s\"", statfile)));
-		goto done;
-	}
-
-	/*
-	 * Read archiver stats struct
-	 */
-	if (fread(&archiverStats, 1, sizeof(archiverStats), fpin) != sizeof(archiverStats))
-	{
-		ereport(pgStatRunningInCollector ? LOG : WARNING,
-				(errmsg("corrupted statistics file \"%s\"", statfile)));
-		goto done;
-	}
-
-	/*
-	 * We found an existing collector stats file. Read it and put all the
-	 * hashtable entries into place.
-	 */
-	for (;;)
+	for (;;)
 	{
 		switch (fgetc(fpin))
 		{
@@ -4932,232 +4360,103 @@ pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
 				 * follows.
 				 */
 			case 'D':
-				if (fread(&dbbuf, 1, offsetof(PgStat_StatDBEntry, tables),
-						  fpin) != offsetof(PgStat_StatDBEntry, tables))
 				{
-					ereport(pgStatRunningInCollector ? LOG : WARNING,
-							(errmsg("corrupted statistics file \"%s\"",
-									statfile)));
-					goto done;
-				}
+					PgStat_StatDBEntry *dbentry;
 
-				/*
-				 * Add to the DB hash
-				 */
-				dbentry = (PgStat_StatDBEntry *) hash_search(dbhash,
-												  (void *) &dbbuf.databaseid,
-															 HASH_ENTER,
-															 &found);
-				if (found)
-				{
-					ereport(pgStatRunningInCollector ? LOG : WARNING,
-							(errmsg("corrupted statistics file \"%s\"",
-									statfile)));
-					goto done;
-				}
+					if (fread(&dbbuf, 1, offsetof(PgStat_StatDBEntry, tables),
+							  fpin) != offsetof(PgStat_StatDBEntry, tables))
+					{
+						ereport(LOG,
+								(errmsg("corrupted statistics file \"%s\"",
+										statfile)));
+						goto done;
+					}
 
-				memcpy(dbentry, &dbbuf, sizeof(PgStat_StatDBEntry));
-				dbentry->tables = NULL;
-				dbentry->functions = NULL;
+					dbentry = (PgStat_StatDBEntry *)
+						dshash_find_or_insert(pgStatDBTable,
+											  &dbbuf.databaseid, &found);
+					memcpy(dbentry, &dbbuf,
+						   offsetof(PgStat_StatDBEntry, tables));
+					dbentry->tables = NULL;
+					dbentry->functions = NULL;
+					dshash_release_lock(pgStatDBTable, dbentry);
 
-				/*
-				 * Don't create tables/functions hashtables for uninteresting
-				 * databases.
-				 */
-				if (onlydb != InvalidOid)
-				{
-					if (dbbuf.databaseid != onlydb &&
-						dbbuf.databaseid != InvalidOid)
-						break;
+					if (found)
+					{
+						ereport(LOG,
+								(errmsg("corrupted statistics file \"%s\"",
+										statfile)));
+						goto done;
+					}
 				}
-
-				memset(&hash_ctl, 0, sizeof(hash_ctl));
-				hash_ctl.keysize = sizeof(Oid);
-				hash_ctl.entrysize = sizeof(PgStat_StatTabEntry);
-				hash_ctl.hcxt = pgStatLocalContext;
-				dbentry->tables = hash_create("Per-database table",
-											  PGSTAT_TAB_HASH_SIZE,
-											  &hash_ctl,
-									  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
-
-				hash_ctl.keysize = sizeof(Oid);
-				hash_ctl.entrysize = sizeof(PgStat_StatFuncEntry);
-				hash_ctl.hcxt = pgStatLocalContext;
-				dbentry->functions = hash_create("Per-database function",
-												 PGSTAT_FUNCTION_HASH_SIZE,
-												 &hash_ctl,
-									  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
-
-				/*
-				 * If requested, read the data from the database-specific
-				 * file.  Otherwise we just leave the hashtables empty.
-				 */
-				if (deep)
-					pgstat_read_db_statsfile(dbentry->databaseid,
-											 dbentry->tables,
-											 dbentry->functions,
-											 permanent);
-
 				break;
 
-			case 'E':
-				goto done;
-
-			default:
-				ereport(pgStatRunningInCollector ? LOG : WARNING,
-						(errmsg("corrupted statistics file \"%s\"",
-								statfile)));
-				goto done;
-		}
-	}
-
-done:
-	FreeFile(fpin);
-
-	/* If requested to read the permanent file, also get rid of it. */
-	if (permanent)
-	{
-		elog(DEBUG2, "removing permanent stats file \"%s\"", statfile);
-		unlink(statfile);
-	}
-
-	return dbhash;
-}
-
-
-/* ----------
- * pgstat_read_db_statsfile() -
- *
- *	Reads in the existing statistics collector file for the given database,
- *	filling the passed-in tables and functions hash tables.
- *
- *	As in pgstat_read_statsfiles, if the permanent file is requested, it is
- *	removed after reading.
- *
- *	Note: this code has the ability to skip storing per-table or per-function
- *	data, if NULL is passed for the corresponding hashtable.  That's not used
- *	at the moment though.
- * ----------
- */
-static void
-pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash,
-						 bool permanent)
-{
-	PgStat_StatTabEntry *tabentry;
-	PgStat_StatTabEntry tabbuf;
-	PgStat_StatFuncEntry funcbuf;
-	PgStat_StatFuncEntry *funcentry;
-	FILE	   *fpin;
-	int32		format_id;
-	bool		found;
-	char		statfile[MAXPGPATH];
-
-	get_dbstat_filename(permanent, false, databaseid, statfile, MAXPGPATH);
-
-	/*
-	 * Try to open the stats file. If it doesn't exist, the backends simply
-	 * return zero for anything and the collector simply starts from scratch
-	 * with empty counters.
-	 *
-	 * ENOENT is a possibility if the stats collector is not running or has
-	 * not yet written the stats file the first time.  Any other failure
-	 * condition is suspicious.
-	 */
-	if ((fpin = AllocateFile(statfile, PG_BINARY_R)) == NULL)
-	{
-		if (errno != ENOENT)
-			ereport(pgStatRunningInCollector ? LOG : WARNING,
-					(errcode_for_file_access(),
-					 errmsg("could not open statistics file \"%s\": %m",
-							statfile)));
-		return;
-	}
-
-	/*
-	 * Verify it's of the expected format.
-	 */
-	if (fread(&format_id, 1, sizeof(format_id), fpin) != sizeof(format_id) ||
-		format_id != PGSTAT_FILE_FORMAT_ID)
-	{
-		ereport(pgStatRunningInCollector ? LOG : WARNING,
-				(errmsg("corrupted statistics file \"%s\"", statfile)));
-		goto done;
-	}
-
-	/*
-	 * We found an existing collector stats file. Read it and put all the
-	 * hashtable entries into place.
-	 */
-	for (;;)
-	{
-		switch (fgetc(fpin))
-		{
 				/*
-				 * 'T'	A PgStat_StatTabEntry follows.
+				 * 'T'	A database OID and a PgStat_StatTabEntry follow.
 				 */
 			case 'T':
-				if (fread(&tabbuf, 1, sizeof(PgStat_StatTabEntry),
-						  fpin) != sizeof(PgStat_StatTabEntry))
 				{
-					ereport(pgStatRunningInCollector ? LOG : WARNING,
-							(errmsg("corrupted statistics file \"%s\"",
-									statfile)));
-					goto done;
-				}
+					PgStat_SharedTabEntry *tabentry;
 
-				/*
-				 * Skip if table data not wanted.
-				 */
-				if (tabhash == NULL)
-					break;
+					if (fread(&key.databaseid, 1, sizeof(Oid),
+							  fpin) != sizeof(Oid) ||
+						fread(&tabbuf, 1, sizeof(PgStat_StatTabEntry),
+							  fpin) != sizeof(PgStat_StatTabEntry))
+					{
+						ereport(LOG,
+								(errmsg("corrupted statistics file \"%s\"",
+										statfile)));
+						goto done;
+					}
 
-				tabentry = (PgStat_StatTabEntry *) hash_search(tabhash,
-													(void *) &tabbuf.tableid,
-														 HASH_ENTER, &found);
+					key.objectid = tabbuf.tableid;
+					tabentry = (PgStat_SharedTabEntry *)
+						dshash_find_or_insert(pgStatTabTable, &key, &found);
+					memcpy(&tabentry->stats, &tabbuf, sizeof(tabbuf));
+					dshash_release_lock(pgStatTabTable, tabentry);
 
-				if (found)
-				{
-					ereport(pgStatRunningInCollector ? LOG : WARNING,
-							(errmsg("corrupted statistics file \"%s\"",
-									statfile)));
-					goto done;
+					if (found)
+					{
+						ereport(LOG,
+								(errmsg("corrupted statistics file \"%s\"",
+										statfile)));
+						goto done;
+					}
 				}
-
-				memcpy(tabentry, &tabbuf, sizeof(tabbuf));
 				break;
 
 				/*
-				 * 'F'	A PgStat_StatFuncEntry follows.
+				 * 'F'	A database OID and a PgStat_StatFuncEntry follow.
 				 */
 			case 'F':
-				if (fread(&funcbuf, 1, sizeof(PgStat_StatFuncEntry),
-						  fpin) != sizeof(PgStat_StatFuncEntry))
 				{
-					ereport(pgStatRunningInCollector ? LOG : WARNING,
-							(errmsg("corrupted statistics file \"%s\"",
-									statfile)));
-					goto done;
-				}
+					PgStat_SharedFuncEntry *funcentry;
 
-				/*
-				 * Skip if function data not wanted.
-				 */
-				if (funchash == NULL)
-					break;
+					if (fread(&key.databaseid, 1, sizeof(Oid),
+							  fpin) != sizeof(Oid) ||
+						fread(&funcbuf, 1, sizeof(PgStat_StatFuncEntry),
+							  fpin) != sizeof(PgStat_StatFuncEntry))
+					{
+						ereport(LOG,
+								(errmsg("corrupted statistics file \"%s\"",
+										statfile)));
+						goto done;
+					}
 
-				funcentry = (PgStat_StatFuncEntry *) hash_search(funchash,
-												(void *) &funcbuf.functionid,
-														 HASH_ENTER, &found);
+					key.objectid = funcbuf.functionid;
+					funcentry = (PgStat_SharedFuncEntry *)
+						dshash_find_or_insert(pgStatFuncTable, &key, &found);
+					memcpy(&funcentry->stats, &funcbuf, sizeof(funcbuf));
+					dshash_release_lock(pgStatFuncTable, funcentry);
 
-				if (found)
-				{
-					ereport(pgStatRunningInCollector ? LOG : WARNING,
-							(errmsg("corrupted statistics file \"%s\"",
-									statfile)));
-					goto done;
+					if (found)
+					{
+						ereport(LOG,
+								(errmsg("corrupted statistics file \"%s\"",
+										statfile)));
+						goto done;
+					}
 				}
-
-				memcpy(funcentry, &funcbuf, sizeof(funcbuf));
 				break;
 
 				/*
@@ -5167,7 +4466,7 @@ pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash,
 				goto done;
 
 			default:
-				ereport(pgStatRunningInCollector ? LOG : WARNING,
+				ereport(LOG,
 						(errmsg("corrupted statistics file \"%s\"",
 								statfile)));
 				goto done;
@@ -5177,274 +4476,210 @@ pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash,
 done:
 	FreeFile(fpin);
 
-	if (permanent)
-	{
-		elog(DEBUG2, "removing permanent stats file \"%s\"", statfile);
-		unlink(statfile);
-	}
+	elog(DEBUG2, "removing permanent stats file \"%s\"", statfile);
+	unlink(statfile);
 }
 
 /* ----------
- * pgstat_read_db_statsfile_timestamp() -
- *
- *	Attempt to determine the timestamp of the last db statfile write.
- *	Returns TRUE if successful; the timestamp is stored in *ts.
- *
- *	This needs to be careful about handling databases for which no stats file
- *	exists, such as databases without a stat entry or those not yet written:
+ * pgstat_before_server_shutdown() -
  *
- *	- if there's a database entry in the global file, return the corresponding
- *	stats_timestamp value.
- *
- *	- if there's no db stat entry (e.g. for a new or inactive database),
- *	there's no stats_timestamp value, but also nothing to write so we return
- *	the timestamp of the global statfile.
+ *	before_shmem_exit callback of a standalone backend: save the statistics,
+ *	since there is no checkpointer to do it for us.
  * ----------
  */
-static bool
-pgstat_read_db_statsfile_timestamp(Oid databaseid, bool permanent,
-								   TimestampTz *ts)
+void
+pgstat_before_server_shutdown(int code, Datum arg)
 {
-	PgStat_StatDBEntry dbentry;
-	PgStat_GlobalStats myGlobalStats;
-	PgStat_ArchiverStats myArchiverStats;
-	FILE	   *fpin;
-	int32		format_id;
-	const char *statfile = permanent ? PGSTAT_STAT_PERMANENT_FILENAME : pgstat_stat_filename;
+	/* Don't write a possibly inconsistent file after an error exit */
+	if (code == 0)
+		pgstat_save_stats();
+}
 
-	/*
-	 * Try to open the stats file.  As above, anything but ENOENT is worthy of
-	 * complaining about.
-	 */
-	if ((fpin = AllocateFile(statfile, PG_BINARY_R)) == NULL)
-	{
-		if (errno != ENOENT)
-			ereport(pgStatRunningInCollector ? LOG : WARNING,
-					(errcode_for_file_access(),
-					 errmsg("could not open statistics file \"%s\": %m",
-							statfile)));
-		return false;
-	}
 
-	/*
-	 * Verify it's of the expected format.
-	 */
-	if (fread(&format_id, 1, sizeof(format_id), fpin) != sizeof(format_id) ||
-		format_id != PGSTAT_FILE_FORMAT_ID)
-	{
-		ereport(pgStatRunningInCollector ? LOG : WARNING,
-				(errmsg("corrupted statistics file \"%s\"", statfile)));
-		FreeFile(fpin);
-		return false;
-	}
+/*
+ * Look up or create the snapshot entry for a database.  Table and function
+ * hash tables are created along with it.
+ */
+static PgStat_StatDBEntry *
+pgstat_snapshot_db_entry(Oid databaseid)
+{
+	PgStat_StatDBEntry *dbentry;
+	bool		found;
 
-	/*
-	 * Read global stats struct
-	 */
-	if (fread(&myGlobalStats, 1, sizeof(myGlobalStats),
-			  fpin) != sizeof(myGlobalStats))
+	dbentry = (PgStat_StatDBEntry *) hash_search(pgStatDBHash,
+												 (void *) &databaseid,
+												 HASH_ENTER, &found);
+	if (!found)
 	{
-		ereport(pgStatRunningInCollector ? LOG : WARNING,
-				(errmsg("corrupted statistics file \"%s\"", statfile)));
-		FreeFile(fpin);
-		return false;
+		reset_dbentry_counters(dbentry);
+		dbentry->stat_reset_timestamp = 0;
 	}
 
-	/*
-	 * Read archiver stats struct
-	 */
-	if (fread(&myArchiverStats, 1, sizeof(myArchiverStats),
-			  fpin) != sizeof(myArchiverStats))
+	if (dbentry->tables == NULL)
 	{
-		ereport(pgStatRunningInCollector ? LOG : WARNING,
-				(errmsg("corrupted statistics file \"%s\"", statfile)));
-		FreeFile(fpin);
-		return false;
+		HASHCTL		hash_ctl;
+
+		memset(&hash_ctl, 0, sizeof(hash_ctl));
+		hash_ctl.keysize = sizeof(Oid);
+		hash_ctl.entrysize = sizeof(PgStat_StatTabEntry);
+		hash_ctl.hcxt = pgStatLocalContext;
+		dbentry->tables = hash_create("Per-database table",
+									  PGSTAT_TAB_HASH_SIZE,
+									  &hash_ctl,
+									  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+		hash_ctl.keysize = sizeof(Oid);
+		hash_ctl.entrysize = sizeof(PgStat_StatFuncEntry);
+		hash_ctl.hcxt = pgStatLocalContext;
+		dbentry->functions = hash_create("Per-database function",
+										 PGSTAT_FUNCTION_HASH_SIZE,
+										 &hash_ctl,
+										 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 	}
 
-	/* By default, we're going to return the timestamp of the global file. */
-	*ts = myGlobalStats.stats_timestamp;
+	return dbentry;
+}
+
+/*
+ * If not already done, copy the global and per-database shared statistics
+ * into some local hash tables.  The results will be kept until
+ * pgstat_clear_snapshot() is called (typically, at end of transaction).
+ *
+ * Table and function entries are copied one at a time, the first time they
+ * are asked for, since most callers only look at a few of them; a caller
+ * that wants to scan them all calls pgstat_snapshot_all_objects() instead.
+ */
+static void
+pgstat_build_snapshot(void)
+{
+	dshash_seq_status status;
+	HASHCTL		hash_ctl;
+	PgStat_StatDBEntry *shdbentry;
+	PgStat_StatDBEntry *dbentry;
+	TimestampTz now;
+
+	/* already built it? */
+	if (pgStatDBHash)
+		return;
 
 	/*
-	 * We found an existing collector stats file.  Read it and look for a
-	 * record for the requested database.  If found, use its timestamp.
+	 * The tables will live in pgStatLocalContext.
 	 */
-	for (;;)
-	{
-		switch (fgetc(fpin))
-		{
-				/*
-				 * 'D'	A PgStat_StatDBEntry struct describing a database
-				 * follows.
-				 */
-			case 'D':
-				if (fread(&dbentry, 1, offsetof(PgStat_StatDBEntry, tables),
-						  fpin) != offsetof(PgStat_StatDBEntry, tables))
-				{
-					ereport(pgStatRunningInCollector ? LOG : WARNING,
-							(errmsg("corrupted statistics file \"%s\"",
-									statfile)));
-					goto done;
-				}
+	pgstat_setup_memcxt();
 
-				/*
-				 * If this is the DB we're looking for, save its timestamp and
-				 * we're done.
-				 */
-				if (dbentry.databaseid == databaseid)
-				{
-					*ts = dbentry.stats_timestamp;
-					goto done;
-				}
+	memset(&hash_ctl, 0, sizeof(hash_ctl));
+	hash_ctl.keysize = sizeof(Oid);
+	hash_ctl.entrysize = sizeof(PgStat_StatDBEntry);
+	hash_ctl.hcxt = pgStatLocalContext;
+	pgStatDBHash = hash_create("Databases hash", PGSTAT_DB_HASH_SIZE,
+							   &hash_ctl,
+							   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 
-				break;
+	now = GetCurrentTimestamp();
 
-			case 'E':
-				goto done;
+	SpinLockAcquire(&pgStatShmem->mutex);
+	memcpy(&globalStats, &pgStatShmem->globalStats, sizeof(globalStats));
+	memcpy(&archiverStats, &pgStatShmem->archiverStats,
+		   sizeof(archiverStats));
+	SpinLockRelease(&pgStatShmem->mutex);
 
-			default:
-				ereport(pgStatRunningInCollector ? LOG : WARNING,
-						(errmsg("corrupted statistics file \"%s\"",
-								statfile)));
-				goto done;
-		}
-	}
+	globalStats.stats_timestamp = now;
 
-done:
-	FreeFile(fpin);
-	return true;
+	pgstat_attach_shmem();
+
+	/*
+	 * Copy the database entries.  Each partition is locked while we walk it,
+	 * so keep the work done per entry to a minimum.
+	 */
+	dshash_seq_init(&status, pgStatDBTable, false);
+	while ((shdbentry = dshash_seq_next(&status)) != NULL)
+	{
+		dbentry = (PgStat_StatDBEntry *) hash_search(pgStatDBHash,
+												(void *) &shdbentry->databaseid,
+													 HASH_ENTER, NULL);
+		memcpy(dbentry, shdbentry, offsetof(PgStat_StatDBEntry, tables));
+		dbentry->stats_timestamp = now;
+		dbentry->tables = NULL;
+		dbentry->functions = NULL;
+	}
+	dshash_seq_term(&status);
 }
 
 /*
- * If not already done, read the statistics collector stats file into
- * some hash tables.  The results will be kept until pgstat_clear_snapshot()
- * is called (typically, at end of transaction).
+ * Copy all the table and function entries we can see (those of MyDatabaseId
+ * and of the shared catalogs) into the snapshot, for callers that scan them
+ * all.  Entries that were already copied are left alone, so that a caller
+ * keeps seeing the values it was shown earlier in the transaction.
  */
 static void
-backend_read_statsfile(void)
+pgstat_snapshot_all_objects(void)
 {
-	TimestampTz min_ts = 0;
-	TimestampTz ref_ts = 0;
-	Oid			inquiry_db;
-	int			count;
+	dshash_seq_status status;
+	PgStat_StatDBEntry *dbentry;
 
-	/* already read it? */
-	if (pgStatDBHash)
+	pgstat_build_snapshot();
+
+	if (pgStatSnapshotComplete)
 		return;
-	Assert(!pgStatRunningInCollector);
 
-	/*
-	 * In a normal backend, we check staleness of the data for our own DB, and
-	 * so we send MyDatabaseId in inquiry messages.  In the autovac launcher,
-	 * check staleness of the shared-catalog data, and send InvalidOid in
-	 * inquiry messages so as not to force writing unnecessary data.
-	 */
-	if (IsAutoVacuumLauncherProcess())
-		inquiry_db = InvalidOid;
-	else
-		inquiry_db = MyDatabaseId;
+	/* Make sure the hash tables exist even if there's nothing to copy */
+	(void) pgstat_snapshot_db_entry(MyDatabaseId);
+	(void) pgstat_snapshot_db_entry(InvalidOid);
 
 	/*
-	 * Loop until fresh enough stats file is available or we ran out of time.
-	 * The stats inquiry message is sent repeatedly in case collector drops
-	 * it; but not every single time, as that just swamps the collector.
+	 * A table may show up before its database entry if a concurrent backend
+	 * is just creating both; pgstat_snapshot_db_entry copes with that.
 	 */
-	for (count = 0; count < PGSTAT_POLL_LOOP_COUNT; count++)
+	dshash_seq_init(&status, pgStatTabTable, false);
+	for (;;)
 	{
-		bool		ok;
-		TimestampTz file_ts = 0;
-		TimestampTz cur_ts;
-
-		CHECK_FOR_INTERRUPTS();
+		PgStat_SharedTabEntry *shtabentry;
+		PgStat_StatTabEntry *tabentry;
+		bool		found;
 
-		ok = pgstat_read_db_statsfile_timestamp(inquiry_db, false, &file_ts);
+		shtabentry = (PgStat_SharedTabEntry *) dshash_seq_next(&status);
+		if (shtabentry == NULL)
+			break;
 
-		cur_ts = GetCurrentTimestamp();
-		/* Calculate min acceptable timestamp, if we didn't already */
-		if (count == 0 || cur_ts < ref_ts)
-		{
-			/*
-			 * We set the minimum acceptable timestamp to PGSTAT_STAT_INTERVAL
-			 * msec before now.  This indirectly ensures that the collector
-			 * needn't write the file more often than PGSTAT_STAT_INTERVAL. In
-			 * an autovacuum worker, however, we want a lower delay to avoid
-			 * using stale data, so we use PGSTAT_RETRY_DELAY (since the
-			 * number of workers is low, this shouldn't be a problem).
-			 *
-			 * We don't recompute min_ts after sleeping, except in the
-			 * unlikely case that cur_ts went backwards.  So we might end up
-			 * accepting a file a bit older than PGSTAT_STAT_INTERVAL.  In
-			 * practice that shouldn't happen, though, as long as the sleep
-			 * time is less than PGSTAT_STAT_INTERVAL; and we don't want to
-			 * tell the collector that our cutoff time is less than what we'd
-			 * actually accept.
-			 */
-			ref_ts = cur_ts;
-			if (IsAutoVacuumWorkerProcess())
-				min_ts = TimestampTzPlusMilliseconds(ref_ts,
-													 -PGSTAT_RETRY_DELAY);
-			else
-				min_ts = TimestampTzPlusMilliseconds(ref_ts,
-													 -PGSTAT_STAT_INTERVAL);
-		}
+		if (shtabentry->key.databaseid != MyDatabaseId &&
+			shtabentry->key.databaseid != InvalidOid)
+			continue;
 
-		/*
-		 * If the file timestamp is actually newer than cur_ts, we must have
-		 * had a clock glitch (system time went backwards) or there is clock
-		 * skew between our processor and the stats collector's processor.
-		 * Accept the file, but send an inquiry message anyway to make
-		 * pgstat_recv_inquiry do a sanity check on the collector's time.
-		 */
-		if (ok && file_ts > cur_ts)
-		{
-			/*
-			 * A small amount of clock skew between processors isn't terribly
-			 * surprising, but a large difference is worth logging.  We
-			 * arbitrarily define "large" as 1000 msec.
-			 */
-			if (file_ts >= TimestampTzPlusMilliseconds(cur_ts, 1000))
-			{
-				char	   *filetime;
-				char	   *mytime;
-
-				/* Copy because timestamptz_to_str returns a static buffer */
-				filetime = pstrdup(timestamptz_to_str(file_ts));
-				mytime = pstrdup(timestamptz_to_str(cur_ts));
-				elog(LOG, "stats collector's time %s is later than backend local time %s",
-					 filetime, mytime);
-				pfree(filetime);
-				pfree(mytime);
-			}
+		dbentry = pgstat_snapshot_db_entry(shtabentry->key.databaseid);
+		tabentry = (PgStat_StatTabEntry *) hash_search(dbentry->tables,
+											(void *) &shtabentry->key.objectid,
+													   HASH_ENTER, &found);
+		if (!found)
+			memcpy(tabentry, &shtabentry->stats, sizeof(PgStat_StatTabEntry));
+	}
+	dshash_seq_term(&status);
 
-			pgstat_send_inquiry(cur_ts, min_ts, inquiry_db);
-			break;
-		}
+	dshash_seq_init(&status, pgStatFuncTable, false);
+	for (;;)
+	{
+		PgStat_SharedFuncEntry *shfuncentry;
+		PgStat_StatFuncEntry *funcentry;
+		bool		found;
 
-		/* Normal acceptance case: file is not older than cutoff time */
-		if (ok && file_ts >= min_ts)
+		shfuncentry = (PgStat_SharedFuncEntry *) dshash_seq_next(&status);
+		if (shfuncentry == NULL)
 			break;
 
-		/* Not there or too old, so kick the collector and wait a bit */
-		if ((count % PGSTAT_INQ_LOOP_COUNT) == 0)
-			pgstat_send_inquiry(cur_ts, min_ts, inquiry_db);
+		if (shfuncentry->key.databaseid != MyDatabaseId &&
+			shfuncentry->key.databaseid != InvalidOid)
+			continue;
 
-		pg_usleep(PGSTAT_RETRY_DELAY * 1000L);
+		dbentry = pgstat_snapshot_db_entry(shfuncentry->key.databaseid);
+		funcentry = (PgStat_StatFuncEntry *) hash_search(dbentry->functions,
+										   (void *) &shfuncentry->key.objectid,
+														 HASH_ENTER, &found);
+		if (!found)
+			memcpy(funcentry, &shfuncentry->stats,
+				   sizeof(PgStat_StatFuncEntry));
 	}
+	dshash_seq_term(&status);
 
-	if (count >= PGSTAT_POLL_LOOP_COUNT)
-		ereport(LOG,
-				(errmsg("using stale statistics instead of current ones "
-						"because stats collector is not responding")));
-
-	/*
-	 * Autovacuum launcher wants stats about all databases, but a shallow read
-	 * is sufficient.  Regular backends want a deep read for just the tables
-	 * they can see (MyDatabaseId + shared catalogs).
-	 */
-	if (IsAutoVacuumLauncherProcess())
-		pgStatDBHash = pgstat_read_statsfiles(InvalidOid, false, false);
-	else
-		pgStatDBHash = pgstat_read_statsfiles(MyDatabaseId, false, true);
+	pgStatSnapshotComplete = true;
 }
 
 
@@ -5484,127 +4719,66 @@ pgstat_clear_snapshot(void)
 	/* Reset variables */
 	pgStatLocalContext = NULL;
 	pgStatDBHash = NULL;
+	pgStatSnapshotComplete = false;
 	localBackendStatusTable = NULL;
 	localNumBackends = 0;
 }
 
 
 /* ----------
- * pgstat_recv_inquiry() -
+ * pgstat_apply_tabstat() -
  *
- *	Process stat inquiry requests.
+ *	Count what the backend has done.
  * ----------
  */
 static void
-pgstat_recv_inquiry(PgStat_MsgInquiry *msg, int len)
+pgstat_apply_tabstat(PgStat_MsgTabstat *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
-
-	elog(DEBUG2, "received inquiry for database %u", msg->databaseid);
-
-	/*
-	 * If there's already a write request for this DB, there's nothing to do.
-	 *
-	 * Note that if a request is found, we return early and skip the below
-	 * check for clock skew.  This is okay, since the only way for a DB
-	 * request to be present in the list is that we have been here since the
-	 * last write round.  It seems sufficient to check for clock skew once per
-	 * write round.
-	 */
-	if (list_member_oid(pending_write_requests, msg->databaseid))
-		return;
+	PgStat_Counter tuples_returned = 0;
+	PgStat_Counter tuples_fetched = 0;
+	PgStat_Counter tuples_inserted = 0;
+	PgStat_Counter tuples_updated = 0;
+	PgStat_Counter tuples_deleted = 0;
+	PgStat_Counter blocks_fetched = 0;
+	PgStat_Counter blocks_hit = 0;
+	int			i;
 
 	/*
-	 * Check to see if we last wrote this database at a time >= the requested
-	 * cutoff time.  If so, this is a stale request that was generated before
-	 * we updated the DB file, and we don't need to do so again.
-	 *
-	 * If the requestor's local clock time is older than stats_timestamp, we
-	 * should suspect a clock glitch, ie system time going backwards; though
-	 * the more likely explanation is just delayed message receipt.  It is
-	 * worth expending a GetCurrentTimestamp call to be sure, since a large
-	 * retreat in the system clock reading could otherwise cause us to neglect
-	 * to update the stats file for a long time.
+	 * Sum up the per-table counts first, so that the database entry needs
+	 * to be locked only once.
 	 */
-	dbentry = pgstat_get_db_entry(msg->databaseid, false);
-	if (dbentry == NULL)
-	{
-		/*
-		 * We have no data for this DB.  Enter a write request anyway so that
-		 * the global stats will get updated.  This is needed to prevent
-		 * backend_read_statsfile from waiting for data that we cannot supply,
-		 * in the case of a new DB that nobody has yet reported any stats for.
-		 * See the behavior of pgstat_read_db_statsfile_timestamp.
-		 */
-	}
-	else if (msg->clock_time < dbentry->stats_timestamp)
-	{
-		TimestampTz cur_ts = GetCurrentTimestamp();
-
-		if (cur_ts < dbentry->stats_timestamp)
-		{
-			/*
-			 * Sure enough, time went backwards.  Force a new stats file write
-			 * to get back in sync; but first, log a complaint.
-			 */
-			char	   *writetime;
-			char	   *mytime;
-
-			/* Copy because timestamptz_to_str returns a static buffer */
-			writetime = pstrdup(timestamptz_to_str(dbentry->stats_timestamp));
-			mytime = pstrdup(timestamptz_to_str(cur_ts));
-			elog(LOG,
-				 "stats_timestamp %s is later than collector's time %s for database %u",
-				 writetime, mytime, dbentry->databaseid);
-			pfree(writetime);
-			pfree(mytime);
-		}
-		else
-		{
-			/*
-			 * Nope, it's just an old request.  Assuming msg's clock_time is
-			 * >= its cutoff_time, it must be stale, so we can ignore it.
-			 */
-			return;
-		}
-	}
-	else if (msg->cutoff_time <= dbentry->stats_timestamp)
+	for (i = 0; i < msg->m_nentries; i++)
 	{
-		/* Stale request, ignore it */
-		return;
+		PgStat_TableCounts *counts = &(msg->m_entry[i].t_counts);
+
+		tuples_returned += counts->t_tuples_returned;
+		tuples_fetched += counts->t_tuples_fetched;
+		tuples_inserted += counts->t_tuples_inserted;
+		tuples_updated += counts->t_tuples_updated;
+		tuples_deleted += counts->t_tuples_deleted;
+		blocks_fetched += counts->t_blocks_fetched;
+		blocks_hit += counts->t_blocks_hit;
 	}
 
 	/*
-	 * We need to write this DB, so create a request.
+	 * Update database-wide stats.
 	 */
-	pending_write_requests = lappend_oid(pending_write_requests,
-										 msg->databaseid);
-}
-
-
-/* ----------
- * pgstat_recv_tabstat() -
- *
- *	Count what the backend has done.
- * ----------
- */
-static void
-pgstat_recv_tabstat(PgStat_MsgTabstat *msg, int len)
-{
-	PgStat_StatDBEntry *dbentry;
-	PgStat_StatTabEntry *tabentry;
-	int			i;
-	bool		found;
-
 	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
 
-	/*
-	 * Update database-wide stats.
-	 */
 	dbentry->n_xact_commit += (PgStat_Counter) (msg->m_xact_commit);
 	dbentry->n_xact_rollback += (PgStat_Counter) (msg->m_xact_rollback);
 	dbentry->n_block_read_time += msg->m_block_read_time;
 	dbentry->n_block_write_time += msg->m_block_write_time;
+	dbentry->n_tuples_returned += tuples_returned;
+	dbentry->n_tuples_fetched += tuples_fetched;
+	dbentry->n_tuples_inserted += tuples_inserted;
+	dbentry->n_tuples_updated += tuples_updated;
+	dbentry->n_tuples_deleted += tuples_deleted;
+	dbentry->n_blocks_fetched += blocks_fetched;
+	dbentry->n_blocks_hit += blocks_hit;
+
+	dshash_release_lock(pgStatDBTable, dbentry);
 
 	/*
 	 * Process all table entries in the message.
@@ -5612,102 +4786,56 @@ pgstat_recv_tabstat(PgStat_MsgTabstat *msg, int len)
 	for (i = 0; i < msg->m_nentries; i++)
 	{
 		PgStat_TableEntry *tabmsg = &(msg->m_entry[i]);
-
-		tabentry = (PgStat_StatTabEntry *) hash_search(dbentry->tables,
-													(void *) &(tabmsg->t_id),
-													   HASH_ENTER, &found);
-
-		if (!found)
+		PgStat_SharedTabEntry *shentry;
+		PgStat_StatTabEntry *tabentry;
+
+		shentry = pgstat_get_tab_entry(msg->m_databaseid, tabmsg->t_id, true);
+		tabentry = &shentry->stats;
+
+		tabentry->numscans += tabmsg->t_counts.t_numscans;
+		tabentry->tuples_returned += tabmsg->t_counts.t_tuples_returned;
+		tabentry->tuples_fetched += tabmsg->t_counts.t_tuples_fetched;
+		tabentry->tuples_inserted += tabmsg->t_counts.t_tuples_inserted;
+		tabentry->tuples_updated += tabmsg->t_counts.t_tuples_updated;
+		tabentry->tuples_deleted += tabmsg->t_counts.t_tuples_deleted;
+		tabentry->tuples_hot_updated += tabmsg->t_counts.t_tuples_hot_updated;
+		/* If table was truncated, first reset the live/dead counters */
+		if (tabmsg->t_counts.t_truncated)
 		{
-			/*
-			 * If it's a new table entry, initialize counters to the values we
-			 * just got.
-			 */
-			tabentry->numscans = tabmsg->t_counts.t_numscans;
-			tabentry->tuples_returned = tabmsg->t_counts.t_tuples_returned;
-			tabentry->tuples_fetched = tabmsg->t_counts.t_tuples_fetched;
-			tabentry->tuples_inserted = tabmsg->t_counts.t_tuples_inserted;
-			tabentry->tuples_updated = tabmsg->t_counts.t_tuples_updated;
-			tabentry->tuples_deleted = tabmsg->t_counts.t_tuples_deleted;
-			tabentry->tuples_hot_updated = tabmsg->t_counts.t_tuples_hot_updated;
-			tabentry->n_live_tuples = tabmsg->t_counts.t_delta_live_tuples;
-			tabentry->n_dead_tuples = tabmsg->t_counts.t_delta_dead_tuples;
-			tabentry->changes_since_analyze = tabmsg->t_counts.t_changed_tuples;
-			tabentry->blocks_fetched = tabmsg->t_counts.t_blocks_fetched;
-			tabentry->blocks_hit = tabmsg->t_counts.t_blocks_hit;
-
-			tabentry->vacuum_timestamp = 0;
-			tabentry->vacuum_count = 0;
-			tabentry->autovac_vacuum_timestamp = 0;
-			tabentry->autovac_vacuum_count = 0;
-			tabentry->analyze_timestamp = 0;
-			tabentry->analyze_count = 0;
-			tabentry->autovac_analyze_timestamp = 0;
-			tabentry->autovac_analyze_count = 0;
-		}
-		else
-		{
-			/*
-			 * Otherwise add the values to the existing entry.
-			 */
-			tabentry->numscans += tabmsg->t_counts.t_numscans;
-			tabentry->tuples_returned += tabmsg->t_counts.t_tuples_returned;
-			tabentry->tuples_fetched += tabmsg->t_counts.t_tuples_fetched;
-			tabentry->tuples_inserted += tabmsg->t_counts.t_tuples_inserted;
-			tabentry->tuples_updated += tabmsg->t_counts.t_tuples_updated;
-			tabentry->tuples_deleted += tabmsg->t_counts.t_tuples_deleted;
-			tabentry->tuples_hot_updated += tabmsg->t_counts.t_tuples_hot_updated;
-			/* If table was truncated, first reset the live/dead counters */
-			if (tabmsg->t_counts.t_truncated)
-			{
-				tabentry->n_live_tuples = 0;
-				tabentry->n_dead_tuples = 0;
-			}
-			tabentry->n_live_tuples += tabmsg->t_counts.t_delta_live_tuples;
-			tabentry->n_dead_tuples += tabmsg->t_counts.t_delta_dead_tuples;
-			tabentry->changes_since_analyze += tabmsg->t_counts.t_changed_tuples;
-			tabentry->blocks_fetched += tabmsg->t_counts.t_blocks_fetched;
-			tabentry->blocks_hit += tabmsg->t_counts.t_blocks_hit;
+			tabentry->n_live_tuples = 0;
+			tabentry->n_dead_tuples = 0;
 		}
+		tabentry->n_live_tuples += tabmsg->t_counts.t_delta_live_tuples;
+		tabentry->n_dead_tuples += tabmsg->t_counts.t_delta_dead_tuples;
+		tabentry->changes_since_analyze += tabmsg->t_counts.t_changed_tuples;
+		tabentry->blocks_fetched += tabmsg->t_counts.t_blocks_fetched;
+		tabentry->blocks_hit += tabmsg->t_counts.t_blocks_hit;
 
 		/* Clamp n_live_tuples in case of negative delta_live_tuples */
 		tabentry->n_live_tuples = Max(tabentry->n_live_tuples, 0);
 		/* Likewise for n_dead_tuples */
 		tabentry->n_dead_tuples = Max(tabentry->n_dead_tuples, 0);
 
-		/*
-		 * Add per-table stats to the per-database entry, too.
-		 */
-		dbentry->n_tuples_returned += tabmsg->t_counts.t_tuples_returned;
-		dbentry->n_tuples_fetched += tabmsg->t_counts.t_tuples_fetched;
-		dbentry->n_tuples_inserted += tabmsg->t_counts.t_tuples_inserted;
-		dbentry->n_tuples_updated += tabmsg->t_counts.t_tuples_updated;
-		dbentry->n_tuples_deleted += tabmsg->t_counts.t_tuples_deleted;
-		dbentry->n_blocks_fetched += tabmsg->t_counts.t_blocks_fetched;
-		dbentry->n_blocks_hit += tabmsg->t_counts.t_blocks_hit;
+		dshash_release_lock(pgStatTabTable, shentry);
 	}
 }
 
 
 /* ----------
- * pgstat_recv_tabpurge() -
+ * pgstat_apply_tabpurge() -
  *
  *	Arrange for dead table removal.
  * ----------
  */
 static void
-pgstat_recv_tabpurge(PgStat_MsgTabpurge *msg, int len)
+pgstat_apply_tabpurge(PgStat_MsgTabpurge *msg, int len)
 {
-	PgStat_StatDBEntry *dbentry;
+	PgStat_ObjKey key;
 	int			i;
 
-	dbentry = pgstat_get_db_entry(msg->m_databaseid, false);
+	pgstat_attach_shmem();
 
-	/*
-	 * No need to purge if we don't even know the database.
-	 */
-	if (!dbentry || !dbentry->tables)
-		return;
+	key.databaseid = msg->m_databaseid;
 
 	/*
 	 * Process all table entries in the message.
@@ -5715,64 +4843,41 @@ pgstat_recv_tabpurge(PgStat_MsgTabpurge *msg, int len)
 	for (i = 0; i < msg->m_nentries; i++)
 	{
 		/* Remove from hashtable if present; we don't care if it's not. */
-		(void) hash_search(dbentry->tables,
-						   (void *) &(msg->m_tableid[i]),
-						   HASH_REMOVE, NULL);
+		key.objectid = msg->m_tableid[i];
+		(void) dshash_delete_key(pgStatTabTable, &key);
 	}
 }
 
 
 /* ----------
- * pgstat_recv_dropdb() -
+ * pgstat_apply_dropdb() -
  *
  *	Arrange for dead database removal
  * ----------
  */
 static void
-pgstat_recv_dropdb(PgStat_MsgDropdb *msg, int len)
+pgstat_apply_dropdb(PgStat_MsgDropdb *msg, int len)
 {
 	Oid			dbid = msg->m_databaseid;
-	PgStat_StatDBEntry *dbentry;
 
-	/*
-	 * Lookup the database in the hashtable.
-	 */
-	dbentry = pgstat_get_db_entry(dbid, false);
+	pgstat_attach_shmem();
 
 	/*
-	 * If found, remove it (along with the db statfile).
+	 * If found, remove it along with its tables and functions.
 	 */
-	if (dbentry)
-	{
-		char		statfile[MAXPGPATH];
-
-		get_dbstat_filename(false, false, dbid, statfile, MAXPGPATH);
-
-		elog(DEBUG2, "removing stats file \"%s\"", statfile);
-		unlink(statfile);
-
-		if (dbentry->tables != NULL)
-			hash_destroy(dbentry->tables);
-		if (dbentry->functions != NULL)
-			hash_destroy(dbentry->functions);
-
-		if (hash_search(pgStatDBHash,
-						(void *) &dbid,
-						HASH_REMOVE, NULL) == NULL)
-			ereport(ERROR,
-					(errmsg("database hash table corrupted during cleanup --- abort")));
-	}
+	if (dshash_delete_key(pgStatDBTable, &dbid))
+		pgstat_remove_db_objects(dbid);
 }
 
 
 /* ----------
- * pgstat_recv_resetcounter() -
+ * pgstat_apply_resetcounter() -
  *
  *	Reset the statistics for the specified database.
  * ----------
  */
 static void
-pgstat_recv_resetcounter(PgStat_MsgResetcounter *msg, int len)
+pgstat_apply_resetcounter(PgStat_MsgResetcounter *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
 
@@ -5785,45 +4890,40 @@ pgstat_recv_resetcounter(PgStat_MsgResetcounter *msg, int len)
 		return;
 
 	/*
-	 * We simply throw away all the database's table entries by recreating a
-	 * new hash table for them.
-	 */
-	if (dbentry->tables != NULL)
-		hash_destroy(dbentry->tables);
-	if (dbentry->functions != NULL)
-		hash_destroy(dbentry->functions);
-
-	dbentry->tables = NULL;
-	dbentry->functions = NULL;
-
-	/*
-	 * Reset database-level stats, too.  This creates empty hash tables for
-	 * tables and functions.
+	 * Reset database-level stats, then throw away all the database's table
+	 * and function entries.
 	 */
 	reset_dbentry_counters(dbentry);
+	dshash_release_lock(pgStatDBTable, dbentry);
+
+	pgstat_remove_db_objects(msg->m_databaseid);
 }
 
 /* ----------
- * pgstat_recv_resetshared() -
+ * pgstat_apply_resetsharedcounter() -
  *
  *	Reset some shared statistics of the cluster.
  * ----------
  */
 static void
-pgstat_recv_resetsharedcounter(PgStat_MsgResetsharedcounter *msg, int len)
+pgstat_apply_resetsharedcounter(PgStat_MsgResetsharedcounter *msg, int len)
 {
+	TimestampTz now = GetCurrentTimestamp();
+
+	SpinLockAcquire(&pgStatShmem->mutex);
 	if (msg->m_resettarget == RESET_BGWRITER)
 	{
 		/* Reset the global background writer statistics for the cluster. */
-		memset(&globalStats, 0, sizeof(globalStats));
-		globalStats.stat_reset_timestamp = GetCurrentTimestamp();
+		memset(&pgStatShmem->globalStats, 0, sizeof(PgStat_GlobalStats));
+		pgStatShmem->globalStats.stat_reset_timestamp = now;
 	}
 	else if (msg->m_resettarget == RESET_ARCHIVER)
 	{
 		/* Reset the archiver statistics for the cluster. */
-		memset(&archiverStats, 0, sizeof(archiverStats));
-		archiverStats.stat_reset_timestamp = GetCurrentTimestamp();
+		memset(&pgStatShmem->archiverStats, 0, sizeof(PgStat_ArchiverStats));
+		pgStatShmem->archiverStats.stat_reset_timestamp = now;
 	}
+	SpinLockRelease(&pgStatShmem->mutex);
 
 	/*
 	 * Presumably the sender of this message validated the target, don't
@@ -5832,15 +4932,16 @@ pgstat_recv_resetsharedcounter(PgStat_MsgResetsharedcounter *msg, int len)
 }
 
 /* ----------
- * pgstat_recv_resetsinglecounter() -
+ * pgstat_apply_resetsinglecounter() -
  *
  *	Reset a statistics for a single object
  * ----------
  */
 static void
-pgstat_recv_resetsinglecounter(PgStat_MsgResetsinglecounter *msg, int len)
+pgstat_apply_resetsinglecounter(PgStat_MsgResetsinglecounter *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
+	PgStat_ObjKey key;
 
 	dbentry = pgstat_get_db_entry(msg->m_databaseid, false);
 
@@ -5849,24 +4950,25 @@ pgstat_recv_resetsinglecounter(PgStat_MsgResetsinglecounter *msg, int len)
 
 	/* Set the reset timestamp for the whole database */
 	dbentry->stat_reset_timestamp = GetCurrentTimestamp();
+	dshash_release_lock(pgStatDBTable, dbentry);
 
 	/* Remove object if it exists, ignore it if not */
+	key.databaseid = msg->m_databaseid;
+	key.objectid = msg->m_objectid;
 	if (msg->m_resettype == RESET_TABLE)
-		(void) hash_search(dbentry->tables, (void *) &(msg->m_objectid),
-						   HASH_REMOVE, NULL);
+		(void) dshash_delete_key(pgStatTabTable, &key);
 	else if (msg->m_resettype == RESET_FUNCTION)
-		(void) hash_search(dbentry->functions, (void *) &(msg->m_objectid),
-						   HASH_REMOVE, NULL);
+		(void) dshash_delete_key(pgStatFuncTable, &key);
 }
 
 /* ----------
- * pgstat_recv_autovac() -
+ * pgstat_apply_autovac() -
  *
  *	Process an autovacuum signalling message.
  * ----------
  */
 static void
-pgstat_recv_autovac(PgStat_MsgAutovacStart *msg, int len)
+pgstat_apply_autovac(PgStat_MsgAutovacStart *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
 
@@ -5876,26 +4978,32 @@ pgstat_recv_autovac(PgStat_MsgAutovacStart *msg, int len)
 	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
 
 	dbentry->last_autovac_time = msg->m_start_time;
+
+	dshash_release_lock(pgStatDBTable, dbentry);
 }
 
 /* ----------
- * pgstat_recv_vacuum() -
+ * pgstat_apply_vacuum() -
  *
  *	Process a VACUUM message.
  * ----------
  */
 static void
-pgstat_recv_vacuum(PgStat_MsgVacuum *msg, int len)
+pgstat_apply_vacuum(PgStat_MsgVacuum *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
+	PgStat_SharedTabEntry *shentry;
 	PgStat_StatTabEntry *tabentry;
 
 	/*
-	 * Store the data in the table's hashtable entry.
+	 * Make sure the database is known, then store the data in the table's
+	 * hashtable entry.
 	 */
 	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
+	dshash_release_lock(pgStatDBTable, dbentry);
 
-	tabentry = pgstat_get_tab_entry(dbentry, msg->m_tableoid, true);
+	shentry = pgstat_get_tab_entry(msg->m_databaseid, msg->m_tableoid, true);
+	tabentry = &shentry->stats;
 
 	tabentry->n_live_tuples = msg->m_live_tuples;
 	tabentry->n_dead_tuples = msg->m_dead_tuples;
@@ -5910,26 +5018,32 @@ pgstat_recv_vacuum(PgStat_MsgVacuum *msg, int len)
 		tabentry->vacuum_timestamp = msg->m_vacuumtime;
 		tabentry->vacuum_count++;
 	}
+
+	dshash_release_lock(pgStatTabTable, shentry);
 }
 
 /* ----------
- * pgstat_recv_analyze() -
+ * pgstat_apply_analyze() -
  *
  *	Process an ANALYZE message.
  * ----------
  */
 static void
-pgstat_recv_analyze(PgStat_MsgAnalyze *msg, int len)
+pgstat_apply_analyze(PgStat_MsgAnalyze *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
+	PgStat_SharedTabEntry *shentry;
 	PgStat_StatTabEntry *tabentry;
 
 	/*
-	 * Store the data in the table's hashtable entry.
+	 * Make sure the database is known, then store the data in the table's
+	 * hashtable entry.
 	 */
 	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
+	dshash_release_lock(pgStatDBTable, dbentry);
 
-	tabentry = pgstat_get_tab_entry(dbentry, msg->m_tableoid, true);
+	shentry = pgstat_get_tab_entry(msg->m_databaseid, msg->m_tableoid, true);
+	tabentry = &shentry->stats;
 
 	tabentry->n_live_tuples = msg->m_live_tuples;
 	tabentry->n_dead_tuples = msg->m_dead_tuples;
@@ -5952,65 +5066,76 @@ pgstat_recv_analyze(PgStat_MsgAnalyze *msg, int len)
 		tabentry->analyze_timestamp = msg->m_analyzetime;
 		tabentry->analyze_count++;
 	}
+
+	dshash_release_lock(pgStatTabTable, shentry);
 }
 
 
 /* ----------
- * pgstat_recv_archiver() -
+ * pgstat_apply_archiver() -
  *
- *	Process a ARCHIVER message.
+ *	Process a ARCHIVER message.  The archiver is not attached to the DSA
+ *	area (it has no PGPROC), so its statistics live in the control struct.
  * ----------
  */
 static void
-pgstat_recv_archiver(PgStat_MsgArchiver *msg, int len)
+pgstat_apply_archiver(PgStat_MsgArchiver *msg, int len)
 {
+	PgStat_ArchiverStats *stats = &pgStatShmem->archiverStats;
+
+	SpinLockAcquire(&pgStatShmem->mutex);
 	if (msg->m_failed)
 	{
 		/* Failed archival attempt */
-		++archiverStats.failed_count;
-		memcpy(archiverStats.last_failed_wal, msg->m_xlog,
-			   sizeof(archiverStats.last_failed_wal));
-		archiverStats.last_failed_timestamp = msg->m_timestamp;
+		++stats->failed_count;
+		memcpy(stats->last_failed_wal, msg->m_xlog,
+			   sizeof(stats->last_failed_wal));
+		stats->last_failed_timestamp = msg->m_timestamp;
 	}
 	else
 	{
 		/* Successful archival operation */
-		++archiverStats.archived_count;
-		memcpy(archiverStats.last_archived_wal, msg->m_xlog,
-			   sizeof(archiverStats.last_archived_wal));
-		archiverStats.last_archived_timestamp = msg->m_timestamp;
+		++stats->archived_count;
+		memcpy(stats->last_archived_wal, msg->m_xlog,
+			   sizeof(stats->last_archived_wal));
+		stats->last_archived_timestamp = msg->m_timestamp;
 	}
+	SpinLockRelease(&pgStatShmem->mutex);
 }
 
 /* ----------
- * pgstat_recv_bgwriter() -
+ * pgstat_apply_bgwriter() -
  *
  *	Process a BGWRITER message.
  * ----------
  */
 static void
-pgstat_recv_bgwriter(PgStat_MsgBgWriter *msg, int len)
+pgstat_apply_bgwriter(PgStat_MsgBgWriter *msg, int len)
 {
-	globalStats.timed_checkpoints += msg->m_timed_checkpoints;
-	globalStats.requested_checkpoints += msg->m_requested_checkpoints;
-	globalStats.checkpoint_write_time += msg->m_checkpoint_write_time;
-	globalStats.checkpoint_sync_time += msg->m_checkpoint_sync_time;
-	globalStats.buf_written_checkpoints += msg->m_buf_written_checkpoints;
-	globalStats.buf_written_clean += msg->m_buf_written_clean;
-	globalStats.maxwritten_clean += msg->m_maxwritten_clean;
-	globalStats.buf_written_backend += msg->m_buf_written_backend;
-	globalStats.buf_fsync_backend += msg->m_buf_fsync_backend;
-	globalStats.buf_alloc += msg->m_buf_alloc;
+	PgStat_GlobalStats *stats = &pgStatShmem->globalStats;
+
+	SpinLockAcquire(&pgStatShmem->mutex);
+	stats->timed_checkpoints += msg->m_timed_checkpoints;
+	stats->requested_checkpoints += msg->m_requested_checkpoints;
+	stats->checkpoint_write_time += msg->m_checkpoint_write_time;
+	stats->checkpoint_sync_time += msg->m_checkpoint_sync_time;
+	stats->buf_written_checkpoints += msg->m_buf_written_checkpoints;
+	stats->buf_written_clean += msg->m_buf_written_clean;
+	stats->maxwritten_clean += msg->m_maxwritten_clean;
+	stats->buf_written_backend += msg->m_buf_written_backend;
+	stats->buf_fsync_backend += msg->m_buf_fsync_backend;
+	stats->buf_alloc += msg->m_buf_alloc;
+	SpinLockRelease(&pgStatShmem->mutex);
 }
 
 /* ----------
- * pgstat_recv_recoveryconflict() -
+ * pgstat_apply_recoveryconflict() -
  *
  *	Process a RECOVERYCONFLICT message.
  * ----------
  */
 static void
-pgstat_recv_recoveryconflict(PgStat_MsgRecoveryConflict *msg, int len)
+pgstat_apply_recoveryconflict(PgStat_MsgRecoveryConflict *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
 
@@ -6041,32 +5166,36 @@ pgstat_recv_recoveryconflict(PgStat_MsgRecoveryConflict *msg, int len)
 			dbentry->n_conflict_startup_deadlock++;
 			break;
 	}
+
+	dshash_release_lock(pgStatDBTable, dbentry);
 }
 
 /* ----------
- * pgstat_recv_deadlock() -
+ * pgstat_apply_deadlock() -
  *
  *	Process a DEADLOCK message.
  * ----------
  */
 static void
-pgstat_recv_deadlock(PgStat_MsgDeadlock *msg, int len)
+pgstat_apply_deadlock(PgStat_MsgDeadlock *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
 
 	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
 
 	dbentry->n_deadlocks++;
+
+	dshash_release_lock(pgStatDBTable, dbentry);
 }
 
 /* ----------
- * pgstat_recv_tempfile() -
+ * pgstat_apply_tempfile() -
  *
  *	Process a TEMPFILE message.
  * ----------
  */
 static void
-pgstat_recv_tempfile(PgStat_MsgTempFile *msg, int len)
+pgstat_apply_tempfile(PgStat_MsgTempFile *msg, int len)
 {
 	PgStat_StatDBEntry *dbentry;
 
@@ -6074,33 +5203,41 @@ pgstat_recv_tempfile(PgStat_MsgTempFile *msg, int len)
 
 	dbentry->n_temp_bytes += msg->m_filesize;
 	dbentry->n_temp_files += 1;
+
+	dshash_release_lock(pgStatDBTable, dbentry);
 }
 
 /* ----------
- * pgstat_recv_funcstat() -
+ * pgstat_apply_funcstat() -
  *
  *	Count what the backend has done.
  * ----------
  */
 static void
-pgstat_recv_funcstat(PgStat_MsgFuncstat *msg, int len)
+pgstat_apply_funcstat(PgStat_MsgFuncstat *msg, int len)
 {
 	PgStat_FunctionEntry *funcmsg = &(msg->m_entry[0]);
 	PgStat_StatDBEntry *dbentry;
-	PgStat_StatFuncEntry *funcentry;
+	PgStat_ObjKey key;
 	int			i;
-	bool		found;
 
+	/* Make sure the database is known */
 	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
+	dshash_release_lock(pgStatDBTable, dbentry);
+
+	key.databaseid = msg->m_databaseid;
 
 	/*
 	 * Process all function entries in the message.
 	 */
 	for (i = 0; i < msg->m_nentries; i++, funcmsg++)
 	{
-		funcentry = (PgStat_StatFuncEntry *) hash_search(dbentry->functions,
-												   (void *) &(funcmsg->f_id),
-														 HASH_ENTER, &found);
+		PgStat_SharedFuncEntry *shentry;
+		bool		found;
+
+		key.objectid = funcmsg->f_id;
+		shentry = (PgStat_SharedFuncEntry *)
+			dshash_find_or_insert(pgStatFuncTable, &key, &found);
 
 		if (!found)
 		{
@@ -6108,41 +5245,40 @@ pgstat_recv_funcstat(PgStat_MsgFuncstat *msg, int len)
 			 * If it's a new function entry, initialize counters to the values
 			 * we just got.
 			 */
-			funcentry->f_numcalls = funcmsg->f_numcalls;
-			funcentry->f_total_time = funcmsg->f_total_time;
-			funcentry->f_self_time = funcmsg->f_self_time;
+			shentry->stats.functionid = funcmsg->f_id;
+			shentry->stats.f_numcalls = funcmsg->f_numcalls;
+			shentry->stats.f_total_time = funcmsg->f_total_time;
+			shentry->stats.f_self_time = funcmsg->f_self_time;
 		}
 		else
 		{
 			/*
 			 * Otherwise add the values to the existing entry.
 			 */
-			funcentry->f_numcalls += funcmsg->f_numcalls;
-			funcentry->f_total_time += funcmsg->f_total_time;
-			funcentry->f_self_time += funcmsg->f_self_time;
+			shentry->stats.f_numcalls += funcmsg->f_numcalls;
+			shentry->stats.f_total_time += funcmsg->f_total_time;
+			shentry->stats.f_self_time += funcmsg->f_self_time;
 		}
+
+		dshash_release_lock(pgStatFuncTable, shentry);
 	}
 }
 
 /* ----------
- * pgstat_recv_funcpurge() -
+ * pgstat_apply_funcpurge() -
  *
  *	Arrange for dead function removal.
  * ----------
  */
 static void
-pgstat_recv_funcpurge(PgStat_MsgFuncpurge *msg, int len)
+pgstat_apply_funcpurge(PgStat_MsgFuncpurge *msg, int len)
 {
-	PgStat_StatDBEntry *dbentry;
+	PgStat_ObjKey key;
 	int			i;
 
-	dbentry = pgstat_get_db_entry(msg->m_databaseid, false);
+	pgstat_attach_shmem();
 
-	/*
-	 * No need to purge if we don't even know the database.
-	 */
-	if (!dbentry || !dbentry->functions)
-		return;
+	key.databaseid = msg->m_databaseid;
 
 	/*
 	 * Process all function entries in the message.
@@ -6150,49 +5286,7 @@ pgstat_recv_funcpurge(PgStat_MsgFuncpurge *msg, int len)
 	for (i = 0; i < msg->m_nentries; i++)
 	{
 		/* Remove from hashtable if present; we don't care if it's not. */
-		(void) hash_search(dbentry->functions,
-						   (void *) &(msg->m_functionid[i]),
-						   HASH_REMOVE, NULL);
+		key.objectid = msg->m_functionid[i];
+		(void) dshash_delete_key(pgStatFuncTable, &key);
 	}
 }
-
-/* ----------
- * pgstat_write_statsfile_needed() -
- *
- *	Do we need to write out any stats files?
- * ----------
- */
-static bool
-pgstat_write_statsfile_needed(void)
-{
-	if (pending_write_requests != NIL)
-		return true;
-
-	/* Everything was written recently */
-	return false;
-}
-
-/* ----------
- * pgstat_db_requested() -
- *
- *	Checks whether stats for a particular DB need to be written to a file.
- * ----------
- */
-static bool
-pgstat_db_requested(Oid databaseid)
-{
-	/*
-	 * If any requests are outstanding at all, we should write the stats for
-	 * shared catalogs (the "database" with OID 0).  This ensures that
-	 * backends will see up-to-date stats for shared catalogs, even though
-	 * they send inquiry messages mentioning only their own DB.
-	 */
-	if (databaseid == InvalidOid && pending_write_requests != NIL)
-		return true;
-
-	/* Search to see if there's an open request to write this database. */
-	if (list_member_oid(pending_write_requests, databaseid))
-		return true;
-
-	return false;
-}
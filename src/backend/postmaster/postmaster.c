@@ -112,6 +112,7 @@
 #include "postmaster/fork_process.h"
 #include "postmaster/pgarch.h"
 #include "postmaster/postmaster.h"
+#include "postmaster/proxy.h"
 #include "postmaster/syslogger.h"
 #include "replication/logicallauncher.h"
 #include "replication/walsender.h"
@@ -214,6 +215,18 @@ int			ReservedBackends;
 #define MAXLISTEN	64
 static pgsocket ListenSocket[MAXLISTEN];
 
+/* The sockets we're listening to for connection proxies (see proxy.c) */
+static pgsocket ProxyListenSocket[MAXLISTEN];
+
+/*
+ * PIDs of the connection proxies, and the socket pairs we talk to them
+ * through: [0] is our end, [1] the proxy's.  NextProxy is the proxy that
+ * gets the next client.
+ */
+static pid_t ProxyPID[MAX_CONNECTION_PROXIES];
+static pgsocket ProxyChannel[MAX_CONNECTION_PROXIES][2];
+static int	NextProxy = 0;
+
 /*
  * Set by the -o option
  */
@@ -251,7 +264,6 @@ static pid_t StartupPID = 0,
 			WalReceiverPID = 0,
 			AutoVacPID = 0,
 			PgArchPID = 0,
-			PgStatPID = 0,
 			SysLoggerPID = 0;
 
 /* Startup process's status */
@@ -406,6 +418,12 @@ static void BackendInitialize(Port *port);
 static void BackendRun(Port *port) pg_attribute_noreturn();
 static void ExitPostmaster(int status) pg_attribute_noreturn();
 static int	ServerLoop(void);
+#ifdef USE_CONNECTION_PROXIES
+static void DispatchToProxy(Port *port);
+static void HandleProxyRequests(int id);
+static Port *ProxyConnCreate(pgsocket sock);
+#endif
+static void SignalConnectionProxies(int signal);
 static int	BackendStartup(Port *port);
 static int	ProcessStartupPacket(Port *port, bool SSLdone);
 static void processCancelRequest(Port *port, void *pkt);
@@ -501,7 +519,7 @@ typedef struct
 	PGPROC	   *AuxiliaryProcs;
 	PGPROC	   *PreparedXactProcs;
 	PMSignalData *PMSignalState;
-	InheritableSocket pgStatSock;
+	PgStat_ShmemControl *pgStatShmem;
 	pid_t		PostmasterPid;
 	TimestampTz PgStartTime;
 	TimestampTz PgReloadTime;
@@ -613,8 +631,8 @@ PostmasterMain(int argc, char *argv[])
 	 * CAUTION: when changing this list, check for side-effects on the signal
 	 * handling setup of child processes.  See tcop/postgres.c,
 	 * bootstrap/bootstrap.c, postmaster/bgwriter.c, postmaster/walwriter.c,
-	 * postmaster/autovacuum.c, postmaster/pgarch.c, postmaster/pgstat.c,
-	 * postmaster/syslogger.c, postmaster/bgworker.c and
+	 * postmaster/autovacuum.c, postmaster/pgarch.c, postmaster/syslogger.c,
+	 * postmaster/bgworker.c and
 	 * postmaster/checkpointer.c.
 	 */
 	pqinitmask();
@@ -969,7 +987,22 @@ PostmasterMain(int argc, char *argv[])
 	 * charged with closing the sockets again at postmaster shutdown.
 	 */
 	for (i = 0; i < MAXLISTEN; i++)
+	{
 		ListenSocket[i] = PGINVALID_SOCKET;
+		ProxyListenSocket[i] = PGINVALID_SOCKET;
+	}
+	for (i = 0; i < MAX_CONNECTION_PROXIES; i++)
+	{
+		ProxyPID[i] = 0;
+		ProxyChannel[i][0] = ProxyChannel[i][1] = PGINVALID_SOCKET;
+	}
+
+#ifndef USE_CONNECTION_PROXIES
+	if (ConnectionProxiesNumber > 0)
+		ereport(FATAL,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("connection proxies are not supported on this platform")));
+#endif
 
 	on_proc_exit(CloseServerPorts, 0);
 
@@ -1022,6 +1055,17 @@ PostmasterMain(int argc, char *argv[])
 				ereport(WARNING,
 						(errmsg("could not create listen socket for \"%s\"",
 								curhost)));
+
+			/* Listen for clients of the connection proxies, too */
+			if (ConnectionProxiesNumber > 0 &&
+				StreamServerPort(AF_UNSPEC,
+								 strcmp(curhost, "*") == 0 ? NULL : curhost,
+								 (unsigned short) ProxyPortNumber,
+								 NULL,
+								 ProxyListenSocket, MAXLISTEN) != STATUS_OK)
+				ereport(WARNING,
+						(errmsg("could not create connection proxy listen socket for \"%s\"",
+								curhost)));
 		}
 
 		if (!success && elemlist != NIL)
@@ -1129,6 +1173,32 @@ PostmasterMain(int argc, char *argv[])
 		ereport(FATAL,
 				(errmsg("no socket created for listening")));
 
+#ifdef USE_CONNECTION_PROXIES
+
+	/*
+	 * Set up the channels to the connection proxies.  Datagram sockets keep
+	 * requests, and the sockets passed with them, apart.
+	 */
+	if (ConnectionProxiesNumber > 0)
+	{
+		if (ProxyListenSocket[0] == PGINVALID_SOCKET)
+			ereport(FATAL,
+					(errmsg("no socket created for connection proxies")));
+
+		for (i = 0; i < ConnectionProxiesNumber; i++)
+		{
+			if (socketpair(AF_UNIX, SOCK_DGRAM, 0, ProxyChannel[i]) < 0)
+				ereport(FATAL,
+						(errcode_for_socket_access(),
+						 errmsg("could not create connection proxy channel: %m")));
+			if (!pg_set_noblock(ProxyChannel[i][0]))
+				ereport(FATAL,
+						(errcode_for_socket_access(),
+						 errmsg("could not set connection proxy channel to nonblocking mode: %m")));
+		}
+	}
+#endif
+
 	/*
 	 * If no valid TCP ports, write an empty line for listen address,
 	 * indicating the Unix socket must be used.  Note that this line is not
@@ -1263,12 +1333,6 @@ PostmasterMain(int argc, char *argv[])
 
 	whereToSendOutput = DestNone;
 
-	/*
-	 * Initialize stats collection subsystem (this does NOT start the
-	 * collector process!)
-	 */
-	pgstat_init();
-
 	/*
 	 * Initialize the autovacuum subsystem (again, no process start yet)
 	 */
@@ -1366,6 +1430,11 @@ CloseServerPorts(int status, Datum arg)
 			StreamClose(ListenSocket[i]);
 			ListenSocket[i] = PGINVALID_SOCKET;
 		}
+		if (ProxyListenSocket[i] != PGINVALID_SOCKET)
+		{
+			StreamClose(ProxyListenSocket[i]);
+			ProxyListenSocket[i] = PGINVALID_SOCKET;
+		}
 	}
 
 	/*
@@ -1737,6 +1806,32 @@ ServerLoop(void)
 					}
 				}
 			}
+
+#ifdef USE_CONNECTION_PROXIES
+			for (i = 0; i < MAXLISTEN; i++)
+			{
+				if (ProxyListenSocket[i] == PGINVALID_SOCKET)
+					break;
+				if (FD_ISSET(ProxyListenSocket[i], &rmask))
+				{
+					Port	   *port;
+
+					port = ConnCreate(ProxyListenSocket[i]);
+					if (port)
+					{
+						DispatchToProxy(port);
+						StreamClose(port->sock);
+						ConnFree(port);
+					}
+				}
+			}
+
+			for (i = 0; i < ConnectionProxiesNumber; i++)
+			{
+				if (FD_ISSET(ProxyChannel[i][0], &rmask))
+					HandleProxyRequests(i);
+			}
+#endif
 		}
 
 		/* If we have lost the log collector, try to start a new one */
@@ -1780,15 +1875,24 @@ ServerLoop(void)
 				start_autovac_launcher = false; /* signal processed */
 		}
 
-		/* If we have lost the stats collector, try to start a new one */
-		if (PgStatPID == 0 &&
-			(pmState == PM_RUN || pmState == PM_HOT_STANDBY))
-			PgStatPID = pgstat_start();
-
 		/* If we have lost the archiver, try to start a new one. */
 		if (PgArchPID == 0 && PgArchStartupAllowed())
 			PgArchPID = pgarch_start();
 
+#ifdef USE_CONNECTION_PROXIES
+		/* Likewise for the connection proxies */
+		if (pmState == PM_RUN && Shutdown == NoShutdown)
+		{
+			int			i;
+
+			for (i = 0; i < ConnectionProxiesNumber; i++)
+			{
+				if (ProxyPID[i] == 0)
+					ProxyPID[i] = ConnectionProxyStart(i, ProxyChannel[i][1]);
+			}
+		}
+#endif
+
 		/* If we need to signal the autovacuum launcher, do so now */
 		if (avlauncher_needs_signal)
 		{
@@ -1897,6 +2001,30 @@ initMasks(fd_set *rmask)
 			maxsock = fd;
 	}
 
+	for (i = 0; i < MAXLISTEN; i++)
+	{
+		int			fd = ProxyListenSocket[i];
+
+		if (fd == PGINVALID_SOCKET)
+			break;
+		FD_SET(fd, rmask);
+
+		if (fd > maxsock)
+			maxsock = fd;
+	}
+
+	for (i = 0; i < ConnectionProxiesNumber; i++)
+	{
+		int			fd = ProxyChannel[i][0];
+
+		if (fd == PGINVALID_SOCKET)
+			continue;
+		FD_SET(fd, rmask);
+
+		if (fd > maxsock)
+			maxsock = fd;
+	}
+
 	return maxsock + 1;
 }
 
@@ -2406,6 +2534,131 @@ ConnFree(Port *conn)
 	free(conn);
 }
 
+#ifdef USE_CONNECTION_PROXIES
+
+/*
+ * DispatchToProxy -- pass a client connection on to a connection proxy
+ *
+ * The proxies take turns.  If none can take the connection, the client is
+ * simply disconnected.
+ */
+static void
+DispatchToProxy(Port *port)
+{
+	ProxyRequest req;
+	int			i;
+
+	req.type = PROXY_REQ_CLIENT;
+	req.pid = 0;
+	req.key = 0;
+
+	for (i = 0; i < ConnectionProxiesNumber; i++)
+	{
+		int			id = NextProxy;
+
+		NextProxy = (NextProxy + 1) % ConnectionProxiesNumber;
+		if (ProxyPID[id] != 0 &&
+			ProxySendRequest(ProxyChannel[id][0], &req, port->sock))
+			return;
+	}
+
+	ereport(LOG,
+			(errmsg("could not pass connection to a connection proxy")));
+}
+
+/*
+ * HandleProxyRequests -- process requests from a connection proxy
+ *
+ * A proxy asks us to start pooled backends, handing us the client end of
+ * their connections, and to relay cancel requests meant for other proxies.
+ */
+static void
+HandleProxyRequests(int id)
+{
+	ProxyRequest req;
+	pgsocket	sock;
+
+	while (ProxyReceiveRequest(ProxyChannel[id][0], &req, &sock))
+	{
+		if (req.type == PROXY_REQ_BACKEND && sock != PGINVALID_SOCKET)
+		{
+			Port	   *port = ProxyConnCreate(sock);
+
+			BackendStartup(port);
+
+			/*
+			 * We no longer need the open socket or port structure in this
+			 * process
+			 */
+			StreamClose(port->sock);
+			ConnFree(port);
+			continue;
+		}
+
+		if (req.type == PROXY_REQ_CANCEL)
+		{
+			int			i;
+
+			for (i = 0; i < ConnectionProxiesNumber; i++)
+			{
+				if (ProxyPID[i] != 0 && ProxyPID[i] == req.pid && i != id)
+				{
+					(void) ProxySendRequest(ProxyChannel[i][0], &req,
+											PGINVALID_SOCKET);
+					break;
+				}
+			}
+		}
+
+		if (sock != PGINVALID_SOCKET)
+			closesocket(sock);
+	}
+}
+
+/*
+ * ProxyConnCreate -- create the connection data structure for a pooled
+ * backend, whose client is a connection proxy on the other end of sock
+ */
+static Port *
+ProxyConnCreate(pgsocket sock)
+{
+	Port	   *port;
+
+	if (!(port = (Port *) calloc(1, sizeof(Port))))
+	{
+		ereport(LOG,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+		ExitPostmaster(1);
+	}
+
+	port->sock = sock;
+	port->pooled = true;
+
+	/*
+	 * The socket is one end of an unnamed Unix-domain socket pair.  The
+	 * backend learns the address of each client from the proxy.
+	 */
+	port->laddr.addr.ss_family = AF_UNIX;
+	port->laddr.salen = sizeof(struct sockaddr_un);
+	port->raddr.addr.ss_family = AF_UNIX;
+	port->raddr.salen = sizeof(struct sockaddr_un);
+
+#if defined(ENABLE_GSS) || defined(ENABLE_SSPI)
+	port->gss = (pg_gssinfo *) calloc(1, sizeof(pg_gssinfo));
+	if (!port->gss)
+	{
+		ereport(LOG,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+		ExitPostmaster(1);
+	}
+#endif
+
+	return port;
+}
+#endif   /* USE_CONNECTION_PROXIES */
+
 
 /*
  * ClosePostmasterPorts -- close all the postmaster's open sockets
@@ -2444,6 +2697,26 @@ ClosePostmasterPorts(bool am_syslogger)
 			StreamClose(ListenSocket[i]);
 			ListenSocket[i] = PGINVALID_SOCKET;
 		}
+		if (ProxyListenSocket[i] != PGINVALID_SOCKET)
+		{
+			StreamClose(ProxyListenSocket[i]);
+			ProxyListenSocket[i] = PGINVALID_SOCKET;
+		}
+	}
+
+	/* Close the connection proxy channels */
+	for (i = 0; i < MAX_CONNECTION_PROXIES; i++)
+	{
+		if (ProxyChannel[i][0] != PGINVALID_SOCKET)
+		{
+			closesocket(ProxyChannel[i][0]);
+			ProxyChannel[i][0] = PGINVALID_SOCKET;
+		}
+		if (ProxyChannel[i][1] != PGINVALID_SOCKET)
+		{
+			closesocket(ProxyChannel[i][1]);
+			ProxyChannel[i][1] = PGINVALID_SOCKET;
+		}
 	}
 
 	/* If using syslogger, close the read side of the pipe */
@@ -2518,8 +2791,7 @@ SIGHUP_handler(SIGNAL_ARGS)
 			signal_child(PgArchPID, SIGHUP);
 		if (SysLoggerPID != 0)
 			signal_child(SysLoggerPID, SIGHUP);
-		if (PgStatPID != 0)
-			signal_child(PgStatPID, SIGHUP);
+		SignalConnectionProxies(SIGHUP);
 
 		/* Reload authentication config files too */
 		if (!load_hba())
@@ -2608,6 +2880,13 @@ pmdie(SIGNAL_ARGS)
 				if (WalWriterPID != 0)
 					signal_child(WalWriterPID, SIGTERM);
 
+				/*
+				 * Connection proxies go away right away too.  Their clients
+				 * lose their connections, and the pooled backends exit once
+				 * the proxies are gone; they can't outlive the proxies.
+				 */
+				SignalConnectionProxies(SIGTERM);
+
 				/*
 				 * If we're in recovery, we can't kill the startup process
 				 * right away, because at present doing so does not release
@@ -2682,6 +2961,8 @@ pmdie(SIGNAL_ARGS)
 				/* and the walwriter too */
 				if (WalWriterPID != 0)
 					signal_child(WalWriterPID, SIGTERM);
+				/* and the connection proxies */
+				SignalConnectionProxies(SIGTERM);
 				pmState = PM_WAIT_BACKENDS;
 			}
 
@@ -2841,8 +3122,6 @@ reaper(SIGNAL_ARGS)
 				AutoVacPID = StartAutoVacLauncher();
 			if (PgArchStartupAllowed() && PgArchPID == 0)
 				PgArchPID = pgarch_start();
-			if (PgStatPID == 0)
-				PgStatPID = pgstat_start();
 
 			/* workers may be scheduled to start now */
 			maybe_start_bgworker();
@@ -2907,13 +3186,6 @@ reaper(SIGNAL_ARGS)
 				SignalChildren(SIGUSR2);
 
 				pmState = PM_SHUTDOWN_2;
-
-				/*
-				 * We can also shut down the stats collector now; there's
-				 * nothing left for it to do.
-				 */
-				if (PgStatPID != 0)
-					signal_child(PgStatPID, SIGQUIT);
 			}
 			else
 			{
@@ -2990,19 +3262,27 @@ reaper(SIGNAL_ARGS)
 		}
 
 		/*
-		 * Was it the statistics collector?  If so, just try to start a new
-		 * one; no need to force reset of the rest of the system.  (If fail,
-		 * we'll try again in future cycles of the main loop.)
+		 * Was it a connection proxy?  Its clients have lost their sessions,
+		 * but the proxy doesn't touch shared memory, so there's no need to
+		 * reset the system; just let the main loop start a new one.
 		 */
-		if (pid == PgStatPID)
+		if (ConnectionProxiesNumber > 0)
 		{
-			PgStatPID = 0;
-			if (!EXIT_STATUS_0(exitstatus))
-				LogChildExit(LOG, _("statistics collector process"),
-							 pid, exitstatus);
-			if (pmState == PM_RUN || pmState == PM_HOT_STANDBY)
-				PgStatPID = pgstat_start();
-			continue;
+			int			i;
+
+			for (i = 0; i < ConnectionProxiesNumber; i++)
+			{
+				if (pid == ProxyPID[i])
+					break;
+			}
+			if (i < ConnectionProxiesNumber)
+			{
+				ProxyPID[i] = 0;
+				if (!EXIT_STATUS_0(exitstatus))
+					LogChildExit(LOG, _("connection proxy"),
+								 pid, exitstatus);
+				continue;
+			}
 		}
 
 		/* Was it the system logger?  If so, try to start a new one */
@@ -3450,22 +3730,6 @@ HandleChildCrash(int pid, int exitstatus, const char *procname)
 		signal_child(PgArchPID, SIGQUIT);
 	}
 
-	/*
-	 * Force a power-cycle of the pgstat process too.  (This isn't absolutely
-	 * necessary, but it seems like a good idea for robustness, and it
-	 * simplifies the state-machine logic in the case where a shutdown request
-	 * arrives during crash processing.)
-	 */
-	if (PgStatPID != 0 && take_action)
-	{
-		ereport(DEBUG2,
-				(errmsg_internal("sending %s to process %d",
-								 "SIGQUIT",
-								 (int) PgStatPID)));
-		signal_child(PgStatPID, SIGQUIT);
-		allow_immediate_pgstat_restart();
-	}
-
 	/* We do NOT restart the syslogger */
 
 	if (Shutdown != ImmediateShutdown)
@@ -3665,12 +3929,10 @@ PostmasterStateMachine(void)
 					FatalError = true;
 					pmState = PM_WAIT_DEAD_END;
 
-					/* Kill the walsenders, archiver and stats collector too */
+					/* Kill the walsenders and archiver too */
 					SignalChildren(SIGQUIT);
 					if (PgArchPID != 0)
 						signal_child(PgArchPID, SIGQUIT);
-					if (PgStatPID != 0)
-						signal_child(PgStatPID, SIGQUIT);
 				}
 			}
 		}
@@ -3698,10 +3960,9 @@ PostmasterStateMachine(void)
 	{
 		/*
 		 * PM_WAIT_DEAD_END state ends when the BackendList is entirely empty
-		 * (ie, no dead_end children remain), and the archiver and stats
-		 * collector are gone too.
+		 * (ie, no dead_end children remain), and the archiver is gone too.
 		 *
-		 * The reason we wait for those two is to protect them against a new
+		 * The reason we wait for the archiver is to protect it against a new
 		 * postmaster starting conflicting subprocesses; this isn't an
 		 * ironclad protection, but it at least helps in the
 		 * shutdown-and-immediately-restart scenario.  Note that they have
@@ -3710,7 +3971,7 @@ PostmasterStateMachine(void)
 		 * FatalError processing.
 		 */
 		if (dlist_is_empty(&BackendList) &&
-			PgArchPID == 0 && PgStatPID == 0)
+			PgArchPID == 0)
 		{
 			/* These other guys should be dead already */
 			Assert(StartupPID == 0);
@@ -3906,8 +4167,22 @@ TerminateChildren(int signal)
 		signal_child(AutoVacPID, signal);
 	if (PgArchPID != 0)
 		signal_child(PgArchPID, signal);
-	if (PgStatPID != 0)
-		signal_child(PgStatPID, signal);
+	SignalConnectionProxies(signal);
+}
+
+/*
+ * Send a signal to all running connection proxies.
+ */
+static void
+SignalConnectionProxies(int signal)
+{
+	int			i;
+
+	for (i = 0; i < ConnectionProxiesNumber; i++)
+	{
+		if (ProxyPID[i] != 0)
+			signal_child(ProxyPID[i], signal);
+	}
 }
 
 /*
@@ -4730,7 +5005,8 @@ SubPostmasterMain(int argc, char *argv[])
 		strcmp(argv[1], "--forkavlauncher") == 0 ||
 		strcmp(argv[1], "--forkavworker") == 0 ||
 		strcmp(argv[1], "--forkboot") == 0 ||
-		strncmp(argv[1], "--forkbgworker=", 15) == 0)
+		strncmp(argv[1], "--forkbgworker=", 15) == 0 ||
+		strcmp(argv[1], "--forkarch") == 0)
 		PGSharedMemoryReAttach();
 	else
 		PGSharedMemoryNoReAttach();
@@ -4879,16 +5155,15 @@ SubPostmasterMain(int argc, char *argv[])
 	}
 	if (strcmp(argv[1], "--forkarch") == 0)
 	{
-		/* Do not want to attach to shared memory */
+		/*
+		 * The archiver has no PGPROC, so it can't run
+		 * CreateSharedMemoryAndSemaphores; it only needs the statistics
+		 * area, whose address was passed down in the backend variables.
+		 */
+		InitShmemAccess(UsedShmemSegAddr);
 
 		PgArchiverMain(argc, argv);		/* does not return */
 	}
-	if (strcmp(argv[1], "--forkcol") == 0)
-	{
-		/* Do not want to attach to shared memory */
-
-		PgstatCollectorMain(argc, argv);		/* does not return */
-	}
 	if (strcmp(argv[1], "--forklog") == 0)
 	{
 		/* Do not want to attach to shared memory */
@@ -4993,12 +5268,6 @@ sigusr1_handler(SIGNAL_ARGS)
 	if (CheckPostmasterSignal(PMSIGNAL_BEGIN_HOT_STANDBY) &&
 		pmState == PM_RECOVERY && Shutdown == NoShutdown)
 	{
-		/*
-		 * Likewise, start other special children as needed.
-		 */
-		Assert(PgStatPID == 0);
-		PgStatPID = pgstat_start();
-
 		ereport(LOG,
 		(errmsg("database system is ready to accept read only connections")));
 
@@ -5812,8 +6081,8 @@ extern slock_t *ShmemLock;
 extern slock_t *ProcStructLock;
 extern PGPROC *AuxiliaryProcs;
 extern PMSignalData *PMSignalState;
-extern pgsocket pgStatSock;
 extern pg_time_t first_syslogger_file_time;
+extern PgStat_ShmemControl *pgStatShmem;
 
 #ifndef WIN32
 #define write_inheritable_socket(dest, src, childpid) ((*(dest) = (src)), true)
@@ -5865,8 +6134,7 @@ save_backend_variables(BackendParameters *param, Port *port,
 	param->AuxiliaryProcs = AuxiliaryProcs;
 	param->PreparedXactProcs = PreparedXactProcs;
 	param->PMSignalState = PMSignalState;
-	if (!write_inheritable_socket(&param->pgStatSock, pgStatSock, childPid))
-		return false;
+	param->pgStatShmem = pgStatShmem;
 
 	param->PostmasterPid = PostmasterPid;
 	param->PgStartTime = PgStartTime;
@@ -6098,7 +6366,7 @@ restore_backend_variables(BackendParameters *param, Port *port)
 	AuxiliaryProcs = param->AuxiliaryProcs;
 	PreparedXactProcs = param->PreparedXactProcs;
 	PMSignalState = param->PMSignalState;
-	read_inheritable_socket(&pgStatSock, &param->pgStatSock);
+	pgStatShmem = param->pgStatShmem;
 
 	PostmasterPid = param->PostmasterPid;
 	PgStartTime = param->PgStartTime;
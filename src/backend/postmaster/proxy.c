@@ -0,0 +1,1659 @@
+/*-------------------------------------------------------------------------
+ *
+ * proxy.c
+ *
+ *	Connection proxies, multiplexing client sessions onto pooled backends
+ *
+ *	When connection_proxies is set, the postmaster listens on proxy_port in
+ *	addition to the regular port, and hands every connection accepted there
+ *	to one of the proxy processes.  A proxy reads the client's startup packet
+ *	and puts the client in the session pool for that exact startup packet,
+ *	that is, for the same database, user and options.  The backends of a pool
+ *	are forked by the postmaster like any other backend, except that their
+ *	"client" socket is one end of a socket pair held by the proxy.  They are
+ *	marked as pooled, which makes them skip authentication at startup and
+ *	instead authenticate each client that the proxy hands to them (see
+ *	ProcessPooledSessionStartup in postgres.c).
+ *
+ *	A client is attached to a backend only for the duration of a transaction.
+ *	Before each ReadyForQuery sent outside a transaction block, a pooled
+ *	backend tells the proxy whether its session has acquired state that
+ *	would be lost, or would leak into other clients' sessions, if the next
+ *	transaction ran elsewhere: temporary tables, prepared statements,
+ *	session-level locks, LISTEN registrations, held cursors or parameters
+ *	changed with SET.  The proxy then either puts the backend back in the
+ *	pool, or dedicates it to the client for the rest of the session.  At most
+ *	session_pool_size backends of each pool are shared; clients that want to
+ *	run a transaction while all of them are busy wait in a queue.
+ *
+ *	The proxy relays the frontend/backend protocol message by message, so
+ *	that it can tell where transactions end; it never looks inside messages
+ *	other than the few it needs to follow the session.  Only protocol 3.0 is
+ *	supported, and SSL requests are declined.
+ *
+ *	Cancel requests arriving at a proxy are matched against the cancel keys
+ *	the proxy handed out to its own clients in place of the backends' ones,
+ *	and turned into a signal to whichever backend the client is attached to.
+ *	Requests for another proxy's clients are relayed through the postmaster.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/postmaster/proxy.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "lib/ilist.h"
+#include "lib/stringinfo.h"
+#include "libpq/pqcomm.h"
+#include "libpq/pqsignal.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/fork_process.h"
+#include "postmaster/postmaster.h"
+#include "postmaster/proxy.h"
+#include "storage/dsm.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/ps_status.h"
+
+
+/* GUC options */
+int			ConnectionProxiesNumber = 0;
+int			ProxyPortNumber = 6543;
+int			SessionPoolSize = 10;
+int			MaxSessions = 1000;
+
+#ifdef USE_CONNECTION_PROXIES
+
+/* How often to attempt to restart a failed proxy; in seconds */
+#define PROXY_RESTART_INTERVAL	10
+
+/*
+ * Size of each connection's input buffer.  It must hold a complete startup
+ * packet, and is also the high-water mark of output buffers, beyond which
+ * we stop relaying data to a connection until it catches up.
+ */
+#define PROXY_BUFFER_SIZE		(MAX_STARTUP_PACKET_LENGTH + 1024)
+
+typedef enum ProxyConnState
+{
+	CONN_STARTUP,				/* client: waiting for startup packet */
+	CONN_STARTING,				/* backend: waiting for first ReadyForQuery */
+	CONN_IDLE,					/* not attached to a peer */
+	CONN_WAITING,				/* client: queued for a backend */
+	CONN_ATTACHED				/* relaying to and from the peer */
+} ProxyConnState;
+
+struct SessionPool;
+
+/*
+ * A client or backend connection of the proxy.
+ */
+typedef struct ProxyConn
+{
+	dlist_node	node;			/* in the list of all connections */
+	dlist_node	pool_node;		/* in the pool's idle or waiting list */
+	pgsocket	sock;
+	bool		is_backend;
+	ProxyConnState state;
+	struct SessionPool *pool;
+	struct ProxyConn *peer;		/* attached backend or client, if any */
+	bool		dedicated;		/* attached to the peer for good? */
+	bool		closed;			/* connection is gone, free at end of cycle */
+	bool		close_after_flush;	/* close once output is sent */
+
+	/* Input buffer, and the part of the current message not yet relayed */
+	char		rx_buf[PROXY_BUFFER_SIZE];
+	int			rx_head;
+	int			rx_tail;
+	uint32		msg_remaining;
+
+	/* Output buffer */
+	StringInfoData tx_buf;
+	int			tx_pos;
+
+	/* Registration in the proxy's wait event set */
+	int			event_pos;
+	uint32		events;
+
+	/* Client fields */
+	SockAddr	raddr;			/* client address, for authentication */
+	bool		authenticated;
+	int32		cancel_key;		/* cancel key we gave the client */
+	int			outstanding;	/* ReadyForQuery messages still to come */
+	bool		unsynced;		/* extended query messages sent since Sync? */
+
+	/* Backend fields */
+	int32		backend_pid;
+	int32		backend_key;
+	char		session_state;	/* last PROXY_MSG_SESSION_STATE reported */
+	StringInfo	startup_error;	/* ErrorResponse received during startup */
+} ProxyConn;
+
+/*
+ * Clients using the same startup packet, and the backends serving them.
+ */
+typedef struct SessionPool
+{
+	dlist_node	node;			/* in the list of all pools */
+	char	   *startup_packet; /* startup packet, less the length word */
+	int			startup_len;
+	dlist_head	idle_backends;	/* shared backends not attached to a client */
+	dlist_head	waiting_clients;	/* clients waiting for a backend */
+	int			n_backends;		/* shared backends, including starting ones */
+	int			n_starting;		/* backends not yet ready for queries */
+	int			n_waiting;		/* length of waiting_clients */
+} SessionPool;
+
+/* What to do with a message, as decided by the message handlers */
+typedef enum
+{
+	MSG_WAIT,					/* can't proceed yet; stop processing input */
+	MSG_FORWARD,				/* relay it to the peer */
+	MSG_DISCARD,				/* skip it */
+	MSG_CONSUMED				/* handled and removed from the buffer */
+} ProxyMsgAction;
+
+/* ----------
+ * Local data
+ * ----------
+ */
+static time_t last_proxy_start_time[MAX_CONNECTION_PROXIES];
+
+static pgsocket PostmasterChannel = PGINVALID_SOCKET;
+static MemoryContext ProxyContext = NULL;
+static dlist_head all_conns = DLIST_STATIC_INIT(all_conns);
+static dlist_head all_pools = DLIST_STATIC_INIT(all_pools);
+static int	n_clients = 0;
+
+static WaitEventSet *proxy_wait_set = NULL;
+static bool wait_set_dirty = true;
+
+/*
+ * Flags set by interrupt handlers for later service in the main loop.
+ */
+static volatile sig_atomic_t got_SIGHUP = false;
+static volatile sig_atomic_t got_SIGTERM = false;
+
+/* ----------
+ * Local function forward declarations
+ * ----------
+ */
+static void ConnectionProxyMain(int id) pg_attribute_noreturn();
+static void proxy_exit(SIGNAL_ARGS);
+static void ProxySigHupHandler(SIGNAL_ARGS);
+static void ProxySigTermHandler(SIGNAL_ARGS);
+
+static void proxy_rebuild_wait_set(void);
+static void proxy_handle_postmaster(void);
+static void proxy_add_client(pgsocket sock);
+static void proxy_cancel(int32 pid, int32 key);
+
+static ProxyConn *conn_create(pgsocket sock, bool is_backend);
+static void conn_close(ProxyConn *conn);
+static void conn_read(ProxyConn *conn);
+static void conn_flush(ProxyConn *conn);
+static void conn_service(ProxyConn *conn);
+static void conn_update_events(ProxyConn *conn);
+static void conn_send_error(ProxyConn *conn, const char *sqlstate,
+				const char *msg);
+static void conn_process_input(ProxyConn *conn);
+static bool client_process_startup(ProxyConn *client);
+static ProxyMsgAction client_message(ProxyConn *client, char type,
+			   uint32 len);
+static ProxyMsgAction backend_message(ProxyConn *backend, char type,
+				uint32 len);
+
+static SessionPool *pool_lookup(const char *packet, int len);
+static void pool_request_backend(ProxyConn *client);
+static void pool_launch_backends(SessionPool *pool);
+static void pool_backend_ready(ProxyConn *backend);
+static void pool_fail_waiting(SessionPool *pool, StringInfo error);
+static void attach(ProxyConn *client, ProxyConn *backend);
+static void end_of_transaction(ProxyConn *client, ProxyConn *backend);
+
+
+/* ------------------------------------------------------------
+ * Public functions follow
+ * ------------------------------------------------------------
+ */
+
+/*
+ * ProxySendRequest
+ *
+ *	Send a request datagram over a postmaster/proxy channel, passing along
+ *	the given socket unless it's PGINVALID_SOCKET.  Returns false if the
+ *	datagram could not be sent; the channels are non-blocking.
+ */
+bool
+ProxySendRequest(pgsocket chan, const ProxyRequest *req, pgsocket sock)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		struct cmsghdr hdr;
+		char		buf[CMSG_SPACE(sizeof(int))];
+	}			cmsgbuf;
+	ssize_t		rc;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = (void *) req;
+	iov.iov_len = sizeof(ProxyRequest);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+
+	if (sock != PGINVALID_SOCKET)
+	{
+		struct cmsghdr *cmsg;
+
+		memset(&cmsgbuf, 0, sizeof(cmsgbuf));
+		msg.msg_control = cmsgbuf.buf;
+		msg.msg_controllen = sizeof(cmsgbuf.buf);
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(cmsg), &sock, sizeof(int));
+	}
+
+	do
+	{
+		rc = sendmsg(chan, &msg, 0);
+	} while (rc < 0 && errno == EINTR);
+
+	return rc == sizeof(ProxyRequest);
+}
+
+/*
+ * ProxyReceiveRequest
+ *
+ *	Receive a request datagram sent by ProxySendRequest.  *sock is set to the
+ *	socket that came with it, or PGINVALID_SOCKET.  Returns false if there is
+ *	nothing (more) to receive.
+ */
+bool
+ProxyReceiveRequest(pgsocket chan, ProxyRequest *req, pgsocket *sock)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		struct cmsghdr hdr;
+		char		buf[CMSG_SPACE(sizeof(int))];
+	}			cmsgbuf;
+	struct cmsghdr *cmsg;
+	ssize_t		rc;
+
+	*sock = PGINVALID_SOCKET;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = (void *) req;
+	iov.iov_len = sizeof(ProxyRequest);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cmsgbuf.buf;
+	msg.msg_controllen = sizeof(cmsgbuf.buf);
+
+	do
+	{
+		rc = recvmsg(chan, &msg, 0);
+	} while (rc < 0 && errno == EINTR);
+
+	if (rc < 0)
+	{
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+			ereport(LOG,
+					(errcode_for_socket_access(),
+					 errmsg("could not receive from connection proxy channel: %m")));
+		return false;
+	}
+
+	for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+			memcpy(sock, CMSG_DATA(cmsg), sizeof(int));
+	}
+
+	if (rc != sizeof(ProxyRequest))
+	{
+		ereport(LOG,
+				(errmsg("invalid message on connection proxy channel")));
+		if (*sock != PGINVALID_SOCKET)
+			closesocket(*sock);
+		*sock = PGINVALID_SOCKET;
+		req->type = '\0';
+	}
+
+	return true;
+}
+
+/*
+ * ConnectionProxyStart
+ *
+ *	Called from postmaster to fire up connection proxy number id, which is
+ *	to talk to the postmaster over the given channel socket.
+ *
+ *	Returns PID of child process, or 0 if fail.
+ *
+ *	Note: if fail, we will be called again from the postmaster main loop.
+ */
+int
+ConnectionProxyStart(int id, pgsocket chan)
+{
+	time_t		curtime;
+	pid_t		proxyPid;
+
+	/*
+	 * Do nothing if too soon since last start of this proxy, to avoid
+	 * respawning it continuously if it's dying immediately at launch.
+	 */
+	curtime = time(NULL);
+	if ((unsigned int) (curtime - last_proxy_start_time[id]) <
+		(unsigned int) PROXY_RESTART_INTERVAL)
+		return 0;
+	last_proxy_start_time[id] = curtime;
+
+	switch ((proxyPid = fork_process()))
+	{
+		case -1:
+			ereport(LOG,
+					(errmsg("could not fork connection proxy: %m")));
+			return 0;
+
+		case 0:
+			/* in postmaster child ... */
+			InitPostmasterChild();
+
+			/*
+			 * Keep a copy of our end of the channel; closing the postmaster's
+			 * sockets closes the channels of all proxies.
+			 */
+			PostmasterChannel = dup(chan);
+			if (PostmasterChannel < 0)
+				ereport(FATAL,
+						(errcode_for_socket_access(),
+						 errmsg("could not duplicate connection proxy channel: %m")));
+			ClosePostmasterPorts(false);
+
+			/* Drop our connection to dynamic shared memory */
+			dsm_detach_all();
+
+			ConnectionProxyMain(id);
+			break;
+
+		default:
+			return (int) proxyPid;
+	}
+
+	/* shouldn't get here */
+	return 0;
+}
+
+
+/* ------------------------------------------------------------
+ * Local functions called by proxy follow
+ * ------------------------------------------------------------
+ */
+
+/*
+ * ConnectionProxyMain
+ *
+ *	The proxy's main loop: wait for any of our sockets to become ready, and
+ *	move data along.
+ */
+static void
+ConnectionProxyMain(int id)
+{
+	char		activity[32];
+
+	/*
+	 * Ignore all signals usually bound to some action in the postmaster,
+	 * except for SIGHUP, SIGTERM and SIGQUIT.
+	 */
+	pqsignal(SIGHUP, ProxySigHupHandler);
+	pqsignal(SIGINT, SIG_IGN);
+	pqsignal(SIGTERM, ProxySigTermHandler);
+	pqsignal(SIGQUIT, proxy_exit);
+	pqsignal(SIGALRM, SIG_IGN);
+	pqsignal(SIGPIPE, SIG_IGN);
+	pqsignal(SIGUSR1, SIG_IGN);
+	pqsignal(SIGUSR2, SIG_IGN);
+	pqsignal(SIGCHLD, SIG_DFL);
+	pqsignal(SIGTTIN, SIG_DFL);
+	pqsignal(SIGTTOU, SIG_DFL);
+	pqsignal(SIGCONT, SIG_DFL);
+	pqsignal(SIGWINCH, SIG_DFL);
+	PG_SETMASK(&UnBlockSig);
+
+	/*
+	 * Identify myself via ps
+	 */
+	snprintf(activity, sizeof(activity), "%d", id);
+	init_ps_display("connection proxy", activity, "", "");
+
+	ProxyContext = AllocSetContextCreate(TopMemoryContext,
+										 "Connection proxy",
+										 ALLOCSET_DEFAULT_SIZES);
+	MemoryContextSwitchTo(ProxyContext);
+
+	if (!pg_set_noblock(PostmasterChannel))
+		ereport(FATAL,
+				(errcode_for_socket_access(),
+				 errmsg("could not set connection proxy channel to nonblocking mode: %m")));
+
+	for (;;)
+	{
+		WaitEvent	events[64];
+		int			nevents;
+		int			i;
+		dlist_mutable_iter iter;
+
+		if (got_SIGTERM)
+			proc_exit(0);
+
+		if (got_SIGHUP)
+		{
+			got_SIGHUP = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		if (wait_set_dirty)
+			proxy_rebuild_wait_set();
+
+		nevents = WaitEventSetWait(proxy_wait_set, -1, events,
+								   lengthof(events),
+								   WAIT_EVENT_PROXY_MAIN);
+
+		for (i = 0; i < nevents; i++)
+		{
+			WaitEvent  *event = &events[i];
+			ProxyConn  *conn = (ProxyConn *) event->user_data;
+
+			if (event->events & WL_POSTMASTER_DEATH)
+				proc_exit(1);
+
+			if (event->events & WL_LATCH_SET)
+			{
+				ResetLatch(MyLatch);
+				continue;
+			}
+
+			if (conn == NULL)
+			{
+				proxy_handle_postmaster();
+				continue;
+			}
+
+			/* Skip connections closed earlier in this cycle */
+			if (conn->closed)
+				continue;
+
+			if (event->events & WL_SOCKET_WRITEABLE)
+			{
+				conn_flush(conn);
+				/* a peer that was held up by our output may proceed now */
+				if (conn->peer != NULL && !conn->closed)
+					conn_service(conn->peer);
+			}
+			if ((event->events & WL_SOCKET_READABLE) && !conn->closed)
+			{
+				conn_read(conn);
+				if (!conn->closed)
+					conn_service(conn);
+			}
+		}
+
+		/* Free connections closed in this cycle */
+		dlist_foreach_modify(iter, &all_conns)
+		{
+			ProxyConn  *conn = dlist_container(ProxyConn, node, iter.cur);
+
+			if (conn->closed)
+			{
+				dlist_delete(&conn->node);
+				if (conn->startup_error)
+				{
+					pfree(conn->startup_error->data);
+					pfree(conn->startup_error);
+				}
+				pfree(conn->tx_buf.data);
+				pfree(conn);
+			}
+		}
+	}
+}
+
+/* SIGQUIT signal handler for proxy process */
+static void
+proxy_exit(SIGNAL_ARGS)
+{
+	/* SIGQUIT means curl up and die ... */
+	exit(1);
+}
+
+/* SIGHUP signal handler for proxy process */
+static void
+ProxySigHupHandler(SIGNAL_ARGS)
+{
+	int			save_errno = errno;
+
+	/* set flag to re-read config file at next convenient time */
+	got_SIGHUP = true;
+	SetLatch(MyLatch);
+
+	errno = save_errno;
+}
+
+/* SIGTERM signal handler for proxy process */
+static void
+ProxySigTermHandler(SIGNAL_ARGS)
+{
+	int			save_errno = errno;
+
+	/*
+	 * The postmaster sends us SIGTERM when it shuts down.  Our clients lose
+	 * their connections, and the pooled backends exit when they see their
+	 * connections go away.
+	 */
+	got_SIGTERM = true;
+	SetLatch(MyLatch);
+
+	errno = save_errno;
+}
+
+/*
+ * proxy_rebuild_wait_set
+ *
+ *	Create a new wait event set covering all connections that currently wait
+ *	for something.  WaitEventSets can't forget a socket, or wait for nothing
+ *	on it, so we rebuild the set whenever a connection comes or goes, or
+ *	stops or resumes waiting altogether; mere changes of the events waited
+ *	for are applied in place by conn_update_events.
+ */
+static void
+proxy_rebuild_wait_set(void)
+{
+	dlist_iter	iter;
+	int			nevents = 3;
+
+	if (proxy_wait_set != NULL)
+		FreeWaitEventSet(proxy_wait_set);
+
+	dlist_foreach(iter, &all_conns)
+		nevents++;
+
+	proxy_wait_set = CreateWaitEventSet(ProxyContext, nevents);
+	AddWaitEventToSet(proxy_wait_set, WL_LATCH_SET, PGINVALID_SOCKET,
+					  MyLatch, NULL);
+	AddWaitEventToSet(proxy_wait_set, WL_POSTMASTER_DEATH, PGINVALID_SOCKET,
+					  NULL, NULL);
+	AddWaitEventToSet(proxy_wait_set, WL_SOCKET_READABLE, PostmasterChannel,
+					  NULL, NULL);
+
+	dlist_foreach(iter, &all_conns)
+	{
+		ProxyConn  *conn = dlist_container(ProxyConn, node, iter.cur);
+
+		if (conn->closed || conn->events == 0)
+		{
+			conn->event_pos = -1;
+			continue;
+		}
+		conn->event_pos = AddWaitEventToSet(proxy_wait_set, conn->events,
+											conn->sock, NULL, conn);
+	}
+
+	wait_set_dirty = false;
+}
+
+/*
+ * proxy_handle_postmaster
+ *
+ *	Process requests sent by the postmaster: new clients, and cancel requests
+ *	relayed from other proxies.
+ */
+static void
+proxy_handle_postmaster(void)
+{
+	ProxyRequest req;
+	pgsocket	sock;
+
+	while (ProxyReceiveRequest(PostmasterChannel, &req, &sock))
+	{
+		switch (req.type)
+		{
+			case PROXY_REQ_CLIENT:
+				if (sock != PGINVALID_SOCKET)
+					proxy_add_client(sock);
+				break;
+			case PROXY_REQ_CANCEL:
+				proxy_cancel(req.pid, req.key);
+				break;
+			default:
+				if (sock != PGINVALID_SOCKET)
+					closesocket(sock);
+				break;
+		}
+	}
+}
+
+/*
+ * proxy_add_client
+ *
+ *	Take over a client connection accepted by the postmaster.
+ */
+static void
+proxy_add_client(pgsocket sock)
+{
+	ProxyConn  *client;
+
+	if (!pg_set_noblock(sock))
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not set socket to nonblocking mode: %m")));
+		closesocket(sock);
+		return;
+	}
+
+	client = conn_create(sock, false);
+	client->state = CONN_STARTUP;
+
+	client->raddr.salen = sizeof(client->raddr.addr);
+	if (getpeername(sock, (struct sockaddr *) &client->raddr.addr,
+					&client->raddr.salen) < 0)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("getpeername() failed: %m")));
+		conn_close(client);
+		return;
+	}
+
+	if (n_clients > MaxSessions)
+	{
+		conn_send_error(client, "53300",
+						"sorry, too many clients already");
+		return;
+	}
+
+	conn_update_events(client);
+}
+
+/*
+ * proxy_cancel
+ *
+ *	Process a cancel request for one of the keys handed out by a proxy.  If
+ *	it's one of ours, interrupt the backend the client is attached to, if
+ *	any; otherwise let the postmaster pass it on to the right proxy.
+ */
+static void
+proxy_cancel(int32 pid, int32 key)
+{
+	dlist_iter	iter;
+
+	if (pid != MyProcPid)
+	{
+		ProxyRequest req;
+
+		req.type = PROXY_REQ_CANCEL;
+		req.pid = pid;
+		req.key = key;
+		(void) ProxySendRequest(PostmasterChannel, &req, PGINVALID_SOCKET);
+		return;
+	}
+
+	dlist_foreach(iter, &all_conns)
+	{
+		ProxyConn  *conn = dlist_container(ProxyConn, node, iter.cur);
+
+		if (!conn->is_backend && !conn->closed && conn->authenticated &&
+			conn->cancel_key == key)
+		{
+			if (conn->state == CONN_ATTACHED && conn->peer->backend_pid != 0)
+				kill(conn->peer->backend_pid, SIGINT);
+			return;
+		}
+	}
+}
+
+/*
+ * conn_create
+ *
+ *	Set up the state for a new client or backend connection.
+ */
+static ProxyConn *
+conn_create(pgsocket sock, bool is_backend)
+{
+	ProxyConn  *conn;
+
+	conn = (ProxyConn *) palloc0(sizeof(ProxyConn));
+	conn->sock = sock;
+	conn->is_backend = is_backend;
+	conn->event_pos = -1;
+	initStringInfo(&conn->tx_buf);
+	dlist_push_tail(&all_conns, &conn->node);
+
+	if (!is_backend)
+	{
+		n_clients++;
+#ifdef HAVE_STRONG_RANDOM
+		if (!pg_strong_random((char *) &conn->cancel_key, sizeof(int32)))
+#endif
+			conn->cancel_key = (int32) random();
+	}
+
+	return conn;
+}
+
+/*
+ * conn_close
+ *
+ *	Close a connection, and clean up after it: a client's backend is closed
+ *	too if it's in the middle of the client's transaction, or keeps session
+ *	state of the client, and a backend's client loses its connection.  The
+ *	memory is freed at the end of the current cycle of the main loop.
+ */
+static void
+conn_close(ProxyConn *conn)
+{
+	SessionPool *pool = conn->pool;
+	ProxyConn  *peer = conn->peer;
+
+	if (conn->closed)
+		return;
+	conn->closed = true;
+
+	closesocket(conn->sock);
+	conn->sock = PGINVALID_SOCKET;
+	wait_set_dirty = true;
+
+	if (conn->is_backend)
+	{
+		if (pool != NULL && !conn->dedicated)
+		{
+			pool->n_backends--;
+			if (conn->state == CONN_IDLE)
+				dlist_delete(&conn->pool_node);
+			else if (conn->state == CONN_STARTING)
+				pool->n_starting--;
+
+			/*
+			 * If the pool has no backends left, waiting clients would wait
+			 * forever; report the failure to them.  Otherwise make up for the
+			 * lost backend, unless it failed to start, in which case we let
+			 * the clients wait for the existing backends rather than retry
+			 * right away.
+			 */
+			if (pool->n_backends == 0)
+				pool_fail_waiting(pool, conn->startup_error);
+			else if (conn->state != CONN_STARTING)
+				pool_launch_backends(pool);
+		}
+
+		/* The client loses its connection, once it has seen our output */
+		if (peer != NULL)
+		{
+			peer->peer = NULL;
+			peer->state = CONN_IDLE;
+			peer->close_after_flush = true;
+			conn_flush(peer);
+		}
+	}
+	else
+	{
+		n_clients--;
+
+		if (conn->state == CONN_WAITING)
+		{
+			dlist_delete(&conn->pool_node);
+			pool->n_waiting--;
+		}
+
+		if (peer != NULL)
+		{
+			/*
+			 * The backend is in the middle of something for us, or
+			 * dedicated to us; either way it's no use to anyone else.
+			 */
+			peer->peer = NULL;
+			conn_close(peer);
+		}
+	}
+}
+
+/*
+ * conn_read
+ *
+ *	Read whatever the socket has for us, as far as there's buffer space.
+ */
+static void
+conn_read(ProxyConn *conn)
+{
+	int			rc;
+
+	if (conn->rx_head > 0)
+	{
+		memmove(conn->rx_buf, conn->rx_buf + conn->rx_head,
+				conn->rx_tail - conn->rx_head);
+		conn->rx_tail -= conn->rx_head;
+		conn->rx_head = 0;
+	}
+
+	if (conn->rx_tail == PROXY_BUFFER_SIZE)
+		return;
+
+	do
+	{
+		rc = recv(conn->sock, conn->rx_buf + conn->rx_tail,
+				  PROXY_BUFFER_SIZE - conn->rx_tail, 0);
+	} while (rc < 0 && errno == EINTR);
+
+	if (rc < 0)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return;
+		if (errno != ECONNRESET)
+			ereport(LOG,
+					(errcode_for_socket_access(),
+					 errmsg("could not receive data from %s: %m",
+							conn->is_backend ? "pooled backend" : "client")));
+		conn_close(conn);
+		return;
+	}
+	if (rc == 0)
+	{
+		/* EOF; a backend's last words might still have to be relayed */
+		if (conn->is_backend)
+			conn_process_input(conn);
+		conn_close(conn);
+		return;
+	}
+
+	conn->rx_tail += rc;
+}
+
+/*
+ * conn_flush
+ *
+ *	Send as much of the output buffer as the socket takes.
+ */
+static void
+conn_flush(ProxyConn *conn)
+{
+	int			rc;
+
+	while (!conn->closed && conn->tx_pos < conn->tx_buf.len)
+	{
+		rc = send(conn->sock, conn->tx_buf.data + conn->tx_pos,
+				  conn->tx_buf.len - conn->tx_pos, 0);
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if (errno != EPIPE && errno != ECONNRESET)
+				ereport(LOG,
+						(errcode_for_socket_access(),
+						 errmsg("could not send data to %s: %m",
+								conn->is_backend ? "pooled backend" : "client")));
+			conn_close(conn);
+			return;
+		}
+		conn->tx_pos += rc;
+	}
+
+	if (conn->closed)
+		return;
+
+	if (conn->tx_pos == conn->tx_buf.len)
+	{
+		resetStringInfo(&conn->tx_buf);
+		conn->tx_pos = 0;
+		if (conn->close_after_flush)
+		{
+			conn_close(conn);
+			return;
+		}
+	}
+
+	conn_update_events(conn);
+}
+
+/*
+ * conn_service
+ *
+ *	Process a connection's input, and send out what it produced.
+ */
+static void
+conn_service(ProxyConn *conn)
+{
+	conn_process_input(conn);
+	if (conn->closed)
+		return;
+	if (conn->peer != NULL)
+		conn_flush(conn->peer);
+	if (!conn->closed)
+		conn_flush(conn);
+}
+
+/*
+ * conn_update_events
+ *
+ *	Adjust what we wait for on the connection's socket: input as long as
+ *	there's room for it, and output capacity while we have output pending.
+ */
+static void
+conn_update_events(ProxyConn *conn)
+{
+	uint32		events = 0;
+
+	if (conn->closed)
+		return;
+
+	if (conn->rx_tail - conn->rx_head < PROXY_BUFFER_SIZE &&
+		!conn->close_after_flush)
+		events |= WL_SOCKET_READABLE;
+	if (conn->tx_pos < conn->tx_buf.len)
+		events |= WL_SOCKET_WRITEABLE;
+
+	if (events == conn->events)
+		return;
+
+	if (events != 0 && conn->event_pos >= 0 && !wait_set_dirty)
+		ModifyWaitEvent(proxy_wait_set, conn->event_pos, events, NULL);
+	else
+		wait_set_dirty = true;
+	conn->events = events;
+}
+
+/*
+ * conn_send_error
+ *
+ *	Send an ErrorResponse message to a client, and close the connection once
+ *	it's out.
+ */
+static void
+conn_send_error(ProxyConn *conn, const char *sqlstate, const char *msg)
+{
+	StringInfo	buf = &conn->tx_buf;
+	int			start = buf->len;
+	uint32		n32;
+
+	appendStringInfoChar(buf, 'E');
+	appendBinaryStringInfo(buf, "\0\0\0\0", 4);
+	appendStringInfoChar(buf, PG_DIAG_SEVERITY);
+	appendStringInfoString(buf, "FATAL");
+	appendStringInfoChar(buf, '\0');
+	appendStringInfoChar(buf, PG_DIAG_SQLSTATE);
+	appendStringInfoString(buf, sqlstate);
+	appendStringInfoChar(buf, '\0');
+	appendStringInfoChar(buf, PG_DIAG_MESSAGE_PRIMARY);
+	appendStringInfoString(buf, msg);
+	appendStringInfoChar(buf, '\0');
+	appendStringInfoChar(buf, '\0');
+
+	n32 = htonl(buf->len - start - 1);
+	memcpy(buf->data + start + 1, &n32, 4);
+
+	conn->close_after_flush = true;
+	conn_flush(conn);
+}
+
+/*
+ * conn_process_input
+ *
+ *	Work through the messages in a connection's input buffer, relaying them
+ *	to the peer or acting on them, until we run out of input or can't go on
+ *	for the time being.
+ */
+static void
+conn_process_input(ProxyConn *conn)
+{
+	while (!conn->closed)
+	{
+		int			avail = conn->rx_tail - conn->rx_head;
+		char		type;
+		uint32		len;
+		ProxyMsgAction action;
+
+		if (conn->state == CONN_STARTUP)
+		{
+			if (!client_process_startup(conn))
+				break;
+			continue;
+		}
+
+		if (conn->msg_remaining > 0)
+		{
+			/* In the middle of a message; relay (or skip) the next part */
+			ProxyConn  *dst = conn->peer;
+			int			n = Min((uint32) avail, conn->msg_remaining);
+
+			if (n == 0)
+				break;
+			if (dst != NULL && !dst->closed)
+			{
+				/* hold back if the receiving end isn't keeping up */
+				if (dst->tx_buf.len - dst->tx_pos >= PROXY_BUFFER_SIZE)
+					break;
+				appendBinaryStringInfo(&dst->tx_buf,
+									   conn->rx_buf + conn->rx_head, n);
+			}
+			conn->rx_head += n;
+			conn->msg_remaining -= n;
+			continue;
+		}
+
+		/* Start of a new message */
+		if (avail < 5)
+			break;
+		type = conn->rx_buf[conn->rx_head];
+		memcpy(&len, conn->rx_buf + conn->rx_head + 1, 4);
+		len = ntohl(len);
+		if (len < 4)
+		{
+			ereport(LOG,
+					(errcode(ERRCODE_PROTOCOL_VIOLATION),
+					 errmsg("invalid message length from %s",
+							conn->is_backend ? "pooled backend" : "client")));
+			conn_close(conn);
+			break;
+		}
+
+		if (conn->is_backend)
+			action = backend_message(conn, type, len);
+		else
+			action = client_message(conn, type, len);
+
+		if (action == MSG_WAIT)
+			break;
+		else if (action == MSG_FORWARD || action == MSG_DISCARD)
+		{
+			/* the rest is relayed above; without a peer, it's dropped */
+			Assert(action == MSG_DISCARD ? conn->peer == NULL :
+				   conn->peer != NULL);
+			conn->msg_remaining = len + 1;
+		}
+	}
+
+	if (!conn->closed)
+		conn_update_events(conn);
+}
+
+/*
+ * client_process_startup
+ *
+ *	Deal with the client's startup packet, if we have it all.  Returns true
+ *	if we're done with it and there may be more input to process.
+ */
+static bool
+client_process_startup(ProxyConn *client)
+{
+	int			avail = client->rx_tail - client->rx_head;
+	char	   *packet = client->rx_buf + client->rx_head;
+	uint32		len;
+	ProtocolVersion proto;
+	char	   *p;
+	bool		have_user = false;
+
+	if (avail < 4)
+		return false;
+	memcpy(&len, packet, 4);
+	len = ntohl(len);
+	if (len < 8 || len > MAX_STARTUP_PACKET_LENGTH)
+	{
+		ereport(COMMERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("invalid length of startup packet")));
+		conn_close(client);
+		return false;
+	}
+	if (avail < len)
+		return false;
+
+	memcpy(&proto, packet + 4, 4);
+	proto = ntohl(proto);
+	client->rx_head += len;
+
+	if (proto == CANCEL_REQUEST_CODE)
+	{
+		CancelRequestPacket *canc = (CancelRequestPacket *) (packet + 4);
+
+		if (len == sizeof(CancelRequestPacket) + 4)
+			proxy_cancel((int32) ntohl(canc->backendPID),
+						 (int32) ntohl(canc->cancelAuthCode));
+		conn_close(client);
+		return false;
+	}
+
+	if (proto == NEGOTIATE_SSL_CODE)
+	{
+		/* SSL is not supported through the proxy; let the client go on */
+		appendStringInfoChar(&client->tx_buf, 'N');
+		return true;
+	}
+
+	if (PG_PROTOCOL_MAJOR(proto) != 3)
+	{
+		conn_send_error(client, "0A000",
+						"connection proxies support only protocol 3.0");
+		return false;
+	}
+
+	/* Check the parameters for things we can't pool */
+	p = packet + 8;
+	while (p < packet + len && *p != '\0')
+	{
+		char	   *name = p;
+		char	   *value;
+
+		p = memchr(p, '\0', packet + len - p);
+		if (p == NULL || ++p >= packet + len)
+			break;
+		value = p;
+		p = memchr(p, '\0', packet + len - p);
+		if (p == NULL)
+			break;
+		p++;
+
+		if (strcmp(name, "user") == 0 && value[0] != '\0')
+			have_user = true;
+		else if (strcmp(name, "replication") == 0)
+		{
+			conn_send_error(client, "0A000",
+							"replication connections are not supported by connection proxies");
+			return false;
+		}
+	}
+	if (!have_user || p == NULL || p >= packet + len)
+	{
+		conn_send_error(client, "08P01",
+						"invalid startup packet layout");
+		return false;
+	}
+
+	client->pool = pool_lookup(packet + 4, len - 4);
+	client->state = CONN_IDLE;
+	pool_request_backend(client);
+	return true;
+}
+
+/*
+ * client_message
+ *
+ *	Decide what to do with a message from a client.
+ */
+static ProxyMsgAction
+client_message(ProxyConn *client, char type, uint32 len)
+{
+	if (type == 'X')
+	{
+		/* Terminate; never passed on, the backend may serve others */
+		conn_close(client);
+		return MSG_CONSUMED;
+	}
+
+	if (type == PROXY_MSG_NEW_SESSION || type == PROXY_MSG_SESSION_STATE)
+	{
+		/*
+		 * Reserved for talking to the backends; a client sending one is up
+		 * to no good.  Its backend may have seen part of a session from it,
+		 * so that goes too.
+		 */
+		ereport(COMMERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("client sent reserved message type %d to connection proxy",
+						type)));
+		if (client->peer != NULL)
+		{
+			ProxyConn  *backend = client->peer;
+
+			client->peer = NULL;
+			client->state = CONN_IDLE;
+			backend->peer = NULL;
+			conn_close(backend);
+		}
+		conn_send_error(client, "08P01", "invalid frontend message type");
+		return MSG_WAIT;
+	}
+
+	if (client->state != CONN_ATTACHED)
+	{
+		if (client->state == CONN_IDLE)
+			pool_request_backend(client);
+		if (client->state != CONN_ATTACHED)
+			return MSG_WAIT;
+	}
+
+	/* Keep track of how many ReadyForQuery messages the backend owes us */
+	switch (type)
+	{
+		case 'Q':				/* simple query */
+		case 'F':				/* fastpath function call */
+			client->outstanding++;
+			break;
+		case 'S':				/* sync */
+			client->outstanding++;
+			client->unsynced = false;
+			break;
+		case 'P':				/* parse */
+		case 'B':				/* bind */
+		case 'D':				/* describe */
+		case 'E':				/* execute */
+		case 'C':				/* close */
+		case 'H':				/* flush */
+			client->unsynced = true;
+			break;
+		default:
+			break;
+	}
+
+	return MSG_FORWARD;
+}
+
+/*
+ * backend_message
+ *
+ *	Decide what to do with a message from a backend.
+ */
+static ProxyMsgAction
+backend_message(ProxyConn *backend, char type, uint32 len)
+{
+	ProxyConn  *client = backend->peer;
+	int			avail = backend->rx_tail - backend->rx_head;
+	char	   *body = backend->rx_buf + backend->rx_head + 5;
+	bool		whole = avail >= len + 1;
+
+	/* Messages we need to see in full are all short */
+	switch (type)
+	{
+		case 'K':
+		case 'Z':
+		case PROXY_MSG_SESSION_STATE:
+			if (!whole)
+				return MSG_WAIT;
+			break;
+		case 'E':
+			if (!whole && client == NULL && len < PROXY_BUFFER_SIZE)
+				return MSG_WAIT;
+			break;
+		default:
+			break;
+	}
+
+	if (client == NULL)
+	{
+		/*
+		 * Starting up, or idle: nobody to pass anything to.  Take note of the
+		 * cancel key, and of any error that comes before the backend dies.
+		 */
+		switch (type)
+		{
+			case 'K':			/* BackendKeyData */
+				if (len == 12)
+				{
+					uint32		n32;
+
+					memcpy(&n32, body, 4);
+					backend->backend_pid = (int32) ntohl(n32);
+					memcpy(&n32, body + 4, 4);
+					backend->backend_key = (int32) ntohl(n32);
+				}
+				break;
+
+			case 'E':			/* ErrorResponse */
+				if (whole)
+				{
+					if (backend->startup_error == NULL)
+					{
+						backend->startup_error = makeStringInfo();
+						appendBinaryStringInfo(backend->startup_error,
+											   body - 5, len + 1);
+					}
+					break;
+				}
+				return MSG_DISCARD;
+
+			case 'Z':			/* ReadyForQuery */
+				if (backend->state == CONN_STARTING)
+				{
+					backend->rx_head += len + 1;
+					backend->pool->n_starting--;
+					pool_backend_ready(backend);
+					return MSG_CONSUMED;
+				}
+				break;
+
+			case 'R':			/* Authentication* */
+				if (!whole)
+					return MSG_WAIT;
+				if (len != 8 || body[0] || body[1] || body[2] || body[3])
+				{
+					/* pooled backends don't authenticate at startup */
+					ereport(LOG,
+							(errmsg("unexpected authentication request from pooled backend")));
+					conn_close(backend);
+					return MSG_CONSUMED;
+				}
+				return MSG_DISCARD;
+
+			default:
+				return MSG_DISCARD;
+		}
+		backend->rx_head += len + 1;
+		return MSG_CONSUMED;
+	}
+
+	switch (type)
+	{
+		case PROXY_MSG_SESSION_STATE:
+			backend->session_state = body[0];
+			backend->rx_head += len + 1;
+			return MSG_CONSUMED;
+
+		case 'K':				/* BackendKeyData */
+			{
+				uint32		n32;
+
+				/* give the client a key of ours, see proxy_cancel */
+				appendStringInfoChar(&client->tx_buf, 'K');
+				n32 = htonl(12);
+				appendBinaryStringInfo(&client->tx_buf, (char *) &n32, 4);
+				n32 = htonl((uint32) MyProcPid);
+				appendBinaryStringInfo(&client->tx_buf, (char *) &n32, 4);
+				n32 = htonl((uint32) client->cancel_key);
+				appendBinaryStringInfo(&client->tx_buf, (char *) &n32, 4);
+				backend->rx_head += len + 1;
+				return MSG_CONSUMED;
+			}
+
+		case 'Z':				/* ReadyForQuery */
+			{
+				char		status = body[0];
+
+				appendBinaryStringInfo(&client->tx_buf, body - 5, len + 1);
+				backend->rx_head += len + 1;
+
+				client->outstanding--;
+				if (status == 'I' && client->outstanding <= 0 &&
+					!client->unsynced)
+					end_of_transaction(client, backend);
+				backend->session_state = '\0';
+				return MSG_CONSUMED;
+			}
+
+		default:
+			return MSG_FORWARD;
+	}
+}
+
+/*
+ * pool_lookup
+ *
+ *	Find the session pool for the given startup packet, or make a new one.
+ */
+static SessionPool *
+pool_lookup(const char *packet, int len)
+{
+	dlist_iter	iter;
+	SessionPool *pool;
+
+	dlist_foreach(iter, &all_pools)
+	{
+		pool = dlist_container(SessionPool, node, iter.cur);
+
+		if (pool->startup_len == len &&
+			memcmp(pool->startup_packet, packet, len) == 0)
+			return pool;
+	}
+
+	pool = (SessionPool *) palloc0(sizeof(SessionPool));
+	pool->startup_packet = palloc(len);
+	memcpy(pool->startup_packet, packet, len);
+	pool->startup_len = len;
+	dlist_init(&pool->idle_backends);
+	dlist_init(&pool->waiting_clients);
+	dlist_push_tail(&all_pools, &pool->node);
+
+	return pool;
+}
+
+/*
+ * pool_request_backend
+ *
+ *	Attach the client to an idle backend of its pool, or queue it until
+ *	there is one.
+ */
+static void
+pool_request_backend(ProxyConn *client)
+{
+	SessionPool *pool = client->pool;
+
+	Assert(client->state == CONN_IDLE);
+
+	if (!dlist_is_empty(&pool->idle_backends))
+	{
+		ProxyConn  *backend;
+
+		backend = dlist_container(ProxyConn, pool_node,
+								  dlist_pop_head_node(&pool->idle_backends));
+		attach(client, backend);
+		return;
+	}
+
+	client->state = CONN_WAITING;
+	dlist_push_tail(&pool->waiting_clients, &client->pool_node);
+	pool->n_waiting++;
+	pool_launch_backends(pool);
+}
+
+/*
+ * pool_launch_backends
+ *
+ *	Start more backends for the pool, if clients are waiting that the ones
+ *	already starting won't take care of, and the pool isn't full yet.
+ */
+static void
+pool_launch_backends(SessionPool *pool)
+{
+	while (pool->n_starting < pool->n_waiting &&
+		   pool->n_backends < SessionPoolSize)
+	{
+		pgsocket	socks[2];
+		ProxyRequest req;
+		ProxyConn  *backend;
+		uint32		n32;
+
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, socks) < 0)
+		{
+			ereport(LOG,
+					(errcode_for_socket_access(),
+					 errmsg("could not create socket pair for pooled backend: %m")));
+			break;
+		}
+
+		req.type = PROXY_REQ_BACKEND;
+		req.pid = 0;
+		req.key = 0;
+		if (!ProxySendRequest(PostmasterChannel, &req, socks[1]) ||
+			!pg_set_noblock(socks[0]))
+		{
+			ereport(LOG,
+					(errcode_for_socket_access(),
+					 errmsg("could not request pooled backend from postmaster: %m")));
+			closesocket(socks[0]);
+			closesocket(socks[1]);
+			break;
+		}
+		closesocket(socks[1]);
+
+		backend = conn_create(socks[0], true);
+		backend->state = CONN_STARTING;
+		backend->pool = pool;
+		pool->n_backends++;
+		pool->n_starting++;
+
+		/* Send it the startup packet of the pool */
+		n32 = htonl(pool->startup_len + 4);
+		appendBinaryStringInfo(&backend->tx_buf, (char *) &n32, 4);
+		appendBinaryStringInfo(&backend->tx_buf, pool->startup_packet,
+							   pool->startup_len);
+		conn_flush(backend);
+	}
+
+	/* If we can't get any backend going, don't leave the clients hanging */
+	if (pool->n_backends == 0 && pool->n_waiting > 0)
+		pool_fail_waiting(pool, NULL);
+}
+
+/*
+ * pool_backend_ready
+ *
+ *	A backend has become available; give it to the first waiting client of
+ *	the pool, if there is one, or put it in the idle list.
+ */
+static void
+pool_backend_ready(ProxyConn *backend)
+{
+	SessionPool *pool = backend->pool;
+
+	backend->state = CONN_IDLE;
+	backend->peer = NULL;
+
+	if (!dlist_is_empty(&pool->waiting_clients))
+	{
+		ProxyConn  *client;
+
+		client = dlist_container(ProxyConn, pool_node,
+								 dlist_pop_head_node(&pool->waiting_clients));
+		pool->n_waiting--;
+		client->state = CONN_IDLE;
+		attach(client, backend);
+
+		/* The client's pending input can go ahead now */
+		conn_service(client);
+	}
+	else
+		dlist_push_tail(&pool->idle_backends, &backend->pool_node);
+}
+
+/*
+ * pool_fail_waiting
+ *
+ *	Disconnect all clients waiting for a backend of the pool, passing on the
+ *	error that prevented the backend from starting, if we have it.
+ */
+static void
+pool_fail_waiting(SessionPool *pool, StringInfo error)
+{
+	while (!dlist_is_empty(&pool->waiting_clients))
+	{
+		ProxyConn  *client;
+
+		client = dlist_container(ProxyConn, pool_node,
+								 dlist_pop_head_node(&pool->waiting_clients));
+		pool->n_waiting--;
+		client->state = CONN_IDLE;
+
+		if (error != NULL)
+		{
+			appendBinaryStringInfo(&client->tx_buf, error->data, error->len);
+			client->close_after_flush = true;
+			conn_flush(client);
+		}
+		else
+			conn_send_error(client, "53300",
+							"could not start backend for pooled session");
+	}
+}
+
+/*
+ * attach
+ *
+ *	Attach a client to a backend.  A client that hasn't been authenticated
+ *	yet is introduced to the backend first.
+ */
+static void
+attach(ProxyConn *client, ProxyConn *backend)
+{
+	client->peer = backend;
+	backend->peer = client;
+	client->state = CONN_ATTACHED;
+	backend->state = CONN_ATTACHED;
+	backend->session_state = '\0';
+
+	if (!client->authenticated)
+	{
+		StringInfo	buf = &backend->tx_buf;
+		uint32		n32;
+
+		appendStringInfoChar(buf, PROXY_MSG_NEW_SESSION);
+		n32 = htonl(4 + 4 + 4 + client->raddr.salen);
+		appendBinaryStringInfo(buf, (char *) &n32, 4);
+		n32 = htonl((uint32) backend->backend_key);
+		appendBinaryStringInfo(buf, (char *) &n32, 4);
+		n32 = htonl(client->raddr.salen);
+		appendBinaryStringInfo(buf, (char *) &n32, 4);
+		appendBinaryStringInfo(buf, (char *) &client->raddr.addr,
+							   client->raddr.salen);
+		client->outstanding = 1;
+		conn_flush(backend);
+	}
+}
+
+/*
+ * end_of_transaction
+ *
+ *	The backend has finished everything the client asked of it.  Put the
+ *	backend back in the pool, unless the session has state that ties the
+ *	client to it.
+ */
+static void
+end_of_transaction(ProxyConn *client, ProxyConn *backend)
+{
+	SessionPool *pool = backend->pool;
+
+	client->authenticated = true;
+	client->outstanding = 0;
+
+	if (client->dedicated)
+		return;
+
+	if (backend->session_state != 'F')
+	{
+		/*
+		 * The session can't move.  The backend no longer counts against the
+		 * pool, so that other clients can get another one.
+		 */
+		client->dedicated = true;
+		backend->dedicated = true;
+		pool->n_backends--;
+		pool_launch_backends(pool);
+		return;
+	}
+
+	client->peer = NULL;
+	client->state = CONN_IDLE;
+	pool_backend_ready(backend);
+
+	/* Detached, the client's output is no longer sent along with ours */
+	conn_flush(client);
+}
+
+#endif   /* USE_CONNECTION_PROXIES */
@@ -949,7 +949,8 @@ dependencies_clauselist_selectivity(PlannerInfo *root,
 	 * dependency selectivity estimations. Along the way we'll record all of
 	 * the attnums for each clause in a list which we'll reference later so we
 	 * don't need to repeat the same work again. We'll also keep track of all
-	 * attnums seen.
+	 * attnums seen. Clauses already estimated using other statistics (such as
+	 * a MCV list) are skipped.
 	 */
 	listidx = 0;
 	foreach(l, clauses)
@@ -957,7 +958,8 @@ dependencies_clauselist_selectivity(PlannerInfo *root,
 		Node	   *clause = (Node *) lfirst(l);
 		AttrNumber	attnum;
 
-		if (dependency_is_compatible_clause(clause, rel->relid, &attnum))
+		if (!bms_is_member(listidx, *estimatedclauses) &&
+			dependency_is_compatible_clause(clause, rel->relid, &attnum))
 		{
 			list_attnums[listidx] = attnum;
 			clauses_attnums = bms_add_member(clauses_attnums, attnum);
@@ -48,7 +48,7 @@ static VacAttrStats **lookup_var_attr_stats(Relation rel, Bitmapset *attrs,
 					  int natts, VacAttrStats **vacattrstats);
 static void statext_store(Relation pg_stext, Oid relid,
 			  MVNDistinct *ndistinct, MVDependencies *dependencies,
-			  VacAttrStats **stats);
+			  MCVList *mcvlist, VacAttrStats **stats);
 
 
 /*
@@ -75,6 +75,7 @@ BuildRelationExtStatistics(Relation onerel, double totalrows,
 		StatExtEntry   *stat = (StatExtEntry *) lfirst(lc);
 		MVNDistinct	   *ndistinct = NULL;
 		MVDependencies *dependencies = NULL;
+		MCVList		   *mcvlist = NULL;
 		VacAttrStats  **stats;
 		ListCell	   *lc2;
 
@@ -97,10 +98,14 @@ BuildRelationExtStatistics(Relation onerel, double totalrows,
 			else if (t == STATS_EXT_DEPENDENCIES)
 				dependencies = statext_dependencies_build(numrows, rows,
 													   stat->columns, stats);
+			else if (t == STATS_EXT_MCV)
+				mcvlist = statext_mcv_build(numrows, rows, stat->columns,
+											stats, totalrows);
 		}
 
 		/* store the statistics in the catalog */
-		statext_store(pg_stext, stat->statOid, ndistinct, dependencies, stats);
+		statext_store(pg_stext, stat->statOid, ndistinct, dependencies,
+					  mcvlist, stats);
 	}
 
 	heap_close(pg_stext, RowExclusiveLock);
@@ -125,6 +130,10 @@ statext_is_kind_built(HeapTuple htup, char type)
 			attnum = Anum_pg_statistic_ext_stadependencies;
 			break;
 
+		case STATS_EXT_MCV:
+			attnum = Anum_pg_statistic_ext_stamcv;
+			break;
+
 		default:
 			elog(ERROR, "unexpected statistics type requested: %d", type);
 	}
@@ -187,7 +196,8 @@ fetch_statentries_for_relation(Relation pg_statext, Oid relid)
 		for (i = 0; i < ARR_DIMS(arr)[0]; i++)
 		{
 			Assert((enabled[i] == STATS_EXT_NDISTINCT) ||
-				   (enabled[i] == STATS_EXT_DEPENDENCIES));
+				   (enabled[i] == STATS_EXT_DEPENDENCIES) ||
+				   (enabled[i] == STATS_EXT_MCV));
 			entry->types = lappend_int(entry->types, (int) enabled[i]);
 		}
 
@@ -266,7 +276,7 @@ lookup_var_attr_stats(Relation rel, Bitmapset *attrs, int natts,
 static void
 statext_store(Relation pg_stext, Oid statOid,
 			  MVNDistinct *ndistinct, MVDependencies *dependencies,
-			  VacAttrStats **stats)
+			  MCVList *mcvlist, VacAttrStats **stats)
 {
 	HeapTuple	stup,
 				oldtup;
@@ -297,9 +307,18 @@ statext_store(Relation pg_stext, Oid statOid,
 		values[Anum_pg_statistic_ext_stadependencies - 1] = PointerGetDatum(data);
 	}
 
+	if (mcvlist != NULL)
+	{
+		bytea	   *data = statext_mcv_serialize(mcvlist, stats);
+
+		nulls[Anum_pg_statistic_ext_stamcv - 1] = (data == NULL);
+		values[Anum_pg_statistic_ext_stamcv - 1] = PointerGetDatum(data);
+	}
+
 	/* always replace the value (either by bytea or NULL) */
 	replaces[Anum_pg_statistic_ext_standistinct - 1] = true;
 	replaces[Anum_pg_statistic_ext_stadependencies - 1] = true;
+	replaces[Anum_pg_statistic_ext_stamcv - 1] = true;
 
 	/* there should already be a pg_statistic_ext tuple */
 	oldtup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(statOid));
@@ -0,0 +1,1092 @@
+/*-------------------------------------------------------------------------
+ *
+ * mcv.c
+ *	  POSTGRES multi-column MCV lists
+ *
+ * A multi-column MCV (most common values) list tracks the most frequent
+ * combinations of values in the columns covered by the statistics, along
+ * with the frequency of each combination.  Unlike per-column MCV lists this
+ * captures correlation between the columns, so conditions such as
+ * "country = 'X' AND city = 'Y'" are not assumed to be independent.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/statistics/mcv.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/sysattr.h"
+#include "catalog/pg_statistic_ext.h"
+#include "fmgr.h"
+#include "lib/stringinfo.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "nodes/relation.h"
+#include "statistics/extended_stats_internal.h"
+#include "statistics/statistics.h"
+#include "utils/builtins.h"
+#include "utils/bytea.h"
+#include "utils/fmgroids.h"
+#include "utils/fmgrprotos.h"
+#include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
+#include "utils/syscache.h"
+#include "utils/typcache.h"
+
+/*
+ * A group of identical rows in the sorted sample, i.e. a candidate for an
+ * item of the MCV list.
+ */
+typedef struct SortItemGroup
+{
+	int			first;			/* index of the first item of the group */
+	int			count;			/* number of sample rows in the group */
+} SortItemGroup;
+
+static int	compare_groups_by_count(const void *a, const void *b);
+static int	compare_scalar_items(const void *a, const void *b, void *arg);
+static double get_mincount_for_mcv_list(int samplerows, double totalrows);
+static int	count_matching_values(Datum *values, bool *isnull, int nvalues,
+					  Datum value, bool valueisnull, SortSupport ssup);
+static bool mcv_is_compatible_clause(Node *clause, Index relid,
+						 AttrNumber *attnum);
+static bool mcv_item_matches_clause(MCVItem *item, int dim, Node *clause);
+
+
+/*
+ * compare_groups_by_count
+ *		qsort comparator sorting groups by count, in descending order
+ *
+ * Ties are broken by the position of the group in the sorted sample, so
+ * that the result does not depend on the qsort implementation.
+ */
+static int
+compare_groups_by_count(const void *a, const void *b)
+{
+	const SortItemGroup *ga = (const SortItemGroup *) a;
+	const SortItemGroup *gb = (const SortItemGroup *) b;
+
+	if (ga->count != gb->count)
+		return (ga->count > gb->count) ? -1 : 1;
+
+	return (ga->first < gb->first) ? -1 : (ga->first > gb->first);
+}
+
+/*
+ * compare_scalar_items
+ *		qsort_arg comparator for single-dimension SortItems
+ */
+static int
+compare_scalar_items(const void *a, const void *b, void *arg)
+{
+	const SortItem *ia = (const SortItem *) a;
+	const SortItem *ib = (const SortItem *) b;
+
+	return ApplySortComparator(ia->values[0], ia->isnull[0],
+							   ib->values[0], ib->isnull[0],
+							   (SortSupport) arg);
+}
+
+/*
+ * get_mincount_for_mcv_list
+ *		Determine the minimum number of sample rows for a MCV item
+ *
+ * We keep a combination of values only if its estimated frequency is
+ * reasonably accurate, i.e. the relative standard error of the estimate
+ * (treating the sample as drawn without replacement from the table) is
+ * below 20%.  This is the same rule ANALYZE uses for per-column MCV lists
+ * where the sample does not cover all the distinct values.
+ */
+static double
+get_mincount_for_mcv_list(int samplerows, double totalrows)
+{
+	double		n = samplerows;
+	double		N = totalrows;
+	double		numer,
+				denom;
+
+	numer = n * (N - n);
+	denom = N - n + 0.04 * n * (N - 1);
+
+	/* Guard against division by zero (possible if n = N = 1) */
+	if (denom == 0.0)
+		return 0.0;
+
+	return numer / denom;
+}
+
+/*
+ * count_matching_values
+ *		Count values equal to the given one in a sorted array
+ *
+ * The values/isnull arrays have to be sorted using 'ssup', which allows us
+ * to find the first and last matching value by binary search.
+ */
+static int
+count_matching_values(Datum *values, bool *isnull, int nvalues,
+					  Datum value, bool valueisnull, SortSupport ssup)
+{
+	int			lo,
+				hi,
+				start;
+
+	/* find the first value not less than the given one */
+	lo = 0;
+	hi = nvalues;
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (ApplySortComparator(values[mid], isnull[mid],
+								value, valueisnull, ssup) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	start = lo;
+
+	/* and then the first value greater than the given one */
+	hi = nvalues;
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (ApplySortComparator(values[mid], isnull[mid],
+								value, valueisnull, ssup) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo - start;
+}
+
+/*
+ * statext_mcv_build
+ *		Build a multi-column MCV list from the sampled rows
+ *
+ * The sample is sorted on all the columns, which places identical
+ * combinations next to each other, and then split into groups.  The most
+ * frequent groups become the MCV items, as long as they are frequent enough
+ * for the estimate of their frequency to be reliable, up to the largest
+ * statistics target of the columns.
+ *
+ * For each item we also compute the "base" frequency, i.e. the frequency
+ * the combination would have if the columns were independent.  This is
+ * needed to combine the MCV list with the per-column estimates for values
+ * not covered by the list (see mcv_clauselist_selectivity).
+ *
+ * Returns NULL if there are no combinations worth keeping.
+ */
+MCVList *
+statext_mcv_build(int numrows, HeapTuple *rows, Bitmapset *attrs,
+				  VacAttrStats **stats, double totalrows)
+{
+	int			i,
+				j,
+				k;
+	int			numattrs = bms_num_members(attrs);
+	int			ngroups;
+	int			nitems;
+	int			stattarget;
+	int		   *attnums;
+	MultiSortSupport mss;
+	SortItem   *items;
+	Datum	   *values;
+	bool	   *isnull;
+	SortItemGroup *groups;
+	MCVList    *mcvlist;
+
+	if (numrows == 0)
+		return NULL;
+
+	/* the size of the MCV list is determined by the statistics target */
+	stattarget = 0;
+	for (i = 0; i < numattrs; i++)
+		stattarget = Max(stattarget, stats[i]->attr->attstattarget);
+	stattarget = Min(stattarget, STATS_MCVLIST_MAX_ITEMS);
+
+	if (stattarget <= 0)
+		return NULL;
+
+	/* transform the bms into an array, to make accessing i-th member easier */
+	attnums = (int *) palloc(sizeof(int) * numattrs);
+	i = 0;
+	j = -1;
+	while ((j = bms_next_member(attrs, j)) >= 0)
+		attnums[i++] = j;
+
+	/* sort info for all the attributes */
+	mss = multi_sort_init(numattrs);
+
+	/* data for the sort */
+	items = (SortItem *) palloc(numrows * sizeof(SortItem));
+	values = (Datum *) palloc(sizeof(Datum) * numrows * numattrs);
+	isnull = (bool *) palloc(sizeof(bool) * numrows * numattrs);
+
+	for (i = 0; i < numrows; i++)
+	{
+		items[i].values = &values[i * numattrs];
+		items[i].isnull = &isnull[i * numattrs];
+	}
+
+	for (i = 0; i < numattrs; i++)
+	{
+		VacAttrStats *colstat = stats[i];
+		TypeCacheEntry *type;
+
+		type = lookup_type_cache(colstat->attrtypid, TYPECACHE_LT_OPR);
+		if (type->lt_opr == InvalidOid) /* shouldn't happen */
+			elog(ERROR, "cache lookup failed for ordering operator for type %u",
+				 colstat->attrtypid);
+
+		multi_sort_add_dimension(mss, i, type->lt_opr);
+
+		for (j = 0; j < numrows; j++)
+			items[j].values[i] = heap_getattr(rows[j], attnums[i],
+											  colstat->tupDesc,
+											  &items[j].isnull[i]);
+	}
+
+	/* sort the items so that identical combinations are adjacent */
+	qsort_arg((void *) items, numrows, sizeof(SortItem),
+			  multi_sort_compare, mss);
+
+	/* split the sorted sample into groups of identical combinations */
+	groups = (SortItemGroup *) palloc(numrows * sizeof(SortItemGroup));
+	ngroups = 0;
+	groups[0].first = 0;
+	groups[0].count = 1;
+	for (i = 1; i < numrows; i++)
+	{
+		if (multi_sort_compare(&items[i - 1], &items[i], mss) != 0)
+		{
+			ngroups++;
+			groups[ngroups].first = i;
+			groups[ngroups].count = 0;
+		}
+		groups[ngroups].count++;
+	}
+	ngroups++;
+
+	qsort(groups, ngroups, sizeof(SortItemGroup), compare_groups_by_count);
+
+	/*
+	 * If the sample contains more distinct combinations than we can keep, we
+	 * only keep the combinations we have seen often enough to trust the
+	 * frequency estimate.  Otherwise the list describes the whole table.
+	 */
+	nitems = Min(ngroups, stattarget);
+	if (ngroups > nitems)
+	{
+		double		mincount = get_mincount_for_mcv_list(numrows, totalrows);
+
+		for (i = 0; i < nitems; i++)
+		{
+			if (groups[i].count < mincount)
+			{
+				nitems = i;
+				break;
+			}
+		}
+	}
+
+	if (nitems == 0)
+		return NULL;
+
+	mcvlist = (MCVList *) palloc0(offsetof(MCVList, items) +
+								  sizeof(MCVItem *) * nitems);
+	mcvlist->magic = STATS_MCV_MAGIC;
+	mcvlist->type = STATS_MCV_TYPE_BASIC;
+	mcvlist->nitems = nitems;
+	mcvlist->ndimensions = numattrs;
+	for (i = 0; i < numattrs; i++)
+		mcvlist->types[i] = stats[i]->attrtypid;
+
+	for (i = 0; i < nitems; i++)
+	{
+		MCVItem    *item = (MCVItem *) palloc0(sizeof(MCVItem));
+		SortItem   *first = &items[groups[i].first];
+
+		item->values = (Datum *) palloc(sizeof(Datum) * numattrs);
+		item->isnull = (bool *) palloc(sizeof(bool) * numattrs);
+		memcpy(item->values, first->values, sizeof(Datum) * numattrs);
+		memcpy(item->isnull, first->isnull, sizeof(bool) * numattrs);
+
+		item->frequency = (double) groups[i].count / numrows;
+		item->base_frequency = 1.0;
+
+		mcvlist->items[i] = item;
+	}
+
+	/*
+	 * Compute the base frequencies.  For each dimension, sort the sampled
+	 * values on their own and count the rows matching each item.
+	 */
+	for (i = 0; i < numattrs; i++)
+	{
+		SortSupport ssup = &mss->ssup[i];
+		Datum	   *dimvalues = (Datum *) palloc(sizeof(Datum) * numrows);
+		bool	   *dimisnull = (bool *) palloc(sizeof(bool) * numrows);
+		SortItem   *dimitems = (SortItem *) palloc(sizeof(SortItem) * numrows);
+
+		for (j = 0; j < numrows; j++)
+		{
+			dimitems[j].values = &items[j].values[i];
+			dimitems[j].isnull = &items[j].isnull[i];
+		}
+
+		qsort_arg((void *) dimitems, numrows, sizeof(SortItem),
+				  compare_scalar_items, ssup);
+
+		for (j = 0; j < numrows; j++)
+		{
+			dimvalues[j] = dimitems[j].values[0];
+			dimisnull[j] = dimitems[j].isnull[0];
+		}
+
+		for (k = 0; k < nitems; k++)
+		{
+			MCVItem    *item = mcvlist->items[k];
+			int			count;
+
+			count = count_matching_values(dimvalues, dimisnull, numrows,
+										  item->values[i], item->isnull[i],
+										  ssup);
+			item->base_frequency *= (double) count / numrows;
+		}
+
+		pfree(dimitems);
+		pfree(dimvalues);
+		pfree(dimisnull);
+	}
+
+	pfree(groups);
+	pfree(attnums);
+
+	/*
+	 * Note the item values still point into the sample rows, which is fine
+	 * as the list is serialized before the sample is discarded.
+	 */
+	return mcvlist;
+}
+
+/*
+ * statext_mcv_serialize
+ *		Serialize the MCV list into a bytea value
+ *
+ * The format is a header (magic, type, number of items and dimensions)
+ * followed by the type OIDs of the dimensions, and then the items.  Each
+ * item consists of the frequency, base frequency and NULL flags, followed
+ * by the non-NULL values.  Pass-by-value types are stored as a whole Datum,
+ * fixed-length types as their raw bytes, and variable-length types as
+ * their length followed by the (detoasted) value, so the deserialization
+ * can copy them into properly aligned memory.
+ */
+bytea *
+statext_mcv_serialize(MCVList *mcvlist, VacAttrStats **stats)
+{
+	int			i,
+				dim;
+	int			ndims = mcvlist->ndimensions;
+	Size		len;
+	bytea	   *output;
+	char	   *tmp;
+	Datum	   *values;
+
+	/* detoasted copies of the values, so that we can compute the length */
+	values = (Datum *) palloc(sizeof(Datum) * mcvlist->nitems * ndims);
+
+	len = VARHDRSZ + SizeOfMCVList + ndims * sizeof(Oid);
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		len += SizeOfMCVItem(ndims);
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			Form_pg_type type = stats[dim]->attrtype;
+			Datum		value = item->values[dim];
+
+			values[i * ndims + dim] = value;
+
+			if (item->isnull[dim])
+				continue;
+
+			if (type->typbyval)
+				len += sizeof(Datum);
+			else if (type->typlen > 0)
+				len += type->typlen;
+			else if (type->typlen == -1)
+			{
+				value = PointerGetDatum(PG_DETOAST_DATUM(value));
+				values[i * ndims + dim] = value;
+				len += sizeof(uint32) + VARSIZE_ANY(DatumGetPointer(value));
+			}
+			else
+				len += sizeof(uint32) + strlen(DatumGetCString(value)) + 1;
+		}
+	}
+
+	output = (bytea *) palloc0(len);
+	SET_VARSIZE(output, len);
+
+	tmp = VARDATA(output);
+
+	/* store the header fields */
+	memcpy(tmp, &mcvlist->magic, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &mcvlist->type, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &mcvlist->nitems, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &mcvlist->ndimensions, sizeof(AttrNumber));
+	tmp += sizeof(AttrNumber);
+	memcpy(tmp, mcvlist->types, sizeof(Oid) * ndims);
+	tmp += sizeof(Oid) * ndims;
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		memcpy(tmp, &item->frequency, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(tmp, &item->base_frequency, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(tmp, item->isnull, sizeof(bool) * ndims);
+		tmp += sizeof(bool) * ndims;
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			Form_pg_type type = stats[dim]->attrtype;
+			Datum		value = values[i * ndims + dim];
+
+			if (item->isnull[dim])
+				continue;
+
+			if (type->typbyval)
+			{
+				memcpy(tmp, &value, sizeof(Datum));
+				tmp += sizeof(Datum);
+			}
+			else if (type->typlen > 0)
+			{
+				memcpy(tmp, DatumGetPointer(value), type->typlen);
+				tmp += type->typlen;
+			}
+			else
+			{
+				uint32		vallen;
+
+				if (type->typlen == -1)
+					vallen = VARSIZE_ANY(DatumGetPointer(value));
+				else
+					vallen = strlen(DatumGetCString(value)) + 1;
+
+				memcpy(tmp, &vallen, sizeof(uint32));
+				tmp += sizeof(uint32);
+				memcpy(tmp, DatumGetPointer(value), vallen);
+				tmp += vallen;
+			}
+		}
+
+		Assert(tmp <= ((char *) output + len));
+	}
+
+	/* we should have filled the whole bytea exactly */
+	Assert(tmp == ((char *) output + len));
+
+	pfree(values);
+
+	return output;
+}
+
+/*
+ * statext_mcv_deserialize
+ *		Reads serialized MCV list into MCVList structure
+ */
+MCVList *
+statext_mcv_deserialize(bytea *data)
+{
+	int			i,
+				dim;
+	int			ndims;
+	MCVList    *mcvlist;
+	char	   *tmp;
+	char	   *end;
+	int16		typlen[STATS_MAX_DIMENSIONS];
+	bool		typbyval[STATS_MAX_DIMENSIONS];
+
+	if (data == NULL)
+		return NULL;
+
+	if (VARSIZE_ANY_EXHDR(data) < SizeOfMCVList)
+		elog(ERROR, "invalid MCV list size %ld (expected at least %ld)",
+			 VARSIZE_ANY_EXHDR(data), SizeOfMCVList);
+
+	/* read the MCVList header */
+	mcvlist = (MCVList *) palloc0(offsetof(MCVList, items));
+
+	/* initialize pointer to the data part (skip the varlena header) */
+	tmp = VARDATA_ANY(data);
+	end = (char *) data + VARSIZE_ANY(data);
+
+	/* read the header fields and perform basic sanity checks */
+	memcpy(&mcvlist->magic, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&mcvlist->type, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&mcvlist->nitems, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&mcvlist->ndimensions, tmp, sizeof(AttrNumber));
+	tmp += sizeof(AttrNumber);
+
+	if (mcvlist->magic != STATS_MCV_MAGIC)
+		elog(ERROR, "invalid MCV list magic %u (expected %u)",
+			 mcvlist->magic, STATS_MCV_MAGIC);
+
+	if (mcvlist->type != STATS_MCV_TYPE_BASIC)
+		elog(ERROR, "invalid MCV list type %u (expected %u)",
+			 mcvlist->type, STATS_MCV_TYPE_BASIC);
+
+	if (mcvlist->nitems == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid zero-length item array in MCVList")));
+
+	if (mcvlist->nitems > STATS_MCVLIST_MAX_ITEMS ||
+		mcvlist->ndimensions < 2 ||
+		mcvlist->ndimensions > STATS_MAX_DIMENSIONS)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid MCV list with %u items and %d dimensions",
+						mcvlist->nitems, mcvlist->ndimensions)));
+
+	ndims = mcvlist->ndimensions;
+
+	if (tmp + sizeof(Oid) * ndims +
+		mcvlist->nitems * SizeOfMCVItem(ndims) > end)
+		elog(ERROR, "invalid MCV list size %ld", VARSIZE_ANY_EXHDR(data));
+
+	memcpy(mcvlist->types, tmp, sizeof(Oid) * ndims);
+	tmp += sizeof(Oid) * ndims;
+
+	for (dim = 0; dim < ndims; dim++)
+		get_typlenbyval(mcvlist->types[dim], &typlen[dim], &typbyval[dim]);
+
+	/* allocate space for the MCV items */
+	mcvlist = repalloc(mcvlist, offsetof(MCVList, items) +
+					   sizeof(MCVItem *) * mcvlist->nitems);
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = (MCVItem *) palloc0(sizeof(MCVItem));
+
+		item->values = (Datum *) palloc0(sizeof(Datum) * ndims);
+		item->isnull = (bool *) palloc(sizeof(bool) * ndims);
+
+		memcpy(&item->frequency, tmp, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(&item->base_frequency, tmp, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(item->isnull, tmp, sizeof(bool) * ndims);
+		tmp += sizeof(bool) * ndims;
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			if (item->isnull[dim])
+				continue;
+
+			if (typbyval[dim])
+			{
+				memcpy(&item->values[dim], tmp, sizeof(Datum));
+				tmp += sizeof(Datum);
+			}
+			else if (typlen[dim] > 0)
+			{
+				char	   *value = palloc(typlen[dim]);
+
+				memcpy(value, tmp, typlen[dim]);
+				tmp += typlen[dim];
+				item->values[dim] = PointerGetDatum(value);
+			}
+			else
+			{
+				uint32		vallen;
+				char	   *value;
+
+				memcpy(&vallen, tmp, sizeof(uint32));
+				tmp += sizeof(uint32);
+
+				if (tmp + vallen > end)
+					elog(ERROR, "invalid MCV list size %ld",
+						 VARSIZE_ANY_EXHDR(data));
+
+				value = palloc(vallen);
+				memcpy(value, tmp, vallen);
+				tmp += vallen;
+				item->values[dim] = PointerGetDatum(value);
+			}
+		}
+
+		mcvlist->items[i] = item;
+
+		/* still within the bytea */
+		Assert(tmp <= end);
+	}
+
+	/* we should have consumed the whole bytea exactly */
+	Assert(tmp == end);
+
+	return mcvlist;
+}
+
+/*
+ * statext_mcv_load
+ *		Load the MCV list for the indicated pg_statistic_ext tuple
+ */
+MCVList *
+statext_mcv_load(Oid mvoid)
+{
+	bool		isnull;
+	Datum		mcvlist;
+	HeapTuple	htup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(mvoid));
+
+	if (!HeapTupleIsValid(htup))
+		elog(ERROR, "cache lookup failed for extended statistics %u", mvoid);
+
+	mcvlist = SysCacheGetAttr(STATEXTOID, htup,
+							  Anum_pg_statistic_ext_stamcv, &isnull);
+
+	Assert(!isnull);
+
+	ReleaseSysCache(htup);
+
+	return statext_mcv_deserialize(DatumGetByteaP(mcvlist));
+}
+
+/*
+ * pg_mcv_list_in		- input routine for type pg_mcv_list.
+ *
+ * pg_mcv_list is real enough to be a table column, but it has no operations
+ * of its own, and disallows input too
+ */
+Datum
+pg_mcv_list_in(PG_FUNCTION_ARGS)
+{
+	/*
+	 * pg_mcv_list stores the data in binary form and parsing text input is
+	 * not needed, so disallow this.
+	 */
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("cannot accept a value of type %s", "pg_mcv_list")));
+
+	PG_RETURN_VOID();			/* keep compiler quiet */
+}
+
+/*
+ * pg_mcv_list_out		- output routine for type pg_mcv_list.
+ *
+ * Each item is printed as the combination of values, followed by its
+ * frequency and base frequency.
+ */
+Datum
+pg_mcv_list_out(PG_FUNCTION_ARGS)
+{
+	int			i,
+				dim;
+	StringInfoData str;
+	FmgrInfo	outfuncs[STATS_MAX_DIMENSIONS];
+
+	bytea	   *data = PG_GETARG_BYTEA_PP(0);
+
+	MCVList    *mcvlist = statext_mcv_deserialize(data);
+
+	for (dim = 0; dim < mcvlist->ndimensions; dim++)
+	{
+		Oid			outfunc;
+		bool		isvarlena;
+
+		getTypeOutputInfo(mcvlist->types[dim], &outfunc, &isvarlena);
+		fmgr_info(outfunc, &outfuncs[dim]);
+	}
+
+	initStringInfo(&str);
+	appendStringInfoChar(&str, '[');
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		if (i > 0)
+			appendStringInfoString(&str, ", ");
+
+		appendStringInfoString(&str, "{(");
+		for (dim = 0; dim < mcvlist->ndimensions; dim++)
+		{
+			if (dim > 0)
+				appendStringInfoString(&str, ", ");
+
+			if (item->isnull[dim])
+				appendStringInfoString(&str, "NULL");
+			else
+				appendStringInfoString(&str,
+									   OutputFunctionCall(&outfuncs[dim],
+														  item->values[dim]));
+		}
+		appendStringInfo(&str, ") : %f, %f}",
+						 item->frequency, item->base_frequency);
+	}
+
+	appendStringInfoChar(&str, ']');
+
+	PG_RETURN_CSTRING(str.data);
+}
+
+/*
+ * pg_mcv_list_recv		- binary input routine for type pg_mcv_list.
+ */
+Datum
+pg_mcv_list_recv(PG_FUNCTION_ARGS)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("cannot accept a value of type %s", "pg_mcv_list")));
+
+	PG_RETURN_VOID();			/* keep compiler quiet */
+}
+
+/*
+ * pg_mcv_list_send		- binary output routine for type pg_mcv_list.
+ *
+ * MCV lists are serialized in a bytea value (although the type is named
+ * differently), so let's just send that.
+ */
+Datum
+pg_mcv_list_send(PG_FUNCTION_ARGS)
+{
+	return byteasend(fcinfo);
+}
+
+/*
+ * mcv_is_compatible_clause
+ *		Determines if the clause is compatible with MCV lists
+ *
+ * We support OpExprs comparing a Var to a Const using an operator estimated
+ * by eqsel, scalarltsel or scalargtsel (in either order of arguments), and
+ * NullTests on a Var.  The Const is required (rather than any pseudoconstant)
+ * because we evaluate the clause against the values stored in the list.
+ * When returning true, attnum is set to the attribute number of the Var.
+ */
+static bool
+mcv_is_compatible_clause(Node *clause, Index relid, AttrNumber *attnum)
+{
+	RestrictInfo *rinfo = (RestrictInfo *) clause;
+	Var		   *var;
+
+	if (!IsA(rinfo, RestrictInfo))
+		return false;
+
+	/* Pseudoconstants are not really interesting here. */
+	if (rinfo->pseudoconstant)
+		return false;
+
+	/* clauses referencing multiple varnos are incompatible */
+	if (bms_membership(rinfo->clause_relids) != BMS_SINGLETON)
+		return false;
+
+	clause = (Node *) rinfo->clause;
+
+	if (is_opclause(clause))
+	{
+		OpExpr	   *expr = (OpExpr *) clause;
+		Node	   *leftop,
+				   *rightop;
+
+		/* Only expressions with two arguments are considered compatible. */
+		if (list_length(expr->args) != 2)
+			return false;
+
+		leftop = linitial(expr->args);
+		rightop = lsecond(expr->args);
+
+		if (IsA(leftop, Var) && IsA(rightop, Const))
+			var = (Var *) leftop;
+		else if (IsA(leftop, Const) && IsA(rightop, Var))
+			var = (Var *) rightop;
+		else
+			return false;
+
+		/*
+		 * Only equality and inequality operators are supported, identified
+		 * by the function for estimating selectivity (as elsewhere).
+		 */
+		switch (get_oprrest(expr->opno))
+		{
+			case F_EQSEL:
+			case F_SCALARLTSEL:
+			case F_SCALARGTSEL:
+				break;
+
+			default:
+				return false;
+		}
+	}
+	else if (IsA(clause, NullTest))
+	{
+		NullTest   *ntest = (NullTest *) clause;
+
+		if (!IsA(ntest->arg, Var))
+			return false;
+
+		var = (Var *) ntest->arg;
+	}
+	else
+		return false;
+
+	/* Ensure var is from the correct relation */
+	if (var->varno != relid)
+		return false;
+
+	/* we also better ensure the Var is from the current level */
+	if (var->varlevelsup > 0)
+		return false;
+
+	/* Also skip system attributes (we don't allow stats on those). */
+	if (!AttrNumberIsForUserDefinedAttr(var->varattno))
+		return false;
+
+	*attnum = var->varattno;
+	return true;
+}
+
+/*
+ * mcv_item_matches_clause
+ *		Evaluate a compatible clause on the 'dim' value of a MCV item
+ */
+static bool
+mcv_item_matches_clause(MCVItem *item, int dim, Node *clause)
+{
+	if (IsA(clause, RestrictInfo))
+		clause = (Node *) ((RestrictInfo *) clause)->clause;
+
+	if (IsA(clause, NullTest))
+	{
+		NullTest   *ntest = (NullTest *) clause;
+
+		if (ntest->nulltesttype == IS_NULL)
+			return item->isnull[dim];
+		else
+			return !item->isnull[dim];
+	}
+	else
+	{
+		OpExpr	   *expr = (OpExpr *) clause;
+		bool		varonleft = IsA(linitial(expr->args), Var);
+		Const	   *cst;
+		FmgrInfo	opproc;
+
+		cst = (Const *) (varonleft ? lsecond(expr->args) :
+						 linitial(expr->args));
+
+		/* the operators we accept are strict */
+		if (item->isnull[dim] || cst->constisnull)
+			return false;
+
+		fmgr_info(get_opcode(expr->opno), &opproc);
+
+		if (varonleft)
+			return DatumGetBool(FunctionCall2Coll(&opproc,
+												  expr->inputcollid,
+												  item->values[dim],
+												  cst->constvalue));
+		else
+			return DatumGetBool(FunctionCall2Coll(&opproc,
+												  expr->inputcollid,
+												  cst->constvalue,
+												  item->values[dim]));
+	}
+}
+
+/*
+ * mcv_clauselist_selectivity
+ *		Attempt to estimate selectivity using a multi-column MCV list
+ *
+ * We evaluate all the compatible clauses on columns covered by the chosen
+ * statistics against each item of the MCV list, and sum the frequencies of
+ * the matching items.  That gives us an exact (well, as exact as the sample)
+ * selectivity for the part of the data covered by the list.
+ *
+ * For the rest of the data we fall back on the per-column estimates.  We
+ * compute the selectivity assuming independence, and subtract the base
+ * frequency of the matching items (which is the part of that estimate the
+ * MCV list already accounts for).  The result is clamped to the fraction of
+ * the data not covered by the list, i.e.
+ *
+ *	   sel = mcv_sel + Min(Max(simple_sel - mcv_basesel, 0), 1 - mcv_totalsel)
+ *
+ * The 0-based list positions of the clauses we estimated are added to
+ * 'estimatedclauses', and we return 1.0 if no clauses were estimated.
+ */
+Selectivity
+mcv_clauselist_selectivity(PlannerInfo *root,
+						   List *clauses,
+						   int varRelid,
+						   JoinType jointype,
+						   SpecialJoinInfo *sjinfo,
+						   RelOptInfo *rel,
+						   Bitmapset **estimatedclauses)
+{
+	ListCell   *l;
+	Bitmapset  *clauses_attnums = NULL;
+	StatisticExtInfo *stat;
+	MCVList    *mcvlist;
+	AttrNumber *list_attnums;
+	List	   *stat_clauses = NIL;
+	List	   *stat_dims = NIL;
+	int			listidx;
+	int			i;
+	Selectivity mcv_sel = 0.0,
+				mcv_basesel = 0.0,
+				mcv_totalsel = 0.0,
+				simple_sel,
+				other_sel,
+				s1;
+
+	/* check if there's any stats that might be useful for us. */
+	if (!has_stats_of_kind(rel->statlist, STATS_EXT_MCV))
+		return 1.0;
+
+	list_attnums = (AttrNumber *) palloc(sizeof(AttrNumber) *
+										 list_length(clauses));
+
+	/*
+	 * Pre-process the clauses list to extract the attnums seen in each item,
+	 * skipping clauses already estimated by other statistics.
+	 */
+	listidx = 0;
+	foreach(l, clauses)
+	{
+		Node	   *clause = (Node *) lfirst(l);
+		AttrNumber	attnum;
+
+		if (!bms_is_member(listidx, *estimatedclauses) &&
+			mcv_is_compatible_clause(clause, rel->relid, &attnum))
+		{
+			list_attnums[listidx] = attnum;
+			clauses_attnums = bms_add_member(clauses_attnums, attnum);
+		}
+		else
+			list_attnums[listidx] = InvalidAttrNumber;
+
+		listidx++;
+	}
+
+	/*
+	 * If there's not at least two distinct attnums then reject the whole list
+	 * of clauses. We must return 1.0 so the calling function's selectivity is
+	 * unaffected.
+	 */
+	if (bms_num_members(clauses_attnums) < 2)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	/* find the best suited statistics for these attnums */
+	stat = choose_best_statistics(rel->statlist, clauses_attnums,
+								  STATS_EXT_MCV);
+
+	/* if no matching stats could be found then we've nothing to do */
+	if (!stat)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	/* collect the clauses covered by the statistics, with their dimensions */
+	listidx = -1;
+	foreach(l, clauses)
+	{
+		AttrNumber	attnum;
+		int			dim;
+		int			k;
+
+		listidx++;
+		attnum = list_attnums[listidx];
+
+		if (attnum == InvalidAttrNumber || !bms_is_member(attnum, stat->keys))
+			continue;
+
+		/* the dimension is the position of the attnum within the keys */
+		dim = 0;
+		k = -1;
+		while ((k = bms_next_member(stat->keys, k)) != attnum)
+			dim++;
+
+		stat_clauses = lappend(stat_clauses, lfirst(l));
+		stat_dims = lappend_int(stat_dims, dim);
+
+		*estimatedclauses = bms_add_member(*estimatedclauses, listidx);
+	}
+
+	/* load the MCV list stored in the statistics */
+	mcvlist = statext_mcv_load(stat->statOid);
+
+	/* sum the frequencies of the items matching all the clauses */
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+		ListCell   *lc1,
+				   *lc2;
+		bool		match = true;
+
+		mcv_totalsel += item->frequency;
+
+		forboth(lc1, stat_clauses, lc2, stat_dims)
+		{
+			if (!mcv_item_matches_clause(item, lfirst_int(lc2),
+										 (Node *) lfirst(lc1)))
+			{
+				match = false;
+				break;
+			}
+		}
+
+		if (match)
+		{
+			mcv_sel += item->frequency;
+			mcv_basesel += item->base_frequency;
+		}
+	}
+
+	/*
+	 * Estimate the clauses as if they were independent, without using the
+	 * extended statistics (this still recognizes range queries).
+	 */
+	simple_sel = clauselist_selectivity(root, stat_clauses, varRelid,
+										jointype, sjinfo, NULL);
+
+	/* the part of the data not covered by the MCV list */
+	other_sel = simple_sel - mcv_basesel;
+	if (other_sel > 1.0 - mcv_totalsel)
+		other_sel = 1.0 - mcv_totalsel;
+	if (other_sel < 0.0)
+		other_sel = 0.0;
+
+	s1 = mcv_sel + other_sel;
+	CLAMP_PROBABILITY(s1);
+
+	list_free(stat_clauses);
+	list_free(stat_dims);
+	pfree(list_attnums);
+
+	return s1;
+}
@@ -45,6 +45,8 @@
 #include "storage/sinvaladt.h"
 #include "storage/spin.h"
 #include "utils/backend_random.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 
 
@@ -135,7 +137,10 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		size = add_size(size, LWLockShmemSize());
 		size = add_size(size, ProcArrayShmemSize());
 		size = add_size(size, BackendStatusShmemSize());
+		size = add_size(size, PgStatShmemSize());
 		size = add_size(size, SInvalShmemSize());
+		size = add_size(size, SharedCatCacheShmemSize());
+		size = add_size(size, SharedPlanCacheShmemSize());
 		size = add_size(size, PMSignalShmemSize());
 		size = add_size(size, ProcSignalShmemSize());
 		size = add_size(size, CheckpointerShmemSize());
@@ -241,6 +246,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		InitProcGlobal();
 	CreateSharedProcArray();
 	CreateSharedBackendStatus();
+	PgStatShmemInit();
 	TwoPhaseShmemInit();
 	BackgroundWorkerShmemInit();
 
@@ -248,6 +254,8 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 	 * Set up shared-inval messaging
 	 */
 	CreateSharedInvalidationState();
+	SharedCatCacheShmemInit();
+	SharedPlanCacheShmemInit();
 
 	/*
 	 * Set up interprocess signaling mechanisms
@@ -21,6 +21,8 @@
 #include "storage/proc.h"
 #include "storage/sinvaladt.h"
 #include "utils/inval.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 
 
 uint64		SharedInvalidMessageCounter;
@@ -49,6 +51,13 @@ void
 SendSharedInvalidMessages(const SharedInvalidationMessage *msgs, int n)
 {
 	SIInsertDataEntries(msgs, n);
+
+	/*
+	 * Let the shared catalog and plan caches know, now that backends about
+	 * to read the catalogs or plan will see the messages.
+	 */
+	SharedCatCacheInvalidate(msgs, n);
+	SharedPlanCacheInvalidate(msgs, n);
 }
 
 /*
@@ -555,6 +555,18 @@ FindLockCycleRecurseMember(PGPROC *checkProc,
 	int			numLockModes,
 				lm;
 
+	/*
+	 * Relation extension and page locks can never take part in a deadlock
+	 * cycle: a process holding one of them doesn't wait for any heavyweight
+	 * lock other than a relation extension lock, whose holder waits for none.
+	 * So there's no point following wait edges from them.  That also matters
+	 * because these locks conflict even between members of a lock group (see
+	 * LockCheckConflicts), which the group handling below doesn't know about.
+	 */
+	if (lock->tag.locktag_type == LOCKTAG_RELATION_EXTEND ||
+		lock->tag.locktag_type == LOCKTAG_PAGE)
+		return false;
+
 	lockMethodTable = GetLocksMethodTable(lock);
 	numLockModes = lockMethodTable->numLockModes;
 	conflictMask = lockMethodTable->conflictTab[checkProc->waitLockMode];
@@ -1353,6 +1353,21 @@ LockCheckConflicts(LockMethod lockMethodTable,
 		return STATUS_FOUND;
 	}
 
+	/*
+	 * Relation extension and page locks serialize physical changes to a
+	 * relation, which members of a lock group can make concurrently too
+	 * (parallel COPY FROM workers insert into the same relation), so these
+	 * conflict even within a group.  The deadlock detector ignores waits for
+	 * these locks; see FindLockCycleRecurseMember.
+	 */
+	if (lock->tag.locktag_type == LOCKTAG_RELATION_EXTEND ||
+		lock->tag.locktag_type == LOCKTAG_PAGE)
+	{
+		PROCLOCK_PRINT("LockCheckConflicts: conflicting (group, physical)",
+					   proclock);
+		return STATUS_FOUND;
+	}
+
 	/*
 	 * Locks held in conflicting modes by members of our own lock group are
 	 * not real conflicts; we can subtract those out and see if we still have
@@ -2305,6 +2320,37 @@ LockReleaseSession(LOCKMETHODID lockmethodid)
 	}
 }
 
+/*
+ * HaveSessionLocks -- Does the current process hold any session locks?
+ *
+ * Outside a transaction, those can only be advisory locks.
+ */
+bool
+HaveSessionLocks(void)
+{
+	HASH_SEQ_STATUS status;
+	LOCALLOCK  *locallock;
+
+	hash_seq_init(&status, LockMethodLocalHash);
+
+	while ((locallock = (LOCALLOCK *) hash_seq_search(&status)) != NULL)
+	{
+		int			i;
+
+		/* a session lock has a NULL owner */
+		for (i = 0; i < locallock->numLockOwners; i++)
+		{
+			if (locallock->lockOwners[i].owner == NULL)
+			{
+				hash_seq_term(&status);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 /*
  * LockReleaseCurrentOwner
  *		Release all locks belonging to CurrentResourceOwner
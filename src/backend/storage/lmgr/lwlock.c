@@ -494,7 +494,7 @@ RegisterLWLockTranches(void)
 
 	if (LWLockTrancheArray == NULL)
 	{
-		LWLockTranchesAllocated = 64;
+		LWLockTranchesAllocated = 128;
 		LWLockTrancheArray = (char **)
 			MemoryContextAllocZero(TopMemoryContext,
 						  LWLockTranchesAllocated * sizeof(char *));
@@ -511,6 +511,13 @@ RegisterLWLockTranches(void)
 	LWLockRegisterTranche(LWTRANCHE_PARALLEL_QUERY_DSA,
 						  "parallel_query_dsa");
 	LWLockRegisterTranche(LWTRANCHE_TBM, "tbm");
+	LWLockRegisterTranche(LWTRANCHE_PARALLEL_APPEND, "parallel_append");
+	LWLockRegisterTranche(LWTRANCHE_STATS_DSA, "stats_dsa");
+	LWLockRegisterTranche(LWTRANCHE_STATS_HASH, "stats_hash");
+	LWLockRegisterTranche(LWTRANCHE_SHARED_PLAN_DSA, "shared_plan_dsa");
+	LWLockRegisterTranche(LWTRANCHE_SHARED_PLAN_HASH, "shared_plan_hash");
+	LWLockRegisterTranche(LWTRANCHE_SHARED_CATCACHE_DSA, "shared_catcache_dsa");
+	LWLockRegisterTranche(LWTRANCHE_SHARED_CATCACHE_HASH, "shared_catcache_hash");
 
 	/* Register named tranches. */
 	for (i = 0; i < NamedLWLockTrancheRequests; i++)
@@ -255,8 +255,16 @@ ReadyForQuery(CommandDest dest)
 			}
 			else
 				pq_putemptymessage('Z');
-			/* Flush output at end of cycle in any case. */
-			pq_flush();
+
+			/*
+			 * Flush output at end of cycle, unless the client has already
+			 * sent us the whole of its next message.  A client pipelining its
+			 * queries then gets the replies to a whole batch in as few sends
+			 * as the buffer allows; they're flushed when input runs dry,
+			 * before we wait for more (see SocketBackend).
+			 */
+			if (!pq_buffer_has_message())
+				pq_flush();
 			break;
 
 		case DestNone:
@@ -39,9 +39,12 @@
 #include "access/parallel.h"
 #include "access/printtup.h"
 #include "access/xact.h"
+#include "catalog/namespace.h"
 #include "catalog/pg_type.h"
 #include "commands/async.h"
 #include "commands/prepare.h"
+#include "libpq/auth.h"
+#include "libpq/hba.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "libpq/pqsignal.h"
@@ -55,11 +58,13 @@
 #include "pg_getopt.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/postmaster.h"
+#include "postmaster/proxy.h"
 #include "replication/slot.h"
 #include "replication/walsender.h"
 #include "rewrite/rewriteHandler.h"
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
+#include "storage/lock.h"
 #include "storage/proc.h"
 #include "storage/procsignal.h"
 #include "storage/sinval.h"
@@ -69,6 +74,7 @@
 #include "tcop/utility.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/portal.h"
 #include "utils/ps_status.h"
 #include "utils/snapmgr.h"
 #include "utils/timeout.h"
@@ -186,6 +192,9 @@ static bool IsTransactionExitStmt(Node *parsetree);
 static bool IsTransactionExitStmtList(List *pstmts);
 static bool IsTransactionStmtList(List *pstmts);
 static void drop_unnamed_stmt(void);
+static void RecordPortalPlanExecution(Portal portal, double msecs);
+static void ProcessPooledSessionStartup(StringInfo input_message);
+static void ReportPooledSessionState(void);
 static void SigHupHandler(SIGNAL_ARGS);
 static void log_disconnections(int code, Datum arg);
 
@@ -330,6 +339,15 @@ SocketBackend(StringInfo inBuf)
 	 * Get message type code from the frontend.
 	 */
 	HOLD_CANCEL_INTERRUPTS();
+
+	/*
+	 * Replies to pipelined messages may have been left in the send buffer
+	 * while more input was waiting; send them before we might block, which
+	 * we can even if part of the next message has been received.
+	 */
+	if (!pq_buffer_has_message())
+		pq_flush();
+
 	pq_startmsgread();
 	qtype = pq_getbyte();
 
@@ -450,6 +468,15 @@ SocketBackend(StringInfo inBuf)
 						 errmsg("invalid frontend message type %d", qtype)));
 			break;
 
+		case PROXY_MSG_NEW_SESSION:	/* new client from connection proxy */
+			doing_extended_query_message = false;
+			/* only a connection proxy may send this */
+			if (MyProcPort == NULL || !MyProcPort->pooled)
+				ereport(FATAL,
+						(errcode(ERRCODE_PROTOCOL_VIOLATION),
+						 errmsg("invalid frontend message type %d", qtype)));
+			break;
+
 		case 'd':				/* copy data */
 		case 'c':				/* copy done */
 		case 'f':				/* copy fail */
@@ -1858,6 +1885,8 @@ exec_execute_message(const char *portal_name, long max_rows)
 	bool		execute_is_fetch;
 	bool		was_logged = false;
 	char		msec_str[32];
+	instr_time	starttime;
+	instr_time	duration;
 
 	/* Adjust destination to tell printtup.c what to do */
 	dest = whereToSendOutput;
@@ -1987,6 +2016,8 @@ exec_execute_message(const char *portal_name, long max_rows)
 	if (max_rows <= 0)
 		max_rows = FETCH_ALL;
 
+	INSTR_TIME_SET_CURRENT(starttime);
+
 	completed = PortalRun(portal,
 						  max_rows,
 						  true, /* always top level */
@@ -1995,8 +2026,19 @@ exec_execute_message(const char *portal_name, long max_rows)
 						  receiver,
 						  completionTag);
 
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, starttime);
+
 	(*receiver->rDestroy) (receiver);
 
+	/*
+	 * If the portal's cached plan ran to completion in one go, tell the plan
+	 * cache how long it took.  Runs spread over several Execute messages
+	 * would include time spent waiting for the client.
+	 */
+	if (completed && !execute_is_fetch && !is_xact_command && portal->cplan)
+		RecordPortalPlanExecution(portal, INSTR_TIME_GET_MILLISEC(duration));
+
 	if (completed)
 	{
 		if (is_xact_command)
@@ -2433,6 +2475,130 @@ exec_describe_portal_message(const char *portal_name)
 }
 
 
+/*
+ * RecordPortalPlanExecution
+ *
+ * Pass the run time of a portal made by Bind on to the plan cache entry of
+ * the statement it was bound from, if that still exists.  The statement
+ * name may have been given to another statement since the Bind, or the
+ * unnamed statement replaced; CachedPlanRecordExecution then finds that
+ * the portal's plan isn't the statement's and ignores it.
+ */
+static void
+RecordPortalPlanExecution(Portal portal, double msecs)
+{
+	CachedPlanSource *psrc;
+
+	if (portal->prepStmtName)
+	{
+		PreparedStatement *pstmt;
+
+		pstmt = FetchPreparedStatement(portal->prepStmtName, false);
+		psrc = pstmt ? pstmt->plansource : NULL;
+	}
+	else
+		psrc = unnamed_stmt_psrc;
+
+	if (psrc)
+		CachedPlanRecordExecution(psrc, portal->cplan, msecs);
+}
+
+/*
+ * ProcessPooledSessionStartup
+ *
+ * A connection proxy has handed us a new client.  Authenticate it as if it
+ * had connected to us directly, then send it what a freshly started backend
+ * would: the reportable GUC values and our cancel key.  The proxy only
+ * hands us clients whose startup packet matched ours, so the user and
+ * database are already the right ones.
+ *
+ * The message comes down the same socket as the clients' messages, so we
+ * only believe it if it carries our cancel key, which the proxy keeps to
+ * itself, and if we're not in the middle of someone's transaction.
+ */
+static void
+ProcessPooledSessionStartup(StringInfo input_message)
+{
+	Port	   *port = MyProcPort;
+	int32		key;
+	int			salen;
+	StringInfoData buf;
+
+	key = (int32) pq_getmsgint(input_message, 4);
+	if (key != MyCancelKey || IsTransactionOrTransactionBlock())
+		ereport(FATAL,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("unexpected new session message")));
+
+	salen = pq_getmsgint(input_message, 4);
+	if (salen <= 0 || salen > sizeof(port->raddr.addr))
+		ereport(FATAL,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("invalid client address length %d", salen)));
+	memset(&port->raddr, 0, sizeof(port->raddr));
+	pq_copymsgbytes(input_message, (char *) &port->raddr.addr, salen);
+	port->raddr.salen = salen;
+	pq_getmsgend(input_message);
+
+	/* Authentication may need catalog access, so do it in a transaction */
+	SetCurrentStatementStartTimestamp();
+	StartTransactionCommand();
+
+	/* As in PerformAuthentication(), don't let a client hang around */
+	ClientAuthInProgress = true;
+	enable_timeout_after(STATEMENT_TIMEOUT, AuthenticationTimeout * 1000);
+
+	/* This ereports FATAL, ending this backend, if the client fails */
+	ClientAuthentication(port);
+
+	disable_timeout(STATEMENT_TIMEOUT, false);
+	ClientAuthInProgress = false;
+
+	CommitTransactionCommand();
+
+	if (Log_connections)
+		ereport(LOG,
+				(errmsg("pooled connection authorized: user=%s database=%s",
+						port->user_name, port->database_name)));
+
+	BeginReportingGUCOptions();
+
+	pq_beginmessage(&buf, 'K');
+	pq_sendint(&buf, (int32) MyProcPid, sizeof(int32));
+	pq_sendint(&buf, (int32) MyCancelKey, sizeof(int32));
+	pq_endmessage(&buf);
+}
+
+/*
+ * ReportPooledSessionState
+ *
+ * Tell the connection proxy whether the session, now idle outside any
+ * transaction block, could carry on in another backend.  It can't if it
+ * has created anything that lives beyond a transaction.
+ */
+static void
+ReportPooledSessionState(void)
+{
+	Oid			tempNamespaceId;
+	Oid			tempToastNamespaceId;
+	bool		has_state;
+	StringInfoData buf;
+
+	GetTempNamespaceState(&tempNamespaceId, &tempToastNamespaceId);
+
+	has_state = OidIsValid(tempNamespaceId) ||
+		HavePreparedStatements() ||
+		HaveSessionLocks() ||
+		HaveListenChannels() ||
+		HavePortals() ||
+		HaveSessionGUCSettings();
+
+	pq_beginmessage(&buf, PROXY_MSG_SESSION_STATE);
+	pq_sendbyte(&buf, has_state ? 'S' : 'F');
+	pq_endmessage(&buf);
+}
+
+
 /*
  * Convenience routines for starting/committing a single command.
  */
@@ -3727,8 +3893,11 @@ PostgresMain(int argc, char *argv[],
 	 * *MyProcPort, because ConnCreate() allocated that space with malloc()
 	 * ... else we'd need to copy the Port data first.  Also, subsidiary data
 	 * such as the username isn't lost either; see ProcessStartupPacket().
+	 *
+	 * A backend pooled by a connection proxy keeps it, since it authenticates
+	 * every client handed to it against the parsed hba and ident files.
 	 */
-	if (PostmasterContext)
+	if (PostmasterContext && !(MyProcPort && MyProcPort->pooled))
 	{
 		MemoryContextDelete(PostmasterContext);
 		PostmasterContext = NULL;
@@ -3969,8 +4138,12 @@ PostgresMain(int argc, char *argv[],
 				set_ps_display("idle in transaction (aborted)", false);
 				pgstat_report_activity(STATE_IDLEINTRANSACTION_ABORTED, NULL);
 
-				/* Start the idle-in-transaction timer */
-				if (IdleInTransactionSessionTimeout > 0)
+				/*
+				 * Start the idle-in-transaction timer, unless the whole of
+				 * the next message is already here
+				 */
+				if (IdleInTransactionSessionTimeout > 0 &&
+					!pq_buffer_has_message())
 				{
 					disable_idle_in_transaction_timeout = true;
 					enable_timeout_after(IDLE_IN_TRANSACTION_SESSION_TIMEOUT,
@@ -3982,8 +4155,12 @@ PostgresMain(int argc, char *argv[],
 				set_ps_display("idle in transaction", false);
 				pgstat_report_activity(STATE_IDLEINTRANSACTION, NULL);
 
-				/* Start the idle-in-transaction timer */
-				if (IdleInTransactionSessionTimeout > 0)
+				/*
+				 * Start the idle-in-transaction timer, unless the whole of
+				 * the next message is already here
+				 */
+				if (IdleInTransactionSessionTimeout > 0 &&
+					!pq_buffer_has_message())
 				{
 					disable_idle_in_transaction_timeout = true;
 					enable_timeout_after(IDLE_IN_TRANSACTION_SESSION_TIMEOUT,
@@ -3997,6 +4174,10 @@ PostgresMain(int argc, char *argv[],
 
 				set_ps_display("idle", false);
 				pgstat_report_activity(STATE_IDLE, NULL);
+
+				/* Tell the connection proxy if the session can move */
+				if (MyProcPort && MyProcPort->pooled)
+					ReportPooledSessionState();
 			}
 
 			ReadyForQuery(whereToSendOutput);
@@ -4045,6 +4226,19 @@ PostgresMain(int argc, char *argv[],
 		{
 			got_SIGHUP = false;
 			ProcessConfigFile(PGC_SIGHUP);
+
+			/* A pooled backend authenticates clients itself */
+			if (MyProcPort && MyProcPort->pooled)
+			{
+				MemoryContext oldcontext;
+
+				oldcontext = MemoryContextSwitchTo(PostmasterContext);
+				if (!load_hba())
+					ereport(LOG,
+							(errmsg("pg_hba.conf was not reloaded")));
+				load_ident();
+				MemoryContextSwitchTo(oldcontext);
+			}
 		}
 
 		/*
@@ -4260,6 +4454,11 @@ PostgresMain(int argc, char *argv[],
 				}
 				break;
 
+			case PROXY_MSG_NEW_SESSION:
+				ProcessPooledSessionStartup(&input_message);
+				send_ready_for_query = true;
+				break;
+
 			case 'H':			/* flush */
 				pq_getmsgend(&input_message);
 				if (whereToSendOutput == DestRemote)
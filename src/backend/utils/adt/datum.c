@@ -37,11 +37,14 @@
  * will be copied or compared is the compressed data or toast reference.
  * An exception is made for datumCopy() of an expanded object, however,
  * because most callers expect to get a simple contiguous (and pfree'able)
- * result from datumCopy().  See also datumTransfer().
+ * result from datumCopy().  See also datumTransfer().  datum_image_eq()
+ * and datum_image_hash() detoast their arguments too.
  */
 
 #include "postgres.h"
 
+#include "access/hash.h"
+#include "fmgr.h"
 #include "utils/datum.h"
 #include "utils/expandeddatum.h"
 
@@ -251,6 +254,102 @@ datumIsEqual(Datum value1, Datum value2, bool typByVal, int typLen)
 	return res;
 }
 
+/*-------------------------------------------------------------------------
+ * datum_image_eq
+ *
+ * Compares two datums for identical contents, based on byte images.  Return
+ * true if the two datums are equal, false otherwise.
+ *
+ * Unlike datumIsEqual, this detoasts varlena values first, so different
+ * physical representations of the same image compare equal.  Unlike the
+ * type's equality operator, values that the operator considers equal but
+ * whose images differ, like numeric 1.0 and 1.00, compare unequal.
+ *-------------------------------------------------------------------------
+ */
+bool
+datum_image_eq(Datum value1, Datum value2, bool typByVal, int typLen)
+{
+	bool		result;
+
+	if (typByVal)
+		result = (value1 == value2);
+	else if (typLen > 0)
+		result = (memcmp(DatumGetPointer(value1),
+						 DatumGetPointer(value2),
+						 typLen) == 0);
+	else if (typLen == -1)
+	{
+		struct varlena *arg1 = PG_DETOAST_DATUM_PACKED(value1);
+		struct varlena *arg2 = PG_DETOAST_DATUM_PACKED(value2);
+		Size		len1 = VARSIZE_ANY_EXHDR(arg1);
+		Size		len2 = VARSIZE_ANY_EXHDR(arg2);
+
+		result = (len1 == len2 &&
+				  memcmp(VARDATA_ANY(arg1), VARDATA_ANY(arg2), len1) == 0);
+
+		/* Only free memory if it's a copy made here. */
+		if ((Pointer) arg1 != DatumGetPointer(value1))
+			pfree(arg1);
+		if ((Pointer) arg2 != DatumGetPointer(value2))
+			pfree(arg2);
+	}
+	else if (typLen == -2)
+		result = (strcmp(DatumGetCString(value1),
+						 DatumGetCString(value2)) == 0);
+	else
+	{
+		elog(ERROR, "unexpected typLen: %d", typLen);
+		result = false;			/* keep compiler quiet */
+	}
+
+	return result;
+}
+
+/*-------------------------------------------------------------------------
+ * datum_image_hash
+ *
+ * Generate a hash value based on the binary representation of 'value',
+ * consistent with datum_image_eq.  Most callers want the hash function
+ * specific to the datum's type instead.
+ *-------------------------------------------------------------------------
+ */
+uint32
+datum_image_hash(Datum value, bool typByVal, int typLen)
+{
+	uint32		result;
+
+	if (typByVal)
+		result = DatumGetUInt32(hash_any((unsigned char *) &value,
+										 sizeof(Datum)));
+	else if (typLen > 0)
+		result = DatumGetUInt32(hash_any((unsigned char *)
+										 DatumGetPointer(value), typLen));
+	else if (typLen == -1)
+	{
+		struct varlena *val = PG_DETOAST_DATUM_PACKED(value);
+
+		result = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(val),
+										 VARSIZE_ANY_EXHDR(val)));
+
+		/* Only free memory if it's a copy made here. */
+		if ((Pointer) val != DatumGetPointer(value))
+			pfree(val);
+	}
+	else if (typLen == -2)
+	{
+		char	   *s = DatumGetCString(value);
+
+		result = DatumGetUInt32(hash_any((unsigned char *) s, strlen(s)));
+	}
+	else
+	{
+		elog(ERROR, "unexpected typLen: %d", typLen);
+		result = 0;				/* keep compiler quiet */
+	}
+
+	return result;
+}
+
 /*-------------------------------------------------------------------------
  * datumEstimateSpace
  *
@@ -6419,9 +6419,10 @@ genericcostestimate(PlannerInfo *root,
 
 	/*
 	 * Check for ScalarArrayOpExpr index quals, and estimate the number of
-	 * index scans that will be performed.
+	 * index scans that will be performed.  The caller may already know of
+	 * other reasons for repeating the scan.
 	 */
-	num_sa_scans = 1;
+	num_sa_scans = Max(costs->num_sa_scans, 1);
 	foreach(l, indexQuals)
 	{
 		RestrictInfo *rinfo = (RestrictInfo *) lfirst(l);
@@ -6647,11 +6648,28 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	bool		found_saop;
 	bool		found_is_null_op;
 	double		num_sa_scans;
+	double		num_skip_scans;
 	ListCell   *lc;
 
 	/* Do preliminary analysis of indexquals */
 	qinfos = deconstruct_indexquals(path);
 
+	/*
+	 * A skip scan does a separate scan for each distinct value of the first
+	 * index column, behaving as if there were an '=' qual on that column.
+	 */
+	num_skip_scans = 1;
+	if (path->indexskip)
+	{
+		TargetEntry *tle = (TargetEntry *) linitial(index->indextlist);
+		VariableStatData skipdata;
+		bool		isdefault;
+
+		examine_variable(root, (Node *) tle->expr, 0, &skipdata);
+		num_skip_scans = get_variable_numdistinct(&skipdata, &isdefault);
+		ReleaseVariableStats(skipdata);
+	}
+
 	/*
 	 * For a btree scan, only leading '=' quals plus inequality quals for the
 	 * immediately next attribute contribute to index selectivity (these are
@@ -6671,10 +6689,10 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 */
 	indexBoundQuals = NIL;
 	indexcol = 0;
-	eqQualHere = false;
+	eqQualHere = path->indexskip;
 	found_saop = false;
 	found_is_null_op = false;
-	num_sa_scans = 1;
+	num_sa_scans = num_skip_scans;
 	foreach(lc, qinfos)
 	{
 		IndexQualInfo *qinfo = (IndexQualInfo *) lfirst(lc);
@@ -6741,11 +6759,13 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 * clauselist_selectivity calculations.  However, a ScalarArrayOp or
 	 * NullTest invalidates that theory, even though it sets eqQualHere.
 	 */
-	if (index->unique &&
-		indexcol == index->ncolumns - 1 &&
-		eqQualHere &&
-		!found_saop &&
-		!found_is_null_op)
+	if (path->indexdistinct)
+		numIndexTuples = 1.0;	/* only the first match per value is read */
+	else if (index->unique &&
+			 indexcol == index->ncolumns - 1 &&
+			 eqQualHere &&
+			 !found_saop &&
+			 !found_is_null_op)
 		numIndexTuples = 1.0;
 	else
 	{
@@ -6779,9 +6799,18 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 */
 	MemSet(&costs, 0, sizeof(costs));
 	costs.numIndexTuples = numIndexTuples;
+	costs.num_sa_scans = num_skip_scans;
 
 	genericcostestimate(root, path, loop_count, qinfos, &costs);
 
+	/*
+	 * A distinct skip scan visits at most one heap tuple per value of the
+	 * first column.
+	 */
+	if (path->indexdistinct)
+		costs.indexSelectivity = Min(costs.indexSelectivity,
+									 num_skip_scans / index->rel->tuples);
+
 	/*
 	 * Add a CPU-cost component to represent the costs of initial btree
 	 * descent.  We don't charge any I/O cost for touching upper btree levels,
@@ -6791,13 +6820,16 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 *
 	 * If there are ScalarArrayOpExprs, charge this once per SA scan.  The
 	 * ones after the first one are not startup cost so far as the overall
-	 * plan is concerned, so add them only to "total" cost.
+	 * plan is concerned, so add them only to "total" cost.  A skip scan
+	 * descends once more per distinct value to find the next value.
 	 */
 	if (index->tuples > 1)		/* avoid computing log(0) */
 	{
 		descentCost = ceil(log(index->tuples) / log(2.0)) * cpu_operator_cost;
 		costs.indexStartupCost += descentCost;
 		costs.indexTotalCost += costs.num_sa_scans * descentCost;
+		if (path->indexskip)
+			costs.indexTotalCost += num_skip_scans * descentCost;
 	}
 
 	/*
@@ -6813,6 +6845,8 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	descentCost = (index->tree_height + 1) * 50.0 * cpu_operator_cost;
 	costs.indexStartupCost += descentCost;
 	costs.indexTotalCost += costs.num_sa_scans * descentCost;
+	if (path->indexskip)
+		costs.indexTotalCost += num_skip_scans * descentCost;
 
 	/*
 	 * If we can get an estimate of the first column's ordering correlation C
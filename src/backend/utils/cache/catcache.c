@@ -24,6 +24,7 @@
 #include "access/xact.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_type.h"
+#include "funcapi.h"
 #include "miscadmin.h"
 #ifdef CATCACHE_STATS
 #include "storage/ipc.h"		/* for on_proc_exit */
@@ -35,6 +36,7 @@
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/resowner_private.h"
+#include "utils/sharedcatcache.h"
 #include "utils/syscache.h"
 #include "utils/tqual.h"
 
@@ -69,9 +71,15 @@
 #define CACHE6_elog(a,b,c,d,e,f,g)
 #endif
 
+/* Space charged to a cache entry against catalog_cache_memory_target */
+#define CatCTupSize(ct) (sizeof(CatCTup) + (ct)->tuple.t_len)
+
 /* Cache management header --- pointer is NULL until created */
 static CatCacheHeader *CacheHdr = NULL;
 
+/* GUC parameter: space for all catcache entries, in kB; 0 means no limit */
+int			catalog_cache_memory_target = 0;
+
 
 static uint32 CatalogCacheComputeHashValue(CatCache *cache, int nkeys,
 							 ScanKey cur_skey);
@@ -83,6 +91,7 @@ static void CatCachePrintStats(int code, Datum arg);
 #endif
 static void CatCacheRemoveCTup(CatCache *cache, CatCTup *ct);
 static void CatCacheRemoveCList(CatCache *cache, CatCList *cl);
+static void CatCacheEvict(Size needed);
 static void CatalogCacheInitializeCache(CatCache *cache);
 static CatCTup *CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp,
 						uint32 hashValue, Index hashIndex,
@@ -368,8 +377,14 @@ CatCacheRemoveCTup(CatCache *cache, CatCTup *ct)
 		return;					/* nothing left to do */
 	}
 
-	/* delink from linked list */
+	/* delink from linked lists */
 	dlist_delete(&ct->cache_elem);
+	dlist_delete(&ct->lru_elem);
+
+	cache->cc_size -= CatCTupSize(ct);
+	CacheHdr->ch_size -= CatCTupSize(ct);
+	if (ct->negative)
+		--cache->cc_nnegative;
 
 	/* free associated tuple data */
 	if (ct->tuple.t_data != NULL)
@@ -421,6 +436,42 @@ CatCacheRemoveCList(CatCache *cache, CatCList *cl)
 }
 
 
+/*
+ *		CatCacheEvict
+ *
+ * Evict least recently used entries, from any cache, until another "needed"
+ * bytes fit within catalog_cache_memory_target.
+ *
+ * Entries that are referenced, directly or through a CatCList, can't be
+ * removed; we move them to the most recently used end of the LRU list, which
+ * is where they belong anyway, so that we don't keep looking at them.
+ */
+static void
+CatCacheEvict(Size needed)
+{
+	Size		target = (Size) catalog_cache_memory_target * 1024;
+	int			nleft = CacheHdr->ch_ntup;
+
+	while (CacheHdr->ch_size + needed > target && nleft-- > 0)
+	{
+		CatCTup    *ct;
+
+		ct = dlist_container(CatCTup, lru_elem,
+							 dlist_head_node(&CacheHdr->ch_lru));
+
+		if (ct->refcount > 0 ||
+			(ct->c_list != NULL && ct->c_list->refcount > 0))
+		{
+			dlist_move_tail(&CacheHdr->ch_lru, &ct->lru_elem);
+			continue;
+		}
+
+		ct->my_cache->cc_nevictions++;
+		CatCacheRemoveCTup(ct->my_cache, ct);
+	}
+}
+
+
 /*
  *	CatalogCacheIdInvalidate
  *
@@ -757,6 +808,8 @@ InitCatCache(int id,
 		CacheHdr = (CatCacheHeader *) palloc(sizeof(CatCacheHeader));
 		slist_init(&CacheHdr->ch_caches);
 		CacheHdr->ch_ntup = 0;
+		dlist_init(&CacheHdr->ch_lru);
+		CacheHdr->ch_size = 0;
 #ifdef CATCACHE_STATS
 		/* set up to dump stats at backend exit */
 		on_proc_exit(CatCachePrintStats, 0);
@@ -1115,6 +1168,9 @@ SearchCatCache(CatCache *cache,
 	Relation	relation;
 	SysScanDesc scandesc;
 	HeapTuple	ntp;
+	bool		use_shared;
+	Oid			shared_dbid = InvalidOid;
+	uint64		search_seq = 0;
 
 	/* Make sure we're in an xact, even if this ends up being a cache hit */
 	Assert(IsTransactionState());
@@ -1181,6 +1237,7 @@ SearchCatCache(CatCache *cache,
 		 * near the front of the hashbucket's list.)
 		 */
 		dlist_move_head(bucket, &ct->cache_elem);
+		dlist_move_tail(&CacheHdr->ch_lru, &ct->lru_elem);
 
 		/*
 		 * If it's a positive entry, bump its refcount and return it. If it's
@@ -1198,6 +1255,7 @@ SearchCatCache(CatCache *cache,
 #ifdef CATCACHE_STATS
 			cache->cc_hits++;
 #endif
+			cache->cc_nhits++;
 
 			return &ct->tuple;
 		}
@@ -1209,6 +1267,7 @@ SearchCatCache(CatCache *cache,
 #ifdef CATCACHE_STATS
 			cache->cc_neg_hits++;
 #endif
+			cache->cc_nneg_hits++;
 
 			return NULL;
 		}
@@ -1228,7 +1287,58 @@ SearchCatCache(CatCache *cache,
 	 * will eventually age out of the cache, so there's no functional problem.
 	 * This case is rare enough that it's not worth expending extra cycles to
 	 * detect.
+	 *
+	 * Before reading the relation, though, see whether another backend has
+	 * left the tuple, or the knowledge that there is none, in the shared
+	 * catalog cache.
 	 */
+	use_shared = SharedCatCacheUsable();
+	if (use_shared)
+	{
+		bool		negative;
+
+		if (!cache->cc_relisshared)
+			shared_dbid = MyDatabaseId;
+
+		ntp = SharedCatCacheFetch(cache->id, shared_dbid, hashValue,
+								  &negative);
+		if (ntp != NULL)
+		{
+			bool		res;
+
+			/* the entry could be for other keys with the same hash value */
+			HeapKeyTest(ntp,
+						cache->cc_tupdesc,
+						cache->cc_nkeys,
+						cur_skey,
+						res);
+			if (res)
+			{
+				ct = CatalogCacheCreateEntry(cache, ntp,
+											 hashValue, hashIndex,
+											 negative);
+				heap_freetuple(ntp);
+
+				CACHE3_elog(DEBUG2, "SearchCatCache(%s): put shared entry in bucket %d",
+							cache->cc_relname, hashIndex);
+
+				if (negative)
+					return NULL;
+
+				ResourceOwnerEnlargeCatCacheRefs(CurrentResourceOwner);
+				ct->refcount++;
+				ResourceOwnerRememberCatCacheRef(CurrentResourceOwner,
+												 &ct->tuple);
+				return &ct->tuple;
+			}
+			heap_freetuple(ntp);
+		}
+
+		search_seq = SharedCatCacheStartSearch();
+	}
+
+	cache->cc_nmisses++;
+
 	relation = heap_open(cache->cc_reloid, AccessShareLock);
 
 	scandesc = systable_beginscan(relation,
@@ -1252,6 +1362,10 @@ SearchCatCache(CatCache *cache,
 		break;					/* assume only one match */
 	}
 
+	if (ct != NULL && use_shared)
+		SharedCatCacheStore(cache->id, shared_dbid, hashValue,
+							&ct->tuple, false, search_seq);
+
 	systable_endscan(scandesc);
 
 	heap_close(relation, AccessShareLock);
@@ -1275,6 +1389,9 @@ SearchCatCache(CatCache *cache,
 		ct = CatalogCacheCreateEntry(cache, ntp,
 									 hashValue, hashIndex,
 									 true);
+		if (use_shared)
+			SharedCatCacheStore(cache->id, shared_dbid, hashValue,
+								ntp, true, search_seq);
 		heap_freetuple(ntp);
 
 		CACHE4_elog(DEBUG2, "SearchCatCache(%s): Contains %d/%d tuples",
@@ -1470,9 +1587,12 @@ SearchCatCacheList(CatCache *cache,
 		 * cache's list-of-lists, to speed subsequent searches.  (We do not
 		 * move the members to the fronts of their hashbucket lists, however,
 		 * since there's no point in that unless they are searched for
-		 * individually.)
+		 * individually.)  The members have been used though, so that evicting
+		 * them, which would take the list with them, should be put off.
 		 */
 		dlist_move_head(&cache->cc_lists, &cl->cache_elem);
+		for (i = 0; i < cl->n_members; i++)
+			dlist_move_tail(&CacheHdr->ch_lru, &cl->members[i]->lru_elem);
 
 		/* Bump the list's refcount and return it */
 		ResourceOwnerEnlargeCatCacheListRefs(CurrentResourceOwner);
@@ -1715,6 +1835,10 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp,
 	if (dtp != ntp)
 		heap_freetuple(dtp);
 
+	/* Make room for the new entry, if we're over budget */
+	if (catalog_cache_memory_target > 0)
+		CatCacheEvict(CatCTupSize(ct));
+
 	/*
 	 * Finish initializing the CatCTup header, and add it to the cache's
 	 * linked list and counts.
@@ -1728,6 +1852,12 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp,
 	ct->hash_value = hashValue;
 
 	dlist_push_head(&cache->cc_bucket[hashIndex], &ct->cache_elem);
+	dlist_push_tail(&CacheHdr->ch_lru, &ct->lru_elem);
+
+	cache->cc_size += CatCTupSize(ct);
+	CacheHdr->ch_size += CatCTupSize(ct);
+	if (negative)
+		cache->cc_nnegative++;
 
 	cache->cc_ntup++;
 	CacheHdr->ch_ntup++;
@@ -1929,3 +2059,113 @@ PrintCatCacheListLeakWarning(CatCList *list)
 		 list->my_cache->cc_relname, list->my_cache->id,
 		 list, list->refcount);
 }
+
+/*
+ * SQL-callable function reporting the size and hit statistics of this
+ * backend's catalog caches, one row per catcache plus one for the relcache.
+ * This must match the definition of the pg_catalog_cache_stats view in
+ * system_views.sql.
+ */
+Datum
+pg_get_catalog_cache_stats(PG_FUNCTION_ARGS)
+{
+#define CATALOG_CACHE_STATS_COLS	10
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	Datum		values[CATALOG_CACHE_STATS_COLS];
+	bool		nulls[CATALOG_CACHE_STATS_COLS];
+	slist_iter	iter;
+	RelationCacheStats relstats;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+
+	/* need to build tuplestore in query context */
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupdesc = CreateTemplateTupleDesc(CATALOG_CACHE_STATS_COLS, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "cache",
+					   TEXTOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "relid",
+					   REGCLASSOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "indexrelid",
+					   REGCLASSOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "entries",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "negative_entries",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "size",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "negative_hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "misses",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 10, "evictions",
+					   INT8OID, -1, 0);
+
+	tupstore =
+		tuplestore_begin_heap(rsinfo->allowedModes & SFRM_Materialize_Random,
+							  false, work_mem);
+
+	/* generate junk in short-term context */
+	MemoryContextSwitchTo(oldcontext);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	slist_foreach(iter, &CacheHdr->ch_caches)
+	{
+		CatCache   *cache = slist_container(CatCache, cc_next, iter.cur);
+
+		values[0] = CStringGetTextDatum("catcache");
+		values[1] = ObjectIdGetDatum(cache->cc_reloid);
+		values[2] = ObjectIdGetDatum(cache->cc_indexoid);
+		values[3] = Int64GetDatum((int64) cache->cc_ntup);
+		values[4] = Int64GetDatum((int64) cache->cc_nnegative);
+		values[5] = Int64GetDatum((int64) cache->cc_size);
+		values[6] = Int64GetDatum((int64) cache->cc_nhits);
+		values[7] = Int64GetDatum((int64) cache->cc_nneg_hits);
+		values[8] = Int64GetDatum((int64) cache->cc_nmisses);
+		values[9] = Int64GetDatum((int64) cache->cc_nevictions);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	/* The relcache has no negative entries, nor an underlying index */
+	RelationCacheGetStats(&relstats);
+
+	values[0] = CStringGetTextDatum("relcache");
+	nulls[1] = true;
+	nulls[2] = true;
+	values[3] = Int64GetDatum(relstats.entries);
+	values[4] = Int64GetDatum(0);
+	values[5] = Int64GetDatum(relstats.size);
+	values[6] = Int64GetDatum(relstats.hits);
+	values[7] = Int64GetDatum(0);
+	values[8] = Int64GetDatum(relstats.misses);
+	values[9] = Int64GetDatum(relstats.evictions);
+
+	tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	return (Datum) 0;
+}
@@ -705,6 +705,19 @@ AcceptInvalidationMessages(void)
 #endif
 }
 
+/*
+ * TransactionHasInvalidations
+ *		Has the current transaction registered any invalidation messages?
+ *
+ * If so, it has modified the system catalogs, and may see them differently
+ * from other backends until it ends.
+ */
+bool
+TransactionHasInvalidations(void)
+{
+	return transInvalInfo != NULL;
+}
+
 /*
  * PrepareInvalidationState
  *		Initialize inval lists for the current (sub)transaction.
@@ -60,6 +60,7 @@
 #include "optimizer/prep.h"
 #include "parser/analyze.h"
 #include "parser/parsetree.h"
+#include "portability/instr_time.h"
 #include "storage/lmgr.h"
 #include "tcop/pquery.h"
 #include "tcop/utility.h"
@@ -67,10 +68,17 @@
 #include "utils/memutils.h"
 #include "utils/resowner_private.h"
 #include "utils/rls.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
 
+/*
+ * When custom plans have been measured to beat the generic plan, the generic
+ * plan is given another try once in this many executions.
+ */
+#define GENERIC_PLAN_RECHECK_INTERVAL	100
+
 /*
  * We must skip "overhead" operations that involve database access when the
  * cached plan's subject statement is a transaction control command.
@@ -87,6 +95,12 @@
  */
 static CachedPlanSource *first_saved_plan = NULL;
 
+/* The source_id last assigned to a CachedPlanSource */
+static uint64 last_source_id = 0;
+
+/* GUC parameter */
+int			plan_cache_mode = PLAN_CACHE_MODE_AUTO;
+
 static void ReleaseGenericPlan(CachedPlanSource *plansource);
 static List *RevalidateCachedQuery(CachedPlanSource *plansource,
 								   QueryEnvironment *queryEnv);
@@ -96,6 +110,7 @@ static CachedPlan *BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 static bool choose_custom_plan(CachedPlanSource *plansource,
 				   ParamListInfo boundParams);
 static double cached_plan_cost(CachedPlan *plan, bool include_planner);
+static List *FetchSharedPlan(CachedPlanSource *plansource);
 static Query *QueryListGetPrimaryStmt(List *stmts);
 static void AcquireExecutorLocks(List *stmt_list, bool acquire);
 static void AcquirePlannerLocks(List *stmt_list, bool acquire);
@@ -203,10 +218,17 @@ CreateCachedPlan(RawStmt *raw_parse_tree,
 	plansource->is_saved = false;
 	plansource->is_valid = false;
 	plansource->generation = 0;
+	plansource->source_id = ++last_source_id;
 	plansource->next_saved = NULL;
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
 	plansource->num_custom_plans = 0;
+	plansource->total_custom_time = 0;
+	plansource->num_custom_runs = 0;
+	plansource->total_generic_time = 0;
+	plansource->num_generic_runs = 0;
+	plansource->generic_plan_count = 0;
+	plansource->custom_plan_count = 0;
 
 	MemoryContextSwitchTo(oldcxt);
 
@@ -271,10 +293,17 @@ CreateOneShotCachedPlan(RawStmt *raw_parse_tree,
 	plansource->is_saved = false;
 	plansource->is_valid = false;
 	plansource->generation = 0;
+	plansource->source_id = ++last_source_id;
 	plansource->next_saved = NULL;
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
 	plansource->num_custom_plans = 0;
+	plansource->total_custom_time = 0;
+	plansource->num_custom_runs = 0;
+	plansource->total_generic_time = 0;
+	plansource->num_generic_runs = 0;
+	plansource->generic_plan_count = 0;
+	plansource->custom_plan_count = 0;
 
 	return plansource;
 }
@@ -882,7 +911,9 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 				ParamListInfo boundParams, QueryEnvironment *queryEnv)
 {
 	CachedPlan *plan;
-	List	   *plist;
+	List	   *plist = NIL;
+	bool		use_shared;
+	uint64		plan_seq = 0;
 	bool		snapshot_set;
 	bool		is_transient;
 	MemoryContext plan_context;
@@ -905,6 +936,17 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	if (!plansource->is_valid)
 		qlist = RevalidateCachedQuery(plansource, queryEnv);
 
+	/*
+	 * A generic plan may have been made by another backend already; if so,
+	 * we can skip planning altogether.
+	 */
+	use_shared = (boundParams == NULL &&
+				  SharedPlanCacheUsable(plansource, queryEnv));
+	if (use_shared)
+		plist = FetchSharedPlan(plansource);
+	if (plist != NIL)
+		goto have_plan;
+
 	/*
 	 * If we don't already have a copy of the querytree list that can be
 	 * scribbled on by the planner, make one.  For a one-shot plan, we assume
@@ -932,14 +974,22 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	}
 
 	/*
-	 * Generate the plan.
+	 * Generate the plan, and offer it to other backends if we can.
 	 */
+	if (use_shared)
+		plan_seq = SharedPlanCacheStartPlanning();
+
 	plist = pg_plan_queries(qlist, plansource->cursor_options, boundParams);
 
+	if (use_shared)
+		SharedPlanCacheStore(plansource, plist, plan_seq);
+
 	/* Release snapshot if we got one */
 	if (snapshot_set)
 		PopActiveSnapshot();
 
+have_plan:
+
 	/*
 	 * Normally we make a dedicated memory context for the CachedPlan and its
 	 * subsidiary data.  (It's probably not going to be large, but just in
@@ -1001,15 +1051,48 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	plan->is_oneshot = plansource->is_oneshot;
 	plan->is_saved = false;
 	plan->is_valid = true;
+	plan->is_custom = false;
+	plan->planning_time = 0;
 
 	/* assign generation number to new plan */
 	plan->generation = ++(plansource->generation);
+	plan->source_id = plansource->source_id;
 
 	MemoryContextSwitchTo(oldcxt);
 
 	return plan;
 }
 
+/*
+ * FetchSharedPlan: look for a generic plan in the shared plan cache
+ *
+ * Returns the plan's PlannedStmt list, or NIL if there's no usable one.  As
+ * in CheckCachedPlan, we keep the executor locks we take on success.
+ */
+static List *
+FetchSharedPlan(CachedPlanSource *plansource)
+{
+	SharedPlanCheck *check;
+	List	   *plist;
+
+	plist = SharedPlanCacheFetch(plansource, &check);
+	if (plist == NIL)
+		return NIL;
+
+	/*
+	 * Lock the relations the plan uses.  This may process invalidations
+	 * that make the plan, or the querytree it was made for, obsolete; so
+	 * check again afterwards.
+	 */
+	AcquireExecutorLocks(plist, true);
+
+	if (plansource->is_valid && SharedPlanCacheRecheck(check))
+		return plist;
+
+	AcquireExecutorLocks(plist, false);
+	return NIL;
+}
+
 /*
  * choose_custom_plan: choose whether to use custom or generic plan
  *
@@ -1036,11 +1119,59 @@ choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams)
 		return false;
 	if (plansource->cursor_options & CURSOR_OPT_CUSTOM_PLAN)
 		return true;
+	if (plan_cache_mode == PLAN_CACHE_MODE_FORCE_GENERIC_PLAN)
+		return false;
+	if (plan_cache_mode == PLAN_CACHE_MODE_FORCE_CUSTOM_PLAN)
+		return true;
 
 	/* Generate custom plans until we have done at least 5 (arbitrary) */
 	if (plansource->num_custom_plans < 5)
 		return true;
 
+	/*
+	 * Once the current generic plan has actually been run, believe the
+	 * measured run times rather than the estimates: keep using the generic
+	 * plan only as long as it has taken less time on average than planning
+	 * and running a custom plan did.  Estimates of the generic plan's cost
+	 * are made without knowing the parameter values, so they can't tell when
+	 * some values make it very much slower than a custom plan would be.
+	 *
+	 * The measurements belong to the generic plan they were taken with, so
+	 * once that's invalidated we go back to the estimates until the new one
+	 * has been tried.
+	 */
+	if (plansource->num_generic_runs > 0 && plansource->num_custom_runs > 0 &&
+		plansource->gplan && plansource->gplan->is_valid)
+	{
+		double		avg_generic_time;
+		double		avg_custom_time;
+
+		avg_generic_time = plansource->total_generic_time /
+			plansource->num_generic_runs;
+		avg_custom_time = plansource->total_custom_time /
+			plansource->num_custom_runs;
+
+		if (avg_generic_time <= avg_custom_time)
+			return false;
+
+		/*
+		 * Custom plans are winning, but the generic plan was measured with
+		 * other parameter values and other data.  Every so often, run it
+		 * again, with its earlier run times forgotten so that the new one
+		 * decides.  Since it doesn't need planning, one extra run of it costs
+		 * about as much as the custom plans gain on it per run.
+		 */
+		if ((plansource->generic_plan_count + plansource->custom_plan_count) %
+			GENERIC_PLAN_RECHECK_INTERVAL == 0)
+		{
+			plansource->total_generic_time = 0;
+			plansource->num_generic_runs = 0;
+			return false;
+		}
+
+		return true;
+	}
+
 	avg_custom_cost = plansource->total_custom_cost / plansource->num_custom_plans;
 
 	/*
@@ -1184,6 +1315,9 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 			}
 			/* Update generic_cost whenever we make a new generic plan */
 			plansource->generic_cost = cached_plan_cost(plan, false);
+			/* ... and forget how the previous one performed */
+			plansource->total_generic_time = 0;
+			plansource->num_generic_runs = 0;
 
 			/*
 			 * If, based on the now-known value of generic_cost, we'd not have
@@ -1207,15 +1341,26 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 
 	if (customplan)
 	{
-		/* Build a custom plan */
+		instr_time	starttime;
+		instr_time	duration;
+
+		/* Build a custom plan, keeping track of how long that takes */
+		INSTR_TIME_SET_CURRENT(starttime);
 		plan = BuildCachedPlan(plansource, qlist, boundParams, queryEnv);
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, starttime);
+		plan->is_custom = true;
+		plan->planning_time = INSTR_TIME_GET_MILLISEC(duration);
 		/* Accumulate total costs of custom plans, but 'ware overflow */
 		if (plansource->num_custom_plans < INT_MAX)
 		{
 			plansource->total_custom_cost += cached_plan_cost(plan, true);
 			plansource->num_custom_plans++;
 		}
+		plansource->custom_plan_count++;
 	}
+	else
+		plansource->generic_plan_count++;
 
 	Assert(plan != NULL);
 
@@ -1274,6 +1419,56 @@ ReleaseCachedPlan(CachedPlan *plan, bool useResOwner)
 	}
 }
 
+/*
+ * CachedPlanRecordExecution: note how long a run of a cached plan took.
+ *
+ * Callers that execute a plan obtained from GetCachedPlan to completion
+ * should report the elapsed time here, so that choose_custom_plan can
+ * compare how custom and generic plans actually perform.  "plan" must still
+ * be referenced by the caller.  If it didn't come from "plansource", or
+ * isn't its current generic plan or a custom plan, its run time is ignored;
+ * callers that look the source up again after running the plan needn't
+ * worry about it having been replaced in the meantime.
+ */
+void
+CachedPlanRecordExecution(CachedPlanSource *plansource, CachedPlan *plan,
+						  double msecs)
+{
+	Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
+	Assert(plan->magic == CACHEDPLAN_MAGIC);
+
+	/* One-shot plans are never reused, so there's nothing to decide */
+	if (plansource->is_oneshot)
+		return;
+
+	/* Ignore plans of another statement */
+	if (plan->source_id != plansource->source_id)
+		return;
+
+	/* Accumulate, but 'ware overflow */
+	if (plan->is_custom)
+	{
+		if (plansource->num_custom_runs < INT_MAX)
+		{
+			plansource->total_custom_time += plan->planning_time + msecs;
+			plansource->num_custom_runs++;
+		}
+	}
+	else if (plan == plansource->gplan)
+	{
+		if (plansource->num_generic_runs < INT_MAX)
+		{
+			plansource->total_generic_time += msecs;
+			plansource->num_generic_runs++;
+		}
+	}
+
+	/*
+	 * Otherwise it's a generic plan that has been replaced since the caller
+	 * got it; its run time says nothing about the current one.
+	 */
+}
+
 /*
  * CachedPlanSetParentContext: move a CachedPlanSource to a new memory context
  *
@@ -1388,12 +1583,20 @@ CopyCachedPlan(CachedPlanSource *plansource)
 	newsource->is_saved = false;
 	newsource->is_valid = plansource->is_valid;
 	newsource->generation = plansource->generation;
+	newsource->source_id = ++last_source_id;
 	newsource->next_saved = NULL;
 
 	/* We may as well copy any acquired cost knowledge */
 	newsource->generic_cost = plansource->generic_cost;
 	newsource->total_custom_cost = plansource->total_custom_cost;
 	newsource->num_custom_plans = plansource->num_custom_plans;
+	newsource->total_custom_time = plansource->total_custom_time;
+	newsource->num_custom_runs = plansource->num_custom_runs;
+	/* but measurements of the generic plan don't apply without it */
+	newsource->total_generic_time = 0;
+	newsource->num_generic_runs = 0;
+	newsource->generic_plan_count = 0;
+	newsource->custom_plan_count = 0;
 
 	MemoryContextSwitchTo(oldcxt);
 
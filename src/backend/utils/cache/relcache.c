@@ -174,6 +174,23 @@ static TupleDesc *EOXactTupleDescArray;
 static int	NextEOXactTupleDescNum = 0;
 static int	EOXactTupleDescArrayLen = 0;
 
+/*
+ * All relcache entries are also kept in a list in least-recently-used order,
+ * along with an estimate of the memory each one uses.  If that adds up to
+ * more than relation_cache_memory_target kilobytes at the end of a
+ * transaction, the least recently used entries that nobody holds open are
+ * discarded until it no longer does.  Zero means no limit.
+ */
+int			relation_cache_memory_target = 0;
+
+static dlist_head RelationCacheLRU = DLIST_STATIC_INIT(RelationCacheLRU);
+static Size RelationCacheSize = 0;
+
+/* statistics, see RelationCacheGetStats */
+static uint64 relcacheHits = 0;
+static uint64 relcacheMisses = 0;
+static uint64 relcacheEvictions = 0;
+
 /*
  *		macros to manipulate the lookup hashtable
  */
@@ -188,6 +205,8 @@ do { \
 		/* see comments in RelationBuildDesc and RelationBuildLocalRelation */ \
 		Relation _old_rel = hentry->reldesc; \
 		Assert(replace_allowed); \
+		dlist_delete(&_old_rel->rd_lru); \
+		RelationCacheSize -= _old_rel->rd_cachesize; \
 		hentry->reldesc = (RELATION); \
 		if (RelationHasReferenceCountZero(_old_rel)) \
 			RelationDestroyRelation(_old_rel, false); \
@@ -197,6 +216,9 @@ do { \
 	} \
 	else \
 		hentry->reldesc = (RELATION); \
+	(RELATION)->rd_cachesize = RelationEstimateCacheSize(RELATION); \
+	RelationCacheSize += (RELATION)->rd_cachesize; \
+	dlist_push_tail(&RelationCacheLRU, &(RELATION)->rd_lru); \
 } while(0)
 
 #define RelationIdCacheLookup(ID, RELATION) \
@@ -220,6 +242,11 @@ do { \
 	if (hentry == NULL) \
 		elog(WARNING, "failed to delete relcache entry for OID %u", \
 			 (RELATION)->rd_id); \
+	else \
+	{ \
+		dlist_delete(&(RELATION)->rd_lru); \
+		RelationCacheSize -= (RELATION)->rd_cachesize; \
+	} \
 } while(0)
 
 
@@ -246,6 +273,8 @@ static HTAB *OpClassCache = NULL;
 
 static void RelationDestroyRelation(Relation relation, bool remember_tupdesc);
 static void RelationClearRelation(Relation relation, bool rebuild);
+static Size RelationEstimateCacheSize(Relation relation);
+static void RelationCacheEvict(void);
 
 static void RelationReloadIndexInfo(Relation relation);
 static void RelationFlushRelation(Relation relation);
@@ -1204,7 +1233,9 @@ equalPartitionDescs(PartitionKey key, PartitionDesc partdesc1,
 			if (partdesc2->boundinfo == NULL)
 				return false;
 
-			if (!partition_bounds_equal(key, partdesc1->boundinfo,
+			if (!partition_bounds_equal(key->partnatts, key->parttyplen,
+										key->parttypbyval,
+										partdesc1->boundinfo,
 										partdesc2->boundinfo))
 				return false;
 		}
@@ -2078,6 +2109,9 @@ RelationIdGetRelation(Oid relationId)
 
 	if (RelationIsValid(rd))
 	{
+		relcacheHits++;
+		dlist_move_tail(&RelationCacheLRU, &rd->rd_lru);
+
 		RelationIncrementReferenceCount(rd);
 		/* revalidate cache entry if necessary */
 		if (!rd->rd_isvalid)
@@ -2100,6 +2134,7 @@ RelationIdGetRelation(Oid relationId)
 	 * no reldesc in the cache, so have RelationBuildDesc() build one and add
 	 * it.
 	 */
+	relcacheMisses++;
 	rd = RelationBuildDesc(relationId, true);
 	if (RelationIsValid(rd))
 		RelationIncrementReferenceCount(rd);
@@ -2591,6 +2626,8 @@ RelationClearRelation(Relation relation, bool rebuild)
 		SWAPFIELD(SMgrRelation, rd_smgr);
 		/* rd_refcnt must be preserved */
 		SWAPFIELD(int, rd_refcnt);
+		/* the LRU list links to the old struct */
+		SWAPFIELD(dlist_node, rd_lru);
 		/* isnailed shouldn't change */
 		Assert(newrel->rd_isnailed == relation->rd_isnailed);
 		/* creation sub-XIDs must be preserved */
@@ -2629,6 +2666,10 @@ RelationClearRelation(Relation relation, bool rebuild)
 
 #undef SWAPFIELD
 
+		/* newrel now carries the old size estimate; account for the new one */
+		relation->rd_cachesize = RelationEstimateCacheSize(relation);
+		RelationCacheSize += relation->rd_cachesize - newrel->rd_cachesize;
+
 		/* And now we can throw away the temporary entry */
 		RelationDestroyRelation(newrel, !keep_tupdesc);
 	}
@@ -2965,6 +3006,99 @@ AtEOXact_RelationCache(bool isCommit)
 	eoxact_list_overflowed = false;
 	NextEOXactTupleDescNum = 0;
 	EOXactTupleDescArrayLen = 0;
+
+	/* Finally, trim the cache if it has grown past its target */
+	if (relation_cache_memory_target > 0 &&
+		RelationCacheSize > (Size) relation_cache_memory_target * 1024L &&
+		!IsBootstrapProcessingMode())
+		RelationCacheEvict();
+}
+
+/*
+ * RelationCacheEvict
+ *
+ *	Discard least recently used relcache entries until the cache fits within
+ *	relation_cache_memory_target again.  Entries that are nailed or still
+ *	referenced can't be discarded and are skipped over.
+ *
+ *	This is only called at main-transaction end, when the only references
+ *	left are those of nailed entries and leaked ones, so that nobody can be
+ *	holding a pointer to an entry we free.
+ */
+static void
+RelationCacheEvict(void)
+{
+	Size		target = (Size) relation_cache_memory_target * 1024L;
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &RelationCacheLRU)
+	{
+		Relation	relation = dlist_container(RelationData, rd_lru, iter.cur);
+
+		if (RelationCacheSize <= target)
+			break;
+
+		if (relation->rd_isnailed ||
+			!RelationHasReferenceCountZero(relation) ||
+			relation->rd_createSubid != InvalidSubTransactionId ||
+			relation->rd_newRelfilenodeSubid != InvalidSubTransactionId)
+			continue;
+
+		relcacheEvictions++;
+		RelationClearRelation(relation, false);
+	}
+}
+
+/*
+ * RelationEstimateCacheSize
+ *
+ *	Estimate the memory used by a relcache entry: the RelationData and
+ *	pg_class tuple, the tuple descriptor, and the private memory contexts
+ *	holding index, rule and partitioning information.  Smaller allocations
+ *	made directly in CacheMemoryContext (trigger descriptors, index lists and
+ *	the like) are not counted.
+ */
+static Size
+RelationEstimateCacheSize(Relation relation)
+{
+	MemoryContext contexts[4];
+	MemoryContextCounters counters;
+	Size		size;
+	int			i;
+
+	size = sizeof(RelationData) + CLASS_TUPLE_SIZE;
+	if (relation->rd_att)
+		size += sizeof(struct tupleDesc) +
+			relation->rd_att->natts *
+			(sizeof(Form_pg_attribute) + ATTRIBUTE_FIXED_PART_SIZE);
+
+	contexts[0] = relation->rd_indexcxt;
+	contexts[1] = relation->rd_rulescxt;
+	contexts[2] = relation->rd_partkeycxt;
+	contexts[3] = relation->rd_pdcxt;
+	memset(&counters, 0, sizeof(counters));
+	for (i = 0; i < lengthof(contexts); i++)
+	{
+		if (contexts[i] != NULL)
+			contexts[i]->methods->stats(contexts[i], 0, false, &counters);
+	}
+
+	return size + counters.totalspace;
+}
+
+/*
+ * RelationCacheGetStats
+ *
+ *	Report the size and hit statistics of the relcache.
+ */
+void
+RelationCacheGetStats(RelationCacheStats *stats)
+{
+	stats->entries = RelationIdCache ? hash_get_num_entries(RelationIdCache) : 0;
+	stats->size = (int64) RelationCacheSize;
+	stats->hits = (int64) relcacheHits;
+	stats->misses = (int64) relcacheMisses;
+	stats->evictions = (int64) relcacheEvictions;
 }
 
 /*
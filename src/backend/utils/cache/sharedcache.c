@@ -0,0 +1,389 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcache.c
+ *	  Infrastructure for caches shared between backends.
+ *
+ * The shared plan cache (sharedplancache.c) and the shared catalog cache
+ * (sharedcatcache.c) keep objects in shared memory that are only valid until
+ * some catalog change invalidates them.  What they have in common lives
+ * here: setting up a DSA area with a dshash table in the main shared memory
+ * segment, invalidation by sequence numbers, and eviction.
+ *
+ * Invalidation piggybacks on the shared-invalidation machinery.  Whichever
+ * process sends an invalidation message that concerns a cache stamps a slot
+ * of it, chosen by hashing whatever the message is about, with a new
+ * sequence number, after the message has been queued; or it stamps the
+ * whole cache, for messages that invalidate everything.  An object records
+ * the sequence number as of when the catalog reads it was made from
+ * started, and the slots of everything it depends on; it is valid as long
+ * as none of those slots (nor the whole cache) has been stamped since.  A
+ * backend about to read the catalogs gets the sequence number before
+ * accepting pending invalidations, so any change stamped before that has
+ * had its messages processed, and the object can't reflect catalog state
+ * older than its sequence number claims.  Collisions between slots only
+ * cause unnecessary invalidations.
+ *
+ * The DSA area lives right after the cache's control struct in the main
+ * shared memory segment and never grows beyond it, so the memory used is
+ * fixed at startup and no DSM segments are needed.  It has room for the
+ * cache's budget plus half again, for the hash table and for fragmentation,
+ * plus a fixed reserve for the superblocks DSA sets aside for each size
+ * class of object in use, which a small cache would otherwise run out of
+ * long before reaching its budget.  When the objects stored would exceed
+ * the budget, or the number of entries the cap derived from it, a clock
+ * sweep evicts the ones not used recently, along with any that have been
+ * invalidated.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "storage/ipc.h"
+#include "storage/shmem.h"
+#include "utils/memutils.h"
+#include "utils/sharedcache.h"
+
+
+/* Saturation point of an entry's usage count */
+#define SHARED_CACHE_MAX_USAGE		16
+
+/* Room for a 64kB DSA superblock for each size class, and then some */
+#define SHARED_CACHE_AREA_RESERVE	((Size) 64 * 64 * 1024)
+
+/*
+ * Shared control struct of a cache.  The DSA area follows it directly.
+ */
+typedef struct SharedCacheControl
+{
+	dshash_table_handle hash_handle;
+
+	/* Space accounting, for eviction */
+	pg_atomic_uint64 used_bytes;	/* size of all cached objects */
+	pg_atomic_uint32 num_entries;
+	pg_atomic_flag evicting;	/* is somebody running the clock sweep? */
+
+	/* Invalidation sequence numbers, see file header */
+	pg_atomic_uint64 inval_seq; /* last number handed out */
+	pg_atomic_uint64 reset_seq; /* stamp of last invalidation of everything */
+	pg_atomic_uint64 slot_seq[FLEXIBLE_ARRAY_MEMBER];
+} SharedCacheControl;
+
+#define SharedCacheControlSize(cache) \
+	MAXALIGN(offsetof(SharedCacheControl, slot_seq) + \
+			 (cache)->num_slots * sizeof(pg_atomic_uint64))
+#define SharedCacheAreaSize(cache) \
+	(SharedCacheBudget(cache) + SharedCacheBudget(cache) / 2 + \
+	 SHARED_CACHE_AREA_RESERVE)
+#define SharedCacheMaxEntries(cache) \
+	(SharedCacheBudget(cache) / (cache)->entry_bytes)
+#define SharedCacheDSAPlace(cache) \
+	((void *) ((char *) (cache)->ctl + SharedCacheControlSize(cache)))
+
+#define SharedCacheEntryItem(cache, entry) \
+	((SharedCacheItem *) ((char *) (entry) + (cache)->item_offset))
+
+static void shared_cache_detach(int code, Datum arg);
+static void shared_cache_evict(SharedCache *cache);
+
+
+/*
+ * SharedCacheShmemSize
+ *		Compute space needed for a shared cache
+ */
+Size
+SharedCacheShmemSize(SharedCache *cache)
+{
+	if (*cache->size_kb == 0)
+		return 0;
+
+	return add_size(SharedCacheControlSize(cache),
+					SharedCacheAreaSize(cache));
+}
+
+/*
+ * SharedCacheShmemInit
+ *		Create a shared cache, or attach to it
+ */
+void
+SharedCacheShmemInit(SharedCache *cache)
+{
+	bool		found;
+	int			i;
+
+	if (*cache->size_kb == 0)
+		return;
+
+	cache->ctl = (SharedCacheControl *)
+		ShmemInitStruct(cache->name, SharedCacheShmemSize(cache), &found);
+
+	if (!found)
+	{
+		SharedCacheControl *ctl = cache->ctl;
+		dsa_area   *area;
+		dshash_table *hash;
+
+		pg_atomic_init_u64(&ctl->used_bytes, 0);
+		pg_atomic_init_u32(&ctl->num_entries, 0);
+		pg_atomic_init_flag(&ctl->evicting);
+		pg_atomic_init_u64(&ctl->inval_seq, 0);
+		pg_atomic_init_u64(&ctl->reset_seq, 0);
+		for (i = 0; i < cache->num_slots; i++)
+			pg_atomic_init_u64(&ctl->slot_seq[i], 0);
+
+		area = dsa_create_in_place(SharedCacheDSAPlace(cache),
+								   SharedCacheAreaSize(cache),
+								   cache->dsa_tranche, NULL);
+		dsa_pin(area);
+		dsa_set_size_limit(area, SharedCacheAreaSize(cache));
+
+		hash = dshash_create(area, &cache->hash_params, NULL);
+		ctl->hash_handle = dshash_get_hash_table_handle(hash);
+
+		dshash_detach(hash);
+		dsa_detach(area);
+	}
+}
+
+/*
+ * SharedCacheAttach
+ *		Map a cache's DSA area and hash table, if not done already
+ */
+void
+SharedCacheAttach(SharedCache *cache)
+{
+	MemoryContext oldcontext;
+
+	if (cache->area != NULL)
+		return;
+
+	Assert(cache->ctl != NULL);
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	cache->area = dsa_attach_in_place(SharedCacheDSAPlace(cache), NULL);
+	dsa_pin_mapping(cache->area);
+	cache->hash = dshash_attach(cache->area, &cache->hash_params,
+								cache->ctl->hash_handle, NULL);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	on_shmem_exit(shared_cache_detach, PointerGetDatum(cache));
+}
+
+/*
+ * shared_cache_detach
+ *		Release our mapping of a cache at process exit
+ *
+ * Since no DSM segment was given to dsa_attach_in_place(), we must drop our
+ * reference by hand.
+ */
+static void
+shared_cache_detach(int code, Datum arg)
+{
+	SharedCache *cache = (SharedCache *) DatumGetPointer(arg);
+
+	if (cache->area == NULL)
+		return;
+
+	dshash_detach(cache->hash);
+	dsa_detach(cache->area);
+	dsa_release_in_place(SharedCacheDSAPlace(cache));
+
+	cache->hash = NULL;
+	cache->area = NULL;
+}
+
+/*
+ * SharedCacheStamp
+ *		Record an invalidation of a slot, or of everything
+ *
+ * This only uses the control struct, since it's called by whatever process
+ * sends invalidation messages, which may not be able to attach to the DSA
+ * area.
+ */
+void
+SharedCacheStamp(SharedCache *cache, uint32 slot, bool all)
+{
+	SharedCacheControl *ctl = cache->ctl;
+	pg_atomic_uint64 *ptr;
+	uint64		seq;
+	uint64		old;
+
+	Assert(all || slot < cache->num_slots);
+
+	seq = pg_atomic_add_fetch_u64(&ctl->inval_seq, 1);
+
+	ptr = all ? &ctl->reset_seq : &ctl->slot_seq[slot];
+
+	/* Concurrent stamps may arrive out of order; never move backwards */
+	old = pg_atomic_read_u64(ptr);
+	while (old < seq)
+	{
+		if (pg_atomic_compare_exchange_u64(ptr, &old, seq))
+			break;
+	}
+}
+
+/*
+ * SharedCacheCurrentSeq
+ *		Get the sequence number for an object about to be made
+ *
+ * The caller must then accept pending invalidations before reading the
+ * catalogs, see file header.
+ */
+uint64
+SharedCacheCurrentSeq(SharedCache *cache)
+{
+	return pg_atomic_read_u64(&cache->ctl->inval_seq);
+}
+
+/*
+ * SharedCacheValid
+ *		Have none of the slots been invalidated since the sequence number?
+ */
+bool
+SharedCacheValid(SharedCache *cache, uint64 seq, const uint32 *slots,
+				 int num_slots)
+{
+	SharedCacheControl *ctl = cache->ctl;
+	int			i;
+
+	if (pg_atomic_read_u64(&ctl->reset_seq) > seq)
+		return false;
+
+	for (i = 0; i < num_slots; i++)
+	{
+		if (pg_atomic_read_u64(&ctl->slot_seq[slots[i]]) > seq)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * SharedCacheAllocate
+ *		Allocate space for a new object, evicting others if need be
+ *
+ * Returns InvalidDsaPointer if there's no room.  The caller must have
+ * attached to the cache.
+ */
+dsa_pointer
+SharedCacheAllocate(SharedCache *cache, Size size)
+{
+	SharedCacheControl *ctl = cache->ctl;
+
+	Assert(cache->area != NULL);
+
+	if (pg_atomic_read_u64(&ctl->used_bytes) + size >
+		SharedCacheBudget(cache) ||
+		pg_atomic_read_u32(&ctl->num_entries) >=
+		SharedCacheMaxEntries(cache))
+		shared_cache_evict(cache);
+
+	return dsa_allocate_extended(cache->area, size, DSA_ALLOC_NO_OOM);
+}
+
+/*
+ * SharedCacheInstall
+ *		Put an object allocated by SharedCacheAllocate in a hash table entry
+ *
+ * "entry" and "found" are what dshash_find_or_insert returned; an object
+ * already there is freed.  The caller still holds the entry's lock.
+ */
+void
+SharedCacheInstall(SharedCache *cache, void *entry, bool found,
+				   dsa_pointer dp, Size size)
+{
+	SharedCacheControl *ctl = cache->ctl;
+	SharedCacheItem *item = SharedCacheEntryItem(cache, entry);
+
+	if (found)
+	{
+		pg_atomic_sub_fetch_u64(&ctl->used_bytes, item->size);
+		dsa_free(cache->area, item->data);
+	}
+	else
+	{
+		pg_atomic_fetch_add_u32(&ctl->num_entries, 1);
+		pg_atomic_init_u32(&item->usage, 0);
+	}
+	item->data = dp;
+	item->size = size;
+	pg_atomic_write_u32(&item->usage, 1);
+	pg_atomic_fetch_add_u64(&ctl->used_bytes, size);
+}
+
+/*
+ * SharedCacheUsed
+ *		Note that the object in a hash table entry has been used
+ */
+void
+SharedCacheUsed(SharedCache *cache, void *entry)
+{
+	SharedCacheItem *item = SharedCacheEntryItem(cache, entry);
+	uint32		usage;
+
+	usage = pg_atomic_read_u32(&item->usage);
+	if (usage < SHARED_CACHE_MAX_USAGE)
+		pg_atomic_fetch_add_u32(&item->usage, 1);
+}
+
+/*
+ * shared_cache_evict
+ *		Free up space by evicting objects, clock-sweep style
+ *
+ * Each pass removes the invalid objects and those that haven't been used
+ * since the previous pass, and halves the usage count of the rest.  We stop
+ * once we're back under three quarters of the budget and entry limit.  If
+ * another backend is already at it, we don't wait; at worst, the new object
+ * won't fit.
+ */
+static void
+shared_cache_evict(SharedCache *cache)
+{
+	SharedCacheControl *ctl = cache->ctl;
+	int			pass;
+
+	if (!pg_atomic_test_set_flag(&ctl->evicting))
+		return;
+
+	for (pass = 0; pass < 5; pass++)
+	{
+		dshash_seq_status status;
+		void	   *entry;
+
+		if (pg_atomic_read_u64(&ctl->used_bytes) <=
+			SharedCacheBudget(cache) / 4 * 3 &&
+			pg_atomic_read_u32(&ctl->num_entries) <=
+			SharedCacheMaxEntries(cache) / 4 * 3)
+			break;
+
+		dshash_seq_init(&status, cache->hash, true);
+		while ((entry = dshash_seq_next(&status)) != NULL)
+		{
+			SharedCacheItem *item = SharedCacheEntryItem(cache, entry);
+			uint32		usage = pg_atomic_read_u32(&item->usage);
+
+			if (usage == 0 ||
+				!cache->entry_valid(cache, entry,
+									dsa_get_address(cache->area, item->data)))
+			{
+				pg_atomic_sub_fetch_u64(&ctl->used_bytes, item->size);
+				pg_atomic_sub_fetch_u32(&ctl->num_entries, 1);
+				dsa_free(cache->area, item->data);
+				dshash_delete_current(&status);
+			}
+			else
+				pg_atomic_write_u32(&item->usage, usage / 2);
+		}
+		dshash_seq_term(&status);
+	}
+
+	pg_atomic_clear_flag(&ctl->evicting);
+}
@@ -0,0 +1,361 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcatcache.c
+ *	  Cross-backend cache of system catalog tuples.
+ *
+ * Each backend fills its catalog caches (catcache.c) by reading the system
+ * catalogs itself, so every new connection pays for the same index scans
+ * before it gets going, and on schemas with many objects that warm-up is a
+ * noticeable part of short sessions.  When shared_catalog_cache_size is
+ * set, SearchCatCache looks for a missing tuple here before scanning the
+ * catalog, and offers what it finds in the catalog to other backends.
+ * Negative entries, recording that no tuple matches a key, are shared too.
+ *
+ * Entries are keyed by cache ID, database (InvalidOid for shared catalogs)
+ * and the hash value of the search keys, and hold a copy of the tuple,
+ * whose keys are compared on lookup in case of hash collisions.
+ *
+ * Invalidation works as described in sharedcache.c: a catcache invalidation
+ * message stamps a slot chosen by hashing the cache ID and hash value, and
+ * a whole-catalog invalidation stamps the whole cache.  An entry records the
+ * sequence number as of when the catalog scan that produced it started, and
+ * is valid as long as its slot has not been stamped since.
+ *
+ * A transaction that has modified the catalogs sees its own uncommitted
+ * changes, so it neither consults nor fills the cache.  Neither do
+ * processes looking at the catalogs through a historic snapshot (logical
+ * decoding).  Each backend still keeps its own copy of the entries it uses
+ * in its catcache; what is saved is reading them from the catalogs.
+ *
+ * The cache's memory and eviction are also looked after by sharedcache.c.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedcatcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "miscadmin.h"
+#include "storage/lwlock.h"
+#include "utils/inval.h"
+#include "utils/sharedcache.h"
+#include "utils/sharedcatcache.h"
+#include "utils/snapmgr.h"
+
+
+/* GUC parameter: budget for stored tuples, in kB; 0 disables the cache */
+int			shared_catalog_cache_size = 0;
+
+/* Number of invalidation slots */
+#define SHARED_CAT_INVAL_SLOTS		4096
+
+typedef struct SharedCatKey
+{
+	Oid			dbid;			/* InvalidOid for shared catalogs */
+	int			cacheid;
+	uint32		hashvalue;
+} SharedCatKey;
+
+typedef struct SharedCatEntry
+{
+	SharedCatKey key;			/* hash key (must be first) */
+	SharedCacheItem item;		/* the SharedCatData */
+} SharedCatEntry;
+
+/*
+ * A stored tuple.  The struct is followed by the tuple's t_data.
+ */
+typedef struct SharedCatData
+{
+	uint64		search_seq;		/* inval_seq when the catalog scan started */
+	bool		negative;		/* tuple is a dummy holding just the keys */
+	ItemPointerData t_self;
+	Oid			t_tableOid;
+	uint32		t_len;
+} SharedCatData;
+
+#define SharedCatTupleData(data) \
+	((HeapTupleHeader) ((char *) (data) + MAXALIGN(sizeof(SharedCatData))))
+
+static bool shared_cat_entry_valid(SharedCache *cache, void *entry,
+					   void *data);
+
+/*
+ * Catalog tuples are small, so the number of entries is capped more
+ * generously than in the shared plan cache.
+ */
+static SharedCache sharedCatCache = {
+	"Shared Catalog Cache",
+	&shared_catalog_cache_size,
+	256,
+	SHARED_CAT_INVAL_SLOTS,
+	LWTRANCHE_SHARED_CATCACHE_DSA,
+	{
+		sizeof(SharedCatKey),
+		sizeof(SharedCatEntry),
+		dshash_memcmp,
+		dshash_memhash,
+		LWTRANCHE_SHARED_CATCACHE_HASH
+	},
+	offsetof(SharedCatEntry, item),
+	shared_cat_entry_valid
+};
+
+static void shared_cat_make_key(int cacheid, Oid dbid, uint32 hashvalue,
+					SharedCatKey *key);
+
+
+/*
+ * Invalidation slot of a catcache entry.
+ */
+static inline uint32
+shared_cat_slot(int cacheid, uint32 hashvalue)
+{
+	return DatumGetUInt32(hash_uint32(hashvalue ^ ((uint32) cacheid << 24))) %
+		SHARED_CAT_INVAL_SLOTS;
+}
+
+/*
+ * Has the slot not been invalidated since the search started?
+ */
+static inline bool
+shared_cat_valid(uint64 search_seq, uint32 slot)
+{
+	return SharedCacheValid(&sharedCatCache, search_seq, &slot, 1);
+}
+
+
+/*
+ * SharedCatCacheShmemSize
+ *		Compute space needed for the shared catalog cache
+ */
+Size
+SharedCatCacheShmemSize(void)
+{
+	return SharedCacheShmemSize(&sharedCatCache);
+}
+
+/*
+ * SharedCatCacheShmemInit
+ *		Create the shared catalog cache, or attach to it
+ */
+void
+SharedCatCacheShmemInit(void)
+{
+	SharedCacheShmemInit(&sharedCatCache);
+}
+
+/*
+ * SharedCatCacheInvalidate
+ *		Take note of shared invalidation messages that are being sent
+ *
+ * Called by SendSharedInvalidMessages() after queueing the messages, in
+ * whichever process sends them.
+ */
+void
+SharedCatCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	int			i;
+
+	if (sharedCatCache.ctl == NULL)
+		return;
+
+	for (i = 0; i < n; i++)
+	{
+		const SharedInvalidationMessage *msg = &msgs[i];
+
+		if (msg->id >= 0)
+			SharedCacheStamp(&sharedCatCache,
+							 shared_cat_slot(msg->cc.id, msg->cc.hashValue),
+							 false);
+		else if (msg->id == SHAREDINVALCATALOG_ID)
+		{
+			/* a whole catalog's caches are flushed; don't bother sorting */
+			SharedCacheStamp(&sharedCatCache, 0, true);
+			break;
+		}
+	}
+}
+
+/*
+ * shared_cat_entry_valid
+ *		Is a stored tuple still valid?  Used by the clock sweep.
+ */
+static bool
+shared_cat_entry_valid(SharedCache *cache, void *entry, void *data)
+{
+	SharedCatKey *key = &((SharedCatEntry *) entry)->key;
+
+	return shared_cat_valid(((SharedCatData *) data)->search_seq,
+							shared_cat_slot(key->cacheid, key->hashvalue));
+}
+
+static void
+shared_cat_make_key(int cacheid, Oid dbid, uint32 hashvalue,
+					SharedCatKey *key)
+{
+	memset(key, 0, sizeof(SharedCatKey));
+	key->dbid = dbid;
+	key->cacheid = cacheid;
+	key->hashvalue = hashvalue;
+}
+
+/*
+ * SharedCatCacheUsable
+ *		May the current transaction use the shared catalog cache?
+ */
+bool
+SharedCatCacheUsable(void)
+{
+	if (sharedCatCache.ctl == NULL)
+		return false;
+
+	return !IsBootstrapProcessingMode() &&
+		!HistoricSnapshotActive() &&
+		!TransactionHasInvalidations();
+}
+
+/*
+ * SharedCatCacheFetch
+ *		Look for a tuple in the shared catalog cache
+ *
+ * Returns a palloc'd copy of the tuple, or NULL if there is no valid entry.
+ * The caller must check that the tuple's keys match what it's looking for,
+ * in case of a hash collision.  *negative is set to say whether this is a
+ * negative entry.
+ */
+HeapTuple
+SharedCatCacheFetch(int cacheid, Oid dbid, uint32 hashvalue, bool *negative)
+{
+	SharedCatKey key;
+	SharedCatEntry *entry;
+	SharedCatData *data;
+	HeapTuple	tuple;
+
+	Assert(SharedCatCacheUsable());
+
+	SharedCacheAttach(&sharedCatCache);
+	shared_cat_make_key(cacheid, dbid, hashvalue, &key);
+
+	entry = dshash_find(sharedCatCache.hash, &key, false);
+	if (entry == NULL)
+		return NULL;
+
+	data = dsa_get_address(sharedCatCache.area, entry->item.data);
+	if (!shared_cat_valid(data->search_seq, shared_cat_slot(cacheid,
+															hashvalue)))
+	{
+		dshash_release_lock(sharedCatCache.hash, entry);
+		return NULL;
+	}
+
+	tuple = (HeapTuple) palloc(HEAPTUPLESIZE + data->t_len);
+	tuple->t_len = data->t_len;
+	tuple->t_self = data->t_self;
+	tuple->t_tableOid = data->t_tableOid;
+	tuple->t_data = (HeapTupleHeader) ((char *) tuple + HEAPTUPLESIZE);
+	memcpy(tuple->t_data, SharedCatTupleData(data), data->t_len);
+	*negative = data->negative;
+
+	SharedCacheUsed(&sharedCatCache, entry);
+
+	dshash_release_lock(sharedCatCache.hash, entry);
+
+	return tuple;
+}
+
+/*
+ * SharedCatCacheStartSearch
+ *		Get ready to read a tuple from the catalogs that may be stored here
+ *
+ * Returns the sequence number to pass to SharedCatCacheStore.  We take it
+ * before accepting pending invalidations, so that the catalog scan can't see
+ * catalog state older than the sequence number implies.
+ */
+uint64
+SharedCatCacheStartSearch(void)
+{
+	uint64		seq;
+
+	seq = SharedCacheCurrentSeq(&sharedCatCache);
+	AcceptInvalidationMessages();
+
+	return seq;
+}
+
+/*
+ * SharedCatCacheStore
+ *		Offer a tuple just read from the catalogs to other backends
+ *
+ * For a negative entry, the tuple is the dummy built by catcache.c.
+ * search_seq is what SharedCatCacheStartSearch returned before the scan.
+ */
+void
+SharedCatCacheStore(int cacheid, Oid dbid, uint32 hashvalue,
+					HeapTuple tuple, bool negative, uint64 search_seq)
+{
+	uint32		slot = shared_cat_slot(cacheid, hashvalue);
+	SharedCatKey key;
+	SharedCatEntry *entry;
+	SharedCatData *data;
+	dsa_pointer dp;
+	bool		found;
+	Size		size;
+
+	/*
+	 * Don't bother if it's been invalidated already.  Since the scan might
+	 * have processed invalidations sent by our own transaction meanwhile,
+	 * check that too.
+	 */
+	if (!shared_cat_valid(search_seq, slot) || !SharedCatCacheUsable())
+		return;
+
+	size = MAXALIGN(sizeof(SharedCatData)) + tuple->t_len;
+
+	/* Tuples too big for a decent share of the cache aren't worth it */
+	if (size > SharedCacheBudget(&sharedCatCache) / 64)
+		return;
+
+	SharedCacheAttach(&sharedCatCache);
+
+	dp = SharedCacheAllocate(&sharedCatCache, size);
+	if (!DsaPointerIsValid(dp))
+		return;
+
+	data = dsa_get_address(sharedCatCache.area, dp);
+	data->search_seq = search_seq;
+	data->negative = negative;
+	data->t_self = tuple->t_self;
+	data->t_tableOid = tuple->t_tableOid;
+	data->t_len = tuple->t_len;
+	memcpy(SharedCatTupleData(data), tuple->t_data, tuple->t_len);
+
+	shared_cat_make_key(cacheid, dbid, hashvalue, &key);
+	entry = dshash_find_or_insert(sharedCatCache.hash, &key, &found);
+	if (found)
+	{
+		SharedCatData *old = dsa_get_address(sharedCatCache.area,
+											 entry->item.data);
+
+		/*
+		 * Keep a valid entry that somebody else stored from a later scan
+		 * than ours; otherwise replace it, whether it's stale or for keys
+		 * that collide with ours.
+		 */
+		if (old->search_seq >= search_seq &&
+			shared_cat_valid(old->search_seq, slot))
+		{
+			dshash_release_lock(sharedCatCache.hash, entry);
+			dsa_free(sharedCatCache.area, dp);
+			return;
+		}
+	}
+	SharedCacheInstall(&sharedCatCache, entry, found, dp, size);
+	dshash_release_lock(sharedCatCache.hash, entry);
+}
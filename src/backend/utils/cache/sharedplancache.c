@@ -0,0 +1,622 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.c
+ *	  Cross-backend cache of generic plans for prepared statements.
+ *
+ * Every backend plans the statements it prepares for itself, so when many
+ * backends run the same statements (as is typical of applications that use
+ * an ORM and a connection pool), each of them pays for planning the same
+ * generic plans.  When shared_plan_cache_size is set, BuildCachedPlan puts
+ * the generic plans it makes into a cache in shared memory, and looks there
+ * before planning a generic plan itself.
+ *
+ * A plan can be reused by another backend if it was made for the same query
+ * text, parameter types and cursor options, in the same database, for the
+ * same role, with the same search_path, and with the same values of the
+ * settings that influence planning (see GetPlannerSettingsHash).  The cache
+ * is keyed by hashes of those; the query text, parameter types and search
+ * path are stored with the plan and compared, while a collision of the
+ * settings hash would merely yield a plan made under different settings.
+ *
+ * Plan trees are full of pointers, so they can't be used directly from
+ * shared memory: we store them in nodeToString() form and rebuild them with
+ * stringToNode(), which is still much cheaper than planning.  Plans that
+ * involve anything backend-local are never shared: utility statements,
+ * temporary tables or a temporary namespace, row-level security, plans that
+ * depend on a transaction's snapshot, and plans of statements whose
+ * parameters are resolved by a parser hook (as PL/pgSQL's are), since their
+ * meaning isn't determined by their text.
+ *
+ * Invalidation works as described in sharedcache.c.  The invalidation
+ * messages that would invalidate a cached plan in plancache.c stamp a slot
+ * chosen by hashing the relation OID or catcache hash value, for relcache
+ * and pg_proc catcache messages, or the whole cache, for the catalog changes
+ * that reset all plans.  A shared plan remembers the sequence number as of
+ * when its planning started, and the slots of everything it depends on.
+ *
+ * The cache lives in a DSA area placed in the main shared memory segment,
+ * whose size is fixed at startup.  When the plans stored exceed the budget
+ * set by shared_plan_cache_size, sharedcache.c's clock sweep evicts the ones
+ * not used recently, along with any that have been invalidated.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedplancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_class.h"
+#include "miscadmin.h"
+#include "nodes/plannodes.h"
+#include "storage/lwlock.h"
+#include "utils/guc.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
+#include "utils/sharedcache.h"
+#include "utils/sharedplancache.h"
+#include "utils/syscache.h"
+
+
+/* GUC parameter: budget for stored plans, in kB; 0 disables the cache */
+int			shared_plan_cache_size = 0;
+
+/* Number of invalidation slots */
+#define SHARED_PLAN_INVAL_SLOTS		1024
+
+typedef struct SharedPlanKey
+{
+	Oid			dbid;
+	Oid			userid;
+	uint32		query_hash;		/* query text, parameter types, options */
+	uint32		context_hash;	/* search_path and planner settings */
+} SharedPlanKey;
+
+typedef struct SharedPlanEntry
+{
+	SharedPlanKey key;			/* hash key (must be first) */
+	SharedCacheItem item;		/* the SharedPlanData */
+} SharedPlanEntry;
+
+/*
+ * A stored plan, and what we need to make sure it's the right one and still
+ * valid.  The struct is followed by the variable-length parts, in order:
+ * the parameter types, the search path schemas, the invalidation slots of
+ * everything the plan depends on, and the query and plan strings.
+ */
+typedef struct SharedPlanData
+{
+	uint64		plan_seq;		/* inval_seq when planning started */
+	int			cursor_options;
+	bool		path_add_catalog;	/* search path's addCatalog */
+	int			num_params;
+	int			num_schemas;
+	int			num_slots;
+	int			query_len;		/* not counting the terminating zero */
+	int			plan_len;		/* likewise */
+} SharedPlanData;
+
+#define SharedPlanParamTypes(data) \
+	((Oid *) ((char *) (data) + MAXALIGN(sizeof(SharedPlanData))))
+#define SharedPlanSchemas(data) \
+	(SharedPlanParamTypes(data) + (data)->num_params)
+#define SharedPlanSlots(data) \
+	((uint32 *) (SharedPlanSchemas(data) + (data)->num_schemas))
+#define SharedPlanQuery(data) \
+	((char *) (SharedPlanSlots(data) + (data)->num_slots))
+#define SharedPlanString(data) \
+	(SharedPlanQuery(data) + (data)->query_len + 1)
+
+/* What SharedPlanCacheRecheck needs to know about a fetched plan */
+struct SharedPlanCheck
+{
+	uint64		plan_seq;
+	int			num_slots;
+	uint32		slots[FLEXIBLE_ARRAY_MEMBER];
+};
+
+static bool shared_plan_entry_valid(SharedCache *cache, void *entry,
+						void *data);
+
+/*
+ * The number of entries is capped so that the hash table stays well within
+ * the room the DSA area has for it.
+ */
+static SharedCache sharedPlanCache = {
+	"Shared Plan Cache",
+	&shared_plan_cache_size,
+	1024,
+	SHARED_PLAN_INVAL_SLOTS,
+	LWTRANCHE_SHARED_PLAN_DSA,
+	{
+		sizeof(SharedPlanKey),
+		sizeof(SharedPlanEntry),
+		dshash_memcmp,
+		dshash_memhash,
+		LWTRANCHE_SHARED_PLAN_HASH
+	},
+	offsetof(SharedPlanEntry, item),
+	shared_plan_entry_valid
+};
+
+static void shared_plan_make_key(CachedPlanSource *plansource,
+					 SharedPlanKey *key);
+static bool shared_plan_matches(SharedPlanData *data,
+					CachedPlanSource *plansource);
+static int	uint32_cmp(const void *a, const void *b);
+
+
+/*
+ * Invalidation slot of a relation, or of a catcache entry.
+ */
+static inline uint32
+shared_plan_rel_slot(Oid relid)
+{
+	return DatumGetUInt32(hash_uint32((uint32) relid)) %
+		SHARED_PLAN_INVAL_SLOTS;
+}
+
+static inline uint32
+shared_plan_item_slot(int cacheid, uint32 hashvalue)
+{
+	return DatumGetUInt32(hash_uint32(hashvalue ^ ((uint32) cacheid << 24))) %
+		SHARED_PLAN_INVAL_SLOTS;
+}
+
+/*
+ * Has nothing the plan depends on been invalidated since it was made?
+ */
+static inline bool
+shared_plan_valid(uint64 plan_seq, uint32 *slots, int num_slots)
+{
+	return SharedCacheValid(&sharedPlanCache, plan_seq, slots, num_slots);
+}
+
+
+/*
+ * SharedPlanCacheShmemSize
+ *		Compute space needed for the shared plan cache
+ */
+Size
+SharedPlanCacheShmemSize(void)
+{
+	return SharedCacheShmemSize(&sharedPlanCache);
+}
+
+/*
+ * SharedPlanCacheShmemInit
+ *		Create the shared plan cache, or attach to it
+ */
+void
+SharedPlanCacheShmemInit(void)
+{
+	SharedCacheShmemInit(&sharedPlanCache);
+}
+
+/*
+ * SharedPlanCacheInvalidate
+ *		Take note of shared invalidation messages that are being sent
+ *
+ * Called by SendSharedInvalidMessages() after queueing the messages, in
+ * whichever process sends them.
+ */
+void
+SharedPlanCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	bool		reset_all = false;
+	int			i;
+
+	if (sharedPlanCache.ctl == NULL)
+		return;
+
+	for (i = 0; i < n && !reset_all; i++)
+	{
+		const SharedInvalidationMessage *msg = &msgs[i];
+
+		if (msg->id >= 0)
+		{
+			/* These are the syscaches plancache.c watches */
+			switch (msg->cc.id)
+			{
+				case PROCOID:
+					SharedCacheStamp(&sharedPlanCache,
+									 shared_plan_item_slot(msg->cc.id,
+														   msg->cc.hashValue),
+									 false);
+					break;
+				case NAMESPACEOID:
+				case OPEROID:
+				case AMOPOPID:
+				case FOREIGNSERVEROID:
+				case FOREIGNDATAWRAPPEROID:
+					reset_all = true;
+					break;
+				default:
+					break;
+			}
+		}
+		else if (msg->id == SHAREDINVALRELCACHE_ID)
+		{
+			if (msg->rc.relId == InvalidOid)
+				reset_all = true;
+			else
+				SharedCacheStamp(&sharedPlanCache,
+								 shared_plan_rel_slot(msg->rc.relId), false);
+		}
+		else if (msg->id == SHAREDINVALCATALOG_ID)
+		{
+			/* a whole catalog's caches are flushed; don't bother sorting */
+			reset_all = true;
+		}
+	}
+
+	if (reset_all)
+		SharedCacheStamp(&sharedPlanCache, 0, true);
+}
+
+/*
+ * shared_plan_entry_valid
+ *		Is a stored plan still valid?  Used by the clock sweep.
+ */
+static bool
+shared_plan_entry_valid(SharedCache *cache, void *entry, void *data)
+{
+	SharedPlanData *plan = (SharedPlanData *) data;
+
+	return shared_plan_valid(plan->plan_seq, SharedPlanSlots(plan),
+							 plan->num_slots);
+}
+
+/*
+ * SharedPlanCacheUsable
+ *		Could a generic plan for this statement be shared?
+ */
+bool
+SharedPlanCacheUsable(CachedPlanSource *plansource, QueryEnvironment *queryEnv)
+{
+	Oid			tempNamespaceId;
+	Oid			tempToastNamespaceId;
+
+	if (sharedPlanCache.ctl == NULL)
+		return false;
+
+	/* Only long-lived statements whose meaning is given by their text */
+	if (!plansource->is_saved || plansource->is_oneshot ||
+		plansource->parserSetup != NULL || queryEnv != NULL)
+		return false;
+
+	/* Nothing that depends on the role beyond the permissions checked */
+	if (plansource->dependsOnRLS)
+		return false;
+
+	/*
+	 * Nor anything that might resolve names to temporary objects.  Checking
+	 * whether we have a temp namespace at all is simpler and safer than
+	 * trying to tell whether it is on the search path.
+	 */
+	GetTempNamespaceState(&tempNamespaceId, &tempToastNamespaceId);
+	if (OidIsValid(tempNamespaceId))
+		return false;
+
+	return plansource->search_path != NULL;
+}
+
+/*
+ * shared_plan_make_key
+ *		Compute the hash key for a statement's generic plan
+ */
+static void
+shared_plan_make_key(CachedPlanSource *plansource, SharedPlanKey *key)
+{
+	OverrideSearchPath *path = plansource->search_path;
+	uint32		hashkey;
+	ListCell   *lc;
+
+	memset(key, 0, sizeof(SharedPlanKey));
+	key->dbid = MyDatabaseId;
+	key->userid = GetUserId();
+
+	hashkey = DatumGetUInt32(hash_any((const unsigned char *) plansource->query_string,
+									  strlen(plansource->query_string)));
+	if (plansource->num_params > 0)
+		hashkey ^= DatumGetUInt32(hash_any((const unsigned char *) plansource->param_types,
+										   plansource->num_params * sizeof(Oid)));
+	hashkey ^= DatumGetUInt32(hash_uint32((uint32) plansource->cursor_options));
+	key->query_hash = hashkey;
+
+	hashkey = GetPlannerSettingsHash();
+	foreach(lc, path->schemas)
+	{
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+		hashkey ^= DatumGetUInt32(hash_uint32((uint32) lfirst_oid(lc)));
+	}
+	if (path->addCatalog)
+		hashkey ^= 1;
+	key->context_hash = hashkey;
+}
+
+/*
+ * shared_plan_matches
+ *		Was this plan really made for this statement?
+ */
+static bool
+shared_plan_matches(SharedPlanData *data, CachedPlanSource *plansource)
+{
+	OverrideSearchPath *path = plansource->search_path;
+	Oid		   *schemas;
+	ListCell   *lc;
+	int			i;
+
+	if (data->cursor_options != plansource->cursor_options ||
+		data->num_params != plansource->num_params ||
+		data->num_schemas != list_length(path->schemas) ||
+		data->path_add_catalog != path->addCatalog ||
+		data->query_len != strlen(plansource->query_string))
+		return false;
+
+	if (data->num_params > 0 &&
+		memcmp(SharedPlanParamTypes(data), plansource->param_types,
+			   data->num_params * sizeof(Oid)) != 0)
+		return false;
+
+	schemas = SharedPlanSchemas(data);
+	i = 0;
+	foreach(lc, path->schemas)
+	{
+		if (schemas[i++] != lfirst_oid(lc))
+			return false;
+	}
+
+	return strcmp(SharedPlanQuery(data), plansource->query_string) == 0;
+}
+
+/*
+ * SharedPlanCacheFetch
+ *		Look for a usable generic plan for the statement
+ *
+ * Returns the plan's list of PlannedStmts, or NIL if there is none.  The
+ * caller must then lock the relations the plan uses and, since that may
+ * have processed invalidations, make sure with SharedPlanCacheRecheck() that
+ * the plan is still valid before using it.
+ */
+List *
+SharedPlanCacheFetch(CachedPlanSource *plansource, SharedPlanCheck **check)
+{
+	SharedPlanKey key;
+	SharedPlanEntry *entry;
+	SharedPlanData *data;
+	char	   *planstr;
+
+	Assert(SharedPlanCacheUsable(plansource, NULL));
+
+	SharedCacheAttach(&sharedPlanCache);
+	shared_plan_make_key(plansource, &key);
+
+	entry = dshash_find(sharedPlanCache.hash, &key, false);
+	if (entry == NULL)
+		return NIL;
+
+	data = dsa_get_address(sharedPlanCache.area, entry->item.data);
+	if (!shared_plan_matches(data, plansource) ||
+		!shared_plan_valid(data->plan_seq, SharedPlanSlots(data),
+						   data->num_slots))
+	{
+		dshash_release_lock(sharedPlanCache.hash, entry);
+		return NIL;
+	}
+
+	/* Copy out what we need, so as to hold the lock as briefly as we can */
+	planstr = palloc(data->plan_len + 1);
+	memcpy(planstr, SharedPlanString(data), data->plan_len + 1);
+
+	*check = palloc(offsetof(SharedPlanCheck, slots) +
+					data->num_slots * sizeof(uint32));
+	(*check)->plan_seq = data->plan_seq;
+	(*check)->num_slots = data->num_slots;
+	memcpy((*check)->slots, SharedPlanSlots(data),
+		   data->num_slots * sizeof(uint32));
+
+	SharedCacheUsed(&sharedPlanCache, entry);
+
+	dshash_release_lock(sharedPlanCache.hash, entry);
+
+	return (List *) stringToNode(planstr);
+}
+
+/*
+ * SharedPlanCacheRecheck
+ *		Is a plan returned by SharedPlanCacheFetch still valid?
+ */
+bool
+SharedPlanCacheRecheck(SharedPlanCheck *check)
+{
+	return shared_plan_valid(check->plan_seq, check->slots, check->num_slots);
+}
+
+/*
+ * SharedPlanCacheStartPlanning
+ *		Get ready to make a plan that may be stored in the cache
+ *
+ * Returns the sequence number to pass to SharedPlanCacheStore.  We take it
+ * before accepting pending invalidations, so that the planner can't see
+ * catalog state older than the sequence number implies.
+ */
+uint64
+SharedPlanCacheStartPlanning(void)
+{
+	uint64		seq;
+
+	seq = SharedCacheCurrentSeq(&sharedPlanCache);
+	AcceptInvalidationMessages();
+
+	return seq;
+}
+
+/*
+ * SharedPlanCacheStore
+ *		Offer a newly made generic plan to other backends
+ *
+ * plan_seq is what SharedPlanCacheStartPlanning returned before planning.
+ */
+void
+SharedPlanCacheStore(CachedPlanSource *plansource, List *plist,
+					 uint64 plan_seq)
+{
+	OverrideSearchPath *path = plansource->search_path;
+	SharedPlanKey key;
+	SharedPlanEntry *entry;
+	SharedPlanData *data;
+	dsa_pointer dp;
+	bool		found;
+	char	   *planstr;
+	uint32	   *slots;
+	int			num_slots;
+	int			max_slots;
+	int			query_len;
+	int			plan_len;
+	Size		size;
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			i;
+
+	/*
+	 * If the query was invalidated while we were planning it, the plan may
+	 * be out of date already.
+	 */
+	if (!plansource->is_valid)
+		return;
+
+	/* Collect the plan's dependencies, and make sure it's shareable */
+	max_slots = 0;
+	foreach(lc, plist)
+	{
+		PlannedStmt *stmt = castNode(PlannedStmt, lfirst(lc));
+
+		if (stmt->commandType == CMD_UTILITY || stmt->transientPlan)
+			return;
+		max_slots += list_length(stmt->relationOids) +
+			list_length(stmt->invalItems);
+	}
+
+	slots = palloc(Max(max_slots, 1) * sizeof(uint32));
+	num_slots = 0;
+	foreach(lc, plist)
+	{
+		PlannedStmt *stmt = castNode(PlannedStmt, lfirst(lc));
+
+		foreach(lc2, stmt->relationOids)
+		{
+			Oid			relid = lfirst_oid(lc2);
+
+			if (get_rel_persistence(relid) == RELPERSISTENCE_TEMP)
+				return;
+			slots[num_slots++] = shared_plan_rel_slot(relid);
+		}
+		foreach(lc2, stmt->invalItems)
+		{
+			PlanInvalItem *item = (PlanInvalItem *) lfirst(lc2);
+
+			slots[num_slots++] = shared_plan_item_slot(item->cacheId,
+													   item->hashValue);
+		}
+	}
+
+	/* Sort and remove duplicates */
+	if (num_slots > 1)
+	{
+		int			j = 0;
+
+		qsort(slots, num_slots, sizeof(uint32), uint32_cmp);
+		for (i = 1; i < num_slots; i++)
+		{
+			if (slots[i] != slots[j])
+				slots[++j] = slots[i];
+		}
+		num_slots = j + 1;
+	}
+
+	/* Don't bother if it's been invalidated already */
+	if (!shared_plan_valid(plan_seq, slots, num_slots))
+		return;
+
+	planstr = nodeToString(plist);
+	plan_len = strlen(planstr);
+	query_len = strlen(plansource->query_string);
+
+	size = MAXALIGN(sizeof(SharedPlanData)) +
+		(plansource->num_params + list_length(path->schemas)) * sizeof(Oid) +
+		num_slots * sizeof(uint32) +
+		query_len + 1 + plan_len + 1;
+
+	/* Plans too big for a decent share of the cache aren't worth it */
+	if (size > SharedCacheBudget(&sharedPlanCache) / 16)
+		return;
+
+	SharedCacheAttach(&sharedPlanCache);
+
+	dp = SharedCacheAllocate(&sharedPlanCache, size);
+	if (!DsaPointerIsValid(dp))
+		return;
+
+	data = dsa_get_address(sharedPlanCache.area, dp);
+	data->plan_seq = plan_seq;
+	data->cursor_options = plansource->cursor_options;
+	data->path_add_catalog = path->addCatalog;
+	data->num_params = plansource->num_params;
+	data->num_schemas = list_length(path->schemas);
+	data->num_slots = num_slots;
+	data->query_len = query_len;
+	data->plan_len = plan_len;
+	if (data->num_params > 0)
+		memcpy(SharedPlanParamTypes(data), plansource->param_types,
+			   data->num_params * sizeof(Oid));
+	i = 0;
+	foreach(lc, path->schemas)
+		SharedPlanSchemas(data)[i++] = lfirst_oid(lc);
+	memcpy(SharedPlanSlots(data), slots, num_slots * sizeof(uint32));
+	memcpy(SharedPlanQuery(data), plansource->query_string, query_len + 1);
+	memcpy(SharedPlanString(data), planstr, plan_len + 1);
+
+	shared_plan_make_key(plansource, &key);
+	entry = dshash_find_or_insert(sharedPlanCache.hash, &key, &found);
+	if (found)
+	{
+		SharedPlanData *old = dsa_get_address(sharedPlanCache.area,
+											  entry->item.data);
+
+		/*
+		 * If somebody else got there first with a good plan, keep theirs.
+		 * Otherwise the old one is invalid, or for another statement whose
+		 * key collides with ours; replace it.
+		 */
+		if (shared_plan_matches(old, plansource) &&
+			shared_plan_valid(old->plan_seq, SharedPlanSlots(old),
+							  old->num_slots))
+		{
+			dshash_release_lock(sharedPlanCache.hash, entry);
+			dsa_free(sharedPlanCache.area, dp);
+			return;
+		}
+	}
+	SharedCacheInstall(&sharedPlanCache, entry, found, dp, size);
+	dshash_release_lock(sharedPlanCache.hash, entry);
+}
+
+static int
+uint32_cmp(const void *a, const void *b)
+{
+	uint32		av = *(const uint32 *) a;
+	uint32		bv = *(const uint32 *) b;
+
+	if (av < bv)
+		return -1;
+	if (av > bv)
+		return 1;
+	return 0;
+}
@@ -182,6 +182,18 @@ GetDatabaseTupleByOid(Oid dboid)
 static void
 PerformAuthentication(Port *port)
 {
+	/*
+	 * A backend started for a connection proxy has no client of its own
+	 * yet.  It authenticates each client the proxy hands to it instead; see
+	 * ProcessPooledSessionStartup().
+	 */
+	if (port->pooled)
+	{
+		set_ps_display("startup", false);
+		ClientAuthInProgress = false;
+		return;
+	}
+
 	/* This should be set already, but let's make sure */
 	ClientAuthInProgress = true;	/* limit visibility of log messages */
 
@@ -628,6 +640,14 @@ InitPostgres(const char *in_dbname, Oid dboid, const char *username,
 		 */
 		StartupXLOG();
 		on_shmem_exit(ShutdownXLOG, 0);
+
+		/*
+		 * There is no checkpointer to save the statistics at shutdown, so do
+		 * it ourselves.  This must be registered before pgstat_initialize()
+		 * sets up its hook, so that our own counts are flushed first.
+		 */
+		if (!bootstrap)
+			before_shmem_exit(pgstat_before_server_shutdown, 0);
 	}
 
 	/*
@@ -654,12 +674,13 @@ InitPostgres(const char *in_dbname, Oid dboid, const char *username,
 	RelationCacheInitializePhase2();
 
 	/*
-	 * Set up process-exit callback to do pre-shutdown cleanup.  This is the
-	 * first before_shmem_exit callback we register; thus, this will be the
-	 * last thing we do before low-level modules like the buffer manager begin
-	 * to close down.  We need to have this in place before we begin our first
-	 * transaction --- if we fail during the initialization transaction, as is
-	 * entirely possible, we need the AbortTransaction call to clean up.
+	 * Set up process-exit callback to do pre-shutdown cleanup.  Apart from
+	 * the statistics hooks, this is the first before_shmem_exit callback we
+	 * register; thus, this will be nearly the last thing we do before
+	 * low-level modules like the buffer manager begin to close down.  We need
+	 * to have this in place before we begin our first transaction --- if we
+	 * fail during the initialization transaction, as is entirely possible,
+	 * we need the AbortTransaction call to clean up.
 	 */
 	before_shmem_exit(ShutdownPostgres, 0);
 
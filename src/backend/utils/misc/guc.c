@@ -28,6 +28,7 @@
 
 #include "access/commit_ts.h"
 #include "access/gin.h"
+#include "access/hash.h"
 #include "access/rmgr.h"
 #include "access/transam.h"
 #include "access/twophase.h"
@@ -60,6 +61,7 @@
 #include "postmaster/bgworker.h"
 #include "postmaster/bgwriter.h"
 #include "postmaster/postmaster.h"
+#include "postmaster/proxy.h"
 #include "postmaster/syslogger.h"
 #include "postmaster/walwriter.h"
 #include "replication/logicallauncher.h"
@@ -78,13 +80,17 @@
 #include "tsearch/ts_cache.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
+#include "utils/catcache.h"
 #include "utils/guc_tables.h"
 #include "utils/memutils.h"
 #include "utils/pg_locale.h"
 #include "utils/plancache.h"
 #include "utils/portal.h"
+#include "utils/relcache.h"
 #include "utils/ps_status.h"
 #include "utils/rls.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/tzparser.h"
 #include "utils/varlena.h"
@@ -164,6 +170,8 @@ static void assign_syslog_facility(int newval, void *extra);
 static void assign_syslog_ident(const char *newval, void *extra);
 static void assign_session_replication_role(int newval, void *extra);
 static bool check_temp_buffers(int *newval, void **extra, GucSource source);
+static bool check_shared_catalog_cache_size(int *newval, void **extra, GucSource source);
+static bool check_shared_plan_cache_size(int *newval, void **extra, GucSource source);
 static bool check_bonjour(bool *newval, void **extra, GucSource source);
 static bool check_ssl(bool *newval, void **extra, GucSource source);
 static bool check_stage_log_stats(bool *newval, void **extra, GucSource source);
@@ -403,6 +411,13 @@ static const struct config_enum_entry force_parallel_mode_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry plan_cache_mode_options[] = {
+	{"auto", PLAN_CACHE_MODE_AUTO, false},
+	{"force_generic_plan", PLAN_CACHE_MODE_FORCE_GENERIC_PLAN, false},
+	{"force_custom_plan", PLAN_CACHE_MODE_FORCE_CUSTOM_PLAN, false},
+	{NULL, 0, false}
+};
+
 /*
  * password_encryption used to be a boolean, so accept all the likely
  * variants of "on" and "off", too.
@@ -831,6 +846,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_indexskipscan", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of index skip scans."),
+			NULL
+		},
+		&enable_indexskipscan,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_bitmapscan", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of bitmap-scan plans."),
@@ -858,6 +882,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_incrementalsort", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of incremental sort steps."),
+			NULL
+		},
+		&enable_incrementalsort,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_hashagg", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of hashed aggregation plans."),
@@ -876,6 +909,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_memoize", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of memoization."),
+			NULL
+		},
+		&enable_memoize,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_nestloop", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of nested-loop join plans."),
@@ -913,6 +955,46 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"enable_parallel_append", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of parallel append plans."),
+			NULL
+		},
+		&enable_parallel_append,
+		true,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"enable_async_append", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of async append plans."),
+			NULL
+		},
+		&enable_async_append,
+		true,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"enable_partition_wise_join", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables partition-wise join."),
+			NULL
+		},
+		&enable_partition_wise_join,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"enable_partition_wise_agg", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables partition-wise aggregation and grouping."),
+			NULL
+		},
+		&enable_partition_wise_agg,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"geqo", PGC_USERSET, QUERY_TUNING_GEQO,
 			gettext_noop("Enables genetic query optimization."),
@@ -1871,6 +1953,28 @@ static struct config_int ConfigureNamesInt[] =
 		check_temp_buffers, NULL, NULL
 	},
 
+	{
+		{"shared_catalog_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the amount of shared memory used to share system catalog tuples between sessions."),
+			gettext_noop("Zero disables the shared catalog cache."),
+			GUC_UNIT_KB
+		},
+		&shared_catalog_cache_size,
+		0, 0, MAX_KILOBYTES,
+		check_shared_catalog_cache_size, NULL, NULL
+	},
+
+	{
+		{"shared_plan_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the amount of shared memory used to share generic plans of prepared statements between sessions."),
+			gettext_noop("Zero disables the shared plan cache."),
+			GUC_UNIT_KB
+		},
+		&shared_plan_cache_size,
+		0, 0, MAX_KILOBYTES,
+		check_shared_plan_cache_size, NULL, NULL
+	},
+
 	{
 		{"port", PGC_POSTMASTER, CONN_AUTH_SETTINGS,
 			gettext_noop("Sets the TCP port the server listens on."),
@@ -1881,6 +1985,46 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"connection_proxies", PGC_POSTMASTER, CONN_AUTH_SETTINGS,
+			gettext_noop("Sets the number of connection proxy processes."),
+			gettext_noop("Zero disables connection pooling.")
+		},
+		&ConnectionProxiesNumber,
+		0, 0, MAX_CONNECTION_PROXIES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"proxy_port", PGC_POSTMASTER, CONN_AUTH_SETTINGS,
+			gettext_noop("Sets the TCP port on which connection proxies accept clients."),
+			NULL
+		},
+		&ProxyPortNumber,
+		6543, 1, 65535,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"session_pool_size", PGC_SIGHUP, CONN_AUTH_SETTINGS,
+			gettext_noop("Sets the number of backends each connection proxy keeps per database and user."),
+			NULL
+		},
+		&SessionPoolSize,
+		10, 1, MAX_BACKENDS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"max_sessions", PGC_POSTMASTER, CONN_AUTH_SETTINGS,
+			gettext_noop("Sets the maximum number of client sessions per connection proxy."),
+			NULL
+		},
+		&MaxSessions,
+		1000, 1, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"unix_socket_permissions", PGC_POSTMASTER, CONN_AUTH_SETTINGS,
 			gettext_noop("Sets the access permissions of the Unix-domain socket."),
@@ -1934,6 +2078,30 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"catalog_cache_memory_target", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the memory this session's catalog caches are trimmed to."),
+			gettext_noop("Least recently used entries are evicted when the caches "
+						 "would grow past this size. Zero means no limit."),
+			GUC_UNIT_KB
+		},
+		&catalog_cache_memory_target,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"relation_cache_memory_target", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the memory this session's relation cache is trimmed to."),
+			gettext_noop("Least recently used entries are evicted at transaction end "
+						 "when the cache has grown past this size. Zero means no limit."),
+			GUC_UNIT_KB
+		},
+		&relation_cache_memory_target,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"replacement_sort_tuples", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the maximum number of tuples to be sorted using replacement selection."),
@@ -3875,6 +4043,18 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"plan_cache_mode", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Controls the planner's choice between custom and generic plans for cached statements."),
+			gettext_noop("Prepared statements can have custom and generic plans, and the planner "
+						 "will attempt to choose which is better.  This can be set to override "
+						 "the default behavior.")
+		},
+		&plan_cache_mode,
+		PLAN_CACHE_MODE_AUTO, plan_cache_mode_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"password_encryption", PGC_USERSET, CONN_AUTH_SECURITY,
 			gettext_noop("Encrypt passwords."),
@@ -5361,6 +5541,24 @@ BeginReportingGUCOptions(void)
 	}
 }
 
+/*
+ * Have any variables been changed for the rest of the session, by SET or
+ * set_config() without the LOCAL option?
+ */
+bool
+HaveSessionGUCSettings(void)
+{
+	int			i;
+
+	for (i = 0; i < num_guc_variables; i++)
+	{
+		if (guc_variables[i]->source == PGC_S_SESSION)
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * ReportGUCOption: if appropriate, transmit option value to frontend
  */
@@ -8319,6 +8517,73 @@ GetNumConfigOptions(void)
 	return num_guc_variables;
 }
 
+/*
+ * Compute a hash of the current values of all settings that can affect the
+ * plans the planner makes, that is, those in the resource usage and query
+ * tuning groups.  This allows telling whether a plan made by another session
+ * was made under the same settings.
+ */
+uint32
+GetPlannerSettingsHash(void)
+{
+	uint32		hashkey = 0;
+	int			i;
+
+	for (i = 0; i < num_guc_variables; i++)
+	{
+		struct config_generic *conf = guc_variables[i];
+		uint32		valhash;
+
+		switch (conf->group)
+		{
+			case RESOURCES_MEM:
+			case RESOURCES_ASYNCHRONOUS:
+			case QUERY_TUNING_METHOD:
+			case QUERY_TUNING_COST:
+			case QUERY_TUNING_GEQO:
+			case QUERY_TUNING_OTHER:
+				break;
+			default:
+				continue;
+		}
+
+		switch (conf->vartype)
+		{
+			case PGC_BOOL:
+				valhash = (uint32) *((struct config_bool *) conf)->variable;
+				break;
+			case PGC_INT:
+				valhash = (uint32) *((struct config_int *) conf)->variable;
+				break;
+			case PGC_REAL:
+				valhash = DatumGetUInt32(hash_any((const unsigned char *)
+												  ((struct config_real *) conf)->variable,
+												  sizeof(double)));
+				break;
+			case PGC_STRING:
+				{
+					char	   *val = *((struct config_string *) conf)->variable;
+
+					valhash = val ? DatumGetUInt32(hash_any((const unsigned char *) val,
+															strlen(val))) : 0;
+				}
+				break;
+			case PGC_ENUM:
+				valhash = (uint32) *((struct config_enum *) conf)->variable;
+				break;
+			default:
+				valhash = 0;
+				break;
+		}
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+		hashkey ^= DatumGetUInt32(hash_uint32(valhash));
+	}
+
+	return hashkey;
+}
+
 /*
  * show_config_by_name - equiv to SHOW X command but implemented as
  * a function.
@@ -10126,6 +10391,34 @@ check_temp_buffers(int *newval, void **extra, GucSource source)
 	return true;
 }
 
+static bool
+check_shared_catalog_cache_size(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * Less than that wouldn't hold enough tuples to be of any use.
+	 */
+	if (*newval != 0 && *newval < 1024)
+	{
+		GUC_check_errdetail("\"shared_catalog_cache_size\" must be zero or at least 1MB.");
+		return false;
+	}
+	return true;
+}
+
+static bool
+check_shared_plan_cache_size(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * Less than that wouldn't hold enough plans to be of any use.
+	 */
+	if (*newval != 0 && *newval < 1024)
+	{
+		GUC_check_errdetail("\"shared_plan_cache_size\" must be zero or at least 1MB.");
+		return false;
+	}
+	return true;
+}
+
 static bool
 check_bonjour(bool *newval, void **extra, GucSource source)
 {
@@ -10400,28 +10693,14 @@ assign_pgstat_temp_directory(const char *newval, void *extra)
 {
 	/* check_canonical_path already canonicalized newval for us */
 	char	   *dname;
-	char	   *tname;
-	char	   *fname;
 
 	/* directory */
 	dname = guc_malloc(ERROR, strlen(newval) + 1);		/* runtime dir */
 	sprintf(dname, "%s", newval);
 
-	/* global stats */
-	tname = guc_malloc(ERROR, strlen(newval) + 12);		/* /global.tmp */
-	sprintf(tname, "%s/global.tmp", newval);
-	fname = guc_malloc(ERROR, strlen(newval) + 13);		/* /global.stat */
-	sprintf(fname, "%s/global.stat", newval);
-
 	if (pgstat_stat_directory)
 		free(pgstat_stat_directory);
 	pgstat_stat_directory = dname;
-	if (pgstat_stat_tmpname)
-		free(pgstat_stat_tmpname);
-	pgstat_stat_tmpname = tname;
-	if (pgstat_stat_filename)
-		free(pgstat_stat_filename);
-	pgstat_stat_filename = fname;
 }
 
 static bool
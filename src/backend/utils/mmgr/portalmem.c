@@ -1123,6 +1123,16 @@ pg_cursor(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/*
+ * Are there any portals at all?  Between transactions, the only ones that
+ * can exist are holdable cursors.
+ */
+bool
+HavePortals(void)
+{
+	return hash_get_num_entries(PortalHashTable) > 0;
+}
+
 bool
 ThereAreNoReadyPortals(void)
 {
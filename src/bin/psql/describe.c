@@ -2332,7 +2332,8 @@ describeOneTableDetails(const char *schemaname,
 			   "         JOIN pg_catalog.pg_attribute a ON (starelid = a.attrelid AND\n"
 							  "a.attnum = s.attnum AND not attisdropped))) AS columns,\n"
 							  "  (staenabled::char[] @> '{d}'::char[]) AS ndist_enabled,\n"
-							  "  (staenabled::char[] @> '{f}'::char[]) AS deps_enabled\n"
+							  "  (staenabled::char[] @> '{f}'::char[]) AS deps_enabled,\n"
+							  "  (staenabled::char[] @> '{m}'::char[]) AS mcv_enabled\n"
 			  "FROM pg_catalog.pg_statistic_ext stat WHERE starelid  = '%s'\n"
 			  "ORDER BY 1;",
 							  oid);
@@ -2368,6 +2369,12 @@ describeOneTableDetails(const char *schemaname,
 					if (strcmp(PQgetvalue(result, i, 6), "t") == 0)
 					{
 						appendPQExpBuffer(&buf, "%sdependencies", gotone ? ", " : "");
+						gotone = true;
+					}
+
+					if (strcmp(PQgetvalue(result, i, 7), "t") == 0)
+					{
+						appendPQExpBuffer(&buf, "%smcv", gotone ? ", " : "");
 					}
 
 					appendPQExpBuffer(&buf, ") ON (%s)",
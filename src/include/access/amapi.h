@@ -139,6 +139,10 @@ typedef void (*ammarkpos_function) (IndexScanDesc scan);
 /* restore marked scan position */
 typedef void (*amrestrpos_function) (IndexScanDesc scan);
 
+/* skip remaining tuples with the current leading column value */
+typedef bool (*amskip_function) (IndexScanDesc scan,
+											 ScanDirection direction);
+
 /*
  * Callback function signatures - for parallel index scans.
  */
@@ -212,6 +216,7 @@ typedef struct IndexAmRoutine
 	amendscan_function amendscan;
 	ammarkpos_function ammarkpos;		/* can be NULL */
 	amrestrpos_function amrestrpos;		/* can be NULL */
+	amskip_function amskip;		/* can be NULL */
 
 	/* interface functions to support parallel index scans */
 	amestimateparallelscan_function amestimateparallelscan;		/* can be NULL */
@@ -402,6 +402,15 @@ typedef struct GinEntryAccumulator
 	uint32		count;			/* current number of list[] entries */
 } GinEntryAccumulator;
 
+/* One (key, heap pointer) pair, in a sorted-mode BuildAccumulator */
+typedef struct GinSortedEntry
+{
+	Datum		key;
+	ItemPointerData heapptr;
+	OffsetNumber attnum;
+	GinNullCategory category;
+} GinSortedEntry;
+
 typedef struct
 {
 	GinState   *ginstate;
@@ -410,9 +419,22 @@ typedef struct
 	uint32		eas_used;
 	RBTree	   *tree;
 	RBTreeIterator tree_walk;
+
+	/*
+	 * In sorted mode, the entries are collected into a flat array instead of
+	 * the rbtree, and sorted all at once by ginBeginBAScan.
+	 */
+	bool		sorted;
+	GinSortedEntry *sortentries;
+	uint32		nsortentries;	/* current number of sortentries[] */
+	uint32		maxsortentries; /* allocated size of sortentries[] */
+	uint32		sortpos;		/* next entry to return */
+	ItemPointerData *sortlist;	/* result buffer for ginGetBAEntry */
+	uint32		maxsortlist;	/* allocated size of sortlist[] */
 } BuildAccumulator;
 
 extern void ginInitBA(BuildAccumulator *accum);
+extern void ginInitSortedBA(BuildAccumulator *accum);
 extern void ginInsertBAEntries(BuildAccumulator *accum,
 				   ItemPointer heapptr, OffsetNumber attnum,
 				   Datum *entries, GinNullCategory *categories,
@@ -439,7 +461,8 @@ extern void ginHeapTupleFastCollect(GinState *ginstate,
 						OffsetNumber attnum, Datum value, bool isNull,
 						ItemPointer ht_ctid);
 extern void ginInsertCleanup(GinState *ginstate, bool full_clean,
-				 bool fill_fsm, IndexBulkDeleteResult *stats);
+				 bool fill_fsm, bool forceCleanup,
+				 IndexBulkDeleteResult *stats);
 
 /* ginpostinglist.c */
 
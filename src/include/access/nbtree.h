@@ -153,8 +153,15 @@ typedef struct BTMetaPageData
 #define BTTidSame(i1, i2)	\
 	((ItemPointerGetBlockNumber(&(i1)) == ItemPointerGetBlockNumber(&(i2))) && \
 	 (ItemPointerGetOffsetNumber(&(i1)) == ItemPointerGetOffsetNumber(&(i2))))
+
+/*
+ * Downlinks are unique within a level by their block number alone.  We don't
+ * compare the offset part of the TID, since a truncated pivot tuple keeps its
+ * number of key attributes there (see below).
+ */
 #define BTEntrySame(i1, i2) \
-	BTTidSame((i1)->t_tid, (i2)->t_tid)
+	(ItemPointerGetBlockNumberNoCheck(&(i1)->t_tid) == \
+	 ItemPointerGetBlockNumberNoCheck(&(i2)->t_tid))
 
 
 /*
@@ -204,6 +211,55 @@ typedef struct BTMetaPageData
 #define P_FIRSTKEY			((OffsetNumber) 2)
 #define P_FIRSTDATAKEY(opaque)	(P_RIGHTMOST(opaque) ? P_HIKEY : P_FIRSTKEY)
 
+/*
+ *	Suffix truncation.  When a leaf page is split, the new high key of the
+ *	left half (which is also the downlink for the right half in the parent)
+ *	only needs to keep as many leading key attributes as are needed to
+ *	distinguish the last item on the left half from the first item on the
+ *	right half.  The remaining trailing attributes are simply left out of the
+ *	"pivot" tuple, and are treated as "minus infinity" by _bt_compare().
+ *
+ *	A pivot tuple that had attributes truncated away is marked by setting
+ *	INDEX_ALT_TID_MASK in t_info.  The offset number part of its t_tid then
+ *	holds the number of attributes that remain, since it is otherwise unused
+ *	in pivot tuples (the block number part is the downlink, if any).  Tuples
+ *	without the flag bit have all of the index's attributes, so indexes built
+ *	before this was introduced need no conversion.
+ */
+#define INDEX_ALT_TID_MASK			0x2000	/* uses INDEX_AM_RESERVED bit */
+#define BT_N_KEYS_OFFSET_MASK		0x0FFF
+
+#define BTreeTupleIsTruncated(itup) \
+	(((itup)->t_info & INDEX_ALT_TID_MASK) != 0)
+#define BTreeTupleGetNAtts(itup, rel) \
+	( \
+		BTreeTupleIsTruncated(itup) ? \
+		( \
+			ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & \
+			BT_N_KEYS_OFFSET_MASK \
+		) \
+		: \
+		RelationGetNumberOfAttributes(rel) \
+	)
+#define BTreeTupleSetNAtts(itup, n) \
+	do { \
+		(itup)->t_info |= INDEX_ALT_TID_MASK; \
+		ItemPointerSetOffsetNumber(&(itup)->t_tid, \
+								   (n) & BT_N_KEYS_OFFSET_MASK); \
+	} while (0)
+
+/*
+ * Set the downlink of a pivot tuple, without clobbering the number of
+ * attributes stored in a truncated tuple's TID offset.
+ */
+#define BTreeInnerTupleSetDownLink(itup, blkno) \
+	do { \
+		if (BTreeTupleIsTruncated(itup)) \
+			ItemPointerSetBlockNumber(&(itup)->t_tid, (blkno)); \
+		else \
+			ItemPointerSet(&(itup)->t_tid, (blkno), P_HIKEY); \
+	} while (0)
+
 
 /*
  *	Operator strategy numbers for B-tree have been moved to access/stratnum.h,
@@ -388,6 +444,13 @@ typedef struct BTScanOpaqueData
 	BTArrayKeyInfo *arrayKeys;	/* info about each equality-type array key */
 	MemoryContext arrayContext; /* scan-lifespan context for array data */
 
+	/* workspace for skip scans (see _bt_preprocess_skip_key) */
+	bool		skipScan;		/* scanning one leading value at a time? */
+	bool		skipHaveValue;	/* does the skip key hold a value yet? */
+	ScanKey		skipKeyData;	/* skip key followed by copy of
+								 * scan->keyData */
+	MemoryContext skipContext;	/* scan-lifespan context for skip data */
+
 	/* info about killed items if any (killedItems is NULL if never used) */
 	int		   *killedItems;	/* currPos.items indexes of killed items */
 	int			numKilled;		/* number of currently stored items */
@@ -448,6 +511,7 @@ extern void btparallelrescan(IndexScanDesc scan);
 extern void btendscan(IndexScanDesc scan);
 extern void btmarkpos(IndexScanDesc scan);
 extern void btrestrpos(IndexScanDesc scan);
+extern bool btskip(IndexScanDesc scan, ScanDirection dir);
 extern IndexBulkDeleteResult *btbulkdelete(IndexVacuumInfo *info,
 			 IndexBulkDeleteResult *stats,
 			 IndexBulkDeleteCallback callback,
@@ -508,6 +572,7 @@ extern int32 _bt_compare(Relation rel, int keysz, ScanKey scankey,
 			Page page, OffsetNumber offnum);
 extern bool _bt_first(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_next(IndexScanDesc scan, ScanDirection dir);
+extern bool _bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir);
 extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost,
 				 Snapshot snapshot);
 
@@ -516,6 +581,8 @@ extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost,
  */
 extern ScanKey _bt_mkscankey(Relation rel, IndexTuple itup);
 extern ScanKey _bt_mkscankey_nodata(Relation rel);
+extern IndexTuple _bt_truncate(Relation rel, IndexTuple lastleft,
+			 IndexTuple firstright);
 extern void _bt_freeskey(ScanKey skey);
 extern void _bt_freestack(BTStack stack);
 extern void _bt_preprocess_array_keys(IndexScanDesc scan);
@@ -523,6 +590,8 @@ extern void _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_advance_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern void _bt_mark_array_keys(IndexScanDesc scan);
 extern void _bt_restore_array_keys(IndexScanDesc scan);
+extern void _bt_preprocess_skip_key(IndexScanDesc scan);
+extern void _bt_set_skip_key(IndexScanDesc scan, Datum value, bool isnull);
 extern void _bt_preprocess_keys(IndexScanDesc scan);
 extern IndexTuple _bt_checkkeys(IndexScanDesc scan,
 			  Page page, OffsetNumber offnum,
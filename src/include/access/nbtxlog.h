@@ -88,9 +88,9 @@ typedef struct xl_btree_insert
  *
  * The left page's data portion contains the new item, if it's the _L variant.
  * (In the _R variants, the new item is one of the right page's tuples.)
- * If level > 0, an IndexTuple representing the HIKEY of the left page
- * follows.  We don't need this on leaf pages, because it's the same as the
- * leftmost key in the new right page.
+ * An IndexTuple representing the HIKEY of the left page follows.  We need
+ * this even on leaf pages, because the high key may have been suffix-
+ * truncated and so can differ from the leftmost key in the new right page.
  *
  * Backup Blk 1: new right page
  *
@@ -200,6 +200,7 @@ DATA(insert (	1029   600 600 6 2582 ));
 DATA(insert (	1029   600 600 7 2584 ));
 DATA(insert (	1029   600 600 8 3064 ));
 DATA(insert (	1029   600 600 9 3282 ));
+DATA(insert (	1029   600 600 10 4236 ));
 DATA(insert (	2593   603 603 1 2578 ));
 DATA(insert (	2593   603 603 2 2583 ));
 DATA(insert (	2593   603 603 3 2579 ));
@@ -536,4 +537,98 @@ DATA(insert (	4104   603	 603  4  4108 ));
 DATA(insert (	4104   603	 603  11 4067 ));
 DATA(insert (	4104   603	 603  13  187 ));
 
+/* bloom */
+DATA(insert (	4213    21	  21  1  4221 ));
+DATA(insert (	4213    21	  21  2  4222 ));
+DATA(insert (	4213    21	  21  3  4223 ));
+DATA(insert (	4213    21	  21  4  4224 ));
+DATA(insert (	4213    21	  21  11  449 ));
+DATA(insert (	4213    23	  23  1  4221 ));
+DATA(insert (	4213    23	  23  2  4222 ));
+DATA(insert (	4213    23	  23  3  4223 ));
+DATA(insert (	4213    23	  23  4  4224 ));
+DATA(insert (	4213    23	  23  11  450 ));
+DATA(insert (	4213    20	  20  1  4221 ));
+DATA(insert (	4213    20	  20  2  4222 ));
+DATA(insert (	4213    20	  20  3  4223 ));
+DATA(insert (	4213    20	  20  4  4224 ));
+DATA(insert (	4213    20	  20  11  949 ));
+DATA(insert (	4214   700	 700  1  4221 ));
+DATA(insert (	4214   700	 700  2  4222 ));
+DATA(insert (	4214   700	 700  3  4223 ));
+DATA(insert (	4214   700	 700  4  4224 ));
+DATA(insert (	4214   700	 700  11  451 ));
+DATA(insert (	4214   701	 701  1  4221 ));
+DATA(insert (	4214   701	 701  2  4222 ));
+DATA(insert (	4214   701	 701  3  4223 ));
+DATA(insert (	4214   701	 701  4  4224 ));
+DATA(insert (	4214   701	 701  11  452 ));
+DATA(insert (	4215    25	  25  1  4221 ));
+DATA(insert (	4215    25	  25  2  4222 ));
+DATA(insert (	4215    25	  25  3  4223 ));
+DATA(insert (	4215    25	  25  4  4224 ));
+DATA(insert (	4215    25	  25  11  400 ));
+DATA(insert (	4216  1082	1082  1  4221 ));
+DATA(insert (	4216  1082	1082  2  4222 ));
+DATA(insert (	4216  1082	1082  3  4223 ));
+DATA(insert (	4216  1082	1082  4  4224 ));
+DATA(insert (	4216  1082	1082  11  450 ));
+DATA(insert (	4216  1114	1114  1  4221 ));
+DATA(insert (	4216  1114	1114  2  4222 ));
+DATA(insert (	4216  1114	1114  3  4223 ));
+DATA(insert (	4216  1114	1114  4  4224 ));
+DATA(insert (	4216  1114	1114  11 2039 ));
+DATA(insert (	4216  1184	1184  1  4221 ));
+DATA(insert (	4216  1184	1184  2  4222 ));
+DATA(insert (	4216  1184	1184  3  4223 ));
+DATA(insert (	4216  1184	1184  4  4224 ));
+DATA(insert (	4216  1184	1184  11 2039 ));
+DATA(insert (	4217  2950	2950  1  4221 ));
+DATA(insert (	4217  2950	2950  2  4222 ));
+DATA(insert (	4217  2950	2950  3  4223 ));
+DATA(insert (	4217  2950	2950  4  4224 ));
+DATA(insert (	4217  2950	2950  11 2963 ));
+
+/* minmax multi */
+DATA(insert (	4218    21	  21  1  4225 ));
+DATA(insert (	4218    21	  21  2  4226 ));
+DATA(insert (	4218    21	  21  3  4227 ));
+DATA(insert (	4218    21	  21  4  4228 ));
+DATA(insert (	4218    21	  21  11 4229 ));
+DATA(insert (	4218    23	  23  1  4225 ));
+DATA(insert (	4218    23	  23  2  4226 ));
+DATA(insert (	4218    23	  23  3  4227 ));
+DATA(insert (	4218    23	  23  4  4228 ));
+DATA(insert (	4218    23	  23  11 4230 ));
+DATA(insert (	4218    20	  20  1  4225 ));
+DATA(insert (	4218    20	  20  2  4226 ));
+DATA(insert (	4218    20	  20  3  4227 ));
+DATA(insert (	4218    20	  20  4  4228 ));
+DATA(insert (	4218    20	  20  11 4231 ));
+DATA(insert (	4219   700	 700  1  4225 ));
+DATA(insert (	4219   700	 700  2  4226 ));
+DATA(insert (	4219   700	 700  3  4227 ));
+DATA(insert (	4219   700	 700  4  4228 ));
+DATA(insert (	4219   700	 700  11 4232 ));
+DATA(insert (	4219   701	 701  1  4225 ));
+DATA(insert (	4219   701	 701  2  4226 ));
+DATA(insert (	4219   701	 701  3  4227 ));
+DATA(insert (	4219   701	 701  4  4228 ));
+DATA(insert (	4219   701	 701  11 4233 ));
+DATA(insert (	4220  1082	1082  1  4225 ));
+DATA(insert (	4220  1082	1082  2  4226 ));
+DATA(insert (	4220  1082	1082  3  4227 ));
+DATA(insert (	4220  1082	1082  4  4228 ));
+DATA(insert (	4220  1082	1082  11 4234 ));
+DATA(insert (	4220  1114	1114  1  4225 ));
+DATA(insert (	4220  1114	1114  2  4226 ));
+DATA(insert (	4220  1114	1114  3  4227 ));
+DATA(insert (	4220  1114	1114  4  4228 ));
+DATA(insert (	4220  1114	1114  11 4235 ));
+DATA(insert (	4220  1184	1184  1  4225 ));
+DATA(insert (	4220  1184	1184  2  4226 ));
+DATA(insert (	4220  1184	1184  3  4227 ));
+DATA(insert (	4220  1184	1184  4  4228 ));
+DATA(insert (	4220  1184	1184  11 4235 ));
+
 #endif   /* PG_AMPROC_H */
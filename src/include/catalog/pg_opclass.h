@@ -246,5 +246,24 @@ DATA(insert (	3580	pg_lsn_minmax_ops		PGNSP PGUID 4082  3220 t 3220 ));
 /* no brin opclass for enum, tsvector, tsquery, jsonb */
 DATA(insert (	3580	box_inclusion_ops		PGNSP PGUID 4104   603 t 603 ));
 /* no brin opclass for the geometric types except box */
+/* bloom and minmax-multi opclasses are never the default */
+DATA(insert (	3580	int2_bloom_ops	PGNSP PGUID 4213    21 f 21 ));
+DATA(insert (	3580	int4_bloom_ops	PGNSP PGUID 4213    23 f 23 ));
+DATA(insert (	3580	int8_bloom_ops	PGNSP PGUID 4213    20 f 20 ));
+DATA(insert (	3580	float4_bloom_ops	PGNSP PGUID 4214   700 f 700 ));
+DATA(insert (	3580	float8_bloom_ops	PGNSP PGUID 4214   701 f 701 ));
+DATA(insert (	3580	text_bloom_ops	PGNSP PGUID 4215    25 f 25 ));
+DATA(insert (	3580	date_bloom_ops	PGNSP PGUID 4216  1082 f 1082 ));
+DATA(insert (	3580	timestamp_bloom_ops	PGNSP PGUID 4216  1114 f 1114 ));
+DATA(insert (	3580	timestamptz_bloom_ops	PGNSP PGUID 4216  1184 f 1184 ));
+DATA(insert (	3580	uuid_bloom_ops	PGNSP PGUID 4217  2950 f 2950 ));
+DATA(insert (	3580	int2_minmax_multi_ops	PGNSP PGUID 4218    21 f 21 ));
+DATA(insert (	3580	int4_minmax_multi_ops	PGNSP PGUID 4218    23 f 23 ));
+DATA(insert (	3580	int8_minmax_multi_ops	PGNSP PGUID 4218    20 f 20 ));
+DATA(insert (	3580	float4_minmax_multi_ops	PGNSP PGUID 4219   700 f 700 ));
+DATA(insert (	3580	float8_minmax_multi_ops	PGNSP PGUID 4219   701 f 701 ));
+DATA(insert (	3580	date_minmax_multi_ops	PGNSP PGUID 4220  1082 f 1082 ));
+DATA(insert (	3580	timestamp_minmax_multi_ops	PGNSP PGUID 4220  1114 f 1114 ));
+DATA(insert (	3580	timestamptz_minmax_multi_ops	PGNSP PGUID 4220  1184 f 1184 ));
 
 #endif   /* PG_OPCLASS_H */
@@ -185,6 +185,14 @@ DATA(insert OID = 4081 (	3580	uuid_minmax_ops			PGNSP PGUID ));
 DATA(insert OID = 4103 (	3580	range_inclusion_ops		PGNSP PGUID ));
 DATA(insert OID = 4082 (	3580	pg_lsn_minmax_ops		PGNSP PGUID ));
 DATA(insert OID = 4104 (	3580	box_inclusion_ops		PGNSP PGUID ));
+DATA(insert OID = 4213 (	3580	integer_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4214 (	3580	float_bloom_ops			PGNSP PGUID ));
+DATA(insert OID = 4215 (	3580	text_bloom_ops			PGNSP PGUID ));
+DATA(insert OID = 4216 (	3580	datetime_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4217 (	3580	uuid_bloom_ops			PGNSP PGUID ));
+DATA(insert OID = 4218 (	3580	integer_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4219 (	3580	float_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4220 (	3580	datetime_minmax_multi_ops	PGNSP PGUID ));
 DATA(insert OID = 5000 (	4000	box_ops		PGNSP PGUID ));
 
 #endif   /* PG_OPFAMILY_H */
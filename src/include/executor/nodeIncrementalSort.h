@@ -0,0 +1,32 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.h
+ *
+ *
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/executor/nodeIncrementalSort.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef NODEINCREMENTALSORT_H
+#define NODEINCREMENTALSORT_H
+
+#include "nodes/execnodes.h"
+
+/*
+ * Minimum number of tuples sorted together.  Groups of equal presorted keys
+ * smaller than this are merged, so that the per-batch tuplesort overhead is
+ * spread over enough tuples.  The planner's costing relies on this too.
+ */
+#define INCREMENTAL_SORT_MIN_GROUP_SIZE 32
+
+extern IncrementalSortState *ExecInitIncrementalSort(IncrementalSort *node,
+						EState *estate, int eflags);
+extern TupleTableSlot *ExecIncrementalSort(IncrementalSortState *node);
+extern void ExecEndIncrementalSort(IncrementalSortState *node);
+extern void ExecReScanIncrementalSort(IncrementalSortState *node);
+
+#endif   /* NODEINCREMENTALSORT_H */
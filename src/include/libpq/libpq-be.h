@@ -127,6 +127,7 @@ typedef struct Port
 	int			remote_hostname_errcode;		/* see above */
 	char	   *remote_port;	/* text rep of remote port */
 	CAC_state	canAcceptConnections;	/* postmaster connection status */
+	bool		pooled;			/* client is a connection proxy? */
 
 	/*
 	 * Information that needs to be saved from the startup packet and passed
@@ -18,6 +18,7 @@
 #include "access/heapam.h"
 #include "access/tupconvert.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -365,6 +366,12 @@ typedef struct JunkFilter
  *		onConflictSetWhere		list of ON CONFLICT DO UPDATE exprs (qual)
  *		PartitionCheck			partition check expression
  *		PartitionCheckExpr		partition check expression state
+ *		BatchSize				max # of tuples inserted into a foreign table
+ *								in one batch; 1 if not batching
+ *		NumSlots				# of tuples currently queued in the batch
+ *		NumSlotsInitialized		# of batch slots created so far
+ *		Slots					tuples queued for a batched insert
+ *		PlanSlots				plan output tuples of the queued tuples
  * ----------------
  */
 typedef struct ResultRelInfo
@@ -392,6 +399,11 @@ typedef struct ResultRelInfo
 	List	   *ri_PartitionCheck;
 	ExprState  *ri_PartitionCheckExpr;
 	Relation	ri_PartitionRoot;
+	int			ri_BatchSize;
+	int			ri_NumSlots;
+	int			ri_NumSlotsInitialized;
+	TupleTableSlot **ri_Slots;
+	TupleTableSlot **ri_PlanSlots;
 } ResultRelInfo;
 
 /* ----------------
@@ -832,6 +844,8 @@ typedef struct PlanState
 	TupleTableSlot *ps_ResultTupleSlot; /* slot for my result tuples */
 	ExprContext *ps_ExprContext;	/* node's expression-evaluation context */
 	ProjectionInfo *ps_ProjInfo;	/* info for doing tuple projection */
+
+	bool		async_capable;	/* true if node is async-capable */
 } PlanState;
 
 /* ----------------
@@ -937,20 +951,68 @@ typedef struct ModifyTableState
 	TupleTableSlot *mt_partition_tuple_slot;
 } ModifyTableState;
 
+/* ----------------
+ *	 AsyncRequest
+ *
+ *		State for an asynchronous tuple request: the requestor (currently
+ *		always an Append) asks the requestee (an async-capable node, such as
+ *		a ForeignScan) for a tuple, and the requestee either completes the
+ *		request at once, or marks it as pending a callback once the data it
+ *		is waiting for has arrived.  See executor/execAsync.c.
+ * ----------------
+ */
+typedef struct AsyncRequest
+{
+	struct PlanState *requestor;	/* Node that wants a tuple */
+	struct PlanState *requestee;	/* Node from which a tuple is wanted */
+	int			request_index;	/* Scratch space for requestor */
+	bool		callback_pending;	/* Callback is needed */
+	bool		request_complete;	/* Request complete, result valid */
+	TupleTableSlot *result;		/* Result (NULL or an empty slot if no more
+								 * tuples) */
+} AsyncRequest;
+
 /* ----------------
  *	 AppendState information
  *
  *		nplans			how many plans are in the array
- *		whichplan		which plan is being executed (0 .. n-1)
+ *		whichplan		which plan is being executed (0 .. n-1), or
+ *						INVALID_SUBPLAN_INDEX if none has been chosen yet
+ *		pstate			shared state of a parallel-aware Append
+ *		choose_next_subplan	picks the next subplan to run
+ *
+ *		The async-capable subplans, if any, are not run by choosing them in
+ *		turn; they are all sent a request when the scan begins, and the
+ *		results are collected from whichever of them is ready, in between
+ *		running the synchronous subplans.
  * ----------------
  */
-typedef struct AppendState
+struct AppendState;
+typedef struct AppendState AppendState;
+struct ParallelAppendState;
+typedef struct ParallelAppendState ParallelAppendState;
+
+struct AppendState
 {
 	PlanState	ps;				/* its first field is NodeTag */
 	PlanState **appendplans;	/* array of PlanStates for my inputs */
 	int			as_nplans;
 	int			as_whichplan;
-} AppendState;
+	bool		as_begun;		/* false means need to initialize */
+	Bitmapset  *as_asyncplans;	/* asynchronous plans indexes */
+	int			as_nasyncplans; /* # of asynchronous plans */
+	AsyncRequest **as_asyncrequests;	/* array of AsyncRequests */
+	TupleTableSlot **as_asyncresults;	/* unreturned results of async plans */
+	int			as_nasyncresults;	/* # of valid entries in as_asyncresults */
+	bool		as_syncdone;	/* true if all synchronous plans done */
+	int			as_nasyncremain;	/* # of remaining asynchronous plans */
+	Bitmapset  *as_needrequest; /* asynchronous plans needing a new request */
+	struct WaitEventSet *as_eventset;	/* WaitEventSet used to configure
+										 * file descriptor wait events */
+	ParallelAppendState *as_pstate; /* parallel coordination info */
+	Size		pstate_len;		/* size of parallel coordination info */
+	bool		(*choose_next_subplan) (AppendState *);
+};
 
 /* ----------------
  *	 MergeAppendState information
@@ -1115,6 +1177,7 @@ typedef struct
  *		RuntimeContext	   expr context for evaling runtime Skeys
  *		RelationDesc	   index relation descriptor
  *		ScanDesc		   index scan descriptor
+ *		SkipPending		   must skip to next leading value (distinct scan)?
  *
  *		ReorderQueue	   tuples that need reordering due to re-check
  *		ReachedEnd		   have we fetched all tuples from index already?
@@ -1141,6 +1204,7 @@ typedef struct IndexScanState
 	ExprContext *iss_RuntimeContext;
 	Relation	iss_RelationDesc;
 	IndexScanDesc iss_ScanDesc;
+	bool		iss_SkipPending;
 
 	/* These are needed for re-checking ORDER BY expr ordering */
 	pairingheap *iss_ReorderQueue;
@@ -1167,6 +1231,7 @@ typedef struct IndexScanState
  *		RuntimeContext	   expr context for evaling runtime Skeys
  *		RelationDesc	   index relation descriptor
  *		ScanDesc		   index scan descriptor
+ *		SkipPending		   must skip to next leading value (distinct scan)?
  *		VMBuffer		   buffer in use for visibility map testing, if any
  *		HeapFetches		   number of tuples we were forced to fetch from heap
  *		ioss_PscanLen	   Size of parallel index-only scan descriptor
@@ -1186,6 +1251,7 @@ typedef struct IndexOnlyScanState
 	ExprContext *ioss_RuntimeContext;
 	Relation	ioss_RelationDesc;
 	IndexScanDesc ioss_ScanDesc;
+	bool		ioss_SkipPending;
 	Buffer		ioss_VMBuffer;
 	long		ioss_HeapFetches;
 	Size		ioss_PscanLen;
@@ -1676,6 +1742,62 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+struct MemoizeEntry;
+struct MemoizeTuple;
+
+/* ----------------
+ *	 MemoizeState information
+ *
+ *		memoize nodes are used to cache recent and commonly seen results
+ *		from a parameterized scan.  The cache is a hash table keyed by the
+ *		parameter values, bounded by work_mem, and evicts the least recently
+ *		used entries first; see nodeMemoize.c.
+ * ----------------
+ */
+typedef struct MemoizeState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			mstatus;		/* value of ExecMemoize state machine */
+	int			nkeys;			/* number of cache keys */
+	struct memoize_hash *hashtable; /* hash table for cache entries */
+	TupleDesc	hashkeydesc;	/* tuple descriptor for cache keys */
+	TupleTableSlot *tableslot;	/* min tuple slot for existing cache entries */
+	TupleTableSlot *probeslot;	/* virtual slot used for hash lookups */
+	List	   *param_exprs;	/* ExprStates for each cache key */
+	FmgrInfo   *hashfunctions;	/* lookup data for hash funcs nkeys in size */
+	FmgrInfo   *eqfunctions;	/* equality funcs for cache keys */
+	AttrNumber *keyColIdx;		/* key column numbers, 1 to nkeys */
+	MemoryContext tableContext; /* memory context to store cache data */
+	MemoryContext tempContext;	/* context for comparing cache keys */
+	dlist_head	lru_list;		/* least recently used entry list */
+	struct MemoizeTuple *last_tuple;	/* Used to point to the last tuple
+										 * returned during a cache hit and
+										 * the tuple we last stored when
+										 * populating the cache. */
+	struct MemoizeEntry *entry; /* the entry that 'last_tuple' belongs to or
+								 * NULL if 'last_tuple' is NULL. */
+	bool		singlerow;		/* true if the cache entry is to be marked as
+								 * complete after caching the first tuple. */
+	bool		binary_mode;	/* true when cache keys are compared by their
+								 * binary images rather than eqfunctions */
+	uint64		mem_used;		/* bytes of memory used by cache */
+	uint64		mem_limit;		/* memory limit in bytes for the cache */
+	Bitmapset  *keyparamids;	/* Param->paramids of expressions belonging to
+								 * param_exprs */
+	/* statistics for EXPLAIN ANALYZE */
+	uint64		cache_hits;		/* number of rescans where we've found the
+								 * scan parameter values to be cached */
+	uint64		cache_misses;	/* number of rescans where we've not found the
+								 * scan parameter values to be cached. */
+	uint64		cache_evictions;	/* number of cache entries removed due to
+									 * the need to free memory */
+	uint64		cache_overflows;	/* number of times we've had to bypass the
+									 * cache when filling it due to not being
+									 * able to free enough space to store the
+									 * current scan's tuples. */
+	uint64		mem_peak;		/* peak memory usage in bytes */
+} MemoizeState;
+
 /* ----------------
  *	 SortState information
  * ----------------
@@ -1692,6 +1814,33 @@ typedef struct SortState
 	void	   *tuplesortstate; /* private state of tuplesort.c */
 } SortState;
 
+/* ----------------
+ *	 IncrementalSortState information
+ *
+ *		The input arrives sorted by the first presortedCols sort keys.  We
+ *		gather a batch of at least INCREMENTAL_SORT_MIN_GROUP_SIZE tuples,
+ *		extended to the end of the group of equal presorted keys it stops
+ *		in, sort the batch with a fresh tuplesort, return it, and repeat.
+ * ----------------
+ */
+typedef struct IncrementalSortState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	bool		bounded;		/* is the result set bounded? */
+	int64		bound;			/* if bounded, how many tuples are needed */
+	int64		bound_Done;		/* number of tuples already returned */
+	bool		finished;		/* have we read all the input? */
+	FmgrInfo   *eqfunctions;	/* equality fns for the presorted keys */
+	TupleTableSlot *group_pivot;	/* last tuple read, used to find the
+									 * end of the current batch, or the
+									 * first tuple of the next batch */
+	void	   *tuplesortstate; /* tuplesort.c state for the current batch */
+	int64		groupsCount;	/* number of batches sorted */
+	long		maxSpaceUsed;	/* largest space used by any batch */
+	const char *sortMethod;		/* method used by that batch */
+	const char *spaceType;		/* and where it was sorted */
+} IncrementalSortState;
+
 /* ---------------------
  *	GroupState information
  * ---------------------
@@ -125,6 +125,11 @@ typedef struct Plan
 	 */
 	bool		parallel_aware; /* engage parallel-aware logic? */
 
+	/*
+	 * information needed for asynchronous execution
+	 */
+	bool		async_capable;	/* engage asynchronous-capable logic? */
+
 	/*
 	 * Common structural data for all Plan types.
 	 */
@@ -235,6 +240,7 @@ typedef struct Append
 	/* RT indexes of non-leaf tables in a partition tree */
 	List	   *partitioned_rels;
 	List	   *appendplans;
+	int			first_partial_plan; /* see AppendPath.first_partial_path */
 } Append;
 
 /* ----------------
@@ -368,6 +374,11 @@ typedef struct SampleScan
  *
  * indexorderdir specifies the scan ordering, for indexscans on amcanorder
  * indexes (for other indexes it should be "don't care").
+ *
+ * indexskip requests a skip scan, which the index AM performs as a separate
+ * scan for each distinct value of the index's first column.  If indexdistinct
+ * is also set, we ask the AM to skip to the next value as soon as we return
+ * a row, so that we produce just one row per value.
  * ----------------
  */
 typedef struct IndexScan
@@ -380,6 +391,8 @@ typedef struct IndexScan
 	List	   *indexorderbyorig;		/* the same in original form */
 	List	   *indexorderbyops;	/* OIDs of sort ops for ORDER BY exprs */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskip;		/* skip scan over first column's values? */
+	bool		indexdistinct;	/* only one row per first column value? */
 } IndexScan;
 
 /* ----------------
@@ -407,6 +420,8 @@ typedef struct IndexOnlyScan
 	List	   *indexorderby;	/* list of index ORDER BY exprs */
 	List	   *indextlist;		/* TargetEntry list describing index's cols */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskip;		/* skip scan over first column's values? */
+	bool		indexdistinct;	/* only one row per first column value? */
 } IndexOnlyScan;
 
 /* ----------------
@@ -716,6 +731,28 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		memoize node
+ *
+ * Caches the rows returned by a parameterized subplan, keyed by the values
+ * of param_exprs, so that rescans with a set of parameter values seen
+ * before can be answered without running the subplan again.
+ * ----------------
+ */
+typedef struct Memoize
+{
+	Plan		plan;
+	int			numKeys;		/* size of the two arrays below */
+	Oid		   *hashOperators;	/* hash operators for each key */
+	List	   *param_exprs;	/* cache keys in the form of exprs containing
+								 * parameters */
+	bool		singlerow;		/* true if the cache entry is to be marked as
+								 * complete after caching the first record. */
+	bool		binary_mode;	/* true when cache keys are compared by their
+								 * binary images rather than hashOperators */
+	uint32		est_entries;	/* estimated number of cache entries, or 0 */
+} Memoize;
+
 /* ----------------
  *		sort node
  * ----------------
@@ -730,6 +767,19 @@ typedef struct Sort
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
 } Sort;
 
+/* ----------------
+ *		incremental sort node
+ *
+ * The input is already sorted by the first presortedCols sort columns, so
+ * only tuples with equal values of those need to be sorted together.
+ * ----------------
+ */
+typedef struct IncrementalSort
+{
+	Sort		sort;
+	int			presortedCols;	/* number of presorted columns */
+} IncrementalSort;
+
 /* ---------------
  *	 group node -
  *		Used for queries with GROUP BY (but no aggregates) specified.
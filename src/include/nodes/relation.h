@@ -258,6 +258,9 @@ typedef struct PlannerInfo
 
 	List	   *fkey_list;		/* list of ForeignKeyOptInfos */
 
+	List	   *part_schemes;	/* Canonicalised partition schemes used in the
+								 * query. */
+
 	List	   *query_pathkeys; /* desired pathkeys for query_planner() */
 
 	List	   *group_pathkeys; /* groupClause pathkeys, if any */
@@ -473,6 +476,19 @@ typedef struct PlannerInfo
  * We store baserestrictcost in the RelOptInfo (for base relations) because
  * we know we will need it at least once (to price the sequential scan)
  * and may need it multiple times to price index scans.
+ *
+ * If the relation is partitioned, these fields will be set:
+ *
+ *		part_scheme - Partitioning scheme of the relation
+ *		nparts - Number of partitions
+ *		boundinfo - Partition bounds
+ *		part_rels - RelOptInfos for each partition, in bound order
+ *		partexprs - Partition key expressions, one list per key column
+ *
+ * For a partitioned join relation, partexprs[i] may hold several equivalent
+ * expressions (one from each side of an inner join).  A join rel is only
+ * marked partitioned once it has been planned partition-wise; its part_rels
+ * are then "other" join rels of kind RELOPT_OTHER_JOINREL.
  *----------
  */
 typedef enum RelOptKind
@@ -480,6 +496,7 @@ typedef enum RelOptKind
 	RELOPT_BASEREL,
 	RELOPT_JOINREL,
 	RELOPT_OTHER_MEMBER_REL,
+	RELOPT_OTHER_JOINREL,
 	RELOPT_UPPER_REL,
 	RELOPT_DEADREL
 } RelOptKind;
@@ -493,13 +510,41 @@ typedef enum RelOptKind
 	 (rel)->reloptkind == RELOPT_OTHER_MEMBER_REL)
 
 /* Is the given relation a join relation? */
-#define IS_JOIN_REL(rel) ((rel)->reloptkind == RELOPT_JOINREL)
+#define IS_JOIN_REL(rel)	\
+	((rel)->reloptkind == RELOPT_JOINREL || \
+	 (rel)->reloptkind == RELOPT_OTHER_JOINREL)
 
 /* Is the given relation an upper relation? */
 #define IS_UPPER_REL(rel) ((rel)->reloptkind == RELOPT_UPPER_REL)
 
 /* Is the given relation an "other" relation? */
-#define IS_OTHER_REL(rel) ((rel)->reloptkind == RELOPT_OTHER_MEMBER_REL)
+#define IS_OTHER_REL(rel) \
+	((rel)->reloptkind == RELOPT_OTHER_MEMBER_REL || \
+	 (rel)->reloptkind == RELOPT_OTHER_JOINREL)
+
+/*
+ * Partitioning scheme
+ *
+ * Relations partitioned the same way share a single PartitionSchemeData,
+ * canonicalised in PlannerInfo.part_schemes, so that two rels can be checked
+ * for a compatible partitioning scheme by simple pointer comparison.  Only
+ * the properties of the partition key that matter for matching bounds and
+ * join clauses are kept here.
+ */
+typedef struct PartitionSchemeData
+{
+	char		strategy;		/* partition strategy */
+	int16		partnatts;		/* number of partition attributes */
+	Oid		   *partopfamily;	/* OIDs of operator families */
+	Oid		   *partopcintype;	/* OIDs of opclass declared input data types */
+	Oid		   *partcollation;	/* OIDs of partitioning collations */
+
+	/* Cached information about partition key data types. */
+	int16	   *parttyplen;
+	bool	   *parttypbyval;
+} PartitionSchemeData;
+
+typedef struct PartitionSchemeData *PartitionScheme;
 
 typedef struct RelOptInfo
 {
@@ -574,8 +619,28 @@ typedef struct RelOptInfo
 
 	/* used by "other" relations. */
 	Relids		top_parent_relids;		/* Relids of topmost parents. */
+
+	/* used for partitioned relations */
+	PartitionScheme part_scheme;	/* Partitioning scheme. */
+	int			nparts;			/* number of partitions */
+	struct PartitionBoundInfoData *boundinfo;	/* Partition bounds */
+	struct RelOptInfo **part_rels;	/* Array of RelOptInfos of partitions,
+									 * stored in the same order of bounds */
+	List	  **partexprs;		/* Partition key expressions. */
 } RelOptInfo;
 
+/*
+ * Is given relation partitioned?
+ *
+ * A join between two partitioned relations with same partitioning scheme
+ * without any matching partitions will not have any partition in it but will
+ * have partition scheme set. So a relation is deemed to be partitioned if it
+ * has a partitioning scheme, bounds and positive number of partitions.
+ */
+#define IS_PARTITIONED_REL(rel) \
+	((rel)->part_scheme && (rel)->boundinfo && (rel)->nparts > 0 && \
+	 (rel)->part_rels && !IS_DUMMY_REL(rel))
+
 /*
  * IndexOptInfo
  *		Per-index information for planning/optimization
@@ -655,6 +720,7 @@ typedef struct IndexOptInfo
 	bool		amhasgettuple;	/* does AM have amgettuple interface? */
 	bool		amhasgetbitmap; /* does AM have amgetbitmap interface? */
 	bool		amcanparallel;	/* does AM support parallel scan? */
+	bool		amcanskip;		/* does AM have amskip interface? */
 	/* Rather than include amapi.h here, we declare amcostestimate like this */
 	void		(*amcostestimate) ();	/* AM's cost estimator */
 } IndexOptInfo;
@@ -1003,6 +1069,12 @@ typedef struct Path
  * NoMovementScanDirection for an indexscan, but the planner wants to
  * distinguish ordered from unordered indexes for building pathkeys.)
  *
+ * 'indexskip' is true for a skip scan, which scans the index once for each
+ * distinct value of its first column, so that quals on the later columns
+ * can bound each of those scans even though the first column has no qual.
+ * If 'indexdistinct' is also true, only the first row found for each value
+ * is returned; such paths exist only for "SELECT DISTINCT" of that column.
+ *
  * 'indextotalcost' and 'indexselectivity' are saved in the IndexPath so that
  * we need not recompute them when considering using the same index in a
  * bitmap index/heap scan (see BitmapHeapPath).  The costs of the IndexPath
@@ -1019,6 +1091,8 @@ typedef struct IndexPath
 	List	   *indexorderbys;
 	List	   *indexorderbycols;
 	ScanDirection indexscandir;
+	bool		indexskip;
+	bool		indexdistinct;
 	Cost		indextotalcost;
 	Selectivity indexselectivity;
 } IndexPath;
@@ -1155,6 +1229,11 @@ typedef struct CustomPath
  * elements.  These cases are optimized during create_append_plan.
  * In particular, an AppendPath with no subpaths is a "dummy" path that
  * is created to represent the case that a relation is provably empty.
+ *
+ * A parallel-aware AppendPath (path.parallel_aware) lets its participants
+ * share out the subpaths; subpaths before first_partial_path are non-partial
+ * and are each run by only one participant, the rest are partial paths that
+ * any number of participants may join.
  */
 typedef struct AppendPath
 {
@@ -1162,6 +1241,7 @@ typedef struct AppendPath
 	/* RT indexes of non-leaf tables in a partition tree */
 	List	   *partitioned_rels;
 	List	   *subpaths;		/* list of component Paths */
+	int			first_partial_path; /* index of first partial subpath */
 } AppendPath;
 
 #define IS_DUMMY_PATH(p) \
@@ -1210,6 +1290,28 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * MemoizePath represents a Memoize plan node, i.e., a cache of the rows
+ * returned by a parameterized subpath, keyed by the parameter values.  It is
+ * placed above the inner side of a parameterized nested loop, where it saves
+ * rescanning the subpath for outer rows with previously seen key values.
+ */
+typedef struct MemoizePath
+{
+	Path		path;
+	Path	   *subpath;		/* outerpath to cache tuples from */
+	List	   *hash_operators; /* hash operators for each key */
+	List	   *param_exprs;	/* cache keys */
+	bool		singlerow;		/* true if the cache entry is to be marked as
+								 * complete after caching the first record. */
+	bool		binary_mode;	/* true when cache keys are compared by their
+								 * binary images rather than hash_operators */
+	double		calls;			/* expected number of rescans */
+	uint32		est_entries;	/* The maximum number of entries that the
+								 * planner expects will fit in the cache, or 0
+								 * if unknown */
+} MemoizePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
@@ -1391,6 +1493,16 @@ typedef struct SortPath
 	Path	   *subpath;		/* path representing input source */
 } SortPath;
 
+/*
+ * IncrementalSortPath represents a sort step whose input is already sorted
+ * by the first nPresortedCols of the path's pathkeys
+ */
+typedef struct IncrementalSortPath
+{
+	SortPath	spath;
+	int			nPresortedCols; /* number of presorted columns */
+} IncrementalSortPath;
+
 /*
  * GroupPath represents grouping (of presorted input)
  *
@@ -2155,6 +2267,25 @@ typedef struct JoinPathExtraData
 	Relids		param_source_rels;
 } JoinPathExtraData;
 
+/*
+ * Struct for extra information passed to GetForeignUpperPaths when it is
+ * called for grouping (UPPERREL_GROUP_AGG)
+ *
+ * target is the PathTarget the grouping paths must compute
+ * havingQual is the (implicitly-ANDed) HAVING qual the paths must apply
+ * partial is true if the paths are to compute partial aggregates only, to be
+ *		combined by a Finalize Aggregate above them; then havingQual is NIL
+ *
+ * When grouping a single partition in partition-wise aggregation, target and
+ * havingQual are translated to refer to the partition.
+ */
+typedef struct GroupPathExtraData
+{
+	PathTarget *target;
+	List	   *havingQual;
+	bool		partial;
+} GroupPathExtraData;
+
 /*
  * For speed reasons, cost estimation for join paths is performed in two
  * phases: the first phase tries to quickly derive a lower bound for the
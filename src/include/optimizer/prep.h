@@ -55,6 +55,13 @@ extern void expand_inherited_tables(PlannerInfo *root);
 extern Node *adjust_appendrel_attrs(PlannerInfo *root, Node *node,
 					   AppendRelInfo *appinfo);
 
+extern Node *adjust_appendrel_attrs_list(PlannerInfo *root, Node *node,
+							List *appinfos);
+
+extern Relids adjust_child_relids(Relids relids, List *appinfos);
+
+extern List *find_appinfos_by_relids(PlannerInfo *root, Relids relids);
+
 extern Node *adjust_appendrel_attrs_multilevel(PlannerInfo *root, Node *node,
 								  RelOptInfo *child_rel);
 
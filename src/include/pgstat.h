@@ -1,7 +1,7 @@
 /* ----------
  *	pgstat.h
  *
- *	Definitions for the PostgreSQL statistics collector daemon.
+ *	Definitions for the PostgreSQL cumulative statistics system.
  *
  *	Copyright (c) 2001-2017, PostgreSQL Global Development Group
  *
@@ -42,13 +42,11 @@ typedef enum TrackFunctionsLevel
 }	TrackFunctionsLevel;
 
 /* ----------
- * The types of backend -> collector messages
+ * The types of messages that processes apply to the shared statistics
  * ----------
  */
 typedef enum StatMsgType
 {
-	PGSTAT_MTYPE_DUMMY,
-	PGSTAT_MTYPE_INQUIRY,
 	PGSTAT_MTYPE_TABSTAT,
 	PGSTAT_MTYPE_TABPURGE,
 	PGSTAT_MTYPE_DROPDB,
@@ -197,54 +195,15 @@ typedef struct PgStat_MsgHdr
 } PgStat_MsgHdr;
 
 /* ----------
- * Space available in a message.  This will keep the UDP packets below 1K,
- * which should fit unfragmented into the MTU of the loopback interface.
- * (Larger values of PGSTAT_MAX_MSG_SIZE would work for that on most
- * platforms, but we're being conservative here.)
+ * Space available in a message.  Messages are applied directly to shared
+ * memory by the reporting process; the size limit just bounds how much work
+ * is done per batch of per-table or per-function counts.
  * ----------
  */
 #define PGSTAT_MAX_MSG_SIZE 1000
 #define PGSTAT_MSG_PAYLOAD	(PGSTAT_MAX_MSG_SIZE - sizeof(PgStat_MsgHdr))
 
 
-/* ----------
- * PgStat_MsgDummy				A dummy message, ignored by the collector
- * ----------
- */
-typedef struct PgStat_MsgDummy
-{
-	PgStat_MsgHdr m_hdr;
-} PgStat_MsgDummy;
-
-
-/* ----------
- * PgStat_MsgInquiry			Sent by a backend to ask the collector
- *								to write the stats file(s).
- *
- * Ordinarily, an inquiry message prompts writing of the global stats file,
- * the stats file for shared catalogs, and the stats file for the specified
- * database.  If databaseid is InvalidOid, only the first two are written.
- *
- * New file(s) will be written only if the existing file has a timestamp
- * older than the specified cutoff_time; this prevents duplicated effort
- * when multiple requests arrive at nearly the same time, assuming that
- * backends send requests with cutoff_times a little bit in the past.
- *
- * clock_time should be the requestor's current local time; the collector
- * uses this to check for the system clock going backward, but it has no
- * effect unless that occurs.  We assume clock_time >= cutoff_time, though.
- * ----------
- */
-
-typedef struct PgStat_MsgInquiry
-{
-	PgStat_MsgHdr m_hdr;
-	TimestampTz clock_time;		/* observed local clock time */
-	TimestampTz cutoff_time;	/* minimum acceptable file timestamp */
-	Oid			databaseid;		/* requested DB (InvalidOid => shared only) */
-} PgStat_MsgInquiry;
-
-
 /* ----------
  * PgStat_TableEntry			Per-table info in a MsgTabstat
  * ----------
@@ -278,7 +237,7 @@ typedef struct PgStat_MsgTabstat
 
 
 /* ----------
- * PgStat_MsgTabpurge			Sent by the backend to tell the collector
+ * PgStat_MsgTabpurge			Sent by the backend to tell the stats system
  *								about dead tables.
  * ----------
  */
@@ -296,7 +255,7 @@ typedef struct PgStat_MsgTabpurge
 
 
 /* ----------
- * PgStat_MsgDropdb				Sent by the backend to tell the collector
+ * PgStat_MsgDropdb				Sent by the backend to tell the stats system
  *								about a dropped database
  * ----------
  */
@@ -308,7 +267,7 @@ typedef struct PgStat_MsgDropdb
 
 
 /* ----------
- * PgStat_MsgResetcounter		Sent by the backend to tell the collector
+ * PgStat_MsgResetcounter		Sent by the backend to tell the stats system
  *								to reset counters
  * ----------
  */
@@ -319,7 +278,7 @@ typedef struct PgStat_MsgResetcounter
 } PgStat_MsgResetcounter;
 
 /* ----------
- * PgStat_MsgResetsharedcounter Sent by the backend to tell the collector
+ * PgStat_MsgResetsharedcounter Sent by the backend to tell the stats system
  *								to reset a shared counter
  * ----------
  */
@@ -330,7 +289,7 @@ typedef struct PgStat_MsgResetsharedcounter
 } PgStat_MsgResetsharedcounter;
 
 /* ----------
- * PgStat_MsgResetsinglecounter Sent by the backend to tell the collector
+ * PgStat_MsgResetsinglecounter Sent by the backend to tell the stats system
  *								to reset a single counter
  * ----------
  */
@@ -453,7 +412,7 @@ typedef struct PgStat_MsgTempFile
  * it against zeroes to detect whether there are any counts to transmit.
  *
  * Note that the time counters are in instr_time format here.  We convert to
- * microseconds in PgStat_Counter format when transmitting to the collector.
+ * microseconds in PgStat_Counter format when applying them to shared stats.
  * ----------
  */
 typedef struct PgStat_FunctionCounts
@@ -503,7 +462,7 @@ typedef struct PgStat_MsgFuncstat
 } PgStat_MsgFuncstat;
 
 /* ----------
- * PgStat_MsgFuncpurge			Sent by the backend to tell the collector
+ * PgStat_MsgFuncpurge			Sent by the backend to tell the stats system
  *								about dead functions.
  * ----------
  */
@@ -520,7 +479,7 @@ typedef struct PgStat_MsgFuncpurge
 } PgStat_MsgFuncpurge;
 
 /* ----------
- * PgStat_MsgDeadlock			Sent by the backend to tell the collector
+ * PgStat_MsgDeadlock			Sent by the backend to tell the stats system
  *								about a deadlock that occurred.
  * ----------
  */
@@ -531,45 +490,18 @@ typedef struct PgStat_MsgDeadlock
 } PgStat_MsgDeadlock;
 
 
-/* ----------
- * PgStat_Msg					Union over all possible messages.
- * ----------
- */
-typedef union PgStat_Msg
-{
-	PgStat_MsgHdr msg_hdr;
-	PgStat_MsgDummy msg_dummy;
-	PgStat_MsgInquiry msg_inquiry;
-	PgStat_MsgTabstat msg_tabstat;
-	PgStat_MsgTabpurge msg_tabpurge;
-	PgStat_MsgDropdb msg_dropdb;
-	PgStat_MsgResetcounter msg_resetcounter;
-	PgStat_MsgResetsharedcounter msg_resetsharedcounter;
-	PgStat_MsgResetsinglecounter msg_resetsinglecounter;
-	PgStat_MsgAutovacStart msg_autovacuum;
-	PgStat_MsgVacuum msg_vacuum;
-	PgStat_MsgAnalyze msg_analyze;
-	PgStat_MsgArchiver msg_archiver;
-	PgStat_MsgBgWriter msg_bgwriter;
-	PgStat_MsgFuncstat msg_funcstat;
-	PgStat_MsgFuncpurge msg_funcpurge;
-	PgStat_MsgRecoveryConflict msg_recoveryconflict;
-	PgStat_MsgDeadlock msg_deadlock;
-} PgStat_Msg;
-
-
 /* ------------------------------------------------------------
- * Statistic collector data structures follow
+ * Shared statistics data structures follow
  *
  * PGSTAT_FILE_FORMAT_ID should be changed whenever any of these
  * data structures change.
  * ------------------------------------------------------------
  */
 
-#define PGSTAT_FILE_FORMAT_ID	0x01A5BC9D
+#define PGSTAT_FILE_FORMAT_ID	0x01A5BC9E
 
 /* ----------
- * PgStat_StatDBEntry			The collector's data per database
+ * PgStat_StatDBEntry			The shared data per database
  * ----------
  */
 typedef struct PgStat_StatDBEntry
@@ -609,7 +541,7 @@ typedef struct PgStat_StatDBEntry
 
 
 /* ----------
- * PgStat_StatTabEntry			The collector's data per table (or index)
+ * PgStat_StatTabEntry			The shared data per table (or index)
  * ----------
  */
 typedef struct PgStat_StatTabEntry
@@ -645,7 +577,7 @@ typedef struct PgStat_StatTabEntry
 
 
 /* ----------
- * PgStat_StatFuncEntry			The collector's data per function
+ * PgStat_StatFuncEntry			The shared data per function
  * ----------
  */
 typedef struct PgStat_StatFuncEntry
@@ -660,7 +592,7 @@ typedef struct PgStat_StatFuncEntry
 
 
 /*
- * Archiver statistics kept in the stats collector
+ * Archiver statistics kept in shared memory
  */
 typedef struct PgStat_ArchiverStats
 {
@@ -676,7 +608,7 @@ typedef struct PgStat_ArchiverStats
 } PgStat_ArchiverStats;
 
 /*
- * Global statistics kept in the stats collector
+ * Global statistics kept in shared memory
  */
 typedef struct PgStat_GlobalStats
 {
@@ -759,7 +691,7 @@ typedef enum
 	WAIT_EVENT_BGWRITER_HIBERNATE,
 	WAIT_EVENT_BGWRITER_MAIN,
 	WAIT_EVENT_CHECKPOINTER_MAIN,
-	WAIT_EVENT_PGSTAT_MAIN,
+	WAIT_EVENT_PROXY_MAIN,
 	WAIT_EVENT_RECOVERY_WAL_ALL,
 	WAIT_EVENT_RECOVERY_WAL_STREAM,
 	WAIT_EVENT_SYSLOGGER_MAIN,
@@ -798,7 +730,8 @@ typedef enum
  */
 typedef enum
 {
-	WAIT_EVENT_BGWORKER_SHUTDOWN = PG_WAIT_IPC,
+	WAIT_EVENT_APPEND_READY = PG_WAIT_IPC,
+	WAIT_EVENT_BGWORKER_SHUTDOWN,
 	WAIT_EVENT_BGWORKER_STARTUP,
 	WAIT_EVENT_BTREE_PAGE,
 	WAIT_EVENT_EXECUTE_GATHER,
@@ -808,6 +741,8 @@ typedef enum
 	WAIT_EVENT_MQ_SEND,
 	WAIT_EVENT_PARALLEL_FINISH,
 	WAIT_EVENT_PARALLEL_BITMAP_SCAN,
+	WAIT_EVENT_PARALLEL_COPY_CHUNK_FREE,
+	WAIT_EVENT_PARALLEL_COPY_CHUNK_READY,
 	WAIT_EVENT_SAFE_SNAPSHOT,
 	WAIT_EVENT_SYNC_REP,
 	WAIT_EVENT_LOGICAL_SYNC_DATA,
@@ -944,8 +879,8 @@ typedef struct PgBackendSSLStatus
  *
  * Each live backend maintains a PgBackendStatus struct in shared memory
  * showing its current activity.  (The structs are allocated according to
- * BackendId, but that is not critical.)  Note that the collector process
- * has no involvement in, or even access to, these structs.
+ * BackendId, but that is not critical.)  These structs are separate from
+ * the cumulative statistics kept in the shared hash tables.
  *
  * Each auxiliary process also maintains a PgBackendStatus struct in shared
  * memory.
@@ -1106,8 +1041,6 @@ extern bool pgstat_track_counts;
 extern int	pgstat_track_functions;
 extern PGDLLIMPORT int pgstat_track_activity_query_size;
 extern char *pgstat_stat_directory;
-extern char *pgstat_stat_tmpname;
-extern char *pgstat_stat_filename;
 
 /*
  * BgWriter statistics counters are updated directly by bgwriter and bufmgr
@@ -1127,22 +1060,27 @@ extern PgStat_Counter pgStatBlockWriteTime;
 extern Size BackendStatusShmemSize(void);
 extern void CreateSharedBackendStatus(void);
 
-extern void pgstat_init(void);
-extern int	pgstat_start(void);
-extern void pgstat_reset_all(void);
-extern void allow_immediate_pgstat_restart(void);
+/* opaque; exposed only so the postmaster can pass it to EXEC_BACKEND children */
+typedef struct PgStat_ShmemControl PgStat_ShmemControl;
 
-#ifdef EXEC_BACKEND
-extern void PgstatCollectorMain(int argc, char *argv[]) pg_attribute_noreturn();
-#endif
+extern Size PgStatShmemSize(void);
+extern void PgStatShmemInit(void);
 
 
 /* ----------
- * Functions called from backends
+ * Functions called at startup and shutdown
  * ----------
  */
-extern void pgstat_ping(void);
+extern void pgstat_reset_all(void);
+extern void pgstat_restore_stats(void);
+extern void pgstat_save_stats(void);
+extern void pgstat_before_server_shutdown(int code, Datum arg);
+
 
+/* ----------
+ * Functions called from backends
+ * ----------
+ */
 extern void pgstat_report_stat(bool force);
 extern void pgstat_vacuum_stat(void);
 extern void pgstat_drop_database(Oid databaseid);
@@ -1316,6 +1254,8 @@ extern void pgstat_send_bgwriter(void);
  */
 extern PgStat_StatDBEntry *pgstat_fetch_stat_dbentry(Oid dbid);
 extern PgStat_StatTabEntry *pgstat_fetch_stat_tabentry(Oid relid);
+extern PgStat_StatTabEntry *pgstat_fetch_stat_tabentry_ext(bool shared,
+							   Oid relid);
 extern PgBackendStatus *pgstat_fetch_stat_beentry(int beid);
 extern LocalPgBackendStatus *pgstat_fetch_stat_local_beentry(int beid);
 extern PgStat_StatFuncEntry *pgstat_fetch_stat_funcentry(Oid funcid);
@@ -0,0 +1,77 @@
+/*-------------------------------------------------------------------------
+ *
+ * proxy.h
+ *	  Exports from postmaster/proxy.c.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/postmaster/proxy.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _PROXY_H
+#define _PROXY_H
+
+/*
+ * Connection proxies pass sockets between processes with SCM_RIGHTS, and
+ * rely on inheriting them from the postmaster across fork(), so they are
+ * only available where both work.
+ */
+#if defined(HAVE_UNIX_SOCKETS) && !defined(EXEC_BACKEND)
+#define USE_CONNECTION_PROXIES
+#endif
+
+#define MAX_CONNECTION_PROXIES	64
+
+/*
+ * Messages exchanged between a connection proxy and its pooled backends, in
+ * addition to the regular frontend/backend protocol.  The proxy sends
+ * PROXY_MSG_NEW_SESSION ahead of each client it hands to a backend for
+ * authentication; the backend sends PROXY_MSG_SESSION_STATE before every
+ * ReadyForQuery outside a transaction block, saying whether the session
+ * can be moved to another backend ('F') or not ('S').
+ *
+ * These share the stream with the client's own messages, so the proxy
+ * refuses them from clients, and PROXY_MSG_NEW_SESSION carries the cancel
+ * key the backend reported at startup.  The proxy never passes that key on
+ * to clients, so the backend knows the message came from the proxy.
+ */
+#define PROXY_MSG_NEW_SESSION		'A'
+#define PROXY_MSG_SESSION_STATE		'P'
+
+/*
+ * Datagrams exchanged between the postmaster and a connection proxy over
+ * their socket pair.  A socket travels along with PROXY_REQ_CLIENT (a new
+ * client, to the proxy) and PROXY_REQ_BACKEND (the client end of a new
+ * pooled backend's connection, to the postmaster).  PROXY_REQ_CANCEL
+ * carries a cancel request for another proxy's client.
+ */
+#define PROXY_REQ_CLIENT	'C'
+#define PROXY_REQ_BACKEND	'B'
+#define PROXY_REQ_CANCEL	'K'
+
+typedef struct ProxyRequest
+{
+	char		type;			/* one of the PROXY_REQ_* codes */
+	int32		pid;			/* target of a cancel request */
+	int32		key;			/* cancel key */
+} ProxyRequest;
+
+/* GUC options */
+extern int	ConnectionProxiesNumber;
+extern int	ProxyPortNumber;
+extern int	SessionPoolSize;
+extern int	MaxSessions;
+
+#ifdef USE_CONNECTION_PROXIES
+extern bool ProxySendRequest(pgsocket chan, const ProxyRequest *req,
+				 pgsocket sock);
+extern bool ProxyReceiveRequest(pgsocket chan, ProxyRequest *req,
+					pgsocket *sock);
+
+/* Functions called from postmaster */
+extern int	ConnectionProxyStart(int id, pgsocket chan);
+#endif
+
+#endif   /* _PROXY_H */
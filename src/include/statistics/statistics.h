@@ -77,8 +77,44 @@ typedef struct MVDependencies
 /* size of the struct excluding the deps array */
 #define SizeOfDependencies	(offsetof(MVDependencies, ndeps) + sizeof(uint32))
 
+#define STATS_MCV_MAGIC			0xE1A651C2		/* marks serialized bytea */
+#define STATS_MCV_TYPE_BASIC	1		/* basic MCV list type */
+
+/* max number of items in a MCV list (same as the max statistics target) */
+#define STATS_MCVLIST_MAX_ITEMS	10000
+
+/*
+ * Multi-column MCV (most common values) list item, i.e. a combination of
+ * values in the columns covered by the statistics, with its frequency.
+ */
+typedef struct MCVItem
+{
+	double		frequency;		/* frequency of this combination */
+	double		base_frequency;	/* frequency if the columns were independent */
+	bool	   *isnull;			/* NULL flags, one per dimension */
+	Datum	   *values;			/* item values, one per dimension */
+} MCVItem;
+
+/* size of the serialized item excluding the values */
+#define SizeOfMCVItem(ndims)	(2 * sizeof(double) + (ndims) * sizeof(bool))
+
+typedef struct MCVList
+{
+	uint32		magic;			/* magic constant marker */
+	uint32		type;			/* type of MCV list (BASIC) */
+	uint32		nitems;			/* number of MCV items in the list */
+	AttrNumber	ndimensions;	/* number of dimensions */
+	Oid			types[STATS_MAX_DIMENSIONS];	/* OIDs of data types */
+	MCVItem    *items[FLEXIBLE_ARRAY_MEMBER];	/* MCV items */
+} MCVList;
+
+/* size of the serialized header (excluding the types and items) */
+#define SizeOfMCVList \
+	(offsetof(MCVList, ndimensions) + sizeof(AttrNumber))
+
 extern MVNDistinct *statext_ndistinct_load(Oid mvoid);
 extern MVDependencies *staext_dependencies_load(Oid mvoid);
+extern MCVList *statext_mcv_load(Oid mvoid);
 
 extern void BuildRelationExtStatistics(Relation onerel, double totalrows,
 						   int numrows, HeapTuple *rows,
@@ -91,6 +127,13 @@ extern Selectivity dependencies_clauselist_selectivity(PlannerInfo *root,
 									SpecialJoinInfo *sjinfo,
 									RelOptInfo *rel,
 									Bitmapset **estimatedclauses);
+extern Selectivity mcv_clauselist_selectivity(PlannerInfo *root,
+						   List *clauses,
+						   int varRelid,
+						   JoinType jointype,
+						   SpecialJoinInfo *sjinfo,
+						   RelOptInfo *rel,
+						   Bitmapset **estimatedclauses);
 extern bool has_stats_of_kind(List *stats, char requiredkind);
 extern StatisticExtInfo *choose_best_statistics(List *stats,
 					   Bitmapset *attnums, char requiredkind);
@@ -213,6 +213,13 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_PREDICATE_LOCK_MANAGER,
 	LWTRANCHE_PARALLEL_QUERY_DSA,
 	LWTRANCHE_TBM,
+	LWTRANCHE_PARALLEL_APPEND,
+	LWTRANCHE_STATS_DSA,
+	LWTRANCHE_STATS_HASH,
+	LWTRANCHE_SHARED_PLAN_DSA,
+	LWTRANCHE_SHARED_PLAN_HASH,
+	LWTRANCHE_SHARED_CATCACHE_DSA,
+	LWTRANCHE_SHARED_CATCACHE_HASH,
 	LWTRANCHE_FIRST_USER_DEFINED
 }	BuiltinTrancheIds;
 
@@ -54,6 +54,14 @@ typedef struct catcache
 	dlist_head	cc_lists;		/* list of CatCList structs */
 	dlist_head *cc_bucket;		/* hash buckets */
 
+	/* space accounting and statistics, see pg_get_catalog_cache_stats */
+	int			cc_nnegative;	/* # of negative entries currently in cache */
+	Size		cc_size;		/* space used by this cache's tuples */
+	uint64		cc_nhits;		/* # of searches finding a positive entry */
+	uint64		cc_nneg_hits;	/* # of searches finding a negative entry */
+	uint64		cc_nmisses;		/* # of searches that read the catalog */
+	uint64		cc_nevictions;	/* # of entries evicted to save space */
+
 	/*
 	 * Keep these at the end, so that compiling catcache.c with CATCACHE_STATS
 	 * doesn't break ABI for other modules
@@ -88,6 +96,13 @@ typedef struct catctup
 	 */
 	dlist_node	cache_elem;		/* list member of per-bucket list */
 
+	/*
+	 * Each tuple is also a member of a list of all tuples in all caches, in
+	 * LRU order, from which entries are evicted to keep within
+	 * catalog_cache_memory_target.
+	 */
+	dlist_node	lru_elem;		/* list member of global LRU list */
+
 	/*
 	 * The tuple may also be a member of at most one CatCList.  (If a single
 	 * catcache is list-searched with varying numbers of keys, we may have to
@@ -160,12 +175,17 @@ typedef struct catcacheheader
 {
 	slist_head	ch_caches;		/* head of list of CatCache structs */
 	int			ch_ntup;		/* # of tuples in all caches */
+	dlist_head	ch_lru;			/* all tuples, least recently used first */
+	Size		ch_size;		/* space used by tuples in all caches */
 } CatCacheHeader;
 
 
 /* this extern duplicates utils/memutils.h... */
 extern PGDLLIMPORT MemoryContext CacheMemoryContext;
 
+/* GUC parameter */
+extern int	catalog_cache_memory_target;
+
 extern void CreateCacheMemoryContext(void);
 extern void AtEOXact_CatCache(bool isCommit);
 
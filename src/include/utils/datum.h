@@ -46,6 +46,15 @@ extern Datum datumTransfer(Datum value, bool typByVal, int typLen);
 extern bool datumIsEqual(Datum value1, Datum value2,
 			 bool typByVal, int typLen);
 
+/*
+ * datum_image_eq
+ * return true if two datums of the same type have identical images once
+ * detoasted, false otherwise.  datum_image_hash hashes consistently with it.
+ */
+extern bool datum_image_eq(Datum value1, Datum value2,
+			   bool typByVal, int typLen);
+extern uint32 datum_image_hash(Datum value, bool typByVal, int typLen);
+
 /*
  * Serialize and restore datums so that we can transfer them to parallel
  * workers.
@@ -25,6 +25,17 @@ struct RawStmt;
 #define CACHEDPLANSOURCE_MAGIC		195726186
 #define CACHEDPLAN_MAGIC			953717834
 
+/* possible values for plan_cache_mode */
+typedef enum
+{
+	PLAN_CACHE_MODE_AUTO,
+	PLAN_CACHE_MODE_FORCE_GENERIC_PLAN,
+	PLAN_CACHE_MODE_FORCE_CUSTOM_PLAN
+}	PlanCacheMode;
+
+/* GUC parameter */
+extern int	plan_cache_mode;
+
 /*
  * CachedPlanSource (which might better have been called CachedQuery)
  * represents a SQL query that we expect to use multiple times.  It stores
@@ -72,6 +83,10 @@ struct RawStmt;
  * is no way to free memory short of clearing that entire context.  A oneshot
  * plan is always treated as unsaved.
  *
+ * source_id tells which CachedPlanSource a CachedPlan came from.  A plan can
+ * outlive its source, in a portal say, and a new source can then be made at
+ * the same address, so comparing pointers won't do.
+ *
  * Note: the string referenced by commandTag is not subsidiary storage;
  * it is assumed to be a compile-time-constant string.  As with portals,
  * commandTag shall be NULL if and only if the original query string (before
@@ -109,12 +124,21 @@ typedef struct CachedPlanSource
 	bool		is_saved;		/* has CachedPlanSource been "saved"? */
 	bool		is_valid;		/* is the query_list currently valid? */
 	int			generation;		/* increments each time we create a plan */
+	uint64		source_id;		/* unique within the backend, see below */
 	/* If CachedPlanSource has been saved, it is a member of a global list */
 	struct CachedPlanSource *next_saved;		/* list link, if so */
 	/* State kept to help decide whether to use custom or generic plans: */
 	double		generic_cost;	/* cost of generic plan, or -1 if not known */
 	double		total_custom_cost;		/* total cost of custom plans so far */
 	int			num_custom_plans;		/* number of plans included in total */
+	/* Measured run times in msec, see CachedPlanRecordExecution: */
+	double		total_custom_time;		/* planning + execution, custom plans */
+	int			num_custom_runs;		/* number of runs included in total */
+	double		total_generic_time;		/* execution of current generic plan */
+	int			num_generic_runs;		/* number of runs included in total */
+	/* Statistics, reported by pg_prepared_statements: */
+	int64		generic_plan_count;		/* times the generic plan was used */
+	int64		custom_plan_count;		/* times a custom plan was made */
 } CachedPlanSource;
 
 /*
@@ -134,11 +158,14 @@ typedef struct CachedPlan
 	bool		is_oneshot;		/* is it a "oneshot" plan? */
 	bool		is_saved;		/* is CachedPlan in a long-lived context? */
 	bool		is_valid;		/* is the stmt_list currently valid? */
+	bool		is_custom;		/* was it made for specific parameter values? */
+	double		planning_time;	/* msec spent building a custom plan */
 	Oid			planRoleId;		/* Role ID the plan was created for */
 	bool		dependsOnRole;	/* is plan specific to that role? */
 	TransactionId saved_xmin;	/* if valid, replan when TransactionXmin
 								 * changes from this value */
 	int			generation;		/* parent's generation number for this plan */
+	uint64		source_id;		/* parent's source_id */
 	int			refcount;		/* count of live references to this struct */
 	MemoryContext context;		/* context containing this CachedPlan */
 } CachedPlan;
@@ -181,5 +208,7 @@ extern CachedPlan *GetCachedPlan(CachedPlanSource *plansource,
 			  bool useResOwner,
 			  QueryEnvironment *queryEnv);
 extern void ReleaseCachedPlan(CachedPlan *plan, bool useResOwner);
+extern void CachedPlanRecordExecution(CachedPlanSource *plansource,
+						  CachedPlan *plan, double msecs);
 
 #endif   /* PLANCACHE_H */
@@ -20,6 +20,7 @@
 #include "catalog/pg_index.h"
 #include "catalog/pg_publication.h"
 #include "fmgr.h"
+#include "lib/ilist.h"
 #include "nodes/bitmapset.h"
 #include "rewrite/prs2lock.h"
 #include "storage/block.h"
@@ -216,6 +217,10 @@ typedef struct RelationData
 
 	/* use "struct" here to avoid needing to include pgstat.h: */
 	struct PgStat_TableStatus *pgstat_info;		/* statistics collection area */
+
+	/* space accounting, see relation_cache_memory_target in relcache.c */
+	dlist_node	rd_lru;			/* list link in relcache LRU list */
+	Size		rd_cachesize;	/* estimated memory used by this entry */
 } RelationData;
 
 
@@ -79,6 +79,23 @@ extern int	errtablecol(Relation rel, int attnum);
 extern int	errtablecolname(Relation rel, const char *colname);
 extern int	errtableconstraint(Relation rel, const char *conname);
 
+/*
+ * Size and hit statistics of the relcache, see pg_get_catalog_cache_stats
+ */
+typedef struct RelationCacheStats
+{
+	int64		entries;		/* number of cached relations */
+	int64		size;			/* estimated memory used by them */
+	int64		hits;			/* lookups satisfied from the cache */
+	int64		misses;			/* lookups that had to build an entry */
+	int64		evictions;		/* entries dropped to honor the target */
+} RelationCacheStats;
+
+/* GUC parameter */
+extern int	relation_cache_memory_target;
+
+extern void RelationCacheGetStats(RelationCacheStats *stats);
+
 /*
  * Routines for backend startup
  */
@@ -120,7 +120,9 @@ typedef struct
  *
  * Callers should initialize all fields of GenericCosts to zero.  In addition,
  * they can set numIndexTuples to some positive value if they have a better
- * than default way of estimating the number of leaf index tuples visited.
+ * than default way of estimating the number of leaf index tuples visited,
+ * and num_sa_scans to a value above 1 if the scan will be repeated for some
+ * reason other than ScalarArrayOpExpr quals (such as a skip scan).
  */
 typedef struct
 {
@@ -134,7 +136,7 @@ typedef struct
 	double		numIndexPages;	/* number of leaf pages visited */
 	double		numIndexTuples; /* number of leaf tuples visited */
 	double		spc_random_page_cost;	/* relevant random_page_cost value */
-	double		num_sa_scans;	/* # indexscans from ScalarArrayOps */
+	double		num_sa_scans;	/* # indexscans from ScalarArrayOps etc */
 } GenericCosts;
 
 /* Hooks for plugins to get control when we ask for stats */
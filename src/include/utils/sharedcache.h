@@ -0,0 +1,81 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcache.h
+ *	  Infrastructure for caches shared between backends.
+ *
+ * See sharedcache.c for comments.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/utils/sharedcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDCACHE_H
+#define SHAREDCACHE_H
+
+#include "lib/dshash.h"
+#include "port/atomics.h"
+#include "utils/dsa.h"
+
+/*
+ * The part of a cache's hash table entries that the infrastructure looks
+ * after.  The entries are a struct beginning with the key, as dshash wants,
+ * and containing one of these.
+ */
+typedef struct SharedCacheItem
+{
+	dsa_pointer data;			/* the cached object */
+	Size		size;			/* its size, for the space accounting */
+	pg_atomic_uint32 usage;		/* recent uses, for the clock sweep */
+} SharedCacheItem;
+
+typedef struct SharedCache SharedCache;
+
+/* Is the object stored in a hash table entry still valid? */
+typedef bool (*SharedCacheValidHook) (SharedCache *cache, void *entry,
+												  void *data);
+
+/*
+ * A shared cache.  The user of the cache statically initializes the fields
+ * describing it; the rest is filled in as the cache is set up and used.
+ */
+struct SharedCache
+{
+	const char *name;			/* name of the shared memory struct */
+	int		   *size_kb;		/* GUC giving the budget in kB, 0 = off */
+	Size		entry_bytes;	/* budget per entry, to cap their number */
+	int			num_slots;		/* number of invalidation slots */
+	int			dsa_tranche;	/* LWLock tranche of the DSA area */
+	dshash_parameters hash_params;
+	Size		item_offset;	/* offset of SharedCacheItem in entries */
+	SharedCacheValidHook entry_valid;
+
+	/* Shared state, or NULL if the cache is disabled */
+	struct SharedCacheControl *ctl;
+
+	/* This process' mapping of the cache, see SharedCacheAttach */
+	dsa_area   *area;
+	dshash_table *hash;
+};
+
+/* Bytes of cached objects the cache is to keep */
+#define SharedCacheBudget(cache) \
+	((Size) *(cache)->size_kb * 1024)
+
+extern Size SharedCacheShmemSize(SharedCache *cache);
+extern void SharedCacheShmemInit(SharedCache *cache);
+extern void SharedCacheAttach(SharedCache *cache);
+
+extern void SharedCacheStamp(SharedCache *cache, uint32 slot, bool all);
+extern uint64 SharedCacheCurrentSeq(SharedCache *cache);
+extern bool SharedCacheValid(SharedCache *cache, uint64 seq,
+				 const uint32 *slots, int num_slots);
+
+extern dsa_pointer SharedCacheAllocate(SharedCache *cache, Size size);
+extern void SharedCacheInstall(SharedCache *cache, void *entry, bool found,
+				   dsa_pointer dp, Size size);
+extern void SharedCacheUsed(SharedCache *cache, void *entry);
+
+#endif   /* SHAREDCACHE_H */
@@ -0,0 +1,37 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcatcache.h
+ *	  Cross-backend cache of system catalog tuples.
+ *
+ * See sharedcatcache.c for comments.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/utils/sharedcatcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDCATCACHE_H
+#define SHAREDCATCACHE_H
+
+#include "access/htup.h"
+#include "storage/sinval.h"
+
+/* GUC parameter */
+extern int	shared_catalog_cache_size;
+
+extern Size SharedCatCacheShmemSize(void);
+extern void SharedCatCacheShmemInit(void);
+
+extern void SharedCatCacheInvalidate(const SharedInvalidationMessage *msgs,
+						 int n);
+
+extern bool SharedCatCacheUsable(void);
+extern HeapTuple SharedCatCacheFetch(int cacheid, Oid dbid, uint32 hashvalue,
+					bool *negative);
+extern uint64 SharedCatCacheStartSearch(void);
+extern void SharedCatCacheStore(int cacheid, Oid dbid, uint32 hashvalue,
+					HeapTuple tuple, bool negative, uint64 search_seq);
+
+#endif   /* SHAREDCATCACHE_H */
@@ -0,0 +1,42 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.h
+ *	  Cross-backend cache of generic plans for prepared statements.
+ *
+ * See sharedplancache.c for comments.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/utils/sharedplancache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDPLANCACHE_H
+#define SHAREDPLANCACHE_H
+
+#include "storage/sinval.h"
+#include "utils/plancache.h"
+
+/* Opaque state needed to recheck a fetched plan, see SharedPlanCacheFetch */
+typedef struct SharedPlanCheck SharedPlanCheck;
+
+/* GUC parameter */
+extern int	shared_plan_cache_size;
+
+extern Size SharedPlanCacheShmemSize(void);
+extern void SharedPlanCacheShmemInit(void);
+
+extern void SharedPlanCacheInvalidate(const SharedInvalidationMessage *msgs,
+						  int n);
+
+extern bool SharedPlanCacheUsable(CachedPlanSource *plansource,
+					  QueryEnvironment *queryEnv);
+extern List *SharedPlanCacheFetch(CachedPlanSource *plansource,
+					 SharedPlanCheck **check);
+extern bool SharedPlanCacheRecheck(SharedPlanCheck *check);
+extern uint64 SharedPlanCacheStartPlanning(void);
+extern void SharedPlanCacheStore(CachedPlanSource *plansource, List *plist,
+					 uint64 plan_seq);
+
+#endif   /* SHAREDPLANCACHE_H */
@@ -607,7 +607,11 @@ pqPutMsgEnd(PGconn *conn)
 	/* Make message eligible to send */
 	conn->outCount = conn->outMsgEnd;
 
-	if (conn->outCount >= 8192)
+	/*
+	 * Send complete 8K chunks as we go, except in pipeline mode, where the
+	 * sending functions flush once OUTBUFFER_THRESHOLD is reached.
+	 */
+	if (conn->outCount >= 8192 && conn->pipelineStatus == PQ_PIPELINE_OFF)
 	{
 		int			toSend = conn->outCount - (conn->outCount % 8192);
 
@@ -0,0 +1,110 @@
+# Clients of a connection proxy share the pooled backends' connections with
+# the proxy's own messages.  Check that a client can't pass such a message
+# off as the proxy's, in particular the one introducing a new session, with
+# the address pg_hba.conf is checked against.
+# This test cannot run on Windows, which has no connection proxies.
+
+use strict;
+use warnings;
+use IO::Socket::INET;
+use Socket;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 9;
+
+# Read exactly the given number of bytes, or return undef on EOF.
+sub read_bytes
+{
+	my ($sock, $n) = @_;
+	my $buf = '';
+
+	while (length($buf) < $n)
+	{
+		my $rc = sysread($sock, $buf, $n - length($buf), length($buf));
+		return undef if (!$rc);
+	}
+	return $buf;
+}
+
+# Read a backend message, returning its type and body, or an empty list on
+# EOF.
+sub read_message
+{
+	my $sock = shift;
+	my $header = read_bytes($sock, 5);
+
+	return () if (!defined($header));
+	my ($type, $len) = unpack('aN', $header);
+	my $body = read_bytes($sock, $len - 4);
+	return () if (!defined($body));
+	return ($type, $body);
+}
+
+SKIP:
+{
+	skip "connection proxies are not supported on Windows", 9 if ($windows_os);
+
+	my $node = get_new_node('master');
+	my $proxy_port = $node->port + 1;
+
+	$node->init;
+	$node->append_conf('postgresql.conf', qq{
+listen_addresses = '127.0.0.1'
+connection_proxies = 1
+proxy_port = $proxy_port
+});
+	unlink($node->data_dir . '/pg_hba.conf');
+	$node->append_conf('pg_hba.conf', qq{
+local all all trust
+host all all 127.0.0.1/32 trust
+});
+	$node->start;
+
+	my $user = $node->safe_psql('postgres', 'SELECT current_user');
+	my @proxy_psql = ('psql', '-X', '-A', '-t', '-h', '127.0.0.1',
+		'-p', $proxy_port, '-d', 'postgres', '-c', 'SELECT 1');
+
+	command_like(\@proxy_psql, qr/^1$/, 'query through the connection proxy');
+
+	# Log in through the proxy, and wait until we're attached to a backend.
+	my $sock = IO::Socket::INET->new(
+		PeerAddr => '127.0.0.1',
+		PeerPort => $proxy_port,
+		Proto    => 'tcp')
+	  or die "could not connect to proxy: $!";
+	my $params = "user\0$user\0database\0postgres\0\0";
+	syswrite($sock, pack('NN', 8 + length($params), 196608) . $params);
+
+	my ($type, $body);
+	while (1)
+	{
+		($type, $body) = read_message($sock);
+		last if (!defined($type) || $type eq 'Z');
+	}
+	is($type, 'Z', 'session through the proxy is ready for queries');
+
+	# Now claim to be the proxy, introducing a client from elsewhere.
+	my $addr = pack_sockaddr_in(5432, inet_aton('10.0.0.1'));
+	syswrite($sock,
+		'A' . pack('NN', 8 + length($addr), length($addr)) . $addr);
+
+	my $error = '';
+	while (1)
+	{
+		($type, $body) = read_message($sock);
+		last if (!defined($type));
+		$error .= $body if ($type eq 'E');
+	}
+	like($error, qr/C08P01\0/,
+		'new session message from a client is refused');
+	like(
+		slurp_file($node->logfile),
+		qr/client sent reserved message type 65 to connection proxy/,
+		'refused message is logged');
+	close($sock);
+
+	command_like(\@proxy_psql, qr/^1$/,
+		'connection proxy keeps serving other clients');
+
+	$node->stop;
+}
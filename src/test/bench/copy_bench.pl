@@ -0,0 +1,98 @@
+#!/usr/bin/perl
+#
+# copy_bench.pl
+#	  Measure COPY FROM throughput, in rows per second, for each format
+#
+# The data file is written and read by the server, so this must run as a
+# superuser against a server on the local machine.
+#
+# src/test/bench/copy_bench.pl
+
+use strict;
+use warnings;
+
+use Cwd qw(abs_path);
+use File::Temp qw(tempdir);
+use Getopt::Std;
+use Time::HiRes qw(gettimeofday tv_interval);
+
+my %opt;
+getopts('d:r:n:f:w:h', \%opt);
+
+if ($opt{h})
+{
+	print <<EOT;
+Usage:
+$0 [-d DATABASE] [-r ROWS] [-n RUNS] [-f FORMATS] [-w WIDTH]
+-d DATABASE	database to connect to (default: postgres)
+-r ROWS		rows to load per run (default: 1000000)
+-n RUNS		runs per format; the best one is reported (default: 3)
+-f FORMATS	comma-separated list of text, csv and binary (default: all)
+-w WIDTH	length of the text column (default: 20)
+EOT
+	exit 0;
+}
+
+my $dbname  = $opt{d} || 'postgres';
+my $rows    = $opt{r} || 1000000;
+my $runs    = $opt{n} || 3;
+my @formats = split(/,/, $opt{f} || 'text,csv,binary');
+my $width   = $opt{w} || 20;
+
+# the server, possibly running as another user, writes the data files here
+my $dir = abs_path(tempdir('copy_bench_XXXX', TMPDIR => 1, CLEANUP => 1));
+chmod 0777, $dir;
+
+sub psql
+{
+	my ($sql) = @_;
+	open(my $fh, '|-', 'psql', '-X', '-q', '-v', 'ON_ERROR_STOP=1',
+		'-d', $dbname)
+	  or die "could not run psql: $!";
+	print $fh $sql;
+	close($fh) or die "psql failed";
+}
+
+psql(<<EOSQL);
+DROP TABLE IF EXISTS copy_bench_src, copy_bench_dst;
+CREATE TABLE copy_bench_src (
+	id int4,
+	big int8,
+	small int2,
+	val float8,
+	label text,
+	day date);
+INSERT INTO copy_bench_src
+	SELECT g, g * 7919::int8, g % 32767, g / 3.0,
+		   substr(repeat(md5(g::text), ($width / 32) + 1), 1, $width),
+		   date '2000-01-01' + g % 10000
+	FROM generate_series(1, $rows) g;
+CREATE UNLOGGED TABLE copy_bench_dst (LIKE copy_bench_src);
+EOSQL
+
+printf("%-8s %12s %10s %14s\n", 'format', 'rows', 'seconds', 'rows/s');
+
+foreach my $format (@formats)
+{
+	my $file    = "$dir/copy_bench.$format";
+	my $options = $format eq 'text' ? '' : "(FORMAT $format)";
+	my $best;
+
+	psql("COPY copy_bench_src TO '$file' $options;\n");
+
+	for (my $i = 0; $i < $runs; $i++)
+	{
+		psql("TRUNCATE copy_bench_dst;\n");
+
+		my $start = [gettimeofday];
+		psql("COPY copy_bench_dst FROM '$file' $options;\n");
+		my $elapsed = tv_interval($start);
+
+		$best = $elapsed if !defined($best) || $elapsed < $best;
+	}
+
+	printf("%-8s %12d %10.3f %14.0f\n", $format, $rows, $best, $rows / $best);
+	unlink $file;
+}
+
+psql("DROP TABLE copy_bench_src, copy_bench_dst;\n");
@@ -0,0 +1,64 @@
+# Test the queue of work items that BRIN autosummarization requests from
+# autovacuum: a request that is already pending isn't queued again, and a
+# request that doesn't fit in the queue is reported.
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 2;
+
+my $node = get_new_node('master');
+$node->init;
+
+# Keep the requests in the queue: no worker is started to process them.
+$node->append_conf('postgresql.conf', 'autovacuum = off');
+$node->start;
+
+# With one page per range, the first row inserted into each page requests
+# the summarization of the range of the page before it.  Page 0 is summarized
+# when the index is built, so the first request is for page 1.
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE brin_wi (a int) WITH (fillfactor = 10);
+CREATE INDEX brin_wi_idx ON brin_wi USING brin (a)
+	WITH (pages_per_range = 1, autosummarize = on);
+CREATE FUNCTION brin_wi_fill(target int) RETURNS void LANGUAGE plpgsql AS $$
+DECLARE
+	blk int := 0;
+BEGIN
+	WHILE blk < target LOOP
+		INSERT INTO brin_wi VALUES (1) RETURNING (ctid::text::point)[0] INTO blk;
+	END LOOP;
+END
+$$;
+});
+
+# Request the summarization of page 1 many more times than the queue (256
+# items) has room for, then fill it up with requests for pages 2 to 256.
+$node->safe_psql(
+	'postgres', q{
+DO $$
+BEGIN
+	FOR i IN 1..300 LOOP
+		TRUNCATE brin_wi;
+		PERFORM brin_wi_fill(2);
+	END LOOP;
+END
+$$;
+SELECT brin_wi_fill(257);
+});
+
+unlike(
+	slurp_file($node->logfile),
+	qr/was not recorded/,
+	'repeated requests take a single work item');
+
+# The queue is full now, so the next request is dropped, and reported.
+$node->safe_psql('postgres', 'SELECT brin_wi_fill(258)');
+
+like(
+	slurp_file($node->logfile),
+	qr/request for BRIN range summarization for index "brin_wi_idx" page 257 was not recorded/,
+	'request that does not fit in the queue is reported');
+
+$node->stop;
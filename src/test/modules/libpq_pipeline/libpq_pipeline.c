@@ -0,0 +1,689 @@
+/*-------------------------------------------------------------------------
+ *
+ * libpq_pipeline.c
+ *		Verify libpq pipeline execution functionality
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *		src/test/modules/libpq_pipeline/libpq_pipeline.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres_fe.h"
+
+#include "catalog/pg_type.h"
+#include "libpq-fe.h"
+
+
+static void exit_nicely(PGconn *conn);
+static void pg_attribute_noreturn() pg_fatal_impl(int line, const char *fmt,...)
+			pg_attribute_printf(2, 3);
+
+static const char *const drop_table_sql =
+"DROP TABLE IF EXISTS pq_pipeline_demo";
+static const char *const create_table_sql =
+"CREATE UNLOGGED TABLE pq_pipeline_demo(id serial primary key, itemno integer);";
+static const char *const insert_sql =
+"INSERT INTO pq_pipeline_demo(itemno) VALUES ($1)";
+
+/* Number of rows for the pipelined insert test */
+#define NUM_INSERTS		10000
+
+#define pg_fatal(...) pg_fatal_impl(__LINE__, __VA_ARGS__)
+
+static void
+exit_nicely(PGconn *conn)
+{
+	PQfinish(conn);
+	exit(1);
+}
+
+/*
+ * Print an error to stderr and terminate the program.
+ */
+static void
+pg_fatal_impl(int line, const char *fmt,...)
+{
+	va_list		args;
+
+	fflush(stdout);
+
+	fprintf(stderr, "\n%s:%d: ", __FILE__, line);
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	if (fmt[strlen(fmt) - 1] != '\n')
+		fprintf(stderr, "\n");
+	exit(1);
+}
+
+/*
+ * Fetch the next result, and check that it has the expected status.
+ */
+static PGresult *
+expect_result(PGconn *conn, ExecStatusType status)
+{
+	PGresult   *res = PQgetResult(conn);
+
+	if (res == NULL)
+		pg_fatal("expected %s, got NULL: %s",
+				 PQresStatus(status), PQerrorMessage(conn));
+	if (PQresultStatus(res) != status)
+		pg_fatal("expected %s, got %s: %s",
+				 PQresStatus(status), PQresStatus(PQresultStatus(res)),
+				 PQerrorMessage(conn));
+	return res;
+}
+
+/*
+ * Check that the results of the current command are over.
+ */
+static void
+expect_null(PGconn *conn)
+{
+	PGresult   *res = PQgetResult(conn);
+
+	if (res != NULL)
+		pg_fatal("expected NULL result, got %s",
+				 PQresStatus(PQresultStatus(res)));
+}
+
+static void
+test_disallowed_in_pipeline(PGconn *conn)
+{
+	PGresult   *res;
+
+	fprintf(stderr, "test error cases... ");
+
+	if (PQisnonblocking(conn))
+		pg_fatal("Expected blocking connection mode");
+
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("Unable to enter pipeline mode");
+
+	if (PQpipelineStatus(conn) == PQ_PIPELINE_OFF)
+		pg_fatal("Pipeline mode not activated properly");
+
+	/* PQexec should fail in pipeline mode */
+	res = PQexec(conn, "SELECT 1");
+	if (res != NULL)
+		pg_fatal("PQexec should fail in pipeline mode but succeeded");
+
+	/* So should PQsendQuery */
+	if (PQsendQuery(conn, "SELECT 1") != 0)
+		pg_fatal("PQsendQuery should fail in pipeline mode but succeeded");
+
+	/* Entering pipeline mode when already in pipeline mode is OK */
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("re-entering pipeline mode should be a no-op but failed");
+
+	if (PQisBusy(conn) != 0)
+		pg_fatal("PQisBusy should return 0 when idle in pipeline mode, returned 1");
+
+	/* ok, back to normal command mode */
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("couldn't exit idle empty pipeline mode");
+
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF)
+		pg_fatal("Pipeline mode not terminated properly");
+
+	/* exiting pipeline mode when not in pipeline mode should be a no-op */
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("pipeline mode exit when not in pipeline mode should succeed but failed");
+
+	/* can now PQexec again */
+	res = PQexec(conn, "SELECT 1");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("PQexec should succeed after exiting pipeline mode but failed with: %s",
+				 PQerrorMessage(conn));
+	PQclear(res);
+
+	fprintf(stderr, "ok\n");
+}
+
+static void
+test_simple_pipeline(PGconn *conn)
+{
+	PGresult   *res;
+	const char *dummy_params[1] = {"1"};
+	Oid			dummy_param_oids[1] = {INT4OID};
+
+	fprintf(stderr, "simple pipeline... ");
+
+	/*
+	 * Enter pipeline mode and dispatch a set of operations, which we'll then
+	 * process the results of as they come in.
+	 *
+	 * For a simple case we should be able to do this without interim
+	 * processing of results since our output buffer will give us enough slush
+	 * to work with and we won't block on sending. So blocking mode is fine.
+	 */
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+
+	if (PQsendQueryParams(conn, "SELECT $1",
+						  1, dummy_param_oids, dummy_params,
+						  NULL, NULL, 0) != 1)
+		pg_fatal("dispatching SELECT failed: %s", PQerrorMessage(conn));
+
+	if (PQexitPipelineMode(conn) != 0)
+		pg_fatal("exiting pipeline mode with work in progress should fail, but succeeded");
+
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+	res = expect_result(conn, PGRES_TUPLES_OK);
+	if (strcmp(PQgetvalue(res, 0, 0), "1") != 0)
+		pg_fatal("unexpected value %s", PQgetvalue(res, 0, 0));
+	PQclear(res);
+
+	/* the query's results are over */
+	expect_null(conn);
+
+	/*
+	 * Even though we've processed the result there's still a sync to come
+	 * and we can't exit pipeline mode yet
+	 */
+	if (PQexitPipelineMode(conn) != 0)
+		pg_fatal("exiting pipeline mode after query but before sync succeeded incorrectly");
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	/* We're still in pipeline mode... */
+	if (PQpipelineStatus(conn) == PQ_PIPELINE_OFF)
+		pg_fatal("Fell out of pipeline mode somehow");
+
+	/* ... until we end it, which we can safely do now */
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("attempt to exit pipeline mode failed when it should've succeeded: %s",
+				 PQerrorMessage(conn));
+
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF)
+		pg_fatal("Exiting pipeline mode didn't seem to work");
+
+	fprintf(stderr, "ok\n");
+}
+
+static void
+test_multi_pipelines(PGconn *conn)
+{
+	PGresult   *res;
+	const char *dummy_params[1] = {"1"};
+	Oid			dummy_param_oids[1] = {INT4OID};
+
+	fprintf(stderr, "multi pipeline... ");
+
+	/*
+	 * Queue up a couple of small pipelines and process each without returning
+	 * to command mode first.
+	 */
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+
+	if (PQsendQueryParams(conn, "SELECT $1", 1, dummy_param_oids,
+						  dummy_params, NULL, NULL, 0) != 1)
+		pg_fatal("dispatching first SELECT failed: %s", PQerrorMessage(conn));
+
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("Pipeline sync failed: %s", PQerrorMessage(conn));
+
+	if (PQsendQueryParams(conn, "SELECT $1", 1, dummy_param_oids,
+						  dummy_params, NULL, NULL, 0) != 1)
+		pg_fatal("dispatching second SELECT failed: %s", PQerrorMessage(conn));
+
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+	/* OK, start processing the results */
+	PQclear(expect_result(conn, PGRES_TUPLES_OK));
+	expect_null(conn);
+
+	if (PQexitPipelineMode(conn) != 0)
+		pg_fatal("exiting pipeline mode after query but before sync succeeded incorrectly");
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	/* second pipeline */
+	PQclear(expect_result(conn, PGRES_TUPLES_OK));
+	expect_null(conn);
+
+	if (PQexitPipelineMode(conn) != 0)
+		pg_fatal("exiting pipeline mode after query but before sync succeeded incorrectly");
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	/* We're still in pipeline mode ... */
+	if (PQpipelineStatus(conn) == PQ_PIPELINE_OFF)
+		pg_fatal("Fell out of pipeline mode somehow");
+
+	/* until we end it, which we can safely do now */
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("attempt to exit pipeline mode failed when it should've succeeded: %s",
+				 PQerrorMessage(conn));
+
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF)
+		pg_fatal("exiting pipeline mode didn't seem to work");
+
+	res = PQexec(conn, "SELECT 1");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("PQexec after pipeline failed: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	fprintf(stderr, "ok\n");
+}
+
+/*
+ * When an operation in a pipeline fails the rest of the pipeline is flushed.
+ * We still have to get results for each pipeline item, but the item will just
+ * be a PGRES_PIPELINE_ABORTED code.
+ *
+ * This intentionally doesn't use a transaction to wrap the pipeline, so the
+ * first insert is committed by the implicit transaction of its batch only
+ * if the batch succeeds.
+ */
+static void
+test_pipeline_abort(PGconn *conn)
+{
+	PGresult   *res = NULL;
+	const char *values[1];
+	int			i;
+
+	fprintf(stderr, "aborted pipeline... ");
+
+	res = PQexec(conn, drop_table_sql);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("dispatching DROP TABLE failed: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	res = PQexec(conn, create_table_sql);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("dispatching CREATE TABLE failed: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	/*
+	 * Queue up a couple of small pipelines and process each without returning
+	 * to command mode first.  Make sure the second operation in the first
+	 * pipeline ERRORs.
+	 */
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+
+	values[0] = "1";
+	if (PQsendQueryParams(conn, insert_sql, 1, NULL, values,
+						  NULL, NULL, 0) != 1)
+		pg_fatal("dispatching first insert failed: %s", PQerrorMessage(conn));
+
+	if (PQsendQueryParams(conn, "SELECT no_such_function($1)",
+						  1, NULL, values, NULL, NULL, 0) != 1)
+		pg_fatal("dispatching error select failed: %s", PQerrorMessage(conn));
+
+	/* this insert is skipped, and so is the rest of the batch */
+	values[0] = "2";
+	if (PQsendQueryParams(conn, insert_sql, 1, NULL, values,
+						  NULL, NULL, 0) != 1)
+		pg_fatal("dispatching second insert failed: %s", PQerrorMessage(conn));
+
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+	values[0] = "3";
+	if (PQsendQueryParams(conn, insert_sql, 1, NULL, values,
+						  NULL, NULL, 0) != 1)
+		pg_fatal("dispatching second-pipeline insert failed: %s",
+				 PQerrorMessage(conn));
+
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+	/*
+	 * OK, start processing the pipeline results.
+	 *
+	 * We should get a command-ok for the first query, then a fatal error and
+	 * a pipeline aborted message for the second insert, a pipeline-end, then
+	 * a command-ok and a pipeline-ok for the second pipeline operation.
+	 */
+	PQclear(expect_result(conn, PGRES_COMMAND_OK));
+	expect_null(conn);
+
+	/* second query, caused error */
+	PQclear(expect_result(conn, PGRES_FATAL_ERROR));
+	expect_null(conn);
+
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_ABORTED)
+		pg_fatal("pipeline should be flagged as aborted but isn't");
+
+	/* third query in pipeline, the second insert */
+	PQclear(expect_result(conn, PGRES_PIPELINE_ABORTED));
+	expect_null(conn);
+
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_ABORTED)
+		pg_fatal("pipeline should be flagged as aborted but isn't");
+
+	/* Ensure we're still in pipeline */
+	if (PQpipelineStatus(conn) == PQ_PIPELINE_OFF)
+		pg_fatal("Fell out of pipeline mode somehow");
+
+	/*
+	 * The end of a failed pipeline is a PGRES_PIPELINE_SYNC.
+	 *
+	 * (This is so clients know to start processing results normally again
+	 * and can tell the difference between skipped commands and the sync.)
+	 */
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	if (PQpipelineStatus(conn) == PQ_PIPELINE_ABORTED)
+		pg_fatal("sync should've cleared the aborted flag but didn't");
+
+	/* We're still in pipeline mode... */
+	if (PQpipelineStatus(conn) == PQ_PIPELINE_OFF)
+		pg_fatal("Fell out of pipeline mode somehow");
+
+	/* the insert from the second pipeline */
+	PQclear(expect_result(conn, PGRES_COMMAND_OK));
+	expect_null(conn);
+
+	/* the second pipeline sync */
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("exiting pipeline mode failed: %s", PQerrorMessage(conn));
+
+	/*
+	 * The first batch failed as a whole, so only the second one's insert
+	 * remains.
+	 */
+	res = PQexec(conn, "SELECT itemno FROM pq_pipeline_demo");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("Expected tuples, got %s: %s",
+				 PQresStatus(PQresultStatus(res)), PQerrorMessage(conn));
+	if (PQntuples(res) != 1)
+		pg_fatal("expected 1 result, got %d", PQntuples(res));
+	for (i = 0; i < PQntuples(res); i++)
+	{
+		const char *val = PQgetvalue(res, i, 0);
+
+		if (strcmp(val, "3") != 0)
+			pg_fatal("expected itemno 3, got %s", val);
+	}
+	PQclear(res);
+
+	fprintf(stderr, "ok\n");
+}
+
+static void
+test_prepared(PGconn *conn)
+{
+	PGresult   *res = NULL;
+	Oid			param_oids[1] = {INT4OID};
+	const char *values[1] = {"42"};
+
+	fprintf(stderr, "prepared... ");
+
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+	if (PQsendPrepare(conn, "select_one", "SELECT $1, '42', $1::numeric, "
+					  "interval '1 sec'",
+					  1, param_oids) != 1)
+		pg_fatal("preparing query failed: %s", PQerrorMessage(conn));
+	if (PQsendDescribePrepared(conn, "select_one") != 1)
+		pg_fatal("failed to send describePrepared: %s", PQerrorMessage(conn));
+	if (PQsendQueryPrepared(conn, "select_one", 1, values,
+							NULL, NULL, 0) != 1)
+		pg_fatal("failed to execute prepared: %s", PQerrorMessage(conn));
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+	PQclear(expect_result(conn, PGRES_COMMAND_OK));
+	expect_null(conn);
+
+	res = expect_result(conn, PGRES_COMMAND_OK);
+	if (PQnfields(res) != 4)
+		pg_fatal("expected 4 columns, got %d", PQnfields(res));
+	if (PQnparams(res) != 1 || PQparamtype(res, 0) != INT4OID)
+		pg_fatal("unexpected parameter description");
+	PQclear(res);
+	expect_null(conn);
+
+	res = expect_result(conn, PGRES_TUPLES_OK);
+	if (strcmp(PQgetvalue(res, 0, 0), "42") != 0)
+		pg_fatal("unexpected value %s", PQgetvalue(res, 0, 0));
+	PQclear(res);
+	expect_null(conn);
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("could not exit pipeline mode: %s", PQerrorMessage(conn));
+
+	fprintf(stderr, "ok\n");
+}
+
+/*
+ * Send many inserts in a single batch, so that both ends have to cope with
+ * full socket buffers, and collect the results afterwards.
+ */
+static void
+test_pipelined_insert(PGconn *conn)
+{
+	PGresult   *res;
+	char		insert_param_0[16];
+	const char *insert_params[1] = {insert_param_0};
+	int			i;
+
+	fprintf(stderr, "pipelined insert... ");
+
+	res = PQexec(conn, drop_table_sql);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("dispatching DROP TABLE failed: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	res = PQexec(conn, create_table_sql);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("dispatching CREATE TABLE failed: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+
+	if (PQsendQueryParams(conn, "BEGIN", 0, NULL, NULL, NULL, NULL, 0) != 1)
+		pg_fatal("dispatching BEGIN failed: %s", PQerrorMessage(conn));
+
+	for (i = 0; i < NUM_INSERTS; i++)
+	{
+		snprintf(insert_param_0, sizeof(insert_param_0), "%d", i);
+		if (PQsendQueryParams(conn, insert_sql, 1, NULL, insert_params,
+							  NULL, NULL, 0) != 1)
+			pg_fatal("dispatching insert %d failed: %s",
+					 i, PQerrorMessage(conn));
+	}
+
+	if (PQsendQueryParams(conn, "COMMIT", 0, NULL, NULL, NULL, NULL, 0) != 1)
+		pg_fatal("dispatching COMMIT failed: %s", PQerrorMessage(conn));
+
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+	/* BEGIN, the inserts and COMMIT */
+	for (i = 0; i < NUM_INSERTS + 2; i++)
+	{
+		PQclear(expect_result(conn, PGRES_COMMAND_OK));
+		expect_null(conn);
+	}
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("could not exit pipeline mode: %s", PQerrorMessage(conn));
+
+	res = PQexec(conn, "SELECT count(*) FROM pq_pipeline_demo");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("counting rows failed: %s", PQerrorMessage(conn));
+	if (atoi(PQgetvalue(res, 0, 0)) != NUM_INSERTS)
+		pg_fatal("expected %d rows, got %s",
+				 NUM_INSERTS, PQgetvalue(res, 0, 0));
+	PQclear(res);
+
+	fprintf(stderr, "ok\n");
+}
+
+static void
+test_singlerowmode(PGconn *conn)
+{
+	PGresult   *res;
+	int			i;
+
+	fprintf(stderr, "single-row mode... ");
+
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+
+	/* One series of three commands, using single-row mode for the first two. */
+	for (i = 0; i < 3; i++)
+	{
+		char		limit[16];
+		const char *param[1] = {limit};
+
+		snprintf(limit, sizeof(limit), "%d", 44 + i);
+
+		if (PQsendQueryParams(conn,
+							  "SELECT generate_series(42, $1)",
+							  1,
+							  NULL,
+							  param,
+							  NULL,
+							  NULL,
+							  0) != 1)
+			pg_fatal("failed to send query: %s", PQerrorMessage(conn));
+	}
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+
+	for (i = 0; i < 3; i++)
+	{
+		int			nrows = 0;
+
+		if (i < 2 && PQsetSingleRowMode(conn) != 1)
+			pg_fatal("PQsetSingleRowMode() failed for query %d", i);
+
+		while ((res = PQgetResult(conn)) != NULL)
+		{
+			ExecStatusType est = PQresultStatus(res);
+
+			if (est == PGRES_SINGLE_TUPLE)
+			{
+				if (i >= 2)
+					pg_fatal("got single tuple in normal mode");
+				nrows++;
+			}
+			else if (est == PGRES_TUPLES_OK)
+			{
+				if (i < 2 && PQntuples(res) != 0)
+					pg_fatal("expected an empty final result in single-row mode");
+				nrows += PQntuples(res);
+			}
+			else
+				pg_fatal("unexpected result status %s: %s",
+						 PQresStatus(est), PQerrorMessage(conn));
+			PQclear(res);
+		}
+
+		if (nrows != 3 + i)
+			pg_fatal("query %d returned %d rows, expected %d",
+					 i, nrows, 3 + i);
+	}
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC));
+
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("failed to end pipeline mode: %s", PQerrorMessage(conn));
+
+	fprintf(stderr, "ok\n");
+}
+
+static void
+print_test_list(void)
+{
+	printf("disallowed_in_pipeline\n");
+	printf("multi_pipelines\n");
+	printf("pipeline_abort\n");
+	printf("pipelined_insert\n");
+	printf("prepared\n");
+	printf("simple_pipeline\n");
+	printf("singlerow\n");
+}
+
+static void
+usage(const char *progname)
+{
+	fprintf(stderr, "%s tests the libpq pipeline mode.\n\n", progname);
+	fprintf(stderr, "Usage:\n");
+	fprintf(stderr, "  %s tests\n", progname);
+	fprintf(stderr, "  %s TESTNAME [CONNINFO]\n", progname);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *conninfo = "";
+	PGconn	   *conn;
+	char	   *testname;
+	PGresult   *res;
+
+	if (argc < 2 || argc > 3)
+	{
+		usage(argv[0]);
+		exit(1);
+	}
+
+	testname = argv[1];
+	if (strcmp(testname, "tests") == 0)
+	{
+		print_test_list();
+		exit(0);
+	}
+
+	if (argc > 2)
+		conninfo = argv[2];
+
+	/* Make a connection to the database */
+	conn = PQconnectdb(conninfo);
+	if (PQstatus(conn) != CONNECTION_OK)
+	{
+		fprintf(stderr, "Connection to database failed: %s\n",
+				PQerrorMessage(conn));
+		exit_nicely(conn);
+	}
+
+	res = PQexec(conn, "SET lc_messages TO \"C\"");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("failed to set lc_messages: %s", PQerrorMessage(conn));
+	PQclear(res);
+
+	if (strcmp(testname, "disallowed_in_pipeline") == 0)
+		test_disallowed_in_pipeline(conn);
+	else if (strcmp(testname, "multi_pipelines") == 0)
+		test_multi_pipelines(conn);
+	else if (strcmp(testname, "pipeline_abort") == 0)
+		test_pipeline_abort(conn);
+	else if (strcmp(testname, "pipelined_insert") == 0)
+		test_pipelined_insert(conn);
+	else if (strcmp(testname, "prepared") == 0)
+		test_prepared(conn);
+	else if (strcmp(testname, "simple_pipeline") == 0)
+		test_simple_pipeline(conn);
+	else if (strcmp(testname, "singlerow") == 0)
+		test_singlerowmode(conn);
+	else
+	{
+		fprintf(stderr, "\"%s\" is not a recognized test name\n", testname);
+		exit(1);
+	}
+
+	/* close the connection to the database and cleanup */
+	PQfinish(conn);
+	return 0;
+}
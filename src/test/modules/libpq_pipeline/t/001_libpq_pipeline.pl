@@ -0,0 +1,29 @@
+# Run every test of the libpq_pipeline program against a fresh server
+
+use strict;
+use warnings;
+
+use TestLib;
+use Test::More;
+use PostgresNode;
+
+my $prog = "$ENV{TESTDIR}/libpq_pipeline";
+
+my $node = get_new_node('main');
+$node->init;
+$node->start;
+
+my ($out, $err);
+IPC::Run::run [ $prog, 'tests' ], '>', \$out, '2>', \$err
+  or die "could not list tests: $err";
+my @tests = split(/\s+/, $out);
+
+plan tests => scalar @tests;
+
+for my $testname (@tests)
+{
+	command_ok([ $prog, $testname, $node->connstr('postgres') ],
+		"libpq_pipeline $testname");
+}
+
+$node->stop('fast');
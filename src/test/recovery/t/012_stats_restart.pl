@@ -0,0 +1,47 @@
+#
+# Tests for the shared-memory statistics: visibility across backends, and
+# what survives a clean shutdown or a crash.
+#
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 5;
+
+my $node = get_new_node('master');
+$node->init;
+$node->start;
+
+# Counts are applied to shared memory when a backend exits at the latest,
+# so a later session sees them without waiting for a collector.
+$node->safe_psql('postgres',
+	'CREATE TABLE stats_tab (a int); INSERT INTO stats_tab SELECT generate_series(1, 10);');
+$node->safe_psql('postgres', 'DELETE FROM stats_tab WHERE a <= 3;');
+ok( $node->poll_query_until(
+		'postgres',
+		"SELECT n_tup_ins = 10 AND n_tup_del = 3 FROM pg_stat_user_tables WHERE relname = 'stats_tab'"),
+	'counts from other sessions are visible');
+
+# A clean shutdown writes the statistics out, and startup reads them back.
+$node->stop;
+ok(-f $node->data_dir . '/pg_stat/global.stat',
+	'statistics file written at shutdown');
+$node->start;
+is( $node->safe_psql(
+		'postgres',
+		"SELECT n_tup_ins, n_tup_del FROM pg_stat_user_tables WHERE relname = 'stats_tab'"),
+	'10|3',
+	'counts survive a clean restart');
+
+# The statistics file is consumed at startup, so a crash loses the counts.
+ok(!-f $node->data_dir . '/pg_stat/global.stat',
+	'statistics file removed after being read');
+$node->stop('immediate');
+$node->start;
+is( $node->safe_psql(
+		'postgres',
+		"SELECT n_tup_ins, n_tup_del FROM pg_stat_user_tables WHERE relname = 'stats_tab'"),
+	'0|0',
+	'counts are discarded after a crash');
+
+$node->stop;
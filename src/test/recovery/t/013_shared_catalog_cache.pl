@@ -0,0 +1,75 @@
+#
+# Tests for the shared catalog cache: catalog rows read by one backend are
+# found by the next, changes made meanwhile aren't masked by stale entries,
+# and a full cache evicts rows instead of failing.
+#
+# Every session here is a new backend, with an empty catcache of its own, so
+# any scan of the catalog index it doesn't need to do is a hit in the shared
+# cache.
+#
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 6;
+
+my $node = get_new_node('master');
+$node->init;
+$node->append_conf('postgresql.conf', 'shared_catalog_cache_size = 1MB');
+$node->start;
+
+$node->safe_psql('postgres', q{
+DO $$
+BEGIN
+	FOR i IN 1..200 LOOP
+		EXECUTE format('CREATE TABLE cat_t%s ()', i);
+	END LOOP;
+END
+$$;
+});
+
+# Look up the tables' row types by name, and return how many of them were
+# found and how many times the backend had to scan the pg_type index.
+sub lookup_types
+{
+	my $result = $node->safe_psql('postgres', q{
+BEGIN;
+SELECT count(to_regtype('cat_t' || i)) FROM generate_series(1, 200) i;
+SELECT pg_stat_get_xact_numscans('pg_type_typname_nsp_index'::regclass);
+COMMIT;
+});
+	return split(/\n/, $result);
+}
+
+my ($found, $scans) = lookup_types();
+cmp_ok($scans, '>=', 200, 'first session reads the catalog');
+
+($found, $scans) = lookup_types();
+ok($found == 200 && $scans == 0,
+	'next session finds the rows in the shared cache');
+
+# Renaming the table invalidates the cached rows for both names.
+$node->safe_psql('postgres', 'ALTER TABLE cat_t1 RENAME TO cat_renamed');
+is( $node->safe_psql(
+		'postgres',
+		"SELECT to_regtype('cat_t1') IS NULL, to_regtype('cat_renamed')"),
+	't|cat_renamed',
+	'shared cache reflects a change made by another session');
+
+($found, $scans) = lookup_types();
+is($found, 199, 'renamed table is no longer found under its old name');
+
+# Fill the cache well past its budget with rows that don't exist, which get
+# cached as negative entries, and check that the earlier rows were pushed
+# out and that the cache still works.
+$node->safe_psql('postgres',
+	"SELECT count(to_regtype('cat_missing' || i)) FROM generate_series(1, 20000) i"
+);
+
+($found, $scans) = lookup_types();
+cmp_ok($scans, '>=', 100, 'rows not used recently are evicted');
+
+($found, $scans) = lookup_types();
+ok($found == 199 && $scans == 0, 'evicted rows are cached again');
+
+$node->stop;
@@ -0,0 +1,71 @@
+#
+# Tests for the shared plan cache: a generic plan made by one backend is
+# used by the next, but not under different planner settings, and a change
+# made by another session invalidates it.
+#
+# A statement without parameters gets a generic plan right away.  Planning
+# it reads the column's statistics, which a new backend has to fetch from
+# pg_statistic, so a backend that didn't scan pg_statistic's index got its
+# plan from the shared cache.
+#
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 7;
+
+my $node = get_new_node('master');
+$node->init;
+$node->append_conf('postgresql.conf', 'shared_plan_cache_size = 1MB');
+$node->start;
+
+$node->safe_psql('postgres', q{
+CREATE TABLE plan_t AS SELECT i AS a FROM generate_series(1, 10000) i;
+ANALYZE plan_t;
+});
+
+# Prepare and explain the statement in a new session, and return the scan
+# node used and whether the backend had to plan it.
+sub explain_statement
+{
+	my $settings = shift || '';
+	my $result = $node->safe_psql('postgres', qq{
+$settings
+BEGIN;
+PREPARE q AS SELECT count(*) FROM plan_t WHERE a = 42;
+EXPLAIN (COSTS OFF) EXECUTE q;
+SELECT pg_stat_get_xact_numscans('pg_statistic_relid_att_inh_index'::regclass) > 0;
+COMMIT;
+});
+	my ($scan) = $result =~ /^\s*->\s+(.*?) on plan_t/m;
+	my $planned = ($result =~ /^t$/m) ? 1 : 0;
+	return ($scan, $planned);
+}
+
+my ($scan, $planned) = explain_statement();
+ok($scan eq 'Seq Scan' && $planned, 'first session plans the statement');
+
+($scan, $planned) = explain_statement();
+ok($scan eq 'Seq Scan' && !$planned,
+	'next session uses the plan from the shared cache');
+
+# Plans made under other planner settings are kept apart.
+($scan, $planned) = explain_statement('SET enable_seqscan = off;');
+ok($planned, 'session with other planner settings plans for itself');
+
+($scan, $planned) = explain_statement();
+ok(!$planned, 'plan for the default settings is still shared');
+
+# A new index invalidates the plan, and the next session plans again and
+# shares its new plan.
+$node->safe_psql('postgres', 'CREATE INDEX plan_t_a_idx ON plan_t (a)');
+
+($scan, $planned) = explain_statement();
+ok($planned, 'plan is invalidated by a change made by another session');
+like($scan, qr/^Index (Only )?Scan using plan_t_a_idx$/,
+	'new plan uses the new index');
+
+($scan, $planned) = explain_statement();
+ok($scan =~ /plan_t_a_idx/ && !$planned, 'new plan is shared');
+
+$node->stop;
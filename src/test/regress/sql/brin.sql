@@ -444,3 +444,30 @@ SELECT brin_summarize_range('brin_summarize_idx', 4294967295);
 -- invalid block number values
 SELECT brin_summarize_range('brin_summarize_idx', -1);
 SELECT brin_summarize_range('brin_summarize_idx', 4294967296);
+
+-- Test bloom and minmax-multi opclasses
+CREATE TABLE brin_opclass_test (i int4, t text, ts timestamp)
+  WITH (autovacuum_enabled=false);
+INSERT INTO brin_opclass_test
+  SELECT CASE WHEN g % 100 = 0 THEN 100000 + g ELSE g END, md5(g::text),
+         '2017-01-01'::timestamp + g * interval '1 minute'
+  FROM generate_series(1, 10000) g;
+CREATE INDEX brin_bloom_idx ON brin_opclass_test
+  USING brin (i int4_bloom_ops, t text_bloom_ops) WITH (pages_per_range=1);
+CREATE INDEX brin_multi_idx ON brin_opclass_test
+  USING brin (i int4_minmax_multi_ops, ts timestamp_minmax_multi_ops)
+  WITH (pages_per_range=1);
+SET enable_seqscan = off;
+SELECT count(*) FROM brin_opclass_test WHERE t = md5('42');
+SELECT count(*) FROM brin_opclass_test WHERE i = 100500;
+SELECT count(*) FROM brin_opclass_test WHERE i = 42::int8;
+SELECT count(*) FROM brin_opclass_test WHERE i < 10;
+SELECT count(*) FROM brin_opclass_test WHERE i BETWEEN 5000 AND 5010;
+SELECT count(*) FROM brin_opclass_test WHERE ts > '2017-01-07 22:00';
+-- values added to already summarized ranges
+INSERT INTO brin_opclass_test VALUES (-1, 'foo', '2000-01-01');
+SELECT count(*) FROM brin_opclass_test WHERE t = 'foo';
+SELECT count(*) FROM brin_opclass_test WHERE i = -1;
+SELECT count(*) FROM brin_opclass_test WHERE ts < '2001-01-01';
+RESET enable_seqscan;
+DROP TABLE brin_opclass_test;
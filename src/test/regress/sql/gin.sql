@@ -34,3 +34,55 @@ insert into gin_test_tbl select array[1, 3, g] from generate_series(1, 1000) g;
 
 delete from gin_test_tbl where i @> array[2];
 vacuum gin_test_tbl;
+
+-- Test merging a pending list several times gin_pending_list_limit.  An
+-- insertion that pushes the list over the limit normally leaves the merge
+-- to autovacuum, and only merges the list itself when it reaches twice the
+-- limit; gin_clean_pending_list() and vacuum merge it by sorting all the
+-- entries.  Use a multicolumn index, duplicate keys within an item, empty
+-- items, null items and null keys, and check that the index finds the same
+-- rows before and after the merges as a sequential scan.
+create table gin_test_tbl2(a int4[], b text[]) with (autovacuum_enabled = off);
+create index gin_test_idx2 on gin_test_tbl2 using gin (a, b)
+  with (fastupdate = on, gin_pending_list_limit = 64);
+insert into gin_test_tbl2
+  select case when g % 50 = 0 then '{}' else array[g % 100, g % 7, g % 7] end,
+         case when g % 30 = 0 then null
+              when g % 40 = 0 then array[null]::text[]
+              else array[(g % 13)::text] end
+  from generate_series(1, 20000) g;
+
+set enable_seqscan = off;
+explain (costs off)
+select count(*) from gin_test_tbl2 where a @> '{5}';
+select count(*) from gin_test_tbl2 where a @> '{5}';
+select count(*) from gin_test_tbl2 where a @> '{3, 42}';
+select count(*) from gin_test_tbl2 where a <@ '{}';
+select count(*) from gin_test_tbl2 where b && '{1, 12}';
+
+-- whether anything is left to merge depends on autovacuum, so hide the count
+do $$ begin perform gin_clean_pending_list('gin_test_idx2'); end $$;
+
+select count(*) from gin_test_tbl2 where a @> '{5}';
+select count(*) from gin_test_tbl2 where a @> '{3, 42}';
+select count(*) from gin_test_tbl2 where a <@ '{}';
+select count(*) from gin_test_tbl2 where b && '{1, 12}';
+
+delete from gin_test_tbl2 where a @> '{3}';
+insert into gin_test_tbl2
+  select array[g % 100, g % 11], array[(g % 17)::text]
+  from generate_series(1, 5000) g;
+vacuum gin_test_tbl2;
+
+select count(*) from gin_test_tbl2 where a @> '{5}';
+select count(*) from gin_test_tbl2 where a @> '{3, 42}';
+select count(*) from gin_test_tbl2 where a <@ '{}';
+select count(*) from gin_test_tbl2 where b && '{1, 12}';
+
+reset enable_seqscan;
+set enable_bitmapscan = off;
+select count(*) from gin_test_tbl2 where a @> '{5}';
+select count(*) from gin_test_tbl2 where a @> '{3, 42}';
+select count(*) from gin_test_tbl2 where a <@ '{}';
+select count(*) from gin_test_tbl2 where b && '{1, 12}';
+reset enable_bitmapscan;
@@ -98,6 +98,22 @@ and p <@ box(point(5,5), point(6, 6));
 
 drop index gist_tbl_multi_index;
 
+-- Test that the sorted build, used by default for the point opclass, and
+-- the buffering build produce indexes that return the same answers.
+create index gist_tbl_point_index on gist_tbl using gist (p);
+
+select count(*) from gist_tbl where p <@ box(point(0,0), point(100, 100));
+select count(*) from gist_tbl where p <@ box(point(250,250), point(260, 260));
+
+drop index gist_tbl_point_index;
+
+create index gist_tbl_point_index on gist_tbl using gist (p) with (buffering = on);
+
+select count(*) from gist_tbl where p <@ box(point(0,0), point(100, 100));
+select count(*) from gist_tbl where p <@ box(point(250,250), point(260, 260));
+
+drop index gist_tbl_point_index;
+
 -- Clean up
 reset enable_seqscan;
 reset enable_bitmapscan;
@@ -0,0 +1,51 @@
+--
+-- INCREMENTAL SORT
+--
+-- Sorting input that is already sorted by a prefix of the requested keys
+--
+
+CREATE TABLE incr_sort_t (a int, b int, c int);
+INSERT INTO incr_sort_t
+  SELECT i / 100, (i * 37) % 100, i / 10 FROM generate_series(0, 9999) i;
+CREATE INDEX incr_sort_t_a_idx ON incr_sort_t (a);
+CREATE INDEX incr_sort_t_c_idx ON incr_sort_t (c);
+ANALYZE incr_sort_t;
+
+-- the index provides the order on a, so only b needs sorting
+EXPLAIN (COSTS OFF)
+SELECT * FROM incr_sort_t ORDER BY a, b LIMIT 10;
+SELECT * FROM incr_sort_t ORDER BY a, b LIMIT 10;
+
+-- results spanning two groups
+SELECT a, b FROM incr_sort_t ORDER BY a, b LIMIT 10 OFFSET 95;
+
+-- groups smaller than the minimum batch size are sorted together
+EXPLAIN (COSTS OFF)
+SELECT * FROM incr_sort_t ORDER BY c, b LIMIT 25;
+SELECT * FROM incr_sort_t ORDER BY c, b LIMIT 25;
+
+-- check the order of a larger result
+SELECT count(*) FROM
+  (SELECT a, b, lag(a) OVER w AS prev_a, lag(b) OVER w AS prev_b
+     FROM (SELECT a, b FROM incr_sort_t ORDER BY a, b LIMIT 5000) s
+   WINDOW w AS ()) ss
+WHERE (prev_a, prev_b) > (a, b);
+
+-- rescan with a different parameter each time
+SELECT x, ss.* FROM generate_series(1, 3) x,
+  LATERAL (SELECT a, b FROM incr_sort_t WHERE a >= x
+           ORDER BY a, b LIMIT 2) ss;
+
+-- without incremental sort, the cheapest path is sorted in full
+SET enable_incrementalsort = off;
+EXPLAIN (COSTS OFF)
+SELECT * FROM incr_sort_t ORDER BY a, b LIMIT 10;
+RESET enable_incrementalsort;
+
+-- disabling full sorts leaves incremental sort available
+SET enable_sort = off;
+EXPLAIN (COSTS OFF)
+SELECT * FROM incr_sort_t ORDER BY a, b LIMIT 10;
+RESET enable_sort;
+
+DROP TABLE incr_sort_t;
@@ -0,0 +1,114 @@
+--
+-- MEMOIZE
+--
+-- Caching of the inner side of parameterized nested loops
+--
+
+-- Memory usage and heap fetches vary between runs, so mask them.  The
+-- number of evictions depends on the size of the entries, and so does the
+-- number of hits and misses once there are any evictions.
+CREATE FUNCTION explain_memoize(query text, hide_hitmiss bool DEFAULT false)
+RETURNS SETOF text
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+BEGIN
+    FOR ln IN
+        EXECUTE format('EXPLAIN (ANALYZE, COSTS OFF, SUMMARY OFF, TIMING OFF) %s',
+            query)
+    LOOP
+        IF hide_hitmiss THEN
+            ln := regexp_replace(ln, 'Hits: \d+', 'Hits: N');
+            ln := regexp_replace(ln, 'Misses: \d+', 'Misses: N');
+        END IF;
+        ln := regexp_replace(ln, 'Evictions: 0', 'Evictions: Zero');
+        ln := regexp_replace(ln, 'Evictions: \d+', 'Evictions: N');
+        ln := regexp_replace(ln, 'Memory Usage: \d+', 'Memory Usage: N');
+        ln := regexp_replace(ln, 'Heap Fetches: \d+', 'Heap Fetches: N');
+        RETURN NEXT ln;
+    END LOOP;
+END;
+$$;
+
+SET enable_hashjoin TO off;
+SET enable_bitmapscan TO off;
+
+-- twenty has 20 distinct values, so all but 20 of the inner scans are hits
+SELECT explain_memoize('
+SELECT COUNT(*), AVG(t1.unique1) FROM tenk1 t1
+INNER JOIN tenk1 t2 ON t1.unique1 = t2.twenty
+WHERE t2.unique1 < 1000;');
+SELECT COUNT(*), AVG(t1.unique1) FROM tenk1 t1
+INNER JOIN tenk1 t2 ON t1.unique1 = t2.twenty
+WHERE t2.unique1 < 1000;
+
+-- the same results without the cache
+SET enable_memoize TO off;
+SELECT COUNT(*), AVG(t1.unique1) FROM tenk1 t1
+INNER JOIN tenk1 t2 ON t1.unique1 = t2.twenty
+WHERE t2.unique1 < 1000;
+RESET enable_memoize;
+
+-- a lateral reference is part of the cache key too
+SELECT explain_memoize('
+SELECT COUNT(*), AVG(t2.unique1) FROM tenk1 t1,
+LATERAL (SELECT t2.unique1 FROM tenk1 t2
+         WHERE t1.twenty = t2.unique1 OFFSET 0) t2
+WHERE t1.unique1 < 1000;');
+SELECT COUNT(*), AVG(t2.unique1) FROM tenk1 t1,
+LATERAL (SELECT t2.unique1 FROM tenk1 t2
+         WHERE t1.twenty = t2.unique1 OFFSET 0) t2
+WHERE t1.unique1 < 1000;
+
+-- lateral references are compared by their binary images, as values that
+-- are equal may still give different results, like numeric 1.0 and 1.00
+CREATE TABLE memoize_num (n numeric);
+INSERT INTO memoize_num
+  SELECT CASE WHEN i % 2 = 0 THEN 1.0 ELSE 1.00 END
+  FROM generate_series(1, 100) i;
+ANALYZE memoize_num;
+SELECT explain_memoize('
+SELECT m.n, s.t FROM memoize_num m,
+LATERAL (SELECT m.n::text AS t FROM tenk1 t WHERE t.twenty = m.n LIMIT 1) s;')
+  LIMIT 8;
+SELECT m.n::text AS n, s.t, COUNT(*) FROM memoize_num m,
+LATERAL (SELECT m.n::text AS t FROM tenk1 t WHERE t.twenty = m.n LIMIT 1) s
+GROUP BY 1, 2 ORDER BY 1, 2;
+DROP TABLE memoize_num;
+
+-- semi and anti joins need only cache the first row for each key
+SET enable_mergejoin TO off;
+SELECT explain_memoize('
+SELECT COUNT(*) FROM tenk1 t1
+WHERE EXISTS (SELECT 1 FROM tenk1 t2 WHERE t2.unique1 = t1.twenty)
+AND t1.unique1 < 1000;');
+SELECT COUNT(*) FROM tenk1 t1
+WHERE EXISTS (SELECT 1 FROM tenk1 t2 WHERE t2.unique1 = t1.twenty)
+AND t1.unique1 < 1000;
+SELECT explain_memoize('
+SELECT COUNT(*) FROM tenk1 t1
+WHERE NOT EXISTS (SELECT 1 FROM tenk1 t2
+                  WHERE t2.unique1 = t1.twenty AND t2.ten < 5)
+AND t1.unique1 < 1000;');
+SELECT COUNT(*) FROM tenk1 t1
+WHERE NOT EXISTS (SELECT 1 FROM tenk1 t2
+                  WHERE t2.unique1 = t1.twenty AND t2.ten < 5)
+AND t1.unique1 < 1000;
+RESET enable_mergejoin;
+
+-- a cache too small to hold every entry still gives the right answer
+SET work_mem TO '64kB';
+SET enable_mergejoin TO off;
+SELECT explain_memoize('
+SELECT COUNT(*), SUM(t1.four) FROM tenk1 t1
+INNER JOIN tenk1 t2 ON t1.unique1 = t2.thousand;', true);
+SELECT COUNT(*), SUM(t1.four) FROM tenk1 t1
+INNER JOIN tenk1 t2 ON t1.unique1 = t2.thousand;
+RESET enable_mergejoin;
+RESET work_mem;
+
+RESET enable_hashjoin;
+RESET enable_bitmapscan;
+
+DROP FUNCTION explain_memoize(text, bool);
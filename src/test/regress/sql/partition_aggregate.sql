@@ -0,0 +1,63 @@
+--
+-- PARTITION_AGGREGATE
+-- Test partition-wise grouping and aggregation
+--
+
+-- Enable partition-wise aggregation, which by default is disabled.
+SET enable_partition_wise_agg TO true;
+-- Disable hash aggregation, so that the plans below are stable.
+SET enable_hashagg TO false;
+
+CREATE TABLE pagg_tab (a int, b int, c int) PARTITION BY RANGE(a);
+CREATE TABLE pagg_tab_p1 PARTITION OF pagg_tab FOR VALUES FROM (0) TO (10);
+CREATE TABLE pagg_tab_p2 PARTITION OF pagg_tab FOR VALUES FROM (10) TO (20);
+CREATE TABLE pagg_tab_p3 PARTITION OF pagg_tab FOR VALUES FROM (20) TO (30);
+INSERT INTO pagg_tab SELECT i % 30, i % 7, i FROM generate_series(0, 2999) i;
+ANALYZE pagg_tab;
+
+-- GROUP BY includes the partition key, so each partition is aggregated fully
+EXPLAIN (COSTS OFF)
+SELECT a, count(*), sum(c) FROM pagg_tab GROUP BY a HAVING avg(c) < 1500 ORDER BY a;
+SELECT a, count(*), sum(c) FROM pagg_tab GROUP BY a HAVING avg(c) < 1500 ORDER BY a;
+
+-- GROUP BY doesn't include the partition key, so partitions are aggregated
+-- partially and the results combined
+EXPLAIN (COSTS OFF)
+SELECT b, count(*), sum(a) FROM pagg_tab GROUP BY b ORDER BY b;
+SELECT b, count(*), sum(a) FROM pagg_tab GROUP BY b ORDER BY b;
+
+-- without GROUP BY
+SELECT count(*), sum(c), max(a) FROM pagg_tab;
+
+-- grouping without aggregates
+SELECT b FROM pagg_tab GROUP BY b ORDER BY b;
+
+-- aggregates that can't be computed partially prevent partial aggregation
+EXPLAIN (COSTS OFF)
+SELECT b, count(DISTINCT a) FROM pagg_tab GROUP BY b ORDER BY b;
+SELECT b, count(DISTINCT a) FROM pagg_tab GROUP BY b ORDER BY b;
+
+-- hashed aggregation gives the same results
+RESET enable_hashagg;
+SELECT a, count(*), sum(c) FROM pagg_tab GROUP BY a HAVING avg(c) < 1500 ORDER BY a;
+SELECT b, count(*), sum(a) FROM pagg_tab GROUP BY b ORDER BY b;
+
+-- aggregation over a partition-wise join
+SET enable_partition_wise_join TO true;
+SELECT t1.a, count(*) FROM pagg_tab t1, pagg_tab t2 WHERE t1.a = t2.a AND t1.c < 100 AND t2.c < 100 AND t1.a < 12 GROUP BY t1.a ORDER BY t1.a;
+RESET enable_partition_wise_join;
+
+-- partition-wise aggregation can be done in parallel
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+SELECT a, count(*), sum(c) FROM pagg_tab GROUP BY a HAVING avg(c) < 1500 ORDER BY a;
+SELECT b, count(*), sum(a) FROM pagg_tab GROUP BY b ORDER BY b;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+
+DROP TABLE pagg_tab;
+RESET enable_partition_wise_agg;
@@ -156,3 +156,36 @@ end$$ language plpgsql;
 
 select cachebug();
 select cachebug();
+
+-- Test plan_cache_mode and the plan counters in pg_prepared_statements
+
+create table test_mode (a int);
+insert into test_mode select 1 from generate_series(1,1000) union all select 2;
+create index on test_mode (a);
+analyze test_mode;
+
+prepare test_mode_pp (int) as select count(*) from test_mode where a = $1;
+
+-- up to 5 executions, custom plan is used
+explain (costs off) execute test_mode_pp(2);
+
+-- force generic plan
+set plan_cache_mode to force_generic_plan;
+explain (costs off) execute test_mode_pp(2);
+execute test_mode_pp(2);
+execute test_mode_pp(1);
+
+-- but we can force a custom plan
+set plan_cache_mode to force_custom_plan;
+explain (costs off) execute test_mode_pp(2);
+execute test_mode_pp(2);
+
+-- check the counters
+select generic_plans, custom_plans,
+       mean_generic_time is not null as generic_timed,
+       mean_custom_time is not null as custom_timed
+  from pg_prepared_statements where name = 'test_mode_pp';
+
+reset plan_cache_mode;
+deallocate test_mode_pp;
+drop table test_mode;
@@ -0,0 +1,65 @@
+--
+-- SKIP SCAN
+--
+-- B-tree scans that jump between the values of the leading index column
+--
+
+CREATE TABLE skip_scan_t (a int, b int, c text);
+INSERT INTO skip_scan_t
+  SELECT i % 4, i, 'x' FROM generate_series(1, 10000) i;
+CREATE INDEX skip_scan_t_a_b_idx ON skip_scan_t (a, b);
+ANALYZE skip_scan_t;
+
+-- a qual on the second column only
+EXPLAIN (COSTS OFF)
+SELECT * FROM skip_scan_t WHERE b = 5000;
+SELECT * FROM skip_scan_t WHERE b = 5000;
+
+-- the output is still in index order
+EXPLAIN (COSTS OFF)
+SELECT a, b FROM skip_scan_t WHERE b BETWEEN 100 AND 103 ORDER BY a, b;
+SELECT a, b FROM skip_scan_t WHERE b BETWEEN 100 AND 103 ORDER BY a, b;
+
+-- DISTINCT on the leading column reads one entry per value
+EXPLAIN (COSTS OFF)
+SELECT DISTINCT a FROM skip_scan_t;
+SELECT DISTINCT a FROM skip_scan_t;
+
+EXPLAIN (COSTS OFF)
+SELECT DISTINCT a FROM skip_scan_t WHERE b < 3;
+SELECT DISTINCT a FROM skip_scan_t WHERE b < 3;
+
+-- NULLs in the leading column form a value of their own
+INSERT INTO skip_scan_t VALUES (NULL, 5000, 'y');
+SELECT * FROM skip_scan_t WHERE b = 5000;
+SELECT DISTINCT a FROM skip_scan_t;
+
+-- rescan with a different parameter each time
+SELECT v, (SELECT count(*) FROM skip_scan_t t WHERE t.b = v)
+FROM (VALUES (7), (8)) v(v);
+
+-- without skip scans, the whole table is read
+SET enable_indexskipscan = off;
+EXPLAIN (COSTS OFF)
+SELECT DISTINCT a FROM skip_scan_t;
+RESET enable_indexskipscan;
+
+DROP TABLE skip_scan_t;
+
+-- a lossy clause is rechecked after the scan, so the first tuple of each
+-- value may be rejected and DISTINCT must not skip the rest of the value
+CREATE TABLE skip_scan_like (a int, b text COLLATE "C");
+INSERT INTO skip_scan_like
+  SELECT i % 3, CASE WHEN i < 3 THEN 'fooa' WHEN i < 300 THEN 'foob'
+                     ELSE 'foobar' END
+  FROM generate_series(0, 1999) i;
+CREATE INDEX skip_scan_like_a_b_idx ON skip_scan_like (a, b);
+ANALYZE skip_scan_like;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+EXPLAIN (COSTS OFF)
+SELECT DISTINCT a FROM skip_scan_like WHERE b LIKE 'foo%bar';
+SELECT DISTINCT a FROM skip_scan_like WHERE b LIKE 'foo%bar';
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE skip_scan_like;
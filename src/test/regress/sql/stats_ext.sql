@@ -231,3 +231,66 @@ EXPLAIN (COSTS OFF)
 
 RESET random_page_cost;
 DROP TABLE functional_dependencies;
+
+-- MCV lists
+CREATE TABLE mcv_lists (
+    filler1 TEXT,
+    filler2 NUMERIC,
+    a INT,
+    b INT,
+    filler3 DATE,
+    c TEXT
+);
+
+-- check estimated (and actual) number of rows of the top-level plan node
+CREATE FUNCTION check_estimated_rows(text) RETURNS TABLE (estimated int, actual int)
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+    tmp text[];
+BEGIN
+    FOR ln IN EXECUTE format('EXPLAIN ANALYZE %s', $1) LOOP
+        tmp := regexp_match(ln, 'rows=(\d*) .* rows=(\d*)');
+        RETURN QUERY SELECT tmp[1]::int, tmp[2]::int;
+        EXIT;
+    END LOOP;
+END;
+$$;
+
+-- perfectly correlated columns, including NULLs
+INSERT INTO mcv_lists (a, b, c, filler1)
+     SELECT nullif(mod(i,100), 0), nullif(mod(i,100), 0), nullif(mod(i,100), 0), i
+       FROM generate_series(1,5000) s(i);
+
+ANALYZE mcv_lists;
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = 1');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = 1 AND c = ''1''');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a < 5 AND b < 5');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a IS NULL AND b IS NULL');
+
+-- create statistics
+CREATE STATISTICS mcv_lists_stats WITH (mcv) ON (a, b, c) FROM mcv_lists;
+
+ANALYZE mcv_lists;
+
+SELECT pg_get_statisticsextdef(oid), staenabled, stamcv IS NOT NULL AS built
+  FROM pg_statistic_ext WHERE staname = 'mcv_lists_stats';
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = 1');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = 1 AND c = ''1''');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a < 5 AND b < 5');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a IS NULL AND b IS NULL');
+
+-- combination not present in the MCV list
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = 2');
+
+DROP FUNCTION check_estimated_rows(text);
+DROP TABLE mcv_lists;
@@ -12,6 +12,25 @@ select count(*) >= 0 as ok from pg_available_extension_versions;
 
 select count(*) >= 0 as ok from pg_available_extensions;
 
+-- The relcache is always populated; check that the catcache and relcache
+-- give up their least recently used entries when limited in size
+select count(*) > 0 as ok from pg_catalog_cache_stats
+  where cache = 'relcache' and entries > 0;
+
+set catalog_cache_memory_target = '64kB';
+select count(*) > 0 as ok from pg_proc
+  where has_function_privilege(oid, 'execute');
+select sum(evictions) > 0 as ok, sum(size) <= 65536 as ok
+  from pg_catalog_cache_stats where cache = 'catcache';
+reset catalog_cache_memory_target;
+
+set relation_cache_memory_target = '64kB';
+select count(pg_relation_size(oid)) > 0 as ok from pg_class
+  where relnamespace = 'pg_catalog'::regnamespace and relkind in ('r', 'i');
+select evictions > 0 as ok from pg_catalog_cache_stats
+  where cache = 'relcache';
+reset relation_cache_memory_target;
+
 -- At introduction, pg_config had 23 entries; it may grow
 select count(*) > 20 as ok from pg_config;
 